@@ -208,6 +208,9 @@ man_pages = [
     ('man3/flux_msg_handler_create', 'flux_msg_handler_stop', 'manage message handlers', [author], 3),
     ('man3/flux_msg_handler_create', 'flux_msg_handler_create', 'manage message handlers', [author], 3),
     ('man3/flux_msg_handler_create', 'flux_get_handle_watcher', 'manage message handlers', [author], 3),
+    ('man3/flux_msg_handler_create', 'flux_dispatch_set_batch', 'manage message handlers', [author], 3),
+    ('man3/flux_msg_handler_create', 'flux_get_dispatch_stats', 'manage message handlers', [author], 3),
+    ('man3/flux_msg_handler_create', 'flux_clr_dispatch_stats', 'manage message handlers', [author], 3),
     ('man3/flux_msg_handler_allow_rolemask', 'flux_msg_handler_allow_rolemask', 'alter message handler rolemask', [author], 3),
     ('man3/flux_msg_handler_allow_rolemask', 'flux_msg_handler_deny_rolemask', 'alter message handler rolemask', [author], 3),
     ('man3/flux_open', 'flux_clone', 'open/close connection to Flux Message Broker', [author], 3),
@@ -235,6 +238,7 @@ man_pages = [
     ('man3/flux_requeue', 'flux_requeue', 'requeue a message', [author], 3),
     ('man3/flux_respond', 'flux_respond_pack', 'respond to a request', [author], 3),
     ('man3/flux_respond', 'flux_respond_raw', 'respond to a request', [author], 3),
+    ('man3/flux_respond', 'flux_respond_raw_iov', 'respond to a request', [author], 3),
     ('man3/flux_respond', 'flux_respond_error', 'respond to a request', [author], 3),
     ('man3/flux_respond', 'flux_respond', 'respond to a request', [author], 3),
     ('man3/flux_response_decode', 'flux_response_decode_raw', 'decode a Flux response message', [author], 3),
@@ -385,6 +389,7 @@ man_pages = [
     ('man5/flux-config-policy', 'flux-config-policy', 'configure Flux job policy', [author], 5),
     ('man5/flux-config-queues', 'flux-config-queues', 'configure Flux job queues', [author], 5),
     ('man5/flux-config-job-manager', 'flux-config-job-manager', 'configure Flux job manager service', [author], 5),
+    ('man5/flux-config-job-list', 'flux-config-job-list', 'configure Flux job list service', [author], 5),
     ('man5/flux-config-kvs', 'flux-config-kvs', 'configure Flux kvs service', [author], 5),
     ('man5/flux-config-heartbeat', 'flux-config-heartbeat', 'configure Flux heartbeat service', [author], 5),
     ('man5/flux-config-fake-resources', 'flux-config-fake-resources', 'configure synthetic resources for Flux test instances', [author], 5),
@@ -20,6 +20,7 @@ brew install \
   zeromq \
   jansson \
   lz4 \
+  zstd \
   libarchive \
   hwloc \
   sqlite \
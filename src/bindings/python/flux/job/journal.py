@@ -128,7 +128,11 @@ class JournalConsumer(JournalConsumerBase):
 
     @property
     def request_payload(self):
-        return {"full": self.full}
+        payload = {"full": self.full}
+        if self.since > 0.0:
+            #  Let the job manager skip jobs with no events after since
+            payload["after_time"] = self.since
+        return payload
 
     def process_response(self, resp):
         """Process a single job manager journal response
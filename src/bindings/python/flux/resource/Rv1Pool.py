@@ -40,8 +40,9 @@ or directly::
 import json
 import syslog
 import time
+from bisect import bisect_left, insort
 from collections.abc import Mapping
-from typing import Dict, List, Tuple
+from typing import Dict, List, Optional, Tuple
 
 from flux.idset import IDset
 from flux.job import JobID
@@ -285,10 +286,25 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         up              – True if rank is schedulable
         allocated_cores – set of core IDs currently allocated on this rank
         allocated_gpus  – set of GPU IDs currently allocated on this rank
+
+    A free-resource index groups up ranks by ``(free cores, free GPUs)``
+    so that :meth:`alloc` visits candidates in worst-fit order without
+    scanning the whole pool.  It is updated incrementally by the methods
+    that change availability or allocation, and rebuilt on demand if
+    :attr:`generation` shows the pool changed by other means.
     """
 
     version = 1
 
+    # Free-resource index, built on first use by _index_build():
+    # _free_index: (free cores, free GPUs) -> sorted list of rank positions.
+    # _index_ranks: rank position -> rank, in _ranks iteration order.
+    # _index_pos: rank -> rank position.
+    # _index_key: rank -> its _free_index key, for indexed (up) ranks.
+    # _index_gen: generation at which the index was last valid.
+    _free_index = None
+    _index_gen = -1
+
     #: Pool options recognised by this implementation.  The scheduler logs
     #: a warning for any key in ``pool_kwargs`` not listed here.
     known_options: frozenset = frozenset()
@@ -424,22 +440,26 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         if ids == "all":
             for info in self._ranks.values():
                 info["up"] = True
+            self._index_update(None)
         else:
-            for rank in IDset(ids):
+            ranks = IDset(ids)
+            for rank in ranks:
                 if rank in self._ranks:
                     self._ranks[rank]["up"] = True
-        self._bump()
+            self._index_update(ranks)
 
     def mark_down(self, ids: str) -> None:
         """Mark ranks as not schedulable."""
         if ids == "all":
             for info in self._ranks.values():
                 info["up"] = False
+            self._index_update(None)
         else:
-            for rank in IDset(ids):
+            ranks = IDset(ids)
+            for rank in ranks:
                 if rank in self._ranks:
                     self._ranks[rank]["up"] = False
-        self._bump()
+            self._index_update(ranks)
 
     def remove_ranks(self, ranks) -> None:
         """Remove ranks from the pool (shrink event)."""
@@ -449,7 +469,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             self._ranks.pop(rank, None)
             for prop_ranks in self._properties.values():
                 prop_ranks.discard(rank)
-        self._bump()
+        self._index_update(ranks)
 
     # ------------------------------------------------------------------
     # ResourcePoolImplementation — job lifecycle
@@ -472,7 +492,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
             )
         self._set_allocated(R)
         self._job_state[jobid] = (R.get_expiration(), R)
-        self._bump()
+        self._index_update(R._ranks)
         self.log(syslog.LOG_INFO, f"hello: {JobID(jobid).f58}: {R.dumps()}")
 
     def free(self, jobid: int, R=None, final: bool = False) -> None:
@@ -528,12 +548,14 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                     self._ranks[rank]["allocated_cores"] -= ainfo["cores"]
                     self._ranks[rank]["allocated_gpus"] -= ainfo["gpus"]
             freed_dumps = alloc.dumps()
+            freed_ranks = alloc._ranks
         elif R is not None:
             for rank, ainfo in R._ranks.items():
                 if rank in self._ranks:
                     self._ranks[rank]["allocated_cores"] -= ainfo["cores"]
                     self._ranks[rank]["allocated_gpus"] -= ainfo["gpus"]
             freed_dumps = R.dumps()
+            freed_ranks = R._ranks
             if jobid in self._job_state:
                 end_time, alloc = self._job_state[jobid]
                 remaining = set(alloc._ranks.keys()) - set(R._ranks.keys())
@@ -547,18 +569,19 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                     self._ranks[rank]["allocated_cores"] -= ainfo["cores"]
                     self._ranks[rank]["allocated_gpus"] -= ainfo["gpus"]
             freed_dumps = alloc.dumps()
+            freed_ranks = alloc._ranks
         self.log(
             syslog.LOG_DEBUG,
             f"free: {JobID(jobid).f58}: {freed_dumps}" + (" (final)" if final else ""),
         )
-        self._bump()
+        self._index_update(freed_ranks)
 
     def update_expiration(self, jobid: int, expiration: float) -> None:
         """Update the end time for a tracked job."""
         if jobid in self._job_state:
             _, alloc = self._job_state[jobid]
             self._job_state[jobid] = (expiration, alloc)
-            self._bump()
+            self._index_update(())
 
     def job_end_times(self) -> List[Tuple[int, float]]:
         """Return a list of ``(jobid, end_time)`` pairs for all tracked jobs."""
@@ -636,29 +659,29 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         if constraint is not None and isinstance(constraint, str):
             constraint = json.loads(constraint)
 
-        # Build candidate list: up ranks with enough free cores (and GPUs).
-        # Each entry is (rank, info, free_cores, free_gpus).
-        candidates = []
-        for rank, info in self._ranks.items():
-            if not info["up"]:
-                continue
-            free_cores = info["cores"] - info["allocated_cores"]
-            free_gpus = info["gpus"] - info["allocated_gpus"]
-            needed_cores = len(info["cores"]) if exclusive else slot_size
-            if len(free_cores) < needed_cores:
-                continue
-            if gpu_per_slot > 0 and len(free_gpus) < gpu_per_slot:
-                continue
-            candidates.append((rank, info, free_cores, free_gpus))
-
-        if constraint is not None:
-            candidates = [
-                (r, i, fc, fg)
-                for r, i, fc, fg in candidates
-                if self._matches_constraint(r, i, constraint)
-            ]
-
-        candidates = self._sort_candidates(candidates)
+        # Candidates are up ranks with enough free cores (and GPUs) that
+        # match the constraint.  Each is (rank, info, free_cores, free_gpus).
+        # They are generated in worst-fit order from the free-resource index.
+        # Overrides of _sort_candidates or _select_resources receive the full
+        # list, in _ranks order before sorting.  Otherwise the generator is
+        # passed directly, filtered by the per-node need of the default
+        # selection, so it visits only as many ranks as the request uses.
+        sort_override = type(self)._sort_candidates is not Rv1Pool._sort_candidates
+        select_override = type(self)._select_resources is not Rv1Pool._select_resources
+        if sort_override or select_override or exclusive or request.nnodes == 0:
+            min_cores, min_gpus = slot_size, gpu_per_slot
+        else:
+            slots_per_node = request.nslots // request.nnodes
+            min_cores = slots_per_node * slot_size
+            min_gpus = slots_per_node * gpu_per_slot
+        candidates = self._indexed_candidates(
+            min_cores, min_gpus, exclusive, constraint
+        )
+        if sort_override:
+            candidates = sorted(candidates, key=lambda c: self._index_pos[c[0]])
+            candidates = self._sort_candidates(candidates)
+        elif select_override:
+            candidates = list(candidates)
 
         selected, actual_nslots = self._select_resources(candidates, request)
 
@@ -710,7 +733,7 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
         )
         result._nslots = actual_nslots
         self._job_state[jobid] = (end_time, result)
-        self._bump()
+        self._index_update(selected_ranks)
         self.log(syslog.LOG_DEBUG, f"alloc: {JobID(jobid).f58}: {result.dumps()}")
         return result
 
@@ -818,6 +841,145 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
                 self._ranks[rank]["allocated_cores"] |= oinfo["cores"]
                 self._ranks[rank]["allocated_gpus"] |= oinfo["gpus"]
 
+    def _index_build(self) -> None:
+        """(Re)build the free-resource index from ``_ranks``."""
+        self._free_index = {}
+        self._index_ranks = list(self._ranks)
+        self._index_pos = {rank: pos for pos, rank in enumerate(self._index_ranks)}
+        self._index_key = {}
+        for rank in self._index_ranks:
+            self._index_rank(rank)
+        self._index_gen = self.generation
+
+    def _index_rank(self, rank: int) -> None:
+        """Move *rank* to the index bucket matching its current state."""
+        pos = self._index_pos.get(rank)
+        if pos is None:
+            if rank in self._ranks:
+                # rank was added without going through the index: rebuild
+                self._free_index = None
+            return
+        key = self._index_key.pop(rank, None)
+        if key is not None:
+            bucket = self._free_index[key]
+            del bucket[bisect_left(bucket, pos)]
+            if not bucket:
+                del self._free_index[key]
+        info = self._ranks.get(rank)
+        if info is None or not info["up"]:
+            return
+        key = (
+            len(info["cores"] - info["allocated_cores"]),
+            len(info["gpus"] - info["allocated_gpus"]),
+        )
+        insort(self._free_index.setdefault(key, []), pos)
+        self._index_key[rank] = key
+
+    def _index_update(self, ranks) -> None:
+        """Bump :attr:`generation` after a change to *ranks* (None = all).
+
+        Keeps the free-resource index valid by updating only *ranks*, unless
+        it is already stale or all ranks changed, in which case it is left to
+        be rebuilt on next use.
+        """
+        valid = self._free_index is not None and self._index_gen == self.generation
+        self._bump()
+        if not valid or ranks is None:
+            self._free_index = None
+            return
+        for rank in ranks:
+            self._index_rank(rank)
+            if self._free_index is None:
+                return
+        self._index_gen = self.generation
+
+    def _indexed_candidates(
+        self, min_cores: int, min_gpus: int, exclusive: bool, constraint
+    ):
+        """Generate alloc candidates in worst-fit order from the index.
+
+        Yields ``(rank, info, free_cores, free_gpus)`` for up ranks with at
+        least *min_cores* free cores (all cores if *exclusive*) and
+        *min_gpus* free GPUs that match *constraint*.  Order is descending
+        free cores, then free GPUs, then ``_ranks`` order, which is what the
+        default :meth:`_sort_candidates` produces.
+
+        If :meth:`_constraint_ranks` can resolve *constraint* from the
+        property rank sets, only the matching ranks are visited, unless a
+        subclass overrides :meth:`_matches_constraint`.
+        """
+        if self._free_index is None or self._index_gen != self.generation:
+            self._index_build()
+        index = self._free_index
+        if (
+            constraint is not None
+            and type(self)._matches_constraint is Rv1Set._matches_constraint
+        ):
+            matching = self._constraint_ranks(constraint)
+            if matching is not None:
+                index = {}
+                for rank in matching:
+                    key = self._index_key.get(rank)
+                    if key is not None:
+                        index.setdefault(key, []).append(self._index_pos[rank])
+                for bucket in index.values():
+                    bucket.sort()
+                constraint = None
+        if exclusive:
+            min_cores = 0
+        for key in sorted(index, reverse=True):
+            ncores, ngpus = key
+            if ncores < min_cores:
+                break
+            if ngpus < min_gpus:
+                continue
+            for pos in index[key]:
+                rank = self._index_ranks[pos]
+                info = self._ranks[rank]
+                free_cores = info["cores"] - info["allocated_cores"]
+                if exclusive and len(free_cores) < len(info["cores"]):
+                    continue
+                if constraint is not None and not self._matches_constraint(
+                    rank, info, constraint
+                ):
+                    continue
+                yield rank, info, free_cores, info["gpus"] - info["allocated_gpus"]
+
+    def _constraint_ranks(self, constraint) -> Optional[set]:
+        """Return the set of ranks matching *constraint*, or None.
+
+        A ``properties`` constraint with at least one non-negated property,
+        or an ``and``/``or`` of such constraints, is resolved with set
+        operations on :attr:`_properties`.  None means the constraint must
+        be checked rank by rank with :meth:`_matches_constraint`.
+        """
+        if not isinstance(constraint, Mapping) or len(constraint) != 1:
+            return None
+        op, args = next(iter(constraint.items()))
+        if not isinstance(args, list) or not args:
+            return None
+        if op == "properties":
+            if not all(isinstance(prop, str) for prop in args):
+                return None
+            want = [prop for prop in args if not prop.startswith("^")]
+            if not want:
+                return None
+            ranks = set.intersection(
+                *(set(self._properties.get(prop, ())) for prop in want)
+            )
+            for prop in args:
+                if prop.startswith("^"):
+                    ranks -= self._properties.get(prop[1:], set())
+            return ranks
+        if op in ("and", "or"):
+            sets = [self._constraint_ranks(c) for c in args]
+            if any(ranks is None for ranks in sets):
+                return None
+            if op == "and":
+                return set.intersection(*sets)
+            return set.union(*sets)
+        return None
+
     def _sort_candidates(self, candidates: list) -> list:
         """Sort *candidates* for node selection order.
 
@@ -833,9 +995,12 @@ class Rv1Pool(Rv1Set, ResourcePoolImplementation):
     def _select_resources(self, candidates: list, request) -> tuple:
         """Select resources from *candidates* to satisfy *request*.
 
-        *candidates* is a list of ``(rank, info, free_cores, free_gpus)``
+        *candidates* is an iterable of ``(rank, info, free_cores, free_gpus)``
         tuples, already filtered for availability and sorted by
-        ``_sort_candidates``.
+        ``_sort_candidates``.  When neither this method nor
+        ``_sort_candidates`` is overridden it is a generator, so the default
+        selection only visits as many ranks as the request needs; overrides
+        always receive a list.
 
         .. warning::
            The *info* dict is live pool state shared with the parent Rv1Pool.
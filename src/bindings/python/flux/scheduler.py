@@ -362,11 +362,26 @@ class Scheduler(BrokerModule):
         self._forecast_pending = False
         self._forecast_idle = h.idle_watcher_create()
         self._forecast_check = h.check_watcher_create(self._on_forecast_check)
+        # Batched R commits: R for every alloc_success() in one reactor
+        # iteration is added to a single KVS transaction, committed from a
+        # prepare watcher before the reactor blocks.
+        # _alloc_txn: open transaction, or None when no allocs are pending.
+        # _alloc_batch: (msg, R, annotations) for each alloc in _alloc_txn.
+        # _alloc_prep: fires before the reactor blocks to commit the batch.
+        # _alloc_idle: keeps the reactor from blocking while a batch is open,
+        #   in case it was opened after _alloc_prep ran in this iteration.
+        self._alloc_txn = None
+        self._alloc_batch = []
+        self._alloc_prep = h.prepare_watcher_create(self._on_alloc_prep)
+        self._alloc_idle = h.idle_watcher_create()
         # Scheduling statistics, exposed via the stats-get RPC.
         self._sched_passes = 0
         self._sched_yields = 0
         self._forecast_passes = 0
         self._forecast_yields = 0
+        self._alloc_commits = 0
+        self._alloc_committed = 0
+        self._alloc_batch_max = 0
         self._pending_args = []
         for arg in args:
             if arg.startswith("queue-depth="):
@@ -617,7 +632,8 @@ class Scheduler(BrokerModule):
 
         Typically called via :meth:`AllocRequest.success`.  *R* must be a
         dict (parsed R JSON object).  The alloc response to job-manager is
-        sent only after R is safely stored in KVS.
+        sent only after R is safely stored in KVS.  R for all allocations
+        made in the same reactor iteration is committed in one transaction.
 
         Args:
             msg: The alloc request :class:`~flux.message.Message`.
@@ -632,24 +648,41 @@ class Scheduler(BrokerModule):
             raise OSError("flux_job_kvs_key failed")
         key = ffi.string(buf).decode()
 
-        txn = KVSTxn(self.handle)
-        txn.put(key, R)
+        if self._alloc_txn is None:
+            self._alloc_txn = KVSTxn(self.handle)
+            self._alloc_prep.start()
+            self._alloc_idle.start()
+        self._alloc_txn.put(key, R)
+        self._alloc_batch.append((msg, R, annotations))
+
+    def _on_alloc_prep(self, *_):
+        """Prepare-watcher callback: commit R for the pending batch."""
+        self._alloc_prep.stop()
+        self._alloc_idle.stop()
+        txn, batch = self._alloc_txn, self._alloc_batch
+        self._alloc_txn = None
+        self._alloc_batch = []
+        if not batch:
+            return
         f = kvs_commit_async(self.handle, _kvstxn=txn)
-        f.then(self._alloc_commit_continuation, (msg, R, annotations))
+        f.then(self._alloc_commit_continuation, batch)
+        self._alloc_commits += 1
+        self._alloc_committed += len(batch)
+        self._alloc_batch_max = max(self._alloc_batch_max, len(batch))
 
-    def _alloc_commit_continuation(self, future, args):
-        """Send the alloc response after the KVS commit completes."""
-        msg, R_dict, annotations = args
+    def _alloc_commit_continuation(self, future, batch):
+        """Send the alloc responses after the KVS commit completes."""
         try:
             future.get()
         except OSError as exc:
             self.log.error(f"alloc: KVS commit failed: {exc}")
             self.stop_error()
             return
-        resp = {"id": msg.payload["id"], "type": _ALLOC_SUCCESS, "R": R_dict}
-        if annotations is not None:
-            resp["annotations"] = annotations
-        self.handle.respond(msg, resp)
+        for msg, R_dict, annotations in batch:
+            resp = {"id": msg.payload["id"], "type": _ALLOC_SUCCESS, "R": R_dict}
+            if annotations is not None:
+                resp["annotations"] = annotations
+            self.handle.respond(msg, resp)
 
     def alloc_deny(self, msg, note=None):
         """Send an alloc denial response.  Typically called via :meth:`AllocRequest.deny`.
@@ -1063,6 +1096,12 @@ class Scheduler(BrokerModule):
             for generator-based schedulers.
         ``pending_jobs``
             Current number of pending alloc requests in the scheduler queue.
+        ``alloc_commits``
+            Number of KVS commits of allocated R.
+        ``alloc_committed``
+            Number of allocations whose R has been committed.
+        ``alloc_batch_max``
+            Most allocations whose R was committed in a single transaction.
         """
         return {
             "sched_passes": self._sched_passes,
@@ -1073,6 +1112,9 @@ class Scheduler(BrokerModule):
             "sched_duration_ewma": self._sched_duration_ewma,
             "sched_interval_ewma": self._sched_interval_ewma,
             "pending_jobs": len(self._queue),
+            "alloc_commits": self._alloc_commits,
+            "alloc_committed": self._alloc_committed,
+            "alloc_batch_max": self._alloc_batch_max,
         }
 
     # ------------------------------------------------------------------
@@ -20,6 +20,7 @@
 #include "src/common/libutil/iterators.h"
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/errno_safe.h"
+#include "src/common/librouter/subtrie.h"
 #include "ccan/str/str.h"
 #include "ccan/array_size/array_size.h"
 
@@ -31,6 +32,7 @@
 
 struct modhash {
     zhash_t *zh_byuuid;
+    struct subtrie *subscribers; // topic => modules
     flux_msg_handler_t **handlers;
     struct broker *ctx;
     struct flux_msglist *trace_requests;
@@ -191,10 +193,30 @@ int modhash_response_sendmsg_new (modhash_t *mh, flux_msg_t **msg)
     return module_sendmsg_new (p, msg);
 }
 
+/* A module subscribes to a topic for the first time.
+ * Index the module by topic for event distribution.
+ */
+static int modhash_subscribe (const char *topic, void *arg)
+{
+    module_t *p = arg;
+    modhash_t *mh = module_aux_get (p, "modhash");
+
+    return subtrie_insert (mh->subscribers, topic, p);
+}
+
+static int modhash_unsubscribe (const char *topic, void *arg)
+{
+    module_t *p = arg;
+    modhash_t *mh = module_aux_get (p, "modhash");
+
+    return subtrie_remove (mh->subscribers, topic, p);
+}
+
 static int modhash_add (modhash_t *mh, module_t *p)
 {
     if (module_aux_set (p, "modhash", mh, NULL) < 0)
         return -1;
+    module_set_subscribe_cb (p, modhash_subscribe, modhash_unsubscribe, p);
     /* always succeeds - uuids are by definition unique */
     (void)zhash_insert (mh->zh_byuuid, module_get_uuid (p), p);
     zhash_freefn (mh->zh_byuuid,
@@ -977,7 +999,8 @@ modhash_t *modhash_create (struct broker *ctx)
         return NULL;
     mh->ctx = ctx;
     if (flux_msg_handler_addvec (ctx->h, htab, ctx, &mh->handlers) < 0
-        || !(mh->trace_requests = flux_msglist_create ()))
+        || !(mh->trace_requests = flux_msglist_create ())
+        || !(mh->subscribers = subtrie_create ()))
         goto error;
     if (!(mh->zh_byuuid = zhash_new ())) {
         errno = ENOMEM;
@@ -1015,6 +1038,7 @@ int modhash_destroy (modhash_t *mh)
             }
             zhash_destroy (&mh->zh_byuuid);
         }
+        subtrie_destroy (mh->subscribers);
         flux_msg_handler_delvec (mh->handlers);
         flux_msglist_destroy (mh->trace_requests);
         flux_future_destroy (mh->f_builtins_load);
@@ -1100,29 +1124,46 @@ module_t *modhash_lookup_byname (modhash_t *mh, const char *name)
     return NULL;
 }
 
+struct event_mcast {
+    modhash_t *mh;
+    const flux_msg_t *msg;
+    int errnum;
+};
+
+// subtrie_match_f footprint
+static void event_mcast_module (void *subscriber, void *arg)
+{
+    module_t *p = subscriber;
+    struct event_mcast *mc = arg;
+    flux_msg_t *cpy;
+
+    trace_module_msg (mc->mh->ctx->h,
+                      "rx",
+                      module_get_name (p),
+                      mc->mh->trace_requests,
+                      mc->msg);
+    if (!(cpy = flux_msg_copy (mc->msg, true))
+        || module_sendmsg_new (p, &cpy) < 0) {
+        if (mc->errnum == 0)
+            mc->errnum = errno;
+        flux_msg_decref (cpy);
+    }
+}
+
 int modhash_event_mcast (modhash_t *mh, const flux_msg_t *msg)
 {
+    struct event_mcast mc = { .mh = mh, .msg = msg, .errnum = 0 };
     const char *topic;
-    module_t *p;
 
-    if (flux_msg_get_topic (msg, &topic) < 0)
+    if (flux_msg_get_topic (msg, &topic) < 0
+        || subtrie_match (mh->subscribers,
+                          topic,
+                          event_mcast_module,
+                          &mc) < 0)
+        return -1;
+    if (mc.errnum != 0) {
+        errno = mc.errnum;
         return -1;
-    p = zhash_first (mh->zh_byuuid);
-    while (p) {
-        if (module_is_subscribed (p, topic)) {
-            trace_module_msg (mh->ctx->h,
-                              "rx",
-                              module_get_name (p),
-                              mh->trace_requests,
-                              msg);
-            flux_msg_t *cpy;
-            if (!(cpy = flux_msg_copy (msg, true))
-                || module_sendmsg_new (p, &cpy) < 0) {
-                flux_msg_decref (cpy);
-                return -1;
-            }
-        }
-        p = zhash_next (mh->zh_byuuid);
     }
     return 0;
 }
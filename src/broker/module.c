@@ -721,9 +721,13 @@ int module_unsubscribe (module_t *p, const char *topic)
     return subhash_unsubscribe (p->sub, topic);
 }
 
-bool module_is_subscribed (module_t *p, const char *topic)
+void module_set_subscribe_cb (module_t *p,
+                              subscribe_f sub,
+                              subscribe_f unsub,
+                              void *arg)
 {
-    return subhash_topic_match (p->sub, topic);
+    subhash_set_subscribe (p->sub, sub, arg);
+    subhash_set_unsubscribe (p->sub, unsub, arg);
 }
 
 ssize_t module_get_send_queue_count (module_t *p)
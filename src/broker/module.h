@@ -15,6 +15,7 @@
 #include <flux/core.h>
 
 #include "src/common/librouter/disconnect.h"
+#include "src/common/librouter/subhash.h"
 
 /* Module states, for embedding in keepalive messages (rfc 5)
  */
@@ -130,7 +131,15 @@ bool module_unload_requested (module_t *p);
  */
 int module_subscribe (module_t *p, const char *topic);
 int module_unsubscribe (module_t *p, const char *topic);
-bool module_is_subscribed (module_t *p, const char *topic);
+
+/* Register callbacks for the first subscription to, and the last
+ * unsubscription from, each topic.  'unsub' is also called for each
+ * remaining topic when the module is destroyed.
+ */
+void module_set_subscribe_cb (module_t *p,
+                              subscribe_f sub,
+                              subscribe_f unsub,
+                              void *arg);
 
 ssize_t module_get_send_queue_count (module_t *p);
 ssize_t module_get_recv_queue_count (module_t *p);
@@ -624,7 +624,8 @@ static void move_dir_lost_and_found (struct fsck_ctx *ctx,
             log_msg_exit ("out of memory");
         if (treeobj_is_symlink (entry)
             || treeobj_is_val (entry)
-            || treeobj_is_valref (entry))
+            || treeobj_is_valref (entry)
+            || treeobj_is_ivalref (entry))
             put_lost_and_found (ctx, newpath, entry);
         else if (treeobj_is_dir (entry))
             move_dir_lost_and_found (ctx, newpath, entry);
@@ -763,6 +763,9 @@ void cmd_get_one (flux_t *h, const char *key, struct lookup_ctx *ctx)
         flags |= FLUX_KVS_WAITCREATE;
     if (optparse_hasopt (ctx->p, "stream"))
         flags |= FLUX_KVS_STREAM;
+    /* A plain raw lookup can skip the base64 encoded treeobj response */
+    if (optparse_hasopt (ctx->p, "raw") && flags == 0)
+        flags |= FLUX_KVS_RAW;
     if (optparse_hasopt (ctx->p, "at")) {
         const char *reference = optparse_get_str (ctx->p, "at", NULL);
         if (!(f = flux_kvs_lookupat (h, flags, key, reference)))
@@ -1613,7 +1616,9 @@ static int categorize_key (flux_t *h,
             if (zlist_append (dirs, nkey) < 0)
                 log_err_exit ("zlist_append");
     }
-    else if (treeobj_is_val (treeobj) || treeobj_is_valref (treeobj)) {
+    else if (treeobj_is_val (treeobj)
+             || treeobj_is_valref (treeobj)
+             || treeobj_is_ivalref (treeobj)) {
         if (require_directory) {
             fprintf (stderr, "%s: Not a directory\n", nkey);
             goto error;
@@ -151,6 +151,12 @@ static int op_getopt (void *impl, const char *option, void *val, size_t size)
             goto error;
         memcpy (val, &limit, size);
     }
+    else if (streq (option, FLUX_OPT_RECV_QUEUE_COUNT)) {
+        size_t count = msg_deque_count (ctx->queue);
+        if (size != sizeof (count) || !val)
+            goto error;
+        memcpy (val, &count, size);
+    }
     else if (streq (option, FLUX_OPT_POLLFD_EVENTS)) {
         int events = POLLIN;
         if (size != sizeof (events) || !val)
@@ -114,7 +114,7 @@ void flux_msg_destroy (flux_msg_t *msg)
         if (msg_has_route (msg))
             msg_route_clear (msg);
         free (msg->topic);
-        free (msg->payload);
+        msg_payload_release (msg);
         json_decref (msg->json);
         aux_destroy (&msg->aux);
         free (msg->lasterr);
@@ -836,6 +836,49 @@ char *flux_msg_route_string (const flux_msg_t *msg)
     return buf;
 }
 
+void msg_payload_release (flux_msg_t *msg)
+{
+    struct msg_payload *pbuf = msg->pbuf;
+
+    if (pbuf && __atomic_sub_fetch (&pbuf->refcount, 1, __ATOMIC_ACQ_REL) == 0)
+        free (pbuf);
+    msg->pbuf = NULL;
+    msg->payload = NULL;
+    msg->payload_size = 0;
+}
+
+void *msg_payload_alloc (flux_msg_t *msg, size_t size)
+{
+    struct msg_payload *pbuf;
+
+    if (!(pbuf = malloc (sizeof (*pbuf) + size))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    pbuf->refcount = 1;
+    pbuf->size = size;
+    msg_payload_release (msg);
+    msg->pbuf = pbuf;
+    msg->payload = pbuf->data;
+    msg->payload_size = size;
+    return msg->payload;
+}
+
+/* Share 'msg' payload buffer with 'cpy', which must not have one.
+ */
+static void msg_payload_share (flux_msg_t *cpy, const flux_msg_t *msg)
+{
+    __atomic_add_fetch (&msg->pbuf->refcount, 1, __ATOMIC_RELAXED);
+    cpy->pbuf = msg->pbuf;
+    cpy->payload = msg->payload;
+    cpy->payload_size = msg->payload_size;
+}
+
+static bool msg_payload_is_shared (const flux_msg_t *msg)
+{
+    return __atomic_load_n (&msg->pbuf->refcount, __ATOMIC_ACQUIRE) > 1;
+}
+
 static bool payload_overlap (flux_msg_t *msg, const void *b)
 {
     return ((char *)b >= (char *)msg->payload
@@ -854,43 +897,78 @@ int flux_msg_set_payload (flux_msg_t *msg, const void *buf, size_t size)
      */
     if (msg_has_payload (msg) && (buf != NULL && size > 0)) {
         assert (msg->payload);
-        if (msg->payload != buf || msg->payload_size != size) {
-            if (payload_overlap (msg, buf)) {
-                errno = EINVAL;
-                return -1;
-            }
+        if (msg->payload == buf && msg->payload_size == size)
+            return 0;
+        if (payload_overlap (msg, buf)) {
+            errno = EINVAL;
+            return -1;
         }
-        if (size > msg->payload_size) {
-            void *ptr;
-            if (!(ptr = realloc (msg->payload, size))) {
-                errno = ENOMEM;
+        /* A shared buffer must not be modified, so replace it.
+         */
+        if (size > msg->pbuf->size || msg_payload_is_shared (msg)) {
+            if (!msg_payload_alloc (msg, size))
                 return -1;
-            }
-            msg->payload = ptr;
-            msg->payload_size = size;
         }
+        msg->payload_size = size;
         memcpy (msg->payload, buf, size);
     /* Case #2: add payload.
      */
     } else if (!msg_has_payload (msg) && (buf != NULL && size > 0)) {
         assert (!msg->payload);
-        if (!(msg->payload = malloc (size)))
+        if (!msg_payload_alloc (msg, size))
             return -1;
-        msg->payload_size = size;
         memcpy (msg->payload, buf, size);
         msg_set_flag (msg, FLUX_MSGFLAG_PAYLOAD);
     /* Case #3: remove payload.
      */
     } else if (msg_has_payload (msg) && (buf == NULL || size == 0)) {
         assert (msg->payload);
-        free (msg->payload);
-        msg->payload = NULL;
-        msg->payload_size = 0;
+        msg_payload_release (msg);
         msg_clear_flag (msg, FLUX_MSGFLAG_PAYLOAD);
     }
     return 0;
 }
 
+int flux_msg_set_payload_iov (flux_msg_t *msg,
+                              const struct iovec *iov,
+                              int iovcnt)
+{
+    size_t size = 0;
+    char *cp;
+
+    if (msg_validate (msg) < 0)
+        return -1;
+    if (iovcnt < 0 || (iovcnt > 0 && !iov)) {
+        errno = EINVAL;
+        return -1;
+    }
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0) {
+            if (!iov[i].iov_base
+                || (msg_has_payload (msg)
+                    && payload_overlap (msg, iov[i].iov_base))) {
+                errno = EINVAL;
+                return -1;
+            }
+            size += iov[i].iov_len;
+        }
+    }
+    if (size == 0)
+        return flux_msg_set_payload (msg, NULL, 0);
+    json_decref (msg->json);            /* invalidate cached json object */
+    msg->json = NULL;
+    if (!(cp = msg_payload_alloc (msg, size)))
+        return -1;
+    for (int i = 0; i < iovcnt; i++) {
+        if (iov[i].iov_len > 0) {
+            memcpy (cp, iov[i].iov_base, iov[i].iov_len);
+            cp += iov[i].iov_len;
+        }
+    }
+    msg_set_flag (msg, FLUX_MSGFLAG_PAYLOAD);
+    return 0;
+}
+
 static inline void msg_lasterr_reset (flux_msg_t *msg)
 {
     if (msg_validate (msg) == 0) {
@@ -1155,12 +1233,8 @@ flux_msg_t *flux_msg_copy (const flux_msg_t *msg, bool payload)
             goto nomem;
     }
     if (msg->payload) {
-        if (payload) {
-            cpy->payload_size = msg->payload_size;
-            if (!(cpy->payload = malloc (cpy->payload_size)))
-                goto error;
-            memcpy (cpy->payload, msg->payload, msg->payload_size);
-        }
+        if (payload)
+            msg_payload_share (cpy, msg);
         else
             msg_clear_flag (cpy, FLUX_MSGFLAG_PAYLOAD);
     }
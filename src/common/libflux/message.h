@@ -17,6 +17,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/types.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -170,6 +171,15 @@ int flux_msg_get_payload (const flux_msg_t *msg,
                           const void **buf,
                           size_t *size);
 int flux_msg_set_payload (flux_msg_t *msg, const void *buf, size_t size);
+
+/* Set payload to the concatenation of 'iovcnt' buffers in 'iov'.
+ * The buffers are gathered directly into the new payload, so the caller
+ * need not assemble them in a temporary buffer first.
+ * Any old payload is deleted.  A zero total length removes the payload.
+ */
+int flux_msg_set_payload_iov (flux_msg_t *msg,
+                              const struct iovec *iov,
+                              int iovcnt);
 bool flux_msg_has_payload (const flux_msg_t *msg);
 
 /* Test/set/clear message flags
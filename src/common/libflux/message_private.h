@@ -18,6 +18,18 @@
 
 #include "message_proto.h"
 
+/* Payload buffer, shared by a message and its copies from flux_msg_copy().
+ * A shared buffer is immutable:  setting the payload of a message whose
+ * buffer is shared allocates a new buffer for that message.  The refcount
+ * is manipulated atomically since message copies are commonly handed
+ * off to other threads, e.g. broker modules.
+ */
+struct msg_payload {
+    int refcount;
+    size_t size;            // allocated size of data
+    char data[];
+};
+
 struct flux_msg {
     // optional route list, if FLUX_MSGFLAG_ROUTE
     struct list_head routes;
@@ -27,8 +39,9 @@ struct flux_msg {
     char *topic;
 
     // optional payload frame, if FLUX_MSGFLAG_PAYLOAD
-    void *payload;
+    void *payload;          // points to pbuf->data
     size_t payload_size;
+    struct msg_payload *pbuf;
 
     // required proto frame data
     struct proto proto;
@@ -44,6 +57,16 @@ flux_msg_t *msg_create (void);
 
 int msg_frames (const flux_msg_t *msg);
 
+/* Replace msg->payload with a new, unshared buffer of 'size' bytes.
+ * The payload flag is not changed.  Returns the buffer on success, or NULL
+ * on failure with errno set.
+ */
+void *msg_payload_alloc (flux_msg_t *msg, size_t size);
+
+/* Drop msg's reference on its payload buffer, if any.
+ */
+void msg_payload_release (flux_msg_t *msg);
+
 #define msgtype_is_valid(tp) \
     ((tp) == FLUX_MSGTYPE_REQUEST || (tp) == FLUX_MSGTYPE_RESPONSE \
      || (tp) == FLUX_MSGTYPE_EVENT || (tp) == FLUX_MSGTYPE_CONTROL)
@@ -18,6 +18,7 @@
 
 #include "src/common/libutil/errno_safe.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libfluxutil/dispatch_stats.h"
 #include "ccan/str/str.h"
 
 #include "method.h"
@@ -222,13 +223,15 @@ static void method_stats_get_cb (flux_t *h,
                                  void *arg)
 {
     flux_msgcounters_t mcs;
+    json_t *dispatch = NULL;
 
-    if (flux_request_decode (msg, NULL, NULL) < 0)
+    if (flux_request_decode (msg, NULL, NULL) < 0
+        || !(dispatch = dispatch_stats_encode (h)))
         goto error;
     flux_get_msgcounters (h, &mcs);
     if (flux_respond_pack (h,
                            msg,
-                           "{s:{s:i s:i s:i s:i} s:{s:i s:i s:i s:i}}",
+                           "{s:{s:i s:i s:i s:i} s:{s:i s:i s:i s:i} s:O}",
                            "tx",
                              "request", mcs.request_tx,
                              "response", mcs.response_tx,
@@ -238,12 +241,15 @@ static void method_stats_get_cb (flux_t *h,
                              "request", mcs.request_rx,
                              "response", mcs.response_rx,
                              "event", mcs.event_rx,
-                             "control", mcs.control_rx) < 0)
+                             "control", mcs.control_rx,
+                           "dispatch", dispatch) < 0)
         flux_log_error (h, "error responding to stats-get request");
+    json_decref (dispatch);
     return;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "error responding to stats-get request");
+    json_decref (dispatch);
 }
 
 static void method_stats_clear_cb (flux_t *h,
@@ -254,6 +260,7 @@ static void method_stats_clear_cb (flux_t *h,
     if (flux_request_decode (msg, NULL, NULL) < 0)
         goto error;
     flux_clr_msgcounters (h);
+    flux_clr_dispatch_stats (h);
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "error responding to stats-clear request");
     return;
@@ -267,8 +274,10 @@ static void method_stats_clear_event_cb (flux_t *h,
                                          const flux_msg_t *msg,
                                          void *arg)
 {
-    if (flux_event_decode (msg, NULL, NULL) == 0)
+    if (flux_event_decode (msg, NULL, NULL) == 0) {
         flux_clr_msgcounters (h);
+        flux_clr_dispatch_stats (h);
+    }
 }
 
 static void method_config_reload_cb (flux_t *h,
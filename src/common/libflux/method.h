@@ -17,12 +17,14 @@
  *
  * stats-get
  *   Support "flux module stats".
- *   Return flux_t message counters from flux_get_msgcounters(3).
+ *   Return flux_t message counters from flux_get_msgcounters(3),
+ *   and message dispatch histograms from flux_get_dispatch_stats(3).
  *   This method is accessible to guest users.
  *
  * stats-clear
  *   Support "flux module stats --clear".
- *   Clear message counters by calling flux_clr_msgcounters(3).
+ *   Clear message counters by calling flux_clr_msgcounters(3),
+ *   and dispatch histograms by calling flux_clr_dispatch_stats(3).
  *   An event message handler for the same topic string is also registered.
  *   To enable "flux-module stats --clear-all", the caller must also subscribe.
  *   to the event message.
@@ -12,28 +12,70 @@
 #include "config.h"
 #endif
 #include <assert.h>
+#include <limits.h>
+#include <stdlib.h>
 #include <flux/core.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libutil/iterators.h"
 #include "src/common/libutil/errno_safe.h"
+#include "src/common/librouter/subtrie.h"
+
+#include "reactor_private.h"
 
 struct handler_stack {
     flux_msg_handler_t *mh;  // current message handler in stack
     zlistx_t *stack;         // stack of message handlers if >1
 };
 
+/* Handlers not in handlers_rpc or handlers_method are indexed by the
+ * form of their topic glob, so that a message is only compared with
+ * handlers that could match it:
+ * - exact topic strings are hashed
+ * - "prefix*" globs are in a prefix trie (match-any is the "" prefix)
+ * - any other glob is in a list that is scanned for every message
+ */
+enum index_type {
+    INDEX_NONE = 0,
+    INDEX_EXACT,
+    INDEX_PREFIX,
+    INDEX_GLOB,
+};
+
+/* Handlers that might match the message being dispatched, in descending
+ * registration order.  An entry is set to NULL if its handler is destroyed
+ * during delivery.
+ */
+#define CANDIDATES_STATIC 16
+struct candidates {
+    struct flux_msg_handler **v;
+    int count;
+    int size;
+    struct flux_msg_handler *buf[CANDIDATES_STATIC];
+    struct candidates *prev;    // enclosing delivery, if nested
+    int errnum;
+};
+
 struct dispatch {
     flux_t *h;
-    zlist_t *handlers;
     zlist_t *handlers_new;
     zhashx_t *handlers_rpc; // matchtag => response handler
     zhashx_t *handlers_method; // topic => request handler (non-glob only)
+    zhashx_t *handlers_exact; // topic => zlistx of handlers
+    struct subtrie *handlers_prefix; // prefix => handlers
+    zlist_t *handlers_glob; // other globs
+    unsigned int handlers_seq; // registration counter
+    struct candidates *candidates; // deliveries in progress
     flux_watcher_t *w;
     int running_count;
     int usecount;
     zlist_t *unmatched;
+    int batch_max;          // max messages dispatched per handle_cb()
+    bool batch_env;         // batch_max was set by FLUX_DISPATCH_BATCH
+    bool queue_unsupported; // connector lacks FLUX_OPT_RECV_QUEUE_COUNT
+    unsigned int batch_hist[FLUX_DISPATCH_HIST_SIZE];
+    unsigned int queue_hist[FLUX_DISPATCH_HIST_SIZE];
 };
 
 #define HANDLER_MAGIC 0x44433322
@@ -45,6 +87,9 @@ struct flux_msg_handler {
     flux_msg_handler_f fn;
     void *arg;
     uint8_t running:1;
+    enum index_type index;
+    char *prefix;           // INDEX_PREFIX: topic_glob minus trailing '*'
+    unsigned int seq;       // order of indexing, newest is highest
 };
 
 static void handle_cb (flux_reactor_t *r,
@@ -167,6 +212,15 @@ static void method_hash_remove (zhashx_t *hash, flux_msg_handler_t *mh)
     }
 }
 
+static void exact_list_destructor (void **item)
+{
+    if (item && *item) {
+        zlistx_t *l = *item;
+        zlistx_destroy (&l);
+        *item = NULL;
+    }
+}
+
 /* Return true if topic string 's' could match multiple request topics,
  * e.g. contains a glob character, or is NULL or "" which match anything.
  */
@@ -199,10 +253,15 @@ static void dispatch_usecount_decr (struct dispatch *d)
             dispatch_requeue (d);
         if (d->unmatched)
             zlist_destroy (&d->unmatched);
-        if (d->handlers) {
-            assert (zlist_size (d->handlers) == 0);
-            zlist_destroy (&d->handlers);
+        if (d->handlers_exact) {
+            assert (zhashx_size (d->handlers_exact) == 0);
+            zhashx_destroy (&d->handlers_exact);
+        }
+        if (d->handlers_glob) {
+            assert (zlist_size (d->handlers_glob) == 0);
+            zlist_destroy (&d->handlers_glob);
         }
+        subtrie_destroy (d->handlers_prefix);
         if (d->handlers_new) {
             assert (zlist_size (d->handlers_new) == 0);
             zlist_destroy (&d->handlers_new);
@@ -239,6 +298,28 @@ static void dispatch_destroy (void *arg)
     dispatch_usecount_decr (d);
 }
 
+/* Return the batch size set with FLUX_DISPATCH_BATCH, or 0 if unset
+ * or invalid.
+ */
+static int getenv_batch (void)
+{
+    const char *s = getenv ("FLUX_DISPATCH_BATCH");
+    char *endptr;
+    long count;
+
+    if (!s)
+        return 0;
+    errno = 0;
+    count = strtol (s, &endptr, 10);
+    if (errno != 0
+        || endptr == s
+        || *endptr != '\0'
+        || count < 1
+        || count > INT_MAX)
+        return 0;
+    return count;
+}
+
 static struct dispatch *dispatch_get (flux_t *h)
 {
     struct dispatch *d = flux_aux_get (h, "flux::dispatch");
@@ -248,8 +329,16 @@ static struct dispatch *dispatch_get (flux_t *h)
             return NULL;
         memset (d, 0, sizeof (*d));
         d->usecount = 1;
-        if (!(d->handlers = zlist_new ()))
+        if ((d->batch_max = getenv_batch ()) > 0)
+            d->batch_env = true;
+        else
+            d->batch_max = 1;
+        if (!(d->handlers_exact = zhashx_new ())
+            || !(d->handlers_glob = zlist_new ()))
             goto nomem;
+        zhashx_set_destructor (d->handlers_exact, exact_list_destructor);
+        if (!(d->handlers_prefix = subtrie_create ()))
+            goto error;
         if (!(d->handlers_new = zlist_new ()))
             goto nomem;
         d->h = h;
@@ -333,12 +422,215 @@ static void call_handler (flux_msg_handler_t *mh, const flux_msg_t *msg)
     mh->fn (mh->d->h, mh, msg, mh->arg);
 }
 
+static enum index_type get_index_type (const char *glob)
+{
+    size_t len;
+
+    if (!glob || (len = strlen (glob)) == 0)
+        return INDEX_PREFIX;
+    if (!strpbrk (glob, "*?["))
+        return INDEX_EXACT;
+    if (glob[len - 1] == '*' && strcspn (glob, "*?[\\") == len - 1)
+        return INDEX_PREFIX;
+    return INDEX_GLOB;
+}
+
+static int index_add (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    enum index_type type = get_index_type (mh->match.topic_glob);
+    const char *glob = mh->match.topic_glob;
+    zlistx_t *l;
+
+    switch (type) {
+        case INDEX_EXACT:
+            if (!(l = zhashx_lookup (d->handlers_exact, glob))) {
+                if (!(l = zlistx_new ()))
+                    goto nomem;
+                (void)zhashx_insert (d->handlers_exact, glob, l);
+            }
+            if (!zlistx_add_end (l, mh)) {
+                if (zlistx_size (l) == 0)
+                    zhashx_delete (d->handlers_exact, glob);
+                goto nomem;
+            }
+            break;
+        case INDEX_PREFIX:
+            if (!(mh->prefix = strndup (glob ? glob : "",
+                                        glob ? strlen (glob) - 1 : 0)))
+                goto nomem;
+            if (subtrie_insert (d->handlers_prefix, mh->prefix, mh) < 0) {
+                ERRNO_SAFE_WRAP (free, mh->prefix);
+                mh->prefix = NULL;
+                return -1;
+            }
+            break;
+        case INDEX_GLOB:
+            if (zlist_append (d->handlers_glob, mh) < 0)
+                goto nomem;
+            break;
+        case INDEX_NONE:
+            break;
+    }
+    mh->index = type;
+    mh->seq = ++d->handlers_seq;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static void index_remove (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    zlistx_t *l;
+    void *handle;
+
+    switch (mh->index) {
+        case INDEX_EXACT:
+            if ((l = zhashx_lookup (d->handlers_exact, mh->match.topic_glob))
+                && (handle = zlistx_find (l, mh))) {
+                zlistx_delete (l, handle);
+                if (zlistx_size (l) == 0)
+                    zhashx_delete (d->handlers_exact, mh->match.topic_glob);
+            }
+            break;
+        case INDEX_PREFIX:
+            (void)subtrie_remove (d->handlers_prefix, mh->prefix, mh);
+            free (mh->prefix);
+            mh->prefix = NULL;
+            break;
+        case INDEX_GLOB:
+            zlist_remove (d->handlers_glob, mh);
+            break;
+        case INDEX_NONE:
+            break;
+    }
+    mh->index = INDEX_NONE;
+}
+
+/* Index handlers created since the last call, in creation order.
+ */
+static int index_new_handlers (struct dispatch *d)
+{
+    flux_msg_handler_t *mh;
+
+    while ((mh = zlist_pop (d->handlers_new))) {
+        if (index_add (d, mh) < 0) {
+            int saved_errno = errno;
+            (void)zlist_push (d->handlers_new, mh);
+            errno = saved_errno;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void candidates_init (struct candidates *c)
+{
+    c->v = c->buf;
+    c->count = 0;
+    c->size = CANDIDATES_STATIC;
+    c->prev = NULL;
+    c->errnum = 0;
+}
+
+static void candidates_free (struct candidates *c)
+{
+    if (c->v != c->buf)
+        free (c->v);
+}
+
+static void candidates_add (struct candidates *c, flux_msg_handler_t *mh)
+{
+    if (c->count == c->size) {
+        int size = c->size * 2;
+        flux_msg_handler_t **v;
+
+        if (!(v = malloc (size * sizeof (v[0])))) {
+            c->errnum = ENOMEM;
+            return;
+        }
+        memcpy (v, c->v, c->count * sizeof (v[0]));
+        candidates_free (c);
+        c->v = v;
+        c->size = size;
+    }
+    c->v[c->count++] = mh;
+}
+
+// subtrie_match_f footprint
+static void candidates_add_cb (void *subscriber, void *arg)
+{
+    candidates_add (arg, subscriber);
+}
+
+static int candidates_cmp (const void *a, const void *b)
+{
+    const flux_msg_handler_t *mh1 = *(flux_msg_handler_t **)a;
+    const flux_msg_handler_t *mh2 = *(flux_msg_handler_t **)b;
+
+    if (mh1->seq > mh2->seq)
+        return -1;
+    if (mh1->seq < mh2->seq)
+        return 1;
+    return 0;
+}
+
+/* Clear 'mh' from any deliveries in progress before it is freed.
+ */
+static void candidates_forget (struct dispatch *d, flux_msg_handler_t *mh)
+{
+    struct candidates *c;
+
+    for (c = d->candidates; c != NULL; c = c->prev) {
+        for (int i = 0; i < c->count; i++) {
+            if (c->v[i] == mh)
+                c->v[i] = NULL;
+        }
+    }
+}
+
+/* Find indexed handlers that might match 'msg', newest first.
+ */
+static int index_lookup (struct dispatch *d,
+                         const flux_msg_t *msg,
+                         struct candidates *c)
+{
+    const char *topic;
+    zlistx_t *l;
+    flux_msg_handler_t *mh;
+
+    if (flux_msg_get_topic (msg, &topic) < 0)
+        topic = NULL;
+    if (topic && (l = zhashx_lookup (d->handlers_exact, topic))) {
+        mh = zlistx_first (l);
+        while (mh) {
+            candidates_add (c, mh);
+            mh = zlistx_next (l);
+        }
+    }
+    (void)subtrie_match (d->handlers_prefix,
+                         topic ? topic : "",
+                         candidates_add_cb,
+                         c);
+    FOREACH_ZLIST (d->handlers_glob, mh) {
+        candidates_add (c, mh);
+    }
+    if (c->errnum != 0) {
+        errno = c->errnum;
+        return -1;
+    }
+    if (c->count > 1)
+        qsort (c->v, c->count, sizeof (c->v[0]), candidates_cmp);
+    return 0;
+}
+
 /* Messages are matched in the following order:
  * 1) RPC responses - lookup in handlers_rpc hash by matchtag.
  * 2) RPC requests - lookup in handlers_method hash by topic string
- * 3) Requests and responses not matched above - sent to first match in
- *    list of handlers, where most recently registered handlers match first.
- * 4) Events - sent to all matches in list of handlers
+ * 3) Requests and responses not matched above - sent to first match
+ *    among indexed handlers, where most recently registered handlers
+ *    match first.
+ * 4) Events - sent to all matching indexed handlers, newest first
  */
 static bool dispatch_message (struct dispatch *d,
                               const flux_msg_t *msg,
@@ -372,8 +664,19 @@ static bool dispatch_message (struct dispatch *d,
     }
     /* other */
     if (!match) {
-        FOREACH_ZLIST (d->handlers, mh) {
-            if (!mh->running)
+        struct candidates c;
+
+        candidates_init (&c);
+        c.prev = d->candidates;
+        d->candidates = &c;
+        if (index_lookup (d, msg, &c) < 0) {
+            const char *topic = "unknown";
+            (void)flux_msg_get_topic (msg, &topic);
+            flux_log_error (d->h, "dispatch %s", topic);
+            c.count = 0;
+        }
+        for (int i = 0; i < c.count; i++) {
+            if (!(mh = c.v[i]) || !mh->running)
                 continue;
             if (flux_msg_cmp (msg, mh->match)) {
                 call_handler (mh, msg);
@@ -383,6 +686,8 @@ static bool dispatch_message (struct dispatch *d,
                 }
             }
         }
+        d->candidates = c.prev;
+        candidates_free (&c);
     }
     return match;
 }
@@ -411,54 +716,30 @@ static void handle_late_response (struct dispatch *d, const flux_msg_t *msg)
         fprintf (stderr, "MATCHDEBUG: reclaimed matchtag=%d\n", matchtag);
 }
 
-static int transfer_items_zlist (zlist_t *from, zlist_t *to)
-{
-    void *item;
-    int rc = -1;
-
-    while ((item = zlist_pop (from))) {
-        if (zlist_push (to, item) < 0) {
-            errno = ENOMEM;
-            goto done;
-        }
-    }
-    rc = 0;
-done:
-    return rc;
-}
-
-static void handle_cb (flux_reactor_t *r,
-                       flux_watcher_t *hw,
-                       int revents,
-                       void *arg)
+/* Receive one message and dispatch it.
+ * Return 1 if a message was dispatched, 0 if none was available,
+ * or -1 on fatal error.
+ */
+static int dispatch_one (struct dispatch *d)
 {
-    struct dispatch *d = arg;
-    flux_msg_t *msg = NULL;
+    flux_msg_t *msg;
     int rc = -1;
     int type;
     bool match;
     const char *topic;
 
-    if (revents & FLUX_POLLERR)
-        goto done;
     if (!(msg = flux_recv (d->h, FLUX_MATCH_ANY, FLUX_O_NONBLOCK))) {
-        if (errno == EAGAIN && errno == EWOULDBLOCK)
-            rc = 0; /* ignore spurious wakeup */
-        goto done;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        return -1;
     }
     if (flux_msg_get_type (msg, &type) < 0) {
-        rc = 0; /* ignore mangled message */
+        rc = 1; /* ignore mangled message */
         goto done;
     }
     if (flux_msg_get_topic (msg, &topic) < 0)
         topic = "unknown"; /* used for logging */
 
-    /* Add any new handlers here, making handler creation
-     * safe to call during handlers list traversal below.
-     */
-    if (transfer_items_zlist (d->handlers_new, d->handlers) < 0)
-        goto done;
-
     match = dispatch_message (d, msg, type);
 
     /* Message was not "consumed".
@@ -466,7 +747,7 @@ static void handle_cb (flux_reactor_t *r,
      * Otherwise, respond with ENOSYS if it was a request,
      * or log it if FLUX_O_TRACE.
      */
-    if (!match) {
+    if (!match && d->h) {
         if ((flux_flags_get (d->h) & FLUX_O_CLONE)) {
             if (!d->unmatched && !(d->unmatched = zlist_new ())) {
                 errno = ENOMEM;
@@ -506,11 +787,90 @@ static void handle_cb (flux_reactor_t *r,
             }
         }
     }
-    rc = 0;
+    rc = 1;
 done:
-    if (rc < 0)
-        flux_reactor_stop_error (r);
     flux_msg_destroy (msg);
+    return rc;
+}
+
+static int hist_bucket (size_t val)
+{
+    int i = 0;
+
+    while (val > 0 && i < FLUX_DISPATCH_HIST_SIZE - 1) {
+        val >>= 1;
+        i++;
+    }
+    return i;
+}
+
+/* Sample the connector receive queue depth, if the connector supports it.
+ */
+static void sample_queue_depth (struct dispatch *d)
+{
+    size_t count;
+
+    if (d->queue_unsupported)
+        return;
+    if (flux_opt_get (d->h,
+                      FLUX_OPT_RECV_QUEUE_COUNT,
+                      &count,
+                      sizeof (count)) < 0) {
+        d->queue_unsupported = true;
+        return;
+    }
+    d->queue_hist[hist_bucket (count)]++;
+}
+
+/* Dispatch up to d->batch_max messages.  The batch ends early if the
+ * queue is empty, the last handler is stopped, the handle is destroyed,
+ * or a handler stops the reactor.  If messages remain, the handle watcher
+ * stays ready and is called again on the next loop iteration, after other
+ * ready watchers have run.
+ */
+static void handle_cb (flux_reactor_t *r,
+                       flux_watcher_t *hw,
+                       int revents,
+                       void *arg)
+{
+    struct dispatch *d = arg;
+    int count = 0;
+    int rc;
+
+    if (revents & FLUX_POLLERR)
+        goto error;
+
+    /* Hold a reference on 'd' in case a handler destroys the handle.
+     */
+    dispatch_usecount_incr (d);
+    sample_queue_depth (d);
+
+    /* Add any new handlers here, making handler creation
+     * safe to call during handlers list traversal.  Within a batch,
+     * only repeat this if a handler was created by the previous message.
+     */
+    if (index_new_handlers (d) < 0)
+        goto error_decr;
+    while (count < d->batch_max) {
+        if (count > 0
+            && zlist_size (d->handlers_new) > 0
+            && index_new_handlers (d) < 0)
+            goto error_decr;
+        if ((rc = dispatch_one (d)) < 0)
+            goto error_decr;
+        if (rc == 0)
+            break;
+        count++;
+        if (!d->h || d->running_count == 0 || reactor_is_stopped (r))
+            break;
+    }
+    d->batch_hist[hist_bucket (count)]++;
+    dispatch_usecount_decr (d);
+    return;
+error_decr:
+    dispatch_usecount_decr (d);
+error:
+    flux_reactor_stop_error (r);
 }
 
 void flux_msg_handler_start (flux_msg_handler_t *mh)
@@ -581,7 +941,8 @@ void flux_msg_handler_destroy (flux_msg_handler_t *mh)
         }
         else {
             zlist_remove (mh->d->handlers_new, mh);
-            zlist_remove (mh->d->handlers, mh);
+            index_remove (mh->d, mh);
+            candidates_forget (mh->d, mh);
         }
         flux_msg_handler_stop (mh);
         dispatch_usecount_decr (mh->d);
@@ -634,14 +995,14 @@ flux_msg_handler_t *flux_msg_handler_create (flux_t *h,
             goto error;
     }
     /* Request (glob), response (FLUX_MATCHTAG_NONE), events:
-     * Message handler is pushed to the front of the handlers list,
-     * and matches before older ones for requests and responses.
+     * Message handler is indexed by topic glob, and matches before
+     * older ones for requests and responses.
      * (Requests and responses in hashes above match first though).
      * Event messages are broadcast to all matching handlers.
      */
     else {
-        /* N.B. append(handlers_new); later, pop(handlers_new), push(handlers).
-         * Net effect: push(handlers).
+        /* N.B. Indexing is deferred to handle_cb(), so handlers may be
+         * created during dispatch.
          */
         if (zlist_append (d->handlers_new, mh) < 0) {
             errno = ENOMEM;
@@ -747,6 +1108,45 @@ flux_watcher_t *flux_get_handle_watcher (flux_t *h)
     return d ? d->w : NULL;
 }
 
+int flux_dispatch_set_batch (flux_t *h, int count)
+{
+    struct dispatch *d;
+
+    if (!h || count < 1) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(d = dispatch_get (h)))
+        return -1;
+    if (!d->batch_env)
+        d->batch_max = count;
+    return 0;
+}
+
+void flux_get_dispatch_stats (flux_t *h, flux_dispatch_stats_t *stats)
+{
+    struct dispatch *d;
+
+    if (!stats)
+        return;
+    memset (stats, 0, sizeof (*stats));
+    if (!h || !(d = dispatch_get (h)))
+        return;
+    stats->batch_max = d->batch_max;
+    memcpy (stats->batch, d->batch_hist, sizeof (stats->batch));
+    memcpy (stats->queue, d->queue_hist, sizeof (stats->queue));
+}
+
+void flux_clr_dispatch_stats (flux_t *h)
+{
+    struct dispatch *d;
+
+    if (h && (d = dispatch_get (h))) {
+        memset (d->batch_hist, 0, sizeof (d->batch_hist));
+        memset (d->queue_hist, 0, sizeof (d->queue_hist));
+    }
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -65,6 +65,28 @@ int flux_dispatch_requeue (flux_t *h);
 // accessor for start/stop/ref/unref
 flux_watcher_t *flux_get_handle_watcher (flux_t *h);
 
+/* Dispatch up to 'count' messages each time the handle watcher is ready,
+ * rather than one.  Messages beyond 'count' are left for the next reactor
+ * loop iteration so other watchers get a turn.  The default is 1.
+ * FLUX_DISPATCH_BATCH in the environment overrides 'count' if set.
+ */
+int flux_dispatch_set_batch (flux_t *h, int count);
+
+/* Dispatch statistics are histograms with power of two buckets.
+ * Bucket 0 counts zero, bucket i > 0 counts values in [2^(i-1), 2^i),
+ * and the last bucket also counts anything larger.
+ */
+#define FLUX_DISPATCH_HIST_SIZE 10
+
+typedef struct {
+    int batch_max;
+    unsigned int batch[FLUX_DISPATCH_HIST_SIZE]; // messages per wakeup
+    unsigned int queue[FLUX_DISPATCH_HIST_SIZE]; // recv queue depth at wakeup
+} flux_dispatch_stats_t;
+
+void flux_get_dispatch_stats (flux_t *h, flux_dispatch_stats_t *stats);
+void flux_clr_dispatch_stats (flux_t *h);
+
 #ifdef __cplusplus
 }
 #endif
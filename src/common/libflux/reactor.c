@@ -24,6 +24,7 @@ struct flux_reactor {
     struct ev_loop *loop;
     int usecount;
     unsigned int errflag:1;
+    unsigned int stopflag:1;
 };
 
 static int valid_flags (int flags, int valid)
@@ -88,6 +89,7 @@ int flux_reactor_run (flux_reactor_t *r, int flags)
     if (flags & FLUX_REACTOR_ONCE)
         ev_flags |= EVRUN_ONCE;
     r->errflag = 0;
+    r->stopflag = 0;
     count = ev_run (r->loop, ev_flags);
     return (r->errflag ? -1 : count);
 }
@@ -110,12 +112,14 @@ void flux_reactor_now_update (flux_reactor_t *r)
 void flux_reactor_stop (flux_reactor_t *r)
 {
     r->errflag = 0;
+    r->stopflag = 1;
     ev_break (r->loop, EVBREAK_ALL);
 }
 
 void flux_reactor_stop_error (flux_reactor_t *r)
 {
     r->errflag = 1;
+    r->stopflag = 1;
     ev_break (r->loop, EVBREAK_ALL);
 }
 
@@ -124,6 +128,11 @@ void *reactor_get_loop (flux_reactor_t *r)
     return r ? r->loop : NULL;
 }
 
+bool reactor_is_stopped (flux_reactor_t *r)
+{
+    return r ? r->stopflag : false;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
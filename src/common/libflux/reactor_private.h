@@ -11,11 +11,19 @@
 #ifndef _FLUX_CORE_REACTOR_PRIVATE_H
 #define _FLUX_CORE_REACTOR_PRIVATE_H
 
+#include <stdbool.h>
+
 #include "reactor.h"
 
 /* retrieve underlying loop implementation - for watcher_wrap.c only */
 void *reactor_get_loop (flux_reactor_t *r);
 
+/* Return true if flux_reactor_stop() or flux_reactor_stop_error() was
+ * called since the reactor last started running, so a callback that
+ * processes work in a loop can return promptly.
+ */
+bool reactor_is_stopped (flux_reactor_t *r);
+
 #endif /* !_FLUX_CORE_REACTOR_PRIVATE_H */
 
 /*
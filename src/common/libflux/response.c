@@ -310,6 +310,28 @@ int flux_respond_raw (flux_t *h,
     return 0;
 }
 
+int flux_respond_raw_iov (flux_t *h,
+                          const flux_msg_t *request,
+                          const struct iovec *iov,
+                          int iovcnt)
+{
+    flux_msg_t *msg;
+
+    if (!h || !request) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (flux_msg_is_noresponse (request))
+        return 0;
+    if (!(msg = flux_response_derive (request, 0))
+        || flux_msg_set_payload_iov (msg, iov, iovcnt) < 0
+        || flux_send_new (h, &msg, 0) < 0) {
+        flux_msg_destroy (msg);
+        return -1;
+    }
+    return 0;
+}
+
 int flux_respond_error (flux_t *h,
                         const flux_msg_t *request,
                         int errnum,
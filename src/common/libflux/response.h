@@ -91,6 +91,14 @@ int flux_respond_raw (flux_t *h,
                       const void *data,
                       int len);
 
+/* Create a response to the provided request message with a raw payload
+ * gathered from 'iovcnt' buffers in 'iov'.
+ */
+int flux_respond_raw_iov (flux_t *h,
+                          const flux_msg_t *request,
+                          const struct iovec *iov,
+                          int iovcnt);
+
 /* Create an error response to the provided request message with optional
  * error string payload (if errstr is non-NULL).  If errnum is zero, EINVAL
  * is substituted.
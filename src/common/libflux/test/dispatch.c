@@ -12,9 +12,13 @@
 #include "config.h"
 #endif
 #include <errno.h>
+#include <stdlib.h>
+#include <jansson.h>
 #include <flux/core.h>
 
 #include "src/common/libutil/xzmalloc.h"
+#include "src/common/libfluxutil/dispatch_stats.h"
+#include "ccan/str/str.h"
 #include "src/common/libtap/tap.h"
 
 int cb2_called;
@@ -516,6 +520,349 @@ void test_cloned_dispatch (flux_t *orig)
     diag ("destroyed reactor, closed clone");
 }
 
+static int batch_count;
+static flux_msg_handler_t *batch_late_mh;
+
+void batch_cb (flux_t *h,
+               flux_msg_handler_t *mh,
+               const flux_msg_t *msg,
+               void *arg)
+{
+    const char *action = arg;
+
+    batch_count++;
+    if (!action)
+        return;
+    if (streq (action, "stop"))
+        flux_reactor_stop (flux_get_reactor (h));
+    else if (streq (action, "stop-handler"))
+        flux_msg_handler_stop (mh);
+    else if (streq (action, "create")) {
+        struct flux_match match = FLUX_MATCH_EVENT;
+        match.topic_glob = "late.*";
+        if (!(batch_late_mh = flux_msg_handler_create (h,
+                                                       match,
+                                                       cb2,
+                                                       NULL)))
+            BAIL_OUT ("flux_msg_handler_create failed");
+        flux_msg_handler_start (batch_late_mh);
+    }
+}
+
+static int send_events (flux_t *h, const char *topic, int count)
+{
+    for (int i = 0; i < count; i++) {
+        flux_msg_t *msg;
+        if (!(msg = flux_event_encode (topic, NULL))
+            || flux_send_new (h, &msg, 0) < 0) {
+            flux_msg_destroy (msg);
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Check that up to batch_max messages are dispatched per handle watcher
+ * callback, and that the batch ends early when a handler stops the reactor
+ * or the last running handler.
+ */
+void test_batch (void)
+{
+    flux_t *h;
+    flux_reactor_t *r;
+    flux_msg_handler_t *mh;
+    struct flux_match match = FLUX_MATCH_EVENT;
+    flux_dispatch_stats_t stats;
+    json_t *o;
+    int batch_max, batch_small, batch_large, batch_huge, queue_depth;
+
+    (void)unsetenv ("FLUX_DISPATCH_BATCH");
+    if (!(h = flux_open ("loop://", 0)) || !(r = flux_get_reactor (h)))
+        BAIL_OUT ("can't continue without loop handle");
+
+    errno = 0;
+    ok (flux_dispatch_set_batch (NULL, 4) < 0 && errno == EINVAL,
+        "flux_dispatch_set_batch h=NULL fails with EINVAL");
+    errno = 0;
+    ok (flux_dispatch_set_batch (h, 0) < 0 && errno == EINVAL,
+        "flux_dispatch_set_batch count=0 fails with EINVAL");
+    flux_get_dispatch_stats (h, &stats);
+    ok (stats.batch_max == 1,
+        "batch_max is 1 by default");
+    ok (flux_dispatch_set_batch (h, 4) == 0,
+        "flux_dispatch_set_batch count=4 works");
+
+    match.topic_glob = "batch.*";
+    if (!(mh = flux_msg_handler_create (h, match, batch_cb, NULL)))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh);
+
+    /* 10 messages are dispatched 4, 4, 2.
+     */
+    ok (send_events (h, "batch.a", 10) == 0,
+        "sent 10 events");
+    batch_count = 0;
+    ok (flux_reactor_run (r, FLUX_REACTOR_ONCE) >= 0 && batch_count == 4,
+        "first loop iteration dispatched 4 messages");
+    ok (flux_reactor_run (r, FLUX_REACTOR_ONCE) >= 0 && batch_count == 8,
+        "second loop iteration dispatched 4 messages");
+    ok (flux_reactor_run (r, FLUX_REACTOR_ONCE) >= 0 && batch_count == 10,
+        "third loop iteration dispatched 2 messages");
+    flux_get_dispatch_stats (h, &stats);
+    ok (stats.batch_max == 4,
+        "batch_max is 4");
+    ok (stats.batch[3] == 2 && stats.batch[2] == 1,
+        "batch histogram counts two batches of 4-7 and one of 2-3");
+    ok (stats.queue[4] == 1 && stats.queue[3] == 1 && stats.queue[2] == 1,
+        "queue histogram counts depths 10, 6, and 2");
+    ok ((o = dispatch_stats_encode (h)) != NULL
+        && json_unpack (o,
+                        "{s:i s:{s:i s:i s:i} s:{s:i}}",
+                        "batch-max", &batch_max,
+                        "batch",
+                          "2-3", &batch_small,
+                          "4-7", &batch_large,
+                          "256+", &batch_huge,
+                        "queue",
+                          "8-15", &queue_depth) == 0
+        && batch_max == 4
+        && batch_small == 1
+        && batch_large == 2
+        && batch_huge == 0
+        && queue_depth == 1,
+        "dispatch_stats_encode works");
+    json_decref (o);
+    flux_clr_dispatch_stats (h);
+    flux_get_dispatch_stats (h, &stats);
+    ok (stats.batch[3] == 0 && stats.queue[4] == 0 && stats.batch_max == 4,
+        "flux_clr_dispatch_stats cleared histograms but not batch_max");
+
+    /* A handler that stops the reactor ends the batch.
+     */
+    flux_msg_handler_destroy (mh);
+    if (!(mh = flux_msg_handler_create (h, match, batch_cb, "stop")))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh);
+    ok (send_events (h, "batch.b", 3) == 0,
+        "sent 3 events");
+    batch_count = 0;
+    ok (flux_reactor_run (r, 0) >= 0 && batch_count == 1,
+        "handler that stopped the reactor ended the batch");
+    batch_count = 0;
+    ok (flux_reactor_run (r, 0) >= 0 && batch_count == 1,
+        "next message was dispatched on the next run");
+    batch_count = 0;
+    ok (flux_reactor_run (r, 0) >= 0 && batch_count == 1,
+        "last message was dispatched on the run after that");
+
+    /* A handler that stops itself (the last running handler) ends the batch.
+     */
+    flux_msg_handler_destroy (mh);
+    if (!(mh = flux_msg_handler_create (h, match, batch_cb, "stop-handler")))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh);
+    ok (send_events (h, "batch.d", 2) == 0,
+        "sent 2 events");
+    batch_count = 0;
+    ok (flux_reactor_run (r, FLUX_REACTOR_NOWAIT) >= 0 && batch_count == 1,
+        "handler that stopped itself ended the batch");
+    flux_msg_handler_start (mh);
+    batch_count = 0;
+    ok (flux_reactor_run (r, FLUX_REACTOR_NOWAIT) >= 0 && batch_count == 1,
+        "remaining message was dispatched after restart");
+
+    /* A handler registered during a batch matches later messages in it.
+     */
+    flux_msg_handler_destroy (mh);
+    if (!(mh = flux_msg_handler_create (h, match, batch_cb, "create")))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh);
+    ok (send_events (h, "batch.c", 1) == 0 && send_events (h, "late.a", 1) == 0,
+        "sent batch.c and late.a events");
+    batch_count = 0;
+    cb2_called = 0;
+    ok (flux_reactor_run (r, FLUX_REACTOR_ONCE) >= 0
+        && batch_count == 1
+        && cb2_called == 1,
+        "handler created in a batch received the next message in it");
+
+    flux_msg_handler_destroy (batch_late_mh);
+    flux_msg_handler_destroy (mh);
+    flux_close (h);
+}
+
+/* Check that FLUX_DISPATCH_BATCH overrides flux_dispatch_set_batch().
+ */
+void test_batch_env (void)
+{
+    flux_t *h;
+    flux_dispatch_stats_t stats;
+
+    setenv ("FLUX_DISPATCH_BATCH", "8", 1);
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("can't continue without loop handle");
+    ok (flux_dispatch_set_batch (h, 2) == 0,
+        "flux_dispatch_set_batch count=2 works");
+    flux_get_dispatch_stats (h, &stats);
+    ok (stats.batch_max == 8,
+        "FLUX_DISPATCH_BATCH=8 overrides it");
+    flux_close (h);
+
+    setenv ("FLUX_DISPATCH_BATCH", "foo", 1);
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("can't continue without loop handle");
+    ok (flux_dispatch_set_batch (h, 2) == 0,
+        "flux_dispatch_set_batch count=2 works");
+    flux_get_dispatch_stats (h, &stats);
+    ok (stats.batch_max == 2,
+        "FLUX_DISPATCH_BATCH=foo is ignored");
+    flux_close (h);
+    (void)unsetenv ("FLUX_DISPATCH_BATCH");
+}
+
+static char index_trace[64];
+static flux_msg_handler_t *index_victim;
+
+void index_cb (flux_t *h,
+               flux_msg_handler_t *mh,
+               const flux_msg_t *msg,
+               void *arg)
+{
+    const char *label = arg;
+
+    if (strlen (index_trace) + strlen (label) < sizeof (index_trace))
+        strcat (index_trace, label);
+    if (streq (label, "K")) {
+        flux_msg_handler_destroy (index_victim);
+        index_victim = NULL;
+    }
+    else if (streq (label, "S"))
+        flux_msg_handler_destroy (mh);
+}
+
+static flux_msg_handler_t *index_handler (flux_t *h,
+                                          struct flux_match match,
+                                          const char *topic_glob,
+                                          const char *label)
+{
+    flux_msg_handler_t *mh;
+
+    match.topic_glob = (char *)topic_glob;
+    if (!(mh = flux_msg_handler_create (h, match, index_cb, (void *)label)))
+        BAIL_OUT ("flux_msg_handler_create failed");
+    flux_msg_handler_start (mh);
+    return mh;
+}
+
+static const char *index_run (flux_t *h, const char *type, const char *topic)
+{
+    flux_msg_t *msg;
+
+    index_trace[0] = '\0';
+    if (streq (type, "event"))
+        msg = flux_event_encode (topic, NULL);
+    else
+        msg = flux_request_encode (topic, NULL);
+    if (!msg || flux_send_new (h, &msg, 0) < 0)
+        BAIL_OUT ("failed to send %s %s", type, topic);
+    if (flux_reactor_run (flux_get_reactor (h), FLUX_REACTOR_NOWAIT) < 0)
+        BAIL_OUT ("flux_reactor_run failed");
+    return index_trace;
+}
+
+/* Glob and event handlers are indexed by the form of their topic glob.
+ * Check that every form matches, that events are delivered newest first,
+ * that requests go to the newest matching glob, and that a handler may
+ * destroy itself or a pending handler during event delivery.
+ */
+void test_index (void)
+{
+    flux_t *h;
+    struct flux_match ev = FLUX_MATCH_EVENT;
+    struct flux_match req = FLUX_MATCH_REQUEST;
+    flux_msg_handler_t *mh[8];
+    flux_msg_handler_t *mh_req[3];
+    flux_msg_handler_t *mh_k;
+    const char *trace;
+
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("can't continue without loop handle");
+
+    mh[0] = index_handler (h, ev, "idx.foo", "a");    // exact
+    mh[1] = index_handler (h, ev, "idx.*", "b");      // prefix
+    mh[2] = index_handler (h, ev, NULL, "c");         // match-any
+    mh[3] = index_handler (h, ev, "idx.?oo", "d");    // glob
+    mh[4] = index_handler (h, ev, "idx.bar", "e");    // exact
+    mh[5] = index_handler (h, ev, "idx.f*", "f");     // prefix
+    mh[6] = index_handler (h, ev, "i*x.foo", "g");    // glob
+    mh[7] = index_handler (h, ev, "esc.\\*", "h");    // glob (escaped)
+
+    trace = index_run (h, "event", "idx.foo");
+    ok (streq (trace, "gfdcba"),
+        "idx.foo event delivered to matching handlers newest first");
+    diag ("%s", trace);
+    trace = index_run (h, "event", "idx.bar");
+    ok (streq (trace, "ecb"),
+        "idx.bar event delivered to exact, prefix, match-any handlers");
+    diag ("%s", trace);
+    trace = index_run (h, "event", "idx");
+    ok (streq (trace, "c"),
+        "idx event delivered to match-any handler only");
+    diag ("%s", trace);
+    trace = index_run (h, "event", "esc.x");
+    ok (streq (trace, "c"),
+        "esc.x event is not matched by escaped glob");
+    trace = index_run (h, "event", "esc.*");
+    ok (streq (trace, "hc"),
+        "esc.* event is matched by escaped glob");
+
+    flux_msg_handler_stop (mh[1]);
+    flux_msg_handler_destroy (mh[3]);
+    trace = index_run (h, "event", "idx.foo");
+    ok (streq (trace, "gfca"),
+        "stopped and destroyed handlers are skipped");
+    diag ("%s", trace);
+    flux_msg_handler_start (mh[1]);
+
+    mh_req[0] = index_handler (h, req, "req.*", "x");
+    mh_req[1] = index_handler (h, req, "req.?", "y");
+    trace = index_run (h, "request", "req.a");
+    ok (streq (trace, "y"),
+        "request is delivered to newest matching glob only");
+    mh_req[2] = index_handler (h, req, "r*", "z");
+    trace = index_run (h, "request", "req.a");
+    ok (streq (trace, "z"),
+        "request is delivered to newer prefix glob");
+    trace = index_run (h, "request", "req.ab");
+    ok (streq (trace, "z"),
+        "request not matching complex glob goes to prefix glob");
+    flux_msg_handler_destroy (mh_req[2]);
+    trace = index_run (h, "request", "req.ab");
+    ok (streq (trace, "x"),
+        "request goes to older prefix glob after newer is destroyed");
+    for (int i = 0; i < 2; i++)
+        flux_msg_handler_destroy (mh_req[i]);
+
+    index_victim = mh[0];
+    mh_k = index_handler (h, ev, "idx.foo", "K");
+    (void)index_handler (h, ev, "idx.*", "S"); // destroys itself
+    trace = index_run (h, "event", "idx.foo");
+    ok (streq (trace, "SKgfcb"),
+        "handlers destroyed during event delivery are not called");
+    diag ("%s", trace);
+    trace = index_run (h, "event", "idx.foo");
+    ok (streq (trace, "Kgfcb"),
+        "self-destroyed handler is gone on next delivery");
+    diag ("%s", trace);
+
+    flux_msg_handler_destroy (mh_k);
+    for (int i = 1; i < 8; i++) {
+        if (i != 3)
+            flux_msg_handler_destroy (mh[i]);
+    }
+    flux_close (h);
+}
+
 int main (int argc, char *argv[])
 {
     flux_t *h;
@@ -535,6 +882,9 @@ int main (int argc, char *argv[])
     test_request_catchall (h);
     test_response_catchall (h);
     test_response_with_routes (h);
+    test_batch ();
+    test_batch_env ();
+    test_index ();
 
     flux_close (h);
     done_testing();
@@ -714,6 +714,54 @@ void check_payload (void)
     flux_msg_destroy (msg);
 }
 
+/* flux_msg_set_payload_iov
+ */
+void check_payload_iov (void)
+{
+    flux_msg_t *msg;
+    struct iovec iov[3];
+    const void *buf;
+    size_t len;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_RESPONSE)))
+        BAIL_OUT ("flux_msg_create failed");
+    iov[0].iov_base = "abc";
+    iov[0].iov_len = 3;
+    iov[1].iov_base = NULL;
+    iov[1].iov_len = 0;
+    iov[2].iov_base = "defg";
+    iov[2].iov_len = 4;
+
+    errno = 0;
+    ok (flux_msg_set_payload_iov (NULL, iov, 3) < 0 && errno == EINVAL,
+        "flux_msg_set_payload_iov msg=NULL fails with EINVAL");
+    errno = 0;
+    ok (flux_msg_set_payload_iov (msg, NULL, 1) < 0 && errno == EINVAL,
+        "flux_msg_set_payload_iov iov=NULL fails with EINVAL");
+    errno = 0;
+    ok (flux_msg_set_payload_iov (msg, iov, -1) < 0 && errno == EINVAL,
+        "flux_msg_set_payload_iov iovcnt=-1 fails with EINVAL");
+
+    ok (flux_msg_set_payload_iov (msg, iov, 3) == 0,
+        "flux_msg_set_payload_iov works");
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0 && len == 7,
+        "flux_msg_get_payload returns gathered length");
+    cmp_mem (buf, "abcdefg", 7,
+        "and payload is the concatenation of the buffers");
+
+    iov[0].iov_base = (char *)buf + 1;
+    iov[0].iov_len = 2;
+    errno = 0;
+    ok (flux_msg_set_payload_iov (msg, iov, 1) < 0 && errno == EINVAL,
+        "flux_msg_set_payload_iov detects reuse of payload and fails");
+
+    ok (flux_msg_set_payload_iov (msg, iov, 0) == 0
+        && !flux_msg_has_payload (msg),
+        "flux_msg_set_payload_iov iovcnt=0 removes payload");
+
+    flux_msg_destroy (msg);
+}
+
 /* flux_msg_set_type, flux_msg_get_type
  * flux_msg_set_nodeid, flux_msg_get_nodeid
  * flux_msg_set_errnum, flux_msg_get_errnum
@@ -1064,6 +1112,57 @@ void check_copy (void)
     flux_msg_destroy (msg);
 }
 
+void check_copy_shared_payload (void)
+{
+    flux_msg_t *msg;
+    flux_msg_t *cpy;
+    const void *buf;
+    const void *cpybuf;
+    size_t len;
+    size_t cpylen;
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_topic (msg, "foo") < 0
+        || flux_msg_set_string (msg, "hello world") < 0)
+        BAIL_OUT ("error creating test message");
+    ok ((cpy = flux_msg_copy (msg, true)) != NULL,
+        "flux_msg_copy works");
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0
+        && flux_msg_get_payload (cpy, &cpybuf, &cpylen) == 0
+        && buf == cpybuf
+        && len == cpylen,
+        "copy shares payload buffer with original");
+    ok (msg->pbuf->refcount == 2,
+        "shared payload buffer has refcount of 2");
+
+    ok (flux_msg_set_string (cpy, "bye") == 0,
+        "flux_msg_set_string on copy works");
+    ok (flux_msg_get_payload (msg, &buf, &len) == 0
+        && flux_msg_get_payload (cpy, &cpybuf, &cpylen) == 0
+        && buf != cpybuf
+        && streq (buf, "hello world")
+        && streq (cpybuf, "bye"),
+        "copy got a new buffer and original is unchanged");
+    ok (msg->pbuf->refcount == 1 && cpy->pbuf->refcount == 1,
+        "payload buffers are no longer shared");
+
+    flux_msg_destroy (cpy);
+
+    ok ((cpy = flux_msg_copy (msg, true)) != NULL,
+        "flux_msg_copy works");
+    flux_msg_destroy (msg);
+    ok (flux_msg_get_payload (cpy, &cpybuf, &cpylen) == 0
+        && streq (cpybuf, "hello world"),
+        "copy payload is intact after original is destroyed");
+    ok (cpy->pbuf->refcount == 1,
+        "payload buffer refcount dropped to 1");
+    ok (flux_msg_set_payload (cpy, NULL, 0) == 0
+        && !flux_msg_has_payload (cpy)
+        && cpy->pbuf == NULL,
+        "removing payload from copy releases its buffer");
+    flux_msg_destroy (cpy);
+}
+
 void check_print (void)
 {
     flux_msg_t *msg;
@@ -1399,12 +1498,14 @@ int main (int argc, char *argv[])
     check_routes ();
     check_topic ();
     check_payload ();
+    check_payload_iov ();
     check_payload_json ();
     check_payload_json_formatted ();
     check_matchtag ();
     check_security ();
     check_aux ();
     check_copy ();
+    check_copy_shared_payload ();
     check_flags ();
 
     check_cmp ();
@@ -152,6 +152,9 @@ int main (int argc, char *argv[])
     ok (flux_respond_raw (NULL, msg, "foo", 3) < 0 && errno == EINVAL,
         "flux_respond_raw h=NULL fails with EINVAL");
     errno = 0;
+    ok (flux_respond_raw_iov (NULL, msg, NULL, 0) < 0 && errno == EINVAL,
+        "flux_respond_raw_iov h=NULL fails with EINVAL");
+    errno = 0;
     ok (flux_respond_error (NULL, msg, ENODATA, NULL) < 0 && errno == EINVAL,
         "flux_respond_error h=NULL fails with EINVAL");
     flux_msg_destroy (msg);
@@ -170,10 +173,41 @@ int main (int argc, char *argv[])
     ok (flux_respond_raw (h, NULL, "foo", 3) < 0 && errno == EINVAL,
         "flux_respond_raw msg=NULL fails with EINVAL");
     errno = 0;
+    ok (flux_respond_raw_iov (h, NULL, NULL, 0) < 0 && errno == EINVAL,
+        "flux_respond_raw_iov msg=NULL fails with EINVAL");
+    errno = 0;
     ok (flux_respond_error (h, NULL, ENODATA, NULL) < 0 && errno == EINVAL,
         "flux_respond_error msg=NULL fails with EINVAL");
     flux_close (h);
 
+    /* raw iov response */
+    h = flux_open ("loop://", 0);
+    if (!h)
+        BAIL_OUT ("could not create loop handle");
+    msg = flux_request_encode ("foo", NULL);
+    if (!msg)
+        BAIL_OUT ("flux_request_encode failed");
+    else {
+        struct iovec iov[2] = {
+            { .iov_base = "foo", .iov_len = 3 },
+            { .iov_base = "bar", .iov_len = 3 },
+        };
+        const void *data;
+        size_t len;
+
+        ok (flux_respond_raw_iov (h, msg, iov, 2) == 0,
+            "flux_respond_raw_iov works");
+        msg2 = flux_recv (h, FLUX_MATCH_ANY, 0);
+        ok (msg2 != NULL
+            && flux_msg_get_payload (msg2, &data, &len) == 0
+            && len == 6
+            && memcmp (data, "foobar", 6) == 0,
+            "and sent a response with the gathered payload");
+        flux_msg_destroy (msg2);
+    }
+    flux_msg_destroy (msg);
+    flux_close (h);
+
     /* errnum=0 */
     h = flux_open ("loop://", 0);
     if (!h)
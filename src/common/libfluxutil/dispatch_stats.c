@@ -0,0 +1,94 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* dispatch_stats.c - encode message dispatch histograms as JSON
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+
+#include "dispatch_stats.h"
+
+/* Label histogram bucket 'i' with the range of values it counts.
+ */
+static void bucket_label (int i, char *buf, size_t size)
+{
+    if (i == 0)
+        snprintf (buf, size, "0");
+    else if (i == 1)
+        snprintf (buf, size, "1");
+    else if (i < FLUX_DISPATCH_HIST_SIZE - 1)
+        snprintf (buf, size, "%u-%u", 1U << (i - 1), (1U << i) - 1);
+    else
+        snprintf (buf, size, "%u+", 1U << (i - 1));
+}
+
+static json_t *hist_encode (const unsigned int *hist)
+{
+    json_t *o;
+
+    if (!(o = json_object ()))
+        goto nomem;
+    for (int i = 0; i < FLUX_DISPATCH_HIST_SIZE; i++) {
+        char label[32];
+        json_t *val;
+
+        bucket_label (i, label, sizeof (label));
+        if (!(val = json_integer (hist[i]))
+            || json_object_set_new (o, label, val) < 0) {
+            json_decref (val);
+            goto nomem;
+        }
+    }
+    return o;
+nomem:
+    json_decref (o);
+    errno = ENOMEM;
+    return NULL;
+}
+
+json_t *dispatch_stats_encode (flux_t *h)
+{
+    flux_dispatch_stats_t stats;
+    json_t *batch = NULL;
+    json_t *queue = NULL;
+    json_t *o;
+
+    if (!h) {
+        errno = EINVAL;
+        return NULL;
+    }
+    flux_get_dispatch_stats (h, &stats);
+    if (!(batch = hist_encode (stats.batch))
+        || !(queue = hist_encode (stats.queue)))
+        goto error;
+    if (!(o = json_pack ("{s:i s:O s:O}",
+                         "batch-max", stats.batch_max,
+                         "batch", batch,
+                         "queue", queue))) {
+        errno = ENOMEM;
+        goto error;
+    }
+    json_decref (batch);
+    json_decref (queue);
+    return o;
+error:
+    ERRNO_SAFE_WRAP (json_decref, batch);
+    ERRNO_SAFE_WRAP (json_decref, queue);
+    return NULL;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,26 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _LIBFLUXUTIL_DISPATCH_STATS_H
+#define _LIBFLUXUTIL_DISPATCH_STATS_H
+
+#include <jansson.h>
+#include <flux/core.h>
+
+/* Encode flux_get_dispatch_stats(3) for a stats-get response:
+ *   {"batch-max":i, "batch":{"0":i, "1":i, "2-3":i, ... "256+":i},
+ *    "queue":{...}}
+ * Return a new JSON object, or NULL on failure with errno set.
+ */
+json_t *dispatch_stats_encode (flux_t *h);
+
+#endif // !_LIBFLUXUTIL_DISPATCH_STATS_H
+
+// vi:ts=4 sw=4 expandtab
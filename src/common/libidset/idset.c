@@ -31,6 +31,48 @@ int validate_idset_flags (int flags, int allowed)
     return 0;
 }
 
+static inline bool bitmap_test (const uint64_t *bitmap, unsigned int id)
+{
+    return (bitmap[id / 64] & (1ULL << (id % 64))) != 0;
+}
+
+static inline void bitmap_set (uint64_t *bitmap, unsigned int id)
+{
+    bitmap[id / 64] |= 1ULL << (id % 64);
+}
+
+static inline void bitmap_clear (uint64_t *bitmap, unsigned int id)
+{
+    bitmap[id / 64] &= ~(1ULL << (id % 64));
+}
+
+/* Set bits [lo, hi) in bitmap, a word at a time where possible.
+ */
+static void bitmap_fill (uint64_t *bitmap, size_t lo, size_t hi)
+{
+    while (lo < hi && lo % 64 != 0)
+        bitmap_set (bitmap, lo++);
+    while (hi - lo >= 64) {
+        bitmap[lo / 64] = ~0ULL;
+        lo += 64;
+    }
+    while (lo < hi)
+        bitmap_set (bitmap, lo++);
+}
+
+/* Allocate a bitmap for a universe of 'size' ids, with ids below 'fill'
+ * initially set.
+ */
+static uint64_t *bitmap_create (size_t size, size_t fill)
+{
+    uint64_t *bitmap;
+
+    if (!(bitmap = calloc (IDSET_BITMAP_WORDS (size), sizeof (bitmap[0]))))
+        return NULL;
+    bitmap_fill (bitmap, 0, fill);
+    return bitmap;
+}
+
 struct idset *idset_create (size_t size, int flags)
 {
     struct idset *idset;
@@ -49,11 +91,17 @@ struct idset *idset_create (size_t size, int flags)
     }
     if (!(idset = malloc (sizeof (*idset))))
         return NULL;
-    if ((flags & IDSET_FLAG_INITFULL))
+    if ((flags & IDSET_FLAG_INITFULL)) {
         idset->T = vebnew (size, 1);
-    else
+        idset->bitmap = bitmap_create (size, size);
+    }
+    else {
         idset->T = vebnew (size, 0);
-    if (!idset->T.D) {
+        idset->bitmap = bitmap_create (size, 0);
+    }
+    if (!idset->T.D || !idset->bitmap) {
+        free (idset->T.D);
+        free (idset->bitmap);
         free (idset);
         errno = ENOMEM;
         return NULL;
@@ -73,6 +121,7 @@ void idset_destroy (struct idset *idset)
     if (idset) {
         int saved_errno = errno;
         free (idset->T.D);
+        free (idset->bitmap);
         free (idset);
         errno = saved_errno;
     }
@@ -99,7 +148,7 @@ static struct idset *idset_copy_flags (const struct idset *idset, int flags)
 {
     struct idset *cpy;
 
-    if (!(cpy = malloc (sizeof (*idset))))
+    if (!(cpy = calloc (1, sizeof (*idset))))
         return NULL;
     cpy->flags = flags;
     cpy->T = vebdup (idset->T);
@@ -107,7 +156,15 @@ static struct idset *idset_copy_flags (const struct idset *idset, int flags)
         idset_destroy (cpy);
         return NULL;
     }
+    size_t words = IDSET_BITMAP_WORDS (idset->T.M);
+    if (!(cpy->bitmap = malloc (words * sizeof (cpy->bitmap[0])))) {
+        idset_destroy (cpy);
+        return NULL;
+    }
+    memcpy (cpy->bitmap, idset->bitmap, words * sizeof (cpy->bitmap[0]));
     cpy->count = idset->count;
+    if ((flags & IDSET_FLAG_ALLOC_RR))
+        cpy->alloc_rr_last = IDSET_INVALID_ID;
     return cpy;
 }
 
@@ -134,6 +191,7 @@ static int idset_grow (struct idset *idset, size_t size)
 {
     size_t newsize = idset->T.M;
     Veb T;
+    uint64_t *bitmap;
     unsigned int id;
 
     while (newsize < size) {
@@ -155,6 +213,13 @@ static int idset_grow (struct idset *idset, size_t size)
         T = vebnew (newsize, 0);
         if (!T.D)
             return -1;
+        if (!(bitmap = bitmap_create (newsize, 0))) {
+            free (T.D);
+            return -1;
+        }
+        memcpy (bitmap,
+                idset->bitmap,
+                IDSET_BITMAP_WORDS (idset->T.M) * sizeof (bitmap[0]));
 
         id = vebsucc (idset->T, 0);
         while (id < idset->T.M) {
@@ -164,40 +229,27 @@ static int idset_grow (struct idset *idset, size_t size)
         if ((idset->flags & IDSET_FLAG_INITFULL)) {
             for (id = idset->T.M; id < newsize; id++)
                 vebput (T, id);
+            bitmap_fill (bitmap, idset->T.M, newsize);
             idset->count += (newsize - idset->T.M);
         }
         free (idset->T.D);
+        free (idset->bitmap);
         idset->T = T;
+        idset->bitmap = bitmap;
     }
     return 0;
 }
 
-/* Helper to avoid costly idset_test() operation in idset_put()/idset_del()
- * in some cases that may commonly arise in idset_encode(), for example.
- * This function runs in constant time.  Return true if id is definitely not
- * in set.  A false result is indeterminate.
- */
-static bool nonmember_fast (struct idset *idset, unsigned int id)
-{
-    unsigned int last = idset_last (idset);
-    if (last == IDSET_INVALID_ID || id > last)
-        return true;
-    unsigned int first = idset_first (idset);
-    if (first == IDSET_INVALID_ID || id < first)
-        return true;
-    return false;
-}
-
 /* Wrapper for vebput() which increments idset count.
- * The operation is skipped if id is already in the set.
+ * The operation is skipped if id is already in the set, which is
+ * a constant time bitmap check.
  */
 static void idset_put (struct idset *idset, unsigned int id)
 {
-    if ((idset->flags & IDSET_FLAG_COUNT_LAZY)
-        || nonmember_fast (idset, id)
-        || !idset_test (idset, id)) {
+    if (id < idset->T.M && !bitmap_test (idset->bitmap, id)) {
         idset->count++;
         vebput (idset->T, id);
+        bitmap_set (idset->bitmap, id);
     }
 }
 
@@ -207,6 +259,7 @@ static void idset_put_nocheck (struct idset *idset, unsigned int id)
 {
     idset->count++;
     vebput (idset->T, id);
+    bitmap_set (idset->bitmap, id);
 }
 
 /* Wrapper for vebdel() which decrements idset count.
@@ -214,10 +267,10 @@ static void idset_put_nocheck (struct idset *idset, unsigned int id)
  */
 static void idset_del (struct idset *idset, unsigned int id)
 {
-    if ((idset->flags & IDSET_FLAG_COUNT_LAZY)
-        || (!nonmember_fast (idset, id) && idset_test (idset, id))) {
+    if (id < idset->T.M && bitmap_test (idset->bitmap, id)) {
         idset->count--;
         vebdel (idset->T, id);
+        bitmap_clear (idset->bitmap, id);
     }
 }
 
@@ -227,6 +280,7 @@ static void idset_del_nocheck (struct idset *idset, unsigned int id)
 {
     idset->count--;
     vebdel (idset->T, id);
+    bitmap_clear (idset->bitmap, id);
 }
 
 int idset_set (struct idset *idset, unsigned int id)
@@ -341,7 +395,7 @@ bool idset_test (const struct idset *idset, unsigned int id)
 {
     if (!idset || !valid_id (id) || id >= idset->T.M)
         return false;
-    return (vebsucc (idset->T, id) == id);
+    return bitmap_test (idset->bitmap, id);
 }
 
 unsigned int idset_first (const struct idset *idset)
@@ -400,17 +454,13 @@ size_t idset_count (const struct idset *idset)
     if (!(idset->flags & IDSET_FLAG_COUNT_LAZY))
         return idset->count;
 
-    /* IDSET_FLAG_COUNT_LAZY was set, causing set/clear operations to ignore
-     * safeguards that kept idset->count accurate.  Pay now by iterating.
+    /* IDSET_FLAG_COUNT_LAZY was set.  Count set bits a word at a time.
      */
-    unsigned int id;
+    size_t words = IDSET_BITMAP_WORDS (idset->T.M);
     size_t count = 0;
 
-    id = idset_first (idset);
-    while (id != IDSET_INVALID_ID) {
-        count++;
-        id = idset_next (idset, id);
-    }
+    for (size_t i = 0; i < words; i++)
+        count += __builtin_popcountll (idset->bitmap[i]);
     return count;
 }
 
@@ -421,11 +471,35 @@ bool idset_empty (const struct idset *idset)
     return false;
 }
 
+/* Return word 'i' of idset's bitmap, or 0 if 'i' is beyond the universe.
+ */
+static inline uint64_t bitmap_word (const struct idset *idset, size_t i)
+{
+    return i < IDSET_BITMAP_WORDS (idset->T.M) ? idset->bitmap[i] : 0;
+}
+
+/* Call put/del on each id set in 'word', the bitmap word at index 'i'.
+ */
+static void put_word_nocheck (struct idset *idset, size_t i, uint64_t word)
+{
+    while (word) {
+        idset_put_nocheck (idset, i * 64 + __builtin_ctzll (word));
+        word &= word - 1;
+    }
+}
+
+static void del_word_nocheck (struct idset *idset, size_t i, uint64_t word)
+{
+    while (word) {
+        idset_del_nocheck (idset, i * 64 + __builtin_ctzll (word));
+        word &= word - 1;
+    }
+}
+
 bool idset_equal (const struct idset *idset1,
                   const struct idset *idset2)
 {
-    unsigned int id;
-    bool count_checked = false;
+    size_t words;
 
     if (!idset1 || !idset2)
         return false;
@@ -437,27 +511,15 @@ bool idset_equal (const struct idset *idset1,
         && !(idset2->flags & IDSET_FLAG_COUNT_LAZY)) {
         if (idset_count (idset1) != idset_count (idset2))
             return false;
-        count_checked = true;
-    }
-
-    id = vebsucc (idset1->T, 0);
-    while (id < idset1->T.M) {
-        if (vebsucc (idset2->T, id) != id)
-            return false; // id in idset1 not set in idset2
-        id = vebsucc (idset1->T, id + 1);
     }
-
-    /* No need to iterate idset2 if counts were equal and all ids in idset1
-     * were found in idset2.
+    /* Bits beyond a set's universe are zero, so comparing up to the
+     * larger universe covers ids that are only in one of the sets.
      */
-    if (count_checked)
-        return true;
-
-    id = vebsucc (idset2->T, 0);
-    while (id < idset2->T.M) {
-        if (vebsucc (idset1->T, id) != id)
-            return false; // id in idset2 not set in idset1
-        id = vebsucc (idset2->T, id + 1);
+    words = MAX (IDSET_BITMAP_WORDS (idset1->T.M),
+                 IDSET_BITMAP_WORDS (idset2->T.M));
+    for (size_t i = 0; i < words; i++) {
+        if (bitmap_word (idset1, i) != bitmap_word (idset2, i))
+            return false;
     }
     return true;
 }
@@ -465,25 +527,12 @@ bool idset_equal (const struct idset *idset1,
 bool idset_has_intersection (const struct idset *a, const struct idset *b)
 {
     if (a && b) {
-        unsigned int id;
+        size_t words = MIN (IDSET_BITMAP_WORDS (a->T.M),
+                            IDSET_BITMAP_WORDS (b->T.M));
 
-        /*  If there isn't a penalty for idset_count(3), then ensure
-         *  we're going to iterate the smaller of the provided idsets
-         *  for efficiency:
-         */
-        if (!(a->flags & IDSET_FLAG_COUNT_LAZY)
-            && !(b->flags & IDSET_FLAG_COUNT_LAZY)
-            && idset_count (a) < idset_count (b)) {
-            const struct idset *tmp = a;
-            a = b;
-            b = tmp;
-        }
-
-        id = idset_first (b);
-        while (id != IDSET_INVALID_ID) {
-            if (idset_test (a, id))
+        for (size_t i = 0; i < words; i++) {
+            if ((a->bitmap[i] & b->bitmap[i]))
                 return true;
-            id = idset_next (b, id);
         }
     }
     return false;
@@ -496,12 +545,25 @@ int idset_add (struct idset *a, const struct idset *b)
         return -1;
     }
     if (b) {
-        unsigned int id;
-        id = idset_first (b);
-        while (id != IDSET_INVALID_ID) {
-            if (idset_set (a, id) < 0)
+        unsigned int last = idset_last (b);
+        size_t words;
+
+        if (last == IDSET_INVALID_ID)
+            return 0;
+        /* See IDSET_FLAG_INITFULL note in idset_set(): ids of 'b' beyond
+         * the universe of 'a' are a no-op in that case.  Otherwise 'a'
+         * must grow to fit (or fail if it cannot), as idset_set() would.
+         */
+        if (last >= a->T.M && !(a->flags & IDSET_FLAG_INITFULL)) {
+            if (idset_grow (a, last + 1) < 0)
                 return -1;
-            id = idset_next (b, id);
+        }
+        words = MIN (IDSET_BITMAP_WORDS (a->T.M),
+                     IDSET_BITMAP_WORDS (b->T.M));
+        for (size_t i = 0; i < words; i++) {
+            uint64_t word = b->bitmap[i] & ~a->bitmap[i];
+            if (word)
+                put_word_nocheck (a, i, word);
         }
     }
     return 0;
@@ -531,13 +593,27 @@ int idset_subtract (struct idset *a, const struct idset *b)
         return -1;
     }
     if (b) {
-        unsigned int id;
+        unsigned int last = idset_last (b);
+        size_t words;
 
-        id = idset_first (b);
-        while (id != IDSET_INVALID_ID) {
-            if (idset_clear (a, id) < 0)
+        if (last == IDSET_INVALID_ID)
+            return 0;
+        /* See IDSET_FLAG_INITFULL note in idset_clear(): clearing ids
+         * beyond the universe grows a full set, but is a no-op otherwise.
+         */
+        if (last >= a->T.M && (a->flags & IDSET_FLAG_INITFULL)) {
+            if (idset_grow (a, last + 1) < 0)
                 return -1;
-            id = idset_next (b, id);
+        }
+        /* N.B. 'a' and 'b' may be the same set (see idset_clear_all()),
+         * so each word is computed before any of its bits are cleared.
+         */
+        words = MIN (IDSET_BITMAP_WORDS (a->T.M),
+                     IDSET_BITMAP_WORDS (b->T.M));
+        for (size_t i = 0; i < words; i++) {
+            uint64_t word = a->bitmap[i] & b->bitmap[i];
+            if (word)
+                del_word_nocheck (a, i, word);
         }
     }
     return 0;
@@ -563,7 +639,7 @@ struct idset *idset_difference (const struct idset *a, const struct idset *b)
 struct idset *idset_intersect (const struct idset *a, const struct idset *b)
 {
     struct idset *result;
-    unsigned int id;
+    size_t words;
 
     if (!a || !b) {
         errno = EINVAL;
@@ -582,13 +658,11 @@ struct idset *idset_intersect (const struct idset *a, const struct idset *b)
 
     if (!(result = idset_copy (a)))
         return NULL;
-    id = idset_first (a);
-    while (id != IDSET_INVALID_ID) {
-        if (!idset_test (b, id) && idset_clear (result, id) < 0) {
-            idset_destroy (result);
-            return NULL;
-        }
-        id = idset_next (a, id);
+    words = IDSET_BITMAP_WORDS (a->T.M);
+    for (size_t i = 0; i < words; i++) {
+        uint64_t word = a->bitmap[i] & ~bitmap_word (b, i);
+        if (word)
+            del_word_nocheck (result, i, word);
     }
     return result;
 }
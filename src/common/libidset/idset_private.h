@@ -14,14 +14,22 @@
 /* Implemented as a Van Emde Boas tree using code.google.com/p/libveb.
  * T.D is data; T.M is size
  * All ops are O(log m), for key bitsize m: 2^m == T.M.
+ *
+ * A flat bitmap of T.M bits is kept in sync with the tree.  It gives
+ * O(1) membership tests and lets set algebra (union, intersection,
+ * difference, equality) process 64 ids per word instead of probing
+ * the tree one id at a time.  Ordered iteration still uses the tree.
  */
 
+#include <stdint.h>
+
 #include "veb.h"
 #include "idset.h"
 
 struct idset {
     size_t count;
     Veb T;
+    uint64_t *bitmap;
     int flags;
     unsigned int alloc_rr_last;
 };
@@ -29,6 +37,8 @@ struct idset {
 #define IDSET_ENCODE_CHUNK 1024
 #define IDSET_DEFAULT_SIZE 1024 // default idset size if size=0
 
+#define IDSET_BITMAP_WORDS(size) (((size) + 63) / 64)
+
 int validate_idset_flags (int flags, int allowed);
 
 int format_first (char *buf,
@@ -563,6 +563,15 @@ static struct testop optab[] = {
     { "[0]",    OP_SUB,     NULL,       "[0]",      0,  0 },
     { "[0,1]",  OP_SUB,     "[1]",      "[0]",      0,  0 },
     { "[0,1]",  OP_SUB,     "[2]",      "[0,1]",    0,  0 },
+    /* ranges spanning bitmap word boundaries and differing universes */
+    { "[60-70]",  OP_UNION, "[128-200]", "[60-70,128-200]", 0, 0 },
+    { "[0-4095]", OP_DIFF,  "[63-64,1000-3000]",
+                            "[0-62,65-999,3001-4095]", 0, 0 },
+    { "[0-4095]", OP_INTER, "[63-64,4000-5000]",
+                            "[63-64,4000-4095]", 0, 0 },
+    { "[4000-5000]", OP_INTER, "[0-4095]", "[4000-4095]", 0, 0 },
+    { "[1-3]",    OP_ADD,   "[62-66,10000]", "[1-3,62-66,10000]", 0, 0 },
+    { "[0-127]",  OP_SUB,   "[64-200]", "[0-63]",   0,  0 },
 };
 
 static void tryop (const char *s1,
@@ -660,6 +669,26 @@ void test_ops (void)
     ok (idset_count (a) == 0,
         "idset_clear_all results in empty set");
     idset_destroy (a);
+
+    struct idset *b;
+    if (!(a = idset_decode ("0-63,4096"))
+        || !(b = idset_decode ("64-127")))
+        BAIL_OUT ("idset_decode failed");
+    ok (!idset_has_intersection (a, b) && !idset_has_intersection (b, a),
+        "idset_has_intersection [0-63,4096] [64-127] = false");
+    ok (idset_set (b, 4096) == 0
+        && idset_has_intersection (a, b)
+        && idset_has_intersection (b, a),
+        "idset_has_intersection [0-63,4096] [64-127,4096] = true");
+    ok (!idset_equal (a, b) && !idset_equal (b, a),
+        "idset_equal [0-63,4096] [64-127,4096] = false");
+    ok (idset_range_clear (b, 64, 127) == 0
+        && idset_range_set (b, 0, 63) == 0
+        && idset_equal (a, b)
+        && idset_equal (b, a),
+        "idset_equal [0-63,4096] [0-63,4096] = true");
+    idset_destroy (a);
+    idset_destroy (b);
 }
 
 void test_copy (void)
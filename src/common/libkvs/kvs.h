@@ -37,7 +37,8 @@ enum kvs_op {
     FLUX_KVS_WATCH_UNIQ = 128,
     FLUX_KVS_WATCH_APPEND = 256,
     FLUX_KVS_STREAM = 512,
-    FLUX_KVS_WATCH_INITIAL_SENTINEL = 1024
+    FLUX_KVS_WATCH_INITIAL_SENTINEL = 1024,
+    FLUX_KVS_RAW = 2048
 };
 
 /* Namespace
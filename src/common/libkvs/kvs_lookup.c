@@ -15,6 +15,7 @@
 #include <errno.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <jansson.h>
 #include <flux/core.h>
 
@@ -81,6 +82,11 @@ nomem:
 
 static int validate_lookup_flags (int flags, bool watch_ok)
 {
+    /* FLUX_KVS_RAW responses are not tree objects, and kvs-watch does
+     * not support them, so it cannot be combined with other flags.
+     */
+    if ((flags & FLUX_KVS_RAW) && flags != FLUX_KVS_RAW)
+        return -1;
     if ((flags & FLUX_KVS_WATCH) && !watch_ok)
         return -1;
     if ((flags & FLUX_KVS_WATCH_FLAGS)
@@ -108,6 +114,7 @@ static int validate_lookup_flags (int flags, bool watch_ok)
         case FLUX_KVS_READDIR:
         case FLUX_KVS_READDIR | FLUX_KVS_TREEOBJ:
         case FLUX_KVS_READLINK:
+        case FLUX_KVS_RAW:
             return 0;
         default:
             return -1;
@@ -285,13 +292,41 @@ static int parse_response (flux_future_t *f, struct lookup_ctx *ctx)
     return 0;
 }
 
+/* With FLUX_KVS_RAW, the response payload is the value itself.
+ * Copy it once to a \0 terminated buffer for flux_kvs_lookup_get() and
+ * flux_kvs_lookup_get_unpack(), like treeobj_decode_val() would.
+ */
+static int decode_raw (flux_future_t *f, struct lookup_ctx *ctx)
+{
+    const void *data;
+    size_t len;
+
+    if (flux_rpc_get_raw (f, &data, &len) < 0)
+        return -1;
+    if (!ctx->data.val_valid) {
+        if (len > 0) {
+            if (!(ctx->data.val_data = malloc (len + 1)))
+                return -1;
+            memcpy (ctx->data.val_data, data, len);
+            ((char *)ctx->data.val_data)[len] = '\0';
+        }
+        ctx->data.val_len = len;
+        ctx->data.val_valid = true;
+    }
+    return 0;
+}
+
 int flux_kvs_lookup_get (flux_future_t *f, const char **value)
 {
     struct lookup_ctx *ctx;
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
-    if (parse_response (f, ctx) < 0)
+    if ((ctx->flags & FLUX_KVS_RAW)) {
+        if (decode_raw (f, ctx) < 0)
+            return -1;
+    }
+    else if (parse_response (f, ctx) < 0)
         return -1;
     if (!ctx->data.val_valid) {
         /* ctx->data.treeobj may be NULL if sentinel received */
@@ -315,6 +350,10 @@ int flux_kvs_lookup_get_treeobj (flux_future_t *f, const char **treeobj)
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
+    if ((ctx->flags & FLUX_KVS_RAW)) {
+        errno = EINVAL;
+        return -1;
+    }
     if (parse_response (f, ctx) < 0)
         return -1;
     if (!ctx->data.treeobj_str) {
@@ -334,7 +373,11 @@ int flux_kvs_lookup_get_unpack (flux_future_t *f, const char *fmt, ...)
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
-    if (parse_response (f, ctx) < 0)
+    if ((ctx->flags & FLUX_KVS_RAW)) {
+        if (decode_raw (f, ctx) < 0)
+            return -1;
+    }
+    else if (parse_response (f, ctx) < 0)
         return -1;
     if (!ctx->data.val_valid) {
         if (treeobj_decode_val (ctx->data.treeobj,
@@ -366,6 +409,9 @@ int flux_kvs_lookup_get_raw (flux_future_t *f, const void **data, size_t *len)
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
+    /* the value is the response payload, so return it without a copy */
+    if ((ctx->flags & FLUX_KVS_RAW))
+        return flux_rpc_get_raw (f, data, len);
     if (parse_response (f, ctx) < 0)
         return -1;
     if (!ctx->data.val_valid) {
@@ -391,6 +437,10 @@ int flux_kvs_lookup_get_dir (flux_future_t *f, const flux_kvsdir_t **dirp)
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
+    if ((ctx->flags & FLUX_KVS_RAW)) {
+        errno = EINVAL;
+        return -1;
+    }
     if (parse_response (f, ctx) < 0)
         return -1;
     if (!ctx->data.dir) {
@@ -414,6 +464,10 @@ int flux_kvs_lookup_get_symlink (flux_future_t *f,
 
     if (!(ctx = get_lookup_ctx (f)))
         return -1;
+    if ((ctx->flags & FLUX_KVS_RAW)) {
+        errno = EINVAL;
+        return -1;
+    }
     if (parse_response (f, ctx) < 0)
         return -1;
     if (!treeobj_is_symlink (ctx->data.treeobj)) {
@@ -22,6 +22,14 @@
  *
  * inline dir, val, and symlink objects need no RPC and are handled
  * synchronously as they are discovered.
+ *
+ * A sharded directory (hdir) is transparent to the caller: its shards are
+ * walked under the directory's own path, and a dirref shard is offered to
+ * ops.descend and loaded like any other dirref, but never passed to visit.
+ *
+ * Likewise an indirect valref (ivalref) is transparent: its chain of older
+ * chunks is loaded one at a time (each chunk blobref offered to ops.descend),
+ * then the value is visited and dumped as the equivalent flattened valref.
  */
 
 #if HAVE_CONFIG_H
@@ -47,8 +55,18 @@ struct valref_obj {
     int remaining;              // blobs not yet completed
 };
 
-/* One pending content.load: either a dirref directory object (vobj == NULL)
- * or one blob of a valref value (vobj != NULL).
+/* Accumulator for the chunk chain of one ivalref.  Chunks are loaded
+ * newest first, one at a time, since each names the next.
+ */
+struct ivalref_obj {
+    char *path;
+    json_t *chunks;             // array of blobref arrays, newest chunk first
+    int base;                   // expected total count of the next chunk
+};
+
+/* One pending content.load: a dirref directory object (vobj and iobj NULL),
+ * one blob of a valref value (vobj != NULL), or one ivalref chunk
+ * (iobj != NULL).
  */
 struct load_op {
     struct kvs_treewalk *tw;
@@ -56,6 +74,7 @@ struct load_op {
     char *path;                 // dirref: full path of the directory
     struct valref_obj *vobj;    // valref: shared accumulator, else NULL
     int blob_index;             // valref: index of this blob within the value
+    struct ivalref_obj *iobj;   // ivalref: chain accumulator, else NULL
 };
 
 struct kvs_treewalk {
@@ -147,6 +166,17 @@ static struct valref_obj *valref_obj_create (const char *path,
     return vobj;
 }
 
+static void ivalref_obj_destroy (struct ivalref_obj *iobj)
+{
+    if (iobj) {
+        int saved_errno = errno;
+        json_decref (iobj->chunks);
+        free (iobj->path);
+        free (iobj);
+        errno = saved_errno;
+    }
+}
+
 static void load_op_destroy (struct load_op *op)
 {
     if (op) {
@@ -167,14 +197,17 @@ static void load_op_destructor (void **item)
     }
 }
 
-/* Enqueue one content.load (issued later by treewalk_pump()). 'vobj' is NULL
- * for a dirref directory object, or the shared accumulator for a valref blob.
+/* Enqueue one content.load (issued later by treewalk_pump()). 'vobj' is the
+ * shared accumulator for a valref blob, 'iobj' the chain accumulator for an
+ * ivalref chunk; both are NULL for a dirref directory object.
+ * On failure, the walk is aborted and -1 is returned.
  */
-static void enqueue_load (struct kvs_treewalk *tw,
+static int enqueue_load (struct kvs_treewalk *tw,
                           const char *blobref,
                           const char *path,
                           struct valref_obj *vobj,
-                          int blob_index)
+                          int blob_index,
+                          struct ivalref_obj *iobj)
 {
     struct load_op *op;
 
@@ -183,15 +216,18 @@ static void enqueue_load (struct kvs_treewalk *tw,
         || (path && !(op->path = strdup (path)))) {
         load_op_destroy (op);
         treewalk_fatal (tw, errno);
-        return;
+        return -1;
     }
     op->tw = tw;
     op->vobj = vobj;
     op->blob_index = blob_index;
+    op->iobj = iobj;
     if (!zlistx_add_end (tw->workq, op)) {
         load_op_destroy (op);
         treewalk_fatal (tw, ENOMEM);
+        return -1;
     }
+    return 0;
 }
 
 /* Walk the entries of a directory object, joining each child onto 'path'.
@@ -223,6 +259,173 @@ static void walk_dir (struct kvs_treewalk *tw,
     }
 }
 
+/* Walk the shards of a sharded directory object.  Every shard holds entries
+ * of the same directory, so all are walked under 'path'.
+ */
+static void walk_hdir (struct kvs_treewalk *tw,
+                       const char *path,
+                       json_t *treeobj)
+{
+    json_t *dict = treeobj_get_data (treeobj);
+    const char *slot;
+    json_t *shard;
+
+    json_object_foreach (dict, slot, shard) {
+        if (tw->errnum) // a fatal error aborted the walk
+            return;
+        if (treeobj_is_dir (shard))
+            walk_dir (tw, path, shard);
+        else if (treeobj_is_hdir (shard))
+            walk_hdir (tw, path, shard);
+        else if (treeobj_is_dirref (shard)) {
+            const char *blobref;
+            if (treeobj_get_count (shard) != 1) {
+                report_error (tw, path, KVS_TREEWALK_ERROR_BADCOUNT, 0);
+                continue;
+            }
+            blobref = treeobj_get_blobref (shard, 0);
+            if (tw->ops.descend && !tw->ops.descend (tw->arg, path, blobref))
+                continue;
+            enqueue_load (tw, blobref, path, NULL, 0, NULL);
+        }
+    }
+}
+
+/* Enqueue the blob loads of a valref (already reported to visit).
+ */
+static void walk_valref (struct kvs_treewalk *tw,
+                         const char *path,
+                         json_t *treeobj)
+{
+    /* count >= 1: treeobj_validate() rejects an empty valref. */
+    int count = treeobj_get_count (treeobj);
+    struct valref_obj *vobj;
+
+    /* The caller only wants the blobrefs (reported via visit), not the blob
+     * content or existence: skip the loads entirely.
+     */
+    if (tw->ops.valref_noload)
+        return;
+
+    if (!(vobj = valref_obj_create (path, treeobj, count))) {
+        treewalk_fatal (tw, errno);
+        return;
+    }
+    for (int i = 0; i < count; i++)
+        enqueue_load (tw,
+                      treeobj_get_blobref (treeobj, i),
+                      NULL,
+                      vobj,
+                      i,
+                      NULL);
+}
+
+/* Prepend the inline blobrefs of ivalref 'treeobj' to the chain.
+ */
+static int ivalref_obj_add_chunk (struct ivalref_obj *iobj,
+                                  const json_t *treeobj)
+{
+    int count = treeobj_get_count (treeobj);
+    json_t *chunk;
+
+    if (!(chunk = json_array ()))
+        goto nomem;
+    for (int i = 0; i < count; i++) {
+        if (json_array_append_new (chunk,
+                                   json_string (treeobj_get_blobref (treeobj,
+                                                                     i))) < 0)
+            goto nomem;
+    }
+    if (json_array_append_new (iobj->chunks, chunk) < 0) {
+        chunk = NULL;
+        goto nomem;
+    }
+    iobj->base -= count;
+    return 0;
+nomem:
+    json_decref (chunk);
+    errno = ENOMEM;
+    return -1;
+}
+
+/* The chain is complete (or pruned by ops.descend): build the flattened
+ * valref, oldest blobref first, and treat it like any other valref.
+ */
+static void ivalref_finish (struct kvs_treewalk *tw, struct ivalref_obj *iobj)
+{
+    json_t *valref;
+    size_t index;
+    json_t *chunk;
+
+    if (!(valref = treeobj_create_valref (NULL))) {
+        treewalk_fatal (tw, errno);
+        goto done;
+    }
+    for (index = json_array_size (iobj->chunks); index > 0; index--) {
+        size_t i;
+        json_t *blobref;
+
+        chunk = json_array_get (iobj->chunks, index - 1);
+        json_array_foreach (chunk, i, blobref) {
+            if (treeobj_append_blobref (valref,
+                                        json_string_value (blobref)) < 0) {
+                treewalk_fatal (tw, errno);
+                goto done;
+            }
+        }
+    }
+    if (tw->ops.visit)
+        tw->ops.visit (tw->arg, iobj->path, valref);
+    walk_valref (tw, iobj->path, valref);
+done:
+    json_decref (valref);
+    ivalref_obj_destroy (iobj);
+}
+
+/* Load the next (older) chunk of the chain, unless the caller prunes it.
+ * Ownership of 'iobj' passes to the load (or to ivalref_finish()).
+ */
+static void ivalref_next (struct kvs_treewalk *tw,
+                          struct ivalref_obj *iobj,
+                          const char *prev)
+{
+    if (!prev
+        || (tw->ops.descend && !tw->ops.descend (tw->arg, iobj->path, prev))) {
+        ivalref_finish (tw, iobj);
+        return;
+    }
+    if (enqueue_load (tw, prev, NULL, NULL, 0, iobj) < 0)
+        ivalref_obj_destroy (iobj);
+}
+
+static void walk_ivalref (struct kvs_treewalk *tw,
+                          const char *path,
+                          json_t *treeobj)
+{
+    struct ivalref_obj *iobj;
+    const char *prev;
+    int count;
+
+    if (treeobj_get_ivalref (treeobj, &prev, &count) < 0) {
+        report_error (tw, path, KVS_TREEWALK_ERROR_INVALID, 0);
+        return;
+    }
+    if (!(iobj = calloc (1, sizeof (*iobj)))
+        || !(iobj->path = strdup (path))
+        || !(iobj->chunks = json_array ())) {
+        ivalref_obj_destroy (iobj);
+        treewalk_fatal (tw, ENOMEM);
+        return;
+    }
+    iobj->base = count;
+    if (ivalref_obj_add_chunk (iobj, treeobj) < 0) {
+        ivalref_obj_destroy (iobj);
+        treewalk_fatal (tw, errno);
+        return;
+    }
+    ivalref_next (tw, iobj, prev);
+}
+
 /* Classify one object discovered at 'path' and either handle it now (inline
  * types) or enqueue the content.load(s) needed to dump it (dirref, valref).
  */
@@ -234,12 +437,20 @@ static void classify (struct kvs_treewalk *tw,
         report_error (tw, path, KVS_TREEWALK_ERROR_INVALID, 0);
         return;
     }
+    /* An ivalref is visited as its flattened valref once its chain loads. */
+    if (treeobj_is_ivalref (treeobj)) {
+        walk_ivalref (tw, path, treeobj);
+        return;
+    }
     if (tw->ops.visit)
         tw->ops.visit (tw->arg, path, treeobj);
 
     if (treeobj_is_dir (treeobj)) {
         walk_dir (tw, path, treeobj);
     }
+    else if (treeobj_is_hdir (treeobj)) {
+        walk_hdir (tw, path, treeobj);
+    }
     else if (treeobj_is_dirref (treeobj)) {
         const char *blobref;
         if (treeobj_get_count (treeobj) != 1) {
@@ -250,29 +461,10 @@ static void classify (struct kvs_treewalk *tw,
         /* Let the caller prune an already-walked subtree (see ops.descend). */
         if (tw->ops.descend && !tw->ops.descend (tw->arg, path, blobref))
             return;
-        enqueue_load (tw, blobref, path, NULL, 0);
+        enqueue_load (tw, blobref, path, NULL, 0, NULL);
     }
     else if (treeobj_is_valref (treeobj)) {
-        /* count >= 1: treeobj_validate() above rejects an empty valref. */
-        int count = treeobj_get_count (treeobj);
-        struct valref_obj *vobj;
-
-        /* The caller only wants the blobrefs (reported via visit above), not
-         * the blob content or existence: skip the loads entirely.
-         */
-        if (tw->ops.valref_noload)
-            return;
-
-        if (!(vobj = valref_obj_create (path, treeobj, count))) {
-            treewalk_fatal (tw, errno);
-            return;
-        }
-        for (int i = 0; i < count; i++)
-            enqueue_load (tw,
-                          treeobj_get_blobref (treeobj, i),
-                          NULL,
-                          vobj,
-                          i);
+        walk_valref (tw, path, treeobj);
     }
     else if (treeobj_is_val (treeobj)) {
         if (tw->ops.value)
@@ -284,9 +476,9 @@ static void classify (struct kvs_treewalk *tw,
     }
 }
 
-/* A dirref directory object finished loading: decode it and walk its entries.
- * On a load/decode/type error, prune this subtree (its children are never
- * discovered).
+/* A dirref directory object finished loading: decode it and walk its entries
+ * (or shards, if it is an hdir).  On a load/decode/type error, prune this
+ * subtree (its children are never discovered).
  */
 static void dirref_complete (struct load_op *op, flux_future_t *f)
 {
@@ -303,13 +495,52 @@ static void dirref_complete (struct load_op *op, flux_future_t *f)
         report_error (tw, op->path, KVS_TREEWALK_ERROR_DECODE, 0);
         return;
     }
-    if (!treeobj_is_dir (treeobj)) {
+    if (treeobj_is_hdir (treeobj))
+        walk_hdir (tw, op->path, treeobj);
+    else if (treeobj_is_dir (treeobj))
+        walk_dir (tw, op->path, treeobj);
+    else
         report_error (tw, op->path, KVS_TREEWALK_ERROR_NOTDIR, 0);
-        json_decref (treeobj);
-        return;
+    json_decref (treeobj);
+}
+
+/* One ivalref chunk finished loading: check that it continues the chain,
+ * then load the next one or finish.  On error the whole value is dropped.
+ */
+static void ivalref_complete (struct load_op *op, flux_future_t *f)
+{
+    struct kvs_treewalk *tw = op->tw;
+    struct ivalref_obj *iobj = op->iobj;
+    const void *buf;
+    size_t buflen;
+    json_t *treeobj = NULL;
+    const char *prev;
+    int count;
+
+    if (content_load_get (f, &buf, &buflen) < 0) {
+        report_error (tw, iobj->path, KVS_TREEWALK_ERROR_LOAD, errno);
+        goto error;
     }
-    walk_dir (tw, op->path, treeobj);
+    if (!(treeobj = treeobj_decodeb (buf, buflen))) {
+        report_error (tw, iobj->path, KVS_TREEWALK_ERROR_DECODE, 0);
+        goto error;
+    }
+    if (!treeobj_is_ivalref (treeobj)
+        || treeobj_get_ivalref (treeobj, &prev, &count) < 0
+        || count != iobj->base) {
+        report_error (tw, iobj->path, KVS_TREEWALK_ERROR_INVALID, 0);
+        goto error;
+    }
+    if (ivalref_obj_add_chunk (iobj, treeobj) < 0) {
+        treewalk_fatal (tw, errno);
+        goto error;
+    }
+    ivalref_next (tw, iobj, prev);
+    json_decref (treeobj);
+    return;
+error:
     json_decref (treeobj);
+    ivalref_obj_destroy (iobj);
 }
 
 /* One blob of a valref finished loading: stash its result. When the last
@@ -350,6 +581,8 @@ static void load_continuation (flux_future_t *f, void *arg)
     tw->in_flight--;
     if (op->vobj)
         valref_complete (op, f);
+    else if (op->iobj)
+        ivalref_complete (op, f);
     else
         dirref_complete (op, f);
     flux_future_destroy (f);
@@ -407,7 +640,7 @@ int kvs_treewalk_run (struct kvs_treewalk *tw)
     /* The root is a blob that decodes to a directory object, i.e. an implicit
      * dirref with path "".
      */
-    enqueue_load (tw, tw->root_blobref, "", NULL, 0);
+    enqueue_load (tw, tw->root_blobref, "", NULL, 0, NULL);
     treewalk_pump (tw);
     /* Run the reactor only if a load is actually in flight.  If the initial
      * pump failed (e.g. OOM) nothing is outstanding, so running would block
@@ -59,7 +59,9 @@ struct kvs_treewalk_blob {
 
 struct kvs_treewalk_ops {
     /* Called once for every object as it is discovered, before dispatch.
-     * Useful for verbose path listing.  May be NULL.
+     * An ivalref is reported as the equivalent flattened valref, once its
+     * chain of chunks has been loaded.  Useful for verbose path listing.
+     * May be NULL.
      */
     void (*visit) (void *arg, const char *path, json_t *treeobj);
 
@@ -69,7 +71,9 @@ struct kvs_treewalk_ops {
      * a caller walking several overlapping roots skip a subtree it has already
      * walked, avoiding repeated loads of shared interior nodes.  When NULL,
      * every dirref is descended.  Note that visit() has already fired for the
-     * dirref object before this is called.
+     * dirref object before this is called.  Each older chunk of an ivalref is
+     * also offered here before it is loaded; if it is pruned, the value is
+     * reported with only the blobrefs of the newer chunks.
      */
     bool (*descend) (void *arg, const char *path, const char *blobref);
 
@@ -65,12 +65,54 @@ void errors (void)
     flux_future_destroy (f);
 }
 
+void raw_flags (void)
+{
+    flux_t *h;
+    flux_future_t *f;
+
+    if (!(h = flux_open ("loop://", 0)))
+        BAIL_OUT ("could not create loop handle");
+
+    errno = 0;
+    ok (flux_kvs_lookup (h, NULL, FLUX_KVS_RAW | FLUX_KVS_TREEOBJ, "a") == NULL
+        && errno == EINVAL,
+        "flux_kvs_lookup FLUX_KVS_RAW|FLUX_KVS_TREEOBJ fails with EINVAL");
+    errno = 0;
+    ok (flux_kvs_lookup (h, NULL, FLUX_KVS_RAW | FLUX_KVS_READDIR, "a") == NULL
+        && errno == EINVAL,
+        "flux_kvs_lookup FLUX_KVS_RAW|FLUX_KVS_READDIR fails with EINVAL");
+    errno = 0;
+    ok (flux_kvs_lookup (h, NULL, FLUX_KVS_RAW | FLUX_KVS_WATCH, "a") == NULL
+        && errno == EINVAL,
+        "flux_kvs_lookup FLUX_KVS_RAW|FLUX_KVS_WATCH fails with EINVAL");
+    errno = 0;
+    ok (flux_kvs_lookup (h, NULL, FLUX_KVS_RAW | FLUX_KVS_STREAM, "a") == NULL
+        && errno == EINVAL,
+        "flux_kvs_lookup FLUX_KVS_RAW|FLUX_KVS_STREAM fails with EINVAL");
+
+    ok ((f = flux_kvs_lookup (h, "primary", FLUX_KVS_RAW, "a")) != NULL,
+        "flux_kvs_lookup FLUX_KVS_RAW works");
+    errno = 0;
+    ok (flux_kvs_lookup_get_treeobj (f, NULL) < 0 && errno == EINVAL,
+        "flux_kvs_lookup_get_treeobj fails on FLUX_KVS_RAW lookup");
+    errno = 0;
+    ok (flux_kvs_lookup_get_dir (f, NULL) < 0 && errno == EINVAL,
+        "flux_kvs_lookup_get_dir fails on FLUX_KVS_RAW lookup");
+    errno = 0;
+    ok (flux_kvs_lookup_get_symlink (f, NULL, NULL) < 0 && errno == EINVAL,
+        "flux_kvs_lookup_get_symlink fails on FLUX_KVS_RAW lookup");
+    flux_future_destroy (f);
+
+    flux_close (h);
+}
+
 int main (int argc, char *argv[])
 {
 
     plan (NO_PLAN);
 
     errors ();
+    raw_flags ();
 
     done_testing();
     return (0);
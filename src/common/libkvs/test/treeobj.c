@@ -186,6 +186,198 @@ void test_valref (void)
     json_decref (valref);
 }
 
+void test_ivalref (void)
+{
+    json_t *ivalref;
+    json_t *cpy;
+    json_t *o;
+    const char *prev;
+    const char *blobref;
+    char *s;
+    int count;
+
+    ok ((ivalref = treeobj_create_ivalref (NULL, 0)) != NULL,
+        "treeobj_create_ivalref with no prev works");
+    errno = 0;
+    ok (treeobj_validate (ivalref) < 0 && errno == EINVAL,
+        "treeobj_validate rejects ivalref with no blobrefs");
+    ok (treeobj_is_ivalref (ivalref) && !treeobj_is_valref (ivalref),
+        "treeobj_is_ivalref returns true, treeobj_is_valref false");
+    ok (treeobj_append_blobref (ivalref, blobrefs[0]) == 0
+        && treeobj_append_blobref (ivalref, blobrefs[1]) == 0,
+        "treeobj_append_blobref works twice");
+    ok (treeobj_validate (ivalref) == 0,
+        "treeobj_validate likes ivalref now");
+    ok (treeobj_get_count (ivalref) == 2,
+        "treeobj_get_count returns 2");
+    ok (treeobj_get_ivalref (ivalref, &prev, &count) == 0
+        && prev == NULL
+        && count == 2,
+        "treeobj_get_ivalref returns no prev and count of 2");
+    blobref = treeobj_get_blobref (ivalref, 1);
+    ok (blobref != NULL && streq (blobref, blobrefs[1]),
+        "treeobj_get_blobref [1] returns expected blobref");
+    diag_json (ivalref);
+    json_decref (ivalref);
+
+    ok ((ivalref = treeobj_create_ivalref (blobrefs[0], 10)) != NULL,
+        "treeobj_create_ivalref with prev works");
+    ok (treeobj_append_blobref (ivalref, blobrefs[2]) == 0,
+        "treeobj_append_blobref works");
+    ok (treeobj_validate (ivalref) == 0,
+        "treeobj_validate likes ivalref");
+    ok (treeobj_get_count (ivalref) == 1,
+        "treeobj_get_count returns 1 inline blobref");
+    ok (treeobj_get_ivalref (ivalref, &prev, &count) == 0
+        && prev != NULL
+        && streq (prev, blobrefs[0])
+        && count == 11,
+        "treeobj_get_ivalref returns prev and count of 11");
+    ok ((cpy = treeobj_copy (ivalref)) != NULL
+        && json_equal (cpy, ivalref),
+        "treeobj_copy works");
+    ok (treeobj_append_blobref (cpy, blobrefs[0]) == 0
+        && treeobj_get_count (ivalref) == 1,
+        "appending to copy does not alter original");
+    json_decref (cpy);
+    if (!(s = treeobj_encode (ivalref)))
+        BAIL_OUT ("treeobj_encode failed");
+    ok ((cpy = treeobj_decode (s)) != NULL && json_equal (cpy, ivalref),
+        "ivalref survives encode/decode");
+    json_decref (cpy);
+    free (s);
+    diag_json (ivalref);
+    json_decref (ivalref);
+
+    errno = 0;
+    ok (treeobj_create_ivalref (NULL, 1) == NULL && errno == EINVAL,
+        "treeobj_create_ivalref no prev, count=1 fails with EINVAL");
+    errno = 0;
+    ok (treeobj_create_ivalref (blobrefs[0], 0) == NULL && errno == EINVAL,
+        "treeobj_create_ivalref prev, count=0 fails with EINVAL");
+    errno = 0;
+    ok (treeobj_create_ivalref ("foo", 1) == NULL && errno == EINVAL,
+        "treeobj_create_ivalref bad prev fails with EINVAL");
+    errno = 0;
+    ok (treeobj_get_ivalref (NULL, NULL, NULL) < 0
+        && errno == EINVAL,
+        "treeobj_get_ivalref obj=NULL fails with EINVAL");
+
+    o = json_pack ("{s:i s:s s:{s:i s:[s]}}",
+                   "ver", 1,
+                   "type", "ivalref",
+                   "data",
+                     "count", 2,
+                     "blobrefs", blobrefs[0]);
+    errno = 0;
+    ok (o && treeobj_validate (o) < 0 && errno == EINVAL,
+        "treeobj_validate rejects ivalref with wrong count and no prev");
+    json_decref (o);
+    o = json_pack ("{s:i s:s s:{s:i s:s s:[s]}}",
+                   "ver", 1,
+                   "type", "ivalref",
+                   "data",
+                     "count", 1,
+                     "prev", blobrefs[1],
+                     "blobrefs", blobrefs[0]);
+    errno = 0;
+    ok (o && treeobj_validate (o) < 0 && errno == EINVAL,
+        "treeobj_validate rejects ivalref with prev and no older blobrefs");
+    json_decref (o);
+    o = json_pack ("{s:i s:s s:{s:i s:[s] s:i}}",
+                   "ver", 1,
+                   "type", "ivalref",
+                   "data",
+                     "count", 1,
+                     "blobrefs", blobrefs[0],
+                     "extra", 1);
+    errno = 0;
+    ok (o && treeobj_validate (o) < 0 && errno == EINVAL,
+        "treeobj_validate rejects ivalref with unknown member");
+    json_decref (o);
+}
+
+void test_ivalref_chunks (void)
+{
+    json_t *ivalref;
+    json_t *cpy;
+    const char *ref;
+    int count;
+
+    ok ((ivalref = treeobj_create_ivalref (blobrefs[1], 8)) != NULL
+        && treeobj_append_blobref (ivalref, blobrefs[2]) == 0,
+        "created ivalref with prev and count of 9");
+    ok (treeobj_get_ivalref_nchunks (ivalref) == 0,
+        "treeobj_get_ivalref_nchunks returns 0 with no index");
+    errno = 0;
+    ok (treeobj_get_ivalref_chunk (ivalref, 0, &ref, &count) < 0
+        && errno == EINVAL,
+        "treeobj_get_ivalref_chunk fails with EINVAL with no index");
+    ok (treeobj_append_ivalref_chunk (ivalref, blobrefs[0], 4) == 0
+        && treeobj_append_ivalref_chunk (ivalref, blobrefs[1], 8) == 0,
+        "treeobj_append_ivalref_chunk works twice");
+    ok (treeobj_validate (ivalref) == 0,
+        "treeobj_validate likes ivalref with index");
+    ok (treeobj_get_ivalref_nchunks (ivalref) == 2,
+        "treeobj_get_ivalref_nchunks returns 2");
+    ok (treeobj_get_ivalref_chunk (ivalref, 0, &ref, &count) == 0
+        && streq (ref, blobrefs[0])
+        && count == 4,
+        "treeobj_get_ivalref_chunk 0 returns oldest chunk");
+    ok (treeobj_get_ivalref_chunk (ivalref, 1, &ref, &count) == 0
+        && streq (ref, blobrefs[1])
+        && count == 8,
+        "treeobj_get_ivalref_chunk 1 returns prev");
+    errno = 0;
+    ok (treeobj_get_ivalref_chunk (ivalref, 2, &ref, &count) < 0
+        && errno == EINVAL,
+        "treeobj_get_ivalref_chunk out of range fails with EINVAL");
+    diag_json (ivalref);
+
+    ok ((cpy = treeobj_deep_copy (ivalref)) != NULL
+        && treeobj_clear_ivalref_chunks (cpy) == 0
+        && treeobj_get_ivalref_nchunks (cpy) == 0
+        && treeobj_validate (cpy) == 0,
+        "treeobj_clear_ivalref_chunks removes index");
+    json_decref (cpy);
+
+    ok ((cpy = treeobj_deep_copy (ivalref)) != NULL
+        && treeobj_append_ivalref_chunk (cpy, blobrefs[2], 8) == 0,
+        "appended chunk that does not match prev");
+    errno = 0;
+    ok (treeobj_validate (cpy) < 0 && errno == EINVAL,
+        "treeobj_validate rejects index that does not end at prev");
+    json_decref (cpy);
+    json_decref (ivalref);
+
+    ok ((ivalref = treeobj_create_ivalref (blobrefs[1], 8)) != NULL
+        && treeobj_append_blobref (ivalref, blobrefs[2]) == 0
+        && treeobj_append_ivalref_chunk (ivalref, blobrefs[0], 8) == 0
+        && treeobj_append_ivalref_chunk (ivalref, blobrefs[1], 8) == 0,
+        "created ivalref with non-increasing chunk counts");
+    errno = 0;
+    ok (treeobj_validate (ivalref) < 0 && errno == EINVAL,
+        "treeobj_validate rejects non-increasing chunk counts");
+    json_decref (ivalref);
+
+    ok ((ivalref = treeobj_create_ivalref (NULL, 0)) != NULL
+        && treeobj_append_blobref (ivalref, blobrefs[2]) == 0
+        && treeobj_append_ivalref_chunk (ivalref, blobrefs[0], 1) == 0,
+        "created ivalref with index and no prev");
+    errno = 0;
+    ok (treeobj_validate (ivalref) < 0 && errno == EINVAL,
+        "treeobj_validate rejects index without prev");
+    json_decref (ivalref);
+
+    errno = 0;
+    ok (treeobj_append_ivalref_chunk (NULL, blobrefs[0], 1) < 0
+        && errno == EINVAL,
+        "treeobj_append_ivalref_chunk obj=NULL fails with EINVAL");
+    errno = 0;
+    ok (treeobj_get_ivalref_nchunks (NULL) < 0 && errno == EINVAL,
+        "treeobj_get_ivalref_nchunks obj=NULL fails with EINVAL");
+}
+
 void test_val (void)
 {
     json_t *val, *val2;
@@ -807,28 +999,174 @@ void test_corner_cases (void)
     json_decref (symlink);
 }
 
+void test_hdir (void)
+{
+    json_t *hdir, *dir, *val, *cpy, *bad;
+    const json_t *shard;
+    char *s;
+    char name[16];
+    int i, total;
+    bool placed;
+    void *iter;
+
+    ok ((hdir = treeobj_create_hdir ()) != NULL,
+        "treeobj_create_hdir works");
+    ok (treeobj_validate (hdir) == 0,
+        "treeobj_validate likes empty hdir");
+    ok (treeobj_is_hdir (hdir) && !treeobj_is_dir (hdir),
+        "treeobj_is_hdir returns true, treeobj_is_dir returns false");
+    ok (treeobj_get_count (hdir) == 0,
+        "treeobj_get_count returns 0");
+    errno = 0;
+    ok (treeobj_hdir_get_shard (hdir, "foo", 0) == NULL && errno == ENOENT,
+        "treeobj_hdir_get_shard on empty hdir fails with ENOENT");
+
+    /* pin the on-disk placement: FNV-1a ("foo") = 0xa9f37ed7 */
+    if (!(dir = treeobj_create_dir ()))
+        BAIL_OUT ("can't continue without test value");
+    ok (treeobj_hdir_set_shard (hdir, "foo", 0, dir) == 0
+        && treeobj_get_count (hdir) == 1
+        && json_object_get (treeobj_get_data (hdir), "17") == dir,
+        "treeobj_hdir_set_shard foo depth 0 uses slot 17");
+    ok (treeobj_hdir_set_shard (hdir, "foo", 1, dir) == 0
+        && treeobj_get_count (hdir) == 2
+        && json_object_get (treeobj_get_data (hdir), "16") == dir,
+        "treeobj_hdir_set_shard foo depth 1 uses slot 16");
+    ok (treeobj_hdir_get_shard (hdir, "foo", 0) == dir
+        && treeobj_hdir_peek_shard (hdir, "foo", 1) == dir,
+        "treeobj_hdir_get_shard/peek_shard find the shards");
+    ok (treeobj_validate (hdir) == 0,
+        "treeobj_validate likes populated hdir");
+    json_decref (dir);
+    json_decref (hdir);
+
+    /* split a dir */
+    if (!(dir = treeobj_create_dir ())
+        || !(val = treeobj_create_val ("x", 1)))
+        BAIL_OUT ("can't continue without test value");
+    for (i = 0; i < 200; i++) {
+        snprintf (name, sizeof (name), "key%d", i);
+        if (treeobj_insert_entry (dir, name, val) < 0)
+            BAIL_OUT ("treeobj_insert_entry failed");
+    }
+    ok ((hdir = treeobj_hdir_split (dir, 0)) != NULL,
+        "treeobj_hdir_split works");
+    ok (treeobj_validate (hdir) == 0,
+        "treeobj_validate likes split hdir");
+    ok (treeobj_get_count (hdir) > 1
+        && treeobj_get_count (hdir) <= TREEOBJ_HDIR_FANOUT,
+        "split hdir has between 2 and %d shards", TREEOBJ_HDIR_FANOUT);
+    placed = true;
+    for (i = 0; i < 200; i++) {
+        snprintf (name, sizeof (name), "key%d", i);
+        if (!(shard = treeobj_hdir_peek_shard (hdir, name, 0))
+            || !treeobj_is_dir (shard)
+            || !treeobj_peek_entry (shard, name))
+            placed = false;
+    }
+    ok (placed == true,
+        "every entry is found in the shard for its name");
+    total = 0;
+    iter = json_object_iter (treeobj_get_data (hdir));
+    while (iter) {
+        total += treeobj_get_count (json_object_iter_value (iter));
+        iter = json_object_iter_next (treeobj_get_data (hdir), iter);
+    }
+    ok (total == 200,
+        "shards hold 200 entries in total");
+
+    ok ((s = treeobj_encode (hdir)) != NULL
+        && (cpy = treeobj_decode (s)) != NULL
+        && json_equal (cpy, hdir),
+        "hdir survives encode/decode");
+    free (s);
+    json_decref (cpy);
+
+    ok ((cpy = treeobj_copy (hdir)) != NULL
+        && treeobj_is_hdir (cpy)
+        && treeobj_get_count (cpy) == treeobj_get_count (hdir),
+        "treeobj_copy works on hdir");
+    ok (json_object_del (treeobj_get_data (cpy), "17") == 0
+        && json_object_get (treeobj_get_data (hdir), "17") != NULL,
+        "removing shard from copy does not affect original");
+    json_decref (cpy);
+
+    errno = 0;
+    ok (treeobj_hdir_set_shard (hdir, "foo", 0, val) < 0 && errno == EINVAL,
+        "treeobj_hdir_set_shard rejects val shard with EINVAL");
+    errno = 0;
+    ok (treeobj_hdir_get_shard (hdir, "foo", TREEOBJ_HDIR_MAXDEPTH) == NULL
+        && errno == EINVAL,
+        "treeobj_hdir_get_shard fails with EINVAL on bad depth");
+    errno = 0;
+    ok (treeobj_hdir_get_shard (dir, "foo", 0) == NULL && errno == EINVAL,
+        "treeobj_hdir_get_shard fails with EINVAL on dir");
+    errno = 0;
+    ok (treeobj_hdir_split (hdir, 0) == NULL && errno == EINVAL,
+        "treeobj_hdir_split fails with EINVAL on hdir");
+    errno = 0;
+    ok (treeobj_hdir_split (dir, TREEOBJ_HDIR_MAXDEPTH) == NULL
+        && errno == EINVAL,
+        "treeobj_hdir_split fails with EINVAL on bad depth");
+    errno = 0;
+    ok (treeobj_get_entry (hdir, "key0") == NULL && errno == EINVAL,
+        "treeobj_get_entry fails with EINVAL on hdir");
+    json_decref (hdir);
+    json_decref (dir);
+
+    if (!(bad = json_pack ("{s:i s:s s:{s:O}}",
+                           "ver", 1,
+                           "type", "hdir",
+                           "data",
+                             "zz", val)))
+        BAIL_OUT ("json_pack failed");
+    errno = 0;
+    ok (treeobj_validate (bad) < 0 && errno == EINVAL,
+        "treeobj_validate rejects hdir with bad slot key");
+    json_decref (bad);
+    if (!(bad = json_pack ("{s:i s:s s:{s:O}}",
+                           "ver", 1,
+                           "type", "hdir",
+                           "data",
+                             "1f", val)))
+        BAIL_OUT ("json_pack failed");
+    errno = 0;
+    ok (treeobj_validate (bad) < 0 && errno == EINVAL,
+        "treeobj_validate rejects hdir with val shard");
+    json_decref (bad);
+    json_decref (val);
+}
+
 void test_type_name (void)
 {
-    json_t *val, *valref, *dir, *dirref, *symlink, *notatreeobj;
+    json_t *val, *valref, *ivalref, *dir, *dirref, *hdir, *symlink;
+    json_t *notatreeobj;
     const char *s;
 
     val = treeobj_create_val ("a", 1);
     valref = treeobj_create_valref (NULL);
+    ivalref = treeobj_create_ivalref (NULL, 0);
     dir = treeobj_create_dir ();
     dirref = treeobj_create_dirref (NULL);
+    hdir = treeobj_create_hdir ();
     symlink = treeobj_create_symlink (NULL, "some-string");
     notatreeobj = json_object ();
-    if (!val || !valref || !dir || !dirref || !symlink || !notatreeobj)
+    if (!val || !valref || !ivalref || !dir || !dirref || !hdir || !symlink
+        || !notatreeobj)
         BAIL_OUT ("can't continue without test value");
 
     s = treeobj_type_name (val);
     ok (streq (s, "val"), "treeobj_type_name returns val correctly");
     s = treeobj_type_name (valref);
     ok (streq (s, "valref"), "treeobj_type_name returns valref correctly");
+    s = treeobj_type_name (ivalref);
+    ok (streq (s, "ivalref"), "treeobj_type_name returns ivalref correctly");
     s = treeobj_type_name (dir);
     ok (streq (s, "dir"), "treeobj_type_name returns dir correctly");
     s = treeobj_type_name (dirref);
     ok (streq (s, "dirref"), "treeobj_type_name returns dirref correctly");
+    s = treeobj_type_name (hdir);
+    ok (streq (s, "hdir"), "treeobj_type_name returns hdir correctly");
     s = treeobj_type_name (symlink);
     ok (streq (s, "symlink"), "treeobj_type_name returns symlink correctly");
     s = treeobj_type_name (notatreeobj);
@@ -840,8 +1178,10 @@ void test_type_name (void)
 
     json_decref (val);
     json_decref (valref);
+    json_decref (ivalref);
     json_decref (dir);
     json_decref (dirref);
+    json_decref (hdir);
     json_decref (symlink);
     json_decref (notatreeobj);
 }
@@ -851,10 +1191,13 @@ int main(int argc, char** argv)
     plan (NO_PLAN);
 
     test_valref ();
+    test_ivalref ();
+    test_ivalref_chunks ();
     test_val ();
     test_dirref ();
     test_dir ();
     test_dir_peek ();
+    test_hdir ();
     test_copy ();
     test_deep_copy ();
     test_symlink ();
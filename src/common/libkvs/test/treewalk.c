@@ -464,6 +464,149 @@ static void test_inline_dir (flux_t *h, struct blobstore *bs)
     free (rootref);
 }
 
+/* A sharded directory referenced by dirref, whose shards are themselves
+ * dirrefs:
+ *   root/
+ *     big/  = dirref -> hdir { slot => dirref -> dir { k0..k39 = val } }
+ * Entries are visited under "big/" and every shard dirref is offered to
+ * ops.descend.
+ */
+static void test_hdir (flux_t *h, struct blobstore *bs)
+{
+    json_t *dir, *hdir, *root, *o;
+    const char *slot;
+    json_t *shard;
+    char *ref, *rootref;
+    int shards;
+    struct collector c;
+    struct kvs_treewalk *tw;
+    struct kvs_treewalk_ops ops = test_ops;
+
+    if (!(dir = treeobj_create_dir ()))
+        BAIL_OUT ("create dir failed");
+    for (int i = 0; i < 40; i++) {
+        char name[16];
+        snprintf (name, sizeof (name), "k%d", i);
+        if (!(o = treeobj_create_val ("x", 1))
+            || treeobj_insert_entry (dir, name, o) < 0)
+            BAIL_OUT ("insert entry failed");
+        json_decref (o);
+    }
+    if (!(hdir = treeobj_hdir_split (dir, 0)))
+        BAIL_OUT ("treeobj_hdir_split failed");
+    json_decref (dir);
+    shards = treeobj_get_count (hdir);
+    json_object_foreach (treeobj_get_data (hdir), slot, shard) {
+        ref = store_treeobj (bs, shard);
+        if (!(o = treeobj_create_dirref (ref))
+            || json_object_set_new (treeobj_get_data (hdir), slot, o) < 0)
+            BAIL_OUT ("replace shard failed");
+        free (ref);
+    }
+    ref = store_treeobj (bs, hdir);
+    json_decref (hdir);
+    if (!(o = treeobj_create_dirref (ref))
+        || !(root = treeobj_create_dir ())
+        || treeobj_insert_entry (root, "big", o) < 0)
+        BAIL_OUT ("create root failed");
+    json_decref (o);
+    free (ref);
+    rootref = store_treeobj (bs, root);
+    json_decref (root);
+
+    collector_init (&c, h);
+    ops.descend = on_descend;
+    tw = kvs_treewalk_create (h, rootref, '/', 4, 0, &ops, &c);
+    ok (kvs_treewalk_run (tw) == 0, "walk with sharded dir ok");
+    ok (c.errors == 0, "sharded dir: no errors (got %d)", c.errors);
+    ok (c.values == 40, "sharded dir: all 40 values visited (got %d)",
+        c.values);
+    ok (visited_has (&c, "big/k0") && visited_has (&c, "big/k39"),
+        "shard entries visited under the directory path");
+    ok (c.descend_calls == shards + 1,
+        "descend called for the dirref and each of %d shards (got %d)",
+        shards,
+        c.descend_calls);
+    ok (zlistx_size (c.visited) == 41,
+        "shards themselves are not visited (got %zu)",
+        zlistx_size (c.visited));
+    kvs_treewalk_destroy (tw);
+    collector_fini (&c);
+    free (rootref);
+}
+
+/* An ivalref's chunk chain is loaded and the value is visited and dumped as
+ * one flattened valref.  Pruning a chunk in descend truncates the value to
+ * the newer blobs.
+ */
+static void test_ivalref (flux_t *h, struct blobstore *bs)
+{
+    json_t *chunk, *root;
+    char *blobref[5];
+    char *prev = NULL;
+    char *rootref;
+    struct collector c;
+    struct kvs_treewalk *tw;
+    struct kvs_treewalk_ops ops = test_ops;
+
+    for (int i = 0; i < 5; i++) {
+        char data[4];
+        memset (data, 'a' + i, sizeof (data));
+        blobref[i] = store (bs, data, sizeof (data));
+    }
+    /* two stored chunks of 2 blobrefs, then 1 inline */
+    for (int i = 0; i < 5; i += 2) {
+        if (!(chunk = treeobj_create_ivalref (prev, i))
+            || treeobj_append_blobref (chunk, blobref[i]) < 0
+            || (i < 4 && treeobj_append_blobref (chunk, blobref[i + 1]) < 0))
+            BAIL_OUT ("create ivalref failed");
+        free (prev);
+        prev = NULL;
+        if (i < 4) {
+            prev = store_treeobj (bs, chunk);
+            json_decref (chunk);
+        }
+    }
+    if (!(root = treeobj_create_dir ())
+        || treeobj_insert_entry (root, "log", chunk) < 0)
+        BAIL_OUT ("create root failed");
+    json_decref (chunk);
+    rootref = store_treeobj (bs, root);
+    json_decref (root);
+
+    collector_init (&c, h);
+    ops.descend = on_descend;
+    tw = kvs_treewalk_create (h, rootref, '/', 4, 0, &ops, &c);
+    ok (kvs_treewalk_run (tw) == 0, "walk with ivalref ok");
+    ok (c.errors == 0, "ivalref: no errors (got %d)", c.errors);
+    ok (c.descend_calls == 2,
+        "descend called for each stored chunk (got %d)",
+        c.descend_calls);
+    ok (zlistx_size (c.visited) == 1 && visited_has (&c, "log"),
+        "ivalref visited once");
+    ok (c.valrefs_done == 1 && c.valref_total_bytes == 20,
+        "ivalref dumped as one value of 5 blobs (got %d bytes)",
+        c.valref_total_bytes);
+    kvs_treewalk_destroy (tw);
+    collector_fini (&c);
+
+    collector_init (&c, h);
+    c.prune_path = "log";
+    tw = kvs_treewalk_create (h, rootref, '/', 4, 0, &ops, &c);
+    ok (kvs_treewalk_run (tw) == 0, "walk with pruned ivalref chunk ok");
+    ok (c.descend_calls == 1 && c.errors == 0,
+        "pruned chunk is not loaded and reports no error");
+    ok (c.valrefs_done == 1 && c.valref_total_bytes == 4,
+        "pruned ivalref dumped with only its inline blob (got %d bytes)",
+        c.valref_total_bytes);
+    kvs_treewalk_destroy (tw);
+    collector_fini (&c);
+
+    for (int i = 0; i < 5; i++)
+        free (blobref[i]);
+    free (rootref);
+}
+
 /* A valref_request override routes valref blob fetches through the caller;
  * the walk otherwise behaves identically.
  */
@@ -634,6 +777,8 @@ int main (int argc, char *argv[])
     test_basic_walk (h, &bs, 64);
     test_separator (h, &bs);
     test_inline_dir (h, &bs);
+    test_hdir (h, &bs);
+    test_ivalref (h, &bs);
     test_valref_request_override (h, &bs);
     test_descend_prune (h, &bs);
     test_valref_noload (h, &bs);
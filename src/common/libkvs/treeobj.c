@@ -15,6 +15,10 @@
 #endif
 #include <errno.h>
 #include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <limits.h>
 #include <assert.h>
 #include <stdbool.h>
 #include <jansson.h>
@@ -27,6 +31,119 @@
 
 static const int treeobj_version = 1;
 
+/* FNV-1a.  Shard placement depends on it, so it must never change.
+ */
+static uint32_t hdir_hash (const char *name)
+{
+    uint32_t h = 2166136261u;
+
+    while (*name) {
+        h ^= (unsigned char)*name++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+/* Shard slots are keyed by two lowercase hex digits, e.g. "1f".
+ */
+static int hdir_slot_key (const char *name, int depth, char *key, size_t size)
+{
+    unsigned int slot;
+
+    if (!name || depth < 0 || depth >= TREEOBJ_HDIR_MAXDEPTH) {
+        errno = EINVAL;
+        return -1;
+    }
+    slot = (hdir_hash (name) >> (depth * TREEOBJ_HDIR_BITS))
+           & (TREEOBJ_HDIR_FANOUT - 1);
+    snprintf (key, size, "%02x", slot);
+    return 0;
+}
+
+static bool hdir_slot_key_valid (const char *key)
+{
+    char *endptr;
+    unsigned long slot;
+
+    if (strlen (key) != 2
+        || !strchr ("0123456789abcdef", key[0])
+        || !strchr ("0123456789abcdef", key[1]))
+        return false;
+    slot = strtoul (key, &endptr, 16);
+    if (*endptr != '\0' || slot >= TREEOBJ_HDIR_FANOUT)
+        return false;
+    return true;
+}
+
+static bool hdir_shard_type (const char *type)
+{
+    return streq (type, "dir")
+           || streq (type, "hdir")
+           || streq (type, "dirref");
+}
+
+/* An ivalref's data is an object:
+ *   "count": total number of blobrefs, including those reached via "prev"
+ *   "prev": (optional) blobref of the previous ivalref chunk
+ *   "chunks": (optional) array of [blobref, count] for all previous chunks
+ *   "blobrefs": array of the most recently appended blobrefs
+ */
+static int ivalref_peek (const json_t *data,
+                         const char **prev,
+                         int *count,
+                         json_t **chunks,
+                         json_t **blobrefs)
+{
+    const char *p = NULL;
+    int c;
+    json_t *x = NULL;
+    json_t *a;
+
+    if (json_unpack ((json_t *)data,
+                     "{s:i s?s s?o s:o !}",
+                     "count", &c,
+                     "prev", &p,
+                     "chunks", &x,
+                     "blobrefs", &a) < 0
+        || (x && !json_is_array (x))
+        || !json_is_array (a)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (prev)
+        *prev = p;
+    if (count)
+        *count = c;
+    if (chunks)
+        *chunks = x;
+    if (blobrefs)
+        *blobrefs = a;
+    return 0;
+}
+
+/* Get entry 'index' of an ivalref "chunks" array.
+ */
+static int ivalref_chunk_peek (json_t *chunks,
+                               int index,
+                               const char **ref,
+                               int *count)
+{
+    json_t *o;
+    const char *r;
+    int c;
+
+    if (!(o = json_array_get (chunks, index))
+        || json_unpack (o, "[si!]", &r, &c) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (ref)
+        *ref = r;
+    if (count)
+        *count = c;
+    return 0;
+}
+
 static int treeobj_unpack (json_t *obj, const char **typep, json_t **datap)
 {
     json_t *data;
@@ -97,6 +214,43 @@ int treeobj_validate (const json_t *obj)
                 goto inval;
         }
     }
+    else if (streq (type, "ivalref")) {
+        const char *prev;
+        int i, count, len;
+        json_t *chunks;
+        json_t *blobrefs;
+        if (ivalref_peek (data, &prev, &count, &chunks, &blobrefs) < 0)
+            goto inval;
+        len = json_array_size (blobrefs);
+        if (len == 0)
+            goto inval;
+        if (prev) {
+            if (blobref_validate (prev) < 0 || count <= len)
+                goto inval;
+        }
+        else if (count != len)
+            goto inval;
+        /* chunk counts increase, and the newest chunk is 'prev' */
+        if (chunks) {
+            const char *ref = NULL;
+            int n, last = 0;
+            if (!prev || json_array_size (chunks) == 0)
+                goto inval;
+            for (i = 0; i < json_array_size (chunks); i++) {
+                if (ivalref_chunk_peek (chunks, i, &ref, &n) < 0
+                    || blobref_validate (ref) < 0
+                    || n <= last)
+                    goto inval;
+                last = n;
+            }
+            if (!streq (ref, prev) || last != count - len)
+                goto inval;
+        }
+        json_array_foreach (blobrefs, i, o) {
+            if (blobref_validate (json_string_value (o)) < 0)
+                goto inval;
+        }
+    }
     else if (streq (type, "dir")) {
         const char *key;
         if (!json_is_object (data))
@@ -109,6 +263,19 @@ int treeobj_validate (const json_t *obj)
                 goto inval;
         }
     }
+    else if (streq (type, "hdir")) {
+        const char *key;
+        const char *shard_type;
+        if (!json_is_object (data))
+            goto inval;
+        json_object_foreach ((json_t *)data, key, o) {
+            if (!hdir_slot_key_valid (key)
+                || !(shard_type = treeobj_get_type (o))
+                || !hdir_shard_type (shard_type)
+                || treeobj_validate (o) < 0)
+                goto inval;
+        }
+    }
     else if (streq (type, "symlink")) {
         json_t *o;
         if (!json_is_object (data))
@@ -162,6 +329,12 @@ bool treeobj_is_valref (const json_t *obj)
     return type && streq (type, "valref");
 }
 
+bool treeobj_is_ivalref (const json_t *obj)
+{
+    const char *type = treeobj_get_type (obj);
+    return type && streq (type, "ivalref");
+}
+
 bool treeobj_is_dir (const json_t *obj)
 {
     const char *type = treeobj_get_type (obj);
@@ -174,6 +347,12 @@ bool treeobj_is_dirref (const json_t *obj)
     return type && streq (type, "dirref");
 }
 
+bool treeobj_is_hdir (const json_t *obj)
+{
+    const char *type = treeobj_get_type (obj);
+    return type && streq (type, "hdir");
+}
+
 json_t *treeobj_get_data (json_t *obj)
 {
     json_t *data;
@@ -218,6 +397,99 @@ int treeobj_get_symlink (const json_t *obj,
     return 0;
 }
 
+int treeobj_get_ivalref (const json_t *obj, const char **prev, int *count)
+{
+    const char *type;
+    const json_t *data;
+
+    if (treeobj_peek (obj, &type, &data) < 0
+        || !streq (type, "ivalref")
+        || ivalref_peek (data, prev, count, NULL, NULL) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int treeobj_get_ivalref_nchunks (const json_t *obj)
+{
+    const char *type;
+    const json_t *data;
+    json_t *chunks;
+
+    if (treeobj_peek (obj, &type, &data) < 0
+        || !streq (type, "ivalref")
+        || ivalref_peek (data, NULL, NULL, &chunks, NULL) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return chunks ? json_array_size (chunks) : 0;
+}
+
+int treeobj_get_ivalref_chunk (const json_t *obj,
+                               int index,
+                               const char **ref,
+                               int *count)
+{
+    const char *type;
+    const json_t *data;
+    json_t *chunks;
+
+    if (treeobj_peek (obj, &type, &data) < 0
+        || !streq (type, "ivalref")
+        || ivalref_peek (data, NULL, NULL, &chunks, NULL) < 0
+        || !chunks
+        || ivalref_chunk_peek (chunks, index, ref, count) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return 0;
+}
+
+int treeobj_append_ivalref_chunk (json_t *obj, const char *ref, int count)
+{
+    const char *type;
+    json_t *data;
+    json_t *chunks;
+    json_t *o;
+
+    if (!ref
+        || blobref_validate (ref) < 0
+        || treeobj_unpack (obj, &type, &data) < 0
+        || !streq (type, "ivalref")
+        || ivalref_peek (data, NULL, NULL, &chunks, NULL) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!chunks) {
+        if (!(chunks = json_array ())
+            || json_object_set_new (data, "chunks", chunks) < 0) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    if (!(o = json_pack ("[si]", ref, count))
+        || json_array_append_new (chunks, o) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+int treeobj_clear_ivalref_chunks (json_t *obj)
+{
+    const char *type;
+    json_t *data;
+
+    if (treeobj_unpack (obj, &type, &data) < 0
+        || !streq (type, "ivalref")) {
+        errno = EINVAL;
+        return -1;
+    }
+    (void)json_object_del (data, "chunks");
+    return 0;
+}
+
 int treeobj_decode_val (const json_t *obj, void **dp, size_t *lp)
 {
     const char *type, *xdatastr;
@@ -268,7 +540,13 @@ int treeobj_get_count (const json_t *obj)
     if (streq (type, "valref") || streq (type, "dirref")) {
         count = json_array_size (data);
     }
-    else if (streq (type, "dir")) {
+    else if (streq (type, "ivalref")) {
+        json_t *blobrefs;
+        if (ivalref_peek (data, NULL, NULL, NULL, &blobrefs) < 0)
+            return -1;
+        count = json_array_size (blobrefs);
+    }
+    else if (streq (type, "dir") || streq (type, "hdir")) {
         count = json_object_size (data);
     }
     else if (streq (type, "symlink") || streq (type, "val")) {
@@ -387,10 +665,14 @@ json_t *treeobj_copy (json_t *obj)
         return NULL;
     }
     /* shallow copy of treeobj data and deep copy of treeobj is
-     * identical except for dir object.
+     * identical except for dir and hdir objects.
      */
-    if (treeobj_is_dir (obj)) {
-        if (!(cpy = treeobj_create_dir ()))
+    if (treeobj_is_dir (obj) || treeobj_is_hdir (obj)) {
+        if (treeobj_is_dir (obj))
+            cpy = treeobj_create_dir ();
+        else
+            cpy = treeobj_create_hdir ();
+        if (!cpy)
             return NULL;
 
         if (!(datacpy = json_copy (data))) {
@@ -423,24 +705,46 @@ int treeobj_append_blobref (json_t *obj, const char *blobref)
 {
     const char *type;
     json_t *data, *o;
+    json_t *blobrefs;
+    int count = 0;
     int rc = -1;
 
     if (!blobref
         || blobref_validate (blobref) < 0
         || treeobj_unpack (obj, &type, &data) < 0
-        || (!streq (type, "dirref") && !streq (type, "valref"))) {
+        || (!streq (type, "dirref")
+            && !streq (type, "valref")
+            && !streq (type, "ivalref"))) {
         errno = EINVAL;
         goto done;
     }
+    if (streq (type, "ivalref")) {
+        if (ivalref_peek (data, NULL, &count, NULL, &blobrefs) < 0)
+            goto done;
+        if (count == INT_MAX) {
+            errno = EOVERFLOW;
+            goto done;
+        }
+    }
+    else
+        blobrefs = data;
     if (!(o = json_string (blobref))) {
         errno = ENOMEM;
         goto done;
     }
-    if (json_array_append_new (data, o) < 0) {
+    if (json_array_append_new (blobrefs, o) < 0) {
         // jansson decrefs the new object on failure
         errno = ENOMEM;
         goto done;
     }
+    if (streq (type, "ivalref")) {
+        if (!(o = json_integer (count + 1))
+            || json_object_set_new (data, "count", o) < 0) {
+            json_array_remove (blobrefs, json_array_size (blobrefs) - 1);
+            errno = ENOMEM;
+            goto done;
+        }
+    }
     rc = 0;
 done:
     return rc;
@@ -453,10 +757,18 @@ const char *treeobj_get_blobref (const json_t *obj, int index)
     const char *type, *blobref = NULL;
 
     if (treeobj_peek (obj, &type, &data) < 0
-        || (!streq (type, "dirref") && !streq (type, "valref"))) {
+        || (!streq (type, "dirref")
+            && !streq (type, "valref")
+            && !streq (type, "ivalref"))) {
         errno = EINVAL;
         goto done;
     }
+    if (streq (type, "ivalref")) {
+        json_t *blobrefs;
+        if (ivalref_peek (data, NULL, NULL, NULL, &blobrefs) < 0)
+            goto done;
+        data = blobrefs;
+    }
     if (!(o = json_array_get (data, index))) {
         errno = EINVAL;
         goto done;
@@ -480,6 +792,20 @@ json_t *treeobj_create_dir (void)
     return obj;
 }
 
+json_t *treeobj_create_hdir (void)
+{
+    json_t *obj;
+
+    if (!(obj = json_pack ("{s:i s:s s:{}}",
+                           "ver", treeobj_version,
+                           "type", "hdir",
+                           "data"))) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return obj;
+}
+
 json_t *treeobj_create_symlink (const char *ns, const char *target)
 {
     json_t *data, *obj;
@@ -563,6 +889,38 @@ json_t *treeobj_create_valref (const char *blobref)
     return obj;
 }
 
+json_t *treeobj_create_ivalref (const char *prev, int count)
+{
+    json_t *obj;
+
+    if (prev ? (blobref_validate (prev) < 0 || count <= 0) : count != 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (prev) {
+        obj = json_pack ("{s:i s:s s:{s:i s:s s:[]}}",
+                         "ver", treeobj_version,
+                         "type", "ivalref",
+                         "data",
+                           "count", count,
+                           "prev", prev,
+                           "blobrefs");
+    }
+    else {
+        obj = json_pack ("{s:i s:s s:{s:i s:[]}}",
+                         "ver", treeobj_version,
+                         "type", "ivalref",
+                         "data",
+                           "count", count,
+                           "blobrefs");
+    }
+    if (!obj) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    return obj;
+}
+
 json_t *treeobj_create_dirref (const char *blobref)
 {
     json_t *obj;
@@ -620,6 +978,116 @@ error:
     return NULL;
 }
 
+json_t *treeobj_hdir_get_shard (json_t *obj, const char *name, int depth)
+{
+    const char *type;
+    json_t *data, *shard;
+    char key[8];
+
+    if (treeobj_unpack (obj, &type, &data) < 0
+        || !streq (type, "hdir")
+        || hdir_slot_key (name, depth, key, sizeof (key)) < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(shard = json_object_get (data, key))) {
+        errno = ENOENT;
+        return NULL;
+    }
+    return shard;
+}
+
+const json_t *treeobj_hdir_peek_shard (const json_t *obj,
+                                       const char *name,
+                                       int depth)
+{
+    const char *type;
+    const json_t *data, *shard;
+    char key[8];
+
+    if (treeobj_peek (obj, &type, &data) < 0
+        || !streq (type, "hdir")
+        || hdir_slot_key (name, depth, key, sizeof (key)) < 0) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(shard = json_object_get (data, key))) {
+        errno = ENOENT;
+        return NULL;
+    }
+    return shard;
+}
+
+int treeobj_hdir_set_shard (json_t *obj,
+                            const char *name,
+                            int depth,
+                            json_t *shard)
+{
+    const char *type, *shard_type;
+    json_t *data;
+    char key[8];
+
+    if (!shard
+        || treeobj_unpack (obj, &type, &data) < 0
+        || !streq (type, "hdir")
+        || treeobj_peek (shard, &shard_type, NULL) < 0
+        || !hdir_shard_type (shard_type)
+        || hdir_slot_key (name, depth, key, sizeof (key)) < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (json_object_set (data, key, shard) < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+json_t *treeobj_hdir_split (const json_t *dir, int depth)
+{
+    const char *type;
+    const json_t *data;
+    const char *name;
+    json_t *entry;
+    json_t *hdir;
+    int save_errno;
+
+    if (treeobj_peek (dir, &type, &data) < 0
+        || !streq (type, "dir")
+        || depth < 0
+        || depth >= TREEOBJ_HDIR_MAXDEPTH) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(hdir = treeobj_create_hdir ()))
+        return NULL;
+    /* N.B. it should be safe to cast away const on 'data' as long as
+     * 'entry' is not modified.  The new shards take references on the
+     * entries, they are not copied.
+     */
+    json_object_foreach ((json_t *)data, name, entry) {
+        json_t *shard;
+
+        if (!(shard = treeobj_hdir_get_shard (hdir, name, depth))) {
+            if (!(shard = treeobj_create_dir ()))
+                goto error;
+            if (treeobj_hdir_set_shard (hdir, name, depth, shard) < 0) {
+                json_decref (shard);
+                goto error;
+            }
+            json_decref (shard);
+        }
+        if (treeobj_insert_entry_novalidate (shard, name, entry) < 0)
+            goto error;
+    }
+    return hdir;
+error:
+    save_errno = errno;
+    json_decref (hdir);
+    errno = save_errno;
+    return NULL;
+}
+
 json_t *treeobj_decode (const char *buf)
 {
     if (!buf) {
@@ -656,10 +1124,14 @@ const char *treeobj_type_name (const json_t *obj)
         return "val";
     else if (treeobj_is_valref (obj))
         return "valref";
+    else if (treeobj_is_ivalref (obj))
+        return "ivalref";
     else if (treeobj_is_dir (obj))
         return "dir";
     else if (treeobj_is_dirref (obj))
         return "dirref";
+    else if (treeobj_is_hdir (obj))
+        return "hdir";
     return "unknown";
 }
 
@@ -19,6 +19,9 @@
 /* Create a treeobj
  * valref, dirref: if blobref is NULL, treeobj_append_blobref()
  * must be called before object is valid.
+ * ivalref: 'prev' is the blobref of the previous chunk, holding 'count'
+ * blobrefs in total, or NULL with 'count' of 0.  treeobj_append_blobref()
+ * must be called before object is valid.
  * val: copies argument (caller retains ownership)
  * symlink: ns argument is optional
  * Return JSON object on success, NULL on failure with errno set.
@@ -26,8 +29,10 @@
 json_t *treeobj_create_symlink (const char *ns, const char *target);
 json_t *treeobj_create_val (const void *data, size_t len);
 json_t *treeobj_create_valref (const char *blobref);
+json_t *treeobj_create_ivalref (const char *prev, int count);
 json_t *treeobj_create_dir (void);
 json_t *treeobj_create_dirref (const char *blobref);
+json_t *treeobj_create_hdir (void);
 
 /* Validate treeobj, recursively.
  * Return 0 if valid, -1 with errno = EINVAL if invalid.
@@ -43,12 +48,16 @@ const char *treeobj_get_type (const json_t *obj);
 bool treeobj_is_symlink (const json_t *obj);
 bool treeobj_is_val (const json_t *obj);
 bool treeobj_is_valref (const json_t *obj);
+bool treeobj_is_ivalref (const json_t *obj);
 bool treeobj_is_dir (const json_t *obj);
 bool treeobj_is_dirref (const json_t *obj);
+bool treeobj_is_hdir (const json_t *obj);
 
 /* get type-specific value.
  * For dirref/valref, this is an array of blobrefs.
+ * For ivalref, this is an object with count, optional prev, and blobrefs.
  * For directory, this is dictionary of treeobjs
+ * For hdir, this is a dictionary of shards keyed by slot.
  * For symlink, this is an object with optional namespace and target.
  * For val this is string containing base64-encoded data.
  * Return JSON object on success, NULL on error with errno = EINVAL.
@@ -62,6 +71,32 @@ int treeobj_get_symlink (const json_t *obj,
                          const char **ns,
                          const char **target);
 
+/* Indirect valref (ivalref) support.
+ * An ivalref stands in for a valref with many blobrefs, such as a key that
+ * is frequently appended to.  It holds the most recently appended blobrefs
+ * inline, and 'prev', the blobref of an encoded ivalref holding the ones
+ * before them (which may in turn have a 'prev').  'count' is the total
+ * number of blobrefs in the chain.  'prev' is set to NULL on the last link.
+ */
+int treeobj_get_ivalref (const json_t *obj, const char **prev, int *count);
+
+/* The ivalref stored in a directory also carries an index of all of its
+ * chunks, oldest first, so that the chunks holding a range of blobrefs
+ * can be found without following 'prev' through each one.  Entry 'index'
+ * is the blobref of a chunk and the total 'count' through that chunk.
+ * The index is not stored with the chunks themselves.
+ * treeobj_get_ivalref_nchunks() returns the number of entries, 0 if there
+ * is no index, or -1 on error.  Other functions return 0 on success, -1 on
+ * error with errno set.
+ */
+int treeobj_get_ivalref_nchunks (const json_t *obj);
+int treeobj_get_ivalref_chunk (const json_t *obj,
+                               int index,
+                               const char **ref,
+                               int *count);
+int treeobj_append_ivalref_chunk (json_t *obj, const char *ref, int count);
+int treeobj_clear_ivalref_chunks (json_t *obj);
+
 /* get decoded val data.
  * If len == 0, data will be NULL.
  * If len > 0, data will be followed by an extra NULL byte in memory.
@@ -71,7 +106,9 @@ int treeobj_decode_val (const json_t *obj, void **data, size_t *len);
 
 /* get type-specific count.
  * For dirref/valref, this is the number of blobrefs.
+ * For ivalref, this is the number of inline blobrefs.
  * For directory, this is number of entries
+ * For hdir, this is the number of non-empty shards.
  * For symlink or val, this is 1.
  * Return count on success, -1 on error with errno = EINVAL.
  */
@@ -111,12 +148,12 @@ json_t *treeobj_copy (json_t *obj);
 /* Deep copy a treeobj */
 json_t *treeobj_deep_copy (const json_t *obj);
 
-/* add blobref to dirref,valref object.
+/* add blobref to dirref,valref,ivalref object.
  * Return 0 on success, -1 on failure with errno set.
  */
 int treeobj_append_blobref (json_t *obj, const char *blobref);
 
-/* get blobref entry at 'index'.
+/* get blobref entry at 'index' (of the inline blobrefs, for ivalref).
  * Return blobref on success, NULL on failure with errno set.
  */
 const char *treeobj_get_blobref (const json_t *obj, int index);
@@ -130,6 +167,34 @@ json_t *treeobj_create_valref_buf (const char *hashtype,
                                    void *data,
                                    int len);
 
+/* Sharded directory (hdir) support.
+ * An hdir stands in for a large directory.  Its entries are spread across
+ * up to TREEOBJ_HDIR_FANOUT shards, each a dir, hdir, or dirref, chosen by
+ * TREEOBJ_HDIR_BITS bits of a hash of the entry name.  Which bits are used
+ * depends on 'depth', which is 0 for an hdir referenced by a directory
+ * entry and increases by one for each hdir nested within it.  A dirref may
+ * point to an hdir as well as to a dir.
+ * get_shard returns the shard that holds (or would hold) 'name', owned by
+ * 'obj', or NULL with errno = ENOENT if that slot is empty.
+ * set_shard takes a reference on 'shard' and does not validate it beyond
+ * its type.
+ * split creates an hdir at 'depth' from the entries of 'dir', placing them
+ * in inline dir shards.  It fails with EINVAL if depth is out of range.
+ */
+#define TREEOBJ_HDIR_BITS       5
+#define TREEOBJ_HDIR_FANOUT     (1 << TREEOBJ_HDIR_BITS)
+#define TREEOBJ_HDIR_MAXDEPTH   (32 / TREEOBJ_HDIR_BITS)
+
+json_t *treeobj_hdir_get_shard (json_t *obj, const char *name, int depth);
+const json_t *treeobj_hdir_peek_shard (const json_t *obj,
+                                       const char *name,
+                                       int depth);
+int treeobj_hdir_set_shard (json_t *obj,
+                            const char *name,
+                            int depth,
+                            json_t *shard);
+json_t *treeobj_hdir_split (const json_t *dir, int depth);
+
 /* Convert a treeobj to/from string.
  * The return value of treeobj_decode must be destroyed with json_decref().
  * The return value of treeobj_encode must be destroyed with free().
@@ -139,8 +204,8 @@ json_t *treeobj_decodeb (const char *buf, size_t buflen);
 char *treeobj_encode (const json_t *obj);
 
 /* Get treeobj type name
- * Returns "symlink", "val", "valref", "dir", "dirref" or NULL if
- * invalid treeobj.
+ * Returns "symlink", "val", "valref", "ivalref", "dir", "dirref", "hdir", or
+ * "unknown" if invalid treeobj.
  */
 const char *treeobj_type_name (const json_t *obj);
 
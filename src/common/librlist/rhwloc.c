@@ -17,6 +17,9 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <sys/utsname.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <hwloc/shmem.h>
 
 #include <flux/idset.h>
 #include <jansson.h>
@@ -101,7 +104,7 @@ hwloc_topology_t rhwloc_xml_topology_load (const char *xml,
 {
     hwloc_topology_t topo = NULL;
     int flags = 0;
-    if (!(in_flags & RHWLOC_NO_RESTRICT))
+    if (!(in_flags & RHWLOC_NO_RESTRICT) || (in_flags & RHWLOC_THISSYSTEM))
         flags |= HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM;
     if (init_topo_from_xml (&topo, xml, flags) < 0)
         return NULL;
@@ -245,6 +248,145 @@ char *rhwloc_local_topology_xml (rhwloc_flags_t rflags)
     return result;
 }
 
+/*  Shared memory topology file format: a header page followed by the
+ *  topology as written by hwloc_shmem_topology_write().  The topology
+ *  must be mapped at the same virtual address in every process, so
+ *  the address is recorded in the header.
+ */
+#define SHMEM_MAGIC 0x666c7868  /* "flxh" */
+
+struct shmem_header {
+    uint32_t magic;
+    uint32_t api_version;
+    uint64_t offset;
+    uint64_t address;
+    uint64_t length;
+};
+
+/*  Candidate mapping addresses, chosen to be well clear of where Linux
+ *  places the heap, shared libraries, and stack on 64-bit systems.
+ */
+static const uint64_t shmem_addresses[] = {
+    0x10000000000ULL,
+    0x20000000000ULL,
+    0x30000000000ULL,
+    0x40000000000ULL,
+};
+
+static size_t shmem_offset (void)
+{
+    long pagesize = sysconf (_SC_PAGESIZE);
+    size_t offset = pagesize > 0 ? pagesize : 4096;
+
+    while (offset < sizeof (struct shmem_header))
+        offset *= 2;
+    return offset;
+}
+
+static int shmem_write_fd (hwloc_topology_t topo, int fd)
+{
+    struct shmem_header hdr = {
+        .magic = SHMEM_MAGIC,
+        .api_version = HWLOC_API_VERSION,
+        .offset = shmem_offset (),
+    };
+    size_t length;
+    int i;
+
+    if (hwloc_shmem_topology_get_length (topo, &length, 0) < 0)
+        return -1;
+    hdr.length = length;
+    if (ftruncate (fd, hdr.offset + hdr.length) < 0)
+        return -1;
+    for (i = 0; i < sizeof (shmem_addresses) / sizeof (shmem_addresses[0]);
+         i++) {
+        if (hwloc_shmem_topology_write (topo,
+                                        fd,
+                                        hdr.offset,
+                                        (void *)(uintptr_t)shmem_addresses[i],
+                                        length,
+                                        0) == 0) {
+            hdr.address = shmem_addresses[i];
+            break;
+        }
+        if (errno != EBUSY)
+            return -1;
+    }
+    if (hdr.address == 0) {
+        errno = EBUSY;
+        return -1;
+    }
+    if (pwrite (fd, &hdr, sizeof (hdr), 0) != sizeof (hdr))
+        return -1;
+    return 0;
+}
+
+int rhwloc_topology_shmem_write (hwloc_topology_t topo, const char *path)
+{
+    char *tmp = NULL;
+    int fd = -1;
+
+    if (!topo || !path || sizeof (void *) < sizeof (uint64_t)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (asprintf (&tmp, "%s.XXXXXX", path) < 0)
+        return -1;
+    if ((fd = mkstemp (tmp)) < 0)
+        goto error;
+    if (shmem_write_fd (topo, fd) < 0 || close (fd) < 0)
+        goto error;
+    fd = -1;
+    /*  Replace any existing file atomically, since it may be adopted
+     *  concurrently.
+     */
+    if (rename (tmp, path) < 0)
+        goto error;
+    free (tmp);
+    return 0;
+error:
+    if (fd >= 0)
+        ERRNO_SAFE_WRAP (close, fd);
+    if (tmp)
+        ERRNO_SAFE_WRAP (unlink, tmp);
+    ERRNO_SAFE_WRAP (free, tmp);
+    return -1;
+}
+
+hwloc_topology_t rhwloc_topology_shmem_adopt (const char *path)
+{
+    struct shmem_header hdr;
+    hwloc_topology_t topo = NULL;
+    int fd;
+
+    if (!path) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if ((fd = open (path, O_RDONLY)) < 0)
+        return NULL;
+    if (pread (fd, &hdr, sizeof (hdr), 0) != sizeof (hdr)
+        || hdr.magic != SHMEM_MAGIC
+        || hdr.api_version != HWLOC_API_VERSION
+        || hdr.address > UINTPTR_MAX) {
+        errno = EINVAL;
+        goto out;
+    }
+    /*  N.B. this fails with EBUSY if the address is already in use
+     *  in this process.  The mapping survives close(2) of the file.
+     */
+    if (hwloc_shmem_topology_adopt (&topo,
+                                    fd,
+                                    hdr.offset,
+                                    (void *)(uintptr_t)hdr.address,
+                                    hdr.length,
+                                    0) < 0)
+        topo = NULL;
+out:
+    ERRNO_SAFE_WRAP (close, fd);
+    return topo;
+}
+
 const char * rhwloc_hostname (hwloc_topology_t topo)
 {
     static char hostname[_POSIX_HOST_NAME_MAX + 1];
@@ -17,7 +17,9 @@
 #include "src/common/libflux/types.h" /* flux_error_t */
 
 typedef enum {
-    RHWLOC_NO_RESTRICT = 0x1
+    RHWLOC_NO_RESTRICT = 0x1,
+    RHWLOC_THISSYSTEM = 0x2,    /* with NO_RESTRICT, still mark topology
+                                 * as from this system for CPU binding */
 } rhwloc_flags_t;
 
 /*  Load local topology with Flux standard flags and filtering
@@ -39,6 +41,23 @@ char *rhwloc_local_topology_xml (rhwloc_flags_t flags);
  */
 char *rhwloc_topology_xml_restrict (const char *xml);
 
+/*  Name of the shared topology file in a broker's rundir.
+ */
+#define RHWLOC_SHMEM_FILE "hwloc.shmem"
+
+/*  Write topology to 'path' in hwloc shared memory format, so that other
+ *  processes on this node can attach to it without parsing XML.
+ *  Any existing file is replaced atomically.
+ */
+int rhwloc_topology_shmem_write (hwloc_topology_t topo, const char *path);
+
+/*  Attach read-only to a topology written by rhwloc_topology_shmem_write().
+ *  Destroy the result with hwloc_topology_destroy().  Returns NULL if
+ *  the file is missing or incompatible, or if its mapping address is
+ *  already in use, in which case the caller should fall back to XML.
+ */
+hwloc_topology_t rhwloc_topology_shmem_adopt (const char *path);
+
 /*  Return HostName from an hwloc topology object
  */
 const char *rhwloc_hostname (hwloc_topology_t topo);
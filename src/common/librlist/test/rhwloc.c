@@ -11,6 +11,8 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <stdlib.h>
+#include <unistd.h>
 #include <flux/hostlist.h>
 #include <jansson.h>
 
@@ -978,6 +980,62 @@ void test_gpu_objects (void)
     hwloc_topology_destroy (topo);
 }
 
+void test_shmem (void)
+{
+    hwloc_topology_t topo;
+    hwloc_topology_t adopted;
+    hwloc_topology_t adopted2;
+    const char *tmpdir = getenv ("TMPDIR");
+    char path[1024];
+    char *s1, *s2;
+    int fd;
+
+    snprintf (path, sizeof (path), "%s/shmem.XXXXXX", tmpdir ? tmpdir : "/tmp");
+    if ((fd = mkstemp (path)) < 0)
+        BAIL_OUT ("mkstemp %s: %s", path, strerror (errno));
+    close (fd);
+
+    topo = rhwloc_xml_topology_load (xml_multi_backend, RHWLOC_NO_RESTRICT);
+    if (!topo)
+        BAIL_OUT ("failed to load multi-backend GPU topology");
+
+    errno = 0;
+    ok (rhwloc_topology_shmem_write (NULL, path) < 0 && errno == EINVAL,
+        "rhwloc_topology_shmem_write topo=NULL fails with EINVAL");
+    ok (rhwloc_topology_shmem_adopt (path) == NULL,
+        "rhwloc_topology_shmem_adopt fails on invalid file");
+
+    ok (rhwloc_topology_shmem_write (topo, path) == 0,
+        "rhwloc_topology_shmem_write works");
+    adopted = rhwloc_topology_shmem_adopt (path);
+    ok (adopted != NULL,
+        "rhwloc_topology_shmem_adopt works");
+    if (!adopted)
+        BAIL_OUT ("cannot continue without adopted topology");
+    ok (rhwloc_count_type (adopted, "core") == 1
+        && rhwloc_count_type (adopted, "gpu") == 2,
+        "adopted topology has 1 core and 2 gpus");
+    s1 = rhwloc_core_idset_string (topo, NULL);
+    s2 = rhwloc_core_idset_string (adopted, NULL);
+    ok (s1 && s2 && strcmp (s1, s2) == 0,
+        "adopted topology has same cores as original");
+    free (s1);
+    free (s2);
+    ok (strcmp (rhwloc_hostname (adopted), "testhost") == 0,
+        "adopted topology has expected hostname");
+
+    errno = 0;
+    adopted2 = rhwloc_topology_shmem_adopt (path);
+    ok (adopted2 == NULL && errno == EBUSY,
+        "rhwloc_topology_shmem_adopt fails with EBUSY if already mapped");
+
+    hwloc_topology_destroy (adopted);
+    hwloc_topology_destroy (topo);
+
+    unlink (path);
+    ok (rhwloc_topology_shmem_adopt (path) == NULL && errno == ENOENT,
+        "rhwloc_topology_shmem_adopt fails with ENOENT on missing file");
+}
 
 int main (int ac, char *av[])
 {
@@ -988,6 +1046,7 @@ int main (int ac, char *av[])
     test_xml ();
     test_cores_to_cpuset ();
     test_gpu_objects ();
+    test_shmem ();
 
     done_testing ();
 }
@@ -20,6 +20,7 @@
 
 #include "router.h"
 #include "subhash.h"
+#include "subtrie.h"
 #include "servhash.h"
 #include "disconnect.h"
 
@@ -37,6 +38,7 @@ struct router {
     zhashx_t *routes;               // uuid => 'struct router_entry'
     void *arg;
     struct subhash *subscriptions;  // router's subscriber hash
+    struct subtrie *subscribers;    // topic => router entries
     struct servhash *services;
     flux_msg_handler_t **handlers;
     bool mute;
@@ -228,12 +230,20 @@ static int broker_unsubscribe (const char *topic, void *arg)
 
 /* A client asks the router to subscribe.
  * This might generate a broker_subscribe() or just usecount++.
+ * The client is also indexed by topic for event distribution.
  */
 static int router_subscribe (const char *topic, void *arg)
 {
-    struct router *rtr = arg;
+    struct router_entry *entry = arg;
+    struct router *rtr = entry->rtr;
 
-    return subhash_subscribe (rtr->subscriptions, topic);
+    if (subhash_subscribe (rtr->subscriptions, topic) < 0)
+        return -1;
+    if (subtrie_insert (rtr->subscribers, topic, entry) < 0) {
+        ERRNO_SAFE_WRAP (subhash_unsubscribe, rtr->subscriptions, topic);
+        return -1;
+    }
+    return 0;
 }
 
 /* A client asks the router to unsubscribe.
@@ -241,9 +251,12 @@ static int router_subscribe (const char *topic, void *arg)
  */
 static int router_unsubscribe (const char *topic, void *arg)
 {
-    struct router *rtr = arg;
+    struct router_entry *entry = arg;
+    struct router *rtr = entry->rtr;
 
-    return subhash_unsubscribe (rtr->subscriptions, topic);
+    if (subhash_unsubscribe (rtr->subscriptions, topic) < 0)
+        return -1;
+    return subtrie_remove (rtr->subscribers, topic, entry);
 }
 
 static void disconnect_cb (const flux_msg_t *msg, void *arg)
@@ -319,8 +332,8 @@ struct router_entry *router_entry_add (struct router *rtr,
     if (!(entry = router_entry_create (uuid, cb, arg)))
         return NULL;
 
-    subhash_set_subscribe (entry->subscriptions, router_subscribe, rtr);
-    subhash_set_unsubscribe (entry->subscriptions, router_unsubscribe, rtr);
+    subhash_set_subscribe (entry->subscriptions, router_subscribe, entry);
+    subhash_set_unsubscribe (entry->subscriptions, router_unsubscribe, entry);
 
     if (zhashx_insert (rtr->routes, uuid, entry) < 0) {
         router_entry_destroy (entry);
@@ -398,6 +411,19 @@ error:
     return;
 }
 
+// subtrie_match_f footprint
+static void event_send (void *subscriber, void *arg)
+{
+    struct router_entry *entry = subscriber;
+    const flux_msg_t *msg = arg;
+
+    if (entry->send (msg, entry->arg) < 0) {
+        flux_log_error (entry->rtr->h,
+                        "router: event > client=%.5s",
+                        entry->uuid);
+    }
+}
+
 /* Receive event from broker.
  * Distribute to all router entries with matching subscriptions.
  */
@@ -407,22 +433,14 @@ static void event_cb (flux_t *h,
                       void *arg)
 {
     struct router *rtr = arg;
-    struct router_entry *entry;
     const char *topic;
 
-    if (flux_msg_get_topic (msg, &topic) < 0) {
+    if (flux_msg_get_topic (msg, &topic) < 0
+        || subtrie_match (rtr->subscribers,
+                          topic,
+                          event_send,
+                          (void *)msg) < 0)
         flux_log_error (h, "router: event > client");
-        return;
-    }
-
-    entry = zhashx_first (rtr->routes);
-    while ((entry)) {
-        if (subhash_topic_match (entry->subscriptions, topic)) {
-            if (entry->send (msg, entry->arg) < 0)
-                flux_log_error (h, "router: event > client=%.5s", entry->uuid);
-        }
-        entry = zhashx_next (rtr->routes);
-    }
 }
 
 static const struct flux_msg_handler_spec htab[] = {
@@ -448,7 +466,8 @@ struct router *router_create (flux_t *h)
         goto error;
     zhashx_set_destructor (rtr->routes, router_entry_destructor);
 
-    if (!(rtr->subscriptions = subhash_create ()))
+    if (!(rtr->subscriptions = subhash_create ())
+        || !(rtr->subscribers = subtrie_create ()))
         goto error;
     subhash_set_subscribe (rtr->subscriptions, broker_subscribe, rtr);
     subhash_set_unsubscribe (rtr->subscriptions, broker_unsubscribe, rtr);
@@ -469,9 +488,13 @@ void router_destroy (struct router *rtr)
 {
     if (rtr) {
         flux_msg_handler_delvec (rtr->handlers);
+        /* N.B. destroying routes unsubscribes each entry, which
+         * requires the router's subscriber hash and index.
+         */
+        ERRNO_SAFE_WRAP (zhashx_destroy, &rtr->routes);
         subhash_destroy (rtr->subscriptions);
+        subtrie_destroy (rtr->subscribers);
         servhash_destroy (rtr->services);
-        ERRNO_SAFE_WRAP (zhashx_destroy, &rtr->routes);
         ERRNO_SAFE_WRAP (free, rtr);
     }
 }
@@ -39,6 +39,16 @@
  *   is assembled, then it is freed.  The static buffer is sized somewhat
  *   arbitrarily at 4K.
  *
+ * - sendfd_batch() gathers the frames of many queued messages into one
+ *   writev(2), copying small frames (routes, topic, proto) and headers into
+ *   a scratch buffer and referencing large payloads in place.  Only if the
+ *   kernel accepts part of a message is that message encoded into the iobuf,
+ *   so the remainder can be finished by sendfd() when the fd is writable.
+ *
+ * - recvfd_fill() reads whatever is available into a larger rxbuf, then
+ *   recvfd_next() splits out complete messages, so a burst of small messages
+ *   costs one read(2) rather than two per message.
+ *
  * - sendfd/recvfd do not encrypt messages, therefore this transport
  *   is only appropriate for use on AF_LOCAL sockets or on file descriptors
  *   tunneled through a secure channel.
@@ -47,14 +57,34 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <sys/uio.h>
 #include <arpa/inet.h>
 #include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
 #include <flux/core.h>
 
+#include "src/common/libflux/message_iovec.h"
+#include "src/common/libflux/message_proto.h"
+
 #include "sendfd.h"
 
 #define IOBUF_MAGIC 0xffee0012
 
+#define BATCH_IOV_MAX       64      // iovec entries per writev(2)
+#define BATCH_MSG_MAX       128     // messages per writev(2)
+#define BATCH_COPY_MAX      128     // frames up to this size are copied
+#define BATCH_SCRATCH_SIZE  4096    // space for headers and copied frames
+
+#define RXBUF_SIZE          16384   // default read-ahead buffer size
+
+struct batch {
+    struct iovec iov[BATCH_IOV_MAX];
+    int iovcnt;
+    uint8_t scratch[BATCH_SCRATCH_SIZE];
+    size_t used;
+};
+
 void iobuf_init (struct iobuf *iobuf)
 {
     memset (iobuf, 0, sizeof (*iobuf));
@@ -67,6 +97,38 @@ void iobuf_clean (struct iobuf *iobuf)
     memset (iobuf, 0, sizeof (*iobuf));
 }
 
+void rxbuf_init (struct rxbuf *rxbuf)
+{
+    memset (rxbuf, 0, sizeof (*rxbuf));
+}
+
+void rxbuf_clean (struct rxbuf *rxbuf)
+{
+    free (rxbuf->buf);
+    memset (rxbuf, 0, sizeof (*rxbuf));
+}
+
+/* Encode 'msg' with its header into an idle iobuf.
+ */
+static int iobuf_encode (struct iobuf *io, const flux_msg_t *msg)
+{
+    ssize_t s;
+
+    if ((s = flux_msg_encode_size (msg)) < 0)
+        return -1;
+    io->size = s + 8;
+    if (io->size <= sizeof (io->buf_fixed))
+        io->buf = io->buf_fixed;
+    else if (!(io->buf = malloc (io->size)))
+        return -1;
+    *(uint32_t *)&io->buf[0] = IOBUF_MAGIC;
+    *(uint32_t *)&io->buf[4] = htonl (io->size - 8);
+    io->done = 0;
+    if (flux_msg_encode (msg, &io->buf[8], io->size - 8) < 0)
+        return -1;
+    return 0;
+}
+
 int sendfd (int fd, const flux_msg_t *msg, struct iobuf *iobuf)
 {
     struct iobuf local;
@@ -80,19 +142,8 @@ int sendfd (int fd, const flux_msg_t *msg, struct iobuf *iobuf)
     if (!iobuf)
         iobuf_init (&local);
     if (!io->buf) {
-        ssize_t s;
-        if ((s = flux_msg_encode_size (msg)) < 0)
-            goto done;
-        io->size = s + 8;
-        if (io->size <= sizeof (io->buf_fixed))
-            io->buf = io->buf_fixed;
-        else if (!(io->buf = malloc (io->size)))
+        if (iobuf_encode (io, msg) < 0)
             goto done;
-        *(uint32_t *)&io->buf[0] = IOBUF_MAGIC;
-        *(uint32_t *)&io->buf[4] = htonl (io->size - 8);
-        if (flux_msg_encode (msg, &io->buf[8], io->size - 8) < 0)
-            goto done;
-        io->done = 0;
     }
     do {
         rc = write (fd, io->buf + io->done, io->size - io->done);
@@ -113,6 +164,177 @@ done:
     return rc;
 }
 
+/* Append 'len' bytes to the batch, either by reference, or by copying them
+ * into the scratch buffer, extending the previous iovec entry if it ends
+ * where the copy begins.  The caller has checked that there is room.
+ */
+static void batch_append (struct batch *b,
+                          const void *data,
+                          size_t len,
+                          bool copy)
+{
+    if (len == 0)
+        return;
+    if (copy) {
+        uint8_t *dst = &b->scratch[b->used];
+        struct iovec *last = b->iovcnt > 0 ? &b->iov[b->iovcnt - 1] : NULL;
+
+        memcpy (dst, data, len);
+        b->used += len;
+        if (last && (uint8_t *)last->iov_base + last->iov_len == dst) {
+            last->iov_len += len;
+            return;
+        }
+        data = dst;
+    }
+    b->iov[b->iovcnt].iov_base = (void *)data;
+    b->iov[b->iovcnt].iov_len = len;
+    b->iovcnt++;
+}
+
+/* Add 'msg' to the batch, setting 'wire_size' to its size on the wire
+ * including header.  Fail with ENOSPC if the batch cannot accommodate it.
+ */
+static int batch_add (struct batch *b, const flux_msg_t *msg, size_t *wire_size)
+{
+    uint8_t proto[PROTO_SIZE];
+    struct msg_iovec *iov;
+    int iovcnt;
+    size_t need_scratch = 8;
+    int need_iov = 1;
+    size_t size = 0;
+    uint32_t hdr[2];
+
+    if (msg_to_iovec (msg, proto, PROTO_SIZE, &iov, &iovcnt) < 0)
+        return -1;
+    for (int i = 0; i < iovcnt; i++) {
+        size_t prefix = iov[i].size < 0xff ? 1 : 5;
+
+        size += prefix + iov[i].size;
+        need_scratch += prefix;
+        if (iov[i].size <= BATCH_COPY_MAX)
+            need_scratch += iov[i].size;
+        else
+            need_iov += 2;
+    }
+    if (b->used + need_scratch > sizeof (b->scratch)
+        || b->iovcnt + need_iov > BATCH_IOV_MAX) {
+        free (iov);
+        errno = ENOSPC;
+        return -1;
+    }
+    hdr[0] = IOBUF_MAGIC;
+    hdr[1] = htonl (size);
+    batch_append (b, hdr, sizeof (hdr), true);
+    for (int i = 0; i < iovcnt; i++) {
+        uint8_t prefix[5];
+        size_t prefix_len;
+
+        if (iov[i].size < 0xff) {
+            prefix[0] = iov[i].size;
+            prefix_len = 1;
+        }
+        else {
+            uint32_t n = htonl (iov[i].size);
+            prefix[0] = 0xff;
+            memcpy (&prefix[1], &n, sizeof (n));
+            prefix_len = 5;
+        }
+        batch_append (b, prefix, prefix_len, true);
+        batch_append (b,
+                      iov[i].data,
+                      iov[i].size,
+                      iov[i].size <= BATCH_COPY_MAX);
+    }
+    free (iov);
+    *wire_size = size + 8;
+    return 0;
+}
+
+int sendfd_batch (int fd,
+                  const flux_msg_t *msgs[],
+                  int count,
+                  struct iobuf *iobuf)
+{
+    struct batch b;
+    size_t wire_size[BATCH_MSG_MAX];
+    int sent = 0;
+
+    if (fd < 0 || !msgs || count < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* Finish a message left partially written by the previous call.
+     */
+    if (count > 0 && iobuf && iobuf->buf) {
+        if (sendfd (fd, msgs[0], iobuf) < 0)
+            return -1;
+        sent++;
+    }
+    while (sent < count) {
+        int nmsgs = 0;
+        ssize_t n;
+        int i;
+
+        b.iovcnt = 0;
+        b.used = 0;
+        while (sent + nmsgs < count && nmsgs < BATCH_MSG_MAX) {
+            if (batch_add (&b, msgs[sent + nmsgs], &wire_size[nmsgs]) < 0) {
+                if (errno != ENOSPC)
+                    goto error;
+                break;
+            }
+            nmsgs++;
+        }
+        /* A message too big for an empty batch (e.g. one with very many
+         * routes) is encoded and sent on its own.
+         */
+        if (nmsgs == 0) {
+            if (sendfd (fd, msgs[sent], iobuf) < 0)
+                goto error;
+            sent++;
+            continue;
+        }
+        if ((n = writev (fd, b.iov, b.iovcnt)) < 0)
+            goto error;
+        for (i = 0; i < nmsgs && n >= wire_size[i]; i++) {
+            n -= wire_size[i];
+            sent++;
+        }
+        if (i < nmsgs) {
+            struct iobuf local;
+            struct iobuf *io = iobuf ? iobuf : &local;
+
+            /* The fd is full.  Save the rest of the partially written
+             * message in iobuf, or in blocking mode, finish it now.
+             */
+            if (n == 0)
+                break;
+            if (!iobuf)
+                iobuf_init (&local);
+            if (iobuf_encode (io, msgs[sent]) < 0) {
+                iobuf_clean (io);
+                goto error;
+            }
+            io->done = n;
+            if (iobuf)
+                break;
+            if (sendfd (fd, msgs[sent], &local) < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK)
+                    errno = EPROTO;
+                iobuf_clean (&local);
+                goto error;
+            }
+            sent++;
+        }
+    }
+    return sent;
+error:
+    if (sent > 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        return sent;
+    return -1;
+}
+
 flux_msg_t *recvfd (int fd, struct iobuf *iobuf)
 {
     struct iobuf local;
@@ -178,6 +400,86 @@ done:
     return msg;
 }
 
+ssize_t recvfd_fill (int fd, struct rxbuf *rxbuf)
+{
+    size_t need = RXBUF_SIZE;
+    ssize_t n;
+
+    if (fd < 0 || !rxbuf) {
+        errno = EINVAL;
+        return -1;
+    }
+    /* Move any partial message to the front of the buffer, and if its
+     * header has arrived, make sure the buffer is large enough to hold it.
+     */
+    if (rxbuf->start > 0) {
+        memmove (rxbuf->buf,
+                 rxbuf->buf + rxbuf->start,
+                 rxbuf->end - rxbuf->start);
+        rxbuf->end -= rxbuf->start;
+        rxbuf->start = 0;
+    }
+    if (rxbuf->end >= 8) {
+        uint32_t size;
+        memcpy (&size, &rxbuf->buf[4], sizeof (size));
+        if (ntohl (size) + 8 > need)
+            need = ntohl (size) + 8;
+    }
+    if (rxbuf->size < need) {
+        uint8_t *buf;
+        if (!(buf = realloc (rxbuf->buf, need)))
+            return -1;
+        rxbuf->buf = buf;
+        rxbuf->size = need;
+    }
+    if (rxbuf->end == rxbuf->size) // complete messages not yet consumed
+        return 0;
+    if ((n = read (fd, rxbuf->buf + rxbuf->end, rxbuf->size - rxbuf->end)) < 0)
+        return -1;
+    if (n == 0) {
+        errno = ECONNRESET;
+        return -1;
+    }
+    rxbuf->end += n;
+    return n;
+}
+
+flux_msg_t *recvfd_next (struct rxbuf *rxbuf)
+{
+    flux_msg_t *msg;
+    uint32_t hdr[2];
+    size_t size;
+
+    if (!rxbuf) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (rxbuf->end - rxbuf->start < 8)
+        goto again;
+    memcpy (hdr, rxbuf->buf + rxbuf->start, sizeof (hdr));
+    if (hdr[0] != IOBUF_MAGIC) {
+        errno = EPROTO;
+        return NULL;
+    }
+    size = ntohl (hdr[1]);
+    if (rxbuf->end - rxbuf->start - 8 < size)
+        goto again;
+    if (!(msg = flux_msg_decode (rxbuf->buf + rxbuf->start + 8, size)))
+        return NULL;
+    rxbuf->start += size + 8;
+    /* Once drained, release a buffer that was enlarged for a big message.
+     */
+    if (rxbuf->start == rxbuf->end) {
+        rxbuf->start = rxbuf->end = 0;
+        if (rxbuf->size > RXBUF_SIZE)
+            rxbuf_clean (rxbuf);
+    }
+    return msg;
+again:
+    errno = EAGAIN;
+    return NULL;
+}
+
 /*
  * vi:tabstop=4 shiftwidth=4 expandtab
  */
@@ -26,12 +26,53 @@ struct iobuf {
  */
 int sendfd (int fd, const flux_msg_t *msg, struct iobuf *iobuf);
 
+/* Send up to 'count' messages from 'msgs' to file descriptor, gathering
+ * many messages into each writev(2) directly from their frames rather than
+ * encoding each one into a buffer and writing it separately.
+ * If a message is only partially written, its remainder is kept in iobuf,
+ * and it must be passed again as msgs[0] on the next call, as with sendfd().
+ * Returns the number of messages sent in full, or -1 on failure with errno
+ * set.  If the fd would block before any message is completed, fails with
+ * EAGAIN/EWOULDBLOCK.
+ */
+int sendfd_batch (int fd,
+                  const flux_msg_t *msgs[],
+                  int count,
+                  struct iobuf *iobuf);
+
 /* Receive message from file descriptor.
  * iobuf captures intermediate state to make EAGAIN/EWOULDBLOCK restartable.
  * Returns message on success, NULL on failure with errno set.
  */
 flux_msg_t *recvfd (int fd, struct iobuf *iobuf);
 
+/* Read-ahead buffer for recvfd_fill() and recvfd_next().
+ */
+struct rxbuf {
+    uint8_t *buf;
+    size_t size;
+    size_t start;       // offset of first unconsumed byte
+    size_t end;         // offset just past last byte read
+};
+
+/* Read as much as is available from file descriptor into rxbuf, with a
+ * single read(2) that may span many messages.
+ * Returns the number of bytes read, or -1 on failure with errno set
+ * (ECONNRESET on EOF).
+ */
+ssize_t recvfd_fill (int fd, struct rxbuf *rxbuf);
+
+/* Decode the next complete message in rxbuf without further I/O.
+ * Returns message on success, NULL on failure with errno set.  Fails with
+ * EAGAIN/EWOULDBLOCK if no complete message is buffered.  Since buffered
+ * data does not make the file descriptor readable, call this until it
+ * fails after each recvfd_fill().
+ */
+flux_msg_t *recvfd_next (struct rxbuf *rxbuf);
+
+void rxbuf_init (struct rxbuf *rxbuf);
+void rxbuf_clean (struct rxbuf *rxbuf);
+
 /* Initialize iobuf members.
  */
 void iobuf_init (struct iobuf *iobuf);
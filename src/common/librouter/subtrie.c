@@ -0,0 +1,318 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* subtrie.c - index event subscriptions of many subscribers by topic
+ *
+ * Event subscriptions are topic prefixes:  a subscription to "foo" matches
+ * "foo", "foobar", and "foo.bar", and "" matches everything.  Where
+ * subhash_topic_match() answers "does this one subscriber want the event?"
+ * by scanning its subscriptions, a subtrie holds the subscriptions of all
+ * subscribers (e.g. broker modules or connector-local clients) in a
+ * character trie, so the set of subscribers for an event is found in one
+ * walk down the trie along the topic string, independent of the number
+ * of subscribers and subscriptions that do not match.
+ *
+ * A subscriber with several subscriptions matching one topic (e.g. "job"
+ * and "job-state") is only visited once per subtrie_match() call.  This is
+ * tracked with a per-subscriber generation number compared against a
+ * counter that is incremented on each match.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libutil/errno_safe.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "subtrie.h"
+
+struct subscriber {
+    void *arg;
+    int refcount;               // number of subscriptions held
+    unsigned int gen;           // last subtrie_match() generation visited
+};
+
+struct node {
+    char c;
+    struct node *parent;
+    struct node *child;         // first child
+    struct node *sibling;       // next sibling
+    zlistx_t *subs;             // list of 'struct subscriber', or NULL
+};
+
+struct subtrie {
+    struct node root;           // represents the "" topic prefix
+    zhashx_t *subscribers;      // arg => 'struct subscriber'
+    unsigned int gen;
+};
+
+static void node_destroy (struct node *n)
+{
+    if (n) {
+        struct node *child = n->child;
+        while (child) {
+            struct node *next = child->sibling;
+            node_destroy (child);
+            child = next;
+        }
+        zlistx_destroy (&n->subs);
+        free (n);
+    }
+}
+
+static struct node *node_child (struct node *n, char c)
+{
+    struct node *child = n->child;
+
+    while (child && child->c != c)
+        child = child->sibling;
+    return child;
+}
+
+static struct node *node_child_add (struct node *n, char c)
+{
+    struct node *child;
+
+    if (!(child = calloc (1, sizeof (*child))))
+        return NULL;
+    child->c = c;
+    child->parent = n;
+    child->sibling = n->child;
+    n->child = child;
+    return child;
+}
+
+/* Unlink and free 'n' and any ancestors (other than root) left with
+ * no subscribers and no children.
+ */
+static void node_prune (struct subtrie *st, struct node *n)
+{
+    while (n != &st->root && !n->child && !n->subs) {
+        struct node *parent = n->parent;
+        struct node **np = &parent->child;
+
+        while (*np != n)
+            np = &(*np)->sibling;
+        *np = n->sibling;
+        free (n);
+        n = parent;
+    }
+}
+
+/* Find the node for 'topic'.  If 'create' is true, add missing nodes.
+ */
+static struct node *node_lookup (struct subtrie *st,
+                                 const char *topic,
+                                 bool create)
+{
+    struct node *n = &st->root;
+    const char *cp;
+
+    for (cp = topic; *cp != '\0'; cp++) {
+        struct node *child;
+
+        if (!(child = node_child (n, *cp))) {
+            if (!create) {
+                errno = ENOENT;
+                return NULL;
+            }
+            if (!(child = node_child_add (n, *cp))) {
+                node_prune (st, n);
+                return NULL;
+            }
+        }
+        n = child;
+    }
+    return n;
+}
+
+// zhashx_hash_fn footprint
+static size_t subscriber_hasher (const void *key)
+{
+    return (uintptr_t)key;
+}
+
+// zhashx_comparator_fn footprint
+static int subscriber_key_cmp (const void *key1, const void *key2)
+{
+    if (key1 == key2)
+        return 0;
+    return key1 < key2 ? -1 : 1;
+}
+
+// zhashx_destructor_fn footprint
+static void subscriber_destructor (void **item)
+{
+    if (item) {
+        ERRNO_SAFE_WRAP (free, *item);
+        *item = NULL;
+    }
+}
+
+int subtrie_insert (struct subtrie *st, const char *topic, void *arg)
+{
+    struct subscriber *sub;
+    struct node *n;
+    bool new_sub = false;
+
+    if (!st || !topic || !arg) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(sub = zhashx_lookup (st->subscribers, arg))) {
+        if (!(sub = calloc (1, sizeof (*sub))))
+            return -1;
+        sub->arg = arg;
+        sub->gen = st->gen;
+        (void)zhashx_insert (st->subscribers, arg, sub);
+        new_sub = true;
+    }
+    if (!(n = node_lookup (st, topic, true)))
+        goto error;
+    if (n->subs && zlistx_find (n->subs, sub)) {
+        errno = EEXIST;
+        goto error;
+    }
+    if (!n->subs && !(n->subs = zlistx_new ()))
+        goto nomem;
+    if (!zlistx_add_end (n->subs, sub))
+        goto nomem;
+    sub->refcount++;
+    return 0;
+nomem:
+    if (n->subs && zlistx_size (n->subs) == 0)
+        zlistx_destroy (&n->subs);
+    node_prune (st, n);
+    errno = ENOMEM;
+error:
+    if (new_sub)
+        zhashx_delete (st->subscribers, arg);
+    return -1;
+}
+
+int subtrie_remove (struct subtrie *st, const char *topic, void *arg)
+{
+    struct subscriber *sub;
+    struct node *n;
+    void *handle;
+
+    if (!st || !topic || !arg) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(sub = zhashx_lookup (st->subscribers, arg))
+        || !(n = node_lookup (st, topic, false))
+        || !n->subs
+        || !(handle = zlistx_find (n->subs, sub))) {
+        errno = ENOENT;
+        return -1;
+    }
+    zlistx_delete (n->subs, handle);
+    if (zlistx_size (n->subs) == 0) {
+        zlistx_destroy (&n->subs);
+        node_prune (st, n);
+    }
+    if (--sub->refcount == 0)
+        zhashx_delete (st->subscribers, arg);
+    return 0;
+}
+
+static int node_match (struct subtrie *st,
+                       struct node *n,
+                       subtrie_match_f cb,
+                       void *arg)
+{
+    struct subscriber *sub;
+    int count = 0;
+
+    if (n->subs) {
+        sub = zlistx_first (n->subs);
+        while (sub) {
+            if (sub->gen != st->gen) {
+                sub->gen = st->gen;
+                if (cb)
+                    cb (sub->arg, arg);
+                count++;
+            }
+            sub = zlistx_next (n->subs);
+        }
+    }
+    return count;
+}
+
+int subtrie_match (struct subtrie *st,
+                   const char *topic,
+                   subtrie_match_f cb,
+                   void *arg)
+{
+    struct node *n;
+    const char *cp;
+    int count;
+
+    if (!st || !topic) {
+        errno = EINVAL;
+        return -1;
+    }
+    st->gen++;
+    n = &st->root;
+    count = node_match (st, n, cb, arg);
+    for (cp = topic; *cp != '\0'; cp++) {
+        if (!(n = node_child (n, *cp)))
+            break;
+        count += node_match (st, n, cb, arg);
+    }
+    return count;
+}
+
+void subtrie_destroy (struct subtrie *st)
+{
+    if (st) {
+        int saved_errno = errno;
+        struct node *child = st->root.child;
+        while (child) {
+            struct node *next = child->sibling;
+            node_destroy (child);
+            child = next;
+        }
+        zlistx_destroy (&st->root.subs);
+        zhashx_destroy (&st->subscribers);
+        free (st);
+        errno = saved_errno;
+    }
+}
+
+struct subtrie *subtrie_create (void)
+{
+    struct subtrie *st;
+
+    if (!(st = calloc (1, sizeof (*st))))
+        return NULL;
+    if (!(st->subscribers = zhashx_new ()))
+        goto nomem;
+    zhashx_set_key_hasher (st->subscribers, subscriber_hasher);
+    zhashx_set_key_comparator (st->subscribers, subscriber_key_cmp);
+    zhashx_set_key_duplicator (st->subscribers, NULL);
+    zhashx_set_key_destructor (st->subscribers, NULL);
+    zhashx_set_destructor (st->subscribers, subscriber_destructor);
+    return st;
+nomem:
+    errno = ENOMEM;
+    subtrie_destroy (st);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
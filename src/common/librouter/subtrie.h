@@ -0,0 +1,44 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _ROUTER_SUBTRIE_H
+#define _ROUTER_SUBTRIE_H
+
+/* Called once per subscriber with at least one subscription matching
+ * the topic passed to subtrie_match().  The callback must not insert
+ * or remove subscriptions.
+ */
+typedef void (*subtrie_match_f)(void *subscriber, void *arg);
+
+struct subtrie *subtrie_create (void);
+void subtrie_destroy (struct subtrie *st);
+
+/* Add/remove a subscription to 'topic' on behalf of 'subscriber'.
+ * A subscriber may hold only one subscription to a given topic:
+ * insert fails with EEXIST if it is already subscribed, and remove fails
+ * with ENOENT if it is not.
+ */
+int subtrie_insert (struct subtrie *st, const char *topic, void *subscriber);
+int subtrie_remove (struct subtrie *st, const char *topic, void *subscriber);
+
+/* Call 'cb' for each subscriber with a subscription that is a prefix of
+ * 'topic', visiting each subscriber at most once.
+ * Returns the number of subscribers matched, or -1 on error.
+ */
+int subtrie_match (struct subtrie *st,
+                   const char *topic,
+                   subtrie_match_f cb,
+                   void *arg);
+
+#endif /* !_ROUTER_SUBTRIE_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
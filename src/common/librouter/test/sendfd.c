@@ -314,6 +314,232 @@ next:
     free (buf);
 }
 
+/* Send a mix of small, large, and routed messages with one sendfd_batch()
+ * over a blocking pipe, then receive them with recvfd_fill/next().
+ */
+void test_batch (void)
+{
+    int pfd[2];
+    const flux_msg_t *msgs[16];
+    struct rxbuf rx;
+    char buf[1024];
+    int count = 0;
+    int errors = 0;
+    flux_msg_t *msg;
+    int i;
+
+    memset (buf, 0x0f, sizeof (buf));
+    if (pipe2 (pfd, O_CLOEXEC) < 0)
+        BAIL_OUT ("pipe2 failed");
+    for (i = 0; i < 16; i++) {
+        if (!(msg = flux_request_encode_raw ("foo.bar", buf, i * 64)))
+            BAIL_OUT ("flux_request_encode_raw failed");
+        if (i % 4 == 0) {
+            flux_msg_route_enable (msg);
+            if (flux_msg_route_push (msg, "route1") < 0
+                || flux_msg_route_push (msg, "route2") < 0)
+                BAIL_OUT ("flux_msg_route_push failed");
+        }
+        msgs[count++] = msg;
+    }
+    ok (sendfd_batch (pfd[1], msgs, count, NULL) == count,
+        "sendfd_batch sent %d messages", count);
+
+    rxbuf_init (&rx);
+    ok (recvfd_fill (pfd[0], &rx) > 0,
+        "recvfd_fill works");
+    for (i = 0; i < count; i++) {
+        const char *topic;
+        const void *buf2;
+        size_t buf2len;
+
+        while (!(msg = recvfd_next (&rx))) {
+            if (errno != EAGAIN || recvfd_fill (pfd[0], &rx) < 0)
+                BAIL_OUT ("recvfd_next failed: %s", strerror (errno));
+        }
+        if (flux_request_decode_raw (msg, &topic, &buf2, &buf2len) < 0
+            || !streq (topic, "foo.bar")
+            || buf2len != i * 64
+            || (buf2len > 0 && memcmp (buf, buf2, buf2len) != 0)
+            || flux_msg_route_count (msg) != (i % 4 == 0 ? 2 : -1))
+            errors++;
+        flux_msg_destroy (msg);
+    }
+    ok (errors == 0,
+        "recvfd_next returned all messages intact and in order");
+    errno = 0;
+    ok (recvfd_next (&rx) == NULL && errno == EAGAIN,
+        "recvfd_next fails with EAGAIN when buffer is drained");
+    ok (sendfd_batch (pfd[1], msgs, 0, NULL) == 0,
+        "sendfd_batch count=0 sends nothing");
+
+    close (pfd[1]);
+    errno = 0;
+    ok (recvfd_fill (pfd[0], &rx) < 0 && errno == ECONNRESET,
+        "recvfd_fill fails with ECONNRESET when sender closes pipe");
+
+    rxbuf_clean (&rx);
+    for (i = 0; i < count; i++)
+        flux_msg_decref (msgs[i]);
+    close (pfd[0]);
+}
+
+struct bio {
+    zlist_t *queue;
+    struct iobuf iobuf;
+    struct rxbuf rxbuf;
+    int fd;
+    flux_watcher_t *w;
+    int max;
+};
+
+void recv_batch_cb (flux_reactor_t *r,
+                    flux_watcher_t *w,
+                    int revents,
+                    void *arg)
+{
+    struct bio *io = arg;
+    flux_msg_t *msg;
+
+    if ((revents & FLUX_POLLERR))
+        BAIL_OUT ("recv_batch_cb POLLERR");
+    if (recvfd_fill (io->fd, &io->rxbuf) < 0 && errno != EAGAIN)
+        BAIL_OUT ("recvfd_fill error: %s", strerror (errno));
+    while ((msg = recvfd_next (&io->rxbuf))) {
+        if (zlist_append (io->queue, msg) < 0)
+            BAIL_OUT ("zlist_append failed");
+    }
+    if (errno != EAGAIN)
+        BAIL_OUT ("recvfd_next error: %s", strerror (errno));
+    if (zlist_size (io->queue) == io->max)
+        flux_watcher_stop (io->w);
+}
+
+void send_batch_cb (flux_reactor_t *r,
+                    flux_watcher_t *w,
+                    int revents,
+                    void *arg)
+{
+    struct bio *io = arg;
+    const flux_msg_t *msgs[32];
+    flux_msg_t *msg;
+    int count = 0;
+    int n;
+
+    if ((revents & FLUX_POLLERR))
+        BAIL_OUT ("send_batch_cb POLLERR");
+    msg = zlist_first (io->queue);
+    while (msg && count < 32) {
+        msgs[count++] = msg;
+        msg = zlist_next (io->queue);
+    }
+    if (count == 0) {
+        flux_watcher_stop (io->w);
+        return;
+    }
+    if ((n = sendfd_batch (io->fd, msgs, count, &io->iobuf)) < 0) {
+        if (errno == EAGAIN)
+            return;
+        BAIL_OUT ("sendfd_batch error: %s", strerror (errno));
+    }
+    while (n-- > 0)
+        flux_msg_destroy (zlist_pop (io->queue));
+}
+
+void bio_destroy (struct bio *io)
+{
+    if (io) {
+        flux_msg_t *msg;
+        while ((msg = zlist_pop (io->queue)))
+            flux_msg_destroy (msg);
+        zlist_destroy (&io->queue);
+        flux_watcher_destroy (io->w);
+        iobuf_clean (&io->iobuf);
+        rxbuf_clean (&io->rxbuf);
+        free (io);
+    }
+}
+
+struct bio *bio_create (flux_reactor_t *r,
+                        int fd,
+                        int flags,
+                        flux_watcher_f cb)
+{
+    struct bio *io;
+
+    if (!(io = calloc (1, sizeof (*io)))
+        || !(io->queue = zlist_new ())
+        || fd_set_nonblocking (fd) < 0
+        || !(io->w = flux_fd_watcher_create (r, fd, flags, cb, io)))
+        BAIL_OUT ("bio_create failed");
+    iobuf_init (&io->iobuf);
+    rxbuf_init (&io->rxbuf);
+    io->fd = fd;
+    flux_watcher_start (io->w);
+    return io;
+}
+
+/* Like test_nonblock() but using sendfd_batch() and recvfd_fill/next().
+ * Message sizes vary so that writes stop partway through messages.
+ */
+void test_batch_nonblock (int size, int count)
+{
+    int pfd[2];
+    struct bio *iow;
+    struct bio *ior;
+    flux_reactor_t *r;
+    char *buf;
+    int errors = 0;
+    flux_msg_t *msg;
+    int i;
+
+    if (!(buf = malloc (size)))
+        BAIL_OUT ("malloc failed");
+    memset (buf, 0xf0, size);
+    if (!(r = flux_reactor_create (0)))
+        BAIL_OUT ("flux_reactor_create failed");
+    if (pipe2 (pfd, O_CLOEXEC) < 0)
+        BAIL_OUT ("pipe2 failed");
+    iow = bio_create (r, pfd[1], FLUX_POLLOUT, send_batch_cb);
+    ior = bio_create (r, pfd[0], FLUX_POLLIN, recv_batch_cb);
+
+    for (i = 0; i < count; i++) {
+        if (!(msg = flux_request_encode_raw ("foo.bar", buf, i % size)))
+            BAIL_OUT ("flux_request_encode_raw failed");
+        if (zlist_append (iow->queue, msg) < 0)
+            BAIL_OUT ("zlist_append failed");
+    }
+    ior->max = count;
+
+    ok (flux_reactor_run (r, 0) == 0,
+        "batch nonblock %d,%d: reactor ran", count, size);
+    ok (zlist_size (ior->queue) == count,
+        "batch nonblock %d,%d: all messages received", count, size);
+    i = 0;
+    while ((msg = zlist_pop (ior->queue))) {
+        const char *topic;
+        const void *buf2;
+        size_t buf2len;
+
+        if (flux_request_decode_raw (msg, &topic, &buf2, &buf2len) < 0
+            || !streq (topic, "foo.bar")
+            || buf2len != i % size
+            || (buf2len > 0 && memcmp (buf, buf2, buf2len) != 0))
+            errors++;
+        flux_msg_destroy (msg);
+        i++;
+    }
+    ok (errors == 0,
+        "batch nonblock %d,%d: received messages are intact", count, size);
+
+    bio_destroy (iow);
+    bio_destroy (ior);
+    close (pfd[1]);
+    close (pfd[0]);
+    flux_reactor_destroy (r);
+    free (buf);
+}
+
 void test_inval (void)
 {
     flux_msg_t *msg;
@@ -331,6 +557,16 @@ void test_inval (void)
     errno = 0;
     ok (sendfd (0, NULL, NULL) < 0 && errno == EINVAL,
         "senfd msg=NULL fails with EINVAL");
+    errno = 0;
+    ok (sendfd_batch (-1, (const flux_msg_t **)&msg, 1, NULL) < 0
+        && errno == EINVAL,
+        "sendfd_batch fd=-1 fails with EINVAL");
+    errno = 0;
+    ok (recvfd_fill (-1, NULL) < 0 && errno == EINVAL,
+        "recvfd_fill fd=-1 fails with EINVAL");
+    errno = 0;
+    ok (recvfd_next (NULL) == NULL && errno == EINVAL,
+        "recvfd_next rxbuf=NULL fails with EINVAL");
 
     flux_msg_destroy (msg);
 }
@@ -346,6 +582,9 @@ int main (int argc, char *argv[])
     test_nonblock (4096, 256);
     test_nonblock (16384, 64);
     test_nonblock (1048586, 1);
+    test_batch ();
+    test_batch_nonblock (1024, 4096);
+    test_batch_nonblock (262144, 64);
     test_inval ();
 
     done_testing();
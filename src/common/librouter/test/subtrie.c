@@ -0,0 +1,160 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/librouter/subtrie.h"
+
+struct client {
+    const char *name;
+    int hits;
+};
+
+static void count_cb (void *subscriber, void *arg)
+{
+    struct client *c = subscriber;
+    c->hits++;
+}
+
+static void reset (struct client *c, int count)
+{
+    for (int i = 0; i < count; i++)
+        c[i].hits = 0;
+}
+
+void test_match (void)
+{
+    struct subtrie *st;
+    struct client c[] = { { "a", 0 }, { "b", 0 }, { "c", 0 } };
+
+    st = subtrie_create ();
+    ok (st != NULL,
+        "subtrie_create works");
+
+    ok (subtrie_insert (st, "foo", &c[0]) == 0,
+        "subtrie_insert foo a");
+    ok (subtrie_insert (st, "foo.bar", &c[1]) == 0,
+        "subtrie_insert foo.bar b");
+    ok (subtrie_insert (st, "fo", &c[1]) == 0,
+        "subtrie_insert fo b");
+    ok (subtrie_insert (st, "", &c[2]) == 0,
+        "subtrie_insert \"\" c");
+
+    ok (subtrie_match (st, "foo.bar", count_cb, NULL) == 3
+        && c[0].hits == 1 && c[1].hits == 1 && c[2].hits == 1,
+        "subtrie_match foo.bar matches a, b, c once each");
+    reset (c, 3);
+    ok (subtrie_match (st, "foobar", count_cb, NULL) == 3
+        && c[0].hits == 1 && c[1].hits == 1 && c[2].hits == 1,
+        "subtrie_match foobar matches a, b, c");
+    reset (c, 3);
+    ok (subtrie_match (st, "f", count_cb, NULL) == 1
+        && c[0].hits == 0 && c[1].hits == 0 && c[2].hits == 1,
+        "subtrie_match f matches only c");
+    reset (c, 3);
+    ok (subtrie_match (st, "bar", NULL, NULL) == 1,
+        "subtrie_match bar with NULL callback counts c");
+
+    ok (subtrie_remove (st, "", &c[2]) == 0,
+        "subtrie_remove \"\" c");
+    ok (subtrie_match (st, "bar", count_cb, NULL) == 0,
+        "subtrie_match bar matches nothing");
+    ok (subtrie_remove (st, "fo", &c[1]) == 0,
+        "subtrie_remove fo b");
+    ok (subtrie_match (st, "foo", count_cb, NULL) == 1 && c[0].hits == 1,
+        "subtrie_match foo matches only a");
+    reset (c, 3);
+    ok (subtrie_match (st, "foo.bar.baz", count_cb, NULL) == 2
+        && c[0].hits == 1 && c[1].hits == 1,
+        "subtrie_match foo.bar.baz matches a and b");
+    reset (c, 3);
+
+    ok (subtrie_remove (st, "foo.bar", &c[1]) == 0
+        && subtrie_remove (st, "foo", &c[0]) == 0,
+        "subtrie_remove remaining subscriptions");
+    ok (subtrie_match (st, "foo.bar", count_cb, NULL) == 0,
+        "subtrie_match foo.bar matches nothing");
+
+    subtrie_destroy (st);
+}
+
+void test_errors (void)
+{
+    struct subtrie *st;
+    int x, y;
+
+    if (!(st = subtrie_create ()))
+        BAIL_OUT ("subtrie_create failed");
+
+    errno = 0;
+    ok (subtrie_insert (NULL, "foo", &x) < 0 && errno == EINVAL,
+        "subtrie_insert st=NULL fails with EINVAL");
+    errno = 0;
+    ok (subtrie_insert (st, NULL, &x) < 0 && errno == EINVAL,
+        "subtrie_insert topic=NULL fails with EINVAL");
+    errno = 0;
+    ok (subtrie_insert (st, "foo", NULL) < 0 && errno == EINVAL,
+        "subtrie_insert subscriber=NULL fails with EINVAL");
+
+    ok (subtrie_insert (st, "foo", &x) == 0,
+        "subtrie_insert foo x");
+    errno = 0;
+    ok (subtrie_insert (st, "foo", &x) < 0 && errno == EEXIST,
+        "subtrie_insert foo x again fails with EEXIST");
+    ok (subtrie_insert (st, "foo", &y) == 0,
+        "subtrie_insert foo y works");
+
+    errno = 0;
+    ok (subtrie_remove (st, "fo", &x) < 0 && errno == ENOENT,
+        "subtrie_remove fo x fails with ENOENT");
+    errno = 0;
+    ok (subtrie_remove (st, "foobar", &x) < 0 && errno == ENOENT,
+        "subtrie_remove foobar x fails with ENOENT");
+    ok (subtrie_remove (st, "foo", &x) == 0,
+        "subtrie_remove foo x works");
+    errno = 0;
+    ok (subtrie_remove (st, "foo", &x) < 0 && errno == ENOENT,
+        "subtrie_remove foo x again fails with ENOENT");
+    ok (subtrie_match (st, "foo", NULL, NULL) == 1,
+        "subtrie_match foo still matches y");
+
+    errno = 0;
+    ok (subtrie_match (NULL, "foo", NULL, NULL) < 0 && errno == EINVAL,
+        "subtrie_match st=NULL fails with EINVAL");
+    errno = 0;
+    ok (subtrie_match (st, NULL, NULL, NULL) < 0 && errno == EINVAL,
+        "subtrie_match topic=NULL fails with EINVAL");
+
+    lives_ok ({subtrie_destroy (NULL);},
+              "subtrie_destroy NULL doesn't crash");
+
+    /* leave y subscribed to exercise cleanup in destroy */
+    subtrie_destroy (st);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_match ();
+    test_errors ();
+
+    done_testing ();
+    return (0);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
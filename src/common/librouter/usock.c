@@ -61,6 +61,8 @@
 
 #define LISTEN_BACKLOG 5
 
+#define SEND_BATCH_MAX 64   // max messages per sendfd_batch() call
+
 #ifndef UUID_STR_LEN
 #define UUID_STR_LEN 37     // defined in later libuuid headers
 #endif
@@ -80,6 +82,7 @@ struct usock_io {
     int fd;
     flux_watcher_t *w;
     struct iobuf iobuf;
+    struct rxbuf rxbuf;
 };
 
 struct usock_conn {
@@ -218,21 +221,28 @@ static void conn_read_cb (flux_reactor_t *r,
     if ((revents & FLUX_POLLIN)) {
         flux_msg_t *msg;
 
-        if (!(msg = recvfd (conn->in.fd, &conn->in.iobuf))) {
+        /* Read whatever the client has sent in one read(2), then deliver
+         * every complete message buffered, since buffered messages will
+         * not make the fd readable again.
+         */
+        if (recvfd_fill (conn->in.fd, &conn->in.rxbuf) < 0) {
             if (errno != EWOULDBLOCK && errno != EAGAIN)
                 goto error;
         }
-        else {
+        while ((msg = recvfd_next (&conn->in.rxbuf))) {
             /* Update message credentials based on connected creds.
              */
-            if (auth_init_message (msg, &conn->cred) < 0)
+            if (auth_init_message (msg, &conn->cred) < 0) {
+                flux_msg_destroy (msg);
                 goto error;
-
+            }
             if (conn->recv_cb)
                 conn->recv_cb (conn, msg, conn->recv_arg);
             flux_msg_destroy (msg);
             conn->txcount++;
         }
+        if (errno != EWOULDBLOCK && errno != EAGAIN)
+            goto error;
     }
     return;
 error:
@@ -261,9 +271,19 @@ static void conn_write_cb (flux_reactor_t *r,
     }
 
     if ((revents & FLUX_POLLOUT)) {
-        const flux_msg_t *msg = zlist_head (conn->outqueue);
-        if (msg) {
-            if (sendfd (conn->out.fd, msg, &conn->out.iobuf) < 0) {
+        const flux_msg_t *msgs[SEND_BATCH_MAX];
+        const flux_msg_t *msg;
+        int count = 0;
+        int n;
+
+        msg = zlist_first (conn->outqueue);
+        while (msg && count < SEND_BATCH_MAX) {
+            msgs[count++] = msg;
+            msg = zlist_next (conn->outqueue);
+        }
+        if (count > 0) {
+            n = sendfd_batch (conn->out.fd, msgs, count, &conn->out.iobuf);
+            if (n < 0) {
                 if (errno == EPIPE) {
                     /* Remote peer has closed connection.
                      * However, there may still be pending messages sent
@@ -280,10 +300,12 @@ static void conn_write_cb (flux_reactor_t *r,
                     goto error;
             }
             else {
-                (void) conn_outqueue_drop (conn);
+                while (n-- > 0) {
+                    (void) conn_outqueue_drop (conn);
+                    conn->rxcount++;
+                }
                 if (zlist_size (conn->outqueue) == 0)
                     flux_watcher_stop (conn->out.w);
-                conn->rxcount++;
             }
         }
     }
@@ -342,6 +364,7 @@ void usock_conn_destroy (struct usock_conn *conn)
         aux_destroy (&conn->aux);
         flux_watcher_destroy (conn->in.w);
         iobuf_clean (&conn->in.iobuf);
+        rxbuf_clean (&conn->in.rxbuf);
         if (conn->outqueue) {
             const flux_msg_t *msg;
             while ((msg = zlist_pop (conn->outqueue)))
@@ -461,6 +484,7 @@ struct usock_conn *usock_conn_create (flux_reactor_t *r, int infd, int outfd)
                                                conn)))
         goto error;
     iobuf_init (&conn->in.iobuf);
+    rxbuf_init (&conn->in.rxbuf);
 
     if (!(conn->out.w = flux_fd_watcher_create (r,
                                                 conn->out.fd,
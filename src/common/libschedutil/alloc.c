@@ -14,6 +14,7 @@
 #include <flux/core.h>
 #include <jansson.h>
 
+#include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/errno_safe.h"
 #include "schedutil_private.h"
 #include "init.h"
@@ -110,15 +111,26 @@ int schedutil_alloc_respond_cancel (schedutil_t *util, const flux_msg_t *msg)
 struct alloc {
     json_t *annotations;
     const flux_msg_t *msg;
-    flux_kvs_txn_t *txn;
     json_t *R;
 };
 
+/* Allocations whose R is committed to the KVS in one transaction.
+ * R for each allocation made in the same reactor loop iteration is added
+ * to the open batch, which is committed from a prepare watcher before the
+ * reactor blocks.  An idle watcher runs while a batch is open so that
+ * poll(2) does not block if the batch was opened after the prepare watcher
+ * ran, e.g. from another prepare callback.  Responses are sent once the
+ * commit completes.
+ */
+struct alloc_batch {
+    flux_kvs_txn_t *txn;
+    zlistx_t *allocs;
+};
+
 static void alloc_destroy (struct alloc *ctx)
 {
     if (ctx) {
         int saved_errno = errno;
-        flux_kvs_txn_destroy (ctx->txn);
         flux_msg_decref (ctx->msg);
         json_decref (ctx->annotations);
         json_decref (ctx->R);
@@ -127,6 +139,45 @@ static void alloc_destroy (struct alloc *ctx)
     }
 }
 
+// zlistx_destructor_fn footprint
+static void alloc_destructor (void **item)
+{
+    if (item) {
+        alloc_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void alloc_batch_destroy (struct alloc_batch *batch)
+{
+    if (batch) {
+        int saved_errno = errno;
+        zlistx_destroy (&batch->allocs);
+        flux_kvs_txn_destroy (batch->txn);
+        free (batch);
+        errno = saved_errno;
+    }
+}
+
+static struct alloc_batch *alloc_batch_create (void)
+{
+    struct alloc_batch *batch;
+
+    if (!(batch = calloc (1, sizeof (*batch))))
+        return NULL;
+    if (!(batch->txn = flux_kvs_txn_create ()))
+        goto error;
+    if (!(batch->allocs = zlistx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zlistx_set_destructor (batch->allocs, alloc_destructor);
+    return batch;
+error:
+    alloc_batch_destroy (batch);
+    return NULL;
+}
+
 /* Omit RFC 20 instance-local properties (leading '+') from 'R'
  * Returns the number of properties removed: 0 if R is unchanged.
  */
@@ -153,8 +204,11 @@ static int strip_instance_local_properties (json_t *R)
     return count;
 }
 
+/* Create an alloc context for 'msg' and add R to 'txn'.
+ */
 static struct alloc *alloc_create (const flux_msg_t *msg,
                                    const char *R,
+                                   flux_kvs_txn_t *txn,
                                    const char *fmt,
                                    va_list ap)
 {
@@ -179,16 +233,14 @@ static struct alloc *alloc_create (const flux_msg_t *msg,
         errno = ENOMEM;
         goto error;
     }
-    if (!(ctx->txn = flux_kvs_txn_create ()))
-        goto error;
     /* Strip RFC 20 instance-local properties.
      * Commit result instead of original if R was modified.
      */
     if (strip_instance_local_properties (ctx->R) > 0) {
-        if (flux_kvs_txn_pack (ctx->txn, 0, key, "O", ctx->R) < 0)
+        if (flux_kvs_txn_pack (txn, 0, key, "O", ctx->R) < 0)
             goto error;
     }
-    else if (flux_kvs_txn_put (ctx->txn, 0, key, R) < 0)
+    else if (flux_kvs_txn_put (txn, 0, key, R) < 0)
         goto error;
     return ctx;
 error:
@@ -196,41 +248,97 @@ error:
     return NULL;
 }
 
-static void alloc_continuation (flux_future_t *f, void *arg)
+static int alloc_respond (flux_t *h, struct alloc *ctx)
 {
-    schedutil_t *util = arg;
-    flux_t *h = util->h;
-    struct alloc *ctx = flux_future_aux_get (f, "flux::alloc_ctx");
-    json_t *payload = NULL;
+    json_t *payload;
+    int rc;
 
-    remove_outstanding_future (util, f);
-    if (flux_future_get (f, NULL) < 0) {
-        flux_log_error (h, "commit R");
-        goto error;
-    }
     if (!(payload = json_object ())
         || (ctx->annotations && json_object_set (payload,
                                                  "annotations",
                                                  ctx->annotations) < 0)
         || json_object_set (payload, "R", ctx->R) < 0) {
+        json_decref (payload);
         errno = ENOMEM;
-        flux_log_error (h, "error responding to alloc request");
-        goto error;
+        return -1;
     }
-    if (schedutil_alloc_respond_pack (h,
-                                      ctx->msg,
-                                      FLUX_SCHED_ALLOC_SUCCESS,
-                                      "O",
-                                      payload) < 0) {
-        flux_log_error (h, "error responding to alloc request");
+    rc = schedutil_alloc_respond_pack (h,
+                                       ctx->msg,
+                                       FLUX_SCHED_ALLOC_SUCCESS,
+                                       "O",
+                                       payload);
+    ERRNO_SAFE_WRAP (json_decref, payload);
+    return rc;
+}
+
+static void alloc_continuation (flux_future_t *f, void *arg)
+{
+    schedutil_t *util = arg;
+    flux_t *h = util->h;
+    struct alloc_batch *batch = flux_future_aux_get (f, "flux::alloc_batch");
+    struct alloc *ctx;
+
+    remove_outstanding_future (util, f);
+    if (flux_future_get (f, NULL) < 0) {
+        flux_log_error (h, "commit R");
         goto error;
     }
-    json_decref (payload);
+    ctx = zlistx_first (batch->allocs);
+    while (ctx) {
+        if (alloc_respond (h, ctx) < 0) {
+            flux_log_error (h, "error responding to alloc request");
+            goto error;
+        }
+        ctx = zlistx_next (batch->allocs);
+    }
     flux_future_destroy (f);
     return;
 error:
     flux_reactor_stop_error (flux_get_reactor (h)); // XXX
-    ERRNO_SAFE_WRAP (json_decref, payload);
+    flux_future_destroy (f);
+}
+
+/* Commit the open batch.  Called before the reactor blocks, so the batch
+ * holds all allocations made in this reactor loop iteration.
+ */
+static void alloc_prep_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    schedutil_t *util = arg;
+    struct alloc_batch *batch = util->alloc_batch;
+    flux_future_t *f = NULL;
+    size_t count;
+
+    flux_watcher_stop (w);
+    flux_watcher_stop (util->alloc_idle);
+    util->alloc_batch = NULL;
+    if (!batch || zlistx_size (batch->allocs) == 0) {
+        alloc_batch_destroy (batch);
+        return;
+    }
+    count = zlistx_size (batch->allocs);
+    if (!(f = flux_kvs_commit (util->h, NULL, 0, batch->txn)))
+        goto error;
+    if (flux_future_aux_set (f,
+                             "flux::alloc_batch",
+                             batch,
+                             (flux_free_f)alloc_batch_destroy) < 0)
+        goto error;
+    batch = NULL;
+    if (flux_future_then (f, -1, alloc_continuation, util) < 0)
+        goto error;
+    add_outstanding_future (util, f);
+    util->alloc_stats.commits++;
+    util->alloc_stats.committed += count;
+    if (util->alloc_stats.batch_max < count)
+        util->alloc_stats.batch_max = count;
+    return;
+error:
+    flux_log_error (util->h, "commit R");
+    flux_reactor_stop_error (r); // XXX
+    alloc_batch_destroy (batch);
     flux_future_destroy (f);
 }
 
@@ -241,31 +349,58 @@ int schedutil_alloc_respond_success_pack (schedutil_t *util,
                                           ...)
 {
     struct alloc *ctx;
-    flux_future_t *f;
-    flux_t *h = util->h;
     va_list ap;
 
+    if (!util->alloc_batch) {
+        if (!(util->alloc_batch = alloc_batch_create ()))
+            return -1;
+        flux_watcher_start (util->alloc_prep);
+        flux_watcher_start (util->alloc_idle);
+    }
     va_start (ap, fmt);
-    ctx = alloc_create (msg, R, fmt, ap);
+    ctx = alloc_create (msg, R, util->alloc_batch->txn, fmt, ap);
     va_end (ap);
     if (!ctx)
         return -1;
-    if (!(f = flux_kvs_commit (h, NULL, 0, ctx->txn)))
-        goto error;
-    if (flux_future_aux_set (f,
-                             "flux::alloc_ctx",
-                             ctx,
-                             (flux_free_f)alloc_destroy) < 0) {
-        goto error;
+    if (!zlistx_add_end (util->alloc_batch->allocs, ctx)) {
+        alloc_destroy (ctx);
+        errno = ENOMEM;
+        return -1;
     }
-    if (flux_future_then (f, -1, alloc_continuation, util) < 0)
-        goto error;
-    add_outstanding_future (util, f);
     return 0;
-error:
-    alloc_destroy (ctx);
-    flux_future_destroy (f);
-    return -1;
+}
+
+int schedutil_alloc_stats_get (schedutil_t *util,
+                               struct schedutil_alloc_stats *stats)
+{
+    if (!util || !stats) {
+        errno = EINVAL;
+        return -1;
+    }
+    *stats = util->alloc_stats;
+    return 0;
+}
+
+int alloc_batch_init (schedutil_t *util)
+{
+    flux_reactor_t *r = flux_get_reactor (util->h);
+
+    if (!(util->alloc_prep = flux_prepare_watcher_create (r,
+                                                          alloc_prep_cb,
+                                                          util))
+        || !(util->alloc_idle = flux_idle_watcher_create (r, NULL, NULL)))
+        return -1;
+    return 0;
+}
+
+void alloc_batch_cleanup (schedutil_t *util)
+{
+    flux_watcher_destroy (util->alloc_prep);
+    util->alloc_prep = NULL;
+    flux_watcher_destroy (util->alloc_idle);
+    util->alloc_idle = NULL;
+    alloc_batch_destroy (util->alloc_batch);
+    util->alloc_batch = NULL;
 }
 
 /*
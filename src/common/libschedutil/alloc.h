@@ -46,6 +46,8 @@ int schedutil_alloc_respond_deny (schedutil_t *util,
 
 /* Respond to alloc request message - success, allocate R.
  * R is committed to the KVS first, then the response is sent.
+ * R for all allocations made in the same reactor loop iteration is
+ * committed in a single KVS transaction.
  * If something goes wrong after this function returns, the reactor is stopped.
  */
 int schedutil_alloc_respond_success_pack (schedutil_t *util,
@@ -59,6 +61,18 @@ int schedutil_alloc_respond_success_pack (schedutil_t *util,
  */
 int schedutil_alloc_respond_cancel (schedutil_t *util, const flux_msg_t *msg);
 
+struct schedutil_alloc_stats {
+    size_t commits;     // KVS commits of R
+    size_t committed;   // allocations committed
+    size_t batch_max;   // most allocations committed at once
+};
+
+/* Get statistics for the R commits of alloc success responses.
+ * Return 0 on success, -1 on error with errno set.
+ */
+int schedutil_alloc_stats_get (schedutil_t *util,
+                               struct schedutil_alloc_stats *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,6 +56,8 @@ schedutil_t *schedutil_create (flux_t *h,
     if (!(util->outstanding_futures = zlistx_new ()))
         goto error;
     zlistx_set_destructor (util->outstanding_futures, future_destructor);
+    if (alloc_batch_init (util) < 0)
+        goto error;
     if (ops_register (util) < 0)
         goto error;
 
@@ -70,6 +72,7 @@ void schedutil_destroy (schedutil_t *util)
 {
     if (util) {
         int saved_errno = errno;
+        alloc_batch_cleanup (util);
         zlistx_destroy (&util->outstanding_futures);
         ops_unregister (util);
         free (util);
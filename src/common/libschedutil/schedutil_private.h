@@ -16,6 +16,7 @@
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
 #include "init.h"
+#include "alloc.h"
 
 
 struct schedutil_ctx {
@@ -25,6 +26,10 @@ struct schedutil_ctx {
     int flags;
     void *cb_arg;
     zlistx_t *outstanding_futures;
+    struct alloc_batch *alloc_batch;
+    flux_watcher_t *alloc_prep;
+    flux_watcher_t *alloc_idle;
+    struct schedutil_alloc_stats alloc_stats;
 };
 
 /* Track futures that need to be destroyed on scheduler unload.
@@ -38,4 +43,9 @@ int remove_outstanding_future (schedutil_t *util, flux_future_t *fut);
 int ops_register (schedutil_t *util);
 void ops_unregister (schedutil_t *util);
 
+/* Create/destroy the watchers that commit batched alloc R.
+ */
+int alloc_batch_init (schedutil_t *util);
+void alloc_batch_cleanup (schedutil_t *util);
+
 #endif /* HAVE_SCHEDUTIL_PRIVATE_H */
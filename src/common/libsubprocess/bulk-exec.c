@@ -21,9 +21,13 @@
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libutil/aux.h"
+#include "src/common/libutil/errno_safe.h"
 #include "src/common/libjob/idf58.h"
 #include "ccan/str/str.h"
 #include "bulk-exec.h"
+#include "subprocess_private.h"
+#include "remote.h"
+#include "client.h"
 
 struct exec_cmd {
     struct idset *ranks;
@@ -31,6 +35,17 @@ struct exec_cmd {
     int flags;
 };
 
+/* One bulk-exec request, starting an exec_cmd on all of its ranks.
+ */
+struct bulk_launch {
+    struct bulk_exec *exec;
+    flux_future_t *f;
+    flux_subprocess_t **procs;   /* Member subprocesses in rank order */
+    int count;
+    struct idset *pending;       /* Ranks whose exec stream has not ended */
+    bool responded;              /* At least one update was received */
+};
+
 struct bulk_exec {
     flux_t *h;
 
@@ -48,6 +63,8 @@ struct bulk_exec {
     int exit_status;         /* Largest wait status of all complete procs */
 
     unsigned int active:1;
+    unsigned int collective:1;        /* Use bulk-exec requests */
+    unsigned int collective_enosys:1; /* Service has no bulk-exec method */
 
     flux_watcher_t *prep;
     flux_watcher_t *check;
@@ -61,6 +78,7 @@ struct bulk_exec {
 
     zlist_t *commands;
     zlist_t *processes;
+    zlist_t *launches;
 
     struct bulk_exec_ops *handlers;
     void *arg;
@@ -362,12 +380,208 @@ static int subprocess_destroy (flux_t *h, flux_subprocess_t *p)
     return 0;
 }
 
+static void bulk_launch_destroy (void *arg)
+{
+    struct bulk_launch *launch = arg;
+    if (launch) {
+        int saved_errno = errno;
+        flux_future_destroy (launch->f);
+        idset_destroy (launch->pending);
+        free (launch->procs);
+        free (launch);
+        errno = saved_errno;
+    }
+}
+
+static int procs_cmp (const void *a, const void *b)
+{
+    int rank = *(const int *)a;
+    flux_subprocess_t *p = *(flux_subprocess_t * const *)b;
+    return rank - flux_subprocess_rank (p);
+}
+
+static flux_subprocess_t *launch_lookup (struct bulk_launch *launch, int rank)
+{
+    flux_subprocess_t **pp = bsearch (&rank,
+                                      launch->procs,
+                                      launch->count,
+                                      sizeof (launch->procs[0]),
+                                      procs_cmp);
+    return pp ? *pp : NULL;
+}
+
+/* End the exec stream of every member that has not ended yet.
+ */
+static void launch_fail_pending (struct bulk_launch *launch,
+                                 int errnum,
+                                 const char *errstr)
+{
+    unsigned int rank = idset_first (launch->pending);
+    while (rank != IDSET_INVALID_ID) {
+        flux_subprocess_t *p;
+        if ((p = launch_lookup (launch, rank)))
+            remote_proxy_error (p, errnum, errstr);
+        rank = idset_next (launch->pending, rank);
+    }
+    idset_range_clear (launch->pending, 0, INT_MAX);
+}
+
+/* The service does not support bulk-exec.  Start each member with its own
+ * exec request instead, as if collective mode had not been enabled.
+ */
+static void launch_fallback (struct bulk_launch *launch)
+{
+    struct bulk_exec *exec = launch->exec;
+
+    exec->collective_enosys = 1;
+    for (int i = 0; i < launch->count; i++) {
+        flux_subprocess_t *p = launch->procs[i];
+        if (remote_exec (p) < 0)
+            remote_proxy_error (p, errno, NULL);
+    }
+    idset_range_clear (launch->pending, 0, INT_MAX);
+}
+
+static void launch_continuation (flux_future_t *f, void *arg)
+{
+    struct bulk_launch *launch = arg;
+    flux_t *h = launch->exec->h;
+    json_t *updates;
+    json_t *entry;
+    size_t index;
+
+    if (subprocess_bulk_exec_get (f, &updates) < 0) {
+        if (errno == ENOSYS && !launch->responded)
+            launch_fallback (launch);
+        else if (errno == ENODATA)
+            launch_fail_pending (launch,
+                                 EPROTO,
+                                 "bulk-exec stream ended early");
+        else
+            launch_fail_pending (launch, errno, future_strerror (f, errno));
+        return;
+    }
+    launch->responded = true;
+    json_array_foreach (updates, index, entry) {
+        int rank;
+        json_t *response = NULL;
+        int errnum = 0;
+        const char *errstr = NULL;
+        flux_subprocess_t *p;
+
+        if (json_unpack (entry,
+                         "{s:i s?o s?i s?s}",
+                         "rank", &rank,
+                         "response", &response,
+                         "errnum", &errnum,
+                         "errstr", &errstr) < 0
+            || (!response && errnum == 0)
+            || !idset_test (launch->pending, rank)
+            || !(p = launch_lookup (launch, rank))) {
+            flux_log (h, LOG_ERR, "bulk-exec: ignoring invalid update");
+            continue;
+        }
+        if (response) {
+            if (remote_proxy_respond (p, response) < 0)
+                remote_proxy_error (p, errno, NULL);
+        }
+        else {
+            (void)idset_clear (launch->pending, rank);
+            remote_proxy_error (p, errnum, errstr);
+        }
+    }
+    flux_future_reset (f);
+}
+
+static bool exec_use_collective (struct bulk_exec *exec, struct exec_cmd *cmd)
+{
+    /* sdexec needs a unit name per rank, and signed requests are signed
+     * per rank, so those are always started one rank at a time.
+     */
+    return exec->collective
+        && !exec->collective_enosys
+        && !streq (exec->service, "sdexec")
+        && !(cmd->flags & FLUX_SUBPROCESS_FLAGS_SIGN);
+}
+
+/* Start all ranks of 'cmd' with one bulk-exec request.  A subprocess
+ * object is still created for each rank, and the per-rank updates from the
+ * bulk-exec response stream are delivered to it.
+ */
+static int exec_start_cmd_collective (struct bulk_exec *exec,
+                                      struct exec_cmd *cmd)
+{
+    struct bulk_launch *launch;
+    char *ranks = NULL;
+    int count = idset_count (cmd->ranks);
+    int flags;
+    int local_flags;
+    uint32_t rank;
+
+    if (!(launch = calloc (1, sizeof (*launch)))
+        || !(launch->procs = calloc (count, sizeof (launch->procs[0])))
+        || !(launch->pending = idset_copy (cmd->ranks))
+        || !(ranks = idset_encode (cmd->ranks, IDSET_FLAG_RANGE)))
+        goto error;
+    launch->exec = exec;
+    rank = idset_first (cmd->ranks);
+    while (rank != IDSET_INVALID_ID) {
+        flux_subprocess_t *p = subprocess_rexec_member (exec->h,
+                                                        exec->service,
+                                                        rank,
+                                                        cmd->flags,
+                                                        cmd->cmd,
+                                                        &exec->ops,
+                                                        flux_llog,
+                                                        exec->h);
+        if (!p)
+            goto error;
+        if (flux_subprocess_aux_set (p, "job-exec::exec", exec, NULL) < 0
+           || zlist_append (exec->processes, p) < 0) {
+            flux_subprocess_destroy (p);
+            goto error;
+        }
+        zlist_freefn (exec->processes, p,
+                     (zlist_free_fn *) flux_subprocess_destroy,
+                     true);
+        launch->procs[launch->count++] = p;
+        rank = idset_next (cmd->ranks, rank);
+    }
+    remote_exec_flags (launch->procs[0], &flags, &local_flags);
+    if (!(launch->f = subprocess_bulk_exec (exec->h,
+                                            exec->service,
+                                            ranks,
+                                            cmd->cmd,
+                                            flags,
+                                            local_flags))
+        || flux_future_then (launch->f, -1., launch_continuation, launch) < 0
+        || zlist_append (exec->launches, launch) < 0)
+        goto error;
+    zlist_freefn (exec->launches, launch, bulk_launch_destroy, true);
+    idset_range_clear (cmd->ranks, 0, INT_MAX);
+    free (ranks);
+    return count;
+error:
+    /* Members created so far have been added to exec->processes.
+     * End them so that they are counted as complete.
+     */
+    if (launch)
+        launch_fail_pending (launch, errno, NULL);
+    ERRNO_SAFE_WRAP (free, ranks);
+    bulk_launch_destroy (launch);
+    return -1;
+}
+
 static int exec_start_cmd (struct bulk_exec *exec,
                            struct exec_cmd *cmd,
                            int max)
 {
     int count = 0;
     uint32_t rank;
+
+    if (exec_use_collective (exec, cmd))
+        return exec_start_cmd_collective (exec, cmd);
+
     rank = idset_first (cmd->ranks);
     while (rank != IDSET_INVALID_ID && (max < 0 || count < max)) {
         /* Set the unit name for the "sdexec" service.  This is done here
@@ -448,7 +662,7 @@ static int exec_start_cmds (struct bulk_exec *exec, int max)
         if (idset_count (cmd->ranks) == 0)
             zlist_remove (exec->commands, cmd);
         if (max > 0)
-            max -= rc;
+            max = rc < max ? max - rc : 0;
 
     }
     return 0;
@@ -490,6 +704,7 @@ void bulk_exec_destroy (struct bulk_exec *exec)
 {
     if (exec) {
         int saved_errno = errno;
+        zlist_destroy (&exec->launches);
         zlist_destroy (&exec->processes);
         zlist_destroy (&exec->commands);
         idset_destroy (exec->exit_batch);
@@ -529,6 +744,7 @@ struct bulk_exec * bulk_exec_create (struct bulk_exec_ops *ops,
     exec->arg = arg;
     exec->processes = zlist_new ();
     exec->commands = zlist_new ();
+    exec->launches = zlist_new ();
     exec->exit_batch = idset_create (0, IDSET_FLAG_AUTOGROW);
     exec->max_start_per_loop = 1;
 
@@ -548,6 +764,16 @@ int bulk_exec_set_max_per_loop (struct bulk_exec *exec, int max)
     return 0;
 }
 
+int bulk_exec_set_collective (struct bulk_exec *exec, bool enable)
+{
+    if (!exec) {
+        errno = EINVAL;
+        return -1;
+    }
+    exec->collective = enable ? 1 : 0;
+    return 0;
+}
+
 int bulk_exec_push_cmd (struct bulk_exec *exec,
                        const struct idset *ranks,
                        flux_cmd_t *cmd,
@@ -634,6 +860,36 @@ int bulk_exec_cancel (struct bulk_exec *exec)
     return 0;
 }
 
+/*  Log the per-rank errors of a bulk-kill request (see bulk_kill_push()).
+ */
+static void bulk_kill_log_error (flux_t *h, flux_future_t *cf, flux_jobid_t id)
+{
+    json_t *errors = flux_future_aux_get (cf, "bulk_exec::kill_errors");
+    json_t *entry;
+    size_t index;
+
+    json_array_foreach (errors, index, entry) {
+        int rank;
+        int errnum;
+        const char *errstr = NULL;
+
+        if (json_unpack (entry,
+                         "{s:i s:i s?s}",
+                         "rank", &rank,
+                         "errnum", &errnum,
+                         "errstr", &errstr) < 0
+            || errnum == ESRCH)
+            continue;
+        flux_log (h,
+                  LOG_ERR,
+                  "%s: exec_kill: %s (rank %lu): %s",
+                  idf58 (id),
+                  flux_get_hostbyrank (h, rank),
+                  (unsigned long)rank,
+                  errstr ? errstr : flux_strerror (errnum));
+    }
+}
+
 /*  Loop through all child futures and print rank-specific errors
  */
 void bulk_exec_kill_log_error (flux_future_t *f, flux_jobid_t id)
@@ -649,7 +905,9 @@ void bulk_exec_kill_log_error (flux_future_t *f, flux_jobid_t id)
     while (name) {
         flux_future_t *cf = flux_future_get_child (f, name);
         uint32_t rank = flux_rpc_get_nodeid (cf);
-        if (flux_future_is_ready (cf)
+        if (streq (name, "bulk"))
+            bulk_kill_log_error (h, cf, id);
+        else if (flux_future_is_ready (cf)
             && flux_future_get (cf, NULL) < 0
             && errno != ESRCH
             && rank != FLUX_NODEID_ANY) {
@@ -665,12 +923,119 @@ void bulk_exec_kill_log_error (flux_future_t *f, flux_jobid_t id)
     }
 }
 
+/*  Fulfill the "bulk" child future of bulk_exec_kill() with the result of
+ *   the bulk-kill request.  Per-rank errors are stored with the child so
+ *   they can be logged by bulk_exec_kill_log_error().
+ */
+static void bulk_kill_continuation (flux_future_t *f, void *arg)
+{
+    flux_future_t *cf = arg;
+    json_t *pids = flux_future_aux_get (cf, "bulk_exec::kill_pids");
+    json_t *errors = NULL;
+    json_t *entry;
+    size_t index;
+
+    if (flux_rpc_get_unpack (f, "{s:o}", "errors", &entry) < 0) {
+        int errnum = errno;
+        const char *errstr = future_strerror (f, errnum);
+        const char *key;
+        json_t *value;
+
+        /* Report the error for every rank that was signaled.
+         */
+        if (!(errors = json_array ()))
+            goto error;
+        json_object_foreach (pids, key, value) {
+            json_t *o = json_pack ("{s:i s:i s:s}",
+                                   "rank", atoi (key),
+                                   "errnum", errnum,
+                                   "errstr", errstr);
+            if (!o || json_array_append_new (errors, o) < 0)
+                goto error;
+        }
+    }
+    else
+        errors = json_incref (entry);
+    if (flux_future_aux_set (cf,
+                             "bulk_exec::kill_errors",
+                             errors,
+                             (flux_free_f)json_decref) < 0)
+        goto error;
+    /* Succeed unless there were errors, and fail with the first error
+     * otherwise, as the per-rank child futures would.
+     */
+    json_array_foreach (errors, index, entry) {
+        int errnum;
+        if (json_unpack (entry, "{s:i}", "errnum", &errnum) == 0) {
+            flux_future_fulfill_error (cf, errnum, NULL);
+            return;
+        }
+    }
+    flux_future_fulfill (cf, NULL, NULL);
+    return;
+error:
+    json_decref (errors);
+    flux_future_fulfill_error (cf, ENOMEM, NULL);
+}
+
+/*  Signal running members of bulk-exec requests with one bulk-kill request,
+ *   pushed to 'cf' as child "bulk".  'pids' maps rank to pid.
+ */
+static int bulk_kill_push (struct bulk_exec *exec,
+                           flux_future_t *cf,
+                           json_t *pids,
+                           int signum)
+{
+    flux_future_t *child = NULL;
+    flux_future_t *f = NULL;
+
+    if (!(child = flux_future_create (NULL, NULL)))
+        return -1;
+    flux_future_set_flux (child, exec->h);
+    if (flux_future_aux_set (child,
+                             "bulk_exec::kill_pids",
+                             json_incref (pids),
+                             (flux_free_f)json_decref) < 0) {
+        json_decref (pids);
+        goto error;
+    }
+    if (!(f = subprocess_bulk_kill (exec->h, exec->service, pids, signum))
+        || flux_future_aux_set (child,
+                                NULL,
+                                f,
+                                (flux_free_f)flux_future_destroy) < 0) {
+        flux_future_destroy (f);
+        goto error;
+    }
+    if (flux_future_then (f, -1., bulk_kill_continuation, child) < 0
+        || flux_future_push (cf, "bulk", child) < 0)
+        goto error;
+    return 0;
+error:
+    flux_future_destroy (child);
+    return -1;
+}
+
+/*  Members of bulk-exec requests that are running are signaled with one
+ *   bulk-kill request.  Others are signaled one at a time, which also
+ *   covers pending signals for processes that are not running yet.
+ */
+static bool use_bulk_kill (struct bulk_exec *exec, flux_subprocess_t *p)
+{
+    return exec->collective
+        && !exec->collective_enosys
+        && zlist_size (exec->launches) > 0
+        && flux_subprocess_state (p) == FLUX_SUBPROCESS_RUNNING
+        && flux_subprocess_pid (p) > 0;
+}
+
 flux_future_t *bulk_exec_kill (struct bulk_exec *exec,
                                const struct idset *ranks,
                                int signum)
 {
     flux_subprocess_t *p;
     flux_future_t *cf;
+    json_t *pids = NULL;
 
     if (!exec || signum < 0) {
         errno = EINVAL;
@@ -686,6 +1051,24 @@ flux_future_t *bulk_exec_kill (struct bulk_exec *exec,
         if ((!ranks || idset_test (ranks, flux_subprocess_rank (p)))) {
             flux_future_t *f = NULL;
             char s[64];
+
+            (void) snprintf (s,
+                             sizeof (s)-1,
+                             "%u",
+                             flux_subprocess_rank (p));
+            if (use_bulk_kill (exec, p)) {
+                if ((!pids && !(pids = json_object ()))
+                    || json_object_set_new (pids,
+                                            s,
+                                            json_integer (
+                                              flux_subprocess_pid (p))) < 0) {
+                    flux_future_fulfill_error (cf, ENOMEM, "Internal error");
+                    json_decref (pids);
+                    return cf;
+                }
+                p = zlist_next (exec->processes);
+                continue;
+            }
             if (!(f = flux_subprocess_kill (p, signum))) {
                 /* ignore inactive subprocesses (denoted by errno == ESRCH)
                  */
@@ -699,16 +1082,20 @@ flux_future_t *bulk_exec_kill (struct bulk_exec *exec,
                 }
             }
             if (f) {
-                (void) snprintf (s,
-                                 sizeof (s)-1,
-                                 "%u",
-                                flux_subprocess_rank (p));
                 if (flux_future_push (cf, s, f) < 0)
                     flux_future_destroy (f);
             }
         }
         p = zlist_next (exec->processes);
     }
+    if (pids) {
+        if (bulk_kill_push (exec, cf, pids, signum) < 0) {
+            flux_future_fulfill_error (cf, errno, "Internal error");
+            json_decref (pids);
+            return cf;
+        }
+        json_decref (pids);
+    }
 
     /*  If no child futures were pushed into the wait_all future `cf`,
      *   then no signals were sent and we should immediately return ENOENT.
@@ -13,6 +13,7 @@
 #ifndef _SUBPROCESS_BULK_EXEC_H
 #define _SUBPROCESS_BULK_EXEC_H 1
 
+#include <stdbool.h>
 #include <flux/core.h>
 #include <flux/idset.h>
 
@@ -60,6 +61,12 @@ int bulk_exec_aux_set (struct bulk_exec *exec,
  */
 int bulk_exec_set_max_per_loop (struct bulk_exec *exec, int max);
 
+/*  Start all ranks of each cmd with one TBON-collective bulk-exec
+ *   request, if supported by the service, rather than one exec request
+ *   per rank.  Writing to stdin is not supported in this mode.
+ */
+int bulk_exec_set_collective (struct bulk_exec *exec, bool enable);
+
 void bulk_exec_destroy (struct bulk_exec *exec);
 
 int bulk_exec_push_cmd (struct bulk_exec *exec,
@@ -53,6 +53,7 @@ struct rexec_ctx {
     uint32_t rank;
     char *service_name;
     bool sign;
+    bool proxy;
 };
 
 static void rexec_response_clear (struct rexec_response *resp)
@@ -578,6 +579,13 @@ int subprocess_write (flux_future_t *f_exec,
         errno = EINVAL;
         return -1;
     }
+    /* There is no exec request to write to if the process was started by
+     * a bulk-exec request.
+     */
+    if (ctx->proxy) {
+        errno = ENOTSUP;
+        return -1;
+    }
     if (asprintf (&topic, "%s.write", ctx->service_name) < 0)
         return -1;
     if (!(io = ioencode (stream, "0", data, len, eof))
@@ -631,4 +639,146 @@ flux_future_t *subprocess_kill (flux_t *h,
     return f;
 }
 
+flux_future_t *subprocess_rexec_proxy (flux_t *h,
+                                       const char *service_name,
+                                       uint32_t rank,
+                                       flux_cmd_t *cmd,
+                                       int flags)
+{
+    flux_future_t *f;
+    struct rexec_ctx *ctx;
+
+    if (!h || !cmd || !service_name) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(f = flux_future_create (NULL, NULL)))
+        return NULL;
+    flux_future_set_flux (f, h);
+    if (!(ctx = rexec_ctx_create (cmd, service_name, rank, flags))
+        || flux_future_aux_set (f,
+                                "flux::rexec",
+                                ctx,
+                                (flux_free_f)rexec_ctx_destroy) < 0) {
+        rexec_ctx_destroy (ctx);
+        flux_future_destroy (f);
+        return NULL;
+    }
+    ctx->proxy = true;
+    return f;
+}
+
+int subprocess_rexec_proxy_respond (flux_future_t *f, json_t *response)
+{
+    struct rexec_ctx *ctx;
+    flux_msg_t *msg = NULL;
+    char topic[128];
+    char *s = NULL;
+
+    if (!(ctx = flux_future_aux_get (f, "flux::rexec")) || !response) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (snprintf (topic,
+                  sizeof (topic),
+                  "%s.exec",
+                  ctx->service_name) >= sizeof (topic)) {
+        errno = EOVERFLOW;
+        return -1;
+    }
+    if (!(s = json_dumps (response, JSON_COMPACT))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    if (!(msg = flux_response_encode (topic, s))) {
+        ERRNO_SAFE_WRAP (free, s);
+        return -1;
+    }
+    free (s);
+    flux_future_fulfill (f, msg, (flux_free_f)flux_msg_decref);
+    return 0;
+}
+
+flux_future_t *subprocess_bulk_exec (flux_t *h,
+                                     const char *service_name,
+                                     const char *ranks,
+                                     flux_cmd_t *cmd,
+                                     int flags,
+                                     int local_flags)
+{
+    flux_future_t *f;
+    json_t *ocmd;
+    char topic[128];
+    int valid_flags = SUBPROCESS_REXEC_STDOUT
+        | SUBPROCESS_REXEC_STDERR
+        | SUBPROCESS_REXEC_CHANNEL;
+
+    if (!h || !service_name || !ranks || !cmd || (flags & ~valid_flags)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (snprintf (topic,
+                  sizeof (topic),
+                  "%s.bulk-exec",
+                  service_name) >= sizeof (topic)) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    if (!(ocmd = cmd_tojson (cmd)))
+        return NULL;
+    f = flux_rpc_pack (h,
+                       topic,
+                       FLUX_NODEID_ANY,
+                       FLUX_RPC_STREAMING,
+                       "{s:s s:O s:i s:i}",
+                       "ranks", ranks,
+                       "cmd", ocmd,
+                       "flags", flags,
+                       "local_flags", local_flags);
+    ERRNO_SAFE_WRAP (json_decref, ocmd);
+    return f;
+}
+
+int subprocess_bulk_exec_get (flux_future_t *f, json_t **updates)
+{
+    json_t *o;
+
+    if (flux_rpc_get_unpack (f, "{s:o}", "updates", &o) < 0)
+        return -1;
+    if (!json_is_array (o)) {
+        errno = EPROTO;
+        return -1;
+    }
+    if (updates)
+        *updates = o;
+    return 0;
+}
+
+flux_future_t *subprocess_bulk_kill (flux_t *h,
+                                     const char *service_name,
+                                     json_t *pids,
+                                     int signum)
+{
+    char topic[128];
+
+    if (!h || !service_name || !json_is_object (pids)) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (snprintf (topic,
+                  sizeof (topic),
+                  "%s.bulk-kill",
+                  service_name) >= sizeof (topic)) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    return flux_rpc_pack (h,
+                          topic,
+                          FLUX_NODEID_ANY,
+                          0,
+                          "{s:i s:O}",
+                          "signum", signum,
+                          "pids", pids);
+}
+
 // vi: ts=4 sw=4 expandtab
@@ -94,6 +94,37 @@ flux_future_t *subprocess_kill (flux_t *h,
                                 int signum,
                                 bool sign);
 
+/* A proxy future stands in for the exec request of one process started by
+ * a bulk-exec request.  The exec responses for that process are delivered
+ * to it with subprocess_rexec_proxy_respond() or flux_future_fulfill_error(),
+ * and may then be accessed with subprocess_rexec_get() et al.
+ */
+flux_future_t *subprocess_rexec_proxy (flux_t *h,
+                                       const char *service_name,
+                                       uint32_t rank,
+                                       flux_cmd_t *cmd,
+                                       int flags);
+int subprocess_rexec_proxy_respond (flux_future_t *f, json_t *response);
+
+/* Start 'cmd' on 'ranks' with one <service>.bulk-exec request.  Each
+ * response carries an array of per-rank updates (see rexec/collective.c).
+ */
+flux_future_t *subprocess_bulk_exec (flux_t *h,
+                                     const char *service_name,
+                                     const char *ranks,
+                                     flux_cmd_t *cmd,
+                                     int flags,
+                                     int local_flags);
+int subprocess_bulk_exec_get (flux_future_t *f, json_t **updates);
+
+/* Send 'signum' to the processes in 'pids', an object mapping rank to pid.
+ * The response carries an array of per-rank errors.
+ */
+flux_future_t *subprocess_bulk_kill (flux_t *h,
+                                     const char *service_name,
+                                     json_t *pids,
+                                     int signum);
+
 
 #endif /* !_SUBPROCESS_CLIENT_H */
 
@@ -629,9 +629,8 @@ error:
     remote_kill_nowait (p, SIGKILL);
 }
 
-int remote_exec (flux_subprocess_t *p)
+void remote_exec_flags (flux_subprocess_t *p, int *flagsp, int *local_flagsp)
 {
-    flux_future_t *f;
     int flags = 0;
     int local_flags = p->flags;
 
@@ -648,6 +647,17 @@ int remote_exec (flux_subprocess_t *p)
      */
     local_flags &= ~FLUX_SUBPROCESS_FLAGS_LOCAL_UNBUF;
 
+    *flagsp = flags;
+    *local_flagsp = local_flags;
+}
+
+int remote_exec (flux_subprocess_t *p)
+{
+    flux_future_t *f;
+    int flags;
+    int local_flags;
+
+    remote_exec_flags (p, &flags, &local_flags);
     if (!(f = subprocess_rexec (p->h,
                                 p->service_name,
                                 p->rank,
@@ -661,10 +671,46 @@ int remote_exec (flux_subprocess_t *p)
         flux_future_destroy (f);
         return -1;
     }
+    /* A proxy future is replaced if a bulk-exec request fell back to
+     * sending exec requests one rank at a time.
+     */
+    flux_future_destroy (p->f);
     p->f = f;
     return 0;
 }
 
+int remote_exec_proxy (flux_subprocess_t *p)
+{
+    flux_future_t *f;
+    int flags;
+    int local_flags;
+
+    remote_exec_flags (p, &flags, &local_flags);
+    if (!(f = subprocess_rexec_proxy (p->h,
+                                      p->service_name,
+                                      p->rank,
+                                      p->cmd,
+                                      flags))
+        || flux_future_then (f, -1., rexec_continuation, p) < 0) {
+        flux_future_destroy (f);
+        return -1;
+    }
+    p->f = f;
+    return 0;
+}
+
+int remote_proxy_respond (flux_subprocess_t *p, json_t *response)
+{
+    return subprocess_rexec_proxy_respond (p->f, response);
+}
+
+void remote_proxy_error (flux_subprocess_t *p,
+                         int errnum,
+                         const char *errstr)
+{
+    flux_future_fulfill_error (p->f, errnum, errstr);
+}
+
 int remote_attach (flux_subprocess_t *p, pid_t pid, const char *label)
 {
     flux_future_t *f;
@@ -11,6 +11,8 @@
 #ifndef _SUBPROCESS_REMOTE_H
 #define _SUBPROCESS_REMOTE_H
 
+#include <jansson.h>
+
 #include "subprocess.h"
 
 int subprocess_remote_setup (flux_subprocess_t *p, const char *service_name);
@@ -23,6 +25,22 @@ int subprocess_setup_service_name (flux_subprocess_t *p,
 
 int remote_exec (flux_subprocess_t *p);
 
+/* Get the exec request flags for 'p'.
+ */
+void remote_exec_flags (flux_subprocess_t *p, int *flags, int *local_flags);
+
+/* Prepare 'p' to be started as one of the processes of a bulk-exec
+ * request.  Instead of sending an exec request, 'p' waits on a proxy
+ * future, and the caller delivers the exec responses for 'p' with
+ * remote_proxy_respond() and remote_proxy_error().  remote_exec() may
+ * still be called to send a regular exec request if bulk-exec fails.
+ */
+int remote_exec_proxy (flux_subprocess_t *p);
+int remote_proxy_respond (flux_subprocess_t *p, json_t *response);
+void remote_proxy_error (flux_subprocess_t *p,
+                         int errnum,
+                         const char *errstr);
+
 int remote_attach (flux_subprocess_t *p, pid_t pid, const char *label);
 
 flux_future_t *remote_kill (flux_subprocess_t *p, int signum);
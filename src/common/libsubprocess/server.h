@@ -26,6 +26,9 @@ typedef int (*subprocess_server_auth_f) (const flux_msg_t *msg,
                                          void *arg,
                                          flux_error_t *error);
 
+typedef void (*subprocess_server_disconnect_f) (const flux_msg_t *msg,
+                                                void *arg);
+
 /* Create a subprocess server.
  * This sets up a signal watcher for SIGCHLD.  Make sure SIGCHLD cannot be
  * delivered to other threads. Also, it may be wise to block SIGPIPE to
@@ -45,6 +48,14 @@ void subprocess_server_set_auth_cb (subprocess_server_t *s,
                                     subprocess_server_auth_f fn,
                                     void *arg);
 
+/* Register a callback for disconnect requests, called after the server
+ * has cleaned up the disconnecting client's subprocesses.  This allows
+ * other methods of the service to clean up after the client too.
+ */
+void subprocess_server_set_disconnect_cb (subprocess_server_t *s,
+                                          subprocess_server_disconnect_f fn,
+                                          void *arg);
+
 /* Destroy a subprocess server.  This sends a SIGKILL to any remaining
  * subprocesses, then destroys them.
  */
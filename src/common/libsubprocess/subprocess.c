@@ -614,14 +614,15 @@ out:
 }
 
 
-flux_subprocess_t *flux_rexec_ex (flux_t *h,
-                                  const char *service_name,
-                                  int rank,
-                                  int flags,
-                                  const flux_cmd_t *cmd,
-                                  const flux_subprocess_ops_t *ops,
-                                  subprocess_log_f log_fn,
-                                  void *log_data)
+static flux_subprocess_t *rexec_create (flux_t *h,
+                                        const char *service_name,
+                                        int rank,
+                                        int flags,
+                                        const flux_cmd_t *cmd,
+                                        const flux_subprocess_ops_t *ops,
+                                        subprocess_log_f log_fn,
+                                        void *log_data,
+                                        bool proxy)
 {
     flux_subprocess_t *p = NULL;
     flux_reactor_t *r;
@@ -676,7 +677,11 @@ flux_subprocess_t *flux_rexec_ex (flux_t *h,
     if (subprocess_setup_completed (p) < 0)
         goto error;
 
-    if (remote_exec (p) < 0)
+    if (proxy) {
+        if (remote_exec_proxy (p) < 0)
+            goto error;
+    }
+    else if (remote_exec (p) < 0)
         goto error;
 
     return p;
@@ -686,6 +691,46 @@ error:
     return NULL;
 }
 
+flux_subprocess_t *flux_rexec_ex (flux_t *h,
+                                  const char *service_name,
+                                  int rank,
+                                  int flags,
+                                  const flux_cmd_t *cmd,
+                                  const flux_subprocess_ops_t *ops,
+                                  subprocess_log_f log_fn,
+                                  void *log_data)
+{
+    return rexec_create (h,
+                         service_name,
+                         rank,
+                         flags,
+                         cmd,
+                         ops,
+                         log_fn,
+                         log_data,
+                         false);
+}
+
+flux_subprocess_t *subprocess_rexec_member (flux_t *h,
+                                            const char *service_name,
+                                            int rank,
+                                            int flags,
+                                            const flux_cmd_t *cmd,
+                                            const flux_subprocess_ops_t *ops,
+                                            subprocess_log_f log_fn,
+                                            void *log_data)
+{
+    return rexec_create (h,
+                         service_name,
+                         rank,
+                         flags,
+                         cmd,
+                         ops,
+                         log_fn,
+                         log_data,
+                         true);
+}
+
 flux_subprocess_t *flux_rexec (flux_t *h,
                                int rank,
                                int flags,
@@ -145,6 +145,19 @@ void subprocess_decref (flux_subprocess_t *p);
 
 void subprocess_standard_output (flux_subprocess_t *p, const char *stream);
 
+/* Like flux_rexec_ex(), but no exec request is sent.  The subprocess is
+ * started by the caller as one member of a bulk-exec request, and its exec
+ * responses are delivered with remote_proxy_respond() (see remote.h).
+ */
+flux_subprocess_t *subprocess_rexec_member (flux_t *h,
+                                            const char *service_name,
+                                            int rank,
+                                            int flags,
+                                            const flux_cmd_t *cmd,
+                                            const flux_subprocess_ops_t *ops,
+                                            subprocess_log_f log_fn,
+                                            void *log_data);
+
 #endif /* !_SUBPROCESS_PRIVATE_H */
 
 // vi: ts=4 sw=4 expandtab
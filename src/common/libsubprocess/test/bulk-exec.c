@@ -204,6 +204,10 @@ int main (int ac, char **av)
           .arginfo = "NCMDS",
           .usage = "Cancel after NCMDS cmds have been launched"
         },
+        { .name = "collective",
+          .has_arg = 0,
+          .usage = "Start each cmd with one bulk-exec request"
+        },
         OPTPARSE_TABLE_END
     };
 
@@ -253,6 +257,10 @@ int main (int ac, char **av)
     if (bulk_exec_set_max_per_loop (exec, optparse_get_int (p, "mpl", -1)) < 0)
         log_err_exit ("bulk_exec_set_max_per_loop");
 
+    if (bulk_exec_set_collective (exec,
+                                  optparse_hasopt (p, "collective")) < 0)
+        log_err_exit ("bulk_exec_set_collective");
+
     ncmds = optparse_get_int (p, "ncmds", 1);
 
     push_commands (exec, idset, ncmds, ac, av);
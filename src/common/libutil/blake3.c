@@ -0,0 +1,459 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* blake3.c - BLAKE3 hash function (hash mode only)
+ *
+ * Implemented from the BLAKE3 specification
+ * (https://github.com/BLAKE3-team/BLAKE3-specs).
+ *
+ * Input is split into 1K chunks.  Each chunk is hashed on its own to a
+ * chaining value, and chaining values are merged pairwise into a binary
+ * tree whose root produces the digest.  Because chunks are independent,
+ * runs of whole chunks are hashed several at a time: on x86_64 CPUs with
+ * AVX2, eight chunks are compressed in parallel, one per 32-bit lane.
+ * The portable path hashes the same chunks one after another.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+
+#include "blake3.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_BLAKE3_AVX2 1
+#include <immintrin.h>
+#endif
+
+enum {
+    CHUNK_START = 1,
+    CHUNK_END = 2,
+    PARENT = 4,
+    ROOT = 8,
+};
+
+static const uint32_t IV[8] = {
+    0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A,
+    0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19,
+};
+
+/* Message word order for each of the 7 rounds.  Each row is the previous
+ * row permuted by { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 }.
+ */
+static const uint8_t msg_schedule[7][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+    { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+    { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+    { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+    { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+    { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+};
+
+/* The chunks in a batch are hashed in parallel up to this many at a time.
+ */
+#define BLAKE3_BATCH 8
+
+static inline uint32_t load32 (const uint8_t *p)
+{
+    return (uint32_t)p[0]
+        | ((uint32_t)p[1] << 8)
+        | ((uint32_t)p[2] << 16)
+        | ((uint32_t)p[3] << 24);
+}
+
+static inline void store32 (uint8_t *p, uint32_t w)
+{
+    p[0] = (uint8_t)w;
+    p[1] = (uint8_t)(w >> 8);
+    p[2] = (uint8_t)(w >> 16);
+    p[3] = (uint8_t)(w >> 24);
+}
+
+static inline uint32_t rotr32 (uint32_t w, int c)
+{
+    return (w >> c) | (w << (32 - c));
+}
+
+static inline void g (uint32_t *v,
+                      int a,
+                      int b,
+                      int c,
+                      int d,
+                      uint32_t x,
+                      uint32_t y)
+{
+    v[a] = v[a] + v[b] + x;
+    v[d] = rotr32 (v[d] ^ v[a], 16);
+    v[c] = v[c] + v[d];
+    v[b] = rotr32 (v[b] ^ v[c], 12);
+    v[a] = v[a] + v[b] + y;
+    v[d] = rotr32 (v[d] ^ v[a], 8);
+    v[c] = v[c] + v[d];
+    v[b] = rotr32 (v[b] ^ v[c], 7);
+}
+
+/* Compress one block, leaving the full 16 word state in 'out'.
+ * The first 8 words are the new chaining value.
+ */
+static void compress (const uint32_t cv[8],
+                      const uint8_t block[BLAKE3_BLOCK_LEN],
+                      uint8_t block_len,
+                      uint64_t counter,
+                      uint8_t flags,
+                      uint32_t out[16])
+{
+    uint32_t m[16];
+    uint32_t v[16] = {
+        cv[0], cv[1], cv[2], cv[3], cv[4], cv[5], cv[6], cv[7],
+        IV[0], IV[1], IV[2], IV[3],
+        (uint32_t)counter, (uint32_t)(counter >> 32), block_len, flags,
+    };
+
+    for (int i = 0; i < 16; i++)
+        m[i] = load32 (block + 4 * i);
+    for (int r = 0; r < 7; r++) {
+        const uint8_t *s = msg_schedule[r];
+        g (v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+        g (v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+        g (v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+        g (v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+        g (v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+        g (v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+        g (v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+        g (v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+    for (int i = 0; i < 8; i++) {
+        out[i] = v[i] ^ v[i + 8];
+        out[i + 8] = v[i + 8] ^ cv[i];
+    }
+}
+
+static void compress_cv (uint32_t cv[8],
+                         const uint8_t block[BLAKE3_BLOCK_LEN],
+                         uint8_t block_len,
+                         uint64_t counter,
+                         uint8_t flags)
+{
+    uint32_t out[16];
+
+    compress (cv, block, block_len, counter, flags, out);
+    memcpy (cv, out, 8 * sizeof (uint32_t));
+}
+
+/* Hash 'count' whole chunks of 'input', numbered from 'counter', to their
+ * chaining values.
+ */
+static void hash_chunks_portable (const uint8_t *input,
+                                  size_t count,
+                                  uint64_t counter,
+                                  uint32_t cvs[][8])
+{
+    for (size_t i = 0; i < count; i++) {
+        const uint8_t *chunk = input + i * BLAKE3_CHUNK_LEN;
+
+        memcpy (cvs[i], IV, sizeof (IV));
+        for (int b = 0; b < BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN; b++) {
+            uint8_t flags = 0;
+            if (b == 0)
+                flags |= CHUNK_START;
+            if (b == BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN - 1)
+                flags |= CHUNK_END;
+            compress_cv (cvs[i],
+                         chunk + b * BLAKE3_BLOCK_LEN,
+                         BLAKE3_BLOCK_LEN,
+                         counter + i,
+                         flags);
+        }
+    }
+}
+
+#if HAVE_BLAKE3_AVX2
+#define AVX2_ROTR(x, c) \
+    _mm256_or_si256 (_mm256_srli_epi32 ((x), (c)), \
+                     _mm256_slli_epi32 ((x), 32 - (c)))
+
+__attribute__((target ("avx2")))
+static inline void g_avx2 (__m256i *v,
+                           int a,
+                           int b,
+                           int c,
+                           int d,
+                           __m256i x,
+                           __m256i y)
+{
+    v[a] = _mm256_add_epi32 (_mm256_add_epi32 (v[a], v[b]), x);
+    v[d] = AVX2_ROTR (_mm256_xor_si256 (v[d], v[a]), 16);
+    v[c] = _mm256_add_epi32 (v[c], v[d]);
+    v[b] = AVX2_ROTR (_mm256_xor_si256 (v[b], v[c]), 12);
+    v[a] = _mm256_add_epi32 (_mm256_add_epi32 (v[a], v[b]), y);
+    v[d] = AVX2_ROTR (_mm256_xor_si256 (v[d], v[a]), 8);
+    v[c] = _mm256_add_epi32 (v[c], v[d]);
+    v[b] = AVX2_ROTR (_mm256_xor_si256 (v[b], v[c]), 7);
+}
+
+/* Hash up to 8 whole chunks at once, chunk i in 32-bit lane i.
+ * Lanes past 'count' are masked off and never read from 'input'.
+ */
+__attribute__((target ("avx2")))
+static void hash8_avx2 (const uint8_t *input,
+                        size_t count,
+                        uint64_t counter,
+                        uint32_t cvs[][8])
+{
+    const __m256i offsets = _mm256_setr_epi32 (0 * BLAKE3_CHUNK_LEN,
+                                               1 * BLAKE3_CHUNK_LEN,
+                                               2 * BLAKE3_CHUNK_LEN,
+                                               3 * BLAKE3_CHUNK_LEN,
+                                               4 * BLAKE3_CHUNK_LEN,
+                                               5 * BLAKE3_CHUNK_LEN,
+                                               6 * BLAKE3_CHUNK_LEN,
+                                               7 * BLAKE3_CHUNK_LEN);
+    uint32_t lo[8], hi[8], active[8];
+    __m256i h[8];
+    __m256i counter_lo, counter_hi, mask;
+
+    for (int i = 0; i < 8; i++) {
+        h[i] = _mm256_set1_epi32 (IV[i]);
+        lo[i] = (uint32_t)(counter + i);
+        hi[i] = (uint32_t)((counter + i) >> 32);
+        active[i] = i < count ? 0xffffffff : 0;
+    }
+    counter_lo = _mm256_loadu_si256 ((const __m256i *)lo);
+    counter_hi = _mm256_loadu_si256 ((const __m256i *)hi);
+    mask = _mm256_loadu_si256 ((const __m256i *)active);
+
+    for (int b = 0; b < BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN; b++) {
+        const uint8_t *block = input + b * BLAKE3_BLOCK_LEN;
+        uint32_t flags = 0;
+        __m256i m[16];
+        __m256i v[16];
+
+        if (b == 0)
+            flags |= CHUNK_START;
+        if (b == BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN - 1)
+            flags |= CHUNK_END;
+        /* Word i of this block from each of the 8 chunks (little endian).
+         */
+        for (int i = 0; i < 16; i++)
+            m[i] = _mm256_mask_i32gather_epi32 (_mm256_setzero_si256 (),
+                                                (const int *)(block + 4 * i),
+                                                offsets,
+                                                mask,
+                                                1);
+        for (int i = 0; i < 8; i++)
+            v[i] = h[i];
+        for (int i = 0; i < 4; i++)
+            v[i + 8] = _mm256_set1_epi32 (IV[i]);
+        v[12] = counter_lo;
+        v[13] = counter_hi;
+        v[14] = _mm256_set1_epi32 (BLAKE3_BLOCK_LEN);
+        v[15] = _mm256_set1_epi32 (flags);
+        for (int r = 0; r < 7; r++) {
+            const uint8_t *s = msg_schedule[r];
+            g_avx2 (v, 0, 4, 8, 12, m[s[0]], m[s[1]]);
+            g_avx2 (v, 1, 5, 9, 13, m[s[2]], m[s[3]]);
+            g_avx2 (v, 2, 6, 10, 14, m[s[4]], m[s[5]]);
+            g_avx2 (v, 3, 7, 11, 15, m[s[6]], m[s[7]]);
+            g_avx2 (v, 0, 5, 10, 15, m[s[8]], m[s[9]]);
+            g_avx2 (v, 1, 6, 11, 12, m[s[10]], m[s[11]]);
+            g_avx2 (v, 2, 7, 8, 13, m[s[12]], m[s[13]]);
+            g_avx2 (v, 3, 4, 9, 14, m[s[14]], m[s[15]]);
+        }
+        for (int i = 0; i < 8; i++)
+            h[i] = _mm256_xor_si256 (v[i], v[i + 8]);
+    }
+    for (int i = 0; i < 8; i++) {
+        uint32_t w[8];
+        _mm256_storeu_si256 ((__m256i *)w, h[i]);
+        for (int lane = 0; lane < count; lane++)
+            cvs[lane][i] = w[lane];
+    }
+}
+#endif /* HAVE_BLAKE3_AVX2 */
+
+static void hash_chunks (const uint8_t *input,
+                         size_t count,
+                         uint64_t counter,
+                         uint32_t cvs[][8])
+{
+#if HAVE_BLAKE3_AVX2
+    if (count > 1 && __builtin_cpu_supports ("avx2")) {
+        hash8_avx2 (input, count, counter, cvs);
+        return;
+    }
+#endif
+    hash_chunks_portable (input, count, counter, cvs);
+}
+
+static void parent_cv (const uint32_t left[8],
+                       const uint32_t right[8],
+                       uint8_t flags,
+                       uint32_t out[16])
+{
+    uint8_t block[BLAKE3_BLOCK_LEN];
+
+    for (int i = 0; i < 8; i++) {
+        store32 (block + 4 * i, left[i]);
+        store32 (block + 32 + 4 * i, right[i]);
+    }
+    compress (IV, block, BLAKE3_BLOCK_LEN, 0, PARENT | flags, out);
+}
+
+/* A chunk has been completed that is not the last of the input:
+ * push its chaining value, first merging completed subtrees.  After
+ * 'total_chunks' chunks, the number of trailing zero bits of
+ * 'total_chunks' is the number of subtrees that can be merged.
+ */
+static void push_cv (BLAKE3_CTX *ctx, uint32_t cv[8], uint64_t total_chunks)
+{
+    uint32_t out[16];
+
+    while ((total_chunks & 1) == 0) {
+        parent_cv (ctx->cv_stack[--ctx->cv_stack_len], cv, 0, out);
+        memcpy (cv, out, 8 * sizeof (uint32_t));
+        total_chunks >>= 1;
+    }
+    memcpy (ctx->cv_stack[ctx->cv_stack_len++], cv, 8 * sizeof (uint32_t));
+}
+
+static size_t chunk_len (BLAKE3_CTX *ctx)
+{
+    return BLAKE3_BLOCK_LEN * ctx->blocks_compressed + ctx->block_len;
+}
+
+static void chunk_reset (BLAKE3_CTX *ctx, uint64_t chunk_counter)
+{
+    memcpy (ctx->cv, IV, sizeof (IV));
+    ctx->chunk_counter = chunk_counter;
+    ctx->block_len = 0;
+    ctx->blocks_compressed = 0;
+}
+
+/* Add up to a chunk's worth of input to the current chunk.  The last block
+ * is always left buffered, since it may need the CHUNK_END and ROOT flags.
+ */
+static void chunk_update (BLAKE3_CTX *ctx, const uint8_t *data, size_t len)
+{
+    while (len > 0) {
+        size_t take;
+
+        if (ctx->block_len == BLAKE3_BLOCK_LEN) {
+            compress_cv (ctx->cv,
+                         ctx->block,
+                         BLAKE3_BLOCK_LEN,
+                         ctx->chunk_counter,
+                         ctx->blocks_compressed == 0 ? CHUNK_START : 0);
+            ctx->blocks_compressed++;
+            ctx->block_len = 0;
+        }
+        take = BLAKE3_BLOCK_LEN - ctx->block_len;
+        if (take > len)
+            take = len;
+        memcpy (ctx->block + ctx->block_len, data, take);
+        ctx->block_len += take;
+        data += take;
+        len -= take;
+    }
+}
+
+void blake3_init (BLAKE3_CTX *ctx)
+{
+    chunk_reset (ctx, 0);
+    ctx->cv_stack_len = 0;
+}
+
+void blake3_update (BLAKE3_CTX *ctx, const void *data, size_t len)
+{
+    const uint8_t *p = data;
+
+    while (len > 0) {
+        size_t take;
+
+        if (chunk_len (ctx) == BLAKE3_CHUNK_LEN) {
+            uint32_t out[16];
+
+            compress (ctx->cv,
+                      ctx->block,
+                      ctx->block_len,
+                      ctx->chunk_counter,
+                      CHUNK_END
+                      | (ctx->blocks_compressed == 0 ? CHUNK_START : 0),
+                      out);
+            push_cv (ctx, out, ctx->chunk_counter + 1);
+            chunk_reset (ctx, ctx->chunk_counter + 1);
+        }
+        /* Whole chunks that are not the last of the input so far can be
+         * hashed directly, a batch at a time.
+         */
+        if (chunk_len (ctx) == 0 && len > BLAKE3_CHUNK_LEN) {
+            uint32_t cvs[BLAKE3_BATCH][8];
+            size_t count = (len - 1) / BLAKE3_CHUNK_LEN;
+
+            if (count > BLAKE3_BATCH)
+                count = BLAKE3_BATCH;
+            hash_chunks (p, count, ctx->chunk_counter, cvs);
+            for (size_t i = 0; i < count; i++) {
+                push_cv (ctx, cvs[i], ctx->chunk_counter + 1);
+                ctx->chunk_counter++;
+            }
+            p += count * BLAKE3_CHUNK_LEN;
+            len -= count * BLAKE3_CHUNK_LEN;
+            continue;
+        }
+        take = BLAKE3_CHUNK_LEN - chunk_len (ctx);
+        if (take > len)
+            take = len;
+        chunk_update (ctx, p, take);
+        p += take;
+        len -= take;
+    }
+}
+
+void blake3_final (BLAKE3_CTX *ctx, uint8_t hash[BLAKE3_OUT_LEN])
+{
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    uint32_t cv[8];
+    uint8_t block_len;
+    uint8_t flags;
+    uint32_t out[16];
+    uint64_t counter = ctx->chunk_counter;
+    int n = ctx->cv_stack_len;
+
+    /* The output node is the current chunk, or if earlier chunks were
+     * pushed, the parent of the stacked subtrees and the current chunk.
+     * It is compressed last, with the ROOT flag.
+     */
+    memset (block, 0, sizeof (block));
+    memcpy (block, ctx->block, ctx->block_len);
+    memcpy (cv, ctx->cv, sizeof (cv));
+    block_len = ctx->block_len;
+    flags = CHUNK_END | (ctx->blocks_compressed == 0 ? CHUNK_START : 0);
+    while (n > 0) {
+        compress (cv, block, block_len, counter, flags, out);
+        for (int i = 0; i < 8; i++) {
+            store32 (block + 4 * i, ctx->cv_stack[n - 1][i]);
+            store32 (block + 32 + 4 * i, out[i]);
+        }
+        memcpy (cv, IV, sizeof (cv));
+        block_len = BLAKE3_BLOCK_LEN;
+        flags = PARENT;
+        counter = 0;
+        n--;
+    }
+    compress (cv, block, block_len, counter, flags | ROOT, out);
+    for (int i = 0; i < 8; i++)
+        store32 (hash + 4 * i, out[i]);
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,44 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_BLAKE3_H
+#define _UTIL_BLAKE3_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define BLAKE3_OUT_LEN      32      // default digest size
+#define BLAKE3_BLOCK_LEN    64
+#define BLAKE3_CHUNK_LEN    1024
+#define BLAKE3_MAX_DEPTH    54      // 2^54 chunks of 1K is 2^64 bytes
+
+/* BLAKE3 hash state (unkeyed hash mode, 32 byte output).
+ * Input is split into 1K chunks whose chaining values are merged in a
+ * binary tree; the stack holds the roots of completed subtrees.
+ */
+typedef struct {
+    uint32_t cv[8];             // chaining value of the current chunk
+    uint64_t chunk_counter;     // index of the current chunk
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    uint8_t block_len;          // bytes in 'block'
+    uint8_t blocks_compressed;  // blocks of the current chunk compressed
+    uint8_t cv_stack_len;
+    uint32_t cv_stack[BLAKE3_MAX_DEPTH][8];
+} BLAKE3_CTX;
+
+void blake3_init (BLAKE3_CTX *ctx);
+void blake3_update (BLAKE3_CTX *ctx, const void *data, size_t len);
+void blake3_final (BLAKE3_CTX *ctx, uint8_t hash[BLAKE3_OUT_LEN]);
+
+#endif /* !_UTIL_BLAKE3_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,214 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* sha_ni.c - SHA-1 and SHA-256 block functions using the x86 SHA extensions
+ *
+ * The portable sha1.c and sha256.c process one block at a time in C.  On
+ * CPUs with SHA-NI, the same compression functions run several times faster
+ * using the sha1rnds4/sha256rnds2 instructions.  The functions here are
+ * compiled with a target attribute so the rest of libutil does not need
+ * special compiler flags, and callers check sha_ni_supported() at runtime
+ * before using them.
+ *
+ * Message schedule: for SHA-256, four message words are computed per group
+ * of four rounds, W[g] = msg2 (msg1 (W[g-4], W[g-3]) + W[g-2:g-1], W[g-1]).
+ * SHA-1 is similar with W[g] = msg2 (msg1 (W[g-4], W[g-3]) ^ W[g-2], W[g-1]).
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <pthread.h>
+
+#include "sha_ni.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define HAVE_SHA_NI 1
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+#if HAVE_SHA_NI
+static pthread_once_t sha_ni_once = PTHREAD_ONCE_INIT;
+static bool sha_ni;
+
+static void sha_ni_detect (void)
+{
+    unsigned int eax, ebx, ecx, edx;
+
+    /* SSSE3 and SSE4.1 (leaf 1 ecx bits 9 and 19) are used alongside SHA
+     * (leaf 7 ebx bit 29).
+     */
+    if (!__get_cpuid (1, &eax, &ebx, &ecx, &edx)
+        || !(ecx & (1 << 9))
+        || !(ecx & (1 << 19)))
+        return;
+    if (!__get_cpuid_count (7, 0, &eax, &ebx, &ecx, &edx)
+        || !(ebx & (1 << 29)))
+        return;
+    sha_ni = true;
+}
+
+bool sha_ni_supported (void)
+{
+    (void)pthread_once (&sha_ni_once, sha_ni_detect);
+    return sha_ni;
+}
+
+static const uint32_t sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5,
+    0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+    0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7,
+    0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3,
+    0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5,
+    0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+__attribute__((target ("sha,sse4.1")))
+void sha256_ni_blocks (uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+    const __m128i mask = _mm_set_epi64x (0x0c0d0e0f08090a0bULL,
+                                         0x0405060700010203ULL);
+    __m128i state0, state1, tmp;
+
+    /* Rearrange state words ABCDEFGH into the ABEF/CDGH lanes used by
+     * sha256rnds2.
+     */
+    tmp = _mm_loadu_si128 ((const __m128i *)&state[0]);
+    state1 = _mm_loadu_si128 ((const __m128i *)&state[4]);
+    tmp = _mm_shuffle_epi32 (tmp, 0xB1);
+    state1 = _mm_shuffle_epi32 (state1, 0x1B);
+    state0 = _mm_alignr_epi8 (tmp, state1, 8);
+    state1 = _mm_blend_epi16 (state1, tmp, 0xF0);
+
+    while (nblocks-- > 0) {
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+        __m128i w[4];
+
+        for (int i = 0; i < 4; i++) {
+            tmp = _mm_loadu_si128 ((const __m128i *)(data + 16 * i));
+            w[i] = _mm_shuffle_epi8 (tmp, mask);
+        }
+        for (int g = 0; g < 16; g++) {
+            __m128i msg;
+
+            if (g >= 4) {
+                msg = _mm_sha256msg1_epu32 (w[g & 3], w[(g - 3) & 3]);
+                msg = _mm_add_epi32 (msg, _mm_alignr_epi8 (w[(g - 1) & 3],
+                                                           w[(g - 2) & 3],
+                                                           4));
+                w[g & 3] = _mm_sha256msg2_epu32 (msg, w[(g - 1) & 3]);
+            }
+            msg = _mm_add_epi32 (w[g & 3],
+                                 _mm_loadu_si128 ((const __m128i *)
+                                                  &sha256_k[4 * g]));
+            state1 = _mm_sha256rnds2_epu32 (state1, state0, msg);
+            msg = _mm_shuffle_epi32 (msg, 0x0E);
+            state0 = _mm_sha256rnds2_epu32 (state0, state1, msg);
+        }
+        state0 = _mm_add_epi32 (state0, abef);
+        state1 = _mm_add_epi32 (state1, cdgh);
+        data += 64;
+    }
+
+    tmp = _mm_shuffle_epi32 (state0, 0x1B);
+    state1 = _mm_shuffle_epi32 (state1, 0xB1);
+    state0 = _mm_blend_epi16 (tmp, state1, 0xF0);
+    state1 = _mm_alignr_epi8 (state1, tmp, 8);
+    _mm_storeu_si128 ((__m128i *)&state[0], state0);
+    _mm_storeu_si128 ((__m128i *)&state[4], state1);
+}
+
+/* sha1rnds4 takes the round function selector as an immediate.
+ */
+#define SHA1_RNDS4(abcd, e, g) \
+    ((g) < 20 ? _mm_sha1rnds4_epu32 ((abcd), (e), 0) \
+     : (g) < 40 ? _mm_sha1rnds4_epu32 ((abcd), (e), 1) \
+     : (g) < 60 ? _mm_sha1rnds4_epu32 ((abcd), (e), 2) \
+     : _mm_sha1rnds4_epu32 ((abcd), (e), 3))
+
+__attribute__((target ("sha,sse4.1")))
+void sha1_ni_blocks (uint32_t state[5], const uint8_t *data, size_t nblocks)
+{
+    const __m128i mask = _mm_set_epi64x (0x0001020304050607ULL,
+                                         0x08090a0b0c0d0e0fULL);
+    __m128i abcd, e0;
+
+    abcd = _mm_loadu_si128 ((const __m128i *)state);
+    abcd = _mm_shuffle_epi32 (abcd, 0x1B);
+    e0 = _mm_set_epi32 (state[4], 0, 0, 0);
+
+    while (nblocks-- > 0) {
+        __m128i abcd_save = abcd;
+        __m128i e_save = e0;
+        __m128i w[4];
+        __m128i e = e0;
+
+        for (int i = 0; i < 4; i++) {
+            __m128i tmp = _mm_loadu_si128 ((const __m128i *)(data + 16 * i));
+            w[i] = _mm_shuffle_epi8 (tmp, mask);
+        }
+        for (int g = 0; g < 20; g++) {
+            __m128i prev;
+
+            if (g >= 4) {
+                __m128i msg = _mm_sha1msg1_epu32 (w[g & 3], w[(g - 3) & 3]);
+                msg = _mm_xor_si128 (msg, w[(g - 2) & 3]);
+                w[g & 3] = _mm_sha1msg2_epu32 (msg, w[(g - 1) & 3]);
+            }
+            if (g == 0)
+                e = _mm_add_epi32 (e, w[0]);
+            else
+                e = _mm_sha1nexte_epu32 (e, w[g & 3]);
+            prev = abcd;
+            abcd = SHA1_RNDS4 (abcd, e, 4 * g);
+            e = prev;
+        }
+        e0 = _mm_sha1nexte_epu32 (e, e_save);
+        abcd = _mm_add_epi32 (abcd, abcd_save);
+        data += 64;
+    }
+
+    abcd = _mm_shuffle_epi32 (abcd, 0x1B);
+    _mm_storeu_si128 ((__m128i *)state, abcd);
+    state[4] = _mm_extract_epi32 (e0, 3);
+}
+
+#else /* !HAVE_SHA_NI */
+
+bool sha_ni_supported (void)
+{
+    return false;
+}
+
+void sha1_ni_blocks (uint32_t state[5], const uint8_t *data, size_t nblocks)
+{
+}
+
+void sha256_ni_blocks (uint32_t state[8], const uint8_t *data, size_t nblocks)
+{
+}
+
+#endif /* !HAVE_SHA_NI */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,35 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _UTIL_SHA_NI_H
+#define _UTIL_SHA_NI_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Return true if the x86 SHA extensions (SHA-NI) are available at runtime.
+ * Always false on other architectures and compilers.
+ */
+bool sha_ni_supported (void);
+
+/* Run the SHA-1 or SHA-256 compression function over 'nblocks' complete
+ * 64 byte blocks of 'data', updating 'state' in place.  Message padding
+ * and length are left to the caller.  Only call these if
+ * sha_ni_supported() returns true.
+ */
+void sha1_ni_blocks (uint32_t state[5], const uint8_t *data, size_t nblocks);
+void sha256_ni_blocks (uint32_t state[8], const uint8_t *data, size_t nblocks);
+
+#endif /* !_UTIL_SHA_NI_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -18,6 +18,8 @@
 #include "src/common/libutil/blobref.h"
 #include "src/common/libutil/sha1.h"
 #include "src/common/libutil/sha256.h"
+#include "src/common/libutil/sha_ni.h"
+#include "src/common/libutil/blake3.h"
 #include "ccan/str/str.h"
 
 const char *badref[] = {
@@ -31,9 +33,61 @@ const char *badref[] = {
 const char *goodref[] = {
     "sha1-4d4ed591f7d26abd8145650f334d283bdb661765",
     "sha256-a99c07ce93703c7390589c5b007bd9a97a8b6de29e9a920d474d4f028ce2d42c",
+    "blake3-af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262",
     NULL,
 };
 
+/* blobref_hash() may use SHA-NI for whole blocks.  Check that it agrees
+ * with the portable implementation at lengths around block boundaries.
+ */
+static void test_accel (void)
+{
+    uint8_t data[4096 + 65];
+    uint8_t digest[BLOBREF_MAX_DIGEST_SIZE];
+    uint8_t expect[BLOBREF_MAX_DIGEST_SIZE];
+    size_t lens[] = { 0, 1, 55, 56, 63, 64, 65, 127, 128, 129, 1000,
+                      4096, sizeof (data) };
+    int sha1_errors = 0;
+    int sha256_errors = 0;
+
+    diag ("SHA-NI is %savailable", sha_ni_supported () ? "" : "not ");
+    for (int i = 0; i < sizeof (data); i++)
+        data[i] = i * 7 + 3;
+    for (int i = 0; i < sizeof (lens) / sizeof (lens[0]); i++) {
+        SHA1_CTX ctx1;
+        SHA256_CTX ctx256;
+
+        sha1_init (&ctx1);
+        sha1_update (&ctx1, data, lens[i]);
+        sha1_final (&ctx1, expect);
+        if (blobref_hash_raw ("sha1",
+                              data,
+                              lens[i],
+                              digest,
+                              sizeof (digest)) != SHA1_BLOCK_SIZE
+            || memcmp (digest, expect, SHA1_BLOCK_SIZE) != 0) {
+            diag ("sha1 mismatch at length %zu", lens[i]);
+            sha1_errors++;
+        }
+        sha256_init (&ctx256);
+        sha256_update (&ctx256, data, lens[i]);
+        sha256_final (&ctx256, expect);
+        if (blobref_hash_raw ("sha256",
+                              data,
+                              lens[i],
+                              digest,
+                              sizeof (digest)) != SHA256_BLOCK_SIZE
+            || memcmp (digest, expect, SHA256_BLOCK_SIZE) != 0) {
+            diag ("sha256 mismatch at length %zu", lens[i]);
+            sha256_errors++;
+        }
+    }
+    ok (sha1_errors == 0,
+        "blobref_hash_raw sha1 agrees with portable sha1");
+    ok (sha256_errors == 0,
+        "blobref_hash_raw sha256 agrees with portable sha256");
+}
+
 int main(int argc, char** argv)
 {
     char ref[BLOBREF_MAX_STRING_SIZE];
@@ -168,6 +222,23 @@ int main(int argc, char** argv)
     ok (streq (ref, ref2),
         "and blobrefs match");
 
+    /* blake3 */
+    ok (blobref_hash ("blake3", NULL, 0, ref, sizeof (ref)) == 0
+        && streq (ref, goodref[2]),
+        "blobref_hash blake3 handles zero length data");
+    diag ("%s", ref);
+    ok (blobref_hash ("blake3", data, sizeof (data), ref, sizeof (ref)) == 0,
+        "blobref_hash blake3 works");
+    diag ("%s", ref);
+    ok (blobref_strtohash (ref, digest, sizeof (digest)) == BLAKE3_OUT_LEN,
+        "blobref_strtohash returns expected size hash");
+    ok (blobref_hashtostr ("blake3", digest, BLAKE3_OUT_LEN, ref2,
+                           sizeof (ref2)) == 0
+        && streq (ref, ref2),
+        "blobref_hashtostr back again works");
+
+    test_accel ();
+
     /* blobref_validate */
     const char **pp;
     pp = &goodref[0];
@@ -189,6 +260,8 @@ int main(int argc, char** argv)
         "blobref_validate_hashtype sha1 is valid");
     ok (blobref_validate_hashtype ("sha256") == SHA256_BLOCK_SIZE,
         "blobref_validate_hashtype sha256 is valid");
+    ok (blobref_validate_hashtype ("blake3") == BLAKE3_OUT_LEN,
+        "blobref_validate_hashtype blake3 is valid");
     ok (blobref_validate_hashtype ("nerf") == -1,
         "blobref_validate_hashtype nerf is invalid");
     ok (blobref_validate_hashtype (NULL) == -1,
@@ -0,0 +1,132 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* hashbench - compare blobref_hash() throughput per hash type and blob size
+ *
+ * Usage: test_hashbench [MB]
+ *
+ * Each hash type hashes about MB megabytes (default 64) of blobs of each
+ * size, and the throughput is printed in MB/s.  "sha1-portable" and
+ * "sha256-portable" call the C implementations directly, for comparison
+ * with blobref_hash(), which uses SHA-NI when available.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "src/common/libutil/blobref.h"
+#include "src/common/libutil/sha1.h"
+#include "src/common/libutil/sha256.h"
+#include "src/common/libutil/sha_ni.h"
+#include "src/common/libutil/monotime.h"
+#include "src/common/libutil/log.h"
+#include "ccan/str/str.h"
+
+static const size_t sizes[] = { 64, 256, 1024, 4096, 65536, 1048576 };
+
+static void portable_sha1 (const void *data, size_t len, uint8_t *hash)
+{
+    SHA1_CTX ctx;
+
+    sha1_init (&ctx);
+    sha1_update (&ctx, data, len);
+    sha1_final (&ctx, hash);
+}
+
+static void portable_sha256 (const void *data, size_t len, uint8_t *hash)
+{
+    SHA256_CTX ctx;
+
+    sha256_init (&ctx);
+    sha256_update (&ctx, data, len);
+    sha256_final (&ctx, hash);
+}
+
+/* Hash 'total' bytes in blobs of 'size' and return MB/s.
+ * If 'name' ends in "-portable", call the portable code directly.
+ */
+static double bench (const char *name,
+                     const uint8_t *data,
+                     size_t size,
+                     size_t total)
+{
+    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+    size_t count = total / size;
+    struct timespec t0;
+    double ms;
+
+    if (count == 0)
+        count = 1;
+    monotime (&t0);
+    for (size_t i = 0; i < count; i++) {
+        if (streq (name, "sha1-portable"))
+            portable_sha1 (data, size, hash);
+        else if (streq (name, "sha256-portable"))
+            portable_sha256 (data, size, hash);
+        else if (blobref_hash_raw (name,
+                                   data,
+                                   size,
+                                   hash,
+                                   sizeof (hash)) < 0)
+            log_err_exit ("blobref_hash_raw %s", name);
+    }
+    ms = monotime_since (t0);
+    return (double)(count * size) / (1024 * 1024) / (ms / 1000);
+}
+
+int main (int argc, char *argv[])
+{
+    const char *names[] = {
+        "sha1-portable",
+        "sha1",
+        "sha256-portable",
+        "sha256",
+        "blake3",
+    };
+    size_t total = 64;
+    size_t maxsize = sizes[sizeof (sizes) / sizeof (sizes[0]) - 1];
+    uint8_t *data;
+
+    log_init ("hashbench");
+
+    if (argc > 2)
+        log_msg_exit ("Usage: test_hashbench [MB]");
+    if (argc == 2 && (total = strtoul (argv[1], NULL, 10)) == 0)
+        log_msg_exit ("MB must be a positive integer");
+    total *= 1024 * 1024;
+
+    if (!(data = malloc (maxsize)))
+        log_msg_exit ("out of memory");
+    for (size_t i = 0; i < maxsize; i++)
+        data[i] = rand ();
+
+    printf ("SHA-NI: %s\n", sha_ni_supported () ? "yes" : "no");
+    printf ("%-16s", "MB/s");
+    for (int j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+        printf ("%10zu", sizes[j]);
+    printf ("\n");
+    for (int i = 0; i < sizeof (names) / sizeof (names[0]); i++) {
+        printf ("%-16s", names[i]);
+        for (int j = 0; j < sizeof (sizes) / sizeof (sizes[0]); j++)
+            printf ("%10.0f", bench (names[i], data, sizes[j], total));
+        printf ("\n");
+    }
+    free (data);
+    return 0;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -28,6 +28,11 @@
 
 #define ZEROCOPY_THRESHOLD (64 * 1024)
 
+struct zmqutil_msg_frames {
+    zmq_msg_t *frames;
+    int count;
+};
+
 static void zerocopy_free (void *data, void *hint)
 {
     flux_msg_decref (hint);
@@ -110,6 +115,108 @@ int zmqutil_msg_send (void *sock, const flux_msg_t *msg)
     return zmqutil_msg_send_ex (sock, msg, false);
 }
 
+/* Initialize zmsg with the contents of iov.  Large frames reference
+ * iov->data directly, holding a reference on msg (see zerocopy_send()).
+ */
+static int frame_init (zmq_msg_t *zmsg,
+                       struct msg_iovec *iov,
+                       const flux_msg_t *msg)
+{
+    if (iov->size >= ZEROCOPY_THRESHOLD) {
+        flux_msg_incref (msg);
+        if (zmq_msg_init_data (zmsg,
+                               (void *)iov->data,
+                               iov->size,
+                               zerocopy_free,
+                               (void *)msg) < 0) {
+            flux_msg_decref (msg);
+            return -1;
+        }
+    }
+    else {
+        if (zmq_msg_init_size (zmsg, iov->size) < 0)
+            return -1;
+        if (iov->size > 0)
+            memcpy (zmq_msg_data (zmsg), iov->data, iov->size);
+    }
+    return 0;
+}
+
+void zmqutil_msg_frames_destroy (struct zmqutil_msg_frames *mf)
+{
+    if (mf) {
+        int saved_errno = errno;
+        for (int i = 0; i < mf->count; i++)
+            zmq_msg_close (&mf->frames[i]);
+        free (mf->frames);
+        free (mf);
+        errno = saved_errno;
+    }
+}
+
+struct zmqutil_msg_frames *zmqutil_msg_frames_create (const flux_msg_t *msg)
+{
+    struct zmqutil_msg_frames *mf;
+    struct msg_iovec *iov = NULL;
+    int iovcnt;
+    uint8_t proto[PROTO_SIZE];
+
+    if (!msg) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(mf = calloc (1, sizeof (*mf))))
+        return NULL;
+    if (msg_to_iovec (msg, proto, PROTO_SIZE, &iov, &iovcnt) < 0)
+        goto error;
+    if (!(mf->frames = calloc (iovcnt, sizeof (mf->frames[0]))))
+        goto error;
+    while (mf->count < iovcnt) {
+        if (frame_init (&mf->frames[mf->count], &iov[mf->count], msg) < 0)
+            goto error;
+        mf->count++;
+    }
+    free (iov);
+    return mf;
+error:
+    ERRNO_SAFE_WRAP (free, iov);
+    zmqutil_msg_frames_destroy (mf);
+    return NULL;
+}
+
+int zmqutil_msg_frames_send (void *sock,
+                             struct zmqutil_msg_frames *mf,
+                             const char *id,
+                             bool nonblock)
+{
+    int flags = ZMQ_SNDMORE;
+
+    if (!sock || !mf || !id) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (nonblock)
+        flags |= ZMQ_DONTWAIT;
+    if (zmq_send (sock, id, strlen (id), flags) < 0)
+        return -1;
+    for (int i = 0; i < mf->count; i++) {
+        zmq_msg_t zmsg;
+
+        if ((i + 1) == mf->count)
+            flags &= ~ZMQ_SNDMORE;
+        /* zmq_msg_copy() shares the frame's buffer (refcounted by zeromq)
+         * rather than copying it, except for very small frames.
+         */
+        zmq_msg_init (&zmsg);
+        if (zmq_msg_copy (&zmsg, &mf->frames[i]) < 0
+            || zmq_msg_send (&zmsg, sock, flags) < 0) {
+            ERRNO_SAFE_WRAP (zmq_msg_close, &zmsg);
+            return -1;
+        }
+    }
+    return 0;
+}
+
 flux_msg_t *zmqutil_msg_recv (void *sock)
 {
     struct msg_iovec *iov = NULL;
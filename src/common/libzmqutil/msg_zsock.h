@@ -31,6 +31,19 @@ int zmqutil_msg_send_ex (void *dest, const flux_msg_t *msg, bool nonblock);
  */
 flux_msg_t *zmqutil_msg_recv (void *dest);
 
+/* Encode message once for sending to many peers of a ROUTER socket.
+ * zmqutil_msg_frames_send() sends the encoded frames to the peer
+ * identified by 'id' as if 'id' had been pushed onto the message route
+ * stack.  The frames are shared by zeromq, not copied, for each send.
+ * Returns 0 on success, -1 on failure with errno set.
+ */
+struct zmqutil_msg_frames *zmqutil_msg_frames_create (const flux_msg_t *msg);
+void zmqutil_msg_frames_destroy (struct zmqutil_msg_frames *mf);
+int zmqutil_msg_frames_send (void *dest,
+                             struct zmqutil_msg_frames *mf,
+                             const char *id,
+                             bool nonblock);
+
 #ifdef __cplusplus
 }
 #endif
@@ -149,6 +149,73 @@ void check_sendzsock_large (void)
     zmq_close (zsock[1]);
 }
 
+void check_frames (void)
+{
+    void *zsock[2] = { NULL, NULL };
+    struct zmqutil_msg_frames *mf;
+    flux_msg_t *msg, *msg2;
+    const char *topic;
+    const char *s;
+    const char *uri = "inproc://test_frames";
+
+    ok ((zsock[0] = zmq_socket (zctx, ZMQ_PAIR)) != NULL
+        && zmq_bind (zsock[0], uri) == 0
+        && (zsock[1] = zmq_socket (zctx, ZMQ_PAIR)) != NULL
+        && zmq_connect (zsock[1], uri) == 0,
+        "frames: got inproc socket pair");
+
+    if (zsetsockopt_int (zsock[0], ZMQ_LINGER, 5) < 0
+        || zsetsockopt_int (zsock[1], ZMQ_LINGER, 5) < 0)
+        BAIL_OUT ("could not set ZMQ_LINGER socket option");
+
+    if (!(msg = flux_msg_create (FLUX_MSGTYPE_EVENT))
+        || flux_msg_set_topic (msg, "foo.bar") < 0
+        || flux_msg_set_string (msg, "baz") < 0)
+        BAIL_OUT ("could not create test message");
+    flux_msg_route_enable (msg);
+
+    errno = 0;
+    ok (zmqutil_msg_frames_create (NULL) == NULL && errno == EINVAL,
+        "zmqutil_msg_frames_create msg=NULL fails with EINVAL");
+    ok ((mf = zmqutil_msg_frames_create (msg)) != NULL,
+        "zmqutil_msg_frames_create works");
+    flux_msg_destroy (msg);
+
+    errno = 0;
+    ok (zmqutil_msg_frames_send (NULL, mf, "x", false) < 0 && errno == EINVAL,
+        "zmqutil_msg_frames_send dest=NULL fails with EINVAL");
+    errno = 0;
+    ok (zmqutil_msg_frames_send (zsock[1], NULL, "x", false) < 0
+        && errno == EINVAL,
+        "zmqutil_msg_frames_send mf=NULL fails with EINVAL");
+    errno = 0;
+    ok (zmqutil_msg_frames_send (zsock[1], mf, NULL, false) < 0
+        && errno == EINVAL,
+        "zmqutil_msg_frames_send id=NULL fails with EINVAL");
+
+    for (int i = 0; i < 2; i++) {
+        const char *id = i == 0 ? "peer1" : "peer2";
+        ok (zmqutil_msg_frames_send (zsock[1], mf, id, false) == 0,
+            "frames: zmqutil_msg_frames_send %s works", id);
+        ok ((msg2 = zmqutil_msg_recv (zsock[0])) != NULL,
+            "frames: zmqutil_msg_recv works");
+        ok (flux_msg_route_count (msg2) == 1
+            && (s = flux_msg_route_first (msg2)) != NULL
+            && streq (s, id),
+            "frames: received message has route %s", id);
+        ok (flux_msg_get_topic (msg2, &topic) == 0
+            && streq (topic, "foo.bar")
+            && flux_msg_get_string (msg2, &s) == 0
+            && streq (s, "baz"),
+            "frames: received message has expected topic and payload");
+        flux_msg_destroy (msg2);
+    }
+    zmqutil_msg_frames_destroy (mf);
+
+    zmq_close (zsock[0]);
+    zmq_close (zsock[1]);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -158,6 +225,7 @@ int main (int argc, char *argv[])
 
     check_sendzsock ();
     check_sendzsock_large ();
+    check_frames ();
 
     zmq_ctx_term (zctx);
 
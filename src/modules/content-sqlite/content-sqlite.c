@@ -17,8 +17,16 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <sys/statvfs.h>
+#include <sys/eventfd.h>
+#include <arpa/inet.h>
+#include <pthread.h>
+#include <time.h>
 #include <sqlite3.h>
 #include <lz4.h>
+#if HAVE_ZSTD
+#include <zstd.h>
+#include <zdict.h>
+#endif
 #include <flux/core.h>
 #include <jansson.h>
 #include <assert.h>
@@ -33,20 +41,26 @@
 
 #include "src/common/libcontent/content-util.h"
 #include "ccan/str/str.h"
+#include "ccan/list/list.h"
+#include "ccan/array_size/array_size.h"
 
 const size_t lzo_buf_chunksize = 1024*1024;
 const size_t compression_threshold = 256; /* compress blobs >= this size */
+/* with a dictionary, small blobs compress too */
+const size_t dict_compression_threshold = 32;
+const int zstd_level = 3;
 
 const char *sql_create_table = "CREATE TABLE if not exists objects("
                                "  hash BLOB PRIMARY KEY,"
                                "  size INT,"
                                "  object BLOB,"
-                               "  epoch INT DEFAULT 0"
+                               "  epoch INT DEFAULT 0,"
+                               "  codec INT DEFAULT 0"
                                ");";
-const char *sql_load = "SELECT object,size FROM objects"
+const char *sql_load = "SELECT object,size,codec FROM objects"
                        "  WHERE hash = ?1 LIMIT 1";
-const char *sql_store = "INSERT INTO objects (hash,size,object,epoch) "
-                        "  values (?1, ?2, ?3, ?4) "
+const char *sql_store = "INSERT INTO objects (hash,size,object,epoch,codec) "
+                        "  values (?1, ?2, ?3, ?4, ?5) "
                         "ON CONFLICT(hash) DO UPDATE SET epoch = excluded.epoch";
 const char *sql_validate = "SELECT EXISTS("
                            "  SELECT 1 FROM objects WHERE hash = ?1)";
@@ -77,6 +91,7 @@ const char *sql_table_list = "SELECT tbl_name FROM sqlite_master where type = 't
 const char *sql_checkpt_get_all = "SELECT * FROM checkpt_v2 ORDER BY id DESC";
 
 const char *sql_alter_objects_add_epoch = "ALTER TABLE objects ADD COLUMN epoch INT DEFAULT 0";
+const char *sql_alter_objects_add_codec = "ALTER TABLE objects ADD COLUMN codec INT DEFAULT 0";
 const char *sql_get_max_checkpt_id = "SELECT MAX(id) FROM checkpt_v2";
 const char *sql_table_info = "PRAGMA table_info(objects)";
 const char *sql_mark_blob = "UPDATE objects SET epoch = MAX(epoch, ?1) WHERE hash = ?2";
@@ -90,22 +105,42 @@ const char *sql_sweep_delete = "DELETE FROM objects WHERE rowid = ?1";
 const char *sql_max_rowid = "SELECT MAX(rowid) FROM objects";
 const char *sql_count_sweep_candidates = "SELECT COUNT(*) FROM objects WHERE epoch < ?1";
 
+const char *sql_create_table_dicts = "CREATE TABLE if not exists dicts("
+                                     "  seq INTEGER PRIMARY KEY AUTOINCREMENT,"
+                                     "  id INT UNIQUE,"
+                                     "  dict BLOB"
+                                     ");";
+const char *sql_dict_get = "SELECT dict FROM dicts WHERE id = ?1";
+const char *sql_dict_get_latest = "SELECT id,dict FROM dicts"
+                                  "  ORDER BY seq DESC LIMIT 1";
+const char *sql_dict_put = "INSERT INTO dicts (id,dict) values (?1, ?2)";
+const char *sql_dict_samples = "SELECT object,size,codec FROM objects"
+                               "  ORDER BY rowid DESC LIMIT ?1";
+
 #define MAX_CHECKPOINTS_DEFAULT 5
 
 /* Upper bound on the number of hashes accepted by a single mark RPC.
- * The mark handler runs synchronously on content-sqlite's single reactor
- * thread, so an unbounded array would block all other backing traffic while
- * it is processed.  flux-gc batches marks in chunks of 100; this cap is well
- * above that but still bounds the per-RPC work.  Like the sweep ceilings below,
- * it targets a worst-case stall of roughly 100ms: a mark is an indexed UPDATE
- * (~1us warm by the same rough microbenchmark), so 16384 ~= 16ms, comfortably
- * under budget.  Treat this as an order-of-magnitude bound, not a guarantee.
+ * The mark handler runs on content-sqlite's single writer thread, so an
+ * unbounded array would block all other writes (and loads, without WAL
+ * readers) while it is processed.  flux-gc batches marks in chunks of 100;
+ * this cap is well above that but still bounds the per-RPC work.  Like the
+ * sweep ceilings below, it targets a worst-case stall of roughly 100ms: a mark
+ * is an indexed UPDATE (~1us warm by the same rough microbenchmark), so
+ * 16384 ~= 16ms, comfortably under budget.  Treat this as an
+ * order-of-magnitude bound, not a guarantee.
  */
 #define MARK_HASHES_MAX 16384
 
-/* Per-call ceilings on the two sweep bounds.  The sweep runs synchronously on
- * the reactor thread, so both the DELETE work and the SELECT scan must be
- * bounded to cap the stall.  'delete_cap' limits rows deleted (the dominant
+/* Upper bound on the number of blobs accepted by a single batch-store RPC.
+ * The content cache sends at most its flush batch limit (256 by default) per
+ * request; this bounds the writer thread's work for a larger configured
+ * limit.
+ */
+#define BATCH_STORE_MAX 4096
+
+/* Per-call ceilings on the two sweep bounds.  The sweep runs on the writer
+ * thread, so both the DELETE work and the SELECT scan must be bounded to cap
+ * the stall of other writes.  'delete_cap' limits rows deleted (the dominant
  * cost); 'window' limits rows scanned (so a sparse span still makes progress).
  * Requests above these are CLAMPED, not rejected: flux-gc terminates its sweep
  * loop on the rowid cursor reaching the high-water mark, not on batch size, so
@@ -121,18 +156,162 @@ const char *sql_count_sweep_candidates = "SELECT COUNT(*) FROM objects WHERE epo
 #define SWEEP_DELETE_MAX 8192
 #define SWEEP_WINDOW_MAX (1<<19)   /* 512K rows scanned per call */
 
+/* Requests are executed off the reactor by database threads.  One writer
+ * thread owns the read-write connection and runs every request that
+ * modifies the database or depends on the order of modifications.  In WAL
+ * mode, 'readers' threads each own a read-only connection and run loads and
+ * validates, so a KVS cache miss is not queued behind a large store batch or
+ * a GC sweep.  Without WAL, a reader would block on the writer's lock, so
+ * all requests run on the writer thread.
+ *
+ * A thread builds the response message itself, including compression and
+ * decompression, and hands it back to the reactor to be sent.  Flux handles
+ * are not thread safe, so log messages generated on a database thread are
+ * also handed back and logged from the reactor.
+ */
+#define READERS_DEFAULT 2
+#define READERS_MAX 64
+
+/* Values of the objects.codec column.  These are stored on disk, so
+ * existing values must not change.  A blob stored uncompressed has
+ * size = -1, regardless of codec.
+ */
+enum {
+    CODEC_LZ4 = 0,
+    CODEC_ZSTD = 1,
+    CODEC_NONE = 2,         // configuration only: store blobs uncompressed
+};
+#define CODEC_COUNT 2       // codecs that may appear in the codec column
+
+static const char *codec_names[] = { "lz4", "zstd", "none" };
+
+/* zstd dictionary training.  A dictionary is trained from a sample of
+ * recently stored blobs, either on request (content-sqlite.dict-train), or
+ * automatically with the zstd codec once DICT_AUTOTRAIN_STORES blobs have
+ * been stored without one.  The frame header of a zstd blob records the ID
+ * of its dictionary, and every dictionary is kept in the dicts table, so
+ * retraining does not affect blobs already stored.
+ *
+ * Training is CPU bound and roughly linear in the sample size.  A request
+ * runs entirely on the writer thread, so stores wait for it; at the maximum
+ * sample size this can take seconds.  Automatic training samples at most
+ * DICT_AUTOTRAIN_BYTES and runs on a reader thread when there is one, so
+ * the writer only stalls to insert the finished dictionary.  Without
+ * readers, e.g. with a journal_mode other than WAL, it runs on the writer,
+ * where the byte cap bounds the stall to well under a second.
+ */
+#define DICT_SIZE_DEFAULT (112*1024)
+#define DICT_SIZE_MIN 1024
+#define DICT_SIZE_MAX (1024*1024)
+#define DICT_SAMPLES_DEFAULT 10000
+#define DICT_SAMPLES_MAX 100000
+#define DICT_SAMPLE_SIZE_MAX (16*1024)
+#define DICT_AUTOTRAIN_STORES 10000
+#define DICT_AUTOTRAIN_BYTES (4*1024*1024)
+
+struct codec_stats {
+    int64_t count;              // blobs compressed
+    int64_t bytes_in;           // size before compression
+    int64_t bytes_out;          // size stored
+    tstat_t compress_cpu;       // thread CPU time per blob (ms)
+    tstat_t decompress_cpu;
+};
+
 struct content_stats {
     tstat_t load;
     tstat_t store;
+    tstat_t batch_store;
+    struct codec_stats codec[CODEC_COUNT];
 };
 
-struct content_sqlite {
-    flux_msg_handler_t **handlers;
-    char *dbfile;
+struct dict_info {
+    unsigned int id;
+    size_t size;
+    int samples;
+};
+
+#if HAVE_ZSTD
+struct ddict {
+    unsigned int id;
+    ZSTD_DDict *ddict;
+};
+#endif
+
+struct dbconn;
+
+typedef void (*dbop_f)(struct dbconn *conn, const flux_msg_t *msg);
+
+enum {
+    DBOP_READONLY = 1,      // may run on a read-only connection
+};
+
+struct dbop {
+    const char *topic;
+    dbop_f fn;
+    int flags;
+    uint32_t rolemask;
+};
+
+struct dbop_handler {
+    struct content_sqlite *ctx;
+    const struct dbop *op;
+    flux_msg_handler_t *mh;
+};
+
+struct dblog {
+    struct list_node list;
+    int level;
+    char text[];
+};
+
+struct dbjob {
+    struct list_node list;
+    dbop_f fn;
+    flux_msg_t *msg;
+    flux_msg_t *response;
+    struct list_head logs;      // list of 'struct dblog'
+    void *data;                 // private to internal jobs, freed with job
+    size_t size;
+};
+
+struct dbqueue {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    struct list_head jobs;
+    bool shutdown;
+};
+
+struct dbconn {
+    struct content_sqlite *ctx;
     sqlite3 *db;
     sqlite3_stmt *load_stmt;
-    sqlite3_stmt *store_stmt;
     sqlite3_stmt *validate_stmt;
+    size_t lzo_bufsize;
+    void *lzo_buf;
+#if HAVE_ZSTD
+    ZSTD_CCtx *cctx;
+    ZSTD_DCtx *dctx;
+#endif
+    struct dbqueue *queue;
+    struct dbjob *job;          // job in progress, NULL on the reactor thread
+    pthread_t thread;
+    bool started;
+};
+
+struct content_sqlite {
+    struct dbop_handler *handlers;
+    int handler_count;
+    char *dbfile;
+    struct dbconn writer;
+    struct dbconn *readers;
+    int reader_count;
+    struct dbqueue writeq;
+    struct dbqueue readq;
+    struct list_head done;      // completed jobs, protected by done_lock
+    pthread_mutex_t done_lock;
+    int done_fd;                // eventfd signaled when 'done' becomes busy
+    flux_watcher_t *done_w;
+    sqlite3_stmt *store_stmt;
     sqlite3_stmt *checkpt_get_stmt;
     sqlite3_stmt *checkpt_put_stmt;
     sqlite3_stmt *checkpt_prune_stmt;
@@ -140,14 +319,22 @@ struct content_sqlite {
     flux_t *h;
     char *hashfun;
     int hash_size;
-    size_t lzo_bufsize;
-    void *lzo_buf;
     struct content_stats stats;
+    pthread_mutex_t stats_lock;
     char *journal_mode;
     char *synchronous;
     int max_checkpoints;
     bool truncate;
-    int64_t current_epoch;
+    int64_t current_epoch;      // accessed by writer thread once started
+    int codec;                  // codec for new blobs
+    unsigned int dict_id;       // current dictionary, 0 if none (writer)
+    int autotrain_count;        // blobs stored without dictionary (writer)
+#if HAVE_ZSTD
+    ZSTD_CDict *cdict;          // current dictionary (writer)
+    struct ddict *ddicts;       // all loaded dictionaries, under dict_lock
+    int ddict_count;
+    pthread_mutex_t dict_lock;
+#endif
 };
 
 static int set_config (char **conf, const char *val)
@@ -165,24 +352,72 @@ static int set_config (char **conf, const char *val)
  * log_sqlite_error() formats the same text with a code-site prefix for the
  * broker log.
  */
-static const char *set_text_from_sqlite_error (struct content_sqlite *ctx,
+static const char *set_text_from_sqlite_error (struct dbconn *conn,
                                                flux_error_t *errp)
 {
     if (!errp)
         return NULL;
-    if (ctx->db) {
-        const char *errmsg = sqlite3_errmsg (ctx->db);
+    if (conn->db) {
+        const char *errmsg = sqlite3_errmsg (conn->db);
         errprintf (errp,
                    "%s(%d)",
                    errmsg ? errmsg : "unknown error code",
-                   sqlite3_extended_errcode (ctx->db));
+                   sqlite3_extended_errcode (conn->db));
     }
     else
         errprintf (errp, "unknown error, no sqlite3 handle");
     return errp->text;
 }
 
-static void log_sqlite_error (struct content_sqlite *ctx, const char *fmt, ...)
+/* Log from a database thread or the reactor.  On a database thread, the
+ * message is attached to the job in progress and logged by the reactor
+ * when the job completes.
+ */
+static void conn_vlog (struct dbconn *conn,
+                       int level,
+                       const char *fmt,
+                       va_list ap)
+{
+    struct dblog *log;
+    char buf[1024];
+    int saved_errno = errno;
+
+    if (!conn->job) {
+        flux_vlog (conn->ctx->h, level, fmt, ap);
+        goto out;
+    }
+    (void)vsnprintf (buf, sizeof (buf), fmt, ap);
+    if (!(log = malloc (sizeof (*log) + strlen (buf) + 1)))
+        goto out;
+    log->level = level;
+    strcpy (log->text, buf);
+    list_add_tail (&conn->job->logs, &log->list);
+out:
+    errno = saved_errno;
+}
+
+static void conn_log (struct dbconn *conn, int level, const char *fmt, ...)
+{
+    va_list ap;
+
+    va_start (ap, fmt);
+    conn_vlog (conn, level, fmt, ap);
+    va_end (ap);
+}
+
+static void conn_log_error (struct dbconn *conn, const char *fmt, ...)
+{
+    char buf[256];
+    va_list ap;
+
+    va_start (ap, fmt);
+    (void)vsnprintf (buf, sizeof (buf), fmt, ap);
+    va_end (ap);
+
+    conn_log (conn, LOG_ERR, "%s: %s", buf, strerror (errno));
+}
+
+static void log_sqlite_error (struct dbconn *conn, const char *fmt, ...)
 {
     char buf[64];
     flux_error_t error;
@@ -192,16 +427,16 @@ static void log_sqlite_error (struct content_sqlite *ctx, const char *fmt, ...)
     (void)vsnprintf (buf, sizeof (buf), fmt, ap);
     va_end (ap);
 
-    flux_log (ctx->h,
+    conn_log (conn,
               LOG_ERR,
               "%s: %s",
               buf,
-              set_text_from_sqlite_error (ctx, &error));
+              set_text_from_sqlite_error (conn, &error));
 }
 
-static void set_errno_from_sqlite_error (struct content_sqlite *ctx)
+static void set_errno_from_sqlite_error (struct dbconn *conn)
 {
-    switch (sqlite3_errcode (ctx->db)) {
+    switch (sqlite3_errcode (conn->db)) {
         case SQLITE_IOERR:      /* os io error */
             errno = EIO;
             break;
@@ -225,90 +460,559 @@ static void set_errno_from_sqlite_error (struct content_sqlite *ctx)
     }
 }
 
-static int grow_lzo_buf (struct content_sqlite *ctx, size_t size)
+/* Build the response to 'msg' on a database thread.  The reactor sends it
+ * when the job completes.  These mirror flux_respond_raw(),
+ * flux_respond_pack(), and flux_respond_error().
+ */
+static void conn_set_response (struct dbconn *conn, flux_msg_t *response)
+{
+    flux_msg_destroy (conn->job->response);
+    conn->job->response = response;
+}
+
+static int conn_respond_raw (struct dbconn *conn,
+                             const flux_msg_t *msg,
+                             const void *data,
+                             int len)
+{
+    flux_msg_t *response;
+
+    if (flux_msg_is_noresponse (msg))
+        return 0;
+    if (!(response = flux_response_derive (msg, 0))
+        || (data && flux_msg_set_payload (response, data, len) < 0)) {
+        flux_msg_destroy (response);
+        return -1;
+    }
+    conn_set_response (conn, response);
+    return 0;
+}
+
+static int conn_respond_pack (struct dbconn *conn,
+                              const flux_msg_t *msg,
+                              const char *fmt,
+                              ...)
+{
+    flux_msg_t *response;
+    va_list ap;
+    int rc;
+
+    if (flux_msg_is_noresponse (msg))
+        return 0;
+    if (!(response = flux_response_derive (msg, 0)))
+        return -1;
+    va_start (ap, fmt);
+    rc = flux_msg_vpack (response, fmt, ap);
+    va_end (ap);
+    if (rc < 0) {
+        flux_msg_destroy (response);
+        return -1;
+    }
+    conn_set_response (conn, response);
+    return 0;
+}
+
+static int conn_respond_error (struct dbconn *conn,
+                               const flux_msg_t *msg,
+                               int errnum,
+                               const char *errstr)
+{
+    flux_msg_t *response;
+
+    if (errnum == 0)
+        errnum = EINVAL;
+    if (flux_msg_is_noresponse (msg))
+        return 0;
+    if (!(response = flux_response_derive (msg, errnum))
+        || (errstr && flux_msg_set_string (response, errstr) < 0)) {
+        flux_msg_destroy (response);
+        return -1;
+    }
+    conn_set_response (conn, response);
+    return 0;
+}
+
+static void stats_push (struct content_sqlite *ctx, tstat_t *ts, double t)
+{
+    pthread_mutex_lock (&ctx->stats_lock);
+    tstat_push (ts, t);
+    pthread_mutex_unlock (&ctx->stats_lock);
+}
+
+/* Create a job to run 'fn' on a database thread.  'msg' may be NULL for
+ * internal work that has no requester.
+ */
+static struct dbjob *dbjob_create (dbop_f fn, const flux_msg_t *msg)
+{
+    struct dbjob *job;
+
+    if (!(job = calloc (1, sizeof (*job))))
+        return NULL;
+    job->fn = fn;
+    list_head_init (&job->logs);
+    /* The copy shares the payload but is otherwise private to the job, so
+     * the database thread never touches a message the reactor may access.
+     */
+    if (msg && !(job->msg = flux_msg_copy (msg, true))) {
+        ERRNO_SAFE_WRAP (free, job);
+        return NULL;
+    }
+    return job;
+}
+
+static void dbjob_destroy (struct dbjob *job)
+{
+    if (job) {
+        int saved_errno = errno;
+        struct dblog *log;
+        while ((log = list_pop (&job->logs, struct dblog, list)))
+            free (log);
+        flux_msg_destroy (job->msg);
+        flux_msg_destroy (job->response);
+        free (job->data);
+        free (job);
+        errno = saved_errno;
+    }
+}
+
+static void dbqueue_init (struct dbqueue *q)
+{
+    pthread_mutex_init (&q->lock, NULL);
+    pthread_cond_init (&q->cond, NULL);
+    list_head_init (&q->jobs);
+}
+
+static void dbqueue_clean (struct dbqueue *q)
 {
-    size_t newsize = ctx->lzo_bufsize;
+    struct dbjob *job;
+
+    while ((job = list_pop (&q->jobs, struct dbjob, list)))
+        dbjob_destroy (job);
+    pthread_cond_destroy (&q->cond);
+    pthread_mutex_destroy (&q->lock);
+}
+
+static void dbqueue_push (struct dbqueue *q, struct dbjob *job)
+{
+    pthread_mutex_lock (&q->lock);
+    list_add_tail (&q->jobs, &job->list);
+    pthread_cond_signal (&q->cond);
+    pthread_mutex_unlock (&q->lock);
+}
+
+/* Block until a job is available and return it.  After shutdown, the
+ * remaining jobs are returned, then NULL.
+ */
+static struct dbjob *dbqueue_pop (struct dbqueue *q)
+{
+    struct dbjob *job;
+
+    pthread_mutex_lock (&q->lock);
+    while (!(job = list_pop (&q->jobs, struct dbjob, list)) && !q->shutdown)
+        pthread_cond_wait (&q->cond, &q->lock);
+    pthread_mutex_unlock (&q->lock);
+    return job;
+}
+
+static void dbqueue_shutdown (struct dbqueue *q)
+{
+    pthread_mutex_lock (&q->lock);
+    q->shutdown = true;
+    pthread_cond_broadcast (&q->cond);
+    pthread_mutex_unlock (&q->lock);
+}
+
+static int grow_lzo_buf (struct dbconn *conn, size_t size)
+{
+    size_t newsize = conn->lzo_bufsize;
     void *newbuf;
     while (newsize < size)
         newsize += lzo_buf_chunksize;
-    if (!(newbuf = realloc (ctx->lzo_buf, newsize))) {
+    if (!(newbuf = realloc (conn->lzo_buf, newsize))) {
         errno = ENOMEM;
         return -1;
     }
-    ctx->lzo_bufsize = newsize;
-    ctx->lzo_buf = newbuf;
+    conn->lzo_bufsize = newsize;
+    conn->lzo_buf = newbuf;
     return 0;
 }
 
-/* Load blob from objects table, uncompressing if necessary.
+/* Return the calling thread's CPU time in milliseconds.
+ */
+static double thread_cputime (void)
+{
+    struct timespec ts;
+
+    if (clock_gettime (CLOCK_THREAD_CPUTIME_ID, &ts) < 0)
+        return 0.;
+    return ts.tv_sec * 1E3 + ts.tv_nsec * 1E-6;
+}
+
+static void codec_stats_compress (struct content_sqlite *ctx,
+                                  int codec,
+                                  int size_in,
+                                  int size_out,
+                                  double cpu)
+{
+    struct codec_stats *cs = &ctx->stats.codec[codec];
+
+    pthread_mutex_lock (&ctx->stats_lock);
+    cs->count++;
+    cs->bytes_in += size_in;
+    cs->bytes_out += size_out;
+    tstat_push (&cs->compress_cpu, cpu);
+    pthread_mutex_unlock (&ctx->stats_lock);
+}
+
+static void codec_stats_decompress (struct content_sqlite *ctx,
+                                    int codec,
+                                    double cpu)
+{
+    pthread_mutex_lock (&ctx->stats_lock);
+    tstat_push (&ctx->stats.codec[codec].decompress_cpu, cpu);
+    pthread_mutex_unlock (&ctx->stats_lock);
+}
+
+#if HAVE_ZSTD
+/* Decompression dictionaries are shared by all connections and are not
+ * freed until the module is unloaded, so a dictionary returned by
+ * ddict_find() may be used after dict_lock is released.
+ */
+static ZSTD_DDict *ddict_find (struct content_sqlite *ctx, unsigned int id)
+{
+    for (int i = 0; i < ctx->ddict_count; i++) {
+        if (ctx->ddicts[i].id == id)
+            return ctx->ddicts[i].ddict;
+    }
+    return NULL;
+}
+
+static ZSTD_DDict *ddict_add (struct content_sqlite *ctx,
+                              unsigned int id,
+                              const void *buf,
+                              size_t size)
+{
+    ZSTD_DDict *ddict;
+    struct ddict *ddicts;
+
+    pthread_mutex_lock (&ctx->dict_lock);
+    if ((ddict = ddict_find (ctx, id)))
+        goto done;
+    if (!(ddicts = realloc (ctx->ddicts,
+                            (ctx->ddict_count + 1) * sizeof (ddicts[0]))))
+        goto nomem;
+    ctx->ddicts = ddicts;
+    if (!(ddict = ZSTD_createDDict (buf, size)))
+        goto nomem;
+    ddicts[ctx->ddict_count].id = id;
+    ddicts[ctx->ddict_count].ddict = ddict;
+    ctx->ddict_count++;
+done:
+    pthread_mutex_unlock (&ctx->dict_lock);
+    return ddict;
+nomem:
+    pthread_mutex_unlock (&ctx->dict_lock);
+    errno = ENOMEM;
+    return NULL;
+}
+
+/* Find decompression dictionary 'id', reading it from the dicts table
+ * on this connection if it has not been loaded yet.
+ */
+static ZSTD_DDict *dict_lookup (struct dbconn *conn, unsigned int id)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    sqlite3_stmt *stmt = NULL;
+    ZSTD_DDict *ddict;
+
+    pthread_mutex_lock (&ctx->dict_lock);
+    ddict = ddict_find (ctx, id);
+    pthread_mutex_unlock (&ctx->dict_lock);
+    if (ddict)
+        return ddict;
+    if (sqlite3_prepare_v2 (conn->db,
+                            sql_dict_get,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK
+        || sqlite3_bind_int64 (stmt, 1, id) != SQLITE_OK) {
+        log_sqlite_error (conn, "load: preparing dict_get query");
+        set_errno_from_sqlite_error (conn);
+        goto done;
+    }
+    if (sqlite3_step (stmt) != SQLITE_ROW) {
+        conn_log (conn, LOG_ERR, "load: dictionary %u not found", id);
+        errno = EINVAL;
+        goto done;
+    }
+    ddict = ddict_add (ctx,
+                       id,
+                       sqlite3_column_blob (stmt, 0),
+                       sqlite3_column_bytes (stmt, 0));
+done:
+    ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    return ddict;
+}
+
+/* Make dictionary 'id' current for compression on the writer.
+ */
+static int dict_set_current (struct dbconn *conn,
+                             unsigned int id,
+                             const void *buf,
+                             size_t size)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    ZSTD_CDict *cdict;
+
+    if (!ddict_add (ctx, id, buf, size)
+        || !(cdict = ZSTD_createCDict (buf, size, zstd_level))) {
+        errno = ENOMEM;
+        return -1;
+    }
+    ZSTD_freeCDict (ctx->cdict);
+    ctx->cdict = cdict;
+    ctx->dict_id = id;
+    return 0;
+}
+
+static int zstd_compress (struct dbconn *conn, const void *data, int size)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    size_t bound;
+    size_t r;
+
+    if (size < (ctx->cdict ? dict_compression_threshold
+                           : compression_threshold))
+        return 0;
+    if (!conn->cctx && !(conn->cctx = ZSTD_createCCtx ())) {
+        errno = ENOMEM;
+        return -1;
+    }
+    bound = ZSTD_compressBound (size);
+    if (conn->lzo_bufsize < bound && grow_lzo_buf (conn, bound) < 0)
+        return -1;
+    if (ctx->cdict) {
+        r = ZSTD_compress_usingCDict (conn->cctx,
+                                      conn->lzo_buf,
+                                      bound,
+                                      data,
+                                      size,
+                                      ctx->cdict);
+    }
+    else {
+        r = ZSTD_compressCCtx (conn->cctx,
+                               conn->lzo_buf,
+                               bound,
+                               data,
+                               size,
+                               zstd_level);
+    }
+    if (ZSTD_isError (r)) {
+        conn_log (conn, LOG_ERR, "store: zstd: %s", ZSTD_getErrorName (r));
+        errno = EINVAL;
+        return -1;
+    }
+    return r;
+}
+
+static int zstd_decompress (struct dbconn *conn,
+                            const void *data,
+                            int size,
+                            int uncompressed_size)
+{
+    unsigned int id = ZSTD_getDictID_fromFrame (data, size);
+    ZSTD_DDict *ddict = NULL;
+    size_t r;
+
+    if (!conn->dctx && !(conn->dctx = ZSTD_createDCtx ()))
+        return -1;
+    if (id != 0 && !(ddict = dict_lookup (conn, id)))
+        return -1;
+    if (ddict) {
+        r = ZSTD_decompress_usingDDict (conn->dctx,
+                                        conn->lzo_buf,
+                                        uncompressed_size,
+                                        data,
+                                        size,
+                                        ddict);
+    }
+    else {
+        r = ZSTD_decompressDCtx (conn->dctx,
+                                 conn->lzo_buf,
+                                 uncompressed_size,
+                                 data,
+                                 size);
+    }
+    if (ZSTD_isError (r)) {
+        conn_log (conn, LOG_ERR, "load: zstd: %s", ZSTD_getErrorName (r));
+        return -1;
+    }
+    return r;
+}
+#endif /* HAVE_ZSTD */
+
+static int lz4_compress (struct dbconn *conn, const void *data, int size)
+{
+    int bound;
+    int r;
+
+    if (size < compression_threshold)
+        return 0;
+    bound = LZ4_compressBound (size);
+    if (conn->lzo_bufsize < bound && grow_lzo_buf (conn, bound) < 0)
+        return -1;
+    if ((r = LZ4_compress_default (data, conn->lzo_buf, size, bound)) == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return r;
+}
+
+/* Compress 'data' into conn->lzo_buf with the configured codec.
+ * Returns the compressed size and sets *codecp, 0 if the blob should be
+ * stored uncompressed, or -1 on error with errno set.
+ */
+static int content_sqlite_compress (struct dbconn *conn,
+                                    const void *data,
+                                    int size,
+                                    int *codecp)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    double t0 = thread_cputime ();
+    int r;
+
+    switch (ctx->codec) {
+        case CODEC_LZ4:
+            r = lz4_compress (conn, data, size);
+            break;
+#if HAVE_ZSTD
+        case CODEC_ZSTD:
+            r = zstd_compress (conn, data, size);
+            break;
+#endif
+        default:
+            return 0;
+    }
+    if (r <= 0)
+        return r;
+    /* A blob that did not shrink is stored uncompressed.  Account for it
+     * at its original size, so the ratio reflects space actually saved.
+     */
+    codec_stats_compress (ctx,
+                          ctx->codec,
+                          size,
+                          r < size ? r : size,
+                          thread_cputime () - t0);
+    if (r >= size)
+        return 0;
+    *codecp = ctx->codec;
+    return r;
+}
+
+/* Decode the current row of 'stmt', whose first three columns are object,
+ * size, and codec, uncompressing if necessary.  Returned data is valid until
+ * 'stmt' is stepped or reset, or the next decode on 'conn'.
  * Returns 0 on success, -1 on error with errno set.
- * On successful return, must call sqlite3_reset (ctx->load_stmt),
- * which invalidates returned data.
  */
-static int content_sqlite_load (struct content_sqlite *ctx,
-                                const void *hash,
-                                int hash_size,
-                                const void **datap,
-                                int *sizep)
+static int content_sqlite_decode (struct dbconn *conn,
+                                  sqlite3_stmt *stmt,
+                                  const void **datap,
+                                  int *sizep)
 {
     const void *data = NULL;
     int size = 0;
     int uncompressed_size;
+    int codec;
 
-    if (sqlite3_bind_text (ctx->load_stmt,
-                           1,
-                           (char *)hash,
-                           hash_size,
-                           SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "load: binding key");
-        set_errno_from_sqlite_error (ctx);
-        goto error;
-    }
-    if (sqlite3_step (ctx->load_stmt) != SQLITE_ROW) {
-        //log_sqlite_error (ctx, "load: executing stmt");
-        errno = ENOENT;
-        goto error;
-    }
-    size = sqlite3_column_bytes (ctx->load_stmt, 0);
-    if (sqlite3_column_type (ctx->load_stmt, 0) != SQLITE_BLOB && size > 0) {
-        flux_log (ctx->h, LOG_ERR, "load: selected value is not a blob");
+    size = sqlite3_column_bytes (stmt, 0);
+    if (sqlite3_column_type (stmt, 0) != SQLITE_BLOB && size > 0) {
+        conn_log (conn, LOG_ERR, "load: selected value is not a blob");
         errno = EINVAL;
-        goto error;
+        return -1;
     }
-    data = sqlite3_column_blob (ctx->load_stmt, 0);
-    if (sqlite3_column_type (ctx->load_stmt, 1) != SQLITE_INTEGER) {
-        flux_log (ctx->h, LOG_ERR, "load: selected value is not an integer");
+    data = sqlite3_column_blob (stmt, 0);
+    if (sqlite3_column_type (stmt, 1) != SQLITE_INTEGER) {
+        conn_log (conn, LOG_ERR, "load: selected value is not an integer");
         errno = EINVAL;
-        goto error;
+        return -1;
     }
-    uncompressed_size = sqlite3_column_int (ctx->load_stmt, 1);
+    uncompressed_size = sqlite3_column_int (stmt, 1);
+    codec = sqlite3_column_int (stmt, 2);
     if (uncompressed_size != -1) {
-        if (ctx->lzo_bufsize < uncompressed_size
-                                && grow_lzo_buf (ctx, uncompressed_size) < 0)
-            goto error;
-        int r = LZ4_decompress_safe (data,
-                                     ctx->lzo_buf,
-                                     size,
-                                     uncompressed_size);
+        double t0;
+        int r;
+
+        if (conn->lzo_bufsize < uncompressed_size
+                                && grow_lzo_buf (conn, uncompressed_size) < 0)
+            return -1;
+        t0 = thread_cputime ();
+        switch (codec) {
+            case CODEC_LZ4:
+                r = LZ4_decompress_safe (data,
+                                         conn->lzo_buf,
+                                         size,
+                                         uncompressed_size);
+                break;
+#if HAVE_ZSTD
+            case CODEC_ZSTD:
+                r = zstd_decompress (conn, data, size, uncompressed_size);
+                break;
+#endif
+            default:
+                conn_log (conn, LOG_ERR, "load: unsupported codec %d", codec);
+                errno = EINVAL;
+                return -1;
+        }
         if (r < 0) {
             errno = EINVAL;
-            goto error;
+            return -1;
         }
         if (r != uncompressed_size) {
-            flux_log (ctx->h, LOG_ERR, "load: blob size mismatch");
+            conn_log (conn, LOG_ERR, "load: blob size mismatch");
             errno = EINVAL;
-            goto error;
+            return -1;
         }
-        data = ctx->lzo_buf;
+        codec_stats_decompress (conn->ctx, codec, thread_cputime () - t0);
+        data = conn->lzo_buf;
         size = uncompressed_size;
     }
     *datap = data;
     *sizep = size;
-    /* call sqlite3_reset() on ctx->load_stmt in caller, after it has
+    return 0;
+}
+
+/* Load blob from objects table, uncompressing if necessary.
+ * Returns 0 on success, -1 on error with errno set.
+ * On successful return, must call sqlite3_reset (conn->load_stmt),
+ * which invalidates returned data.
+ */
+static int content_sqlite_load (struct dbconn *conn,
+                                const void *hash,
+                                int hash_size,
+                                const void **datap,
+                                int *sizep)
+{
+    if (sqlite3_bind_text (conn->load_stmt,
+                           1,
+                           (char *)hash,
+                           hash_size,
+                           SQLITE_STATIC) != SQLITE_OK) {
+        log_sqlite_error (conn, "load: binding key");
+        set_errno_from_sqlite_error (conn);
+        goto error;
+    }
+    if (sqlite3_step (conn->load_stmt) != SQLITE_ROW) {
+        //log_sqlite_error (conn, "load: executing stmt");
+        errno = ENOENT;
+        goto error;
+    }
+    if (content_sqlite_decode (conn, conn->load_stmt, datap, sizep) < 0)
+        goto error;
+    /* call sqlite3_reset() on conn->load_stmt in caller, after it has
      * used returned data pointer */
     return 0;
 error:
-    ERRNO_SAFE_WRAP (sqlite3_reset, ctx->load_stmt);
+    ERRNO_SAFE_WRAP (sqlite3_reset, conn->load_stmt);
     return -1;
 }
 
@@ -316,14 +1020,17 @@ error:
  * hash over 'data' is stored to 'hash'.
  * Returns hash size on success, -1 on error with errno set.
  */
-static int content_sqlite_store (struct content_sqlite *ctx,
+static int content_sqlite_store (struct dbconn *conn,
                                  const void *data,
                                  int size,
                                  void *hash,
                                  int hash_len)
 {
+    struct content_sqlite *ctx = conn->ctx;
     int uncompressed_size = -1;
+    int codec = CODEC_LZ4;
     int hash_size;
+    int r;
 
     if ((hash_size = blobref_hash_raw (ctx->hashfun,
                                        data,
@@ -332,34 +1039,27 @@ static int content_sqlite_store (struct content_sqlite *ctx,
                                        hash_len)) < 0)
         return -1;
     assert (hash_size == ctx->hash_size);
-    if (size >= compression_threshold) {
-        int r;
-        int out_len = LZ4_compressBound(size);
-        if (ctx->lzo_bufsize < out_len && grow_lzo_buf (ctx, out_len) < 0)
-            return -1;
-        r = LZ4_compress_default (data, ctx->lzo_buf, size, out_len);
-        if (r == 0) {
-            errno = EINVAL;
-            return -1;
-        }
+    if ((r = content_sqlite_compress (conn, data, size, &codec)) < 0)
+        return -1;
+    if (r > 0) {
         uncompressed_size = size;
         size = r;
-        data = ctx->lzo_buf;
+        data = conn->lzo_buf;
     }
     if (sqlite3_bind_text (ctx->store_stmt,
                            1,
                            hash,
                            hash_size,
                            SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "store: binding key");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "store: binding key");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
     if (sqlite3_bind_int (ctx->store_stmt,
                           2,
                           uncompressed_size) != SQLITE_OK) {
-        log_sqlite_error (ctx, "store: binding size");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "store: binding size");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
     if (sqlite3_bind_blob (ctx->store_stmt,
@@ -367,22 +1067,27 @@ static int content_sqlite_store (struct content_sqlite *ctx,
                            data,
                            size,
                            SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "store: binding data");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "store: binding data");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
     if (sqlite3_bind_int64 (ctx->store_stmt,
                             4,
                             ctx->current_epoch) != SQLITE_OK) {
-        log_sqlite_error (ctx, "store: binding epoch");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "store: binding epoch");
+        set_errno_from_sqlite_error (conn);
+        goto error;
+    }
+    if (sqlite3_bind_int (ctx->store_stmt, 5, codec) != SQLITE_OK) {
+        log_sqlite_error (conn, "store: binding codec");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
     /* N.B. ON CONFLICT clause updates epoch without rewriting object.
      */
     if (sqlite3_step (ctx->store_stmt) != SQLITE_DONE) {
-        log_sqlite_error (ctx, "store: executing stmt");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "store: executing stmt");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
     sqlite3_reset (ctx->store_stmt);
@@ -395,46 +1100,314 @@ error:
 /* Validate blob in objects table.
  * Returns 0 if valid, -1 on error (ENOENT if  not found)
  */
-static int content_sqlite_validate (struct content_sqlite *ctx,
+static int content_sqlite_validate (struct dbconn *conn,
                                     const void *hash,
                                     int hash_size)
 {
-    if (sqlite3_bind_text (ctx->validate_stmt,
+    if (sqlite3_bind_text (conn->validate_stmt,
                            1,
                            (char *)hash,
                            hash_size,
                            SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "validate: binding key");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "validate: binding key");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
-    if (sqlite3_step (ctx->validate_stmt) != SQLITE_ROW) {
-        //log_sqlite_error (ctx, "validate: executing stmt");
+    if (sqlite3_step (conn->validate_stmt) != SQLITE_ROW) {
+        //log_sqlite_error (conn, "validate: executing stmt");
         errno = ENOENT;
         goto error;
     }
-    if (sqlite3_column_type (ctx->validate_stmt, 0) != SQLITE_INTEGER) {
-        flux_log (ctx->h, LOG_ERR, "validate: result is not an integer");
+    if (sqlite3_column_type (conn->validate_stmt, 0) != SQLITE_INTEGER) {
+        conn_log (conn, LOG_ERR, "validate: result is not an integer");
         errno = EINVAL;
         goto error;
     }
-    if (!sqlite3_column_int (ctx->validate_stmt, 0)) {
+    if (!sqlite3_column_int (conn->validate_stmt, 0)) {
         errno = ENOENT;
         goto error;
     }
-    (void )sqlite3_reset (ctx->validate_stmt);
+    (void )sqlite3_reset (conn->validate_stmt);
     return 0;
 error:
-    ERRNO_SAFE_WRAP (sqlite3_reset, ctx->validate_stmt);
+    ERRNO_SAFE_WRAP (sqlite3_reset, conn->validate_stmt);
     return -1;
 }
 
-static void load_cb (flux_t *h,
-                     flux_msg_handler_t *mh,
-                     const flux_msg_t *msg,
-                     void *arg)
+#if HAVE_ZSTD
+/* Train a zstd dictionary of up to 'dict_size' bytes on up to 'max_samples'
+ * of the most recently stored blobs, totalling at most 'max_bytes'.  Blobs
+ * larger than DICT_SAMPLE_SIZE_MAX are skipped, since a dictionary mainly
+ * benefits small blobs.  This only reads the database, so it may run on a
+ * reader.  On success, the caller must free '*dictp'.
+ */
+static int dict_train_samples (struct dbconn *conn,
+                               int max_samples,
+                               size_t max_bytes,
+                               size_t dict_size,
+                               void **dictp,
+                               size_t *sizep,
+                               int *countp,
+                               flux_error_t *errp)
 {
-    struct content_sqlite *ctx = arg;
+    sqlite3_stmt *stmt = NULL;
+    char *samples = NULL;
+    size_t samples_size = 0;
+    size_t samples_alloc = 0;
+    size_t *sizes = NULL;
+    int count = 0;
+    void *dict = NULL;
+    size_t r;
+    int rc;
+
+    if (!(sizes = calloc (max_samples, sizeof (sizes[0])))
+        || !(dict = malloc (dict_size)))
+        goto nomem;
+    if (sqlite3_prepare_v2 (conn->db,
+                            sql_dict_samples,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK
+        || sqlite3_bind_int (stmt, 1, max_samples) != SQLITE_OK)
+        goto sqlite_error;
+    while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
+        const void *data;
+        int size;
+
+        if (content_sqlite_decode (conn, stmt, &data, &size) < 0
+            || size == 0
+            || size > DICT_SAMPLE_SIZE_MAX)
+            continue;
+        if (samples_size + size > max_bytes) {
+            rc = SQLITE_DONE;
+            break;
+        }
+        if (samples_size + size > samples_alloc) {
+            size_t newsize = (samples_size + size) * 2;
+            char *tmp;
+
+            if (!(tmp = realloc (samples, newsize)))
+                goto nomem;
+            samples = tmp;
+            samples_alloc = newsize;
+        }
+        memcpy (samples + samples_size, data, size);
+        samples_size += size;
+        sizes[count++] = size;
+    }
+    if (rc != SQLITE_DONE)
+        goto sqlite_error;
+    sqlite3_finalize (stmt);
+    stmt = NULL;
+
+    r = ZDICT_trainFromBuffer (dict, dict_size, samples, sizes, count);
+    if (ZDICT_isError (r)) {
+        errprintf (errp,
+                   "training on %d blobs failed: %s",
+                   count,
+                   ZDICT_getErrorName (r));
+        errno = EINVAL;
+        goto error;
+    }
+    *dictp = dict;
+    *sizep = r;
+    *countp = count;
+    free (sizes);
+    free (samples);
+    return 0;
+nomem:
+    errprintf (errp, "out of memory");
+    errno = ENOMEM;
+    goto error;
+sqlite_error:
+    log_sqlite_error (conn, "dict-train");
+    set_text_from_sqlite_error (conn, errp);
+    set_errno_from_sqlite_error (conn);
+error:
+    ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    ERRNO_SAFE_WRAP (free, dict);
+    ERRNO_SAFE_WRAP (free, sizes);
+    ERRNO_SAFE_WRAP (free, samples);
+    return -1;
+}
+
+/* Add a trained dictionary to the dicts table and make it current.
+ * This must run on the writer.
+ */
+static int dict_add (struct dbconn *conn,
+                     const void *dict,
+                     size_t size,
+                     unsigned int *idp,
+                     flux_error_t *errp)
+{
+    sqlite3_stmt *stmt = NULL;
+    unsigned int id = ZSTD_getDictID_fromDict (dict, size);
+
+    if (sqlite3_prepare_v2 (conn->db,
+                            sql_dict_put,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK
+        || sqlite3_bind_int64 (stmt, 1, id) != SQLITE_OK
+        || sqlite3_bind_blob (stmt, 2, dict, size, SQLITE_STATIC) != SQLITE_OK
+        || sqlite3_step (stmt) != SQLITE_DONE)
+        goto sqlite_error;
+    sqlite3_finalize (stmt);
+    if (dict_set_current (conn, id, dict, size) < 0) {
+        errprintf (errp, "out of memory");
+        errno = ENOMEM;
+        return -1;
+    }
+    *idp = id;
+    return 0;
+sqlite_error:
+    log_sqlite_error (conn, "dict-train");
+    set_text_from_sqlite_error (conn, errp);
+    set_errno_from_sqlite_error (conn);
+    ERRNO_SAFE_WRAP (sqlite3_finalize, stmt);
+    return -1;
+}
+#else
+static int dict_train_samples (struct dbconn *conn,
+                               int max_samples,
+                               size_t max_bytes,
+                               size_t dict_size,
+                               void **dictp,
+                               size_t *sizep,
+                               int *countp,
+                               flux_error_t *errp)
+{
+    errprintf (errp, "content-sqlite was built without zstd support");
+    errno = ENOSYS;
+    return -1;
+}
+
+static int dict_add (struct dbconn *conn,
+                     const void *dict,
+                     size_t size,
+                     unsigned int *idp,
+                     flux_error_t *errp)
+{
+    errprintf (errp, "content-sqlite was built without zstd support");
+    errno = ENOSYS;
+    return -1;
+}
+#endif /* HAVE_ZSTD */
+
+/* Train a dictionary on the writer and make it current.
+ */
+static int dict_train (struct dbconn *conn,
+                       int max_samples,
+                       size_t dict_size,
+                       struct dict_info *info,
+                       flux_error_t *errp)
+{
+    void *dict;
+    size_t size;
+    int count;
+
+    if (dict_train_samples (conn,
+                            max_samples,
+                            SIZE_MAX,
+                            dict_size,
+                            &dict,
+                            &size,
+                            &count,
+                            errp) < 0)
+        return -1;
+    if (dict_add (conn, dict, size, &info->id, errp) < 0) {
+        ERRNO_SAFE_WRAP (free, dict);
+        return -1;
+    }
+    info->size = size;
+    info->samples = count;
+    free (dict);
+    return 0;
+}
+
+/* Internal writer job queued by dict_autotrain_cb(), with the trained
+ * dictionary in job->data.
+ */
+static void dict_autotrain_add_cb (struct dbconn *conn, const flux_msg_t *msg)
+{
+    struct dbjob *job = conn->job;
+    unsigned int id;
+    flux_error_t error;
+
+    if (conn->ctx->dict_id != 0) // trained on request in the meantime
+        return;
+    if (dict_add (conn, job->data, job->size, &id, &error) < 0) {
+        conn_log (conn, LOG_DEBUG, "dictionary training: %s", error.text);
+        return;
+    }
+    conn_log (conn,
+              LOG_INFO,
+              "trained dictionary %u (%zu bytes)",
+              id,
+              job->size);
+}
+
+/* Internal job queued by dict_autotrain_check(), with no request.
+ * Runs on a reader if there is one, then hands the dictionary to the
+ * writer.
+ */
+static void dict_autotrain_cb (struct dbconn *conn, const flux_msg_t *msg)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    struct dbjob *job;
+    void *dict;
+    size_t size;
+    int count;
+    struct timespec t0;
+    flux_error_t error;
+
+    monotime (&t0);
+    if (dict_train_samples (conn,
+                            DICT_SAMPLES_DEFAULT,
+                            DICT_AUTOTRAIN_BYTES,
+                            DICT_SIZE_DEFAULT,
+                            &dict,
+                            &size,
+                            &count,
+                            &error) < 0) {
+        conn_log (conn, LOG_DEBUG, "dictionary training: %s", error.text);
+        return;
+    }
+    conn_log (conn,
+              LOG_DEBUG,
+              "dictionary training on %d blobs took %.3fs",
+              count,
+              monotime_since (t0) * 1E-3);
+    if (!(job = dbjob_create (dict_autotrain_add_cb, NULL))) {
+        free (dict);
+        return;
+    }
+    job->data = dict;
+    job->size = size;
+    dbqueue_push (&ctx->writeq, job);
+}
+
+/* With the zstd codec and no dictionary, queue a training job each time
+ * DICT_AUTOTRAIN_STORES more blobs have been stored.
+ */
+static void dict_autotrain_check (struct dbconn *conn, int count)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    struct dbjob *job;
+
+    if (ctx->codec != CODEC_ZSTD || ctx->dict_id != 0)
+        return;
+    ctx->autotrain_count += count;
+    if (ctx->autotrain_count < DICT_AUTOTRAIN_STORES)
+        return;
+    ctx->autotrain_count = 0;
+    if ((job = dbjob_create (dict_autotrain_cb, NULL)))
+        dbqueue_push (ctx->reader_count > 0 ? &ctx->readq : conn->queue, job);
+}
+
+static void load_cb (struct dbconn *conn, const flux_msg_t *msg)
+{
+    struct content_sqlite *ctx = conn->ctx;
     const void *hash;
     size_t hash_size;
     const void *data;
@@ -446,61 +1419,226 @@ static void load_cb (flux_t *h,
                                  &hash,
                                  &hash_size) < 0)
         goto error;
-    if (hash_size != ctx->hash_size) {
-        errno = EPROTO;
+    if (hash_size != ctx->hash_size) {
+        errno = EPROTO;
+        goto error;
+    }
+    monotime (&t0);
+    if (content_sqlite_load (conn, hash, hash_size, &data, &size) < 0)
+        goto error;
+    stats_push (ctx, &ctx->stats.load, monotime_since (t0));
+    if (conn_respond_raw (conn, msg, data, size) < 0)
+        conn_log_error (conn, "load: flux_respond_raw");
+    (void )sqlite3_reset (conn->load_stmt);
+    return;
+error:
+    if (conn_respond_error (conn, msg, errno, NULL) < 0)
+        conn_log_error (conn, "load: flux_respond_error");
+}
+
+void store_cb (struct dbconn *conn, const flux_msg_t *msg)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    const void *data;
+    size_t size;
+    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
+    int hash_size;
+    struct timespec t0;
+
+    if (flux_request_decode_raw (msg, NULL, &data, &size) < 0) {
+        conn_log_error (conn, "store: request decode failed");
+        goto error;
+    }
+    monotime (&t0);
+    if ((hash_size = content_sqlite_store (conn,
+                                           data,
+                                           size,
+                                           hash,
+                                           sizeof (hash))) < 0)
+        goto error;
+    stats_push (ctx, &ctx->stats.store, monotime_since (t0));
+    if (conn_respond_raw (conn, msg, hash, hash_size) < 0)
+        conn_log_error (conn, "store: flux_respond_raw");
+    dict_autotrain_check (conn, 1);
+    return;
+error:
+    if (conn_respond_error (conn, msg, errno, NULL) < 0)
+        conn_log_error (conn, "store: flux_respond_error");
+}
+
+/* content-backing.batch-store - store a batch of blobs in one transaction
+ * Request:  raw, for each blob: 4 byte size (network order), then data
+ * Response: raw, for each blob in request order: 4 byte errno (network
+ *           order), then hash (zeroed if errno is nonzero)
+ *
+ * In autocommit mode each content_sqlite_store() is its own implicit
+ * transaction, so N blobs flushed from the content cache would incur N
+ * commits.  Wrap them in one transaction instead.  A blob that fails to
+ * store gets a nonzero errno in its result.  An error that ends the
+ * transaction (sqlite rolls back on some, e.g. SQLITE_FULL, or COMMIT
+ * fails) fails the whole request, since none of the blobs were stored.
+ */
+static void batch_store_cb (struct dbconn *conn, const flux_msg_t *msg)
+{
+    struct content_sqlite *ctx = conn->ctx;
+    const uint8_t *buf;
+    size_t size;
+    size_t offset;
+    int count = 0;
+    size_t rec_size = 4 + ctx->hash_size;
+    uint8_t *results = NULL;
+    bool in_txn = false;
+    flux_error_t error;
+    const char *errstr = NULL;
+    struct timespec t0;
+    int i;
+
+    if (flux_request_decode_raw (msg, NULL, (const void **)&buf, &size) < 0)
+        goto error;
+    /* Validate framing before touching the database.
+     */
+    offset = 0;
+    while (offset < size) {
+        uint32_t len;
+
+        if (size - offset < sizeof (len))
+            goto eproto;
+        memcpy (&len, buf + offset, sizeof (len));
+        offset += sizeof (len);
+        if (size - offset < ntohl (len))
+            goto eproto;
+        offset += ntohl (len);
+        count++;
+    }
+    if (count > BATCH_STORE_MAX) {
+        errprintf (&error,
+                   "batch-store request of %d blobs exceeds limit of %d",
+                   count,
+                   BATCH_STORE_MAX);
+        errstr = error.text;
+        errno = EINVAL;
         goto error;
     }
+    if (!(results = calloc (count > 0 ? count : 1, rec_size)))
+        goto error;
+
     monotime (&t0);
-    if (content_sqlite_load (ctx, hash, hash_size, &data, &size) < 0)
+    if (sqlite3_exec (conn->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "batch-store: BEGIN");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
-    tstat_push (&ctx->stats.load, monotime_since (t0));
-    if (flux_respond_raw (h, msg, data, size) < 0)
-        flux_log_error (h, "load: flux_respond_raw");
-    (void )sqlite3_reset (ctx->load_stmt);
+    }
+    in_txn = true;
+    offset = 0;
+    for (i = 0; i < count; i++) {
+        uint8_t *rec = results + i * rec_size;
+        uint32_t len;
+
+        memcpy (&len, buf + offset, sizeof (len));
+        offset += sizeof (len);
+        len = ntohl (len);
+        if (content_sqlite_store (conn,
+                                  buf + offset,
+                                  len,
+                                  rec + 4,
+                                  ctx->hash_size) < 0) {
+            uint32_t errnum = htonl (errno);
+
+            if (sqlite3_get_autocommit (conn->db)) { // rolled back
+                in_txn = false;
+                errstr = set_text_from_sqlite_error (conn, &error);
+                goto error;
+            }
+            memcpy (rec, &errnum, sizeof (errnum));
+            memset (rec + 4, 0, ctx->hash_size);
+        }
+        offset += len;
+    }
+    if (sqlite3_exec (conn->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "batch-store: COMMIT");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
+        goto error;
+    }
+    in_txn = false;
+    stats_push (ctx, &ctx->stats.batch_store, monotime_since (t0));
+    if (conn_respond_raw (conn, msg, results, count * rec_size) < 0)
+        conn_log_error (conn, "batch-store: flux_respond_raw");
+    free (results);
+    dict_autotrain_check (conn, count);
     return;
+eproto:
+    errno = EPROTO;
+    errstr = "malformed batch-store request";
 error:
-    if (flux_respond_error (h, msg, errno, NULL) < 0)
-        flux_log_error (h, "load: flux_respond_error");
+    if (in_txn)
+        ERRNO_SAFE_WRAP (sqlite3_exec, conn->db, "ROLLBACK", NULL, NULL, NULL);
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "batch-store: flux_respond_error");
+    ERRNO_SAFE_WRAP (free, results);
 }
 
-void store_cb (flux_t *h,
-               flux_msg_handler_t *mh,
-               const flux_msg_t *msg,
-               void *arg)
+/* content-sqlite.dict-train - train a zstd compression dictionary
+ * Request:  {"max_samples"?:i, "dict_size"?:i}
+ * Response: {"id":I, "size":I, "samples":i}
+ *
+ * Blobs stored with the zstd codec after this completes are compressed
+ * with the new dictionary.  Older dictionaries remain in the dicts table
+ * for blobs that were compressed with them.  Training runs on the writer,
+ * so stores wait until it completes.
+ */
+static void dict_train_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
-    const void *data;
-    size_t size;
-    uint8_t hash[BLOBREF_MAX_DIGEST_SIZE];
-    int hash_size;
-    struct timespec t0;
+    int max_samples = DICT_SAMPLES_DEFAULT;
+    int dict_size = DICT_SIZE_DEFAULT;
+    struct dict_info info;
+    flux_error_t error;
+    const char *errstr = NULL;
 
-    if (flux_request_decode_raw (msg, NULL, &data, &size) < 0) {
-        flux_log_error (h, "store: request decode failed");
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s?i s?i}",
+                             "max_samples", &max_samples,
+                             "dict_size", &dict_size) < 0)
+        goto error;
+    if (max_samples < 1 || max_samples > DICT_SAMPLES_MAX) {
+        errprintf (&error,
+                   "max_samples must be in the range 1-%d",
+                   DICT_SAMPLES_MAX);
+        errstr = error.text;
+        errno = EINVAL;
         goto error;
     }
-    monotime (&t0);
-    if ((hash_size = content_sqlite_store (ctx,
-                                           data,
-                                           size,
-                                           hash,
-                                           sizeof (hash))) < 0)
+    if (dict_size < DICT_SIZE_MIN || dict_size > DICT_SIZE_MAX) {
+        errprintf (&error,
+                   "dict_size must be in the range %d-%d",
+                   DICT_SIZE_MIN,
+                   DICT_SIZE_MAX);
+        errstr = error.text;
+        errno = EINVAL;
+        goto error;
+    }
+    if (dict_train (conn, max_samples, dict_size, &info, &error) < 0) {
+        errstr = error.text;
         goto error;
-    tstat_push (&ctx->stats.store, monotime_since (t0));
-    if (flux_respond_raw (h, msg, hash, hash_size) < 0)
-        flux_log_error (h, "store: flux_respond_raw");
+    }
+    if (conn_respond_pack (conn,
+                           msg,
+                           "{s:I s:I s:i}",
+                           "id", (json_int_t)info.id,
+                           "size", (json_int_t)info.size,
+                           "samples", info.samples) < 0)
+        conn_log_error (conn, "dict-train: flux_respond_pack");
     return;
 error:
-    if (flux_respond_error (h, msg, errno, NULL) < 0)
-        flux_log_error (h, "store: flux_respond_error");
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "dict-train: flux_respond_error");
 }
 
-static void validate_cb (flux_t *h,
-                         flux_msg_handler_t *mh,
-                         const flux_msg_t *msg,
-                         void *arg)
+static void validate_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
+    struct content_sqlite *ctx = conn->ctx;
     const void *hash;
     size_t hash_size;
 
@@ -513,22 +1651,19 @@ static void validate_cb (flux_t *h,
         errno = EPROTO;
         goto error;
     }
-    if (content_sqlite_validate (ctx, hash, hash_size) < 0)
+    if (content_sqlite_validate (conn, hash, hash_size) < 0)
         goto error;
-    if (flux_respond_raw (h, msg, NULL, 0) < 0)
-        flux_log_error (h, "validate: flux_respond_raw");
+    if (conn_respond_raw (conn, msg, NULL, 0) < 0)
+        conn_log_error (conn, "validate: flux_respond_raw");
     return;
 error:
-    if (flux_respond_error (h, msg, errno, NULL) < 0)
-        flux_log_error (h, "validate: flux_respond_error");
+    if (conn_respond_error (conn, msg, errno, NULL) < 0)
+        conn_log_error (conn, "validate: flux_respond_error");
 }
 
-void checkpoint_get_cb (flux_t *h,
-                        flux_msg_handler_t *mh,
-                        const flux_msg_t *msg,
-                        void *arg)
+void checkpoint_get_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
+    struct content_sqlite *ctx = conn->ctx;
     const char *errstr = NULL;
     flux_error_t sql_error;
     json_t *a = NULL;
@@ -563,19 +1698,19 @@ void checkpoint_get_cb (flux_t *h,
      * which would silently return a partial result or ENOENT.
      */
     if (rc != SQLITE_DONE) {
-        log_sqlite_error (ctx, "checkpt_get: executing stmt");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &sql_error);
+        log_sqlite_error (conn, "checkpt_get: executing stmt");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &sql_error);
         goto error;
     }
 
     /* if no checkpoint entries, we return ENOENT */
     if (json_array_size (a) > 0) {
-        if (flux_respond_pack (h,
+        if (conn_respond_pack (conn,
                                msg,
                                "{s:O}",
                                "value", a) < 0)
-            flux_log_error (h, "flux_respond_pack");
+            conn_log_error (conn, "flux_respond_pack");
     }
     else {
         errno = ENOENT;
@@ -586,18 +1721,15 @@ void checkpoint_get_cb (flux_t *h,
     json_decref (a);
     return;
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "flux_respond_error");
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "flux_respond_error");
     (void )sqlite3_reset (ctx->checkpt_get_stmt);
     json_decref (a);
 }
 
-void checkpoint_put_cb (flux_t *h,
-                        flux_msg_handler_t *mh,
-                        const flux_msg_t *msg,
-                        void *arg)
+void checkpoint_put_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
+    struct content_sqlite *ctx = conn->ctx;
     json_t *o;
     char *value = NULL;
     const char *errstr = NULL;
@@ -618,47 +1750,47 @@ void checkpoint_put_cb (flux_t *h,
                            value,
                            strlen (value),
                            SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt_put: binding value");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "checkpt_put: binding value");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     if (sqlite3_step (ctx->checkpt_put_stmt) != SQLITE_DONE
-                    && sqlite3_errcode (ctx->db) != SQLITE_CONSTRAINT) {
-        log_sqlite_error (ctx, "checkpt_put: executing stmt");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+                    && sqlite3_errcode (conn->db) != SQLITE_CONSTRAINT) {
+        log_sqlite_error (conn, "checkpt_put: executing stmt");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     /* Update current_epoch to the id of the just-inserted checkpoint */
-    ctx->current_epoch = sqlite3_last_insert_rowid (ctx->db);
-    flux_log (ctx->h,
+    ctx->current_epoch = sqlite3_last_insert_rowid (conn->db);
+    conn_log (conn,
               LOG_DEBUG,
               "checkpoint-put: advanced epoch to %jd",
               (intmax_t)ctx->current_epoch);
     if (sqlite3_bind_int (ctx->checkpt_prune_stmt,
                           1,
                           ctx->max_checkpoints) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt_prune: binding count");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "checkpt_prune: binding count");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     if (sqlite3_step (ctx->checkpt_prune_stmt) != SQLITE_DONE) {
-        log_sqlite_error (ctx, "checkpt_prune: executing stmt");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "checkpt_prune: executing stmt");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
-    if (flux_respond (h, msg, NULL) < 0)
-        flux_log_error (h, "flux_respond");
+    if (conn_respond_raw (conn, msg, NULL, 0) < 0)
+        conn_log_error (conn, "flux_respond");
     (void )sqlite3_reset (ctx->checkpt_put_stmt);
     (void )sqlite3_reset (ctx->checkpt_prune_stmt);
     free (value);
     return;
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "flux_respond_error");
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "flux_respond_error");
     (void )sqlite3_reset (ctx->checkpt_put_stmt);
     (void )sqlite3_reset (ctx->checkpt_prune_stmt);
     free (value);
@@ -667,9 +1799,10 @@ error:
 /* On failure, returns NULL with errno set and 'errp' filled with a
  * human-readable description for the client.
  */
-static json_t *stats_checkpoints (struct content_sqlite *ctx,
+static json_t *stats_checkpoints (struct dbconn *conn,
                                   flux_error_t *errp)
 {
+    struct content_sqlite *ctx = conn->ctx;
     sqlite3_stmt *stmt = ctx->checkpt_get_all_stmt;
     json_t *checkpts = NULL;
     int rc;
@@ -687,13 +1820,13 @@ static json_t *stats_checkpoints (struct content_sqlite *ctx,
 
         if ((id = sqlite3_column_int (stmt, 0)) < 0
             || !(s = (const char *)sqlite3_column_text (stmt, 1))) {
-            log_sqlite_error (ctx, "checkpt_get_all: getting values");
-            set_errno_from_sqlite_error (ctx);
-            set_text_from_sqlite_error (ctx, errp);
+            log_sqlite_error (conn, "checkpt_get_all: getting values");
+            set_errno_from_sqlite_error (conn);
+            set_text_from_sqlite_error (conn, errp);
             goto error;
         }
         if (!(value = json_loads (s, 0, NULL))) {
-            flux_log (ctx->h,
+            conn_log (conn,
                       LOG_ERR,
                       "invalid checkpoint value: %s",
                       s);
@@ -714,9 +1847,9 @@ static json_t *stats_checkpoints (struct content_sqlite *ctx,
      * silently return a truncated checkpoint list in the stats output).
      */
     if (rc != SQLITE_DONE) {
-        log_sqlite_error (ctx, "checkpt_get_all: executing stmt");
-        set_errno_from_sqlite_error (ctx);
-        set_text_from_sqlite_error (ctx, errp);
+        log_sqlite_error (conn, "checkpt_get_all: executing stmt");
+        set_errno_from_sqlite_error (conn);
+        set_text_from_sqlite_error (conn, errp);
         goto error;
     }
 
@@ -729,42 +1862,65 @@ error:
     return NULL;
 }
 
+/* Finalize the statements common to all connections and close it.
+ */
+static void dbconn_close (struct dbconn *conn)
+{
+    if (conn) {
+        int saved_errno = errno;
+        if (conn->validate_stmt) {
+            if (sqlite3_finalize (conn->validate_stmt) != SQLITE_OK)
+                log_sqlite_error (conn, "sqlite_finalize validate_stmt");
+            conn->validate_stmt = NULL;
+        }
+        if (conn->load_stmt) {
+            if (sqlite3_finalize (conn->load_stmt) != SQLITE_OK)
+                log_sqlite_error (conn, "sqlite_finalize load_stmt");
+            conn->load_stmt = NULL;
+        }
+        if (conn->db) {
+            if (sqlite3_close (conn->db) != SQLITE_OK)
+                log_sqlite_error (conn, "sqlite3_close");
+            conn->db = NULL;
+        }
+#if HAVE_ZSTD
+        ZSTD_freeCCtx (conn->cctx);
+        conn->cctx = NULL;
+        ZSTD_freeDCtx (conn->dctx);
+        conn->dctx = NULL;
+#endif
+        errno = saved_errno;
+    }
+}
+
 static void content_sqlite_closedb (struct content_sqlite *ctx)
 {
     if (ctx) {
+        struct dbconn *conn = &ctx->writer;
         int saved_errno = errno;
-        if (ctx->validate_stmt) {
-            if (sqlite3_finalize (ctx->validate_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize validate_stmt");
-        }
         if (ctx->store_stmt) {
             if (sqlite3_finalize (ctx->store_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize store_stmt");
-        }
-        if (ctx->load_stmt) {
-            if (sqlite3_finalize (ctx->load_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize load_stmt");
+                log_sqlite_error (conn, "sqlite_finalize store_stmt");
         }
         if (ctx->checkpt_get_stmt) {
             if (sqlite3_finalize (ctx->checkpt_get_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize checkpt_get_stmt");
+                log_sqlite_error (conn, "sqlite_finalize checkpt_get_stmt");
         }
         if (ctx->checkpt_put_stmt) {
             if (sqlite3_finalize (ctx->checkpt_put_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize checkpt_put_stmt");
+                log_sqlite_error (conn, "sqlite_finalize checkpt_put_stmt");
         }
         if (ctx->checkpt_prune_stmt) {
             if (sqlite3_finalize (ctx->checkpt_prune_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize checkpt_prune_stmt");
+                log_sqlite_error (conn, "sqlite_finalize checkpt_prune_stmt");
         }
         if (ctx->checkpt_get_all_stmt) {
             if (sqlite3_finalize (ctx->checkpt_get_all_stmt) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite_finalize checkpt_get_all_stmt");
-        }
-        if (ctx->db) {
-            if (sqlite3_close (ctx->db) != SQLITE_OK)
-                log_sqlite_error (ctx, "sqlite3_close");
+                log_sqlite_error (conn, "sqlite_finalize checkpt_get_all_stmt");
         }
+        dbconn_close (conn);
+        for (int i = 0; i < ctx->reader_count; i++)
+            dbconn_close (&ctx->readers[i]);
         errno = saved_errno;
     }
 }
@@ -805,6 +1961,40 @@ static json_t *pack_tstat (tstat_t *ts)
     return o;
 }
 
+/* Summarize per-codec activity.  Caller must hold ctx->stats_lock.
+ */
+static json_t *pack_codecs (struct content_sqlite *ctx)
+{
+    json_t *codecs;
+
+    if (!(codecs = json_object ()))
+        goto nomem;
+    for (int i = 0; i < CODEC_COUNT; i++) {
+        struct codec_stats *cs = &ctx->stats.codec[i];
+        double ratio = 0.;
+        json_t *o;
+
+        if (cs->bytes_out > 0)
+            ratio = (double)cs->bytes_in / cs->bytes_out;
+        if (!(o = json_pack ("{s:I s:I s:I s:f s:o s:o}",
+                             "count", (json_int_t)cs->count,
+                             "bytes_in", (json_int_t)cs->bytes_in,
+                             "bytes_out", (json_int_t)cs->bytes_out,
+                             "ratio", ratio,
+                             "compress_cpu",
+                               pack_tstat (&cs->compress_cpu),
+                             "decompress_cpu",
+                               pack_tstat (&cs->decompress_cpu)))
+            || json_object_set_new (codecs, codec_names[i], o) < 0)
+            goto nomem;
+    }
+    return codecs;
+nomem:
+    json_decref (codecs);
+    errno = ENOMEM;
+    return NULL;
+}
+
 static unsigned long long get_file_size (const char *path)
 {
     struct stat sb;
@@ -823,58 +2013,72 @@ static unsigned long long get_fs_free (const char *path)
     return sb.f_bsize * sb.f_bavail;
 }
 
-void stats_get_cb (flux_t *h,
-                   flux_msg_handler_t *mh,
-                   const flux_msg_t *msg,
-                   void *arg)
+void stats_get_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
+    struct content_sqlite *ctx = conn->ctx;
     int64_t count;
     const char *errmsg = NULL;
     flux_error_t error;
     json_t *load_time = NULL;
     json_t *store_time = NULL;
+    json_t *batch_store_time = NULL;
+    json_t *codecs = NULL;
     json_t *checkpoints = NULL;
 
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       sql_objects_count,
                       set_count,
                       &count,
                       NULL) != SQLITE_OK) {
-        errmsg = set_text_from_sqlite_error (ctx, &error);
+        errmsg = set_text_from_sqlite_error (conn, &error);
         errno = EPERM;
         goto error;
     }
-    if (!(load_time = pack_tstat (&ctx->stats.load))
-        || !(store_time = pack_tstat (&ctx->stats.store)))
+    pthread_mutex_lock (&ctx->stats_lock);
+    load_time = pack_tstat (&ctx->stats.load);
+    store_time = pack_tstat (&ctx->stats.store);
+    batch_store_time = pack_tstat (&ctx->stats.batch_store);
+    codecs = pack_codecs (ctx);
+    pthread_mutex_unlock (&ctx->stats_lock);
+    if (!load_time || !store_time || !batch_store_time || !codecs)
         goto error;
-    if (!(checkpoints = stats_checkpoints (ctx, &error))) {
+    if (!(checkpoints = stats_checkpoints (conn, &error))) {
         errmsg = error.text;
         goto error;
     }
-    if (flux_respond_pack (h,
+    if (conn_respond_pack (conn,
                            msg,
-                           "{s:I s:I s:I s:I s:O s:O s:{s:s s:s} s:O}",
+                           "{s:I s:I s:I s:I s:O s:O s:O s:O s:I"
+                           " s:{s:s s:s s:i s:s} s:O}",
                            "object_count", count,
                            "current_epoch", ctx->current_epoch,
                            "dbfile_size", get_file_size (ctx->dbfile),
                            "dbfile_free", get_fs_free (ctx->dbfile),
                            "load_time", load_time,
                            "store_time", store_time,
+                           "batch_store_time", batch_store_time,
+                           "codecs", codecs,
+                           "dict_id", (json_int_t)ctx->dict_id,
                            "config",
                              "journal_mode", ctx->journal_mode,
                              "synchronous", ctx->synchronous,
+                             "readers", ctx->reader_count,
+                             "codec", codec_names[ctx->codec],
                            "checkpoints", checkpoints) < 0)
-        flux_log_error (h, "error responding to stats-get request");
+        conn_log_error (conn, "error responding to stats-get request");
     json_decref (load_time);
     json_decref (store_time);
+    json_decref (batch_store_time);
+    json_decref (codecs);
     json_decref (checkpoints);
     return;
 error:
-    if (flux_respond_error (h, msg, errno, errmsg) < 0)
-        flux_log_error (h, "error responding to stats-get request");
+    if (conn_respond_error (conn, msg, errno, errmsg) < 0)
+        conn_log_error (conn, "error responding to stats-get request");
     json_decref (load_time);
     json_decref (store_time);
+    json_decref (batch_store_time);
+    json_decref (codecs);
     json_decref (checkpoints);
 }
 
@@ -892,17 +2096,14 @@ error:
  * store (already swept, or never stored) simply matches no row.  'marked' is
  * the number of rows actually changed, for the caller's progress accounting.
  *
- * The batch is capped at MARK_HASHES_MAX because the whole loop runs
- * synchronously on this module's reactor thread, blocking all other content
- * requests until it completes; the cap bounds that stall (and rejects a
- * malformed or hostile request that would otherwise pin the reactor).
+ * The batch is capped at MARK_HASHES_MAX because the whole loop runs on this
+ * module's writer thread, blocking other writes until it completes; the cap
+ * bounds that stall (and rejects a malformed or hostile request that would
+ * otherwise pin the writer).
  */
-static void mark_cb (flux_t *h,
-                     flux_msg_handler_t *mh,
-                     const flux_msg_t *msg,
-                     void *arg)
+static void mark_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
+    struct content_sqlite *ctx = conn->ctx;
     int64_t target_epoch;
     json_t *hashes;
     size_t index;
@@ -941,23 +2142,23 @@ static void mark_cb (flux_t *h,
      * bookkeeping under synchronous=NORMAL) instead of one, roughly doubling
      * the cost of the batch.
      */
-    if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "mark: BEGIN");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+    if (sqlite3_exec (conn->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "mark: BEGIN");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     in_txn = true;
 
     /* Prepare once and re-bind/re-step per hash (reset below after each). */
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_mark_blob,
                             -1,
                             &stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "mark: preparing statement");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "mark: preparing statement");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
 
@@ -985,23 +2186,23 @@ static void mark_cb (flux_t *h,
         }
 
         if (sqlite3_bind_int64 (stmt, 1, target_epoch) != SQLITE_OK) {
-            log_sqlite_error (ctx, "mark: binding epoch");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "mark: binding epoch");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
 
         if (sqlite3_bind_text (stmt, 2, hash, hash_len, SQLITE_TRANSIENT) != SQLITE_OK) {
-            log_sqlite_error (ctx, "mark: binding hash");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "mark: binding hash");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
 
         if (sqlite3_step (stmt) != SQLITE_DONE) {
-            log_sqlite_error (ctx, "mark: executing statement");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "mark: executing statement");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
 
@@ -1009,31 +2210,31 @@ static void mark_cb (flux_t *h,
          * the epoch unchanged, so 'marked' counts only real updates.  Reset
          * the statement to reuse it for the next hash.
          */
-        marked_count += sqlite3_changes (ctx->db);
+        marked_count += sqlite3_changes (conn->db);
         sqlite3_reset (stmt);
     }
 
     sqlite3_finalize (stmt);
     stmt = NULL;
-    if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "mark: COMMIT");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+    if (sqlite3_exec (conn->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "mark: COMMIT");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     in_txn = false;
 
-    if (flux_respond_pack (h, msg, "{s:i}", "marked", marked_count) < 0)
-        flux_log_error (h, "mark: flux_respond_pack");
+    if (conn_respond_pack (conn, msg, "{s:i}", "marked", marked_count) < 0)
+        conn_log_error (conn, "mark: flux_respond_pack");
     return;
 
 error:
     if (stmt)
         sqlite3_finalize (stmt);
     if (in_txn)
-        sqlite3_exec (ctx->db, "ROLLBACK", NULL, NULL, NULL);
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "mark: flux_respond_error");
+        sqlite3_exec (conn->db, "ROLLBACK", NULL, NULL, NULL);
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "mark: flux_respond_error");
 }
 
 /* content-backing.sweep - delete a bounded batch of blobs with epoch < H
@@ -1059,12 +2260,8 @@ error:
  * so, since epochs only rise), so it is never rescanned.  Bounding at
  * high_water keeps the sweep from chasing blobs stored after the run began.
  */
-static void sweep_cb (flux_t *h,
-                      flux_msg_handler_t *mh,
-                      const flux_msg_t *msg,
-                      void *arg)
+static void sweep_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
     int64_t threshold_epoch;
     int64_t cursor;
     int64_t high_water;
@@ -1116,65 +2313,65 @@ static void sweep_cb (flux_t *h,
      * the SELECT fully before issuing any DELETE avoids modifying the table
      * while a scan against it is open (undefined behavior in SQLite).
      */
-    if (sqlite3_prepare_v2 (ctx->db, sql_sweep_select, -1, &select_stmt, NULL)
+    if (sqlite3_prepare_v2 (conn->db, sql_sweep_select, -1, &select_stmt, NULL)
             != SQLITE_OK) {
-        log_sqlite_error (ctx, "sweep: preparing select");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "sweep: preparing select");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     if (sqlite3_bind_int64 (select_stmt, 1, threshold_epoch) != SQLITE_OK
         || sqlite3_bind_int64 (select_stmt, 2, cursor) != SQLITE_OK
         || sqlite3_bind_int64 (select_stmt, 3, scan_limit) != SQLITE_OK
         || sqlite3_bind_int (select_stmt, 4, delete_cap) != SQLITE_OK) {
-        log_sqlite_error (ctx, "sweep: binding select");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "sweep: binding select");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     while ((rc = sqlite3_step (select_stmt)) == SQLITE_ROW)
         rowids[n++] = sqlite3_column_int64 (select_stmt, 0);
     if (rc != SQLITE_DONE) {
-        log_sqlite_error (ctx, "sweep: executing select");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "sweep: executing select");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     sqlite3_finalize (select_stmt);
     select_stmt = NULL;
 
     /* Delete the collected rowids in one transaction (as in mark_cb). */
-    if (sqlite3_prepare_v2 (ctx->db, sql_sweep_delete, -1, &delete_stmt, NULL)
+    if (sqlite3_prepare_v2 (conn->db, sql_sweep_delete, -1, &delete_stmt, NULL)
             != SQLITE_OK) {
-        log_sqlite_error (ctx, "sweep: preparing delete");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "sweep: preparing delete");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
-    if (sqlite3_exec (ctx->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "sweep: BEGIN");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+    if (sqlite3_exec (conn->db, "BEGIN", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "sweep: BEGIN");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     in_txn = true;
     for (i = 0; i < n; i++) {
         if (sqlite3_bind_int64 (delete_stmt, 1, rowids[i]) != SQLITE_OK
             || sqlite3_step (delete_stmt) != SQLITE_DONE) {
-            log_sqlite_error (ctx, "sweep: executing delete");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "sweep: executing delete");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
-        deleted += sqlite3_changes (ctx->db);
+        deleted += sqlite3_changes (conn->db);
         sqlite3_reset (delete_stmt);
     }
     sqlite3_finalize (delete_stmt);
     delete_stmt = NULL;
-    if (sqlite3_exec (ctx->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "sweep: COMMIT");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+    if (sqlite3_exec (conn->db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "sweep: COMMIT");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     in_txn = false;
@@ -1190,12 +2387,12 @@ static void sweep_cb (flux_t *h,
         cursor = scan_limit;
 
     free (rowids);
-    if (flux_respond_pack (h,
+    if (conn_respond_pack (conn,
                            msg,
                            "{s:I s:I}",
                            "deleted", deleted,
                            "cursor", cursor) < 0)
-        flux_log_error (h, "sweep: flux_respond_pack");
+        conn_log_error (conn, "sweep: flux_respond_pack");
     return;
 
 error:
@@ -1204,10 +2401,10 @@ error:
     if (delete_stmt)
         sqlite3_finalize (delete_stmt);
     if (in_txn)
-        sqlite3_exec (ctx->db, "ROLLBACK", NULL, NULL, NULL);
+        sqlite3_exec (conn->db, "ROLLBACK", NULL, NULL, NULL);
     free (rowids);
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "sweep: flux_respond_error");
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "sweep: flux_respond_error");
 }
 
 /* content-backing.gc-info - get GC information
@@ -1222,21 +2419,18 @@ error:
  *
  * 'candidates' (the count of blobs with epoch < the requested threshold) is
  * only computed and returned when 'get_count' is true.  It requires a COUNT(*)
- * over the objects table -- an UNBOUNDED full-table scan that runs synchronously
- * on this module's single reactor thread, blocking all other content traffic
- * for its duration.  On a large production store that stall can be seconds or
+ * over the objects table -- an UNBOUNDED full-table scan that runs on this
+ * module's single writer thread, blocking all other writes for its
+ * duration.  On a large production store that stall can be seconds or
  * more, so 'get_count' must NOT be used on a hot path.  flux-gc never sets it
  * (it reads only current_epoch and high_water, and the count is not even a
  * meaningful "reclaimable" estimate before the mark phase runs, since it
  * includes reachable data); the count exists solely for the test suite and
  * deliberate, low-frequency ad-hoc inspection where the stall is acceptable.
  */
-static void gc_info_cb (flux_t *h,
-                        flux_msg_handler_t *mh,
-                        const flux_msg_t *msg,
-                        void *arg)
+static void gc_info_cb (struct dbconn *conn, const flux_msg_t *msg)
 {
-    struct content_sqlite *ctx = arg;
+    struct content_sqlite *ctx = conn->ctx;
     int64_t threshold_epoch;
     int get_count = 0;
     sqlite3_stmt *stmt = NULL;
@@ -1254,97 +2448,98 @@ static void gc_info_cb (flux_t *h,
         goto error;
 
     /* MAX(rowid); NULL (empty table) reads back as 0 via column_int64. */
-    if (sqlite3_prepare_v2 (ctx->db, sql_max_rowid, -1, &hw_stmt, NULL)
+    if (sqlite3_prepare_v2 (conn->db, sql_max_rowid, -1, &hw_stmt, NULL)
             != SQLITE_OK
         || sqlite3_step (hw_stmt) != SQLITE_ROW) {
-        log_sqlite_error (ctx, "gc-info: querying high_water");
-        set_errno_from_sqlite_error (ctx);
-        errstr = set_text_from_sqlite_error (ctx, &error);
+        log_sqlite_error (conn, "gc-info: querying high_water");
+        set_errno_from_sqlite_error (conn);
+        errstr = set_text_from_sqlite_error (conn, &error);
         goto error;
     }
     high_water = sqlite3_column_int64 (hw_stmt, 0);
 
     if (get_count) {
-        /* Unbounded full-table scan on the reactor thread -- test / ad-hoc
+        /* Unbounded full-table scan on the writer thread -- test / ad-hoc
          * inspection only, never a hot path (see function comment).
          */
-        if (sqlite3_prepare_v2 (ctx->db,
+        if (sqlite3_prepare_v2 (conn->db,
                                 sql_count_sweep_candidates,
                                 -1,
                                 &stmt,
                                 NULL) != SQLITE_OK) {
-            log_sqlite_error (ctx, "gc-info: preparing statement");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "gc-info: preparing statement");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
 
         if (sqlite3_bind_int64 (stmt, 1, threshold_epoch) != SQLITE_OK) {
-            log_sqlite_error (ctx, "gc-info: binding epoch");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "gc-info: binding epoch");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
 
         if (sqlite3_step (stmt) != SQLITE_ROW) {
-            log_sqlite_error (ctx, "gc-info: executing statement");
-            set_errno_from_sqlite_error (ctx);
-            errstr = set_text_from_sqlite_error (ctx, &error);
+            log_sqlite_error (conn, "gc-info: executing statement");
+            set_errno_from_sqlite_error (conn);
+            errstr = set_text_from_sqlite_error (conn, &error);
             goto error;
         }
 
         candidates = sqlite3_column_int64 (stmt, 0);
     }
 
-    if (flux_respond_pack (h,
+    if (conn_respond_pack (conn,
                            msg,
                            get_count ? "{s:I s:I s:I}" : "{s:I s:I}",
                            "current_epoch", ctx->current_epoch,
                            "high_water", high_water,
                            "candidates", candidates) < 0)
-        flux_log_error (h, "gc-info: flux_respond_pack");
+        conn_log_error (conn, "gc-info: flux_respond_pack");
 
     sqlite3_finalize (hw_stmt);
     sqlite3_finalize (stmt);
     return;
 
 error:
-    if (flux_respond_error (h, msg, errno, errstr) < 0)
-        flux_log_error (h, "gc-info: flux_respond_error");
+    if (conn_respond_error (conn, msg, errno, errstr) < 0)
+        conn_log_error (conn, "gc-info: flux_respond_error");
     if (hw_stmt)
         sqlite3_finalize (hw_stmt);
     if (stmt)
         sqlite3_finalize (stmt);
 }
 
-/* Check if epoch column exists in objects table.
+/* Check if column 'name' exists in objects table.
  * Returns 1 if exists, 0 if not, -1 on error.
  */
-static int epoch_column_exists (struct content_sqlite *ctx)
+static int column_exists (struct content_sqlite *ctx, const char *name)
 {
+    struct dbconn *conn = &ctx->writer;
     sqlite3_stmt *stmt = NULL;
     int exists = 0;
     int rc;
 
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_table_info,
                             -1,
                             &stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing table_info query");
+        log_sqlite_error (conn, "preparing table_info query");
         return -1;
     }
 
     while ((rc = sqlite3_step (stmt)) == SQLITE_ROW) {
         const unsigned char *col_name = sqlite3_column_text (stmt, 1);
-        if (col_name && streq ((const char *)col_name, "epoch")) {
+        if (col_name && streq ((const char *)col_name, name)) {
             exists = 1;
             break;
         }
     }
 
     if (rc != SQLITE_DONE && rc != SQLITE_ROW) {
-        log_sqlite_error (ctx, "querying table_info");
+        log_sqlite_error (conn, "querying table_info");
         sqlite3_finalize (stmt);
         return -1;
     }
@@ -1353,28 +2548,27 @@ static int epoch_column_exists (struct content_sqlite *ctx)
     return exists;
 }
 
-/* Add epoch column to objects table if it doesn't exist.
+/* Add column 'name' to objects table with 'sql' if it doesn't exist.
  */
-static int migrate_add_epoch_column (struct content_sqlite *ctx)
+static int migrate_add_column (struct content_sqlite *ctx,
+                               const char *name,
+                               const char *sql)
 {
-    int exists = epoch_column_exists (ctx);
+    struct dbconn *conn = &ctx->writer;
+    int exists = column_exists (ctx, name);
 
     if (exists < 0)
         return -1;
 
     if (exists) {
-        flux_log (ctx->h, LOG_DEBUG, "epoch column already exists");
+        flux_log (ctx->h, LOG_DEBUG, "%s column already exists", name);
         return 0;
     }
 
-    flux_log (ctx->h, LOG_INFO, "adding epoch column to objects table");
-    if (sqlite3_exec (ctx->db,
-                      sql_alter_objects_add_epoch,
-                      NULL,
-                      NULL,
-                      NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "adding epoch column");
-        set_errno_from_sqlite_error (ctx);
+    flux_log (ctx->h, LOG_INFO, "adding %s column to objects table", name);
+    if (sqlite3_exec (conn->db, sql, NULL, NULL, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "adding %s column", name);
+        set_errno_from_sqlite_error (conn);
         return -1;
     }
 
@@ -1386,15 +2580,16 @@ static int migrate_add_epoch_column (struct content_sqlite *ctx)
  */
 static int init_current_epoch (struct content_sqlite *ctx)
 {
+    struct dbconn *conn = &ctx->writer;
     sqlite3_stmt *stmt = NULL;
     int rc;
 
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_get_max_checkpt_id,
                             -1,
                             &stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing get_max_checkpt_id query");
+        log_sqlite_error (conn, "preparing get_max_checkpt_id query");
         return -1;
     }
 
@@ -1408,7 +2603,7 @@ static int init_current_epoch (struct content_sqlite *ctx)
         }
     }
     else {
-        log_sqlite_error (ctx, "querying max checkpoint id");
+        log_sqlite_error (conn, "querying max checkpoint id");
         sqlite3_finalize (stmt);
         return -1;
     }
@@ -1421,10 +2616,54 @@ static int init_current_epoch (struct content_sqlite *ctx)
     return 0;
 }
 
+/* Make the most recently trained dictionary current for compression.
+ */
+static int dict_load_current (struct content_sqlite *ctx)
+{
+#if HAVE_ZSTD
+    struct dbconn *conn = &ctx->writer;
+    sqlite3_stmt *stmt = NULL;
+    int rc = -1;
+
+    if (sqlite3_prepare_v2 (conn->db,
+                            sql_dict_get_latest,
+                            -1,
+                            &stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "preparing dict_get_latest query");
+        return -1;
+    }
+    switch (sqlite3_step (stmt)) {
+        case SQLITE_ROW:
+            if (dict_set_current (conn,
+                                  sqlite3_column_int64 (stmt, 0),
+                                  sqlite3_column_blob (stmt, 1),
+                                  sqlite3_column_bytes (stmt, 1)) < 0) {
+                flux_log_error (ctx->h, "loading dictionary");
+                goto done;
+            }
+            flux_log (ctx->h, LOG_DEBUG, "using dictionary %u", ctx->dict_id);
+            break;
+        case SQLITE_DONE:
+            break;
+        default:
+            log_sqlite_error (conn, "querying latest dictionary");
+            goto done;
+    }
+    rc = 0;
+done:
+    sqlite3_finalize (stmt);
+    return rc;
+#else
+    return 0;
+#endif
+}
+
 /* Open the database file ctx->dbfile and set up the database.
  */
 static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
 {
+    struct dbconn *conn = &ctx->writer;
     int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE;
     char s[128];
     int64_t count;
@@ -1432,154 +2671,182 @@ static int content_sqlite_opendb (struct content_sqlite *ctx, bool truncate)
     if (truncate)
         (void)unlink (ctx->dbfile);
 
-    if (sqlite3_open_v2 (ctx->dbfile, &ctx->db, flags, NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "opening %s", ctx->dbfile);
+    /* Readers require WAL so they are not blocked by the writer, and
+     * a sqlite library built for concurrent use by multiple threads.
+     */
+    if (!streq (ctx->journal_mode, "WAL") || !sqlite3_threadsafe ())
+        ctx->reader_count = 0;
+
+    if (sqlite3_open_v2 (ctx->dbfile, &conn->db, flags, NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "opening %s", ctx->dbfile);
         goto error;
     }
     snprintf (s, sizeof (s), "PRAGMA journal_mode=%s", ctx->journal_mode);
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       s,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "setting sqlite 'journal_mode' pragma");
+        log_sqlite_error (conn, "setting sqlite 'journal_mode' pragma");
         goto error;
     }
     snprintf (s, sizeof (s), "PRAGMA synchronous=%s", ctx->synchronous);
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       s,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "setting sqlite 'synchronous' pragma");
+        log_sqlite_error (conn, "setting sqlite 'synchronous' pragma");
         goto error;
     }
-    if (sqlite3_exec (ctx->db,
-                      "PRAGMA locking_mode=EXCLUSIVE",
+    /* Exclusive locking keeps other processes out of the database, but
+     * would also lock out this module's reader connections.
+     */
+    snprintf (s,
+              sizeof (s),
+              "PRAGMA locking_mode=%s",
+              ctx->reader_count > 0 ? "NORMAL" : "EXCLUSIVE");
+    if (sqlite3_exec (conn->db,
+                      s,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "setting sqlite 'locking_mode' pragma");
+        log_sqlite_error (conn, "setting sqlite 'locking_mode' pragma");
         goto error;
     }
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       "PRAGMA quick_check",
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "setting sqlite 'quick_check' pragma");
+        log_sqlite_error (conn, "setting sqlite 'quick_check' pragma");
         goto error;
     }
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       sql_create_table,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "creating object table");
+        log_sqlite_error (conn, "creating object table");
         goto error;
     }
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       sql_create_table_checkpt_v2,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "creating checkpt table");
+        log_sqlite_error (conn, "creating checkpt table");
+        goto error;
+    }
+    if (sqlite3_exec (conn->db,
+                      sql_create_table_dicts,
+                      NULL,
+                      NULL,
+                      NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "creating dicts table");
         goto error;
     }
-    if (migrate_add_epoch_column (ctx) < 0)
+    if (migrate_add_column (ctx, "epoch", sql_alter_objects_add_epoch) < 0
+        || migrate_add_column (ctx, "codec", sql_alter_objects_add_codec) < 0)
         goto error;
     if (init_current_epoch (ctx) < 0)
         goto error;
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_load,
                             -1,
-                            &ctx->load_stmt,
+                            &conn->load_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing load stmt");
+        log_sqlite_error (conn, "preparing load stmt");
         goto error;
     }
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_store,
                             -1,
                             &ctx->store_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing store stmt");
+        log_sqlite_error (conn, "preparing store stmt");
         goto error;
     }
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_validate,
                             -1,
-                            &ctx->validate_stmt,
+                            &conn->validate_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing validate stmt");
+        log_sqlite_error (conn, "preparing validate stmt");
         goto error;
     }
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_checkpt_get_v2,
                             -1,
                             &ctx->checkpt_get_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing checkpt_get stmt");
+        log_sqlite_error (conn, "preparing checkpt_get stmt");
         goto error;
     }
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_checkpt_put_v2,
                             -1,
                             &ctx->checkpt_put_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing checkpt_put stmt");
+        log_sqlite_error (conn, "preparing checkpt_put stmt");
         goto error;
     }
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_checkpt_prune,
                             -1,
                             &ctx->checkpt_prune_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing checkpt prune stmt");
+        log_sqlite_error (conn, "preparing checkpt prune stmt");
         goto error;
     }
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_checkpt_get_all,
                             -1,
                             &ctx->checkpt_get_all_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing checkpt get_all stmt");
+        log_sqlite_error (conn, "preparing checkpt get_all stmt");
         goto error;
     }
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       sql_objects_count,
                       set_count,
                       &count,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "querying objects count");
+        log_sqlite_error (conn, "querying objects count");
         goto error;
     }
+    if (ctx->codec == CODEC_ZSTD && dict_load_current (ctx) < 0)
+        goto error;
     flux_log (ctx->h,
               LOG_DEBUG,
-              "%s (%jd objects) journal_mode=%s synchronous=%s",
+              "%s (%jd objects) journal_mode=%s synchronous=%s readers=%d"
+              " codec=%s",
               ctx->dbfile,
               (intmax_t)count,
               ctx->journal_mode,
-              ctx->synchronous);
+              ctx->synchronous,
+              ctx->reader_count,
+              codec_names[ctx->codec]);
     return 0;
 error:
-    set_errno_from_sqlite_error (ctx);
+    set_errno_from_sqlite_error (conn);
     return -1;
 }
 
 static int content_sqlite_checkpt_migrate (struct content_sqlite *ctx)
 {
+    struct dbconn *conn = &ctx->writer;
     sqlite3_stmt *checkpt_get_v1_stmt = NULL;
     json_t *o = NULL;
     const char *s;
     int rv = -1;
 
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_checkpt_get_v1,
                             -1,
                             &checkpt_get_v1_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing checkpt_get migrate stmt");
+        log_sqlite_error (conn, "preparing checkpt_get migrate stmt");
         goto error;
     }
 
@@ -1588,8 +2855,8 @@ static int content_sqlite_checkpt_migrate (struct content_sqlite *ctx)
                            (char *)KVS_DEFAULT_CHECKPOINT,
                            strlen (KVS_DEFAULT_CHECKPOINT),
                            SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt migrate: binding key");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "checkpt migrate: binding key");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
 
@@ -1612,14 +2879,14 @@ static int content_sqlite_checkpt_migrate (struct content_sqlite *ctx)
                            s,
                            strlen (s),
                            SQLITE_STATIC) != SQLITE_OK) {
-        log_sqlite_error (ctx, "checkpt_put: binding value");
-        set_errno_from_sqlite_error (ctx);
+        log_sqlite_error (conn, "checkpt_put: binding value");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
     if (sqlite3_step (ctx->checkpt_put_stmt) != SQLITE_DONE
-                    && sqlite3_errcode (ctx->db) != SQLITE_CONSTRAINT) {
-        log_sqlite_error (ctx, "checkpt_put: executing stmt");
-        set_errno_from_sqlite_error (ctx);
+                    && sqlite3_errcode (conn->db) != SQLITE_CONSTRAINT) {
+        log_sqlite_error (conn, "checkpt_put: executing stmt");
+        set_errno_from_sqlite_error (conn);
         goto error;
     }
 
@@ -1627,19 +2894,19 @@ static int content_sqlite_checkpt_migrate (struct content_sqlite *ctx)
     (void )sqlite3_reset (ctx->checkpt_put_stmt);
 
 drop:
-    if (sqlite3_exec (ctx->db,
+    if (sqlite3_exec (conn->db,
                       sql_drop_checkpt,
                       NULL,
                       NULL,
                       NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "drop checkpt");
+        log_sqlite_error (conn, "drop checkpt");
         goto error;
     }
     rv = 0;
 error:
     if (checkpt_get_v1_stmt) {
         if (sqlite3_finalize (checkpt_get_v1_stmt) != SQLITE_OK)
-            log_sqlite_error (ctx, "sqlite_finalize checkpt_get_v1_stmt");
+            log_sqlite_error (conn, "sqlite_finalize checkpt_get_v1_stmt");
     }
     json_decref (o);
     return rv;
@@ -1649,15 +2916,16 @@ static int content_sqlite_table_exists (struct content_sqlite *ctx,
                                         const char *table_name,
                                         bool *exists)
 {
+    struct dbconn *conn = &ctx->writer;
     sqlite3_stmt *table_list_stmt = NULL;
     int rv = 0;
 
-    if (sqlite3_prepare_v2 (ctx->db,
+    if (sqlite3_prepare_v2 (conn->db,
                             sql_table_list,
                             -1,
                             &table_list_stmt,
                             NULL) != SQLITE_OK) {
-        log_sqlite_error (ctx, "preparing sql_table_list stmt");
+        log_sqlite_error (conn, "preparing sql_table_list stmt");
         goto cleanup;
     }
 
@@ -1679,18 +2947,210 @@ static int content_sqlite_table_exists (struct content_sqlite *ctx,
 cleanup:
     if (table_list_stmt) {
         if (sqlite3_finalize (table_list_stmt) != SQLITE_OK)
-            log_sqlite_error (ctx, "sqlite_finalize table_list_stmt");
+            log_sqlite_error (conn, "sqlite_finalize table_list_stmt");
     }
     return rv;
 }
 
+/* Hand a finished job back to the reactor.  The eventfd is only written
+ * when the done list goes from empty to non-empty, since the reactor
+ * consumes the whole list each time it is woken.
+ */
+static void dbjob_complete (struct content_sqlite *ctx, struct dbjob *job)
+{
+    bool was_empty;
+
+    pthread_mutex_lock (&ctx->done_lock);
+    was_empty = list_empty (&ctx->done);
+    list_add_tail (&ctx->done, &job->list);
+    pthread_mutex_unlock (&ctx->done_lock);
+    if (was_empty) {
+        uint64_t val = 1;
+        if (write (ctx->done_fd, &val, sizeof (val)) < 0)
+            abort (); // only fails if the counter would overflow
+    }
+}
+
+static void *dbconn_thread (void *arg)
+{
+    struct dbconn *conn = arg;
+    struct dbjob *job;
+
+    while ((job = dbqueue_pop (conn->queue))) {
+        conn->job = job;
+        job->fn (conn, job->msg);
+        conn->job = NULL;
+        dbjob_complete (conn->ctx, job);
+    }
+    return NULL;
+}
+
+/* Log messages and send responses for completed jobs.
+ */
+static void process_done (struct content_sqlite *ctx)
+{
+    LIST_HEAD (done);
+    struct dbjob *job;
+
+    pthread_mutex_lock (&ctx->done_lock);
+    list_append_list (&done, &ctx->done);
+    pthread_mutex_unlock (&ctx->done_lock);
+
+    while ((job = list_pop (&done, struct dbjob, list))) {
+        struct dblog *log;
+
+        list_for_each (&job->logs, log, list)
+            flux_log (ctx->h, log->level, "%s", log->text);
+        if (job->response && flux_send_new (ctx->h, &job->response, 0) < 0)
+            flux_log_error (ctx->h, "error sending response");
+        dbjob_destroy (job);
+    }
+}
+
+static void done_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    struct content_sqlite *ctx = arg;
+    uint64_t val;
+
+    if (read (ctx->done_fd, &val, sizeof (val)) < 0
+        && errno != EAGAIN
+        && errno != EWOULDBLOCK)
+        flux_log_error (ctx->h, "error reading from eventfd");
+    process_done (ctx);
+}
+
+static int dbconn_open_reader (struct content_sqlite *ctx,
+                               struct dbconn *conn)
+{
+    conn->ctx = ctx;
+    conn->queue = &ctx->readq;
+    if (!(conn->lzo_buf = calloc (1, lzo_buf_chunksize)))
+        return -1;
+    conn->lzo_bufsize = lzo_buf_chunksize;
+    if (sqlite3_open_v2 (ctx->dbfile,
+                         &conn->db,
+                         SQLITE_OPEN_READONLY,
+                         NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "opening %s read-only", ctx->dbfile);
+        goto error;
+    }
+    if (sqlite3_prepare_v2 (conn->db,
+                            sql_load,
+                            -1,
+                            &conn->load_stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "preparing reader load stmt");
+        goto error;
+    }
+    if (sqlite3_prepare_v2 (conn->db,
+                            sql_validate,
+                            -1,
+                            &conn->validate_stmt,
+                            NULL) != SQLITE_OK) {
+        log_sqlite_error (conn, "preparing reader validate stmt");
+        goto error;
+    }
+    return 0;
+error:
+    set_errno_from_sqlite_error (conn);
+    return -1;
+}
+
+static int dbconn_start (struct dbconn *conn)
+{
+    int e;
+
+    if ((e = pthread_create (&conn->thread, NULL, dbconn_thread, conn))) {
+        errno = e;
+        return -1;
+    }
+    conn->started = true;
+    return 0;
+}
+
+/* Open reader connections (the writer was opened by
+ * content_sqlite_opendb()) and start the database threads.
+ */
+static int content_sqlite_start (struct content_sqlite *ctx)
+{
+    int i;
+
+    if (ctx->reader_count > 0) {
+        if (!(ctx->readers = calloc (ctx->reader_count,
+                                     sizeof (ctx->readers[0]))))
+            return -1;
+        for (i = 0; i < ctx->reader_count; i++) {
+            if (dbconn_open_reader (ctx, &ctx->readers[i]) < 0)
+                return -1;
+        }
+    }
+    if (dbconn_start (&ctx->writer) < 0) {
+        flux_log_error (ctx->h, "error starting writer thread");
+        return -1;
+    }
+    for (i = 0; i < ctx->reader_count; i++) {
+        if (dbconn_start (&ctx->readers[i]) < 0) {
+            flux_log_error (ctx->h, "error starting reader thread");
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Let the database threads finish queued work and exit, then log and send
+ * responses for what they completed.
+ */
+static void content_sqlite_stop (struct content_sqlite *ctx)
+{
+    int i;
+
+    dbqueue_shutdown (&ctx->writeq);
+    dbqueue_shutdown (&ctx->readq);
+    if (ctx->writer.started) {
+        pthread_join (ctx->writer.thread, NULL);
+        ctx->writer.started = false;
+    }
+    for (i = 0; ctx->readers && i < ctx->reader_count; i++) {
+        if (ctx->readers[i].started) {
+            pthread_join (ctx->readers[i].thread, NULL);
+            ctx->readers[i].started = false;
+        }
+    }
+    process_done (ctx);
+}
+
 static void content_sqlite_destroy (struct content_sqlite *ctx)
 {
     if (ctx) {
         int saved_errno = errno;
-        flux_msg_handler_delvec (ctx->handlers);
+        struct dbjob *job;
+        for (int i = 0; i < ctx->handler_count; i++)
+            flux_msg_handler_destroy (ctx->handlers[i].mh);
+        free (ctx->handlers);
+        flux_watcher_destroy (ctx->done_w);
+        if (ctx->done_fd >= 0)
+            close (ctx->done_fd);
+        dbqueue_clean (&ctx->writeq);
+        dbqueue_clean (&ctx->readq);
+        while ((job = list_pop (&ctx->done, struct dbjob, list)))
+            dbjob_destroy (job);
+        pthread_mutex_destroy (&ctx->done_lock);
+        pthread_mutex_destroy (&ctx->stats_lock);
+#if HAVE_ZSTD
+        ZSTD_freeCDict (ctx->cdict);
+        for (int i = 0; i < ctx->ddict_count; i++)
+            ZSTD_freeDDict (ctx->ddicts[i].ddict);
+        free (ctx->ddicts);
+        pthread_mutex_destroy (&ctx->dict_lock);
+#endif
+        free (ctx->writer.lzo_buf);
+        for (int i = 0; ctx->readers && i < ctx->reader_count; i++)
+            free (ctx->readers[i].lzo_buf);
+        free (ctx->readers);
         free (ctx->dbfile);
-        free (ctx->lzo_buf);
         free (ctx->hashfun);
         free (ctx->journal_mode);
         free (ctx->synchronous);
@@ -1699,64 +3159,122 @@ static void content_sqlite_destroy (struct content_sqlite *ctx)
     }
 }
 
-static const struct flux_msg_handler_spec htab[] = {
+/* Dispatch a request to a database thread.
+ */
+static void request_cb (flux_t *h,
+                        flux_msg_handler_t *mh,
+                        const flux_msg_t *msg,
+                        void *arg)
+{
+    struct dbop_handler *oph = arg;
+    struct content_sqlite *ctx = oph->ctx;
+    struct dbjob *job;
+
+    if (!(job = dbjob_create (oph->op->fn, msg))) {
+        if (flux_respond_error (h, msg, errno, NULL) < 0)
+            flux_log_error (h, "%s: flux_respond_error", oph->op->topic);
+        return;
+    }
+    if ((oph->op->flags & DBOP_READONLY) && ctx->reader_count > 0)
+        dbqueue_push (&ctx->readq, job);
+    else
+        dbqueue_push (&ctx->writeq, job);
+}
+
+static const struct dbop dbops[] = {
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.load",
         load_cb,
+        DBOP_READONLY,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.store",
         store_cb,
+        0,
+        0
+    },
+    {
+        "content-backing.batch-store",
+        batch_store_cb,
+        0,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.validate",
         validate_cb,
+        DBOP_READONLY,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.checkpoint-get",
         checkpoint_get_cb,
+        0,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.checkpoint-put",
         checkpoint_put_cb,
+        0,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-sqlite.stats-get",
         stats_get_cb,
+        0,
         FLUX_ROLE_USER
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.mark",
         mark_cb,
+        0,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.sweep",
         sweep_cb,
+        0,
         0
     },
     {
-        FLUX_MSGTYPE_REQUEST,
         "content-backing.gc-info",
         gc_info_cb,
+        0,
+        0
+    },
+    {
+        "content-sqlite.dict-train",
+        dict_train_cb,
+        0,
         0
     },
-    FLUX_MSGHANDLER_TABLE_END,
 };
 
+static int register_handlers (struct content_sqlite *ctx)
+{
+    struct flux_match match = FLUX_MATCH_REQUEST;
+
+    if (!(ctx->handlers = calloc (ARRAY_SIZE (dbops),
+                                  sizeof (ctx->handlers[0]))))
+        return -1;
+    for (int i = 0; i < ARRAY_SIZE (dbops); i++) {
+        struct dbop_handler *oph = &ctx->handlers[i];
+
+        oph->ctx = ctx;
+        oph->op = &dbops[i];
+        match.topic_glob = dbops[i].topic;
+        if (!(oph->mh = flux_msg_handler_create (ctx->h,
+                                                 match,
+                                                 request_cb,
+                                                 oph)))
+            return -1;
+        ctx->handler_count++;
+        flux_msg_handler_allow_rolemask (oph->mh, dbops[i].rolemask);
+        flux_msg_handler_start (oph->mh);
+    }
+    return 0;
+}
+
 static struct content_sqlite *content_sqlite_create (flux_t *h)
 {
     struct content_sqlite *ctx;
@@ -1765,10 +3283,23 @@ static struct content_sqlite *content_sqlite_create (flux_t *h)
 
     if (!(ctx = calloc (1, sizeof (*ctx))))
         return NULL;
-    if (!(ctx->lzo_buf = calloc (1, lzo_buf_chunksize)))
-        goto error;
-    ctx->lzo_bufsize = lzo_buf_chunksize;
     ctx->h = h;
+    ctx->done_fd = -1;
+    dbqueue_init (&ctx->writeq);
+    dbqueue_init (&ctx->readq);
+    list_head_init (&ctx->done);
+    pthread_mutex_init (&ctx->done_lock, NULL);
+    pthread_mutex_init (&ctx->stats_lock, NULL);
+#if HAVE_ZSTD
+    pthread_mutex_init (&ctx->dict_lock, NULL);
+#endif
+    ctx->writer.ctx = ctx;
+    ctx->writer.queue = &ctx->writeq;
+    if (!(ctx->writer.lzo_buf = calloc (1, lzo_buf_chunksize)))
+        goto error;
+    ctx->writer.lzo_bufsize = lzo_buf_chunksize;
+    ctx->reader_count = READERS_DEFAULT;
+    ctx->codec = CODEC_LZ4;
     if (set_config (&ctx->journal_mode, "WAL") < 0)
         goto error;
     if (set_config (&ctx->synchronous, "NORMAL") < 0)
@@ -1817,7 +3348,15 @@ static struct content_sqlite *content_sqlite_create (flux_t *h)
         }
     }
 
-    if (flux_msg_handler_addvec (h, htab, ctx, &ctx->handlers) < 0)
+    if ((ctx->done_fd = eventfd (0, EFD_NONBLOCK | EFD_CLOEXEC)) < 0
+        || !(ctx->done_w = flux_fd_watcher_create (flux_get_reactor (h),
+                                                   ctx->done_fd,
+                                                   FLUX_POLLIN,
+                                                   done_cb,
+                                                   ctx)))
+        goto error;
+    flux_watcher_start (ctx->done_w);
+    if (register_handlers (ctx) < 0)
         goto error;
     return ctx;
 error:
@@ -1849,6 +3388,25 @@ static bool synchronous_valid (const char *s)
     return true;
 }
 
+/* Return the codec named 's', or -1 if it is unknown or unsupported.
+ */
+static int codec_parse (const char *s, flux_error_t *errp)
+{
+    for (int i = 0; i < ARRAY_SIZE (codec_names); i++) {
+        if (streq (s, codec_names[i])) {
+#if !HAVE_ZSTD
+            if (i == CODEC_ZSTD) {
+                errprintf (errp, "%s is not supported by this build", s);
+                return -1;
+            }
+#endif
+            return i;
+        }
+    }
+    errprintf (errp, "unknown codec %s", s);
+    return -1;
+}
+
 static int process_config (struct content_sqlite *ctx,
                            const flux_conf_t *conf)
 {
@@ -1856,14 +3414,18 @@ static int process_config (struct content_sqlite *ctx,
     const char *journal_mode = NULL;
     const char *synchronous = NULL;
     int tmp_max_checkpoints = ctx->max_checkpoints;
+    int readers = ctx->reader_count;
+    const char *codec = NULL;
 
     if (flux_conf_unpack (conf,
                           &error,
-                          "{s?{s?s s?s s?i}}",
+                          "{s?{s?s s?s s?i s?i s?s}}",
                           "content-sqlite",
                             "journal_mode", &journal_mode,
                             "synchronous", &synchronous,
-                            "max_checkpoints", &tmp_max_checkpoints) < 0) {
+                            "max_checkpoints", &tmp_max_checkpoints,
+                            "readers", &readers,
+                            "codec", &codec) < 0) {
         flux_log_error (ctx->h, "%s", error.text);
         return -1;
     }
@@ -1891,6 +3453,21 @@ static int process_config (struct content_sqlite *ctx,
         return -1;
     }
     ctx->max_checkpoints = tmp_max_checkpoints;
+    if (readers < 0 || readers > READERS_MAX) {
+        flux_log (ctx->h, LOG_ERR, "invalid readers config");
+        errno = EINVAL;
+        return -1;
+    }
+    ctx->reader_count = readers;
+    if (codec) {
+        int tmp;
+        if ((tmp = codec_parse (codec, &error)) < 0) {
+            flux_log (ctx->h, LOG_ERR, "invalid codec config: %s", error.text);
+            errno = EINVAL;
+            return -1;
+        }
+        ctx->codec = tmp;
+    }
 
     return 0;
 }
@@ -1934,6 +3511,35 @@ static int process_args (struct content_sqlite *ctx,
             }
             ctx->max_checkpoints = tmp_max_checkpoints;
         }
+        else if (strstarts (argv[i], "readers=")) {
+            char *endptr;
+            long readers;
+            errno = 0;
+            readers = strtol (argv[i] + 8, &endptr, 10);
+            if (errno != 0
+                || *endptr != '\0'
+                || endptr == argv[i] + 8
+                || readers < 0
+                || readers > READERS_MAX) {
+                flux_log (ctx->h, LOG_ERR, "invalid readers specified");
+                errno = EINVAL;
+                return -1;
+            }
+            ctx->reader_count = readers;
+        }
+        else if (strstarts (argv[i], "codec=")) {
+            flux_error_t error;
+            int codec;
+            if ((codec = codec_parse (argv[i] + 6, &error)) < 0) {
+                flux_log (ctx->h,
+                          LOG_ERR,
+                          "invalid codec specified: %s",
+                          error.text);
+                errno = EINVAL;
+                return -1;
+            }
+            ctx->codec = codec;
+        }
         else if (streq ("truncate", argv[i])) {
             *truncate = true;
         }
@@ -1967,6 +3573,8 @@ int mod_main (flux_t *h, int argc, char **argv)
         || (exists
             && content_sqlite_checkpt_migrate (ctx) < 0))
         goto done;
+    if (content_sqlite_start (ctx) < 0)
+        goto done;
     if (content_register_service (h, "content-backing") < 0)
         goto done;
     if (content_register_backing_store (h, "content-sqlite") < 0)
@@ -1979,6 +3587,7 @@ int mod_main (flux_t *h, int argc, char **argv)
 done_unreg:
     (void)content_unregister_backing_store (h);
 done:
+    content_sqlite_stop (ctx);
     content_sqlite_closedb (ctx);
     content_sqlite_destroy (ctx);
     return rc;
@@ -15,6 +15,7 @@
 #endif
 #include <inttypes.h>
 #include <assert.h>
+#include <arpa/inet.h>
 #include <flux/core.h>
 
 #include "src/common/libczmqcontainers/czmq_containers.h"
@@ -24,6 +25,7 @@
 #include "src/common/libutil/iterators.h"
 #include "src/common/libutil/log.h"
 #include "src/common/libcontent/content.h"
+#include "src/common/libfluxutil/dispatch_stats.h"
 #include "ccan/str/str.h"
 
 #include "cache.h"
@@ -32,7 +34,9 @@
 
 /* A periodic callback purges the cache of least recently used entries.
  * The callback is synchronized with the instance heartbeat, with a
- * sync period upper bound set to 'sync_max' seconds.
+ * sync period upper bound set to 'sync_max' seconds.  In addition, the
+ * cache size is held under 'size_limit' as entries are added, regardless
+ * of entry age.
  */
 static double sync_max = 10.;
 
@@ -40,6 +44,8 @@ static const char *default_hash = "sha1";
 
 static const uint32_t default_cache_purge_target_size = 1024*1024*16;
 static const uint32_t default_cache_purge_old_entry = 10; // seconds
+static const uint64_t default_cache_size_limit = 1024ULL*1024*1024;
+static const int dispatch_batch = 16; // max messages per reactor iteration
 
 /* Raise the max blob size value to 1GB so that large KVS values
  * (including KVS directories) can be supported while the KVS transitions
@@ -50,6 +56,17 @@ static const uint32_t default_blob_size_limit = 1048576*1024;
 
 static const uint32_t default_flush_batch_limit = 256;
 
+/* Upper bound on the payload of one content-backing.batch-store request.
+ * A larger blob is sent in a batch of its own.
+ */
+static const size_t batch_store_size_max = 1048576*16;
+
+/* Upper bound on the number of blobs in one content-backing.batch-store
+ * request, matching the limit enforced by content-sqlite.  A flush batch
+ * limit above this is split across several requests.
+ */
+static const int batch_store_count_max = 4096;
+
 /* Hash digests are used as zhashx keys.  The digest size needs to be
  * available to zhashx comparator so make this global.
  */
@@ -72,6 +89,7 @@ struct cache_entry {
     uint8_t load_pending:1;
     uint8_t store_pending:1;
     uint8_t mmapped:1;
+    uint8_t protected:1;            // entry is in protected LRU segment
     struct msgstack *load_requests;
     struct msgstack *store_requests;
     double lastused;
@@ -87,11 +105,13 @@ struct content_cache {
     uint32_t rank;
     zhashx_t *entries;
     uint8_t backing:1;              // 'content.backing' service available
+    uint8_t batch_store:1;          // backing accepts batch-store requests
     char *backing_name;
     char *hash_name;
     struct msgstack *flush_requests;
 
-    struct list_head lru;           // LRU is for valid, clean entries only
+    struct list_head probation;     // LRU segments are for valid,
+    struct list_head protected;     //   clean entries only
     struct list_head flush;         // dirties queued due to batch limit
 
     uint32_t blob_size_limit;
@@ -101,13 +121,23 @@ struct content_cache {
 
     uint32_t purge_target_size;
     uint32_t purge_old_entry;
+    uint64_t size_limit;
 
     uint64_t acct_size;             // total size of all cache entries
+    uint64_t acct_protected;        // total size of protected entries
     uint32_t acct_valid;            // count of valid cache entries
     uint32_t acct_dirty;            // count of dirty cache entries
 
+    uint64_t stats_hits;            // load requests satisfied by cache
+    uint64_t stats_misses;          // load requests sent upstream/to backing
+    uint64_t stats_evictions;       // entries removed by purge or size limit
+
     struct content_checkpoint *checkpoint;
     struct content_mmap *mmap;
+
+    flux_watcher_t *prep_w;
+    flux_watcher_t *check_w;
+    flux_watcher_t *idle_w;
 };
 
 static void flush_respond (struct content_cache *cache);
@@ -240,6 +270,62 @@ static struct cache_entry *cache_entry_create (const void *hash)
     return e;
 }
 
+/* Valid, clean entries are kept in a segmented LRU.  An entry starts out
+ * in the probation segment and is promoted to the protected segment when
+ * it is used again.  The protected segment is limited to a fraction of the
+ * purge target size, and when it overflows, its least recently used entries
+ * are demoted to probation.  Entries are evicted from probation first, so
+ * a burst of blobs that are used once, or one very large blob, displaces
+ * other probationary entries rather than frequently used ones such as
+ * KVS directories near the root.  An entry too large to fit in the
+ * protected segment is never promoted.
+ */
+static uint64_t lru_protected_limit (struct content_cache *cache)
+{
+    return (uint64_t)cache->purge_target_size * 4 / 5;
+}
+
+static void lru_insert (struct content_cache *cache, struct cache_entry *e)
+{
+    e->protected = 0;
+    list_add (&cache->probation, &e->list);
+    e->lastused = flux_reactor_now (cache->reactor);
+}
+
+static void lru_remove (struct content_cache *cache, struct cache_entry *e)
+{
+    list_del_init (&e->list);
+    if (e->protected) {
+        cache->acct_protected -= e->len;
+        e->protected = 0;
+    }
+}
+
+static void lru_touch (struct content_cache *cache, struct cache_entry *e)
+{
+    uint64_t limit = lru_protected_limit (cache);
+    struct cache_entry *victim;
+
+    list_del (&e->list);
+    if (!e->protected && e->len <= limit) {
+        e->protected = 1;
+        cache->acct_protected += e->len;
+    }
+    if (e->protected)
+        list_add (&cache->protected, &e->list);
+    else
+        list_add (&cache->probation, &e->list);
+    e->lastused = flux_reactor_now (cache->reactor);
+
+    while (cache->acct_protected > limit
+           && (victim = list_tail (&cache->protected,
+                                   struct cache_entry,
+                                   list))) {
+        lru_remove (cache, victim);
+        list_add (&cache->probation, &victim->list);
+    }
+}
+
 static void cache_entry_dirty_clear (struct content_cache *cache,
                                      struct cache_entry *e)
 {
@@ -248,8 +334,7 @@ static void cache_entry_dirty_clear (struct content_cache *cache,
         e->dirty = 0;
 
         assert (e->valid);
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
+        lru_insert (cache, e);
 
         request_list_respond_raw (&e->store_requests,
                                   cache->h,
@@ -285,7 +370,8 @@ static struct cache_entry *cache_entry_insert (struct content_cache *cache,
 }
 
 /* Look up a cache entry.
- * Move to front of LRU because it was looked up.
+ * Move to front of LRU because it was looked up.  Promote the entry to the
+ * protected LRU segment if it has been used before.
  * Returns entry on success, NULL on failure.
  * N.B. errno is not set
  */
@@ -300,11 +386,8 @@ static struct cache_entry *cache_entry_lookup (struct content_cache *cache,
     if (!(e = zhashx_lookup (cache->entries, hash)))
         return NULL;
 
-    if (e->valid && !e->dirty) {
-        list_del_from (&cache->lru, &e->list);
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
-    }
+    if (e->valid && !e->dirty)
+        lru_touch (cache, e);
 
     return e;
 }
@@ -317,7 +400,7 @@ static void cache_entry_remove (struct content_cache *cache,
     assert (e->load_requests == NULL);
     assert (e->store_requests == NULL);
     assert (!e->dirty);
-    list_del (&e->list);
+    lru_remove (cache, e);
     if (e->valid) {
         cache->acct_size -= e->len;
         cache->acct_valid--;
@@ -325,6 +408,51 @@ static void cache_entry_remove (struct content_cache *cache,
     zhashx_delete (cache->entries, e->hash);
 }
 
+/* Remove clean entries from the tail of 'segment' until the cache size
+ * is at most 'target', stopping at an entry used in the last 'min_age'
+ * seconds.
+ */
+static void lru_evict (struct content_cache *cache,
+                       struct list_head *segment,
+                       uint64_t target,
+                       double min_age)
+{
+    double now = flux_reactor_now (cache->reactor);
+    struct cache_entry *e;
+    struct cache_entry *next;
+
+    list_for_each_rev_safe (segment, e, next, list) {
+        if (cache->acct_size <= target || now - e->lastused < min_age)
+            break;
+        assert (e->valid);
+        assert (!e->dirty);
+        cache_entry_remove (cache, e);
+        cache->stats_evictions++;
+    }
+}
+
+/* Evict clean entries until the cache size is at most 'target', from the
+ * probation segment first.
+ */
+static void cache_evict (struct content_cache *cache,
+                         uint64_t target,
+                         double min_age)
+{
+    lru_evict (cache, &cache->probation, target, min_age);
+    lru_evict (cache, &cache->protected, target, min_age);
+}
+
+/* Enforce the hard size limit after the cache has grown.  Dirty entries
+ * cannot be evicted, so the limit may be exceeded while they are pending.
+ * N.B. this may evict any clean entry, so callers must not use a cache
+ * entry pointer afterwards.
+ */
+static void cache_enforce_limit (struct content_cache *cache)
+{
+    if (cache->size_limit > 0 && cache->acct_size > cache->size_limit)
+        cache_evict (cache, cache->size_limit, 0.);
+}
+
 /* Load operation
  *
  * If a cache entry is already present and valid, response is immediate.
@@ -369,14 +497,14 @@ static void cache_load_continuation (flux_future_t *f, void *arg)
             e->ephemeral = 1;
         cache->acct_valid++;
         cache->acct_size += e->len;
-        list_add (&cache->lru, &e->list);
-        e->lastused = flux_reactor_now (cache->reactor);
+        lru_insert (cache, e);
         request_list_respond_raw (&e->load_requests,
                                   cache->h,
                                   e->ephemeral ? FLUX_MSGFLAG_USER1 : 0,
                                   e->data,
                                   e->len,
                                   "load");
+        cache_enforce_limit (cache);
     }
     flux_future_destroy (f);
     return;
@@ -456,11 +584,11 @@ static void content_load_request (flux_t *h,
             e->mmapped = 1;
             cache->acct_valid++;
             cache->acct_size += e->len;
-            list_add (&cache->lru, &e->list);
-            e->lastused = flux_reactor_now (cache->reactor);
+            lru_insert (cache, e);
         }
     }
     if (!e->valid) {
+        cache->stats_misses++;
         if (cache_load (cache, e) < 0)
             goto error;
         if (msgstack_push (&e->load_requests, msg) < 0) {
@@ -469,6 +597,7 @@ static void content_load_request (flux_t *h,
         }
         return; /* RPC continuation will respond to msg */
     }
+    cache->stats_hits++;
     if (e->valid && e->mmapped) { // rank 0 only
         if (!content_mmap_validate (e->data_container,
                                     e->hash,
@@ -493,6 +622,7 @@ static void content_load_request (flux_t *h,
         flux_log_error (h, "content load: error sending response");
     }
     flux_msg_decref (response);
+    cache_enforce_limit (cache);
     return;
 error:
     if (flux_respond_error (h, msg, errno, errmsg) < 0)
@@ -605,7 +735,12 @@ static int cache_store (struct content_cache *cache, struct cache_entry *e)
     if (e->store_pending)
         return 0;
     if (cache->rank == 0) {
-        if (cache->flush_batch_count >= cache->flush_batch_limit) {
+        /* If the backing store accepts batch-store requests, queue the
+         * entry to be sent with others once the reactor has handled all
+         * pending events (see cache_check_cb()).
+         */
+        if (cache->flush_batch_count >= cache->flush_batch_limit
+            || cache->batch_store) {
             flush_list_append (cache, e);
             return 0;
         }
@@ -623,6 +758,174 @@ static int cache_store (struct content_cache *cache, struct cache_entry *e)
     return 0;
 }
 
+/* A content-backing.batch-store request stores many blobs in one backing
+ * store transaction, avoiding per-blob commit overhead when the cache is
+ * flushing a burst of dirty entries.
+ *
+ * Request payload: for each blob, 4 byte size (network order), then data.
+ * Response payload: for each blob, in request order, 4 byte errno (network
+ * order), then the blob's hash (zeroed if errno is nonzero).
+ */
+struct store_batch {
+    int count;
+    struct cache_entry *entries[];
+};
+
+static void cache_store_batch_continuation (flux_future_t *f, void *arg)
+{
+    struct content_cache *cache = arg;
+    struct store_batch *b = flux_future_aux_get (f, "batch");
+    const uint8_t *buf;
+    size_t size;
+    int i;
+
+    assert (cache->flush_batch_count >= b->count);
+    cache->flush_batch_count -= b->count;
+    for (i = 0; i < b->count; i++)
+        b->entries[i]->store_pending = 0;
+    if (flux_rpc_get_raw (f, (const void **)&buf, &size) < 0) {
+        /* A backing module that does not implement batch-store fails
+         * with ENOSYS.  Fall back to storing one blob per request.
+         * If the backing store itself is gone, those will fail too.
+         */
+        if (errno == ENOSYS && cache->batch_store) {
+            flux_log (cache->h,
+                      LOG_DEBUG,
+                      "content store: %s",
+                      "backing store does not support batch-store");
+            cache->batch_store = 0;
+            for (i = 0; i < b->count; i++)
+                flush_list_append (cache, b->entries[i]);
+            goto done;
+        }
+        flux_log (cache->h, LOG_CRIT, "content store: %s", strerror (errno));
+        goto error;
+    }
+    if (size != b->count * (4 + content_hash_size)) {
+        flux_log (cache->h,
+                  LOG_CRIT,
+                  "content store: %s",
+                  "malformed batch-store response");
+        errno = EPROTO;
+        goto error;
+    }
+    for (i = 0; i < b->count; i++) {
+        struct cache_entry *e = b->entries[i];
+        const uint8_t *rec = buf + i * (4 + content_hash_size);
+        uint32_t errnum;
+
+        memcpy (&errnum, rec, sizeof (errnum));
+        errnum = ntohl (errnum);
+        if (errnum == 0
+            && memcmp (rec + 4, e->hash, content_hash_size) != 0)
+            errnum = EIO;
+        if (errnum != 0) {
+            flux_log (cache->h,
+                      LOG_CRIT,
+                      "content store: %s",
+                      strerror (errnum));
+            request_list_respond_error (&e->store_requests,
+                                        cache->h,
+                                        errnum,
+                                        NULL,
+                                        "store");
+            request_list_respond_error (&cache->flush_requests,
+                                        cache->h,
+                                        errnum,
+                                        NULL,
+                                        "flush");
+            cache->flush_errno = errnum;
+            continue;
+        }
+        cache_entry_dirty_clear (cache, e);
+        cache->flush_errno = 0;
+    }
+    goto done;
+error:
+    for (i = 0; i < b->count; i++) {
+        request_list_respond_error (&b->entries[i]->store_requests,
+                                    cache->h,
+                                    errno,
+                                    NULL,
+                                    "store");
+    }
+    request_list_respond_error (&cache->flush_requests,
+                                cache->h,
+                                errno,
+                                NULL,
+                                "flush");
+    cache->flush_errno = errno;
+done:
+    flux_future_destroy (f);
+    cache_resume_flush (cache);
+}
+
+/* Send entries from the head of the flush list in one batch-store request,
+ * subject to the flush batch limit and the per-request maximums.
+ */
+static int cache_store_batch (struct content_cache *cache)
+{
+    struct store_batch *b = NULL;
+    struct cache_entry *e;
+    uint8_t *buf = NULL;
+    size_t size = 0;
+    size_t offset = 0;
+    flux_future_t *f = NULL;
+    int count = 0;
+    int i;
+
+    list_for_each (&cache->flush, e, list) {
+        if (cache->flush_batch_count + count >= cache->flush_batch_limit
+            || count >= batch_store_count_max
+            || (count > 0 && size + 4 + e->len > batch_store_size_max))
+            break;
+        size += 4 + e->len;
+        count++;
+    }
+    if (count == 0)
+        return 0;
+    if (!(b = calloc (1, sizeof (*b) + count * sizeof (b->entries[0])))
+        || !(buf = malloc (size)))
+        goto error;
+    e = list_top (&cache->flush, struct cache_entry, list);
+    for (i = 0; i < count; i++) {
+        uint32_t len = htonl (e->len);
+
+        assert (e->valid);
+        memcpy (buf + offset, &len, sizeof (len));
+        memcpy (buf + offset + 4, e->data, e->len);
+        offset += 4 + e->len;
+        b->entries[i] = e;
+        e = list_next (&cache->flush, e, list);
+    }
+    b->count = count;
+    if (!(f = flux_rpc_raw (cache->h,
+                            "content-backing.batch-store",
+                            buf,
+                            size,
+                            0,
+                            0))
+        || flux_future_aux_set (f, "batch", b, free) < 0)
+        goto error;
+    b = NULL; // owned by 'f' now
+    if (flux_future_then (f, -1., cache_store_batch_continuation, cache) < 0)
+        goto error;
+    b = flux_future_aux_get (f, "batch");
+    for (i = 0; i < count; i++) {
+        list_del_init (&b->entries[i]->list);
+        b->entries[i]->store_pending = 1;
+    }
+    cache->flush_batch_count += count;
+    free (buf);
+    return 0;
+error:
+    flux_log_error (cache->h, "content store");
+    flux_future_destroy (f);
+    ERRNO_SAFE_WRAP (free, b);
+    ERRNO_SAFE_WRAP (free, buf);
+    return -1;
+}
+
 static void content_store_request (flux_t *h,
                                    flux_msg_handler_t *mh,
                                    const flux_msg_t *msg,
@@ -687,7 +990,7 @@ static void content_store_request (flux_t *h,
      * ensuring all referenced blobs are eventually persisted.
      */
     else if (!e->dirty) {
-        list_del (&e->list);  // remove from LRU
+        lru_remove (cache, e);
         e->dirty = 1;
         cache->acct_dirty++;
     }
@@ -710,6 +1013,7 @@ static void content_store_request (flux_t *h,
     }
     if (flux_respond_raw (h, msg, hash, hash_size) < 0)
         flux_log_error (h, "content store: flux_respond_raw");
+    cache_enforce_limit (cache);
     return;
 error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
@@ -729,6 +1033,15 @@ static int cache_flush (struct content_cache *cache)
     int last_errno = 0;
     int rc = 0;
 
+    if (cache->rank == 0 && cache->backing && cache->batch_store) {
+        while (cache->flush_batch_count < cache->flush_batch_limit
+               && !list_empty (&cache->flush)) {
+            if (cache_store_batch (cache) < 0)
+                return -1;
+        }
+        return 0;
+    }
+
     while (cache->flush_batch_count < cache->flush_batch_limit) {
         if (!(e = list_top (&cache->flush, struct cache_entry, list)))
             break;
@@ -792,6 +1105,7 @@ static void content_register_backing_request (flux_t *h,
         goto error;
     }
     cache->backing = 1;
+    cache->batch_store = 1;
     flux_log (h, LOG_DEBUG, "content backing store: enabled %s", name);
     if (flux_respond (h, msg, NULL) < 0)
         flux_log_error (h, "error responding to register-backing request");
@@ -854,7 +1168,10 @@ static void content_dropcache_request (flux_t *h,
 
     orig_size = zhashx_size (cache->entries);
 
-    list_for_each_safe (&cache->lru, e, next, list) {
+    list_for_each_safe (&cache->probation, e, next, list) {
+        cache_entry_remove (cache, e);
+    }
+    list_for_each_safe (&cache->protected, e, next, list) {
         cache_entry_remove (cache, e);
     }
 
@@ -874,18 +1191,26 @@ static void content_stats_request (flux_t *h,
 {
     struct content_cache *cache = arg;
     json_t *o = content_mmap_get_stats (cache->mmap);
+    json_t *d = dispatch_stats_encode (h);
 
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:i s:i s:I s:i s:O}",
+                           "{s:i s:i s:i s:I s:I s:I s:I s:I s:I s:i s:O s:O}",
                            "count", zhashx_size (cache->entries),
                            "valid", cache->acct_valid,
                            "dirty", cache->acct_dirty,
                            "size", cache->acct_size,
+                           "protected-size", cache->acct_protected,
+                           "size-limit", cache->size_limit,
+                           "hits", cache->stats_hits,
+                           "misses", cache->stats_misses,
+                           "evictions", cache->stats_evictions,
                            "flush-batch-count", cache->flush_batch_count,
-                           "mmap", o ? o : json_null ()) < 0)
+                           "mmap", o ? o : json_null (),
+                           "dispatch", d ? d : json_null ()) < 0)
         flux_log_error (h, "content stats");
     json_decref (o);
+    json_decref (d);
 }
 
 /* Handle request to store all dirty entries.  The store requests are batched
@@ -958,18 +1283,7 @@ error:
 
 static void cache_purge (struct content_cache *cache)
 {
-    double now = flux_reactor_now (cache->reactor);
-    struct cache_entry *e = NULL;
-    struct cache_entry *next;
-
-    list_for_each_rev_safe (&cache->lru, e, next, list) {
-        if (cache->acct_size <= cache->purge_target_size
-            || now - e->lastused < cache->purge_old_entry)
-            break;
-        assert (e->valid);
-        assert (!e->dirty);
-        cache_entry_remove (cache, e);
-    }
+    cache_evict (cache, cache->purge_target_size, cache->purge_old_entry);
 }
 
 static void update_stats (struct content_cache *cache)
@@ -982,10 +1296,50 @@ static void update_stats (struct content_cache *cache)
         cache->acct_dirty);
     flux_stats_gauge_set (cache->h, "content-cache.size",
         cache->acct_size);
+    flux_stats_gauge_set (cache->h, "content-cache.protected-size",
+        cache->acct_protected);
     flux_stats_gauge_set (cache->h, "content-cache.flush-batch-count",
         cache->flush_batch_count);
 }
 
+/* On rank 0, dirty entries stored while a batch-store capable backing store
+ * is loaded are queued on the flush list.  Send them in batches once the
+ * reactor has run out of other events to handle, so that a burst of stores
+ * is committed to the backing store together.
+ */
+static bool cache_batch_ready (struct content_cache *cache)
+{
+    return (cache->backing
+            && cache->batch_store
+            && cache->flush_batch_count < cache->flush_batch_limit
+            && !list_empty (&cache->flush));
+}
+
+static void cache_prep_cb (flux_reactor_t *r,
+                           flux_watcher_t *w,
+                           int revents,
+                           void *arg)
+{
+    struct content_cache *cache = arg;
+
+    if (cache_batch_ready (cache))
+        flux_watcher_start (cache->idle_w);
+}
+
+static void cache_check_cb (flux_reactor_t *r,
+                            flux_watcher_t *w,
+                            int revents,
+                            void *arg)
+{
+    struct content_cache *cache = arg;
+
+    flux_watcher_stop (cache->idle_w);
+    if (cache_batch_ready (cache)) {
+        if (cache_flush (cache) < 0)
+            cache->flush_errno = errno;
+    }
+}
+
 static void sync_cb (flux_future_t *f, void *arg)
 {
     struct content_cache *cache = arg;
@@ -1084,6 +1438,19 @@ static int parse_u32 (const char *s, uint32_t *val)
     return 0;
 }
 
+static int parse_u64 (const char *s, uint64_t *val)
+{
+    unsigned long long u;
+    char *endptr;
+
+    errno = 0;
+    u = strtoull (s, &endptr, 10);
+    if (errno != 0 || *endptr != '\0' || endptr == s)
+        return -1;
+    *val = u;
+    return 0;
+}
+
 int parse_args (struct content_cache *cache, int argc, char **argv)
 {
     uint32_t val;
@@ -1103,6 +1470,12 @@ int parse_args (struct content_cache *cache, int argc, char **argv)
             }
             cache->purge_old_entry = val;
         }
+        else if (strstarts (argv[i], "size-limit=")) {
+            if (parse_u64 (argv[i] + 11, &cache->size_limit) < 0) {
+                flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
+                return -1;
+            }
+        }
         else if (strstarts (argv[i], "flush-batch-limit=")) {
             if (parse_u32 (argv[i] + 18, &val) < 0) {
                 flux_log (cache->h, LOG_ERR, "error parsing %s", argv[i]);
@@ -1130,6 +1503,9 @@ void content_cache_destroy (struct content_cache *cache)
     if (cache) {
         int saved_errno = errno;
         flux_future_destroy (cache->f_sync);
+        flux_watcher_destroy (cache->prep_w);
+        flux_watcher_destroy (cache->check_w);
+        flux_watcher_destroy (cache->idle_w);
         flux_msg_handler_delvec (cache->handlers);
         free (cache->backing_name);
         zhashx_destroy (&cache->entries);
@@ -1164,6 +1540,7 @@ struct content_cache *content_cache_create (flux_t *h, int argc, char **argv)
     cache->flush_batch_limit = default_flush_batch_limit;
     cache->purge_target_size = default_cache_purge_target_size;
     cache->purge_old_entry = default_cache_purge_old_entry;
+    cache->size_limit = default_cache_size_limit;
     /* Some tunables may be set on the module command line (mainly for test).
      */
     if (parse_args (cache, argc, argv) < 0) {
@@ -1173,7 +1550,8 @@ struct content_cache *content_cache_create (flux_t *h, int argc, char **argv)
     if (get_hash_name (cache) < 0)
         goto error;
 
-    list_head_init (&cache->lru);
+    list_head_init (&cache->probation);
+    list_head_init (&cache->protected);
     list_head_init (&cache->flush);
 
     if (flux_get_rank (h, &cache->rank) < 0)
@@ -1188,8 +1566,21 @@ struct content_cache *content_cache_create (flux_t *h, int argc, char **argv)
                                                  cache->hash_name,
                                                  content_hash_size)))
             goto error;
+        if (!(cache->prep_w = flux_prepare_watcher_create (cache->reactor,
+                                                           cache_prep_cb,
+                                                           cache))
+            || !(cache->check_w = flux_check_watcher_create (cache->reactor,
+                                                             cache_check_cb,
+                                                             cache))
+            || !(cache->idle_w = flux_idle_watcher_create (cache->reactor,
+                                                           NULL,
+                                                           NULL)))
+            goto error;
+        flux_watcher_start (cache->prep_w);
+        flux_watcher_start (cache->check_w);
     }
-    if (flux_msg_handler_addvec (h, htab, cache, &cache->handlers) < 0)
+    if (flux_msg_handler_addvec (h, htab, cache, &cache->handlers) < 0
+        || flux_dispatch_set_batch (h, dispatch_batch) < 0)
         goto error;
     if (!(cache->f_sync = flux_sync_create (h, 0))
         || flux_future_then (cache->f_sync, sync_max, sync_cb, cache) < 0)
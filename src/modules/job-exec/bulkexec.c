@@ -486,6 +486,14 @@ static int exec_init (struct jobinfo *job)
         flux_log_error (job->h, "exec_init: bulk_exec_create");
         goto err;
     }
+    /* Start job shells over the TBON with one request per command.
+     * bulk-exec falls back to per-rank requests if unsupported.
+     */
+    if (streq (service, "rexec")
+        && bulk_exec_set_collective (exec, true) < 0) {
+        flux_log_error (job->h, "exec_init: bulk_exec_set_collective");
+        goto err;
+    }
     if (!(ctx = exec_ctx_create (job, ranks, &error))) {
         flux_log (job->h, LOG_ERR, "exec_ctx_create: %s", error.text);
         goto err;
@@ -74,15 +74,27 @@ static void store_lru (struct info_ctx *ctx, flux_jobid_t id, uint32_t userid)
     return;
 }
 
+int eventlog_owner (struct info_ctx *ctx,
+                    flux_jobid_t id,
+                    const char *s,
+                    uint32_t *useridp)
+{
+    uint32_t userid;
+    if (eventlog_get_userid (ctx, s, &userid) < 0)
+        return -1;
+    store_lru (ctx, id, userid);
+    (*useridp) = userid;
+    return 0;
+}
+
 int eventlog_allow (struct info_ctx *ctx,
                     const flux_msg_t *msg,
                     flux_jobid_t id,
                     const char *s)
 {
     uint32_t userid;
-    if (eventlog_get_userid (ctx, s, &userid) < 0)
+    if (eventlog_owner (ctx, id, s, &userid) < 0)
         return -1;
-    store_lru (ctx, id, userid);
     if (flux_msg_authorize (msg, userid) < 0)
         return -1;
     return 0;
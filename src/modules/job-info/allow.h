@@ -15,6 +15,13 @@
 
 #include "job-info.h"
 
+/* Get the job owner from job eventlog 's' and cache it in the LRU.
+ */
+int eventlog_owner (struct info_ctx *ctx,
+                    flux_jobid_t id,
+                    const char *s,
+                    uint32_t *useridp);
+
 /* Determine if user who sent request 'msg' is allowed to
  * access job eventlog 's'.  Assume first event is the "submit"
  * event which records the job owner.  Will cache recently looked
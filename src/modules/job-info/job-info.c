@@ -21,6 +21,7 @@
 #include "watch.h"
 #include "guest_watch.h"
 #include "update.h"
+#include "launch.h"
 
 static void disconnect_cb (flux_t *h,
                            flux_msg_handler_t *mh,
@@ -31,6 +32,7 @@ static void disconnect_cb (flux_t *h,
     watchers_cancel (ctx, msg, false);
     guest_watchers_cancel (ctx, msg, false);
     update_watchers_cancel (ctx, msg, false);
+    launch_watchers_cancel (ctx, msg, false);
 }
 
 static void stats_cb (flux_t *h,
@@ -44,14 +46,16 @@ static void stats_cb (flux_t *h,
     int guest_watchers = zlistx_size (ctx->guest_watchers);
     int update_lookups = 0;     /* no longer supported */
     int update_watchers = update_watch_count (ctx);
+    int launch_watchers = launch_watch_count (ctx);
     if (flux_respond_pack (h,
                            msg,
-                           "{s:i s:i s:i s:i s:i}",
+                           "{s:i s:i s:i s:i s:i s:i}",
                            "lookups", lookups,
                            "watchers", watchers,
                            "guest_watchers", guest_watchers,
                            "update_lookups", update_lookups,
-                           "update_watchers", update_watchers) < 0) {
+                           "update_watchers", update_watchers,
+                           "launch_watchers", launch_watchers) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
         goto error;
     }
@@ -93,6 +97,16 @@ static const struct flux_msg_handler_spec htab[] = {
       .cb           = update_watch_cancel_cb,
       .rolemask     = FLUX_ROLE_USER
     },
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-info.launch-watch",
+      .cb           = launch_watch_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
+    { .typemask     = FLUX_MSGTYPE_REQUEST,
+      .topic_glob   = "job-info.launch-watch-cancel",
+      .cb           = launch_watch_cancel_cb,
+      .rolemask     = FLUX_ROLE_USER
+    },
     { .typemask     = FLUX_MSGTYPE_REQUEST,
       .topic_glob   = "job-info.disconnect",
       .cb           = disconnect_cb,
@@ -116,6 +130,7 @@ static void info_ctx_destroy (struct info_ctx *ctx)
         watch_cleanup (ctx);
         guest_watch_cleanup (ctx);
         update_watch_cleanup (ctx);
+        launch_watch_cleanup (ctx);
         free (ctx);
         errno = saved_errno;
     }
@@ -140,6 +155,8 @@ static struct info_ctx *info_ctx_create (flux_t *h)
         goto error;
     if (update_watch_setup (ctx) < 0)
         goto error;
+    if (launch_watch_setup (ctx) < 0)
+        goto error;
     return ctx;
 error:
     info_ctx_destroy (ctx);
@@ -36,6 +36,8 @@ struct info_ctx {
     zhashx_t *guest_watchers_matchtags; /* matchtag + uuid -> guest_watcher */
     zlistx_t *update_watchers;
     zhashx_t *index_uw;        /* jobid + key -> update_watcher lookup */
+    zlistx_t *launch_watchers;
+    zhashx_t *index_lw;        /* jobid -> launch_watcher lookup */
 };
 
 #endif /* _FLUX_JOB_INFO_H */
@@ -0,0 +1,549 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* launch.c - handle job-info.launch-watch for job-info
+ *
+ * Job shells need J and R at launch, and R updates while running.
+ * Rather than have every shell of a large job look up J and watch R
+ * in the KVS, job-info.launch-watch coalesces all requests for a job on
+ * each broker into one entry.  On rank 0 the entry looks up J and
+ * watches R once.  On other ranks the entry sends a single launch-watch
+ * request upstream, so requests from local shells and from downstream
+ * job-info modules converge on the parent broker's cache, and each R
+ * update travels down the tree once per broker.
+ *
+ * The first response to each request is {"J":s, "R":o, "userid":i}.
+ * Subsequent responses are R updates {"R":o}.  The stream ends with
+ * ENODATA when the job is complete or the request is canceled.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libjob/job_hash.h"
+
+#include "job-info.h"
+#include "allow.h"
+#include "launch.h"
+
+struct launch_ctx {
+    struct info_ctx *ctx;
+    struct flux_msglist *msglist;
+    flux_jobid_t id;
+    bool upstream;              /* watch is forwarded to parent broker */
+    uint32_t userid;
+    char *J;                    /* J and userid are set together */
+    json_t *R;
+    flux_future_t *lookup_f;    /* rank 0 only */
+    flux_future_t *watch_f;
+    bool watch_canceled;
+    void *handle;               /* zlistx_t handle */
+};
+
+static void launch_ctx_destroy (void *data)
+{
+    if (data) {
+        struct launch_ctx *lc = data;
+        int save_errno = errno;
+        flux_msglist_destroy (lc->msglist);
+        free (lc->J);
+        json_decref (lc->R);
+        flux_future_destroy (lc->lookup_f);
+        flux_future_destroy (lc->watch_f);
+        free (lc);
+        errno = save_errno;
+    }
+}
+
+/* zlistx_destructor_fn */
+static void launch_ctx_destroy_wrapper (void **data)
+{
+    if (data) {
+        launch_ctx_destroy (*data);
+        *data = NULL;
+    }
+}
+
+static struct launch_ctx *launch_ctx_create (struct info_ctx *ctx,
+                                             const flux_msg_t *msg,
+                                             flux_jobid_t id)
+{
+    struct launch_ctx *lc = calloc (1, sizeof (*lc));
+    uint32_t rank;
+
+    if (!lc)
+        return NULL;
+    lc->ctx = ctx;
+    lc->id = id;
+    if (flux_get_rank (ctx->h, &rank) < 0)
+        goto error;
+    lc->upstream = rank > 0;
+    if (!(lc->msglist = flux_msglist_create ()))
+        goto error;
+    if (flux_msglist_append (lc->msglist, msg) < 0)
+        goto error;
+    return lc;
+error:
+    launch_ctx_destroy (lc);
+    return NULL;
+}
+
+/* Stop new requests from joining 'lc'.  A new entry will be created for
+ * later requests for the same job.
+ */
+static void launch_ctx_unindex (struct launch_ctx *lc)
+{
+    if (zhashx_lookup (lc->ctx->index_lw, &lc->id) == lc)
+        zhashx_delete (lc->ctx->index_lw, &lc->id);
+}
+
+static void launch_ctx_remove (struct launch_ctx *lc)
+{
+    launch_ctx_unindex (lc);
+    zlistx_delete (lc->ctx->launch_watchers, lc->handle);
+}
+
+static void watch_cancel (struct launch_ctx *lc)
+{
+    flux_future_t *f;
+    const char *topic;
+    uint32_t nodeid;
+    int matchtag;
+
+    /* in some cases, the watch hasn't started yet */
+    if (!lc->watch_f || lc->watch_canceled)
+        return;
+
+    if (lc->upstream) {
+        topic = "job-info.launch-watch-cancel";
+        nodeid = FLUX_NODEID_UPSTREAM;
+    }
+    else {
+        topic = "job-info.update-watch-cancel";
+        nodeid = FLUX_NODEID_ANY;
+    }
+    matchtag = (int)flux_rpc_get_matchtag (lc->watch_f);
+
+    if (!(f = flux_rpc_pack (lc->ctx->h,
+                             topic,
+                             nodeid,
+                             FLUX_RPC_NORESPONSE,
+                             "{s:i}",
+                             "matchtag", matchtag))) {
+        flux_log_error (lc->ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
+        return;
+    }
+    flux_future_destroy (f);
+    lc->watch_canceled = true;
+    launch_ctx_unindex (lc);
+}
+
+static int respond_initial (struct launch_ctx *lc, const flux_msg_t *msg)
+{
+    return flux_respond_pack (lc->ctx->h,
+                              msg,
+                              "{s:s s:O s:i}",
+                              "J", lc->J,
+                              "R", lc->R,
+                              "userid", lc->userid);
+}
+
+/* Drop requests from users that may not access this job.  Caller can't
+ * access this data, this is not a "fatal" error, so respond with an
+ * error to this one message and continue on the msglist.
+ */
+static void authorize_all (struct launch_ctx *lc)
+{
+    const flux_msg_t *msg;
+
+    msg = flux_msglist_first (lc->msglist);
+    while (msg) {
+        if (flux_msg_authorize (msg, lc->userid) < 0) {
+            if (flux_respond_error (lc->ctx->h, msg, errno, NULL) < 0)
+                flux_log_error (lc->ctx->h,
+                                "%s: flux_respond_error",
+                                __FUNCTION__);
+            flux_msglist_delete (lc->msglist);
+        }
+        msg = flux_msglist_next (lc->msglist);
+    }
+}
+
+static void respond_error_all (struct launch_ctx *lc,
+                               int errnum,
+                               const char *errmsg)
+{
+    const flux_msg_t *msg;
+
+    msg = flux_msglist_first (lc->msglist);
+    while (msg) {
+        if (flux_respond_error (lc->ctx->h, msg, errnum, errmsg) < 0)
+            flux_log_error (lc->ctx->h, "%s: flux_respond_error", __FUNCTION__);
+        msg = flux_msglist_next (lc->msglist);
+    }
+}
+
+/* Handle responses from job-info.update-watch on rank 0, or from the
+ * upstream job-info.launch-watch on other ranks.
+ */
+static void watch_continuation (flux_future_t *f, void *arg)
+{
+    struct launch_ctx *lc = arg;
+    struct info_ctx *ctx = lc->ctx;
+    const char *J = NULL;
+    int userid = -1;
+    json_t *R;
+    bool initial = (lc->R == NULL);
+    const char *errmsg = NULL;
+    const flux_msg_t *msg;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s?s s?i s:o}",
+                             "J", &J,
+                             "userid", &userid,
+                             "R", &R) < 0) {
+        /* ENODATA is normal when job finishes or we've sent cancel */
+        if (errno != ENODATA && errno != EPERM && errno != ENOENT)
+            flux_log_error (ctx->h, "%s: launch watch", __FUNCTION__);
+        goto error;
+    }
+
+    /* if count == 0, all callers canceled streams.  Wait for the
+     * watch to terminate before cleaning up.
+     */
+    if (flux_msglist_count (lc->msglist) == 0) {
+        watch_cancel (lc);
+        flux_future_reset (f);
+        return;
+    }
+
+    if (!lc->J) {
+        if (!J || userid < 0) {
+            errno = EPROTO;
+            errmsg = "launch watch response is missing J or userid";
+            watch_cancel (lc);
+            goto error;
+        }
+        if (!(lc->J = strdup (J))) {
+            watch_cancel (lc);
+            goto error;
+        }
+        lc->userid = userid;
+        authorize_all (lc);
+    }
+    json_decref (lc->R);
+    lc->R = json_incref (R);
+
+    msg = flux_msglist_first (lc->msglist);
+    while (msg) {
+        int rc;
+        if (initial)
+            rc = respond_initial (lc, msg);
+        else
+            rc = flux_respond_pack (ctx->h, msg, "{s:O}", "R", lc->R);
+        if (rc < 0)
+            flux_log_error (ctx->h, "%s: flux_respond", __FUNCTION__);
+        msg = flux_msglist_next (lc->msglist);
+    }
+    if (flux_msglist_count (lc->msglist) == 0)
+        watch_cancel (lc);
+
+    flux_future_reset (f);
+    return;
+
+error:
+    respond_error_all (lc, errno, errmsg);
+    /* flux future destroyed in launch_ctx_destroy, which is
+     * called via zlistx_delete() */
+    launch_ctx_remove (lc);
+}
+
+static int watch_start (struct launch_ctx *lc)
+{
+    if (lc->upstream) {
+        lc->watch_f = flux_rpc_pack (lc->ctx->h,
+                                     "job-info.launch-watch",
+                                     FLUX_NODEID_UPSTREAM,
+                                     FLUX_RPC_STREAMING,
+                                     "{s:I s:i}",
+                                     "id", lc->id,
+                                     "flags", 0);
+    }
+    else {
+        lc->watch_f = flux_rpc_pack (lc->ctx->h,
+                                     "job-info.update-watch",
+                                     FLUX_NODEID_ANY,
+                                     FLUX_RPC_STREAMING,
+                                     "{s:I s:s s:i}",
+                                     "id", lc->id,
+                                     "key", "R",
+                                     "flags", 0);
+    }
+    if (!lc->watch_f) {
+        flux_log_error (lc->ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
+        return -1;
+    }
+    if (flux_future_then (lc->watch_f, -1, watch_continuation, lc) < 0) {
+        /* future cleanup handled with context destruction */
+        flux_log_error (lc->ctx->h, "%s: flux_future_then", __FUNCTION__);
+        return -1;
+    }
+    return 0;
+}
+
+/* Handle J and eventlog lookup on rank 0.  The job owner is taken from
+ * the eventlog so that requests can be authorized locally.
+ */
+static void lookup_continuation (flux_future_t *f, void *arg)
+{
+    struct launch_ctx *lc = arg;
+    struct info_ctx *ctx = lc->ctx;
+    const char *J;
+    const char *eventlog;
+
+    if (flux_rpc_get_unpack (f,
+                             "{s:s s:s}",
+                             "J", &J,
+                             "eventlog", &eventlog) < 0) {
+        if (errno != ENOENT && errno != EPERM)
+            flux_log_error (ctx->h, "%s: flux_rpc_get_unpack", __FUNCTION__);
+        goto error;
+    }
+
+    /* if count == 0, all callers canceled streams */
+    if (flux_msglist_count (lc->msglist) == 0)
+        goto cleanup;
+
+    if (eventlog_owner (ctx, lc->id, eventlog, &lc->userid) < 0
+        || !(lc->J = strdup (J)))
+        goto error;
+
+    authorize_all (lc);
+
+    /* due to security check above, possible no more messages in this
+     * watcher */
+    if (flux_msglist_count (lc->msglist) == 0)
+        goto cleanup;
+
+    if (watch_start (lc) < 0)
+        goto error;
+    return;
+
+error:
+    respond_error_all (lc, errno, NULL);
+cleanup:
+    launch_ctx_remove (lc);
+}
+
+static int launch_watch (struct info_ctx *ctx,
+                         const flux_msg_t *msg,
+                         flux_jobid_t id)
+{
+    struct launch_ctx *lc;
+
+    if (!(lc = launch_ctx_create (ctx, msg, id)))
+        return -1;
+
+    if (lc->upstream) {
+        if (watch_start (lc) < 0)
+            goto error;
+    }
+    else {
+        if (!(lc->lookup_f = flux_rpc_pack (ctx->h,
+                                            "job-info.lookup",
+                                            FLUX_NODEID_ANY,
+                                            0,
+                                            "{s:I s:[ss] s:i}",
+                                            "id", lc->id,
+                                            "keys", "J", "eventlog",
+                                            "flags", 0))) {
+            flux_log_error (ctx->h, "%s: flux_rpc_pack", __FUNCTION__);
+            goto error;
+        }
+        if (flux_future_then (lc->lookup_f,
+                              -1,
+                              lookup_continuation,
+                              lc) < 0) {
+            flux_log_error (ctx->h, "%s: flux_future_then", __FUNCTION__);
+            goto error;
+        }
+    }
+
+    if (!(lc->handle = zlistx_add_end (ctx->launch_watchers, lc))) {
+        errno = ENOMEM;
+        flux_log_error (ctx->h, "%s: zlistx_add_end", __FUNCTION__);
+        goto error;
+    }
+    if (zhashx_insert (ctx->index_lw, &lc->id, lc) < 0) {
+        errno = EEXIST;
+        flux_log_error (ctx->h, "%s: zhashx_insert", __FUNCTION__);
+        goto error_list;
+    }
+    return 0;
+
+error_list:
+    zlistx_delete (ctx->launch_watchers, lc->handle);
+    return -1;
+error:
+    launch_ctx_destroy (lc);
+    return -1;
+}
+
+void launch_watch_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct info_ctx *ctx = arg;
+    struct launch_ctx *lc;
+    flux_jobid_t id;
+    int flags;
+    int valid_flags = 0;
+    const char *errmsg = NULL;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:I s:i}",
+                             "id", &id,
+                             "flags", &flags) < 0)
+        goto error;
+    if ((flags & ~valid_flags)) {
+        errno = EPROTO;
+        errmsg = "launch-watch request rejected with invalid flag";
+        goto error;
+    }
+    if (!flux_msg_is_streaming (msg)) {
+        errno = EPROTO;
+        errmsg = "launch-watch request rejected without streaming RPC flag";
+        goto error;
+    }
+
+    /* if no watchers for this jobid yet, start it */
+    if (!(lc = zhashx_lookup (ctx->index_lw, &id))) {
+        if (launch_watch (ctx, msg, id) < 0)
+            goto error;
+        return;
+    }
+
+    /* if lc->J has not been set, the job owner is not yet known.  The
+     * security check will be done when it is.
+     */
+    if (lc->J) {
+        if (flux_msg_authorize (msg, lc->userid) < 0)
+            goto error;
+        if (lc->R && respond_initial (lc, msg) < 0) {
+            flux_log_error (h, "%s: flux_respond", __FUNCTION__);
+            return;
+        }
+    }
+    if (flux_msglist_append (lc->msglist, msg) < 0)
+        goto error;
+    return;
+
+error:
+    if (flux_respond_error (h, msg, errno, errmsg) < 0)
+        flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
+}
+
+/* Cancel launch_watch if it matches message.
+ */
+static void launch_watch_cancel (struct launch_ctx *lc,
+                                 const flux_msg_t *msg,
+                                 bool cancel)
+{
+    if (cancel) {
+        if (flux_msglist_cancel (lc->ctx->h, lc->msglist, msg) < 0)
+            flux_log_error (lc->ctx->h,
+                            "error handling job-info.launch-watch-cancel");
+    }
+    else {
+        if (flux_msglist_disconnect (lc->msglist, msg) < 0)
+            flux_log_error (lc->ctx->h,
+                            "error handling job-info.launch-watch disconnect");
+    }
+
+    if (flux_msglist_count (lc->msglist) == 0)
+        watch_cancel (lc);
+}
+
+void launch_watchers_cancel (struct info_ctx *ctx,
+                             const flux_msg_t *msg,
+                             bool cancel)
+{
+    struct launch_ctx *lc;
+
+    lc = zlistx_first (ctx->launch_watchers);
+    while (lc) {
+        launch_watch_cancel (lc, msg, cancel);
+        lc = zlistx_next (ctx->launch_watchers);
+    }
+}
+
+void launch_watch_cancel_cb (flux_t *h,
+                             flux_msg_handler_t *mh,
+                             const flux_msg_t *msg,
+                             void *arg)
+{
+    struct info_ctx *ctx = arg;
+    launch_watchers_cancel (ctx, msg, true);
+}
+
+int launch_watch_setup (struct info_ctx *ctx)
+{
+    /* N.B. no cleanup in this setup, caller will destroy info_ctx */
+    if (!(ctx->launch_watchers = zlistx_new ()))
+        return -1;
+    zlistx_set_destructor (ctx->launch_watchers, launch_ctx_destroy_wrapper);
+    /* no destructor for index_lw, destruction handled on
+     * launch_watchers list */
+    if (!(ctx->index_lw = job_hash_create ()))
+        return -1;
+    return 0;
+}
+
+void launch_watch_cleanup (struct info_ctx *ctx)
+{
+    if (ctx->launch_watchers) {
+        struct launch_ctx *lc;
+        while ((lc = zlistx_first (ctx->launch_watchers))) {
+            lc = zlistx_detach_cur (ctx->launch_watchers);
+            watch_cancel (lc);
+            respond_error_all (lc, ENOSYS, NULL);
+            launch_ctx_destroy (lc);
+        }
+        zlistx_destroy (&ctx->launch_watchers);
+        ctx->launch_watchers = NULL;
+    }
+    if (ctx->index_lw) {
+        zhashx_destroy (&ctx->index_lw);
+        ctx->index_lw = NULL;
+    }
+}
+
+int launch_watch_count (struct info_ctx *ctx)
+{
+    struct launch_ctx *lc;
+    int count = 0;
+
+    lc = zlistx_first (ctx->launch_watchers);
+    while (lc) {
+        count += flux_msglist_count (lc->msglist);
+        lc = zlistx_next (ctx->launch_watchers);
+    }
+    return count;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
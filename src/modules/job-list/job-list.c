@@ -100,10 +100,7 @@ static void purge_cb (flux_t *h,
         if ((job = zhashx_lookup (ctx->jsctx->index, &id))) {
             if (job->state != FLUX_JOB_STATE_INACTIVE)
                 continue;
-            job_stats_purge (ctx->jsctx->statsctx, job);
-            if (job->list_handle)
-                zlistx_delete (ctx->jsctx->inactive, job->list_handle);
-            zhashx_delete (ctx->jsctx->index, &id);
+            job_state_purge_inactive (ctx->jsctx, job);
             count++;
         }
     }
@@ -275,6 +272,7 @@ int mod_main (flux_t *h, int argc, char **argv)
     }
     if (flux_reactor_run (flux_get_reactor (h), 0) < 0)
         goto done;
+    job_state_save_snapshot (ctx->jsctx);
     rc = 0;
 done:
     list_ctx_destroy (ctx);
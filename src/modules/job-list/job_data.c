@@ -42,6 +42,7 @@ void job_destroy (void *data)
         json_decref (job->jobspec);
         json_decref (job->R);
         json_decref (job->exception_context);
+        json_decref (job->snapshot);
         free (job);
         errno = save_errno;
     }
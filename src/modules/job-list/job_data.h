@@ -86,6 +86,11 @@ struct job {
     void *list_handle;
 
     int submit_version;         /* version number in submit context */
+
+    /* If restored from a snapshot, holds the strings that const char *
+     * fields such as name and queue point to (see snapshot.c).
+     */
+    json_t *snapshot;
 };
 
 void job_destroy (void *data);
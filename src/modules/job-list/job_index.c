@@ -0,0 +1,460 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* job_index.c - secondary indexes over inactive jobs */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <flux/core.h>
+
+#include "src/common/libidset/idset.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "job_index.h"
+
+/* Large enough for a decimal unsigned int */
+#define KEY_MAX 16
+
+struct job_index {
+    zlistx_comparator_fn *cmp;
+    zhashx_t *userid;
+    zhashx_t *name;
+    zhashx_t *queue;
+    zhashx_t *result;
+    zhashx_t *ranks;
+};
+
+struct job_index_iter {
+    struct job_index *idx;
+    zlistx_t **buckets;
+    struct job **heads;
+    int count;
+    int size;
+    bool started;
+};
+
+/* Arguments for foreach_rank_block() callbacks */
+struct rank_block_arg {
+    struct job_index *idx;
+    struct job *job;
+    struct job_index_iter *iter;
+    bool sorted;
+};
+
+typedef int (*rank_block_f) (const char *key, struct rank_block_arg *arg);
+
+/* zhashx_set_destructor */
+static void bucket_destructor (void **item)
+{
+    if (item) {
+        zlistx_t *l = *item;
+        zlistx_destroy (&l);
+        *item = NULL;
+    }
+}
+
+static zhashx_t *index_create (void)
+{
+    zhashx_t *h;
+
+    if (!(h = zhashx_new ()))
+        return NULL;
+    zhashx_set_destructor (h, bucket_destructor);
+    return h;
+}
+
+static int bucket_add (struct job_index *idx,
+                       zhashx_t *h,
+                       const char *key,
+                       struct job *job,
+                       bool sorted)
+{
+    zlistx_t *l;
+    void *handle;
+
+    if (!(l = zhashx_lookup (h, key))) {
+        if (!(l = zlistx_new ()))
+            goto nomem;
+        zlistx_set_comparator (l, idx->cmp);
+        if (zhashx_insert (h, key, l) < 0) {
+            zlistx_destroy (&l);
+            goto nomem;
+        }
+    }
+    if (sorted)
+        handle = zlistx_insert (l, job, true);
+    else
+        handle = zlistx_add_end (l, job);
+    if (!handle)
+        goto nomem;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static void bucket_remove (zhashx_t *h, const char *key, struct job *job)
+{
+    zlistx_t *l;
+    struct job *j;
+
+    if (!(l = zhashx_lookup (h, key)))
+        return;
+    j = zlistx_last (l);
+    while (j) {
+        if (j == job) {
+            zlistx_delete (l, zlistx_cursor (l));
+            break;
+        }
+        j = zlistx_prev (l);
+    }
+    if (zlistx_size (l) == 0)
+        zhashx_delete (h, key);
+}
+
+static void bucket_sort (zhashx_t *h)
+{
+    zlistx_t *l = zhashx_first (h);
+    while (l) {
+        zlistx_sort (l);
+        l = zhashx_next (h);
+    }
+}
+
+static void uint_key (char *key, unsigned int val)
+{
+    snprintf (key, KEY_MAX, "%u", val);
+}
+
+/* Ranks are cached in idset form on first use, as in match_ranks().
+ */
+static const struct idset *job_ranks (struct job *job)
+{
+    if (!job->ranks)
+        return NULL;
+    if (!job->ranks_idset)
+        job->ranks_idset = idset_decode (job->ranks);
+    return job->ranks_idset;
+}
+
+/* Call 'cb' with the key of each rank block touched by 'ranks'.
+ * idset_next() skips to the first rank past the current block.
+ */
+static int foreach_rank_block (const struct idset *ranks,
+                               rank_block_f cb,
+                               struct rank_block_arg *arg)
+{
+    unsigned int id = idset_first (ranks);
+    unsigned int last = idset_last (ranks);
+
+    while (id != IDSET_INVALID_ID) {
+        unsigned int block = id / JOB_INDEX_RANK_BLOCK;
+        unsigned int block_last = (block + 1) * JOB_INDEX_RANK_BLOCK - 1;
+        char key[KEY_MAX];
+
+        uint_key (key, block);
+        if (cb (key, arg) < 0)
+            return -1;
+        if (block_last >= last)
+            break;
+        id = idset_next (ranks, block_last);
+    }
+    return 0;
+}
+
+static int rank_block_add (const char *key, struct rank_block_arg *arg)
+{
+    return bucket_add (arg->idx, arg->idx->ranks, key, arg->job, arg->sorted);
+}
+
+static int rank_block_remove (const char *key, struct rank_block_arg *arg)
+{
+    bucket_remove (arg->idx->ranks, key, arg->job);
+    return 0;
+}
+
+int job_index_add (struct job_index *idx, struct job *job, bool sorted)
+{
+    char key[KEY_MAX];
+    const struct idset *ranks;
+
+    if (!idx || !job) {
+        errno = EINVAL;
+        return -1;
+    }
+    uint_key (key, job->userid);
+    if (bucket_add (idx, idx->userid, key, job, sorted) < 0)
+        goto error;
+    if (job->name
+        && bucket_add (idx, idx->name, job->name, job, sorted) < 0)
+        goto error;
+    if (job->queue
+        && bucket_add (idx, idx->queue, job->queue, job, sorted) < 0)
+        goto error;
+    uint_key (key, job->result);
+    if (bucket_add (idx, idx->result, key, job, sorted) < 0)
+        goto error;
+    if ((ranks = job_ranks (job))) {
+        struct rank_block_arg arg = { .idx = idx,
+                                      .job = job,
+                                      .sorted = sorted };
+        if (foreach_rank_block (ranks, rank_block_add, &arg) < 0)
+            goto error;
+    }
+    return 0;
+error:
+    job_index_remove (idx, job);
+    errno = ENOMEM;
+    return -1;
+}
+
+void job_index_remove (struct job_index *idx, struct job *job)
+{
+    char key[KEY_MAX];
+    const struct idset *ranks;
+
+    if (!idx || !job)
+        return;
+    uint_key (key, job->userid);
+    bucket_remove (idx->userid, key, job);
+    if (job->name)
+        bucket_remove (idx->name, job->name, job);
+    if (job->queue)
+        bucket_remove (idx->queue, job->queue, job);
+    uint_key (key, job->result);
+    bucket_remove (idx->result, key, job);
+    if ((ranks = job_ranks (job))) {
+        struct rank_block_arg arg = { .idx = idx, .job = job };
+        (void)foreach_rank_block (ranks, rank_block_remove, &arg);
+    }
+}
+
+void job_index_sort (struct job_index *idx)
+{
+    if (idx) {
+        bucket_sort (idx->userid);
+        bucket_sort (idx->name);
+        bucket_sort (idx->queue);
+        bucket_sort (idx->result);
+        bucket_sort (idx->ranks);
+    }
+}
+
+void job_index_destroy (struct job_index *idx)
+{
+    if (idx) {
+        int saved_errno = errno;
+        zhashx_destroy (&idx->userid);
+        zhashx_destroy (&idx->name);
+        zhashx_destroy (&idx->queue);
+        zhashx_destroy (&idx->result);
+        zhashx_destroy (&idx->ranks);
+        free (idx);
+        errno = saved_errno;
+    }
+}
+
+struct job_index *job_index_create (zlistx_comparator_fn *cmp)
+{
+    struct job_index *idx;
+
+    if (!cmp) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(idx = calloc (1, sizeof (*idx))))
+        return NULL;
+    idx->cmp = cmp;
+    if (!(idx->userid = index_create ())
+        || !(idx->name = index_create ())
+        || !(idx->queue = index_create ())
+        || !(idx->result = index_create ())
+        || !(idx->ranks = index_create ()))
+        goto nomem;
+    return idx;
+nomem:
+    job_index_destroy (idx);
+    errno = ENOMEM;
+    return NULL;
+}
+
+void job_index_iter_destroy (struct job_index_iter *iter)
+{
+    if (iter) {
+        int saved_errno = errno;
+        free (iter->buckets);
+        free (iter->heads);
+        free (iter);
+        errno = saved_errno;
+    }
+}
+
+struct job_index_iter *job_index_iter_create (struct job_index *idx)
+{
+    struct job_index_iter *iter;
+
+    if (!idx) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(iter = calloc (1, sizeof (*iter))))
+        return NULL;
+    iter->idx = idx;
+    return iter;
+}
+
+/* Add the bucket for 'key' to the iterator, unless it is not present
+ * in the index or has already been added.
+ */
+static int iter_add (struct job_index_iter *iter,
+                     zhashx_t *h,
+                     const char *key)
+{
+    zlistx_t *l;
+    int i;
+
+    if (iter->started) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!(l = zhashx_lookup (h, key)))
+        return 0;
+    for (i = 0; i < iter->count; i++) {
+        if (iter->buckets[i] == l)
+            return 0;
+    }
+    if (iter->count == iter->size) {
+        int size = iter->size ? iter->size * 2 : 4;
+        zlistx_t **buckets;
+        struct job **heads;
+
+        if (!(buckets = realloc (iter->buckets, size * sizeof (*buckets))))
+            goto nomem;
+        iter->buckets = buckets;
+        if (!(heads = realloc (iter->heads, size * sizeof (*heads))))
+            goto nomem;
+        iter->heads = heads;
+        iter->size = size;
+    }
+    iter->buckets[iter->count++] = l;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+int job_index_iter_add_userid (struct job_index_iter *iter, uint32_t userid)
+{
+    char key[KEY_MAX];
+
+    if (!iter) {
+        errno = EINVAL;
+        return -1;
+    }
+    uint_key (key, userid);
+    return iter_add (iter, iter->idx->userid, key);
+}
+
+int job_index_iter_add_name (struct job_index_iter *iter, const char *name)
+{
+    if (!iter || !name) {
+        errno = EINVAL;
+        return -1;
+    }
+    return iter_add (iter, iter->idx->name, name);
+}
+
+int job_index_iter_add_queue (struct job_index_iter *iter, const char *queue)
+{
+    if (!iter || !queue) {
+        errno = EINVAL;
+        return -1;
+    }
+    return iter_add (iter, iter->idx->queue, queue);
+}
+
+int job_index_iter_add_result (struct job_index_iter *iter,
+                               flux_job_result_t result)
+{
+    char key[KEY_MAX];
+
+    if (!iter) {
+        errno = EINVAL;
+        return -1;
+    }
+    uint_key (key, result);
+    return iter_add (iter, iter->idx->result, key);
+}
+
+static int rank_block_iter_add (const char *key, struct rank_block_arg *arg)
+{
+    return iter_add (arg->iter, arg->iter->idx->ranks, key);
+}
+
+int job_index_iter_add_ranks (struct job_index_iter *iter,
+                              const struct idset *ranks)
+{
+    struct rank_block_arg arg = { .iter = iter };
+
+    if (!iter || !ranks) {
+        errno = EINVAL;
+        return -1;
+    }
+    return foreach_rank_block (ranks, rank_block_iter_add, &arg);
+}
+
+size_t job_index_iter_count (struct job_index_iter *iter)
+{
+    size_t count = 0;
+    int i;
+
+    if (iter) {
+        for (i = 0; i < iter->count; i++)
+            count += zlistx_size (iter->buckets[i]);
+    }
+    return count;
+}
+
+/* Merge buckets by returning the lowest head in inactive list order.
+ * The comparator is a total order, so a job present in several buckets
+ * (e.g. adjacent rank blocks) is the head of each at the same time, and
+ * all of those heads are advanced together.
+ */
+struct job *job_index_iter_next (struct job_index_iter *iter)
+{
+    struct job *job = NULL;
+    int i;
+
+    if (!iter)
+        return NULL;
+    if (!iter->started) {
+        for (i = 0; i < iter->count; i++)
+            iter->heads[i] = zlistx_first (iter->buckets[i]);
+        iter->started = true;
+    }
+    for (i = 0; i < iter->count; i++) {
+        if (iter->heads[i]
+            && (!job || iter->idx->cmp (iter->heads[i], job) < 0))
+            job = iter->heads[i];
+    }
+    for (i = 0; i < iter->count; i++) {
+        if (iter->heads[i] == job && job != NULL)
+            iter->heads[i] = zlistx_next (iter->buckets[i]);
+    }
+    return job;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,87 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_JOB_INDEX_H
+#define _FLUX_JOB_LIST_JOB_INDEX_H
+
+#include <flux/core.h>
+
+#include "src/common/libidset/idset.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "job_data.h"
+
+/* Secondary indexes over inactive jobs, so that list queries filtered
+ * on userid, name, queue, result or ranks need not scan the whole
+ * inactive list.
+ *
+ * Each index maps a key to a bucket of jobs kept in the same order as
+ * the inactive list, as determined by the comparator passed to
+ * job_index_create().  Ranks are indexed by blocks of
+ * JOB_INDEX_RANK_BLOCK consecutive ranks, so a job is added once per
+ * block its ranks touch rather than once per rank.
+ *
+ * Only inactive jobs are indexed.  Active jobs are bounded by the
+ * queue depth and are always scanned.
+ */
+
+#define JOB_INDEX_RANK_BLOCK 64
+
+struct job_index;
+struct job_index_iter;
+
+struct job_index *job_index_create (zlistx_comparator_fn *cmp);
+
+void job_index_destroy (struct job_index *idx);
+
+/* Add 'job' to all indexes.  If 'sorted' is false, 'job' is appended
+ * to each bucket unsorted, and job_index_sort() must be called before
+ * the index is queried (cf. job_state_sort_inactive()).
+ */
+int job_index_add (struct job_index *idx, struct job *job, bool sorted);
+
+/* Remove 'job' from all indexes.  Must be called before any indexed
+ * field of 'job' changes.  Buckets are searched from the tail, since
+ * purged jobs are normally the oldest.
+ */
+void job_index_remove (struct job_index *idx, struct job *job);
+
+void job_index_sort (struct job_index *idx);
+
+/* An iterator returns the union of one or more buckets, in inactive
+ * list order, with each job returned at most once.  Buckets are added
+ * with the job_index_iter_add_*() functions before the first call to
+ * job_index_iter_next().  Keys not present in the index add nothing.
+ *
+ * The index must not be modified while an iterator is in use.
+ */
+struct job_index_iter *job_index_iter_create (struct job_index *idx);
+
+void job_index_iter_destroy (struct job_index_iter *iter);
+
+int job_index_iter_add_userid (struct job_index_iter *iter, uint32_t userid);
+int job_index_iter_add_name (struct job_index_iter *iter, const char *name);
+int job_index_iter_add_queue (struct job_index_iter *iter, const char *queue);
+int job_index_iter_add_result (struct job_index_iter *iter,
+                               flux_job_result_t result);
+int job_index_iter_add_ranks (struct job_index_iter *iter,
+                              const struct idset *ranks);
+
+/* Upper bound on the number of jobs the iterator will return.
+ */
+size_t job_index_iter_count (struct job_index_iter *iter);
+
+struct job *job_index_iter_next (struct job_index_iter *iter);
+
+#endif /* ! _FLUX_JOB_LIST_JOB_INDEX_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
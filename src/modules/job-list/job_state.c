@@ -141,6 +141,7 @@ static void job_state_sort_inactive (struct job_state_ctx *jsctx)
         job->list_handle = zlistx_cursor (jsctx->inactive);
         job = zlistx_next (jsctx->inactive);
     }
+    job_index_sort (jsctx->inactive_index);
 }
 
 /* zlistx_insert() and zlistx_reorder() take a 'low_value' parameter
@@ -223,6 +224,11 @@ static int job_insert_list (struct job_state_ctx *jsctx,
                                                      job,
                                                      true)))
             goto enomem;
+        /* Same for the secondary indexes */
+        if (job_index_add (jsctx->inactive_index,
+                           job,
+                           jsctx->initialized) < 0)
+            goto enomem;
     }
 
     return 0;
@@ -384,11 +390,23 @@ static void update_jobspec (struct job_state_ctx *jsctx,
      */
     if (update_stats)
         job_stats_remove_queue (jsctx->statsctx, job);
+    /* Likewise the job name and queue are indexed for inactive jobs.
+     */
+    if (job->state == FLUX_JOB_STATE_INACTIVE)
+        job_index_remove (jsctx->inactive_index, job);
 
     job_jobspec_update (job, context);
 
     if (update_stats)
         job_stats_add_queue (jsctx->statsctx, job);
+    if (job->state == FLUX_JOB_STATE_INACTIVE
+        && job_index_add (jsctx->inactive_index,
+                          job,
+                          jsctx->initialized) < 0)
+        flux_log_error (jsctx->h,
+                        "%s: job %s: error updating index",
+                        __FUNCTION__,
+                        idf58 (job->id));
 }
 
 static void update_resource (struct job_state_ctx *jsctx,
@@ -408,6 +426,95 @@ static void update_resource (struct job_state_ctx *jsctx,
     job_R_update (job, context);
 }
 
+int job_state_restore_inactive (struct job_state_ctx *jsctx, struct job *job)
+{
+    if (zhashx_insert (jsctx->index, &job->id, job) < 0) {
+        flux_log (jsctx->h,
+                  LOG_ERR,
+                  "%s: job %s already restored",
+                  __FUNCTION__,
+                  idf58 (job->id));
+        job_destroy (job);
+        errno = EEXIST;
+        return -1;
+    }
+    job_stats_update (jsctx->statsctx, job, FLUX_JOB_STATE_INACTIVE);
+    job->state = FLUX_JOB_STATE_INACTIVE;
+    if (job_insert_list (jsctx, job, FLUX_JOB_STATE_INACTIVE) < 0) {
+        job_stats_remove (jsctx->statsctx, job);
+        zhashx_delete (jsctx->index, &job->id);
+        errno = ENOMEM;
+        return -1;
+    }
+    jsctx->restored++;
+    return 0;
+}
+
+static void remove_inactive (struct job_state_ctx *jsctx, struct job *job)
+{
+    job_index_remove (jsctx->inactive_index, job);
+    if (job->list_handle)
+        zlistx_delete (jsctx->inactive, job->list_handle);
+    zhashx_delete (jsctx->index, &job->id);
+}
+
+void job_state_purge_inactive (struct job_state_ctx *jsctx, struct job *job)
+{
+    job_stats_purge (jsctx->statsctx, job);
+    remove_inactive (jsctx, job);
+}
+
+/* Drop a job restored from a snapshot, e.g. because the journal is
+ * replaying it in full.  Unlike a purge, the job is not counted as purged.
+ */
+static void drop_restored (struct job_state_ctx *jsctx, struct job *job)
+{
+    job_stats_remove (jsctx->statsctx, job);
+    remove_inactive (jsctx, job);
+}
+
+/* Called with the journal sentinel.  If the journal resumed from the
+ * snapshot, remove jobs purged since.  Otherwise, the full backlog will be
+ * replayed, so drop all restored jobs.  Before the sentinel, only restored
+ * jobs are on the inactive list.
+ */
+static void sync_restored (struct job_state_ctx *jsctx,
+                           bool resumed,
+                           json_t *purged)
+{
+    struct job *job;
+    size_t index;
+    json_t *entry;
+
+    if (!resumed) {
+        if (jsctx->restored > 0)
+            flux_log (jsctx->h,
+                      LOG_INFO,
+                      "journal did not resume from snapshot, replaying");
+        while ((job = zlistx_first (jsctx->inactive)))
+            drop_restored (jsctx, job);
+        return;
+    }
+    json_array_foreach (purged, index, entry) {
+        flux_jobid_t id = json_integer_value (entry);
+
+        if ((job = zhashx_lookup (jsctx->index, &id))
+            && job->state == FLUX_JOB_STATE_INACTIVE)
+            job_state_purge_inactive (jsctx, job);
+    }
+}
+
+void job_state_save_snapshot (struct job_state_ctx *jsctx)
+{
+    /* After journal EOF the job-manager is unloading, and its next
+     * journal will not resume from this one, so don't bother.
+     */
+    if (!jsctx->initialized || jsctx->journal_eof)
+        return;
+    if (job_snapshot_save (jsctx->snapshot) < 0)
+        flux_log_error (jsctx->h, "error saving snapshot");
+}
+
 void job_state_pause_cb (flux_t *h, flux_msg_handler_t *mh,
                          const flux_msg_t *msg, void *arg)
 {
@@ -1055,18 +1162,30 @@ static int journal_process_events (struct job_state_ctx *jsctx,
     json_t *value;
     json_t *jobspec = NULL;
     json_t *R = NULL;
+    json_int_t seq = -1;
+    struct job *job;
 
     if (flux_msg_unpack (msg,
-                        "{s:I s:o s?o s?o}",
+                        "{s:I s:o s?o s?o s?I}",
                         "id", &id,
                         "events", &events,
                         "jobspec", &jobspec,
-                        "R", &R) < 0)
+                        "R", &R,
+                        "seq", &seq) < 0)
         return -1;
     if (!json_is_array (events)) {
         errno = EPROTO;
         return -1;
     }
+    /* The backlog replays a job's eventlog in full, superseding any
+     * copy restored from the snapshot.
+     */
+    if (!jsctx->initialized
+        && (job = zhashx_lookup (jsctx->index, &id))
+        && job->snapshot)
+        drop_restored (jsctx, job);
+    if (seq >= 0)
+        jsctx->journal_seq = seq;
     json_array_foreach (events, index, value) {
         if (journal_process_event (jsctx, id, value, jobspec, R) < 0)
             return -1;
@@ -1085,6 +1204,7 @@ static void job_events_journal_continuation (flux_future_t *f, void *arg)
         || flux_future_get (f, (const void **)&msg) < 0) {
         if (errno == ENODATA) {
             flux_log (jsctx->h, LOG_INFO, "journal: EOF (exiting)");
+            jsctx->journal_eof = true;
             flux_reactor_stop (flux_get_reactor (jsctx->h));
             return;
         }
@@ -1097,6 +1217,23 @@ static void job_events_journal_continuation (flux_future_t *f, void *arg)
      * as they arrive.
      */
     if (id == FLUX_JOBID_ANY) {
+        double epoch = 0.;
+        json_int_t seq = 0;
+        int resumed = 0;
+        json_t *purged = NULL;
+
+        if (flux_rpc_get_unpack (f,
+                                 "{s?F s?I s?b s?o}",
+                                 "epoch", &epoch,
+                                 "seq", &seq,
+                                 "resumed", &resumed,
+                                 "purged", &purged) < 0) {
+            flux_log_error (jsctx->h, "journal: error parsing sentinel");
+            goto error;
+        }
+        sync_restored (jsctx, resumed, purged);
+        jsctx->journal_epoch = epoch;
+        jsctx->journal_seq = seq;
         while ((msg = flux_msglist_pop (jsctx->backlog))) {
             int rc = journal_process_events (jsctx, msg);
             flux_msg_decref (msg);
@@ -1111,6 +1248,7 @@ static void job_events_journal_continuation (flux_future_t *f, void *arg)
         job_state_sort_inactive (jsctx);
         jsctx->initialized = true;
         requeue_deferred_requests (jsctx->ctx);
+        job_snapshot_start (jsctx->snapshot);
         flux_future_reset (f);
         return;
     }
@@ -1136,19 +1274,35 @@ error:
     return;
 }
 
-static flux_future_t *job_events_journal (struct job_state_ctx *jsctx)
+static flux_future_t *job_events_journal (struct job_state_ctx *jsctx,
+                                          bool restored)
 {
     flux_future_t *f;
 
     /* Set full=true so that inactive jobs are included.
      * Don't set allow/deny so that we receive all events.
+     * If restored from a snapshot, ask to resume from it.
      */
-    if (!(f = flux_rpc_pack (jsctx->h,
-                             "job-manager.events-journal",
-                             FLUX_NODEID_ANY,
-                             FLUX_RPC_STREAMING,
-                             "{s:b}",
-                             "full", 1))
+    if (restored) {
+        f = flux_rpc_pack (jsctx->h,
+                           "job-manager.events-journal",
+                           FLUX_NODEID_ANY,
+                           FLUX_RPC_STREAMING,
+                           "{s:b s:{s:f s:I}}",
+                           "full", 1,
+                           "since",
+                             "epoch", jsctx->journal_epoch,
+                             "seq", jsctx->journal_seq);
+    }
+    else {
+        f = flux_rpc_pack (jsctx->h,
+                           "job-manager.events-journal",
+                           FLUX_NODEID_ANY,
+                           FLUX_RPC_STREAMING,
+                           "{s:b}",
+                           "full", 1);
+    }
+    if (!f
         || flux_future_then (f,
                              -1,
                              job_events_journal_continuation,
@@ -1168,6 +1322,7 @@ error:
 struct job_state_ctx *job_state_create (struct list_ctx *ctx)
 {
     struct job_state_ctx *jsctx = NULL;
+    int restored;
 
     if (!(jsctx = calloc (1, sizeof (*jsctx)))) {
         flux_log_error (ctx->h, "calloc");
@@ -1197,6 +1352,9 @@ struct job_state_ctx *job_state_create (struct list_ctx *ctx)
         goto error;
     zlistx_set_comparator (jsctx->inactive, job_inactive_cmp);
 
+    if (!(jsctx->inactive_index = job_index_create (job_inactive_cmp)))
+        goto error;
+
     if (!(jsctx->processing = zlistx_new ()))
         goto error;
 
@@ -1206,7 +1364,12 @@ struct job_state_ctx *job_state_create (struct list_ctx *ctx)
     if (!(jsctx->backlog = flux_msglist_create ()))
         goto error;
 
-    if (!(jsctx->events = job_events_journal (jsctx)))
+    if (!(jsctx->snapshot = job_snapshot_create (jsctx)))
+        goto error;
+    if ((restored = job_snapshot_restore (jsctx->snapshot)) < 0)
+        flux_log (jsctx->h, LOG_ERR, "snapshot restore failed, replaying");
+
+    if (!(jsctx->events = job_events_journal (jsctx, restored > 0)))
         goto error;
 
     return jsctx;
@@ -1227,10 +1390,12 @@ void job_state_destroy (void *data)
         zlistx_destroy (&jsctx->inactive);
         zlistx_destroy (&jsctx->running);
         zlistx_destroy (&jsctx->pending);
+        job_index_destroy (jsctx->inactive_index);
         zhashx_destroy (&jsctx->index);
         job_stats_ctx_destroy (jsctx->statsctx);
         flux_msglist_destroy (jsctx->backlog);
         flux_future_destroy (jsctx->events);
+        job_snapshot_destroy (jsctx->snapshot);
         free (jsctx);
         errno = saved_errno;
     }
@@ -1240,6 +1405,8 @@ int job_state_config_reload (struct job_state_ctx *jsctx,
                              const flux_conf_t *conf,
                              flux_error_t *errp)
 {
+    if (job_snapshot_config_reload (jsctx->snapshot, conf, errp) < 0)
+        return -1;
     return job_stats_config_reload (jsctx->statsctx, conf, errp);
 }
 
@@ -18,6 +18,8 @@
 
 #include "idsync.h"
 #include "stats.h"
+#include "job_index.h"
+#include "snapshot.h"
 
 /* To handle the common case of user queries on job state, we will
  * store jobs in three different lists.
@@ -34,6 +36,14 @@
  *
  * There is also an additional list `processing` that stores jobs that
  * cannot yet be stored on one of the lists above.
+ *
+ * Inactive jobs are also held in secondary indexes keyed on userid,
+ * name, queue, result and ranks (see job_index.h), so that filtered
+ * queries need not scan the entire inactive list.
+ *
+ * Inactive jobs are periodically saved to a snapshot (see snapshot.h).
+ * On reload they are restored from it, and the job-manager journal is
+ * asked to resume from the snapshot's sequence number.
  */
 
 struct job_state_ctx {
@@ -45,6 +55,7 @@ struct job_state_ctx {
     zlistx_t *running;
     zlistx_t *inactive;
     zlistx_t *processing;
+    struct job_index *inactive_index;
 
     /*  Job statistics: */
     struct job_stats_ctx *statsctx;
@@ -56,6 +67,15 @@ struct job_state_ctx {
     /* stream of job events from the job-manager */
     flux_future_t *events;
 
+    /* journal position of the last event processed, and the number
+     * of jobs restored from a snapshot
+     */
+    double journal_epoch;
+    json_int_t journal_seq;
+    int restored;
+    bool journal_eof;
+    struct job_snapshot *snapshot;
+
     bool initialized;
 };
 
@@ -69,6 +89,18 @@ void job_state_pause_cb (flux_t *h, flux_msg_handler_t *mh,
 void job_state_unpause_cb (flux_t *h, flux_msg_handler_t *mh,
                            const flux_msg_t *msg, void *arg);
 
+/* Add an inactive job restored from a snapshot.
+ */
+int job_state_restore_inactive (struct job_state_ctx *jsctx, struct job *job);
+
+/* Remove a purged inactive job.
+ */
+void job_state_purge_inactive (struct job_state_ctx *jsctx, struct job *job);
+
+/* Save a snapshot of inactive jobs, if the journal has been synchronized.
+ */
+void job_state_save_snapshot (struct job_state_ctx *jsctx);
+
 int job_state_config_reload (struct job_state_ctx *jsctx,
                              const flux_conf_t *conf,
                              flux_error_t *errp);
@@ -29,6 +29,7 @@
 #include "job_data.h"
 #include "match.h"
 #include "state_match.h"
+#include "job_index.h"
 
 json_t *get_job_by_id (struct job_state_ctx *jsctx,
                        flux_error_t *errp,
@@ -59,6 +60,37 @@ static int check_job_visible (struct list_ctx *ctx,
     return 0;
 }
 
+/* Put 'job' onto jobs array if it matches constraint 'c'.  Returns 1 if
+ * jobs array is full, 0 if continue, -1 on error with errno set:
+ *
+ * ENOMEM - out of memory
+ */
+static int get_job_append (json_t *jobs,
+                           flux_error_t *errp,
+                           struct job *job,
+                           int max_entries,
+                           json_t *attrs,
+                           struct list_constraint *c)
+{
+    int ret;
+
+    if ((ret = job_match (job, c, errp)) < 0)
+        return -1;
+    if (ret) {
+        json_t *o;
+        if (!(o = job_to_json (job, attrs, errp)))
+            return -1;
+        if (json_array_append_new (jobs, o) < 0) {
+            // jansson decrefs the new object on failure
+            errno = ENOMEM;
+            return -1;
+        }
+        if (json_array_size (jobs) == max_entries)
+            return 1;
+    }
+    return 0;
+}
+
 /* Put jobs from list onto jobs array, breaking if max_entries has
  * been reached. Returns 1 if jobs array is full, 0 if continue, -1
  * one error with errno set:
@@ -90,26 +122,85 @@ int get_jobs_from_list (json_t *jobs,
         if (job->t_inactive > 0. && job->t_inactive <= since)
             break;
 
-        if ((ret = job_match (job, c, errp)) < 0)
-            return -1;
-        if (ret) {
-            json_t *o;
-            if (!(o = job_to_json (job, attrs, errp)))
-                return -1;
-            if (json_array_append_new (jobs, o) < 0) {
-                // jansson decrefs the new object on failure
-                errno = ENOMEM;
-                return -1;
-            }
-            if (json_array_size (jobs) == max_entries)
-                return 1;
-        }
+        if ((ret = get_job_append (jobs,
+                                   errp,
+                                   job,
+                                   max_entries,
+                                   attrs,
+                                   c)) != 0)
+            return ret;
         job = zlistx_next (list);
     }
 
     return 0;
 }
 
+/* Same as get_jobs_from_list() for inactive jobs, but only visit the
+ * candidates returned by a secondary index iterator, which are in the
+ * same order as the inactive list.
+ */
+static int get_jobs_from_index (json_t *jobs,
+                                flux_error_t *errp,
+                                struct job_index_iter *iter,
+                                int max_entries,
+                                json_t *attrs,
+                                double since,
+                                struct list_constraint *c)
+{
+    struct job *job;
+
+    while ((job = job_index_iter_next (iter))) {
+        int ret;
+
+        if (job->t_inactive <= since)
+            break;
+        if ((ret = get_job_append (jobs,
+                                   errp,
+                                   job,
+                                   max_entries,
+                                   attrs,
+                                   c)) != 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+/* Fetch inactive jobs, using the most selective secondary index for
+ * constraint 'c' if there is one, otherwise scanning the inactive list.
+ */
+static int get_jobs_inactive (struct job_state_ctx *jsctx,
+                              json_t *jobs,
+                              flux_error_t *errp,
+                              int max_entries,
+                              json_t *attrs,
+                              double since,
+                              struct list_constraint *c)
+{
+    struct job_index_iter *iter;
+    int ret;
+
+    if (!(iter = list_constraint_plan (c,
+                                       jsctx->inactive_index,
+                                       zlistx_size (jsctx->inactive))))
+        return get_jobs_from_list (jobs,
+                                   errp,
+                                   jsctx->inactive,
+                                   max_entries,
+                                   attrs,
+                                   since,
+                                   c);
+    ret = get_jobs_from_index (jobs,
+                               errp,
+                               iter,
+                               max_entries,
+                               attrs,
+                               since,
+                               c);
+    job_index_iter_destroy (iter);
+    return ret;
+}
+
 /* Create a JSON array of 'job' objects.  'max_entries' determines the
  * max number of jobs to return, 0=unlimited. 'since' limits jobs returned
  * to those with t_inactive greater than timestamp.  Returns JSON object
@@ -162,13 +253,13 @@ json_t *get_jobs (struct job_state_ctx *jsctx,
 
     if (state_match (FLUX_JOB_STATE_INACTIVE, statec)) {
         if (!ret) {
-            if ((ret = get_jobs_from_list (jobs,
-                                           errp,
-                                           jsctx->inactive,
-                                           max_entries,
-                                           attrs,
-                                           since,
-                                           c)) < 0)
+            if ((ret = get_jobs_inactive (jsctx,
+                                          jobs,
+                                          errp,
+                                          max_entries,
+                                          attrs,
+                                          since,
+                                          c)) < 0)
                 goto error;
         }
     }
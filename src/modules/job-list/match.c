@@ -914,6 +914,141 @@ int job_match (const struct job *job,
     return constraint->match (constraint, job, &constraint->comparisons, errp);
 }
 
+/* RFC 33 virtual queues: a queue constraint also matches jobs in
+ * virtual queues of the named queue (see queue_name_matches()), so add
+ * their buckets too.
+ */
+static int plan_add_queue (struct job_index_iter *iter,
+                           struct match_ctx *mctx,
+                           const char *queue)
+{
+    const char *parent;
+
+    if (job_index_iter_add_queue (iter, queue) < 0)
+        return -1;
+    if (mctx->queue_parents) {
+        parent = zhashx_first (mctx->queue_parents);
+        while (parent) {
+            if (streq (parent, queue)
+                && job_index_iter_add_queue (
+                       iter,
+                       zhashx_cursor (mctx->queue_parents)) < 0)
+                return -1;
+            parent = zhashx_next (mctx->queue_parents);
+        }
+    }
+    return 0;
+}
+
+/* Return an iterator for a single userid, name, queue, results, or
+ * ranks constraint, or NULL if 'c' cannot be satisfied from an index.
+ */
+static struct job_index_iter *plan_leaf (struct list_constraint *c,
+                                         struct job_index *idx)
+{
+    struct job_index_iter *iter;
+
+    if (c->match != match_userid
+        && c->match != match_name
+        && c->match != match_queue
+        && c->match != match_results
+        && c->match != match_ranks)
+        return NULL;
+    if (!(iter = job_index_iter_create (idx)))
+        return NULL;
+    if (c->match == match_userid) {
+        uint32_t *userid = zlistx_first (c->values);
+        while (userid) {
+            /* FLUX_USERID_UNKNOWN matches any user */
+            if ((*userid) == FLUX_USERID_UNKNOWN
+                || job_index_iter_add_userid (iter, *userid) < 0)
+                goto error;
+            userid = zlistx_next (c->values);
+        }
+    }
+    else if (c->match == match_name) {
+        const char *name = zlistx_first (c->values);
+        while (name) {
+            if (job_index_iter_add_name (iter, name) < 0)
+                goto error;
+            name = zlistx_next (c->values);
+        }
+    }
+    else if (c->match == match_queue) {
+        const char *queue = zlistx_first (c->values);
+        while (queue) {
+            if (plan_add_queue (iter, c->mctx, queue) < 0)
+                goto error;
+            queue = zlistx_next (c->values);
+        }
+    }
+    else if (c->match == match_results) {
+        int *results = zlistx_first (c->values);
+        int bit;
+        for (bit = 1; bit <= FLUX_JOB_RESULT_TIMEOUT; bit <<= 1) {
+            if (((*results) & bit)
+                && job_index_iter_add_result (iter, bit) < 0)
+                goto error;
+        }
+    }
+    else { /* c->match == match_ranks */
+        struct idset *idset = zlistx_first (c->values);
+        if (job_index_iter_add_ranks (iter, idset) < 0)
+            goto error;
+    }
+    return iter;
+error:
+    job_index_iter_destroy (iter);
+    return NULL;
+}
+
+/* A job must match every term of an "and", so any indexable term
+ * yields a superset of the matches.  Use the one with fewest candidates.
+ * "or" and "not" are not planned, and fall back to a scan.
+ */
+static struct job_index_iter *plan (struct list_constraint *c,
+                                    struct job_index *idx)
+{
+    struct job_index_iter *best = NULL;
+    struct list_constraint *cp;
+
+    if (c->match != match_and)
+        return plan_leaf (c, idx);
+
+    cp = zlistx_first (c->values);
+    while (cp) {
+        struct job_index_iter *iter;
+
+        if ((iter = plan (cp, idx))) {
+            if (!best
+                || job_index_iter_count (iter) < job_index_iter_count (best)) {
+                job_index_iter_destroy (best);
+                best = iter;
+            }
+            else
+                job_index_iter_destroy (iter);
+        }
+        cp = zlistx_next (c->values);
+    }
+    return best;
+}
+
+struct job_index_iter *list_constraint_plan (struct list_constraint *c,
+                                             struct job_index *idx,
+                                             size_t max_count)
+{
+    struct job_index_iter *iter;
+
+    if (!c || !idx)
+        return NULL;
+    if ((iter = plan (c, idx))
+        && job_index_iter_count (iter) >= max_count) {
+        job_index_iter_destroy (iter);
+        return NULL;
+    }
+    return iter;
+}
+
 static int config_parse_max_comparisons (struct match_ctx *mctx,
                                          const flux_conf_t *conf,
                                          flux_error_t *errp)
@@ -21,6 +21,7 @@
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
 #include "job_data.h"
+#include "job_index.h"
 
 struct match_ctx {
     flux_t *h;
@@ -59,6 +60,17 @@ int job_match (const struct job *job,
                struct list_constraint *constraint,
                flux_error_t *errp);
 
+/*  Select the most selective index in 'idx' that can be used to find
+ *  inactive jobs matching 'constraint'.  Returns an iterator over the
+ *  candidate jobs in inactive list order, or NULL if no index would
+ *  return fewer than 'max_count' candidates and the inactive list
+ *  should be scanned instead.  Candidates must still be checked with
+ *  job_match().
+ */
+struct job_index_iter *list_constraint_plan (struct list_constraint *c,
+                                             struct job_index *idx,
+                                             size_t max_count);
+
 int job_match_config_reload (struct match_ctx *mctx,
                              const flux_conf_t *conf,
                              flux_error_t *errp);
@@ -0,0 +1,833 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* snapshot.c - save and restore inactive jobs in columnar form
+ *
+ * Snapshot format (version 1):
+ *   {"version":1, "epoch":F, "seq":I, "count":N,
+ *    "strings":[s,...], "columns":{"id":[I,...], "name":[i,...], ...}}
+ *
+ * Each column is an array of N values, one per job.  String columns hold
+ * an index into "strings", or -1 for NULL.  Job names, queues, exception
+ * types and so on repeat heavily, so this keeps both the blob and the
+ * restored jobs small.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libcontent/content.h"
+#include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/fsd.h"
+#include "src/common/libutil/grudgeset.h"
+
+#include "job_state.h"
+#include "job_data.h"
+#include "snapshot.h"
+
+#define SNAPSHOT_VERSION 1
+
+static const char *checkpoint_key = "checkpoint.job-list";
+
+/* Default snapshot-interval */
+static const double default_interval = 3600.;
+
+enum column_type {
+    COL_INT,                // int
+    COL_INT64,              // int64_t
+    COL_UINT,               // unsigned int
+    COL_UINT32,             // uint32_t
+    COL_REAL,               // double
+    COL_BOOL,               // bool
+    COL_STRING,             // const char *, dictionary encoded
+    COL_STRDUP,             // char *, owned by job
+};
+
+struct column {
+    const char *name;
+    enum column_type type;
+    size_t offset;
+};
+
+#define COLUMN(t, field) { #field, (t), offsetof (struct job, field) }
+
+/* Columns stored generically.  id, result, annotations, and dependencies
+ * are handled separately below.
+ */
+static const struct column columns[] = {
+    COLUMN (COL_UINT32, userid),
+    COLUMN (COL_INT, urgency),
+    COLUMN (COL_INT64, priority),
+    COLUMN (COL_REAL, t_submit),
+    COLUMN (COL_REAL, t_depend),
+    COLUMN (COL_REAL, t_priority),
+    COLUMN (COL_REAL, t_sched),
+    COLUMN (COL_REAL, t_run),
+    COLUMN (COL_REAL, t_cleanup),
+    COLUMN (COL_REAL, t_inactive),
+    COLUMN (COL_STRING, name),
+    COLUMN (COL_STRING, queue),
+    COLUMN (COL_STRING, cwd),
+    COLUMN (COL_STRING, project),
+    COLUMN (COL_STRING, bank),
+    COLUMN (COL_INT, ntasks),
+    COLUMN (COL_INT, ncores),
+    COLUMN (COL_REAL, duration),
+    COLUMN (COL_INT, nnodes),
+    COLUMN (COL_STRDUP, ranks),
+    COLUMN (COL_STRDUP, nodelist),
+    COLUMN (COL_REAL, expiration),
+    COLUMN (COL_INT, wait_status),
+    COLUMN (COL_BOOL, success),
+    COLUMN (COL_BOOL, exception_occurred),
+    COLUMN (COL_INT, exception_severity),
+    COLUMN (COL_STRING, exception_type),
+    COLUMN (COL_STRING, exception_note),
+    COLUMN (COL_UINT, states_mask),
+    COLUMN (COL_UINT, states_events_mask),
+    COLUMN (COL_INT, submit_version),
+};
+
+#define NR_COLUMNS (sizeof (columns) / sizeof (columns[0]))
+
+struct job_snapshot {
+    flux_t *h;
+    struct job_state_ctx *jsctx;
+    const char *hash_name;
+    double interval;
+    flux_watcher_t *timer;
+    bool started;
+
+    flux_future_t *f;       // save in progress
+    double save_epoch;      // journal position of save in progress
+    json_int_t save_seq;
+    double saved_epoch;     // journal position of last completed save
+    json_int_t saved_seq;
+};
+
+/* String dictionary used during encode.  Indexes are stored in the hash
+ * offset by one so that index 0 is not confused with "not found".
+ */
+struct strtab {
+    zhashx_t *hash;
+    json_t *strings;
+};
+
+static int strtab_index (struct strtab *tab, const char *s, json_int_t *ip)
+{
+    uintptr_t i;
+    json_t *o;
+
+    if (!s) {
+        *ip = -1;
+        return 0;
+    }
+    if ((i = (uintptr_t)zhashx_lookup (tab->hash, s))) {
+        *ip = i - 1;
+        return 0;
+    }
+    i = json_array_size (tab->strings);
+    if (!(o = json_string (s))
+        || json_array_append_new (tab->strings, o) < 0) {
+        // jansson decrefs the new object on failure
+        goto nomem;
+    }
+    if (zhashx_insert (tab->hash, s, (void *)(i + 1)) < 0)
+        goto nomem;
+    *ip = i;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static json_t *encode_value (const struct column *col,
+                             struct job *job,
+                             struct strtab *tab)
+{
+    const char *p = (const char *)job + col->offset;
+    json_int_t i;
+
+    switch (col->type) {
+        case COL_INT:
+            return json_integer (*(const int *)p);
+        case COL_INT64:
+            return json_integer (*(const int64_t *)p);
+        case COL_UINT:
+            return json_integer (*(const unsigned int *)p);
+        case COL_UINT32:
+            return json_integer (*(const uint32_t *)p);
+        case COL_REAL:
+            return json_real (*(const double *)p);
+        case COL_BOOL:
+            return json_boolean (*(const bool *)p);
+        case COL_STRING:
+            if (strtab_index (tab, *(const char **)p, &i) < 0)
+                return NULL;
+            return json_integer (i);
+        case COL_STRDUP:
+            if (!*(char **)p)
+                return json_null ();
+            return json_string (*(char **)p);
+    }
+    return NULL;
+}
+
+static int column_append (json_t *cols, const char *name, json_t *val)
+{
+    json_t *a;
+
+    if (!val)
+        goto nomem;
+    if (!(a = json_object_get (cols, name))) {
+        json_decref (val);
+        goto nomem;
+    }
+    if (json_array_append_new (a, val) < 0) {
+        // jansson decrefs the new object on failure
+        goto nomem;
+    }
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
+static int column_create (json_t *cols, const char *name)
+{
+    json_t *a;
+
+    if (!(a = json_array ())
+        || json_object_set_new (cols, name, a) < 0) {
+        // jansson decrefs the new object on failure
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+/* Create all columns up front, so that an empty snapshot has them too.
+ */
+static json_t *columns_create (void)
+{
+    json_t *cols;
+    int i;
+
+    if (!(cols = json_object ())
+        || column_create (cols, "id") < 0
+        || column_create (cols, "result") < 0
+        || column_create (cols, "annotations") < 0
+        || column_create (cols, "dependencies") < 0)
+        goto nomem;
+    for (i = 0; i < NR_COLUMNS; i++) {
+        if (column_create (cols, columns[i].name) < 0)
+            goto nomem;
+    }
+    return cols;
+nomem:
+    json_decref (cols);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static int encode_job (json_t *cols, struct job *job, struct strtab *tab)
+{
+    json_t *deps = NULL;
+    int i;
+
+    if (column_append (cols, "id", json_integer (job->id)) < 0
+        || column_append (cols, "result", json_integer (job->result)) < 0)
+        return -1;
+    for (i = 0; i < NR_COLUMNS; i++) {
+        if (column_append (cols,
+                           columns[i].name,
+                           encode_value (&columns[i], job, tab)) < 0)
+            return -1;
+    }
+    if (job->dependencies)
+        deps = grudgeset_tojson (job->dependencies);
+    if (column_append (cols,
+                       "annotations",
+                       job->annotations ? json_incref (job->annotations)
+                                        : json_null ()) < 0
+        || column_append (cols,
+                          "dependencies",
+                          deps ? json_incref (deps) : json_null ()) < 0)
+        return -1;
+    return 0;
+}
+
+json_t *job_snapshot_encode (zlistx_t *jobs, double epoch, json_int_t seq)
+{
+    struct strtab tab = { 0 };
+    struct job *job;
+    json_t *cols = NULL;
+    json_t *o = NULL;
+
+    if (!jobs) {
+        errno = EINVAL;
+        return NULL;
+    }
+    if (!(tab.hash = zhashx_new ())
+        || !(tab.strings = json_array ())
+        || !(cols = columns_create ()))
+        goto nomem;
+    job = zlistx_first (jobs);
+    while (job) {
+        if (encode_job (cols, job, &tab) < 0)
+            goto nomem;
+        job = zlistx_next (jobs);
+    }
+    if (!(o = json_pack ("{s:i s:f s:I s:I s:O s:O}",
+                         "version", SNAPSHOT_VERSION,
+                         "epoch", epoch,
+                         "seq", seq,
+                         "count", (json_int_t)zlistx_size (jobs),
+                         "strings", tab.strings,
+                         "columns", cols)))
+        goto nomem;
+    zhashx_destroy (&tab.hash);
+    json_decref (tab.strings);
+    json_decref (cols);
+    return o;
+nomem:
+    zhashx_destroy (&tab.hash);
+    json_decref (tab.strings);
+    json_decref (cols);
+    errno = ENOMEM;
+    return NULL;
+}
+
+static int decode_value (const struct column *col,
+                         struct job *job,
+                         json_t *val,
+                         json_t *strings)
+{
+    char *p = (char *)job + col->offset;
+    json_int_t i;
+
+    switch (col->type) {
+        case COL_INT:
+            if (!json_is_integer (val))
+                goto eproto;
+            *(int *)p = json_integer_value (val);
+            break;
+        case COL_INT64:
+            if (!json_is_integer (val))
+                goto eproto;
+            *(int64_t *)p = json_integer_value (val);
+            break;
+        case COL_UINT:
+            if (!json_is_integer (val))
+                goto eproto;
+            *(unsigned int *)p = json_integer_value (val);
+            break;
+        case COL_UINT32:
+            if (!json_is_integer (val))
+                goto eproto;
+            *(uint32_t *)p = json_integer_value (val);
+            break;
+        case COL_REAL:
+            if (!json_is_number (val))
+                goto eproto;
+            *(double *)p = json_number_value (val);
+            break;
+        case COL_BOOL:
+            if (!json_is_boolean (val))
+                goto eproto;
+            *(bool *)p = json_is_true (val);
+            break;
+        case COL_STRING:
+            if (!json_is_integer (val))
+                goto eproto;
+            if ((i = json_integer_value (val)) < 0)
+                *(const char **)p = NULL;
+            else {
+                json_t *s = json_array_get (strings, i);
+                if (!json_is_string (s))
+                    goto eproto;
+                *(const char **)p = json_string_value (s);
+            }
+            break;
+        case COL_STRDUP:
+            if (json_is_null (val))
+                *(char **)p = NULL;
+            else {
+                if (!json_is_string (val))
+                    goto eproto;
+                if (!(*(char **)p = strdup (json_string_value (val))))
+                    return -1;
+            }
+            break;
+    }
+    return 0;
+eproto:
+    errno = EPROTO;
+    return -1;
+}
+
+static int decode_dependencies (struct job *job, json_t *deps)
+{
+    size_t index;
+    json_t *entry;
+
+    if (json_is_null (deps))
+        return 0;
+    if (!json_is_array (deps)) {
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (deps, index, entry) {
+        if (!json_is_string (entry)) {
+            errno = EPROTO;
+            return -1;
+        }
+        if (grudgeset_add (&job->dependencies, json_string_value (entry)) < 0
+            && errno != EEXIST)
+            return -1;
+    }
+    return 0;
+}
+
+static json_t *get_column (json_t *cols,
+                           const char *name,
+                           size_t count,
+                           flux_error_t *errp)
+{
+    json_t *a = json_object_get (cols, name);
+
+    if (!json_is_array (a) || json_array_size (a) != count) {
+        errprintf (errp, "snapshot column %s missing or malformed", name);
+        errno = EPROTO;
+        return NULL;
+    }
+    return a;
+}
+
+int job_snapshot_decode (flux_t *h,
+                         json_t *o,
+                         double *epoch,
+                         json_int_t *seq,
+                         job_snapshot_restore_f cb,
+                         void *arg,
+                         flux_error_t *errp)
+{
+    int version;
+    json_int_t count;
+    json_t *strings;
+    json_t *cols;
+    json_t *id_col, *result_col, *annotations_col, *dependencies_col;
+    json_t *col[NR_COLUMNS];
+    json_error_t jerror;
+    size_t index;
+    json_t *entry;
+    int i;
+
+    if (!o || !cb) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (json_unpack_ex (o,
+                        &jerror,
+                        0,
+                        "{s:i s:F s:I s:I s:o s:o}",
+                        "version", &version,
+                        "epoch", epoch,
+                        "seq", seq,
+                        "count", &count,
+                        "strings", &strings,
+                        "columns", &cols) < 0) {
+        errprintf (errp, "error decoding snapshot: %s", jerror.text);
+        errno = EPROTO;
+        return -1;
+    }
+    if (version != SNAPSHOT_VERSION) {
+        errprintf (errp, "unsupported snapshot version %d", version);
+        errno = EINVAL;
+        return -1;
+    }
+    if (count < 0 || !json_is_array (strings)) {
+        errprintf (errp, "snapshot is malformed");
+        errno = EPROTO;
+        return -1;
+    }
+    json_array_foreach (strings, index, entry) {
+        if (!json_is_string (entry)) {
+            errprintf (errp, "snapshot string table is malformed");
+            errno = EPROTO;
+            return -1;
+        }
+    }
+    if (!(id_col = get_column (cols, "id", count, errp))
+        || !(result_col = get_column (cols, "result", count, errp))
+        || !(annotations_col = get_column (cols, "annotations", count, errp))
+        || !(dependencies_col = get_column (cols,
+                                            "dependencies",
+                                            count,
+                                            errp)))
+        return -1;
+    for (i = 0; i < NR_COLUMNS; i++) {
+        if (!(col[i] = get_column (cols, columns[i].name, count, errp)))
+            return -1;
+    }
+    for (index = 0; index < count; index++) {
+        json_t *id = json_array_get (id_col, index);
+        json_t *result = json_array_get (result_col, index);
+        json_t *annotations = json_array_get (annotations_col, index);
+        struct job *job;
+
+        if (!json_is_integer (id)
+            || !json_is_integer (result)
+            || (!json_is_null (annotations) && !json_is_object (annotations))) {
+            errprintf (errp, "snapshot job %zu is malformed", index);
+            errno = EPROTO;
+            return -1;
+        }
+        if (!(job = job_create (h, json_integer_value (id)))) {
+            errprintf (errp, "out of memory");
+            return -1;
+        }
+        job->snapshot = json_incref (strings);
+        job->result = json_integer_value (result);
+        if (json_is_object (annotations))
+            job->annotations = json_incref (annotations);
+        for (i = 0; i < NR_COLUMNS; i++) {
+            if (decode_value (&columns[i],
+                              job,
+                              json_array_get (col[i], index),
+                              strings) < 0)
+                goto error_job;
+        }
+        if (decode_dependencies (job,
+                                 json_array_get (dependencies_col,
+                                                 index)) < 0)
+            goto error_job;
+        if (cb (job, arg) < 0) {
+            errprintf (errp,
+                       "error restoring snapshot job %zu: %s",
+                       index,
+                       strerror (errno));
+            return -1;
+        }
+        continue;
+error_job:
+        errprintf (errp,
+                   "error decoding snapshot job %zu: %s",
+                   index,
+                   strerror (errno));
+        job_destroy (job);
+        return -1;
+    }
+    return count;
+}
+
+static int restore_cb (struct job *job, void *arg)
+{
+    struct job_snapshot *snap = arg;
+
+    return job_state_restore_inactive (snap->jsctx, job);
+}
+
+int job_snapshot_restore (struct job_snapshot *snap)
+{
+    flux_future_t *f;
+    flux_future_t *f2 = NULL;
+    int version;
+    const char *blobref;
+    const void *buf;
+    size_t len;
+    json_t *o = NULL;
+    json_error_t jerror;
+    flux_error_t error;
+    double epoch;
+    json_int_t seq;
+    int count;
+    int rc = -1;
+
+    if (!(f = flux_kvs_lookup (snap->h, NULL, 0, checkpoint_key)))
+        return -1;
+    if (flux_kvs_lookup_get_unpack (f,
+                                    "{s:i s:s}",
+                                    "version", &version,
+                                    "blobref", &blobref) < 0) {
+        if (errno == ENOENT) {
+            flux_log (snap->h, LOG_DEBUG, "no snapshot found");
+            rc = 0;
+        }
+        else
+            flux_log_error (snap->h, "%s", checkpoint_key);
+        goto done;
+    }
+    if (version != SNAPSHOT_VERSION) {
+        flux_log (snap->h,
+                  LOG_INFO,
+                  "%s: ignoring version %d snapshot",
+                  checkpoint_key,
+                  version);
+        rc = 0;
+        goto done;
+    }
+    if (!(f2 = content_load_byblobref (snap->h, blobref, 0))
+        || content_load_get (f2, &buf, &len) < 0) {
+        flux_log_error (snap->h, "error loading snapshot %s", blobref);
+        goto done;
+    }
+    if (!(o = json_loadb (buf, len, 0, &jerror))) {
+        flux_log (snap->h, LOG_ERR, "error parsing snapshot: %s", jerror.text);
+        errno = EPROTO;
+        goto done;
+    }
+    if ((count = job_snapshot_decode (snap->h,
+                                      o,
+                                      &epoch,
+                                      &seq,
+                                      restore_cb,
+                                      snap,
+                                      &error)) < 0) {
+        flux_log (snap->h, LOG_ERR, "%s", error.text);
+        goto done;
+    }
+    snap->jsctx->journal_epoch = epoch;
+    snap->jsctx->journal_seq = seq;
+    snap->saved_epoch = epoch;
+    snap->saved_seq = seq;
+    flux_log (snap->h,
+              LOG_DEBUG,
+              "restored %d inactive jobs from snapshot",
+              count);
+    rc = 1;
+done:
+    json_decref (o);
+    flux_future_destroy (f2);
+    flux_future_destroy (f);
+    return rc;
+}
+
+/* Skip the save if nothing has changed since the last one.
+ */
+static bool snapshot_is_current (struct job_snapshot *snap)
+{
+    return (snap->saved_epoch == snap->jsctx->journal_epoch
+            && snap->saved_seq == snap->jsctx->journal_seq);
+}
+
+static flux_future_t *snapshot_store (struct job_snapshot *snap)
+{
+    json_t *o;
+    char *s;
+    flux_future_t *f;
+
+    if (!(o = job_snapshot_encode (snap->jsctx->inactive,
+                                   snap->jsctx->journal_epoch,
+                                   snap->jsctx->journal_seq)))
+        return NULL;
+    s = json_dumps (o, JSON_COMPACT);
+    json_decref (o);
+    if (!s) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    snap->save_epoch = snap->jsctx->journal_epoch;
+    snap->save_seq = snap->jsctx->journal_seq;
+    f = content_store (snap->h, s, strlen (s), 0);
+    free (s);
+    return f;
+}
+
+static flux_future_t *checkpoint_commit (struct job_snapshot *snap,
+                                         flux_future_t *f)
+{
+    const char *blobref;
+    flux_kvs_txn_t *txn;
+    flux_future_t *f2 = NULL;
+
+    if (content_store_get_blobref (f, snap->hash_name, &blobref) < 0
+        || !(txn = flux_kvs_txn_create ()))
+        return NULL;
+    if (flux_kvs_txn_pack (txn,
+                           0,
+                           checkpoint_key,
+                           "{s:i s:s}",
+                           "version", SNAPSHOT_VERSION,
+                           "blobref", blobref) == 0)
+        f2 = flux_kvs_commit (snap->h, NULL, 0, txn);
+    flux_kvs_txn_destroy (txn);
+    return f2;
+}
+
+static void store_continuation (flux_future_t *f, void *arg)
+{
+    struct job_snapshot *snap = arg;
+    flux_future_t *fnext;
+
+    if (!(fnext = checkpoint_commit (snap, f)))
+        flux_future_continue_error (f, errno, NULL);
+    else
+        flux_future_continue (f, fnext);
+    flux_future_destroy (f);
+}
+
+static void save_continuation (flux_future_t *f, void *arg)
+{
+    struct job_snapshot *snap = arg;
+
+    if (flux_future_get (f, NULL) < 0)
+        flux_log (snap->h,
+                  LOG_ERR,
+                  "error saving snapshot: %s",
+                  future_strerror (f, errno));
+    else {
+        snap->saved_epoch = snap->save_epoch;
+        snap->saved_seq = snap->save_seq;
+    }
+    flux_future_destroy (f);
+    snap->f = NULL;
+}
+
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct job_snapshot *snap = arg;
+    flux_future_t *f = NULL;
+    flux_future_t *f2;
+
+    if (snap->f || snapshot_is_current (snap))
+        return;
+    if (!(f = snapshot_store (snap))
+        || !(f2 = flux_future_and_then (f, store_continuation, snap))
+        || flux_future_then (f2, -1., save_continuation, snap) < 0) {
+        flux_log_error (snap->h, "error starting snapshot save");
+        flux_future_destroy (f);
+        return;
+    }
+    snap->f = f2;
+}
+
+int job_snapshot_save (struct job_snapshot *snap)
+{
+    flux_future_t *f = NULL;
+    flux_future_t *f2 = NULL;
+    int rc = -1;
+
+    /* A periodic save in progress is superseded by this one.
+     */
+    flux_future_destroy (snap->f);
+    snap->f = NULL;
+
+    if (snapshot_is_current (snap))
+        return 0;
+    if (!(f = snapshot_store (snap))
+        || !(f2 = checkpoint_commit (snap, f))
+        || flux_future_get (f2, NULL) < 0)
+        goto done;
+    snap->saved_epoch = snap->save_epoch;
+    snap->saved_seq = snap->save_seq;
+    flux_log (snap->h,
+              LOG_DEBUG,
+              "saved snapshot of %zu inactive jobs",
+              zlistx_size (snap->jsctx->inactive));
+    rc = 0;
+done:
+    flux_future_destroy (f2);
+    flux_future_destroy (f);
+    return rc;
+}
+
+static void snapshot_timer_update (struct job_snapshot *snap)
+{
+    if (snap->started && snap->interval > 0.) {
+        flux_timer_watcher_reset (snap->timer, snap->interval, snap->interval);
+        flux_watcher_start (snap->timer);
+    }
+    else
+        flux_watcher_stop (snap->timer);
+}
+
+void job_snapshot_start (struct job_snapshot *snap)
+{
+    if (snap) {
+        snap->started = true;
+        snapshot_timer_update (snap);
+    }
+}
+
+int job_snapshot_config_reload (struct job_snapshot *snap,
+                                const flux_conf_t *conf,
+                                flux_error_t *errp)
+{
+    flux_error_t e;
+    const char *fsd = NULL;
+    double interval = default_interval;
+
+    if (flux_conf_unpack (conf,
+                          &e,
+                          "{s?{s?s}}",
+                          "job-list",
+                            "snapshot-interval", &fsd) < 0)
+        return errprintf (errp, "job-list.snapshot-interval: %s", e.text);
+    if (fsd) {
+        if (fsd_parse_duration (fsd, &interval) < 0)
+            return errprintf (errp, "job-list.snapshot-interval: invalid FSD");
+    }
+    if (interval != snap->interval) {
+        snap->interval = interval;
+        snapshot_timer_update (snap);
+    }
+    return 0;
+}
+
+void job_snapshot_destroy (struct job_snapshot *snap)
+{
+    if (snap) {
+        int saved_errno = errno;
+        flux_watcher_destroy (snap->timer);
+        flux_future_destroy (snap->f);
+        free (snap);
+        errno = saved_errno;
+    }
+}
+
+struct job_snapshot *job_snapshot_create (struct job_state_ctx *jsctx)
+{
+    struct job_snapshot *snap;
+
+    if (!(snap = calloc (1, sizeof (*snap))))
+        return NULL;
+    snap->h = jsctx->h;
+    snap->jsctx = jsctx;
+    snap->interval = default_interval;
+    snap->saved_seq = -1;
+    if (!(snap->hash_name = flux_attr_get (snap->h, "content.hash"))
+        || !(snap->timer = flux_timer_watcher_create (flux_get_reactor (snap->h),
+                                                      0.,
+                                                      0.,
+                                                      timer_cb,
+                                                      snap)))
+        goto error;
+    return snap;
+error:
+    job_snapshot_destroy (snap);
+    return NULL;
+}
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -0,0 +1,79 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _FLUX_JOB_LIST_SNAPSHOT_H
+#define _FLUX_JOB_LIST_SNAPSHOT_H
+
+#include <flux/core.h>
+#include <jansson.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "job_data.h"
+
+/* A snapshot holds the inactive jobs in columnar form, tagged with the
+ * job-manager journal epoch and sequence number it is current to.
+ * It is stored in the content store and referenced from the KVS key
+ * "checkpoint.job-list".  On reload, inactive jobs are restored from the
+ * snapshot and only journal events since the snapshot are replayed.
+ *
+ * Restored jobs do not carry jobspec or R.  String fields such as name
+ * and queue are dictionary encoded; a restored job's const char * fields
+ * point into the shared dictionary referenced by job->snapshot.
+ */
+
+struct job_state_ctx;
+
+typedef int (*job_snapshot_restore_f)(struct job *job, void *arg);
+
+/* Encode the jobs in 'jobs' as a snapshot object.
+ */
+json_t *job_snapshot_encode (zlistx_t *jobs, double epoch, json_int_t seq);
+
+/* Decode snapshot object 'o', calling 'cb' with each restored job.
+ * The callback takes ownership of the job, even on failure.
+ * Returns the number of jobs restored, or -1 on error.
+ */
+int job_snapshot_decode (flux_t *h,
+                         json_t *o,
+                         double *epoch,
+                         json_int_t *seq,
+                         job_snapshot_restore_f cb,
+                         void *arg,
+                         flux_error_t *errp);
+
+struct job_snapshot *job_snapshot_create (struct job_state_ctx *jsctx);
+void job_snapshot_destroy (struct job_snapshot *snap);
+
+/* Restore inactive jobs from the last saved snapshot into jsctx, setting
+ * jsctx->journal_epoch and jsctx->journal_seq.  Returns the number of jobs
+ * restored, 0 if there is no snapshot, or -1 on error.
+ */
+int job_snapshot_restore (struct job_snapshot *snap);
+
+/* Save a snapshot synchronously, e.g. on module unload.
+ */
+int job_snapshot_save (struct job_snapshot *snap);
+
+/* Begin saving snapshots periodically, per the configured interval.
+ */
+void job_snapshot_start (struct job_snapshot *snap);
+
+/* Parse [job-list] snapshot-interval (FSD, "0" disables).
+ */
+int job_snapshot_config_reload (struct job_snapshot *snap,
+                                const flux_conf_t *conf,
+                                flux_error_t *errp);
+
+#endif /* ! _FLUX_JOB_LIST_SNAPSHOT_H */
+
+/*
+ * vi:tabstop=4 shiftwidth=4 expandtab
+ */
@@ -240,6 +240,12 @@ void job_stats_purge (struct job_stats_ctx *statsctx, struct job *job)
     arm_timer (statsctx);
 }
 
+void job_stats_remove (struct job_stats_ctx *statsctx, struct job *job)
+{
+    stats_remove (&statsctx->all, job);
+    job_stats_remove_queue (statsctx, job);
+}
+
 static int object_set_integer (json_t *o,
                                const char *key,
                                unsigned int n)
@@ -49,6 +49,11 @@ void job_stats_remove_queue (struct job_stats_ctx *statsctx,
 
 void job_stats_purge (struct job_stats_ctx *statsctx, struct job *job);
 
+/* A job is being dropped without being purged, e.g. a job restored
+ * from a snapshot that is superseded by the job manager journal.
+ */
+void job_stats_remove (struct job_stats_ctx *statsctx, struct job *job);
+
 /* A client has disconnected from job-list.
  * Cancel streaming job-stats request, if any.
  */
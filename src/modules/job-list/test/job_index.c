@@ -0,0 +1,360 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/modules/job-list/job_data.h"
+#include "src/modules/job-list/job_index.h"
+#include "src/modules/job-list/match.h"
+
+struct match_ctx mctx = { .h = NULL,
+                          .max_hostlist = 1024,
+                          .max_comparisons = 0 };
+
+#define NUMCMP(a,b) ((a)==(b)?0:((a)<(b)?-1:1))
+
+/* Same order as the job-list inactive list */
+static int inactive_cmp (const void *a1, const void *a2)
+{
+    const struct job *j1 = a1;
+    const struct job *j2 = a2;
+    int rc;
+
+    if ((rc = NUMCMP (j2->t_inactive, j1->t_inactive)) == 0)
+        rc = NUMCMP (j2->id, j1->id);
+    return rc;
+}
+
+#define NJOBS 8
+
+/* Jobs alternate between two users, names and queues.  Job i ran on
+ * rank i * 40 + 0-9, so consecutive jobs share or straddle rank blocks.
+ */
+static void setup_jobs (struct job **jobs)
+{
+    int i;
+
+    for (i = 0; i < NJOBS; i++) {
+        struct job *job;
+        char ranks[64];
+
+        if (!(job = job_create (NULL, i + 1)))
+            BAIL_OUT ("failed to create job");
+        job->userid = i % 2 ? 100 : 200;
+        job->name = i % 2 ? "odd" : "even";
+        job->queue = i % 2 ? "batch" : "debug";
+        job->state = FLUX_JOB_STATE_INACTIVE;
+        job->result = i % 4 ? FLUX_JOB_RESULT_COMPLETED
+                            : FLUX_JOB_RESULT_FAILED;
+        job->t_inactive = 1000.0 + i;
+        snprintf (ranks, sizeof (ranks), "%d-%d", i * 40, i * 40 + 9);
+        if (!(job->ranks = strdup (ranks)))
+            BAIL_OUT ("failed to strdup ranks");
+        jobs[i] = job;
+    }
+}
+
+static void destroy_jobs (struct job **jobs)
+{
+    int i;
+    for (i = 0; i < NJOBS; i++)
+        job_destroy (jobs[i]);
+}
+
+/* Return the ids returned by 'iter' as a comma separated string.
+ */
+static const char *iter_ids (struct job_index_iter *iter)
+{
+    static char buf[256];
+    struct job *job;
+    int len = 0;
+
+    buf[0] = '\0';
+    while ((job = job_index_iter_next (iter)))
+        len += snprintf (buf + len,
+                         sizeof (buf) - len,
+                         "%s%ju",
+                         len ? "," : "",
+                         (uintmax_t)job->id);
+    return buf;
+}
+
+static void test_iter (void)
+{
+    struct job *jobs[NJOBS];
+    struct job_index *idx;
+    struct job_index_iter *iter;
+    struct idset *ranks;
+    int i;
+
+    setup_jobs (jobs);
+    if (!(idx = job_index_create (inactive_cmp)))
+        BAIL_OUT ("job_index_create failed");
+
+    /* add in unsorted order, then sort, as during journal replay */
+    for (i = 0; i < NJOBS; i++) {
+        if (job_index_add (idx, jobs[(i * 3) % NJOBS], false) < 0)
+            BAIL_OUT ("job_index_add failed");
+    }
+    job_index_sort (idx);
+
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_userid (iter, 100) == 0,
+        "job_index_iter_add_userid works");
+    ok (job_index_iter_count (iter) == 4,
+        "job_index_iter_count returns bucket size");
+    is (iter_ids (iter), "8,6,4,2",
+        "userid iterator returns jobs in inactive order");
+    job_index_iter_destroy (iter);
+
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_name (iter, "even") == 0
+        && job_index_iter_add_name (iter, "odd") == 0
+        && job_index_iter_add_name (iter, "even") == 0,
+        "job_index_iter_add_name works, with duplicate");
+    ok (job_index_iter_count (iter) == NJOBS,
+        "duplicate bucket is added once");
+    is (iter_ids (iter), "8,7,6,5,4,3,2,1",
+        "union of buckets is merged in inactive order");
+    job_index_iter_destroy (iter);
+
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_queue (iter, "nosuchqueue") == 0
+        && job_index_iter_count (iter) == 0,
+        "unknown key adds no candidates");
+    ok (job_index_iter_next (iter) == NULL,
+        "empty iterator returns NULL");
+    job_index_iter_destroy (iter);
+
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_result (iter, FLUX_JOB_RESULT_FAILED) == 0,
+        "job_index_iter_add_result works");
+    is (iter_ids (iter), "5,1",
+        "result iterator returns expected jobs");
+    job_index_iter_destroy (iter);
+
+    /* ranks 60-70 span blocks 0 and 1.  Jobs 1 and 2 (ranks 0-9, 40-49)
+     * are in block 0, job 3 (ranks 80-89) in block 1 and job 4 (ranks
+     * 120-129) in block 1 and block 2.
+     */
+    if (!(ranks = idset_decode ("60-70")))
+        BAIL_OUT ("idset_decode failed");
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_ranks (iter, ranks) == 0,
+        "job_index_iter_add_ranks works");
+    is (iter_ids (iter), "4,3,2,1",
+        "rank iterator returns candidates from each block once");
+    job_index_iter_destroy (iter);
+    idset_destroy (ranks);
+
+    /* job 5 (ranks 160-169) is in block 2 along with job 4 */
+    if (!(ranks = idset_decode ("130,150")))
+        BAIL_OUT ("idset_decode failed");
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_ranks (iter, ranks) == 0,
+        "job_index_iter_add_ranks works with ranks in one block");
+    is (iter_ids (iter), "5,4",
+        "rank iterator returns all jobs in the block");
+    job_index_iter_destroy (iter);
+    idset_destroy (ranks);
+
+    /* remove job 4 */
+    job_index_remove (idx, jobs[3]);
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_userid (iter, 100) == 0,
+        "job_index_iter_add_userid works");
+    is (iter_ids (iter), "8,6,2",
+        "removed job is no longer returned");
+    job_index_iter_destroy (iter);
+
+    /* sorted insert of job 4 */
+    ok (job_index_add (idx, jobs[3], true) == 0,
+        "job_index_add sorted works");
+    if (!(iter = job_index_iter_create (idx)))
+        BAIL_OUT ("job_index_iter_create failed");
+    ok (job_index_iter_add_userid (iter, 100) == 0,
+        "job_index_iter_add_userid works");
+    is (iter_ids (iter), "8,6,4,2",
+        "re-added job is returned in order");
+    job_index_iter_destroy (iter);
+
+    job_index_destroy (idx);
+    destroy_jobs (jobs);
+}
+
+static struct job_index_iter *plan_constraint (struct job_index *idx,
+                                               const char *str,
+                                               size_t max_count)
+{
+    struct list_constraint *c;
+    struct job_index_iter *iter;
+    flux_error_t error;
+    json_error_t jerror;
+    json_t *jc;
+
+    if (!(jc = json_loads (str, 0, &jerror)))
+        BAIL_OUT ("json constraint invalid: %s", jerror.text);
+    if (!(c = list_constraint_create (&mctx, jc, &error)))
+        BAIL_OUT ("list_constraint_create failed: %s", error.text);
+    iter = list_constraint_plan (c, idx, max_count);
+    list_constraint_destroy (c);
+    json_decref (jc);
+    return iter;
+}
+
+static void test_plan (void)
+{
+    struct job *jobs[NJOBS];
+    struct job_index *idx;
+    struct job_index_iter *iter;
+    int i;
+
+    setup_jobs (jobs);
+    if (!(idx = job_index_create (inactive_cmp)))
+        BAIL_OUT ("job_index_create failed");
+    for (i = 0; i < NJOBS; i++) {
+        if (job_index_add (idx, jobs[i], true) < 0)
+            BAIL_OUT ("job_index_add failed");
+    }
+
+    ok (plan_constraint (idx, "{}", NJOBS) == NULL,
+        "empty constraint is not planned");
+    ok (plan_constraint (idx, "{\"states\":[\"inactive\"]}", NJOBS) == NULL,
+        "states constraint is not planned");
+    ok (plan_constraint (idx, "{\"or\":[{\"userid\":[100]}]}", NJOBS) == NULL,
+        "or constraint is not planned");
+    ok (plan_constraint (idx, "{\"not\":[{\"userid\":[100]}]}", NJOBS) == NULL,
+        "not constraint is not planned");
+    ok (plan_constraint (idx, "{\"userid\":[4294967295]}", NJOBS) == NULL,
+        "userid constraint matching any user is not planned");
+    ok (plan_constraint (idx, "{\"userid\":[100,200]}", NJOBS) == NULL,
+        "constraint matching all jobs is not planned");
+
+    iter = plan_constraint (idx, "{\"userid\":[100]}", NJOBS);
+    ok (iter != NULL,
+        "userid constraint is planned");
+    is (iter_ids (iter), "8,6,4,2",
+        "plan returns expected candidates");
+    job_index_iter_destroy (iter);
+
+    iter = plan_constraint (idx,
+                 "{\"and\":[{\"queue\":[\"batch\"]},"
+                 "{\"results\":[\"failed\"]},"
+                 "{\"t_inactive\":[\">1000.0\"]}]}",
+                 NJOBS);
+    ok (iter != NULL && job_index_iter_count (iter) == 2,
+        "and constraint planned on most selective term");
+    is (iter_ids (iter), "5,1",
+        "plan returns expected candidates");
+    job_index_iter_destroy (iter);
+
+    iter = plan_constraint (idx,
+                 "{\"and\":[{\"name\":[\"odd\"]},"
+                 "{\"and\":[{\"ranks\":[\"0\"]}]}]}",
+                 NJOBS);
+    ok (iter != NULL && job_index_iter_count (iter) == 2,
+        "nested and constraint is planned");
+    is (iter_ids (iter), "2,1",
+        "plan returns expected candidates");
+    job_index_iter_destroy (iter);
+
+    job_index_destroy (idx);
+    destroy_jobs (jobs);
+}
+
+static void test_plan_virtual_queue (void)
+{
+    struct job *jobs[NJOBS];
+    struct job_index *idx;
+    struct job_index_iter *iter;
+    int i;
+
+    setup_jobs (jobs);
+    /* job 1 is in virtual queue "vdebug" of queue "debug" */
+    jobs[0]->queue = "vdebug";
+    if (!(mctx.queue_parents = zhashx_new ()))
+        BAIL_OUT ("zhashx_new failed");
+    if (zhashx_insert (mctx.queue_parents, "vdebug", "debug") < 0)
+        BAIL_OUT ("zhashx_insert failed");
+
+    if (!(idx = job_index_create (inactive_cmp)))
+        BAIL_OUT ("job_index_create failed");
+    for (i = 0; i < NJOBS; i++) {
+        if (job_index_add (idx, jobs[i], true) < 0)
+            BAIL_OUT ("job_index_add failed");
+    }
+
+    iter = plan_constraint (idx, "{\"queue\":[\"debug\"]}", NJOBS);
+    is (iter_ids (iter), "7,5,3,1",
+        "queue plan includes jobs in virtual queues");
+    job_index_iter_destroy (iter);
+
+    iter = plan_constraint (idx, "{\"queue\":[\"vdebug\"]}", NJOBS);
+    is (iter_ids (iter), "1",
+        "virtual queue plan includes only its own jobs");
+    job_index_iter_destroy (iter);
+
+    job_index_destroy (idx);
+    destroy_jobs (jobs);
+    zhashx_destroy (&mctx.queue_parents);
+}
+
+static void test_corner_case (void)
+{
+    struct job_index *idx;
+
+    ok (job_index_create (NULL) == NULL && errno == EINVAL,
+        "job_index_create NULL fails with EINVAL");
+    if (!(idx = job_index_create (inactive_cmp)))
+        BAIL_OUT ("job_index_create failed");
+    ok (job_index_add (NULL, NULL, true) < 0 && errno == EINVAL,
+        "job_index_add NULL fails with EINVAL");
+    ok (job_index_iter_create (NULL) == NULL && errno == EINVAL,
+        "job_index_iter_create NULL fails with EINVAL");
+    ok (job_index_iter_add_name (NULL, "foo") < 0 && errno == EINVAL,
+        "job_index_iter_add_name NULL fails with EINVAL");
+    ok (job_index_iter_next (NULL) == NULL,
+        "job_index_iter_next NULL returns NULL");
+    ok (list_constraint_plan (NULL, idx, 1) == NULL,
+        "list_constraint_plan NULL returns NULL");
+    job_index_remove (NULL, NULL);
+    job_index_sort (NULL);
+    job_index_iter_destroy (NULL);
+    job_index_destroy (idx);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_iter ();
+    test_plan ();
+    test_plan_virtual_queue ();
+    test_corner_case ();
+
+    done_testing ();
+}
+
+/*
+ * vi: ts=4 sw=4 expandtab
+ */
@@ -0,0 +1,290 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <string.h>
+#include <jansson.h>
+#include <flux/core.h>
+
+#include "src/common/libtap/tap.h"
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libutil/grudgeset.h"
+#include "src/modules/job-list/job_data.h"
+#include "src/modules/job-list/snapshot.h"
+#include "ccan/str/str.h"
+
+#define NJOBS 4
+
+static void job_destroy_wrapper (void **item)
+{
+    if (item) {
+        job_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static zlistx_t *create_jobs (void)
+{
+    zlistx_t *l;
+    int i;
+
+    if (!(l = zlistx_new ()))
+        BAIL_OUT ("zlistx_new failed");
+    zlistx_set_destructor (l, job_destroy_wrapper);
+    for (i = 0; i < NJOBS; i++) {
+        struct job *job;
+
+        if (!(job = job_create (NULL, i + 1)))
+            BAIL_OUT ("failed to create job");
+        job->userid = 100 + i;
+        job->priority = 16 + i;
+        job->t_submit = 1000.5 + i;
+        job->t_inactive = 2000.25 + i;
+        job->state = FLUX_JOB_STATE_INACTIVE;
+        job->states_mask = FLUX_JOB_STATE_INACTIVE | FLUX_JOB_STATE_RUN;
+        job->name = i % 2 ? "odd" : "even";
+        job->queue = i % 2 ? "batch" : NULL;
+        job->nnodes = i + 1;
+        job->success = i % 2 ? false : true;
+        if (!job->success) {
+            job->exception_occurred = true;
+            job->exception_type = "cancel";
+            job->result = FLUX_JOB_RESULT_CANCELED;
+        }
+        else
+            job->result = FLUX_JOB_RESULT_COMPLETED;
+        if (!(job->ranks = strdup ("0-3"))
+            || !(job->nodelist = strdup ("node[0-3]")))
+            BAIL_OUT ("strdup failed");
+        if (i == 0) {
+            if (!(job->annotations = json_pack ("{s:{s:s}}",
+                                                "user",
+                                                  "note", "hello")))
+                BAIL_OUT ("json_pack failed");
+            if (grudgeset_add (&job->dependencies, "after:1") < 0)
+                BAIL_OUT ("grudgeset_add failed");
+        }
+        if (!zlistx_add_end (l, job))
+            BAIL_OUT ("zlistx_add_end failed");
+    }
+    return l;
+}
+
+static int restore_cb (struct job *job, void *arg)
+{
+    zlistx_t *l = arg;
+
+    if (!zlistx_add_end (l, job)) {
+        job_destroy (job);
+        return -1;
+    }
+    return 0;
+}
+
+static bool streq_null (const char *s1, const char *s2)
+{
+    if (!s1 || !s2)
+        return s1 == s2;
+    return streq (s1, s2);
+}
+
+static bool job_equal (struct job *a, struct job *b)
+{
+    json_t *deps_a = a->dependencies ? grudgeset_tojson (a->dependencies)
+                                     : NULL;
+    json_t *deps_b = b->dependencies ? grudgeset_tojson (b->dependencies)
+                                     : NULL;
+
+    return a->id == b->id
+        && a->userid == b->userid
+        && a->priority == b->priority
+        && a->t_submit == b->t_submit
+        && a->t_inactive == b->t_inactive
+        && a->states_mask == b->states_mask
+        && streq_null (a->name, b->name)
+        && streq_null (a->queue, b->queue)
+        && streq_null (a->exception_type, b->exception_type)
+        && a->nnodes == b->nnodes
+        && a->success == b->success
+        && a->exception_occurred == b->exception_occurred
+        && a->result == b->result
+        && streq_null (a->ranks, b->ranks)
+        && streq_null (a->nodelist, b->nodelist)
+        && ((!a->annotations && !b->annotations)
+            || json_equal (a->annotations, b->annotations))
+        && ((!deps_a && !deps_b) || json_equal (deps_a, deps_b));
+}
+
+static void test_roundtrip (void)
+{
+    zlistx_t *jobs = create_jobs ();
+    zlistx_t *restored;
+    json_t *o;
+    char *s;
+    double epoch;
+    json_int_t seq;
+    flux_error_t error;
+    struct job *a, *b;
+    int count;
+
+    if (!(restored = zlistx_new ()))
+        BAIL_OUT ("zlistx_new failed");
+    zlistx_set_destructor (restored, job_destroy_wrapper);
+
+    o = job_snapshot_encode (jobs, 42.5, 1234);
+    ok (o != NULL,
+        "job_snapshot_encode works");
+    ok (json_array_size (json_object_get (o, "strings")) == 4,
+        "repeated strings are stored once");
+
+    /* round trip through a string, as via the content store */
+    if (!(s = json_dumps (o, JSON_COMPACT)))
+        BAIL_OUT ("json_dumps failed");
+    json_decref (o);
+    if (!(o = json_loads (s, 0, NULL)))
+        BAIL_OUT ("json_loads failed");
+    free (s);
+
+    count = job_snapshot_decode (NULL,
+                                 o,
+                                 &epoch,
+                                 &seq,
+                                 restore_cb,
+                                 restored,
+                                 &error);
+    ok (count == NJOBS,
+        "job_snapshot_decode restored %d jobs", NJOBS);
+    ok (epoch == 42.5 && seq == 1234,
+        "job_snapshot_decode returned epoch and seq");
+    json_decref (o);
+
+    a = zlistx_first (jobs);
+    b = zlistx_first (restored);
+    while (a && b) {
+        ok (job_equal (a, b),
+            "job %ju restored", (uintmax_t)a->id);
+        ok (b->snapshot != NULL,
+            "job %ju refers to snapshot strings", (uintmax_t)a->id);
+        a = zlistx_next (jobs);
+        b = zlistx_next (restored);
+    }
+    ok (a == NULL && b == NULL,
+        "jobs restored in order");
+
+    zlistx_destroy (&restored);
+    zlistx_destroy (&jobs);
+}
+
+static void test_empty (void)
+{
+    zlistx_t *jobs;
+    json_t *o;
+    double epoch;
+    json_int_t seq;
+    flux_error_t error;
+
+    if (!(jobs = zlistx_new ()))
+        BAIL_OUT ("zlistx_new failed");
+    o = job_snapshot_encode (jobs, 1., 0);
+    ok (o != NULL,
+        "job_snapshot_encode works with no jobs");
+    ok (job_snapshot_decode (NULL,
+                             o,
+                             &epoch,
+                             &seq,
+                             restore_cb,
+                             jobs,
+                             &error) == 0,
+        "job_snapshot_decode restores no jobs");
+    json_decref (o);
+    zlistx_destroy (&jobs);
+}
+
+static void test_invalid (void)
+{
+    zlistx_t *jobs = create_jobs ();
+    zlistx_t *restored;
+    json_t *o;
+    json_t *a;
+    double epoch;
+    json_int_t seq;
+    flux_error_t error;
+
+    if (!(restored = zlistx_new ()))
+        BAIL_OUT ("zlistx_new failed");
+    zlistx_set_destructor (restored, job_destroy_wrapper);
+
+    errno = 0;
+    ok (job_snapshot_encode (NULL, 0., 0) == NULL && errno == EINVAL,
+        "job_snapshot_encode NULL fails with EINVAL");
+    errno = 0;
+    ok (job_snapshot_decode (NULL, NULL, &epoch, &seq, restore_cb, NULL,
+                             &error) < 0
+        && errno == EINVAL,
+        "job_snapshot_decode NULL fails with EINVAL");
+
+    if (!(o = job_snapshot_encode (jobs, 1., 0)))
+        BAIL_OUT ("job_snapshot_encode failed");
+    if (json_object_set_new (o, "version", json_integer (99)) < 0)
+        BAIL_OUT ("json_object_set_new failed");
+    errno = 0;
+    ok (job_snapshot_decode (NULL, o, &epoch, &seq, restore_cb, restored,
+                             &error) < 0
+        && errno == EINVAL,
+        "job_snapshot_decode fails on unknown version");
+    diag ("%s", error.text);
+    json_decref (o);
+
+    if (!(o = job_snapshot_encode (jobs, 1., 0)))
+        BAIL_OUT ("job_snapshot_encode failed");
+    a = json_object_get (json_object_get (o, "columns"), "name");
+    if (json_array_set_new (a, 0, json_integer (100)) < 0)
+        BAIL_OUT ("json_array_set_new failed");
+    errno = 0;
+    ok (job_snapshot_decode (NULL, o, &epoch, &seq, restore_cb, restored,
+                             &error) < 0
+        && errno == EPROTO,
+        "job_snapshot_decode fails on bad string index");
+    diag ("%s", error.text);
+    json_decref (o);
+
+    if (!(o = job_snapshot_encode (jobs, 1., 0)))
+        BAIL_OUT ("job_snapshot_encode failed");
+    a = json_object_get (json_object_get (o, "columns"), "t_submit");
+    if (json_array_remove (a, 0) < 0)
+        BAIL_OUT ("json_array_remove failed");
+    errno = 0;
+    ok (job_snapshot_decode (NULL, o, &epoch, &seq, restore_cb, restored,
+                             &error) < 0
+        && errno == EPROTO,
+        "job_snapshot_decode fails on short column");
+    diag ("%s", error.text);
+    json_decref (o);
+
+    zlistx_destroy (&restored);
+    zlistx_destroy (&jobs);
+}
+
+int main (int argc, char *argv[])
+{
+    plan (NO_PLAN);
+
+    test_roundtrip ();
+    test_empty ();
+    test_invalid ();
+
+    done_testing ();
+}
+
+/*
+ * vi: ts=4 sw=4 expandtab
+ */
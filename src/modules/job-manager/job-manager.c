@@ -17,6 +17,7 @@
 
 #include "src/common/libjob/job_hash.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libfluxutil/dispatch_stats.h"
 
 #include "job.h"
 #include "conf.h"
@@ -42,6 +43,11 @@
 
 #include "job-manager.h"
 
+/* Dispatch up to 'dispatch_batch' queued messages per reactor loop
+ * iteration, e.g. during a burst of job submissions or state events.
+ */
+static const int dispatch_batch = 16;
+
 void getinfo_handle_request (flux_t *h,
                              flux_msg_handler_t *mh,
                              const flux_msg_t *msg,
@@ -90,7 +96,8 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
     struct flux_msg_cred cred;
     json_t *journal = journal_get_stats (ctx->journal);
     json_t *housekeeping = housekeeping_get_stats (ctx->housekeeping);
-    if (!housekeeping || !journal)
+    json_t *dispatch = dispatch_stats_encode (h);
+    if (!housekeeping || !journal || !dispatch)
         goto error;
     if (flux_msg_get_cred (msg, &cred) < 0)
         goto error;
@@ -100,23 +107,26 @@ static void stats_cb (flux_t *h, flux_msg_handler_t *mh,
     }
     if (flux_respond_pack (h,
                            msg,
-                           "{s:O s:i s:i s:I s:O}",
+                           "{s:O s:i s:i s:I s:O s:O}",
                            "journal", journal,
                            "active_jobs", zhashx_size (ctx->active_jobs),
                            "inactive_jobs", zhashx_size (ctx->inactive_jobs),
                            "max_jobid", ctx->max_jobid,
-                           "housekeeping", housekeeping) < 0) {
+                           "housekeeping", housekeeping,
+                           "dispatch", dispatch) < 0) {
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
         goto error;
     }
     json_decref (housekeeping);
     json_decref (journal);
+    json_decref (dispatch);
     return;
  error:
     if (flux_respond_error (h, msg, errno, NULL) < 0)
         flux_log_error (h, "%s: flux_respond_error", __FUNCTION__);
     json_decref (housekeeping);
     json_decref (journal);
+    json_decref (dispatch);
 }
 
 static int private_mode_update (const flux_conf_t *conf,
@@ -277,6 +287,10 @@ int mod_main (flux_t *h, int argc, char **argv)
         flux_log_error (h, "flux_msghandler_add");
         goto done;
     }
+    if (flux_dispatch_set_batch (h, dispatch_batch) < 0) {
+        flux_log_error (h, "flux_dispatch_set_batch");
+        goto done;
+    }
     if (conf_register_callback (ctx.conf,
                                 &error,
                                 private_mode_update,
@@ -36,6 +36,7 @@ struct job {
     json_t *end_event;      // event that caused transition to CLEANUP state
     const flux_msg_t *waiter; // flux_job_wait() request
     double t_clean;
+    uint64_t journal_seq;   // journal sequence number of last event
 
     uint8_t depend_posted:1;// depend event already posted
     uint8_t alloc_queued:1; // queued for alloc, but alloc request not sent
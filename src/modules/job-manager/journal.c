@@ -13,12 +13,16 @@
  * This allows another service to track detailed information about
  * all jobs.  The journal consumer makes a job-manager.events-journal
  * request with optional allow/deny filter and boolean 'full' flag:
- *   {"full"?b, "allow"?{"name":1, ...}, "deny"?{"name:1, ...}}
+ *   {"full"?b, "allow"?{"name":1, ...}, "deny"?{"name:1, ...},
+ *    "after_id"?I, "after_time"?F}
  *
  * If "full" is true, the journal begins with all the inactive jobs.
  * If "full" is false, the journal begins with all the active jobs.
  * If "full" is unspecified, it is assumed to be false.
  * If allow/deny rules are specified, they filter the job events by name.
+ * If "after_id" is specified, only jobs with a greater id are included.
+ * If "after_time" is specified, the backlog includes only jobs with an
+ * event after that timestamp.
  *
  * The journal consumer receives a stream of responses until the job
  * manager is unloaded or the request is canceled.  Each response consists of
@@ -35,9 +39,29 @@
  * The sentinel informs the consumer that it is now caught up and that future
  * responses will be for events that are are posted in real time.
  *
+ * The backlog is sent incrementally, a bounded number of jobs per reactor
+ * loop iteration, so that a large backlog does not stall the job manager.
+ * While it is being sent, real time events are also sent, except for jobs
+ * still waiting in the backlog, whose eventlog will include them.  Thus
+ * real time responses may precede the sentinel, but never precede the
+ * backlog response for the same job.
+ *
  * Additional responses contain at most one event.  The redacted jobspec is
  * included with the "submit" event.  The redacted R object is included
  * with the "alloc" event.
+ *
+ * Each event is assigned a sequence number, included as "seq" in real time
+ * responses.  The sentinel carries the journal "epoch", which identifies
+ * this job manager instance, and the sequence number of the last event:
+ *   {"id":-1, "events":[], "epoch":F, "seq":I, "resumed":b, "purged"?[I]}
+ *
+ * A consumer that has saved its state as of some sequence number may
+ * request {"full":true, "since":{"epoch":F, "seq":I}} to resume.  If the
+ * epoch matches and the sequence number is still covered by the purge log,
+ * the backlog contains all active jobs but only those inactive jobs with
+ * events after "seq", and the sentinel has "resumed":true and lists the
+ * ids of jobs purged after "seq".  Otherwise the full backlog is sent and
+ * "resumed" is false.
  */
 
 #if HAVE_CONFIG_H
@@ -52,22 +76,56 @@
 #include "src/common/libutil/errprintf.h"
 #include "src/common/libutil/fsd.h"
 #include "src/common/libjob/idf58.h"
+#include "src/common/libjob/job_hash.h"
 #include "ccan/str/str.h"
 
 #include "conf.h"
 #include "job.h"
 #include "journal.h"
 
+/* Purge records older than this are dropped.  A consumer that resumes
+ * from before the oldest retained record gets the full backlog.
+ */
+#define JOURNAL_PURGE_LOG_MAX 100000
+
+/* Backlog jobs sent to each consumer per reactor loop iteration.
+ */
+#define JOURNAL_BACKLOG_CHUNK 256
+
+struct journal_purge {
+    uint64_t seq;
+    flux_jobid_t id;
+};
+
 struct journal {
     struct job_manager *ctx;
     flux_msg_handler_t **handlers;
     struct flux_msglist *listeners;
     int event_count;
+    double epoch;           // identifies this journal instance
+    uint64_t seq;           // sequence number of last event or purge
+    zlistx_t *purge_log;    // struct journal_purge, oldest first
+    uint64_t purge_log_seq; // resume is possible from seq >= this
+    int backlog_count;      // listeners with backlog in progress
+    flux_watcher_t *prep;
+    flux_watcher_t *check;
+    flux_watcher_t *idle;
 };
 
 struct journal_filter { // stored as aux item in request message
     json_t *allow;      // allow, deny are owned by message
     json_t *deny;
+    flux_jobid_t after_id;
+    double after_time;
+};
+
+struct journal_backlog { // stored as aux item in request message
+    struct journal *journal;
+    zlistx_t *jobs;     // jobs not yet sent, with reference held
+    zhashx_t *pending;  // the same jobs, by id
+    bool resume;
+    uint64_t since;
+    bool complete;
 };
 
 static bool allow_deny_check (const flux_msg_t *msg, const char *name)
@@ -97,6 +155,24 @@ static bool allow_all (const flux_msg_t *msg)
     return true;
 }
 
+/* Return true if a real time event for job 'id' should be sent to 'msg'.
+ * Events for jobs awaiting their backlog response are held back, since
+ * the job's eventlog will include them.
+ */
+static bool allow_job (const flux_msg_t *msg, flux_jobid_t id)
+{
+    struct journal_filter *filter = flux_msg_aux_get (msg, "filter");
+    struct journal_backlog *backlog = flux_msg_aux_get (msg, "backlog");
+
+    if (id <= filter->after_id)
+        return false;
+    if (backlog
+        && backlog->pending
+        && zhashx_lookup (backlog->pending, &id))
+        return false;
+    return true;
+}
+
 int journal_process_event (struct journal *journal,
                            flux_jobid_t id,
                            const char *name,
@@ -104,11 +180,18 @@ int journal_process_event (struct journal *journal,
 {
     struct job_manager *ctx = journal->ctx;
     const flux_msg_t *msg;
+    struct job *job;
     json_t *o;
 
-    if (!(o = json_pack ("{s:I s:[O]}",
+    journal->seq++;
+    if ((job = zhashx_lookup (ctx->active_jobs, &id))
+        || (job = zhashx_lookup (ctx->inactive_jobs, &id)))
+        job->journal_seq = journal->seq;
+
+    if (!(o = json_pack ("{s:I s:[O] s:I}",
                          "id", id,
-                         "events", entry)))
+                         "events", entry,
+                         "seq", (json_int_t)journal->seq)))
         goto error;
     if (streq (name, "submit")) {
         struct job *job;
@@ -128,6 +211,7 @@ int journal_process_event (struct journal *journal,
     msg = flux_msglist_first (journal->listeners);
     while (msg) {
         if (allow_deny_check (msg, name)
+            && allow_job (msg, id)
             && flux_respond_pack (ctx->h, msg, "O", o) < 0) {
             flux_log_error (ctx->h,
                             "error responding to"
@@ -146,6 +230,71 @@ error:
     return 0;
 }
 
+void journal_purge_job (struct journal *journal, flux_jobid_t id)
+{
+    struct journal_purge *p;
+
+    if (!(p = calloc (1, sizeof (*p))))
+        goto error;
+    p->seq = ++journal->seq;
+    p->id = id;
+    if (!zlistx_add_end (journal->purge_log, p)) {
+        free (p);
+        goto error;
+    }
+    while (zlistx_size (journal->purge_log) > JOURNAL_PURGE_LOG_MAX) {
+        p = zlistx_first (journal->purge_log);
+        journal->purge_log_seq = p->seq;
+        zlistx_delete (journal->purge_log, zlistx_cursor (journal->purge_log));
+    }
+    return;
+error:
+    /* Without a record of this purge, no earlier point can be resumed.
+     */
+    journal->purge_log_seq = journal->seq;
+    flux_log_error (journal->ctx->h,
+                    "error recording journal purge of %s",
+                    idf58 (id));
+}
+
+/* A consumer may resume from 'seq' if it refers to this journal instance
+ * and no purge records after 'seq' have been dropped.
+ */
+static bool journal_can_resume (struct journal *journal,
+                                double epoch,
+                                json_int_t seq)
+{
+    if (epoch != journal->epoch
+        || seq < 0
+        || (uint64_t)seq < journal->purge_log_seq
+        || (uint64_t)seq > journal->seq)
+        return false;
+    return true;
+}
+
+static json_t *purged_since (struct journal *journal, uint64_t seq)
+{
+    struct journal_purge *p;
+    json_t *a;
+
+    if (!(a = json_array ()))
+        goto nomem;
+    p = zlistx_last (journal->purge_log);
+    while (p && p->seq > seq) {
+        json_t *o = json_integer (p->id);
+        if (!o || json_array_append_new (a, o) < 0) {
+            // jansson decrefs the new object on failure
+            goto nomem;
+        }
+        p = zlistx_prev (journal->purge_log);
+    }
+    return a;
+nomem:
+    json_decref (a);
+    errno = ENOMEM;
+    return NULL;
+}
+
 static void filter_destroy (struct journal_filter *filter)
 {
     ERRNO_SAFE_WRAP (free, filter);
@@ -202,58 +351,202 @@ static int send_job_events (struct job_manager *ctx,
     return -1;
 }
 
-/* The entire backlog must be sent to a journal consumer before
- * any new events can be generated, event if it's large.
- */
-static int send_backlog (struct job_manager *ctx,
-                         const flux_msg_t *msg,
-                         bool full)
+static void backlog_destroy (struct journal_backlog *backlog)
 {
-    struct job *job;
-    int job_count = zhashx_size (ctx->active_jobs);
+    if (backlog) {
+        int saved_errno = errno;
+        if (!backlog->complete)
+            backlog->journal->backlog_count--;
+        zhashx_destroy (&backlog->pending);
+        zlistx_destroy (&backlog->jobs);
+        free (backlog);
+        errno = saved_errno;
+    }
+}
 
-    if (full)
-        job_count += zhashx_size (ctx->inactive_jobs);
+static struct journal_backlog *backlog_create (struct journal *journal,
+                                               bool resume,
+                                               uint64_t since)
+{
+    struct journal_backlog *backlog;
 
-    if (job_count > 0) {
-        flux_log (ctx->h,
-                  LOG_DEBUG,
-                  "begin sending journal backlog: %d jobs",
-                  job_count);
+    if (!(backlog = calloc (1, sizeof (*backlog))))
+        return NULL;
+    backlog->journal = journal;
+    backlog->resume = resume;
+    backlog->since = since;
+    journal->backlog_count++;
+    if (!(backlog->jobs = zlistx_new ())
+        || !(backlog->pending = job_hash_create ())) {
+        backlog_destroy (backlog);
+        errno = ENOMEM;
+        return NULL;
     }
+    zlistx_set_destructor (backlog->jobs, job_destructor);
+    return backlog;
+}
 
-    if (full) {
-        job = zhashx_first (ctx->inactive_jobs);
-        while (job) {
-            if (send_job_events (ctx, msg, job) < 0)
-                return -1;
-            job = zhashx_next (ctx->inactive_jobs);
-        }
-    }
-    job = zhashx_first (ctx->active_jobs);
+/* Return the timestamp of the job's most recent event.
+ */
+static double last_event_time (struct job *job)
+{
+    size_t size = json_array_size (job->eventlog);
+    double timestamp = 0.;
+
+    if (size > 0)
+        (void)eventlog_entry_parse (json_array_get (job->eventlog, size - 1),
+                                    &timestamp,
+                                    NULL,
+                                    NULL);
+    return timestamp;
+}
+
+static bool backlog_match (struct journal_backlog *backlog,
+                           struct journal_filter *filter,
+                           struct job *job,
+                           bool inactive)
+{
+    if (job->id <= filter->after_id)
+        return false;
+    if (filter->after_time > 0. && last_event_time (job) <= filter->after_time)
+        return false;
+    if (inactive && backlog->resume && job->journal_seq <= backlog->since)
+        return false;
+    return true;
+}
+
+static int backlog_add_jobs (struct journal_backlog *backlog,
+                             struct journal_filter *filter,
+                             zhashx_t *jobs,
+                             bool inactive)
+{
+    struct job *job;
+
+    job = zhashx_first (jobs);
     while (job) {
-        if (send_job_events (ctx, msg, job) < 0)
-            return -1;
-        job = zhashx_next (ctx->active_jobs);
+        if (backlog_match (backlog, filter, job, inactive)) {
+            if (!zlistx_add_end (backlog->jobs, job_incref (job))) {
+                job_decref (job);
+                goto nomem;
+            }
+            if (zhashx_insert (backlog->pending, &job->id, job) < 0)
+                goto nomem;
+        }
+        job = zhashx_next (jobs);
     }
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
 
-    if (job_count > 0) {
-        flux_log (ctx->h,
-                  LOG_DEBUG,
-                  "finished sending journal backlog");
-    }
-    /* Send a special response with id = FLUX_JOB_ANY to demarcate the
-     * backlog from ongoing events.  The consumer may ignore this message.
-     */
-    if (flux_respond_pack (ctx->h,
+/* Send a special response with id = FLUX_JOB_ANY to demarcate the
+ * backlog from ongoing events.  The consumer may ignore this message.
+ */
+static int send_sentinel (struct journal *journal,
+                          const flux_msg_t *msg,
+                          struct journal_backlog *backlog)
+{
+    json_t *purged = NULL;
+
+    if (backlog->resume && !(purged = purged_since (journal, backlog->since)))
+        return -1;
+    if (flux_respond_pack (journal->ctx->h,
                            msg,
-                           "{s:I s:[]}",
+                           "{s:I s:[] s:f s:I s:b s:o*}",
                            "id", FLUX_JOBID_ANY,
-                           "events") < 0)
+                           "events",
+                           "epoch", journal->epoch,
+                           "seq", (json_int_t)journal->seq,
+                           "resumed", backlog->resume,
+                           "purged", purged) < 0)
         return -1;
     return 0;
 }
 
+static void backlog_complete (struct journal_backlog *backlog)
+{
+    backlog->complete = true;
+    backlog->journal->backlog_count--;
+    zhashx_destroy (&backlog->pending);
+    zlistx_destroy (&backlog->jobs);
+}
+
+/* Send up to JOURNAL_BACKLOG_CHUNK backlog jobs to 'msg', then the sentinel
+ * once all have been sent.  A job purged since the backlog was started is
+ * skipped.
+ */
+static void backlog_send_chunk (struct journal *journal,
+                                const flux_msg_t *msg,
+                                struct journal_backlog *backlog)
+{
+    struct job_manager *ctx = journal->ctx;
+    struct job *job;
+    int count = 0;
+
+    while (count < JOURNAL_BACKLOG_CHUNK
+           && (job = zlistx_first (backlog->jobs))) {
+        zhashx_delete (backlog->pending, &job->id);
+        if (zhashx_lookup (ctx->active_jobs, &job->id) == job
+            || zhashx_lookup (ctx->inactive_jobs, &job->id) == job) {
+            if (send_job_events (ctx, msg, job) < 0)
+                goto error;
+            count++;
+        }
+        zlistx_delete (backlog->jobs, zlistx_cursor (backlog->jobs));
+    }
+    if (zlistx_size (backlog->jobs) == 0) {
+        if (send_sentinel (journal, msg, backlog) < 0)
+            goto error;
+        flux_log (ctx->h, LOG_DEBUG, "finished sending journal backlog");
+        backlog_complete (backlog);
+    }
+    return;
+error:
+    flux_log_error (ctx->h, "error sending journal backlog");
+    backlog_complete (backlog);
+}
+
+/* prep:
+ * Runs right before reactor calls poll(2).
+ * If a backlog is in progress, start idle watcher so poll doesn't block.
+ */
+static void prep_cb (flux_reactor_t *r,
+                     flux_watcher_t *w,
+                     int revents,
+                     void *arg)
+{
+    struct journal *journal = arg;
+
+    if (journal->backlog_count > 0)
+        flux_watcher_start (journal->idle);
+}
+
+/* check:
+ * Runs right after reactor calls poll(2).
+ * Stop idle watcher, and send the next chunk of each backlog in progress.
+ */
+static void check_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct journal *journal = arg;
+    const flux_msg_t *msg;
+
+    flux_watcher_stop (journal->idle);
+
+    if (journal->backlog_count == 0)
+        return;
+    msg = flux_msglist_first (journal->listeners);
+    while (msg) {
+        struct journal_backlog *backlog = flux_msg_aux_get (msg, "backlog");
+        if (backlog && !backlog->complete)
+            backlog_send_chunk (journal, msg, backlog);
+        msg = flux_msglist_next (journal->listeners);
+    }
+}
+
 static void journal_handle_request (flux_t *h,
                                     flux_msg_handler_t *mh,
                                     const flux_msg_t *msg,
@@ -263,22 +556,34 @@ static void journal_handle_request (flux_t *h,
     const char *topic = "unknown";
     struct journal *journal = ctx->journal;
     struct journal_filter *filter;
+    struct journal_backlog *backlog;
     int full = 0;
+    double epoch = 0.;
+    json_int_t since = -1;
+    json_int_t after_id = 0;
+    bool resume = false;
+    int job_count;
     const char *errstr = NULL;
 
     if (!(filter = calloc (1, sizeof (*filter))))
         goto error;
     if (flux_request_unpack (msg,
                              &topic,
-                             "{s?o s?o s?b}",
+                             "{s?o s?o s?b s?{s:F s:I} s?I s?F}",
                              "allow", &filter->allow,
                              "deny", &filter->deny,
-                             "full", &full) < 0
+                             "full", &full,
+                             "since",
+                               "epoch", &epoch,
+                               "seq", &since,
+                             "after_id", &after_id,
+                             "after_time", &filter->after_time) < 0
         || flux_msg_aux_set (msg, "filter", filter,
                              (flux_free_f)filter_destroy) < 0) {
         filter_destroy (filter);
         goto error;
     }
+    filter->after_id = after_id;
     if (!flux_msg_is_streaming (msg)) {
         errno = EPROTO;
         errstr = "job-manager.events requires streaming RPC flag";
@@ -297,9 +602,43 @@ static void journal_handle_request (flux_t *h,
         goto error;
     }
 
-    if (send_backlog (ctx, msg, full) < 0) {
-        flux_log_error (h, "error responding to %s", topic);
-        return;
+    if (since >= 0) {
+        if (!full) {
+            errno = EPROTO;
+            errstr = "job-manager.events since requires full";
+            goto error;
+        }
+        resume = journal_can_resume (journal, epoch, since);
+    }
+
+    if (after_id < 0) {
+        errno = EPROTO;
+        errstr = "job-manager.events after_id must be >= 0";
+        goto error;
+    }
+
+    /* Collect the backlog now.  It is sent from check_cb().
+     */
+    if (!(backlog = backlog_create (journal, resume, resume ? since : 0)))
+        goto error;
+    if (flux_msg_aux_set (msg,
+                          "backlog",
+                          backlog,
+                          (flux_free_f)backlog_destroy) < 0) {
+        backlog_destroy (backlog);
+        goto error;
+    }
+    if ((full && backlog_add_jobs (backlog,
+                                   filter,
+                                   ctx->inactive_jobs,
+                                   true) < 0)
+        || backlog_add_jobs (backlog, filter, ctx->active_jobs, false) < 0)
+        goto error;
+    if ((job_count = zlistx_size (backlog->jobs)) > 0) {
+        flux_log (ctx->h,
+                  LOG_DEBUG,
+                  "begin sending journal backlog: %d jobs",
+                  job_count);
     }
     if (flux_msglist_append (journal->listeners, msg) < 0)
         goto error;
@@ -359,11 +698,24 @@ void journal_ctx_destroy (struct journal *journal)
             }
             flux_msglist_destroy (journal->listeners);
         }
+        zlistx_destroy (&journal->purge_log);
+        flux_watcher_destroy (journal->prep);
+        flux_watcher_destroy (journal->check);
+        flux_watcher_destroy (journal->idle);
         free (journal);
         errno = saved_errno;
     }
 }
 
+/* zlistx_set_destructor */
+static void purge_destructor (void **item)
+{
+    if (item) {
+        free (*item);
+        *item = NULL;
+    }
+}
+
 static const struct flux_msg_handler_spec htab[] = {
     {
         FLUX_MSGTYPE_REQUEST,
@@ -382,15 +734,29 @@ static const struct flux_msg_handler_spec htab[] = {
 
 struct journal *journal_ctx_create (struct job_manager *ctx)
 {
+    flux_reactor_t *r = flux_get_reactor (ctx->h);
     struct journal *journal;
 
     if (!(journal = calloc (1, sizeof (*journal))))
         return NULL;
     journal->ctx = ctx;
+    journal->epoch = flux_reactor_time ();
     if (flux_msg_handler_addvec (ctx->h, htab, ctx, &journal->handlers) < 0)
         goto error;
     if (!(journal->listeners = flux_msglist_create ()))
         goto error;
+    if (!(journal->purge_log = zlistx_new ()))
+        goto error;
+    zlistx_set_destructor (journal->purge_log, purge_destructor);
+    journal->prep = flux_prepare_watcher_create (r, prep_cb, journal);
+    journal->check = flux_check_watcher_create (r, check_cb, journal);
+    journal->idle = flux_idle_watcher_create (r, NULL, NULL);
+    if (!journal->prep || !journal->check || !journal->idle) {
+        errno = ENOMEM;
+        goto error;
+    }
+    flux_watcher_start (journal->prep);
+    flux_watcher_start (journal->check);
     return journal;
 error:
     journal_ctx_destroy (journal);
@@ -26,6 +26,11 @@ int journal_process_event (struct journal *journal,
                            const char *name,
                            json_t *entry);
 
+/* Record that inactive job 'id' was purged, so that a consumer resuming
+ * from an earlier sequence number can be told to drop it.
+ */
+void journal_purge_job (struct journal *journal, flux_jobid_t id);
+
 void journal_ctx_destroy (struct journal *journal);
 struct journal *journal_ctx_create (struct job_manager *ctx);
 
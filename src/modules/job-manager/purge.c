@@ -28,6 +28,7 @@
 #include "conf.h"
 #include "jobtap-internal.h"
 #include "restart.h"
+#include "journal.h"
 
 #define INACTIVE_NUM_UNLIMITED  (-1)
 #define INACTIVE_AGE_UNLIMITED  (-1.)
@@ -149,6 +150,8 @@ static int process_job_purge (struct purge *purge,
                        "job.inactive-remove",
                        NULL);
 
+    journal_purge_job (purge->ctx->journal, job->id);
+
     (void)zlistx_delete (purge->queue, job->handle);
     job->handle = NULL;
     zhashx_delete (purge->ctx->inactive_jobs, &job->id);
@@ -19,6 +19,7 @@
 #include "src/common/libjob/idf58.h"
 #include "src/common/libutil/fluid.h"
 #include "src/common/libutil/errprintf.h"
+#include "src/common/libutil/errno_safe.h"
 #include "src/common/libczmqcontainers/czmq_containers.h"
 
 #include "job.h"
@@ -37,6 +38,14 @@
  */
 #define JOB_LOOKUP_WINDOW 64
 
+/* Number of READDIR lookups kept in flight ahead of the walk, per level of
+ * the KVS job directory. The bits of a FLUID job ID that vary from job to
+ * job are mostly in the lower directory levels, so most jobs have their
+ * own leaf directory and a serial walk costs a few KVS round-trips per job
+ * before the job's own lookups can even be issued.
+ */
+#define READDIR_WINDOW 32
+
 /* The KVS lookups for one job, issued but not yet consumed. */
 struct job_lookup {
     flux_jobid_t id;
@@ -155,29 +164,47 @@ static int depthfirst_map_one (flux_t *h,
     return cb (id, key, arg, error);
 }
 
+static flux_future_t *readdir_lookup (flux_t *h,
+                                      const char *key,
+                                      flux_error_t *error)
+{
+    flux_future_t *f;
+
+    if (!(f = flux_kvs_lookup (h, NULL, FLUX_KVS_READDIR, key))) {
+        errprintf (error,
+                   "cannot send lookup request for %s: %s",
+                   key,
+                   strerror (errno));
+    }
+    return f;
+}
+
+/* Walk directory 'key', whose READDIR lookup 'f' has already been issued.
+ * The subdirectories of 'key' are walked in order, with lookups of the next
+ * READDIR_WINDOW subdirectories issued ahead of the one being walked.
+ * Takes ownership of 'f'.
+ */
 static int depthfirst_map (flux_t *h,
                            const char *key,
+                           flux_future_t *f,
                            int dirskip,
                            restart_map_f cb,
                            void *arg,
                            flux_error_t *error)
 {
-    flux_future_t *f;
     const flux_kvsdir_t *dir;
     flux_kvsitr_t *itr;
     const char *name;
+    char **keys = NULL;
+    flux_future_t **futures = NULL;
+    int nkeys = 0;
+    int issued = 0;
     int path_level;
     int count = 0;
     int rc = -1;
+    int i;
 
     path_level = restart_count_char (key + dirskip, '.');
-    if (!(f = flux_kvs_lookup (h, NULL, FLUX_KVS_READDIR, key))) {
-        errprintf (error,
-                   "cannot send lookup request for %s: %s",
-                   key,
-                   strerror (errno));
-        return -1;
-    }
     if (flux_kvs_lookup_get_dir (f, &dir) < 0) {
         if (errno == ENOENT && path_level == 0)
             rc = 0;
@@ -189,6 +216,12 @@ static int depthfirst_map (flux_t *h,
         }
         goto done;
     }
+    if (!(keys = calloc (flux_kvsdir_get_size (dir) + 1, sizeof (keys[0])))
+        || !(futures = calloc (flux_kvsdir_get_size (dir) + 1,
+                               sizeof (futures[0])))) {
+        errprintf (error, "out of memory walking %s", key);
+        goto done;
+    }
     if (!(itr = flux_kvsitr_create (dir))) {
         errprintf (error,
                    "could not create iterator for %s: %s",
@@ -197,39 +230,72 @@ static int depthfirst_map (flux_t *h,
         goto done;
     }
     while ((name = flux_kvsitr_next (itr))) {
-        char *nkey;
-        int n;
         if (!flux_kvsdir_isdir (dir, name))
             continue;
-        if (!(nkey = flux_kvsdir_key_at (dir, name))) {
+        if (!(keys[nkeys] = flux_kvsdir_key_at (dir, name))) {
             errprintf (error,
                        "could not build key for %s in %s: %s",
                        name,
                        key,
                        strerror (errno));
-            goto done_destroyitr;
+            flux_kvsitr_destroy (itr);
+            goto done;
         }
-        if (path_level == 3) // orig 'key' = .A.B.C, thus 'nkey' is complete
-            n = depthfirst_map_one (h, nkey, dirskip, cb, arg, error);
-        else
-            n = depthfirst_map (h, nkey, dirskip, cb, arg, error);
-        if (n < 0) {
-            int saved_errno = errno;
-            free (nkey);
-            errno = saved_errno;
-            goto done_destroyitr;
+        nkeys++;
+    }
+    flux_kvsitr_destroy (itr);
+    for (i = 0; i < nkeys; i++) {
+        int n;
+        if (path_level == 3) // orig 'key' = .A.B.C, thus keys[i] is complete
+            n = depthfirst_map_one (h, keys[i], dirskip, cb, arg, error);
+        else {
+            while (issued < nkeys && issued <= i + READDIR_WINDOW) {
+                if (!(futures[issued] = readdir_lookup (h,
+                                                        keys[issued],
+                                                        error)))
+                    goto done;
+                issued++;
+            }
+            n = depthfirst_map (h,
+                                keys[i],
+                                futures[i],
+                                dirskip,
+                                cb,
+                                arg,
+                                error);
+            futures[i] = NULL; // destroyed by depthfirst_map()
         }
+        if (n < 0)
+            goto done;
         count += n;
-        free (nkey);
     }
     rc = count;
-done_destroyitr:
-    flux_kvsitr_destroy (itr);
 done:
-    flux_future_destroy (f);
+    for (i = 0; i < nkeys; i++) {
+        ERRNO_SAFE_WRAP (flux_future_destroy, futures[i]);
+        ERRNO_SAFE_WRAP (free, keys[i]);
+    }
+    ERRNO_SAFE_WRAP (free, futures);
+    ERRNO_SAFE_WRAP (free, keys);
+    ERRNO_SAFE_WRAP (flux_future_destroy, f);
     return rc;
 }
 
+/* Call 'cb' for each job in the KVS directory 'dirname', in job ID order.
+ */
+static int restart_map (flux_t *h,
+                        const char *dirname,
+                        restart_map_f cb,
+                        void *arg,
+                        flux_error_t *error)
+{
+    flux_future_t *f;
+
+    if (!(f = readdir_lookup (h, dirname, error)))
+        return -1;
+    return depthfirst_map (h, dirname, f, strlen (dirname), cb, arg, error);
+}
+
 static void job_lookup_destroy (struct job_lookup *jl)
 {
     if (jl) {
@@ -487,27 +553,22 @@ error:
 int restart_from_kvs (struct job_manager *ctx)
 {
     const char *dirname = "job";
-    int dirskip = strlen (dirname);
     struct job *job;
     zlistx_t *active_jobs;
     flux_error_t error;
     struct job_loader loader;
 
-    /* Load any active jobs present in the KVS at startup. The job-loader
-     * pipelines the per-job KVS lookups: depthfirst_map walks the job
-     * directory in jobid order and feeds each job to job_loader_add, which
-     * keeps a window of lookups in flight and completes them in order.
+    /* Load any active jobs present in the KVS at startup. The walk and
+     * the per-job KVS lookups are both pipelined: restart_map walks the job
+     * directory in jobid order, with READDIR lookups issued ahead of the
+     * walk, and feeds each job to job_loader_add, which keeps a window of
+     * lookups in flight and completes them in order.
      */
     if (job_loader_init (&loader, ctx) < 0) {
         flux_log_error (ctx->h, "restart: job_loader_init");
         return -1;
     }
-    if (depthfirst_map (ctx->h,
-                        dirname,
-                        dirskip,
-                        job_loader_add,
-                        &loader,
-                        &error) < 0
+    if (restart_map (ctx->h, dirname, job_loader_add, &loader, &error) < 0
         || job_loader_drain (&loader, &error) < 0) {
         flux_log (ctx->h, LOG_ERR, "restart failed: %s", error.text);
         job_loader_finalize (&loader);
@@ -41,7 +41,7 @@ struct watcher {
     int initial_rootseq;        // initial rootseq returned by initial rpc
     char *key;                  // lookup key
     int flags;                  // kvs_lookup flags
-    zlist_t *lookups;           // list of futures, in commit order
+    zlist_t *lookups;           // list of 'struct lookup', in commit order
     zlist_t *loads;             // list of futures, content loads in ref order
 
     struct ns_monitor *nsm;     // back pointer for removal
@@ -51,6 +51,21 @@ struct watcher {
     int prev_end_index;         // previous end index loaded
     int loaded_blob_count;      // number of indices loaded (for FLUX_KVS_STREAM)
     void *handle;               // zlistx_t handle
+    zlistx_t *index;            // nsm index list this watcher is on
+    void *index_handle;         // zlistx_t handle in 'index'
+};
+
+/* A kvs.lookup-plus RPC.  After the initial lookup, all watchers that
+ * would send an identical request (same key, root, flags, and creds)
+ * share one lookup, so a commit to a key with many watchers costs one
+ * RPC to the KVS rather than one per watcher.
+ */
+struct lookup {
+    flux_future_t *f;
+    struct ns_monitor *nsm;
+    char *hashkey;              // key in nsm->lookups, NULL if not shared
+    zlistx_t *watchers;         // watchers with this lookup on w->lookups
+    int refcount;
 };
 
 /* Current KVS root.
@@ -70,6 +85,11 @@ struct commit {
  * and survive entry removals.  That cannot be done with zhashx_t without
  * retrieving a costly zhashx_keys() list.  Thus, we have watchers on a list
  * and a separate hash for quick lookup access to watchers.
+ *
+ * Each watcher is also on exactly one index list, so that a setroot event
+ * need only visit watchers that it can affect:  watchers that have not yet
+ * sent their initial lookup, FLUX_KVS_WATCH_FULL watchers (which look up
+ * their key on every commit), and watchers of the keys changed by the commit.
  */
 struct ns_monitor {
     char *ns_name;              // namespace name, hash key for ctx->namespaces
@@ -80,6 +100,10 @@ struct ns_monitor {
     struct watch_ctx *ctx;      // back-pointer to watch_ctx
     zlistx_t *watchers;         // list of watchers of this namespace
     zhashx_t *watcher_matchtags;// matchtags -> watchers quick lookup
+    zlistx_t *watchers_pending; // watchers awaiting initial lookup
+    zlistx_t *watchers_full;    // FLUX_KVS_WATCH_FULL watchers
+    zhashx_t *watchers_bykey;   // key -> zlistx_t of other watchers
+    zhashx_t *lookups;          // hashkey -> shared 'struct lookup'
     char *topic;                // topic string for subscription
     bool subscribed;            // subscription active
     flux_future_t *getrootf;    // initial getroot future
@@ -95,6 +119,39 @@ struct watch_ctx {
     zhashx_t *namespace_matchtags; // matchtags -> namespaces w/ requests
 };
 
+static void lookup_destroy (struct lookup *l)
+{
+    if (l) {
+        int saved_errno = errno;
+        if (l->hashkey) {
+            zhashx_delete (l->nsm->lookups, l->hashkey);
+            free (l->hashkey);
+        }
+        flux_future_destroy (l->f);
+        zlistx_destroy (&l->watchers);
+        free (l);
+        errno = saved_errno;
+    }
+}
+
+static void lookup_decref (struct lookup *l)
+{
+    if (l && --l->refcount == 0)
+        lookup_destroy (l);
+}
+
+/* Remove 'w' from the set of watchers awaiting lookup 'l' and drop its
+ * reference.  Lookups still in flight are destroyed with their last watcher.
+ */
+static void lookup_release (struct lookup *l, struct watcher *w)
+{
+    void *handle;
+
+    if ((handle = zlistx_find (l->watchers, w)))
+        zlistx_delete (l->watchers, handle);
+    lookup_decref (l);
+}
+
 static void watcher_destroy (struct watcher *w)
 {
     if (w) {
@@ -103,9 +160,9 @@ static void watcher_destroy (struct watcher *w)
         free (w->matchtag_key);
         free (w->key);
         if (w->lookups) {
-            flux_future_t *f;
-            while ((f = zlist_pop (w->lookups)))
-                flux_future_destroy (f);
+            struct lookup *l;
+            while ((l = zlist_pop (w->lookups)))
+                lookup_release (l, w);
             zlist_destroy (&w->lookups);
         }
         if (w->loads) {
@@ -190,7 +247,12 @@ static void namespace_destroy (void **data)
         struct ns_monitor *nsm = *data;
         int saved_errno = errno;
         commit_destroy (nsm->commit);
+        zlistx_destroy (&nsm->watchers_pending);
+        zlistx_destroy (&nsm->watchers_full);
+        zhashx_destroy (&nsm->watchers_bykey);
+        /* watchers release shared lookups, which unhash themselves */
         zlistx_destroy (&nsm->watchers);
+        zhashx_destroy (&nsm->lookups);
         zhashx_destroy (&nsm->watcher_matchtags);
         if (nsm->subscribed) {
             flux_future_t *f;
@@ -218,6 +280,16 @@ static void watcher_destructor (void **item)
     }
 }
 
+// zhashx_destructor_fn footprint
+static void index_destructor (void **item)
+{
+    if (item) {
+        zlistx_t *l = *item;
+        zlistx_destroy (&l);
+        *item = NULL;
+    }
+}
+
 static struct ns_monitor *namespace_create (struct watch_ctx *ctx,
                                             const char *ns)
 {
@@ -230,6 +302,12 @@ static struct ns_monitor *namespace_create (struct watch_ctx *ctx,
     zlistx_set_destructor (nsm->watchers, watcher_destructor);
     if (!(nsm->watcher_matchtags = zhashx_new ()))
         goto error;
+    if (!(nsm->watchers_pending = zlistx_new ())
+        || !(nsm->watchers_full = zlistx_new ())
+        || !(nsm->watchers_bykey = zhashx_new ())
+        || !(nsm->lookups = zhashx_new ()))
+        goto error;
+    zhashx_set_destructor (nsm->watchers_bykey, index_destructor);
     if (!(nsm->ns_name = strdup (ns)))
         goto error;
     nsm->owner = FLUX_USERID_UNKNOWN;
@@ -249,10 +327,54 @@ static bool key_match (json_t *o, const char *key)
     return false;
 }
 
+static void watcher_unindex (struct ns_monitor *nsm, struct watcher *w)
+{
+    if (w->index) {
+        zlistx_delete (w->index, w->index_handle);
+        if (zlistx_size (w->index) == 0
+            && w->index != nsm->watchers_pending
+            && w->index != nsm->watchers_full)
+            zhashx_delete (nsm->watchers_bykey, w->key);
+        w->index = NULL;
+        w->index_handle = NULL;
+    }
+}
+
+/* (Re-)file 'w' on the index list matching its current state.
+ */
+static int watcher_index (struct ns_monitor *nsm, struct watcher *w)
+{
+    zlistx_t *l;
+
+    watcher_unindex (nsm, w);
+    if (w->rootseq == -1)
+        l = nsm->watchers_pending;
+    else if ((w->flags & FLUX_KVS_WATCH_FULL))
+        l = nsm->watchers_full;
+    else if (!(l = zhashx_lookup (nsm->watchers_bykey, w->key))) {
+        if (!(l = zlistx_new ()))
+            goto nomem;
+        (void)zhashx_insert (nsm->watchers_bykey, w->key, l);
+    }
+    if (!(w->index_handle = zlistx_add_end (l, w))) {
+        if (zlistx_size (l) == 0
+            && l != nsm->watchers_pending
+            && l != nsm->watchers_full)
+            zhashx_delete (nsm->watchers_bykey, w->key);
+        goto nomem;
+    }
+    w->index = l;
+    return 0;
+nomem:
+    errno = ENOMEM;
+    return -1;
+}
+
 static void watcher_cleanup (struct ns_monitor *nsm, struct watcher *w)
 {
     /* it is possible lookups & loads are in flight, they will be
      * cleaned in watcher_destroy() */
+    watcher_unindex (nsm, w);
     zhashx_delete (nsm->watcher_matchtags, w->matchtag_key);
     zhashx_delete (nsm->ctx->namespace_matchtags, w->matchtag_key);
     zlistx_delete (nsm->watchers, w->handle);
@@ -281,18 +403,32 @@ static void handle_load_response (flux_future_t *f, struct watcher *w)
     const void *data;
     size_t size;
     flux_error_t err;
+    int blobs = ptr2int (flux_future_aux_get (f, "range"));
+    json_t *val = NULL;
 
-    if (content_load_get (f, &data, &size) < 0) {
-        errprintf (&err, "failed to load content data");
-        goto error_respond;
+    /* A ranged kvs.lookup returns the blobs already concatenated.
+     */
+    if (blobs > 0) {
+        if (flux_rpc_get_unpack (f, "{s:o}", "val", &val) < 0) {
+            errprintf (&err, "failed to look up older content data");
+            goto error_respond;
+        }
+        if (!w->mute)
+            json_incref (val);
     }
-
-    if (!w->mute) {
-        json_t *val = treeobj_create_val (data, size);
-        if (!val) {
+    else {
+        if (content_load_get (f, &data, &size) < 0) {
+            errprintf (&err, "failed to load content data");
+            goto error_respond;
+        }
+        blobs = 1;
+        if (!w->mute && !(val = treeobj_create_val (data, size))) {
             errprintf (&err, "failed to create treeobj value");
             goto error_respond;
         }
+    }
+
+    if (!w->mute) {
         if (flux_respond_pack (h, w->request, "{ s:o }", "val", val) < 0) {
             flux_log_error (h,
                             "%s: failed to respond to kvs-watch.lookup",
@@ -300,7 +436,7 @@ static void handle_load_response (flux_future_t *f, struct watcher *w)
             json_decref (val);
             goto finished;
         }
-        w->loaded_blob_count++;
+        w->loaded_blob_count += blobs;
         w->responded = true;
 
         if (flux_future_aux_get (f, "initial_sentinel"))
@@ -376,17 +512,97 @@ error:
     return NULL;
 }
 
+/* Look up blobs [start_index, end_index] of the watched key under
+ * 'root_ref' with one ranged kvs.lookup, so that the KVS loads only the
+ * ivalref chunks that hold them.  The response is a single val.
+ */
+static flux_future_t *load_older (flux_t *h,
+                                  struct watcher *w,
+                                  const char *root_ref,
+                                  int start_index,
+                                  int end_index)
+{
+    flux_msg_t *msg;
+    json_t *o = NULL;
+    flux_future_t *f = NULL;
+    int saved_errno;
+
+    if (!(msg = flux_request_encode ("kvs.lookup", NULL))
+        || !(o = treeobj_create_dirref (root_ref))
+        || flux_msg_pack (msg,
+                          "{s:s s:i s:O s:[ii]}",
+                          "key", w->key,
+                          "flags", 0,
+                          "rootdir", o,
+                          "range", start_index, end_index) < 0
+        || flux_msg_set_cred (msg, w->cred) < 0
+        || !(f = flux_rpc_message (h, msg, FLUX_NODEID_ANY, 0))
+        || flux_future_aux_set (f,
+                                "range",
+                                int2ptr (end_index - start_index + 1),
+                                NULL) < 0
+        || flux_future_then (f, -1., load_continuation, w) < 0)
+        goto error;
+    if (zlist_append (w->loads, f) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    flux_msg_destroy (msg);
+    json_decref (o);
+    return f;
+error:
+    saved_errno = errno;
+    flux_future_destroy (f);
+    flux_msg_destroy (msg);
+    json_decref (o);
+    errno = saved_errno;
+    return NULL;
+}
+
+static bool is_valref (json_t *val)
+{
+    return treeobj_is_valref (val) || treeobj_is_ivalref (val);
+}
+
+/* Return the number of blobs in valref or ivalref 'val'.
+ */
+static int get_blob_count (json_t *val)
+{
+    int count;
+
+    if (treeobj_is_ivalref (val)) {
+        if (treeobj_get_ivalref (val, NULL, &count) < 0)
+            return -1;
+        return count;
+    }
+    return treeobj_get_count (val);
+}
+
 static int load_range (flux_t *h,
                        struct watcher *w,
                        int start_index,
                        int end_index,
-                       json_t *val)
+                       json_t *val,
+                       const char *root_ref)
 {
+    int base = 0;
     int i;
 
+    /* Only the newest blobrefs of an ivalref are inline.  Fetch any older
+     * ones through the KVS first, to preserve response order.
+     */
+    if (treeobj_is_ivalref (val)) {
+        base = get_blob_count (val) - treeobj_get_count (val);
+        if (start_index < base) {
+            int last = end_index < base ? end_index : base - 1;
+            if (!load_older (h, w, root_ref, start_index, last))
+                return -1;
+            start_index = last + 1;
+        }
+    }
     for (i = start_index; i <= end_index; i++) {
         flux_future_t *f;
-        const char *ref = treeobj_get_blobref (val, i);
+        const char *ref = treeobj_get_blobref (val, i - base);
         if (!ref)
             return -1;
         if (!(f = load_ref (h, w, ref)))
@@ -423,10 +639,10 @@ static int handle_initial_response (flux_t *h,
             w->loaded_blob_count++;
             goto out;
         }
-        else if (treeobj_is_valref (val)) {
+        else if (is_valref (val)) {
             w->index_valid = true;
             w->prev_start_index = 0;
-            w->prev_end_index = treeobj_get_count (val) - 1;
+            w->prev_end_index = get_blob_count (val) - 1;
         }
         else {
             if (w->flags & FLUX_KVS_WATCH_APPEND)
@@ -449,7 +665,8 @@ static int handle_initial_response (flux_t *h,
                         w,
                         w->prev_start_index,
                         w->prev_end_index,
-                        val) < 0) {
+                        val,
+                        root_ref) < 0) {
             errprintf (&err,
                        "error sending request for content blobs [%d:%d]",
                        w->prev_start_index,
@@ -571,7 +788,7 @@ static int handle_append_response (flux_t *h,
             w->loaded_blob_count++;
             w->responded = true;
         }
-        else if (treeobj_is_valref (val)) {
+        else if (is_valref (val)) {
             /* N.B. It may not be obvious why we have to check
              * w->index_valid if we have not yet responded.  It is
              * possible we have received a setroot response and an
@@ -582,7 +799,7 @@ static int handle_append_response (flux_t *h,
                 int new_end_index;
                 if (w->flags & FLUX_KVS_STREAM)
                     goto out;
-                new_end_index = treeobj_get_count (val) - 1;
+                new_end_index = get_blob_count (val) - 1;
                 if (new_end_index > w->prev_end_index) {
                     w->prev_start_index = w->prev_end_index + 1;
                     w->prev_end_index = new_end_index;
@@ -598,14 +815,15 @@ static int handle_append_response (flux_t *h,
             else {
                 w->index_valid = true;
                 w->prev_start_index = 0;
-                w->prev_end_index = treeobj_get_count (val) - 1;
+                w->prev_end_index = get_blob_count (val) - 1;
             }
 
             if (load_range (h,
                             w,
                             w->prev_start_index,
                             w->prev_end_index,
-                            val) < 0) {
+                            val,
+                            root_ref) < 0) {
                 errprintf (&err,
                            "error sending request for content blobs [%d:%d]",
                            w->prev_start_index,
@@ -631,7 +849,7 @@ static int handle_append_response (flux_t *h,
         }
     }
     else {
-        if (treeobj_is_valref (val)) {
+        if (is_valref (val)) {
             int new_end_index;
             if (!w->index_valid) {
                 errno = EPROTO;
@@ -639,7 +857,7 @@ static int handle_append_response (flux_t *h,
             }
             if (w->flags & FLUX_KVS_STREAM)
                 goto out;
-            new_end_index = treeobj_get_count (val) - 1;
+            new_end_index = get_blob_count (val) - 1;
             if (new_end_index > w->prev_end_index) {
                 w->prev_start_index = w->prev_end_index + 1;
                 w->prev_end_index = new_end_index;
@@ -656,7 +874,8 @@ static int handle_append_response (flux_t *h,
                             w,
                             w->prev_start_index,
                             w->prev_end_index,
-                            val) < 0) {
+                            val,
+                            root_ref) < 0) {
                 errprintf (&err, "error loading reference");
                 goto error_respond;
             }
@@ -831,20 +1050,20 @@ finished:
     w->finished = true;
 }
 
-/* One lookup has completed.
- * Pop ready futures off w->lookups and send responses, until
- * the list is empty, or a non-ready future is encountered.
+/* One of the watcher's lookups has completed.
+ * Pop ready lookups off w->lookups and send responses, until
+ * the list is empty, or a non-ready lookup is encountered.
  */
-static void lookup_continuation (flux_future_t *f, void *arg)
+static void watcher_lookups_ready (struct watcher *w)
 {
-    struct watcher *w = arg;
     struct ns_monitor *nsm = w->nsm;
+    struct lookup *l;
 
-    while ((f = zlist_first (w->lookups)) && flux_future_is_ready (f)) {
-        f = zlist_pop (w->lookups);
+    while ((l = zlist_first (w->lookups)) && flux_future_is_ready (l->f)) {
+        l = zlist_pop (w->lookups);
         if (!w->finished)
-            handle_lookup_response (f, w);
-        flux_future_destroy (f);
+            handle_lookup_response (l->f, w);
+        lookup_release (l, w);
         /* if WAITCREATE and (!WATCH and !STREAM), then we only care
          * about sending one response and being done.  We can use the
          * responded flag to indicate that condition.
@@ -859,6 +1078,40 @@ static void lookup_continuation (flux_future_t *f, void *arg)
         watcher_cleanup (nsm, w);
 }
 
+/* A lookup has completed.  Notify each watcher sharing it.
+ * Iterate over a copy of l->watchers, since processing a watcher removes
+ * it from the list, and may destroy it.  Only that watcher is destroyed,
+ * so the remaining entries in the copy stay valid.  Once the last watcher
+ * of the namespace is destroyed, so is the namespace, so the lookup is
+ * unhashed from nsm->lookups first, and held until the loop is done.
+ */
+static void lookup_continuation (flux_future_t *f, void *arg)
+{
+    struct lookup *l = arg;
+    zlistx_t *watchers;
+    struct watcher *w;
+
+    if (l->hashkey) {
+        zhashx_delete (l->nsm->lookups, l->hashkey);
+        free (l->hashkey);
+        l->hashkey = NULL;
+    }
+    if (!(watchers = zlistx_dup (l->watchers))) {
+        flux_log_error (flux_future_get_flux (f),
+                        "%s: zlistx_dup",
+                        __FUNCTION__);
+        return;
+    }
+    l->refcount++;
+    w = zlistx_first (watchers);
+    while (w) {
+        watcher_lookups_ready (w);
+        w = zlistx_next (watchers);
+    }
+    zlistx_destroy (&watchers);
+    lookup_decref (l);
+}
+
 /* Like flux_kvs_lookupat() except:
  * - targets kvs.lookup-plus, so root_ref & root_seq are available in
  *   response
@@ -932,27 +1185,101 @@ error:
     return NULL;
 }
 
-static int process_lookup_response (struct ns_monitor *nsm, struct watcher *w)
+/* Send a lookup on behalf of 'w', and hash it under 'hashkey' (if non-NULL)
+ * so that watchers with an identical request can share it.
+ * The lookup is returned with no references.
+ */
+static struct lookup *lookup_create (struct ns_monitor *nsm,
+                                     struct watcher *w,
+                                     char *hashkey)
 {
-    flux_future_t *f;
-    if (!(f = lookupat (nsm->ctx->h,
-                        w,
-                        nsm->commit->rootref,
-                        nsm->commit->rootseq,
-                        nsm->ns_name))) {
+    struct lookup *l;
+
+    if (!(l = calloc (1, sizeof (*l))))
+        return NULL;
+    l->nsm = nsm;
+    if (!(l->watchers = zlistx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (!(l->f = lookupat (nsm->ctx->h,
+                           w,
+                           nsm->commit->rootref,
+                           nsm->commit->rootseq,
+                           nsm->ns_name))) {
         flux_log_error (nsm->ctx->h, "%s: lookupat", __FUNCTION__);
-        return -1;
+        goto error;
     }
-    if (zlist_append (w->lookups, f) < 0) {
-        flux_future_destroy (f);
+    if (flux_future_then (l->f, -1., lookup_continuation, l) < 0)
+        goto error;
+    if (hashkey) {
+        if (zhashx_insert (nsm->lookups, hashkey, l) < 0) {
+            errno = EEXIST;
+            goto error;
+        }
+        l->hashkey = hashkey;
+    }
+    return l;
+error:
+    lookup_destroy (l);
+    return NULL;
+}
+
+/* Key under which identical post-initial lookups of 'w' are shared.
+ * The requester's creds are part of the key since the lookup is made
+ * with them (see lookupat()).  The key comes last since it may contain ':'.
+ */
+static char *lookup_hashkey (struct ns_monitor *nsm, struct watcher *w)
+{
+    char *s;
+
+    if (asprintf (&s,
+                  "%s:%d:%d:%ju:%ju:%s",
+                  nsm->commit->rootref,
+                  nsm->commit->rootseq,
+                  w->flags,
+                  (uintmax_t)w->cred.userid,
+                  (uintmax_t)w->cred.rolemask,
+                  w->key) < 0)
+        return NULL;
+    return s;
+}
+
+static int process_lookup_response (struct ns_monitor *nsm, struct watcher *w)
+{
+    struct lookup *l = NULL;
+    char *hashkey = NULL;
+    bool initial = !w->initial_rpc_sent;
+
+    if (!initial) {
+        if (!(hashkey = lookup_hashkey (nsm, w)))
+            return -1;
+        if ((l = zhashx_lookup (nsm->lookups, hashkey))) {
+            free (hashkey);
+            hashkey = NULL;
+        }
+    }
+    if (!l) {
+        if (!(l = lookup_create (nsm, w, hashkey))) {
+            free (hashkey);
+            return -1;
+        }
+    }
+    if (!zlistx_add_end (l->watchers, w)) {
+        if (l->refcount == 0)
+            lookup_destroy (l);
         errno = ENOMEM;
         return -1;
     }
-    if (flux_future_then (f, -1., lookup_continuation, w) < 0) {
-        flux_future_destroy (f);
+    l->refcount++;
+    if (zlist_append (w->lookups, l) < 0) {
+        lookup_release (l, w);
+        errno = ENOMEM;
         return -1;
     }
     w->rootseq = nsm->commit->rootseq;
+    if (initial && watcher_index (nsm, w) < 0)
+        return -1;
     return 0;
 }
 
@@ -1005,11 +1332,12 @@ static void watcher_respond (struct ns_monitor *nsm, struct watcher *w)
      * they are processed asynchronously.  For example, some values
      * may be cached within the KVS while others are not.
      *
-     * KVS lookup futures are added to the w->lookups zlist in commit
-     * order here, and in lookup_continuation(), fulfilled futures are
-     * popped off the head of w->lookups until an unfulfilled future
+     * KVS lookups are added to the w->lookups zlist in commit
+     * order here, and in watcher_lookups_ready(), fulfilled lookups are
+     * popped off the head of w->lookups until an unfulfilled lookup
      * is encountered, so that responses are always returned to the
-     * watcher in commit order.
+     * watcher in commit order.  A lookup may be shared with other
+     * watchers of the same key at the same root.
      *
      * Security note: although the requester has already been authenticated
      * to access the namespace by check_authorization() above, we make the
@@ -1059,6 +1387,63 @@ static void watcher_respond_ns (struct ns_monitor *nsm)
     }
 }
 
+/* Respond to the watchers that the current commit may affect.  Fall back
+ * to visiting every watcher if an error is pending or the changed keys
+ * are unknown (e.g. root from getroot RPC or namespace-created event).
+ * N.B. watcher_respond() only destroys the watcher it is called on, and the
+ * namespace only when its last watcher is gone, so the collected list of
+ * distinct watchers remains valid while iterating.
+ */
+static void watcher_respond_commit (struct ns_monitor *nsm)
+{
+    zlistx_t *affected;
+    const char *key;
+    json_t *value;
+    struct watcher *w;
+
+    if (nsm->fatal_errnum != 0
+        || nsm->errnum != 0
+        || !nsm->commit
+        || !nsm->commit->keys)
+        goto fallback;
+    if (!(affected = zlistx_new ()))
+        goto fallback;
+    w = zlistx_first (nsm->watchers_pending);
+    while (w) {
+        if (!zlistx_add_end (affected, w))
+            goto fallback_destroy;
+        w = zlistx_next (nsm->watchers_pending);
+    }
+    w = zlistx_first (nsm->watchers_full);
+    while (w) {
+        if (!zlistx_add_end (affected, w))
+            goto fallback_destroy;
+        w = zlistx_next (nsm->watchers_full);
+    }
+    json_object_foreach (nsm->commit->keys, key, value) {
+        zlistx_t *l;
+        if ((l = zhashx_lookup (nsm->watchers_bykey, key))) {
+            w = zlistx_first (l);
+            while (w) {
+                if (!zlistx_add_end (affected, w))
+                    goto fallback_destroy;
+                w = zlistx_next (l);
+            }
+        }
+    }
+    w = zlistx_first (affected);
+    while (w) {
+        watcher_respond (nsm, w);
+        w = zlistx_next (affected);
+    }
+    zlistx_destroy (&affected);
+    return;
+fallback_destroy:
+    zlistx_destroy (&affected);
+fallback:
+    watcher_respond_ns (nsm);
+}
+
 /* Cancel watcher 'w' if it matches:
  * - credentials and matchtag if cancel true
  * - credentials if cancel false
@@ -1293,7 +1678,7 @@ static void setroot_cb (flux_t *h,
     if (nsm->owner == FLUX_USERID_UNKNOWN)
         nsm->owner = owner;
 done:
-    watcher_respond_ns (nsm);
+    watcher_respond_commit (nsm);
 }
 
 /* kvs.getroot response for initial namespace creation
@@ -1485,10 +1870,16 @@ static void lookup_cb (flux_t *h,
         goto error;
     }
     if (zhashx_insert (ctx->namespace_matchtags, w->matchtag_key, nsm) < 0) {
+        zhashx_delete (nsm->watcher_matchtags, w->matchtag_key);
         zlistx_delete (nsm->watchers, w->handle);
         errno = EINVAL;
         goto error;
     }
+    if (watcher_index (nsm, w) < 0) {
+        watcher_cleanup (nsm, w);
+        errno = ENOMEM;
+        goto error;
+    }
     if (nsm->commit)
         watcher_respond (nsm, w);
     return;
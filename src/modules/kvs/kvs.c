@@ -16,6 +16,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <limits.h>
 #include <libgen.h>
 #include <unistd.h>
 #include <stdbool.h>
@@ -38,6 +39,7 @@
 #include "src/common/libcontent/content.h"
 #include "src/common/libutil/fsd.h"
 #include "src/common/librouter/msg_hash.h"
+#include "src/common/libfluxutil/dispatch_stats.h"
 
 #include "waitqueue.h"
 #include "cache.h"
@@ -63,6 +65,12 @@ const double max_lastuse_age = 10.;
  */
 const double max_namespace_age = 3600.;
 
+/* Dispatch up to 'dispatch_batch' queued messages per reactor loop
+ * iteration, so commit bursts are merged with fewer trips through
+ * the prepare/check watchers.
+ */
+const int dispatch_batch = 16;
+
 struct kvs_ctx {
     struct cache *cache;    /* blobref => cache_entry */
     kvsroot_mgr_t *krm;
@@ -73,6 +81,8 @@ struct kvs_ctx {
     flux_watcher_t *idle_w;
     flux_watcher_t *check_w;
     int transaction_merge;
+    int hdir_threshold;
+    int ivalref_chunk;
     char initial_rootref[BLOBREF_MAX_STRING_SIZE];
     bool initial_rootref_set;
     bool events_init;            /* flag */
@@ -183,6 +193,8 @@ static struct kvs_ctx *kvs_ctx_create (flux_t *h)
             goto error;
     }
     ctx->transaction_merge = 1;
+    ctx->hdir_threshold = KVSTXN_HDIR_THRESHOLD_DEFAULT;
+    ctx->ivalref_chunk = KVSTXN_IVALREF_CHUNK_DEFAULT;
     if (!(ctx->requests = msg_hash_create (MSG_HASH_TYPE_UUID_MATCHTAG)))
         goto error;
     list_head_init (&ctx->work_queue);
@@ -346,6 +358,8 @@ static void getroot_completion (flux_future_t *f, void *arg)
             flux_log_error (ctx->h, "%s: kvsroot_mgr_create_root", __FUNCTION__);
             goto error;
         }
+        (void)kvstxn_mgr_set_hdir_threshold (root->ktm, ctx->hdir_threshold);
+        (void)kvstxn_mgr_set_ivalref_chunk (root->ktm, ctx->ivalref_chunk);
 
         if (event_subscribe (ctx, ns) < 0) {
             int save_errno = errno;
@@ -1283,6 +1297,7 @@ static lookup_t *lookup_common (flux_t *h,
     const char *ns = NULL;
     const char *key;
     json_t *root_dirent = NULL;
+    json_t *range = NULL;
     lookup_t *lh = NULL;
     const char *root_ref = NULL;
     wait_t *wait = NULL;
@@ -1295,15 +1310,18 @@ static lookup_t *lookup_common (flux_t *h,
         struct flux_msg_cred cred;
         int root_seq = -1;
 
-        /* namespace, rootdir, and rootseq optional */
+        int first, last;
+
+        /* namespace, rootdir, rootseq, and range optional */
         if (flux_request_unpack (msg,
                                  NULL,
-                                 "{ s:s s:i s?s s?o s?i}",
+                                 "{ s:s s:i s?s s?o s?i s?o}",
                                  "key", &key,
                                  "flags", &flags,
                                  "namespace", &ns,
                                  "rootdir", &root_dirent,
-                                 "rootseq", &root_seq) < 0) {
+                                 "rootseq", &root_seq,
+                                 "range", &range) < 0) {
             flux_log_error (h, "%s: flux_request_unpack", __FUNCTION__);
             goto done;
         }
@@ -1342,6 +1360,16 @@ static lookup_t *lookup_common (flux_t *h,
                                   h)))
             goto done;
 
+        /* range is [first, last] blob index of a value */
+        if (range) {
+            if (json_unpack (range, "[ii!]", &first, &last) < 0) {
+                lookup_destroy (lh);
+                errno = EPROTO;
+                goto done;
+            }
+            (void)lookup_set_range (lh, first, last);
+        }
+
         if (flux_msg_aux_set (msg,
                               "lookup_handle",
                               lh,
@@ -1439,6 +1467,20 @@ static void lookup_request_cb (flux_t *h,
         goto error;
     }
 
+    /* FLUX_KVS_RAW: respond with the value as the raw payload, gathered
+     * directly from the cached blobs without base64 encoding.
+     */
+    if ((lookup_get_flags (lh) & FLUX_KVS_RAW)) {
+        const struct iovec *iov;
+        int iovcnt;
+
+        if (lookup_get_value_iov (lh, &iov, &iovcnt) < 0)
+            goto error;
+        if (flux_respond_raw_iov (h, msg, iov, iovcnt) < 0)
+            flux_log_error (h, "%s: flux_respond_raw_iov", __FUNCTION__);
+        request_tracking_remove (ctx, msg);
+        return;
+    }
     if (!(val = lookup_get_value (lh))) {
         errno = ENOENT;
         goto error;
@@ -1488,6 +1530,12 @@ static void lookup_plus_request_cb (flux_t *h,
         goto error;
     }
 
+    /* responses carry tree objects, raw values are not supported */
+    if ((lookup_get_flags (lh) & FLUX_KVS_RAW)) {
+        errno = EINVAL;
+        goto error;
+    }
+
     root_ref = lookup_get_root_ref (lh);
     assert (root_ref);
     root_seq = lookup_get_root_seq (lh);
@@ -2061,6 +2109,7 @@ static void stats_get_cb (flux_t *h,
     json_t *cstats = NULL;
     json_t *txncstats = NULL;
     json_t *nsstats = NULL;
+    json_t *dstats = NULL;
     tstat_t ts = { 0 };
     int size = 0, incomplete = 0, dirty = 0;
     double scale = 1E-3;
@@ -2091,6 +2140,9 @@ static void stats_get_cb (flux_t *h,
     if (!(nsstats = json_object ()))
         goto nomem;
 
+    if (!(dstats = dispatch_stats_encode (h)))
+        goto error;
+
     if (kvsroot_mgr_root_count (ctx->krm) > 0) {
         if (kvsroot_mgr_iter_roots (ctx->krm, stats_get_root_cb, nsstats) < 0) {
             flux_log_error (h, "%s: kvsroot_mgr_iter_roots", __FUNCTION__);
@@ -2116,17 +2168,19 @@ static void stats_get_cb (flux_t *h,
 
     if (flux_respond_pack (h,
                            msg,
-                           "{ s:O s:O s:{s:O} s:i }",
+                           "{ s:O s:O s:{s:O} s:i s:O }",
                            "cache", cstats,
                            "namespace", nsstats,
                            "transaction-opcount",
                              "commit", txncstats,
-                           "pending_requests", zhashx_size (ctx->requests)) < 0)
+                           "pending_requests", zhashx_size (ctx->requests),
+                           "dispatch", dstats) < 0)
         flux_log_error (h, "%s: flux_respond_pack", __FUNCTION__);
     json_decref (tstats);
     json_decref (cstats);
     json_decref (txncstats);
     json_decref (nsstats);
+    json_decref (dstats);
     return;
 nomem:
     errno = ENOMEM;
@@ -2137,6 +2191,7 @@ error:
     json_decref (cstats);
     json_decref (txncstats);
     json_decref (nsstats);
+    json_decref (dstats);
 }
 
 static int namespace_create (struct kvs_ctx *ctx,
@@ -2170,6 +2225,8 @@ static int namespace_create (struct kvs_ctx *ctx,
         flux_log_error (ctx->h, "%s: kvsroot_mgr_create_root", __FUNCTION__);
         return -1;
     }
+    (void)kvstxn_mgr_set_hdir_threshold (root->ktm, ctx->hdir_threshold);
+    (void)kvstxn_mgr_set_ivalref_chunk (root->ktm, ctx->ivalref_chunk);
 
     setroot (ctx, root, rootref, 0);
 
@@ -2679,6 +2736,36 @@ static int process_args (struct kvs_ctx *ctx, int ac, char **av)
                 return -1;
             }
         }
+        else if (strstarts (av[i], "hdir-threshold=")) {
+            char *endptr;
+            long threshold;
+            errno = 0;
+            threshold = strtol (av[i]+15, &endptr, 10);
+            if (errno != 0
+                || *endptr != '\0'
+                || endptr == av[i]+15
+                || threshold < 0
+                || threshold > INT_MAX) {
+                errno = EINVAL;
+                return -1;
+            }
+            ctx->hdir_threshold = threshold;
+        }
+        else if (strstarts (av[i], "ivalref-chunk=")) {
+            char *endptr;
+            long chunk;
+            errno = 0;
+            chunk = strtol (av[i]+14, &endptr, 10);
+            if (errno != 0
+                || *endptr != '\0'
+                || endptr == av[i]+14
+                || chunk < 0
+                || chunk > INT_MAX) {
+                errno = EINVAL;
+                return -1;
+            }
+            ctx->ivalref_chunk = chunk;
+        }
         else if (strstarts (av[i], "initial-rootref=")) {
             char *ptr = av[i] + 16;
             if (strlen (ptr) > BLOBREF_MAX_STRING_SIZE
@@ -2890,6 +2977,8 @@ int mod_main (flux_t *h, int argc, char **argv)
             flux_log_error (h, "kvsroot_mgr_create_root");
             goto done;
         }
+        (void)kvstxn_mgr_set_hdir_threshold (root->ktm, ctx->hdir_threshold);
+        (void)kvstxn_mgr_set_ivalref_chunk (root->ktm, ctx->ivalref_chunk);
         setroot (ctx, root, rootref, seq);
 
         if (event_subscribe (ctx, KVS_PRIMARY_NAMESPACE) < 0) {
@@ -2903,6 +2992,10 @@ int mod_main (flux_t *h, int argc, char **argv)
         flux_log_error (h, "flux_msg_handler_addvec");
         goto done;
     }
+    if (flux_dispatch_set_batch (h, dispatch_batch) < 0) {
+        flux_log_error (h, "flux_dispatch_set_batch");
+        goto done;
+    }
     if (!(f_heartbeat_sync = flux_sync_create (h, heartbeat_sync_min))
             || flux_future_then (f_heartbeat_sync,
                                  heartbeat_sync_max,
@@ -49,6 +49,8 @@ struct kvstxn_mgr {
     const char *ns_name;
     const char *hash_name;
     int noop_stores;            /* for kvs.stats-get, etc.*/
+    int hdir_threshold;
+    int ivalref_chunk;
     zlist_t *ready;
     flux_t *h;
     void *aux;
@@ -453,7 +455,86 @@ static int store_cache (kvstxn_t *kt,
     return -1;
 }
 
-/* Store DIRVAL objects, converting them to DIRREFs.
+static int kvstxn_unroll (kvstxn_t *kt, json_t *dir);
+static int kvstxn_unroll_hdir (kvstxn_t *kt, json_t *hdir, int depth);
+
+/* Unroll and store a dir or hdir object, returning a new dirref to it.
+ * A dir with more than hdir_threshold entries is first split into an
+ * hdir at 'depth', so only shards touched by this transaction (still
+ * inline in the root copy) are stored again.
+ */
+static json_t *kvstxn_store_dir (kvstxn_t *kt, json_t *dir, int depth)
+{
+    char ref[BLOBREF_MAX_STRING_SIZE];
+    enum store_result result;
+    struct cache_entry *entry;
+    json_t *hdir = NULL;
+    json_t *dirref = NULL;
+
+    if (treeobj_is_dir (dir)
+        && kt->ktm->hdir_threshold > 0
+        && treeobj_get_count (dir) > kt->ktm->hdir_threshold
+        && depth < TREEOBJ_HDIR_MAXDEPTH) {
+        if (!(hdir = treeobj_hdir_split (dir, depth)))
+            return NULL;
+        dir = hdir;
+    }
+    if (treeobj_is_hdir (dir)) {
+        if (kvstxn_unroll_hdir (kt, dir, depth) < 0)
+            goto done;
+    }
+    else if (kvstxn_unroll (kt, dir) < 0) /* depth first */
+        goto done;
+    if (store_cache (kt,
+                     dir,
+                     false,
+                     ref,
+                     sizeof (ref),
+                     &entry,
+                     &result) < 0)
+        goto done;
+    if (kvstxn_add_cache_entry (kt, entry, result) < 0)
+        goto done;
+    dirref = treeobj_create_dirref (ref);
+done:
+    ERRNO_SAFE_WRAP (json_decref, hdir);
+    return dirref;
+}
+
+/* Store the inline shards of an hdir at 'depth', converting them to
+ * DIRREFs.  Shards that are still DIRREFs were not modified.  Empty
+ * dir shards are dropped.
+ * Return 0 on success, -1 on error
+ */
+static int kvstxn_unroll_hdir (kvstxn_t *kt, json_t *hdir, int depth)
+{
+    json_t *hdir_data;
+    json_t *shard;
+    json_t *ktmp;
+    const char *key;
+    void *tmp;
+
+    if (!(hdir_data = treeobj_get_data (hdir)))
+        return -1;
+
+    json_object_foreach_safe (hdir_data, tmp, key, shard) {
+        if (treeobj_is_dir (shard) && treeobj_get_count (shard) == 0)
+            (void)json_object_del (hdir_data, key);
+        else if (treeobj_is_dir (shard) || treeobj_is_hdir (shard)) {
+            if (!(ktmp = kvstxn_store_dir (kt, shard, depth + 1)))
+                return -1;
+            if (json_object_set_new (hdir_data, key, ktmp) < 0) {
+                // jansson decrefs the new object on failure
+                errno = ENOMEM;
+                return -1;
+            }
+        }
+    }
+
+    return 0;
+}
+
+/* Store DIRVAL (and HDIR) objects, converting them to DIRREFs.
  * Store (large) FILEVAL objects, converting them to FILEREFs.
  * Return 0 on success, -1 on error
  */
@@ -479,20 +560,8 @@ static int kvstxn_unroll (kvstxn_t *kt, json_t *dir)
      */
     while (iter) {
         dir_entry = json_object_iter_value (iter);
-        if (treeobj_is_dir (dir_entry)) {
-            if (kvstxn_unroll (kt, dir_entry) < 0) /* depth first */
-                return -1;
-            if (store_cache (kt,
-                             dir_entry,
-                             false,
-                             ref,
-                             sizeof (ref),
-                             &entry,
-                             &result) < 0)
-                return -1;
-            if (kvstxn_add_cache_entry (kt, entry, result) < 0)
-                return -1;
-            if (!(ktmp = treeobj_create_dirref (ref)))
+        if (treeobj_is_dir (dir_entry) || treeobj_is_hdir (dir_entry)) {
+            if (!(ktmp = kvstxn_store_dir (kt, dir_entry, 0)))
                 return -1;
             if (json_object_iter_set_new (dir, iter, ktmp) < 0) {
                 // jansson decrefs the new object on failure
@@ -558,6 +627,121 @@ static int kvstxn_val_data_to_cache (kvstxn_t *kt,
     return 0;
 }
 
+/* Store 'ivalref' as a chunk and return a new, empty ivalref that
+ * follows it.  The chunk index moves to the new ivalref, with the stored
+ * chunk added.  Return NULL on error.
+ */
+static json_t *kvstxn_ivalref_push (kvstxn_t *kt, json_t *ivalref)
+{
+    char ref[BLOBREF_MAX_STRING_SIZE];
+    enum store_result result;
+    struct cache_entry *entry;
+    json_t *chunk;
+    json_t *next = NULL;
+    const char *cref;
+    int count, ccount;
+    int nchunks, i;
+
+    if (treeobj_get_ivalref (ivalref, NULL, &count) < 0
+        || (nchunks = treeobj_get_ivalref_nchunks (ivalref)) < 0
+        || !(chunk = treeobj_deep_copy (ivalref)))
+        return NULL;
+    if (treeobj_clear_ivalref_chunks (chunk) < 0
+        || store_cache (kt,
+                        chunk,
+                        false,
+                        ref,
+                        sizeof (ref),
+                        &entry,
+                        &result) < 0
+        || kvstxn_add_cache_entry (kt, entry, result) < 0
+        || !(next = treeobj_create_ivalref (ref, count)))
+        goto error;
+    for (i = 0; i < nchunks; i++) {
+        if (treeobj_get_ivalref_chunk (ivalref, i, &cref, &ccount) < 0
+            || treeobj_append_ivalref_chunk (next, cref, ccount) < 0)
+            goto error;
+    }
+    if (treeobj_append_ivalref_chunk (next, ref, count) < 0)
+        goto error;
+    json_decref (chunk);
+    return next;
+error:
+    ERRNO_SAFE_WRAP (json_decref, next);
+    ERRNO_SAFE_WRAP (json_decref, chunk);
+    return NULL;
+}
+
+/* Convert 'valref' into an ivalref whose chunks hold ivalref_chunk
+ * blobrefs each.  Return NULL on error.
+ */
+static json_t *kvstxn_valref_to_ivalref (kvstxn_t *kt, json_t *valref)
+{
+    json_t *ivalref;
+    json_t *next;
+    const char *ref;
+    int count;
+    int i;
+
+    if ((count = treeobj_get_count (valref)) < 0
+        || !(ivalref = treeobj_create_ivalref (NULL, 0)))
+        return NULL;
+    for (i = 0; i < count; i++) {
+        if (treeobj_get_count (ivalref) == kt->ktm->ivalref_chunk) {
+            if (!(next = kvstxn_ivalref_push (kt, ivalref)))
+                goto error;
+            json_decref (ivalref);
+            ivalref = next;
+        }
+        if (!(ref = treeobj_get_blobref (valref, i))
+            || treeobj_append_blobref (ivalref, ref) < 0)
+            goto error;
+    }
+    return ivalref;
+error:
+    ERRNO_SAFE_WRAP (json_decref, ivalref);
+    return NULL;
+}
+
+/* Append 'ref' to a copy of the valref or ivalref 'entry'.  Once a
+ * valref reaches ivalref_chunk blobrefs it is converted to an ivalref,
+ * and a full ivalref is stored as a chunk before 'ref' is appended to a
+ * new one, so the cost of an append does not grow with the number of
+ * blobrefs.  Return the new object, or NULL on error.
+ */
+static json_t *kvstxn_append_blobref (kvstxn_t *kt,
+                                      json_t *entry,
+                                      const char *ref)
+{
+    int chunk = kt->ktm->ivalref_chunk;
+    json_t *cpy;
+    json_t *next;
+
+    if (treeobj_is_valref (entry)
+        && (chunk == 0 || treeobj_get_count (entry) < chunk))
+        cpy = treeobj_deep_copy (entry);
+    else if (treeobj_is_valref (entry))
+        cpy = kvstxn_valref_to_ivalref (kt, entry);
+    else
+        cpy = treeobj_deep_copy (entry);
+    if (!cpy)
+        return NULL;
+    if (treeobj_is_ivalref (cpy)
+        && chunk > 0
+        && treeobj_get_count (cpy) >= chunk) {
+        if (!(next = kvstxn_ivalref_push (kt, cpy)))
+            goto error;
+        json_decref (cpy);
+        cpy = next;
+    }
+    if (treeobj_append_blobref (cpy, ref) < 0)
+        goto error;
+    return cpy;
+error:
+    ERRNO_SAFE_WRAP (json_decref, cpy);
+    return NULL;
+}
+
 static int kvstxn_append (kvstxn_t *kt,
                           json_t *dirent,
                           json_t *dir,
@@ -582,14 +766,14 @@ static int kvstxn_append (kvstxn_t *kt,
          * twice, leading to duplicated data.  See issue #6207. */
         (*append) = true;
     }
-    else if (treeobj_is_valref (entry)) {
+    else if (treeobj_is_valref (entry) || treeobj_is_ivalref (entry)) {
         char ref[BLOBREF_MAX_STRING_SIZE];
         json_t *cpy;
 
-        /* treeobj is valref, so we need to append the new data's
-         * blobref to this tree object.  Before doing so, we must save
-         * off the new data to the cache and mark it dirty for
-         * flushing later (if necessary)
+        /* treeobj is valref or ivalref, so we need to append the new
+         * data's blobref to this tree object.  Before doing so, we
+         * must save off the new data to the cache and mark it dirty
+         * for flushing later (if necessary)
          *
          * Note that we make a copy of the original entry and
          * re-insert it into the directory.  We do not want to
@@ -600,13 +784,8 @@ static int kvstxn_append (kvstxn_t *kt,
         if (kvstxn_val_data_to_cache (kt, dirent, ref, sizeof (ref)) < 0)
             return -1;
 
-        if (!(cpy = treeobj_deep_copy (entry)))
-            return -1;
-
-        if (treeobj_append_blobref (cpy, ref) < 0) {
-            json_decref (cpy);
+        if (!(cpy = kvstxn_append_blobref (kt, entry, ref)))
             return -1;
-        }
 
         /* To improve performance, call
          * treeobj_insert_entry_novalidate() instead of
@@ -665,7 +844,8 @@ static int kvstxn_append (kvstxn_t *kt,
         return -1;
     }
     else if (treeobj_is_dir (entry)
-             || treeobj_is_dirref (entry)) {
+             || treeobj_is_dirref (entry)
+             || treeobj_is_hdir (entry)) {
         errno = EISDIR;
         return -1;
     }
@@ -680,6 +860,111 @@ static int kvstxn_append (kvstxn_t *kt,
     return 0;
 }
 
+/* Copy the dir or hdir object referenced by 'dirref' out of the cache,
+ * so it can be modified in the root copy.  If the object is not yet in
+ * the cache, set *missing_ref and return 0 with *cpyp = NULL.
+ * Return 0 on success, -1 on error.
+ */
+static int kvstxn_deref_dirref (kvstxn_t *kt,
+                                const json_t *dirref,
+                                json_t **cpyp,
+                                const char **missing_ref)
+{
+    struct cache_entry *entry;
+    const char *ref;
+    const json_t *dirktmp;
+    int refcount;
+
+    *cpyp = NULL;
+
+    if ((refcount = treeobj_get_count (dirref)) < 0)
+        return -1;
+
+    if (refcount != 1) {
+        flux_log (kt->ktm->h, LOG_ERR, "invalid dirref count: %d", refcount);
+        errno = ENOTRECOVERABLE;
+        return -1;
+    }
+
+    if (!(ref = treeobj_get_blobref (dirref, 0)))
+        return -1;
+
+    if (!(entry = cache_lookup (kt->ktm->cache, ref))
+        || !cache_entry_get_valid (entry)) {
+        *missing_ref = ref;
+        return 0; /* stall */
+    }
+
+    if (!(dirktmp = cache_entry_get_treeobj (entry))) {
+        errno = ENOTRECOVERABLE;
+        return -1;
+    }
+
+    /* do not corrupt store by modifying orig. */
+    if (!(*cpyp = treeobj_deep_copy (dirktmp)))
+        return -1;
+    return 0;
+}
+
+/* 'hdir' is a sharded directory in the root copy.  Find the dir shard
+ * that holds (or would hold) 'name', replacing dirref shards along the
+ * way with copies of the objects they reference, as is done for dirref
+ * entries in kvstxn_link_dirent().  If there is no such shard, create
+ * an empty one if 'create' is true, otherwise set *leafp to NULL.
+ * *leafp is also set to NULL if *missing_ref must be loaded first.
+ * Return 0 on success, -1 on error.
+ */
+static int kvstxn_hdir_leaf (kvstxn_t *kt,
+                             json_t *hdir,
+                             const char *name,
+                             bool create,
+                             json_t **leafp,
+                             const char **missing_ref)
+{
+    json_t *shard;
+    json_t *cpy;
+    int depth = 0;
+
+    *leafp = NULL;
+    while (1) {
+        if (!(shard = treeobj_hdir_get_shard (hdir, name, depth))) {
+            if (errno != ENOENT)
+                return -1;
+            if (!create)
+                return 0;
+            if (!(shard = treeobj_create_dir ()))
+                return -1;
+            if (treeobj_hdir_set_shard (hdir, name, depth, shard) < 0) {
+                json_decref (shard);
+                return -1;
+            }
+            json_decref (shard);
+        }
+        else if (treeobj_is_dirref (shard)) {
+            if (kvstxn_deref_dirref (kt, shard, &cpy, missing_ref) < 0)
+                return -1;
+            if (!cpy)
+                return 0; /* stall */
+            if (treeobj_hdir_set_shard (hdir, name, depth, cpy) < 0) {
+                json_decref (cpy);
+                return -1;
+            }
+            json_decref (cpy);
+            shard = cpy;
+        }
+        if (treeobj_is_dir (shard)) {
+            *leafp = shard;
+            return 0;
+        }
+        if (!treeobj_is_hdir (shard)) {
+            errno = ENOTRECOVERABLE;
+            return -1;
+        }
+        hdir = shard;
+        depth++;
+    }
+}
+
 /* link (key, dirent) into directory 'dir'.
  */
 static int kvstxn_link_dirent (kvstxn_t *kt,
@@ -696,6 +981,12 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
     json_t *subdir = NULL, *dir_entry;
     int rc = -1;
 
+    /* hdir objects are created by kvstxn_unroll(), not by users */
+    if (treeobj_is_hdir (dirent)) {
+        errno = EINVAL;
+        goto done;
+    }
+
     if (!(cpy = kvs_util_normalize_key (key, NULL)))
         goto done;
 
@@ -715,6 +1006,18 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
     while ((next = strchr (name, '.'))) {
         *next++ = '\0';
 
+        if (treeobj_is_hdir (dir)) {
+            if (kvstxn_hdir_leaf (kt,
+                                  dir,
+                                  name,
+                                  !json_is_null (dirent),
+                                  &dir,
+                                  missing_ref) < 0)
+                goto done;
+            if (!dir)
+                goto success; /* stall, or deleting a nonexistent key */
+        }
+
         if (!treeobj_is_dir (dir)) {
             errno = ENOTRECOVERABLE;
             goto done;
@@ -732,44 +1035,14 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
             }
             json_decref (subdir);
         }
-        else if (treeobj_is_dir (dir_entry)) {
+        else if (treeobj_is_dir (dir_entry) || treeobj_is_hdir (dir_entry)) {
             subdir = dir_entry;
         }
         else if (treeobj_is_dirref (dir_entry)) {
-            struct cache_entry *entry;
-            const char *ref;
-            const json_t *subdirktmp;
-            int refcount;
-
-            if ((refcount = treeobj_get_count (dir_entry)) < 0)
+            if (kvstxn_deref_dirref (kt, dir_entry, &subdir, missing_ref) < 0)
                 goto done;
-
-            if (refcount != 1) {
-                flux_log (kt->ktm->h,
-                          LOG_ERR,
-                          "invalid dirref count: %d",
-                          refcount);
-                errno = ENOTRECOVERABLE;
-                goto done;
-            }
-
-            if (!(ref = treeobj_get_blobref (dir_entry, 0)))
-                goto done;
-
-            if (!(entry = cache_lookup (kt->ktm->cache, ref))
-                || !cache_entry_get_valid (entry)) {
-                *missing_ref = ref;
+            if (!subdir)
                 goto success; /* stall */
-            }
-
-            if (!(subdirktmp = cache_entry_get_treeobj (entry))) {
-                errno = ENOTRECOVERABLE;
-                goto done;
-            }
-
-            /* do not corrupt store by modifying orig. */
-            if (!(subdir = treeobj_deep_copy (subdirktmp)))
-                goto done;
 
             /* copy from entry already in cache, assume novalidate ok */
             if (treeobj_insert_entry_novalidate (dir, name, subdir) < 0) {
@@ -828,6 +1101,17 @@ static int kvstxn_link_dirent (kvstxn_t *kt,
     /* This is the final path component of the key.  Add/modify/delete
      * it in the directory.
      */
+    if (treeobj_is_hdir (dir)) {
+        if (kvstxn_hdir_leaf (kt,
+                              dir,
+                              name,
+                              !json_is_null (dirent),
+                              &dir,
+                              missing_ref) < 0)
+            goto done;
+        if (!dir)
+            goto success; /* stall, or deleting a nonexistent key */
+    }
     if (!json_is_null (dirent)) {
         if (flags & FLUX_KVS_APPEND) {
             if (kvstxn_append (kt, dirent, dir, name, append) < 0)
@@ -1291,6 +1575,8 @@ kvstxn_mgr_t *kvstxn_mgr_create (struct cache *cache,
     }
     ktm->h = h;
     ktm->aux = aux;
+    ktm->hdir_threshold = KVSTXN_HDIR_THRESHOLD_DEFAULT;
+    ktm->ivalref_chunk = KVSTXN_IVALREF_CHUNK_DEFAULT;
     return ktm;
 
  error:
@@ -1394,6 +1680,26 @@ int kvstxn_mgr_get_noop_stores (kvstxn_mgr_t *ktm)
     return ktm->noop_stores;
 }
 
+int kvstxn_mgr_set_hdir_threshold (kvstxn_mgr_t *ktm, int threshold)
+{
+    if (!ktm || threshold < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    ktm->hdir_threshold = threshold;
+    return 0;
+}
+
+int kvstxn_mgr_set_ivalref_chunk (kvstxn_mgr_t *ktm, int chunk)
+{
+    if (!ktm || chunk < 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    ktm->ivalref_chunk = chunk;
+    return 0;
+}
+
 int kvstxn_mgr_ready_transaction_count (kvstxn_mgr_t *ktm)
 {
     return zlist_size (ktm->ready);
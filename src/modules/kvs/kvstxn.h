@@ -208,6 +208,26 @@ void kvstxn_mgr_remove_transaction (kvstxn_mgr_t *ktm,
 
 int kvstxn_mgr_get_noop_stores (kvstxn_mgr_t *ktm);
 
+/* Directories (other than the root) with more than 'threshold' entries
+ * are stored as sharded hdir objects, so that updating one key rewrites
+ * only the shards along its path.  0 (the default) disables sharding of
+ * directories that are not already sharded, since older readers do not
+ * understand hdir objects.
+ */
+#define KVSTXN_HDIR_THRESHOLD_DEFAULT 0
+
+int kvstxn_mgr_set_hdir_threshold (kvstxn_mgr_t *ktm, int threshold);
+
+/* A valref that is appended to beyond 'chunk' blobrefs is converted to
+ * an ivalref, which keeps up to 'chunk' blobrefs inline and the rest in
+ * a chain of stored chunks, so that an append does not copy every
+ * blobref appended before it.  0 (the default) disables the conversion,
+ * since older readers do not understand ivalref objects.
+ */
+#define KVSTXN_IVALREF_CHUNK_DEFAULT 0
+
+int kvstxn_mgr_set_ivalref_chunk (kvstxn_mgr_t *ktm, int chunk);
+
 /* return count of ready transactions */
 int kvstxn_mgr_ready_transaction_count (kvstxn_mgr_t *ktm);
 
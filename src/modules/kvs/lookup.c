@@ -83,6 +83,24 @@ struct lookup {
     const json_t *valref_missing_refs;
     const char *missing_ref;
 
+    /* hdir shards or ivalref chunks not yet in cache, as a valref so
+     * that they can be iterated on as valref_missing_refs.
+     */
+    json_t *missing_refs;
+
+    /* blob index range to read, see lookup_set_range() */
+    bool range_set;
+    int range_first;
+    int range_last;
+
+    /* valref of the blobrefs to read, when not lh->wdirent itself */
+    json_t *vref;
+
+    /* with FLUX_KVS_RAW, value as buffers, see lookup_get_value_iov() */
+    struct iovec *iov;
+    int iovcnt;
+    void *rawbuf;
+
     /* for namespace callback */
 
     char *missing_namespace;
@@ -340,6 +358,64 @@ cleanup:
     return ret;
 }
 
+/* 'hdir' is a sharded directory.  Find the dir shard that would hold
+ * 'name', following dirref shards through the cache.  On success, set
+ * *leafp to the shard (or NULL if there is none) and *entryp to the
+ * cache entry that holds it, if it was loaded from a dirref.
+ */
+static lookup_process_t walk_hdir (lookup_t *lh,
+                                   const json_t *hdir,
+                                   const char *name,
+                                   const json_t **leafp,
+                                   struct cache_entry **entryp)
+{
+    const json_t *shard;
+    int depth = 0;
+
+    while (1) {
+        if (!(shard = treeobj_hdir_peek_shard (hdir, name, depth))) {
+            if (errno != ENOENT) {
+                lh->errnum = errno;
+                return LOOKUP_PROCESS_ERROR;
+            }
+            (*leafp) = NULL;
+            return LOOKUP_PROCESS_FINISHED;
+        }
+        if (treeobj_is_dirref (shard)) {
+            struct cache_entry *entry;
+            const char *refstr;
+
+            if (treeobj_get_count (shard) != 1
+                || !(refstr = treeobj_get_blobref (shard, 0))) {
+                flux_log (lh->h, LOG_ERR, "invalid hdir shard dirref");
+                lh->errnum = ENOTRECOVERABLE;
+                return LOOKUP_PROCESS_ERROR;
+            }
+            if (!(entry = cache_lookup (lh->cache, refstr))
+                || !cache_entry_get_valid (entry)) {
+                lh->missing_ref = refstr;
+                return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+            }
+            if (!(shard = cache_entry_get_treeobj (entry))) {
+                flux_log (lh->h, LOG_ERR, "hdir shard is non-treeobj");
+                lh->errnum = ENOTRECOVERABLE;
+                return LOOKUP_PROCESS_ERROR;
+            }
+            (*entryp) = entry;
+        }
+        if (treeobj_is_dir (shard)) {
+            (*leafp) = shard;
+            return LOOKUP_PROCESS_FINISHED;
+        }
+        if (!treeobj_is_hdir (shard)) {
+            lh->errnum = ENOTRECOVERABLE;
+            return LOOKUP_PROCESS_ERROR;
+        }
+        hdir = shard;
+        depth++;
+    }
+}
+
 /* Get dirent of the requested path starting at the given root.
  *
  * Return true on success or error, error code is returned in ep and
@@ -400,7 +476,7 @@ static lookup_process_t walk (lookup_t *lh)
                     lh->errnum = ENOTRECOVERABLE;
                 goto error;
             }
-            if (!treeobj_is_dir (dir)) {
+            if (!treeobj_is_dir (dir) && !treeobj_is_hdir (dir)) {
                 /* dirref pointed to non-dir error, special case when
                  * root_dirent is bad, is EINVAL from user.
                  */
@@ -413,6 +489,7 @@ static lookup_process_t walk (lookup_t *lh)
         } else {
             /* Unexpected dirent type */
             if (treeobj_is_valref (wl->dirent)
+                || treeobj_is_ivalref (wl->dirent)
                 || treeobj_is_val (wl->dirent)) {
                 /* don't return ENOENT or ENOTDIR, error to be
                  * determined by caller */
@@ -436,6 +513,20 @@ static lookup_process_t walk (lookup_t *lh)
             }
         }
 
+        /* Find the shard of a sharded directory that holds pathcomp */
+
+        if (treeobj_is_hdir (dir)) {
+            lookup_process_t hret;
+
+            hret = walk_hdir (lh, dir, pathcomp, &dir, &entry);
+            if (hret == LOOKUP_PROCESS_ERROR)
+                goto error;
+            else if (hret == LOOKUP_PROCESS_LOAD_MISSING_REFS)
+                return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+            if (!dir)
+                goto done; /* let caller decide, as for a missing entry */
+        }
+
         /* Get directory reference of path component from directory */
 
         if (!(dirent_tmp = treeobj_peek_entry (dir, pathcomp))) {
@@ -529,6 +620,15 @@ lookup_t *lookup_create (struct cache *cache,
         return NULL;
     }
 
+    /* raw values only, not treeobjs, directories, or symlinks */
+    if ((flags & FLUX_KVS_RAW)
+        && (flags & (FLUX_KVS_TREEOBJ
+                     | FLUX_KVS_READDIR
+                     | FLUX_KVS_READLINK))) {
+        errno = EINVAL;
+        return NULL;
+    }
+
     if (!(lh = calloc (1, sizeof (*lh))))
         goto cleanup;
 
@@ -584,6 +684,10 @@ void lookup_destroy (lookup_t *lh)
         free (lh->root_ref);
         free (lh->path);
         json_decref (lh->val);
+        json_decref (lh->missing_refs);
+        json_decref (lh->vref);
+        free (lh->iov);
+        free (lh->rawbuf);
         free (lh->missing_namespace);
         zlist_destroy (&lh->levels);
         free (lh);
@@ -591,6 +695,18 @@ void lookup_destroy (lookup_t *lh)
     }
 }
 
+int lookup_set_range (lookup_t *lh, int first, int last)
+{
+    if (!lh || lh->state != LOOKUP_STATE_INIT) {
+        errno = EINVAL;
+        return -1;
+    }
+    lh->range_set = true;
+    lh->range_first = first;
+    lh->range_last = last;
+    return 0;
+}
+
 int lookup_get_errnum (lookup_t *lh)
 {
     if (lh) {
@@ -630,6 +746,66 @@ json_t *lookup_get_value (lookup_t *lh)
     return NULL;
 }
 
+/* With FLUX_KVS_RAW, lh->val is a val, or a valref whose blobs were
+ * all found in cache by lookup().  The iovec points directly at the
+ * cache entries, so it must be consumed before the cache is expired.
+ */
+int lookup_get_value_iov (lookup_t *lh, const struct iovec **iov, int *iovcnt)
+{
+    int count;
+    int i;
+
+    if (!lh || !iov || !iovcnt
+        || lh->state != LOOKUP_STATE_FINISHED
+        || !(lh->flags & FLUX_KVS_RAW)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!lh->val) {
+        errno = ENOENT;
+        return -1;
+    }
+    if (!lh->iov) {
+        if (treeobj_is_val (lh->val))
+            count = 1;
+        else if ((count = treeobj_get_count (lh->val)) < 0)
+            return -1;
+        if (!(lh->iov = calloc (count, sizeof (lh->iov[0]))))
+            return -1;
+        if (treeobj_is_val (lh->val)) {
+            size_t len;
+
+            if (treeobj_decode_val (lh->val, &lh->rawbuf, &len) < 0)
+                return -1;
+            lh->iov[0].iov_base = lh->rawbuf;
+            lh->iov[0].iov_len = len;
+        }
+        else {
+            for (i = 0; i < count; i++) {
+                struct cache_entry *entry;
+                const char *ref;
+                const void *data;
+                int len;
+
+                if (!(ref = treeobj_get_blobref (lh->val, i))
+                    || !(entry = cache_lookup (lh->cache, ref))
+                    || !cache_entry_get_valid (entry)
+                    || cache_entry_get_raw (entry, &data, &len) < 0) {
+                    flux_log (lh->h, LOG_ERR, "valref blob not in cache");
+                    errno = ENOTRECOVERABLE;
+                    return -1;
+                }
+                lh->iov[i].iov_base = (void *)data;
+                lh->iov[i].iov_len = len;
+            }
+        }
+        lh->iovcnt = count;
+    }
+    *iov = lh->iov;
+    *iovcnt = lh->iovcnt;
+    return 0;
+}
+
 int lookup_iter_missing_refs (lookup_t *lh, lookup_ref_f cb, void *data)
 {
     if (lh
@@ -706,6 +882,13 @@ int lookup_get_root_seq (lookup_t *lh)
     return -1;
 }
 
+int lookup_get_flags (lookup_t *lh)
+{
+    if (lh)
+        return lh->flags;
+    return 0;
+}
+
 static int namespace_still_valid (lookup_t *lh)
 {
     struct kvsroot *root;
@@ -732,20 +915,22 @@ static int namespace_still_valid (lookup_t *lh)
 
 /* return 0 on success, -1 on failure.  On success, stall should be
  * checked */
-static int get_single_blobref_valref_value (lookup_t *lh, bool *stall)
+static int get_single_blobref_valref_value (lookup_t *lh,
+                                            const json_t *vref,
+                                            bool *stall)
 {
     struct cache_entry *entry;
     const char *reftmp;
     const void *valdata;
     int len;
 
-    if (!(reftmp = treeobj_get_blobref (lh->wdirent, 0))) {
+    if (!(reftmp = treeobj_get_blobref (vref, 0))) {
         lh->errnum = errno;
         return -1;
     }
     if (!(entry = cache_lookup (lh->cache, reftmp))
         || !cache_entry_get_valid (entry)) {
-        lh->valref_missing_refs = lh->wdirent;
+        lh->valref_missing_refs = vref;
         (*stall) = true;
         return 0;
     }
@@ -763,6 +948,7 @@ static int get_single_blobref_valref_value (lookup_t *lh, bool *stall)
 }
 
 static int get_multi_blobref_valref_length (lookup_t *lh,
+                                            const json_t *vref,
                                             int refcount,
                                             int *total_len,
                                             bool *stall)
@@ -774,13 +960,13 @@ static int get_multi_blobref_valref_length (lookup_t *lh,
     int i;
 
     for (i = 0; i < refcount; i++) {
-        if (!(reftmp = treeobj_get_blobref (lh->wdirent, i))) {
+        if (!(reftmp = treeobj_get_blobref (vref, i))) {
             lh->errnum = errno;
             return -1;
         }
         if (!(entry = cache_lookup (lh->cache, reftmp))
             || !cache_entry_get_valid (entry)) {
-            lh->valref_missing_refs = lh->wdirent;
+            lh->valref_missing_refs = vref;
             (*stall) = true;
             return 0;
         }
@@ -805,6 +991,7 @@ static int get_multi_blobref_valref_length (lookup_t *lh,
 }
 
 static char *get_multi_blobref_valref_data (lookup_t *lh,
+                                            const json_t *vref,
                                             int refcount,
                                             int total_len)
 {
@@ -827,7 +1014,7 @@ static char *get_multi_blobref_valref_data (lookup_t *lh,
         /* this function should only be called if all cache entries
          * known to be valid & raw, thus assert checks below */
 
-        reftmp = treeobj_get_blobref (lh->wdirent, i);
+        reftmp = treeobj_get_blobref (vref, i);
         assert (reftmp);
 
         entry = cache_lookup (lh->cache, reftmp);
@@ -848,6 +1035,7 @@ static char *get_multi_blobref_valref_data (lookup_t *lh,
 /* return 0 on success, -1 on failure.  On success, stall should be
  * check */
 static int get_multi_blobref_valref_value (lookup_t *lh,
+                                           const json_t *vref,
                                            int refcount,
                                            bool *stall)
 {
@@ -855,7 +1043,11 @@ static int get_multi_blobref_valref_value (lookup_t *lh,
     int total_len = 0;
     int rc = -1;
 
-    if (get_multi_blobref_valref_length (lh, refcount, &total_len, stall) < 0)
+    if (get_multi_blobref_valref_length (lh,
+                                         vref,
+                                         refcount,
+                                         &total_len,
+                                         stall) < 0)
         goto done;
 
     if ((*stall) == true) {
@@ -863,7 +1055,10 @@ static int get_multi_blobref_valref_value (lookup_t *lh,
         goto done;
     }
 
-    if (!(valbuf = get_multi_blobref_valref_data (lh, refcount, total_len)))
+    if (!(valbuf = get_multi_blobref_valref_data (lh,
+                                                  vref,
+                                                  refcount,
+                                                  total_len)))
         goto done;
 
     if (!(lh->val = treeobj_create_val (valbuf, total_len))) {
@@ -878,6 +1073,373 @@ done:
     return rc;
 }
 
+/* Get the number of blobs in the value of a val, valref, or ivalref.
+ * Return count on success, -1 on failure.
+ */
+static int get_blob_count (lookup_t *lh, const json_t *obj)
+{
+    int count;
+
+    if (treeobj_is_ivalref (obj)) {
+        if (treeobj_get_ivalref (obj, NULL, &count) < 0) {
+            lh->errnum = errno;
+            return -1;
+        }
+    }
+    else if (treeobj_is_val (obj))
+        count = 1;
+    else if ((count = treeobj_get_count (obj)) < 0) {
+        lh->errnum = errno;
+        return -1;
+    }
+    if (count == 0) {
+        flux_log (lh->h, LOG_ERR, "invalid valref count: %d", count);
+        lh->errnum = ENOTRECOVERABLE;
+        return -1;
+    }
+    return count;
+}
+
+/* Get the blob index range [first, last] to read from a value of
+ * 'count' blobs.  Negative indices set with lookup_set_range() count
+ * back from the end.  Return 0 on success, -1 on failure.
+ */
+static int get_range (lookup_t *lh, int count, int *first, int *last)
+{
+    int f = 0;
+    int l = count - 1;
+
+    if (lh->range_set) {
+        f = lh->range_first < 0 ? lh->range_first + count : lh->range_first;
+        l = lh->range_last < 0 ? lh->range_last + count : lh->range_last;
+        if (f < 0 || f > l || l >= count) {
+            lh->errnum = ERANGE;
+            return -1;
+        }
+    }
+    *first = f;
+    *last = l;
+    return 0;
+}
+
+/* Add a missing blobref to lh->missing_refs.
+ * Return 0 on success, -1 on failure.
+ */
+static int add_missing_ref (lookup_t *lh, const char *ref)
+{
+    if (!lh->missing_refs)
+        lh->missing_refs = treeobj_create_valref (NULL);
+    if (!lh->missing_refs
+        || treeobj_append_blobref (lh->missing_refs, ref) < 0) {
+        lh->errnum = errno;
+        return -1;
+    }
+    return 0;
+}
+
+/* Find the chunks of ivalref 'obj' that hold blobs [first, last] in its
+ * chunk index, and add those not in cache to lh->missing_refs, so that
+ * they are all loaded with a single stall.  An ivalref without an index
+ * is left to get_valref_range(), which loads its chain one chunk at a time.
+ * Return 0 on success, -1 on failure.  On success, stall should be
+ * checked.
+ */
+static int ivalref_collect (lookup_t *lh,
+                            const json_t *obj,
+                            int first,
+                            int last,
+                            bool *stall)
+{
+    struct cache_entry *entry;
+    const char *ref;
+    int nchunks, i;
+    int start, end;
+
+    lh->valref_missing_refs = NULL;
+    json_decref (lh->missing_refs);
+    lh->missing_refs = NULL;
+
+    (*stall) = false;
+    if ((nchunks = treeobj_get_ivalref_nchunks (obj)) < 0) {
+        lh->errnum = errno;
+        return -1;
+    }
+    for (i = nchunks - 1; i >= 0; i--) {
+        if (treeobj_get_ivalref_chunk (obj, i, &ref, &end) < 0) {
+            lh->errnum = errno;
+            return -1;
+        }
+        if (end <= first)
+            break;
+        start = 0;
+        if (i > 0
+            && treeobj_get_ivalref_chunk (obj, i - 1, NULL, &start) < 0) {
+            lh->errnum = errno;
+            return -1;
+        }
+        if (start > last)
+            continue;
+        if (!(entry = cache_lookup (lh->cache, ref))
+            || !cache_entry_get_valid (entry)) {
+            if (add_missing_ref (lh, ref) < 0)
+                return -1;
+            (*stall) = true;
+        }
+    }
+    if ((*stall))
+        lh->valref_missing_refs = lh->missing_refs;
+    return 0;
+}
+
+/* Set 'vrefp' to a valref of blobrefs [first, last] of the valref or
+ * ivalref lh->wdirent.  The chunks of an ivalref are read from the cache,
+ * newest first, only as far back as 'first'.  With a chunk index, only the
+ * chunks holding the range are read, and all that are missing are loaded
+ * with one stall, see ivalref_collect().  Otherwise 'prev' is followed
+ * one chunk at a time.
+ * Return 0 on success, -1 on failure.  On success, stall should be
+ * checked.
+ */
+static int get_valref_range (lookup_t *lh,
+                             int first,
+                             int last,
+                             const json_t **vrefp,
+                             bool *stall)
+{
+    const json_t *obj = lh->wdirent;
+    json_t *refs = NULL;
+    json_t *vref = NULL;
+    json_t *o;
+    const char *prev;
+    const char *ref;
+    struct cache_entry *entry;
+    int count, base, start, end, i;
+    int nchunks = 0;
+    int rc = -1;
+
+    if (treeobj_is_valref (obj)
+        && first == 0
+        && last == treeobj_get_count (obj) - 1) {
+        (*vrefp) = obj;
+        (*stall) = false;
+        return 0;
+    }
+    if (treeobj_is_ivalref (obj)) {
+        if ((nchunks = treeobj_get_ivalref_nchunks (obj)) < 0) {
+            lh->errnum = errno;
+            return -1;
+        }
+        if (nchunks > 0) {
+            if (ivalref_collect (lh, obj, first, last, stall) < 0)
+                return -1;
+            if ((*stall))
+                return 0;
+        }
+    }
+    if (!(refs = json_array ())) {
+        lh->errnum = ENOMEM;
+        goto done;
+    }
+    /* collect blobrefs last to first */
+    while (true) {
+        prev = NULL;
+        base = 0;
+        if (treeobj_is_ivalref (obj)) {
+            if (treeobj_get_ivalref (obj, &prev, &count) < 0) {
+                lh->errnum = errno;
+                goto done;
+            }
+            base = count - treeobj_get_count (obj);
+        }
+        for (i = treeobj_get_count (obj) - 1; i >= 0; i--) {
+            if (base + i > last)
+                continue;
+            if (base + i < first)
+                break;
+            if (!(o = json_string (treeobj_get_blobref (obj, i)))
+                || json_array_append_new (refs, o) < 0) {
+                lh->errnum = ENOMEM;
+                goto done;
+            }
+        }
+        if (first >= base)
+            break;
+        /* next chunk is the newest one that starts at or before 'last' */
+        if (nchunks > 0) {
+            do {
+                nchunks--;
+                start = 0;
+                if (treeobj_get_ivalref_chunk (lh->wdirent,
+                                               nchunks,
+                                               &ref,
+                                               &end) < 0
+                    || (nchunks > 0
+                        && treeobj_get_ivalref_chunk (lh->wdirent,
+                                                      nchunks - 1,
+                                                      NULL,
+                                                      &start) < 0)) {
+                    lh->errnum = errno;
+                    goto done;
+                }
+            } while (start > last && nchunks > 0);
+        }
+        else {
+            if (!prev) {
+                flux_log (lh->h, LOG_ERR, "ivalref chain ends early");
+                lh->errnum = ENOTRECOVERABLE;
+                goto done;
+            }
+            ref = prev;
+            start = -1;
+            end = base;
+        }
+        if (!(entry = cache_lookup (lh->cache, ref))
+            || !cache_entry_get_valid (entry)) {
+            lh->valref_missing_refs = NULL;
+            lh->missing_ref = ref;
+            (*stall) = true;
+            rc = 0;
+            goto done;
+        }
+        if (!(obj = cache_entry_get_treeobj (entry))
+            || !treeobj_is_ivalref (obj)
+            || treeobj_get_ivalref (obj, NULL, &count) < 0
+            || count != end
+            || (start >= 0 && count - treeobj_get_count (obj) != start)) {
+            flux_log (lh->h, LOG_ERR, "ivalref chunk %s is corrupt", ref);
+            lh->errnum = ENOTRECOVERABLE;
+            goto done;
+        }
+    }
+    if (!(vref = treeobj_create_valref (NULL))) {
+        lh->errnum = errno;
+        goto done;
+    }
+    for (i = json_array_size (refs) - 1; i >= 0; i--) {
+        o = json_array_get (refs, i);
+        if (treeobj_append_blobref (vref, json_string_value (o)) < 0) {
+            lh->errnum = errno;
+            goto done;
+        }
+    }
+    json_decref (lh->vref);
+    lh->vref = vref;
+    vref = NULL;
+    (*vrefp) = lh->vref;
+    (*stall) = false;
+    rc = 0;
+done:
+    json_decref (vref);
+    json_decref (refs);
+    return rc;
+}
+
+/* Copy the entries of the sharded directory 'hdir' into 'dir'.  Shards
+ * that are not in cache are added to lh->missing_refs and 'stall'
+ * is set, but the rest are still visited so that all missing shards at
+ * this level are loaded together.
+ * Return 0 on success, -1 on failure.
+ */
+static int hdir_collect (lookup_t *lh,
+                         const json_t *hdir,
+                         json_t *dir,
+                         bool *stall)
+{
+    const char *key;
+    json_t *shard;
+
+    /* N.B. it should be safe to cast away const on 'hdir' as long as
+     * 'shard' is not modified.
+     */
+    json_object_foreach (treeobj_get_data ((json_t *)hdir), key, shard) {
+        const json_t *obj = shard;
+
+        if (treeobj_is_dirref (shard)) {
+            struct cache_entry *entry;
+            const char *ref;
+
+            if (treeobj_get_count (shard) != 1
+                || !(ref = treeobj_get_blobref (shard, 0))) {
+                flux_log (lh->h, LOG_ERR, "invalid hdir shard dirref");
+                lh->errnum = ENOTRECOVERABLE;
+                return -1;
+            }
+            if (!(entry = cache_lookup (lh->cache, ref))
+                || !cache_entry_get_valid (entry)) {
+                if (add_missing_ref (lh, ref) < 0)
+                    return -1;
+                (*stall) = true;
+                continue;
+            }
+            if (!(obj = cache_entry_get_treeobj (entry))) {
+                flux_log (lh->h, LOG_ERR, "hdir shard is non-treeobj");
+                lh->errnum = ENOTRECOVERABLE;
+                return -1;
+            }
+        }
+        if (treeobj_is_hdir (obj)) {
+            if (hdir_collect (lh, obj, dir, stall) < 0)
+                return -1;
+        }
+        else if (treeobj_is_dir (obj)) {
+            const char *name;
+            json_t *entry;
+
+            if ((*stall))
+                continue; /* result will be discarded */
+            json_object_foreach (treeobj_get_data ((json_t *)obj),
+                                 name,
+                                 entry) {
+                json_t *cpy;
+
+                if (!(cpy = treeobj_deep_copy (entry))
+                    || treeobj_insert_entry_novalidate (dir, name, cpy) < 0) {
+                    lh->errnum = errno ? errno : ENOMEM;
+                    json_decref (cpy);
+                    return -1;
+                }
+                json_decref (cpy);
+            }
+        }
+        else {
+            lh->errnum = ENOTRECOVERABLE;
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/* Readdir of a sharded directory returns an ordinary dir, so that it is
+ * indistinguishable from an unsharded one to clients.
+ * return 0 on success, -1 on failure.  On success, stall should be
+ * checked
+ */
+static int get_hdir_value (lookup_t *lh, const json_t *hdir, bool *stall)
+{
+    json_t *dir;
+
+    lh->valref_missing_refs = NULL;
+    json_decref (lh->missing_refs);
+    lh->missing_refs = NULL;
+
+    if (!(dir = treeobj_create_dir ())) {
+        lh->errnum = errno;
+        return -1;
+    }
+    (*stall) = false;
+    if (hdir_collect (lh, hdir, dir, stall) < 0) {
+        json_decref (dir);
+        return -1;
+    }
+    if ((*stall)) {
+        json_decref (dir);
+        lh->valref_missing_refs = lh->missing_refs;
+        return 0;
+    }
+    lh->val = dir;
+    return 0;
+}
+
 lookup_process_t lookup (lookup_t *lh)
 {
     const json_t *valtmp = NULL;
@@ -946,6 +1508,10 @@ lookup_process_t lookup (lookup_t *lh)
 
             /* special case root */
             if (streq (lh->path, ".")) {
+                if (lh->range_set) {
+                    lh->errnum = EINVAL;
+                    goto error;
+                }
                 if ((lh->flags & FLUX_KVS_TREEOBJ)) {
                     if (!(lh->val = treeobj_create_dirref (lh->root_ref))) {
                         lh->errnum = errno;
@@ -1023,7 +1589,40 @@ lookup_process_t lookup (lookup_t *lh)
                     goto error;
             }
 
+            if (lh->range_set
+                && !treeobj_is_val (lh->wdirent)
+                && !treeobj_is_valref (lh->wdirent)
+                && !treeobj_is_ivalref (lh->wdirent)) {
+                lh->errnum = EINVAL;
+                goto error;
+            }
+
             if ((lh->flags & FLUX_KVS_TREEOBJ)) {
+                /* with a range, return a valref of only those blobs */
+                if (lh->range_set) {
+                    const json_t *vref = lh->wdirent;
+                    bool stall = false;
+                    int first, last;
+
+                    if ((refcount = get_blob_count (lh, lh->wdirent)) < 0
+                        || get_range (lh, refcount, &first, &last) < 0)
+                        goto error;
+                    if (!treeobj_is_val (lh->wdirent)) {
+                        if (get_valref_range (lh,
+                                              first,
+                                              last,
+                                              &vref,
+                                              &stall) < 0)
+                            goto error;
+                        if (stall)
+                            return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+                    }
+                    if (!(lh->val = treeobj_deep_copy (vref))) {
+                        lh->errnum = errno;
+                        goto error;
+                    }
+                    goto done;
+                }
                 if (!(lh->val = treeobj_deep_copy (lh->wdirent))) {
                     lh->errnum = errno;
                     goto error;
@@ -1064,18 +1663,29 @@ lookup_process_t lookup (lookup_t *lh)
                     lh->errnum = ENOTRECOVERABLE;
                     goto error;
                 }
-                if (!treeobj_is_dir (valtmp)) {
+                if (treeobj_is_hdir (valtmp)) {
+                    bool stall;
+
+                    if (get_hdir_value (lh, valtmp, &stall) < 0)
+                        goto error;
+                    if (stall)
+                        return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+                }
+                else if (!treeobj_is_dir (valtmp)) {
                     /* dirref points to not dir */
                     lh->errnum = ENOTRECOVERABLE;
                     goto error;
                 }
-                if (!(lh->val = treeobj_deep_copy (valtmp))) {
+                else if (!(lh->val = treeobj_deep_copy (valtmp))) {
                     lh->errnum = errno;
                     goto error;
                 }
             }
-            else if (treeobj_is_valref (lh->wdirent)) {
+            else if (treeobj_is_valref (lh->wdirent)
+                     || treeobj_is_ivalref (lh->wdirent)) {
+                const json_t *vref;
                 bool stall;
+                int first, last;
 
                 if ((lh->flags & FLUX_KVS_READLINK)) {
                     lh->errnum = EINVAL;
@@ -1085,26 +1695,43 @@ lookup_process_t lookup (lookup_t *lh)
                     lh->errnum = ENOTDIR;
                     goto error;
                 }
-                if ((refcount = treeobj_get_count (lh->wdirent)) < 0) {
-                    lh->errnum = errno;
+                if ((refcount = get_blob_count (lh, lh->wdirent)) < 0
+                    || get_range (lh, refcount, &first, &last) < 0)
                     goto error;
-                }
-                if (!refcount) {
-                    flux_log (lh->h,
-                              LOG_ERR,
-                              "invalid valref count: %d",
-                              refcount);
-                    lh->errnum = ENOTRECOVERABLE;
+                if (get_valref_range (lh, first, last, &vref, &stall) < 0)
                     goto error;
+                if (stall)
+                    return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+                refcount = treeobj_get_count (vref);
+                if ((lh->flags & FLUX_KVS_RAW)) {
+                    int total_len;
+
+                    /* blobs are sent from cache, see lookup_get_value_iov()
+                     */
+                    if (get_multi_blobref_valref_length (lh,
+                                                         vref,
+                                                         refcount,
+                                                         &total_len,
+                                                         &stall) < 0)
+                        goto error;
+                    if (stall)
+                        return LOOKUP_PROCESS_LOAD_MISSING_REFS;
+                    if (!(lh->val = treeobj_deep_copy (vref))) {
+                        lh->errnum = errno;
+                        goto error;
+                    }
                 }
-                if (refcount == 1) {
-                    if (get_single_blobref_valref_value (lh, &stall) < 0)
+                else if (refcount == 1) {
+                    if (get_single_blobref_valref_value (lh,
+                                                         vref,
+                                                         &stall) < 0)
                         goto error;
                     if (stall)
                         return LOOKUP_PROCESS_LOAD_MISSING_REFS;
                 }
                 else {
                     if (get_multi_blobref_valref_value (lh,
+                                                        vref,
                                                         refcount,
                                                         &stall) < 0)
                         goto error;
@@ -1127,6 +1754,8 @@ lookup_process_t lookup (lookup_t *lh)
                 }
             }
             else if (treeobj_is_val (lh->wdirent)) {
+                int first, last;
+
                 if ((lh->flags & FLUX_KVS_READLINK)) {
                     lh->errnum = EINVAL;
                     goto error;
@@ -1135,6 +1764,8 @@ lookup_process_t lookup (lookup_t *lh)
                     lh->errnum = ENOTDIR;
                     goto error;
                 }
+                if (get_range (lh, 1, &first, &last) < 0)
+                    goto error;
                 if (!(lh->val = treeobj_deep_copy (lh->wdirent))) {
                     lh->errnum = errno;
                     goto error;
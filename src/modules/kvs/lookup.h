@@ -11,6 +11,7 @@
 #ifndef _FLUX_KVS_LOOKUP_H
 #define _FLUX_KVS_LOOKUP_H
 
+#include <sys/uio.h>
 #include <flux/core.h>
 #include "cache.h"
 #include "kvsroot.h"
@@ -51,6 +52,15 @@ lookup_t *lookup_create (struct cache *cache,
 /* Destroy a lookup handle */
 void lookup_destroy (lookup_t *lh);
 
+/* Read only blobs [first, last] of a val, valref, or ivalref value,
+ * where a negative index counts back from the last blob (-1).  With
+ * FLUX_KVS_TREEOBJ, a valref of just those blobrefs is returned.
+ * Must be called before the first lookup().  The lookup fails with
+ * ERANGE if the range is empty or out of bounds, or EINVAL if the
+ * value is of another type.
+ */
+int lookup_set_range (lookup_t *lh, int first, int last);
+
 /* Get errnum, should be checked after lookup() returns
  * LOOKUP_PROCESS_ERROR */
 int lookup_get_errnum (lookup_t *lh);
@@ -67,6 +77,18 @@ int lookup_set_aux_errnum (lookup_t *lh, int errnum);
  * memory. */
 json_t *lookup_get_value (lookup_t *lh);
 
+/* With FLUX_KVS_RAW, get the value of lookup() as an array of buffers
+ * whose concatenation is the value, after lookup() returns
+ * LOOKUP_PROCESS_FINISHED.  The buffers of a valref point into the KVS
+ * cache and are only valid until the cache is next expired.  The array
+ * is owned by the lookup handle.  Fails with ENOENT if there is no value.
+ */
+int lookup_get_value_iov (lookup_t *lh, const struct iovec **iov, int *iovcnt);
+
+/* Get the flags passed to lookup_create().
+ */
+int lookup_get_flags (lookup_t *lh);
+
 /* On lookup stall b/c of missing reference(s), get missing reference
  * that should be loaded into the KVS cache via callback function.
  *
@@ -3021,6 +3021,184 @@ void kvstxn_process_giant_dir (void)
     json_decref (root);
 }
 
+/* With a small hdir threshold, a directory is stored sharded and an
+ * update to one key only rewrites the root, the hdir, and one shard.
+ */
+void kvstxn_process_hdir (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    int count = 0;
+    kvstxn_mgr_t *ktm;
+    kvstxn_t *kt;
+    char rootref[BLOBREF_MAX_STRING_SIZE];
+    char newroot[BLOBREF_MAX_STRING_SIZE];
+    char key[64];
+    char val[64];
+    struct cache_entry *entry;
+    const json_t *o;
+    json_t *ops, *op, *dir;
+    lookup_t *lh;
+    struct flux_msg_cred cred = { .rolemask = FLUX_ROLE_OWNER, .userid = 0 };
+    int i;
+
+    cache = create_cache_with_empty_rootdir (rootref, sizeof (rootref));
+
+    ok ((krm = kvsroot_mgr_create (NULL, NULL)) != NULL,
+        "kvsroot_mgr_create works");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, ref_dummy);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    errno = 0;
+    ok (kvstxn_mgr_set_hdir_threshold (ktm, -1) < 0 && errno == EINVAL,
+        "kvstxn_mgr_set_hdir_threshold fails on negative threshold");
+    ok (kvstxn_mgr_set_hdir_threshold (ktm, 4) == 0,
+        "kvstxn_mgr_set_hdir_threshold 4 works");
+
+    ops = json_array ();
+    for (i = 0; i < 16; i++) {
+        snprintf (key, sizeof (key), "dir.key%d", i);
+        snprintf (val, sizeof (val), "val%d", i);
+        ops_append (ops, key, val, 0);
+    }
+    ok (kvstxn_mgr_add_transaction (ktm, "transaction1", ops, 0, 0) == 0,
+        "kvstxn_mgr_add_transaction works");
+    json_decref (ops);
+
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+
+    ok (kvstxn_process (kt, rootref, 0) == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES,
+        "kvstxn_process returns KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES");
+
+    ok (kvstxn_iter_dirty_cache_entries (kt, cache_count_dirty_cb, &count) == 0,
+        "kvstxn_iter_dirty_cache_entries works for dirty cache entries");
+
+    ok (count > 3,
+        "root, hdir, and multiple shards were dirty");
+
+    ok (kvstxn_process (kt, rootref, 0) == KVSTXN_PROCESS_FINISHED,
+        "kvstxn_process returns KVSTXN_PROCESS_FINISHED");
+
+    ok (kvstxn_get_newroot_ref (kt) != NULL,
+        "kvstxn_get_newroot_ref returns != NULL when processing complete");
+    strcpy (newroot, kvstxn_get_newroot_ref (kt));
+
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+
+    ok ((entry = cache_lookup (cache, newroot)) != NULL
+        && (o = cache_entry_get_treeobj (entry)) != NULL
+        && (o = treeobj_peek_entry (o, "dir")) != NULL
+        && treeobj_is_dirref (o)
+        && (entry = cache_lookup (cache, treeobj_get_blobref (o, 0))) != NULL
+        && (o = cache_entry_get_treeobj (entry)) != NULL
+        && treeobj_is_hdir (o),
+        "dir is stored as a dirref to an hdir");
+
+    for (i = 0; i < 16; i++) {
+        snprintf (key, sizeof (key), "dir.key%d", i);
+        snprintf (val, sizeof (val), "val%d", i);
+        verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, key, val);
+    }
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.nokey", NULL);
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             newroot,
+                             0,
+                             "dir",
+                             cred,
+                             FLUX_KVS_READDIR,
+                             NULL)) != NULL,
+        "lookup_create dir with FLUX_KVS_READDIR");
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED,
+        "lookup found result");
+    dir = lookup_get_value (lh);
+    ok (dir != NULL
+        && treeobj_is_dir (dir)
+        && treeobj_get_count (dir) == 16
+        && treeobj_peek_entry (dir, "key7") != NULL,
+        "readdir of hdir returns a dir with all 16 entries");
+    json_decref (dir);
+    lookup_destroy (lh);
+
+    /* update one key, and delete another */
+    create_ready_kvstxn (ktm, "transaction2", "dir.key3", "new", 0, 0);
+
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+
+    ok (kvstxn_process (kt, newroot, 0) == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES,
+        "kvstxn_process returns KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES");
+
+    count = 0;
+    ok (kvstxn_iter_dirty_cache_entries (kt, cache_count_dirty_cb, &count) == 0,
+        "kvstxn_iter_dirty_cache_entries works for dirty cache entries");
+
+    ok (count == 3,
+        "only root, hdir, and one shard were dirty");
+
+    ok (kvstxn_process (kt, newroot, 0) == KVSTXN_PROCESS_FINISHED,
+        "kvstxn_process returns KVSTXN_PROCESS_FINISHED");
+
+    strcpy (newroot, kvstxn_get_newroot_ref (kt));
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.key3", "new");
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.key4", "val4");
+
+    create_ready_kvstxn (ktm, "transaction3", "dir.key5", NULL, 0, 0);
+
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+
+    ok (kvstxn_process (kt, newroot, 0) == KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES,
+        "kvstxn_process returns KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES");
+
+    ok (kvstxn_iter_dirty_cache_entries (kt, cache_noop_cb, NULL) == 0,
+        "kvstxn_iter_dirty_cache_entries works for dirty cache entries");
+
+    ok (kvstxn_process (kt, newroot, 0) == KVSTXN_PROCESS_FINISHED,
+        "kvstxn_process returns KVSTXN_PROCESS_FINISHED");
+
+    strcpy (newroot, kvstxn_get_newroot_ref (kt));
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.key5", NULL);
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "dir.key6", "val6");
+
+    /* users may not commit hdir objects */
+    ops = json_array ();
+    dir = treeobj_create_hdir ();
+    txn_encode_op ("badhdir", 0, dir, &op);
+    json_array_append_new (ops, op);
+    json_decref (dir);
+    ok (kvstxn_mgr_add_transaction (ktm, "transaction4", ops, 0, 0) == 0,
+        "kvstxn_mgr_add_transaction works");
+    json_decref (ops);
+
+    ok ((kt = kvstxn_mgr_get_ready_transaction (ktm)) != NULL,
+        "kvstxn_mgr_get_ready_transaction returns ready kvstxn");
+
+    ok (kvstxn_process (kt, newroot, 0) == KVSTXN_PROCESS_ERROR
+        && kvstxn_get_errnum (kt) == EINVAL,
+        "kvstxn_process fails with EINVAL on hdir dirent");
+
+    kvstxn_mgr_remove_transaction (ktm, kt, false);
+
+    kvstxn_mgr_destroy (ktm);
+    kvsroot_mgr_destroy (krm);
+    cache_destroy (cache);
+}
+
 void kvstxn_process_append (void)
 {
     struct cache *cache;
@@ -3169,6 +3347,175 @@ void kvstxn_process_append (void)
     json_decref (root);
 }
 
+void kvstxn_process_ivalref (void)
+{
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    int count = 0;
+    kvstxn_mgr_t *ktm;
+    kvstxn_t *kt;
+    char rootref[BLOBREF_MAX_STRING_SIZE];
+    char newroot[BLOBREF_MAX_STRING_SIZE];
+    char name[64];
+    char val[2] = { 0 };
+    struct cache_entry *entry;
+    const json_t *o;
+    const char *prev;
+    json_t *test;
+    json_t *v;
+    lookup_t *lh;
+    struct flux_msg_cred cred = { .rolemask = FLUX_ROLE_OWNER, .userid = 0 };
+    int total;
+    int i;
+
+    cache = create_cache_with_empty_rootdir (rootref, sizeof (rootref));
+
+    ok ((krm = kvsroot_mgr_create (NULL, NULL)) != NULL,
+        "kvsroot_mgr_create works");
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, ref_dummy);
+
+    ok ((ktm = kvstxn_mgr_create (cache,
+                                  KVS_PRIMARY_NAMESPACE,
+                                  "sha1",
+                                  NULL,
+                                  &test_global)) != NULL,
+        "kvstxn_mgr_create works");
+
+    errno = 0;
+    ok (kvstxn_mgr_set_ivalref_chunk (ktm, -1) < 0 && errno == EINVAL,
+        "kvstxn_mgr_set_ivalref_chunk fails on negative chunk");
+    ok (kvstxn_mgr_set_ivalref_chunk (ktm, 4) == 0,
+        "kvstxn_mgr_set_ivalref_chunk 4 works");
+
+    /* append "a" through "j" to "log", one transaction each */
+    strcpy (newroot, rootref);
+    for (i = 0; i < 10; i++) {
+        val[0] = 'a' + i;
+        snprintf (name, sizeof (name), "transaction%d", i);
+        create_ready_kvstxn (ktm, name, "log", val, FLUX_KVS_APPEND, 0);
+
+        if (!(kt = kvstxn_mgr_get_ready_transaction (ktm)))
+            BAIL_OUT ("kvstxn_mgr_get_ready_transaction failed");
+        if (kvstxn_process (kt, newroot, 0)
+            != KVSTXN_PROCESS_DIRTY_CACHE_ENTRIES)
+            BAIL_OUT ("kvstxn_process failed");
+        count = 0;
+        (void)kvstxn_iter_dirty_cache_entries (kt,
+                                               cache_count_dirty_cb,
+                                               &count);
+        if (i == 8)
+            ok (count == 3,
+                "append to full ivalref dirties blob, chunk, and root");
+        if (i == 9)
+            ok (count == 2,
+                "append to ivalref dirties only blob and root");
+        if (kvstxn_process (kt, newroot, 0) != KVSTXN_PROCESS_FINISHED)
+            BAIL_OUT ("kvstxn_process failed");
+        strcpy (newroot, kvstxn_get_newroot_ref (kt));
+        kvstxn_mgr_remove_transaction (ktm, kt, false);
+    }
+
+    ok ((entry = cache_lookup (cache, newroot)) != NULL
+        && (o = cache_entry_get_treeobj (entry)) != NULL
+        && (o = treeobj_peek_entry (o, "log")) != NULL
+        && treeobj_is_ivalref (o)
+        && treeobj_get_ivalref (o, &prev, &total) == 0
+        && total == 10
+        && prev != NULL
+        && treeobj_get_count (o) == 2,
+        "log is an ivalref of 10 blobrefs, 2 inline");
+    ok (treeobj_get_ivalref_nchunks (o) == 2
+        && treeobj_get_ivalref_chunk (o, 1, &prev, &total) == 0
+        && total == 8,
+        "log has an index of 2 chunks, the newest ending at 8");
+
+    verify_value (cache, krm, KVS_PRIMARY_NAMESPACE, newroot, "log",
+                  "abcdefghij");
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             newroot,
+                             0,
+                             "log",
+                             cred,
+                             0,
+                             NULL)) != NULL
+        && lookup_set_range (lh, -3, -1) == 0,
+        "lookup_create log with range [-3, -1]");
+    test = treeobj_create_val ("hij", 3);
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED
+        && (v = lookup_get_value (lh)) != NULL
+        && json_equal (test, v),
+        "lookup returns last 3 blobs");
+    json_decref (test);
+    json_decref (v);
+    errno = 0;
+    ok (lookup_set_range (lh, 0, 0) < 0 && errno == EINVAL,
+        "lookup_set_range fails after lookup");
+    lookup_destroy (lh);
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             newroot,
+                             0,
+                             "log",
+                             cred,
+                             0,
+                             NULL)) != NULL
+        && lookup_set_range (lh, 2, 5) == 0,
+        "lookup_create log with range [2, 5]");
+    test = treeobj_create_val ("cdef", 4);
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED
+        && (v = lookup_get_value (lh)) != NULL
+        && json_equal (test, v),
+        "lookup returns blobs spanning chunks");
+    json_decref (test);
+    json_decref (v);
+    lookup_destroy (lh);
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             newroot,
+                             0,
+                             "log",
+                             cred,
+                             FLUX_KVS_TREEOBJ,
+                             NULL)) != NULL
+        && lookup_set_range (lh, 0, 1) == 0,
+        "lookup_create log with FLUX_KVS_TREEOBJ, range [0, 1]");
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED
+        && (v = lookup_get_value (lh)) != NULL
+        && treeobj_is_valref (v)
+        && treeobj_get_count (v) == 2,
+        "lookup returns valref of 2 blobrefs");
+    json_decref (v);
+    lookup_destroy (lh);
+
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             newroot,
+                             0,
+                             "log",
+                             cred,
+                             0,
+                             NULL)) != NULL
+        && lookup_set_range (lh, 5, 20) == 0,
+        "lookup_create log with range [5, 20]");
+    ok (lookup (lh) == LOOKUP_PROCESS_ERROR
+        && lookup_get_errnum (lh) == ERANGE,
+        "lookup fails with ERANGE");
+    lookup_destroy (lh);
+
+    kvstxn_mgr_destroy (ktm);
+    kvsroot_mgr_destroy (krm);
+    cache_destroy (cache);
+}
+
 void kvstxn_process_append_errors (void)
 {
     struct cache *cache;
@@ -3740,7 +4087,9 @@ int main (int argc, char *argv[])
     kvstxn_process_bad_dirrefs ();
     kvstxn_process_big_fileval ();
     kvstxn_process_giant_dir ();
+    kvstxn_process_hdir ();
     kvstxn_process_append ();
+    kvstxn_process_ivalref ();
     kvstxn_process_append_errors ();
     kvstxn_process_append_no_duplicate ();
     kvstxn_process_fallback_merge ();
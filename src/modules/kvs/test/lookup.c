@@ -3329,6 +3329,373 @@ void lookup_stall_ref_expire_cache_entries (void) {
     json_decref (root);
 }
 
+/* lookup through a sharded directory, stalling on shards not in cache */
+void lookup_stall_hdir (void) {
+    json_t *root;
+    json_t *dir;
+    json_t *hdir;
+    json_t *shards;
+    json_t *shard;
+    json_t *test;
+    const char *slot;
+    const char *ref;
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    lookup_t *lh;
+    char shard_ref[BLOBREF_MAX_STRING_SIZE];
+    char k0_ref[BLOBREF_MAX_STRING_SIZE];
+    char hdir_ref[BLOBREF_MAX_STRING_SIZE];
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    int count;
+
+    ltest_init (&cache, &krm);
+
+    /* This cache is
+     *
+     * shard refs (one per occupied slot)
+     * "kN" : val to "N"
+     *
+     * hdir_ref
+     * hdir of dirrefs to the shard refs, holding k0 .. k15
+     *
+     * root_ref
+     * "hd" : dirref to hdir_ref
+     */
+
+    dir = treeobj_create_dir ();
+    for (int i = 0; i < 16; i++) {
+        char name[16];
+        char val[16];
+        snprintf (name, sizeof (name), "k%d", i);
+        snprintf (val, sizeof (val), "%d", i);
+        _treeobj_insert_entry_val (dir, name, val, strlen (val));
+    }
+    hdir = treeobj_hdir_split (dir, 0);
+    shards = json_object ();
+    count = hdir ? treeobj_get_count (hdir) : 0;
+    ok (shards != NULL && count > 2,
+        "created hdir with %d shards", count);
+
+    treeobj_hash ("sha1",
+                  treeobj_hdir_peek_shard (hdir, "k0", 0),
+                  k0_ref,
+                  sizeof (k0_ref));
+    json_object_foreach (treeobj_get_data (hdir), slot, shard) {
+        treeobj_hash ("sha1", shard, shard_ref, sizeof (shard_ref));
+        json_object_set (shards, shard_ref, shard);
+        json_object_set_new (treeobj_get_data (hdir),
+                             slot,
+                             treeobj_create_dirref (shard_ref));
+    }
+    treeobj_hash ("sha1", hdir, hdir_ref, sizeof (hdir_ref));
+
+    root = treeobj_create_dir ();
+    _treeobj_insert_entry_dirref (root, "hd", hdir_ref);
+    treeobj_hash ("sha1", root, root_ref, sizeof (root_ref));
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
+
+    (void)cache_insert (cache, create_cache_entry_treeobj (root_ref, root));
+    (void)cache_insert (cache, create_cache_entry_treeobj (hdir_ref, hdir));
+
+    /* lookup hd.k0, should stall on the shard holding k0 */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "hd.k0",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create stalltest hd.k0");
+    check_stall (lh, EAGAIN, 1, k0_ref, "hd.k0 stall");
+
+    (void)cache_insert (cache,
+                        create_cache_entry_treeobj (k0_ref,
+                                                    json_object_get (shards,
+                                                                     k0_ref)));
+
+    /* lookup hd.k0, should succeed */
+    test = treeobj_create_val ("0", 1);
+    check_value (lh, test, "hd.k0");
+    json_decref (test);
+
+    /* readdir hd, should stall on all shards but the one holding k0 */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "hd",
+                             owner_cred,
+                             FLUX_KVS_READDIR,
+                             NULL)) != NULL,
+        "lookup_create stalltest hd readdir");
+    check_stall (lh, EAGAIN, count - 1, NULL, "hd readdir stall");
+
+    json_object_foreach (shards, ref, shard) {
+        if (!streq (ref, k0_ref))
+            (void)cache_insert (cache, create_cache_entry_treeobj (ref, shard));
+    }
+
+    /* readdir hd, should succeed and return the whole directory */
+    check_value (lh, dir, "hd readdir");
+
+    ltest_finalize (cache, krm);
+    json_decref (shards);
+    json_decref (hdir);
+    json_decref (dir);
+    json_decref (root);
+}
+
+/* lookup through an ivalref, stalling once on all chunks not in cache */
+void lookup_stall_ivalref (void) {
+    json_t *root;
+    json_t *chunk[3];
+    json_t *head;
+    json_t *test;
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    lookup_t *lh;
+    char blob_ref[8][BLOBREF_MAX_STRING_SIZE];
+    char chunk_ref[3][BLOBREF_MAX_STRING_SIZE];
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+    char data[2] = { 0 };
+    int i;
+
+    ltest_init (&cache, &krm);
+
+    /* This cache is
+     *
+     * blob_ref[0..7]
+     * "a" .. "h"
+     *
+     * chunk_ref[0..2] (not initially in cache)
+     * ivalref chunks holding blob_ref[0..1], [2..3], [4..5]
+     *
+     * root_ref
+     * "log" : ivalref holding blob_ref[6..7], prev chunk_ref[2],
+     *         with an index of all three chunks
+     */
+    for (i = 0; i < 8; i++) {
+        data[0] = 'a' + i;
+        blobref_hash ("sha1", data, 1, blob_ref[i], sizeof (blob_ref[i]));
+        (void)cache_insert (cache,
+                            create_cache_entry_raw (blob_ref[i], data, 1));
+    }
+    for (i = 0; i < 3; i++) {
+        chunk[i] = treeobj_create_ivalref (i > 0 ? chunk_ref[i - 1] : NULL,
+                                           i * 2);
+        treeobj_append_blobref (chunk[i], blob_ref[i * 2]);
+        treeobj_append_blobref (chunk[i], blob_ref[i * 2 + 1]);
+        treeobj_hash ("sha1", chunk[i], chunk_ref[i], sizeof (chunk_ref[i]));
+    }
+    head = treeobj_create_ivalref (chunk_ref[2], 6);
+    treeobj_append_blobref (head, blob_ref[6]);
+    treeobj_append_blobref (head, blob_ref[7]);
+    for (i = 0; i < 3; i++)
+        treeobj_append_ivalref_chunk (head, chunk_ref[i], (i + 1) * 2);
+
+    root = treeobj_create_dir ();
+    treeobj_insert_entry (root, "log", head);
+    treeobj_hash ("sha1", root, root_ref, sizeof (root_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (root_ref, root));
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
+
+    /* lookup log range [2, 3], should stall on the one chunk holding it */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "log",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL
+        && lookup_set_range (lh, 2, 3) == 0,
+        "lookup_create stalltest log range [2, 3]");
+    check_stall (lh, EAGAIN, 1, chunk_ref[1], "log range [2, 3] stall");
+    lookup_destroy (lh);
+
+    /* lookup log, should stall once on all three chunks */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "log",
+                             owner_cred,
+                             0,
+                             NULL)) != NULL,
+        "lookup_create stalltest log");
+    check_stall (lh, EAGAIN, 3, NULL, "log stall");
+
+    for (i = 0; i < 3; i++)
+        (void)cache_insert (cache,
+                            create_cache_entry_treeobj (chunk_ref[i],
+                                                        chunk[i]));
+
+    /* lookup log, should succeed */
+    test = treeobj_create_val ("abcdefgh", 8);
+    check_value (lh, test, "log");
+    json_decref (test);
+
+    ltest_finalize (cache, krm);
+    for (i = 0; i < 3; i++)
+        json_decref (chunk[i]);
+    json_decref (head);
+    json_decref (root);
+}
+
+/* FLUX_KVS_RAW lookups return the value as buffers from the cache */
+void lookup_raw (void) {
+    json_t *root;
+    json_t *valref;
+    json_t *dir;
+    struct cache *cache;
+    kvsroot_mgr_t *krm;
+    lookup_t *lh;
+    const struct iovec *iov;
+    int iovcnt;
+    char valref_ref[BLOBREF_MAX_STRING_SIZE];
+    char valref2_ref[BLOBREF_MAX_STRING_SIZE];
+    char root_ref[BLOBREF_MAX_STRING_SIZE];
+
+    ltest_init (&cache, &krm);
+
+    /* This cache is
+     *
+     * valref_ref
+     * "abcd"
+     *
+     * valref2_ref
+     * "efgh" (not initially in cache)
+     *
+     * root_ref
+     * "val" : val to "foo"
+     * "valref" : valref to [ valref_ref, valref2_ref ]
+     * "dir" : empty dir
+     */
+
+    blobref_hash ("sha1", "abcd", 4, valref_ref, sizeof (valref_ref));
+    (void)cache_insert (cache, create_cache_entry_raw (valref_ref, "abcd", 4));
+    blobref_hash ("sha1", "efgh", 4, valref2_ref, sizeof (valref2_ref));
+
+    valref = treeobj_create_valref (valref_ref);
+    treeobj_append_blobref (valref, valref2_ref);
+
+    root = treeobj_create_dir ();
+    _treeobj_insert_entry_val (root, "val", "foo", 3);
+    treeobj_insert_entry (root, "valref", valref);
+    dir = treeobj_create_dir ();
+    treeobj_insert_entry (root, "dir", dir);
+
+    treeobj_hash ("sha1", root, root_ref, sizeof (root_ref));
+    (void)cache_insert (cache, create_cache_entry_treeobj (root_ref, root));
+
+    setup_kvsroot (krm, KVS_PRIMARY_NAMESPACE, cache, root_ref, 0);
+
+    errno = 0;
+    ok (lookup_create (cache,
+                       krm,
+                       KVS_PRIMARY_NAMESPACE,
+                       NULL,
+                       0,
+                       "val",
+                       owner_cred,
+                       FLUX_KVS_RAW | FLUX_KVS_TREEOBJ,
+                       NULL) == NULL
+        && errno == EINVAL,
+        "lookup_create FLUX_KVS_RAW|FLUX_KVS_TREEOBJ fails with EINVAL");
+
+    /* raw val is decoded into one buffer */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "val",
+                             owner_cred,
+                             FLUX_KVS_RAW,
+                             NULL)) != NULL,
+        "lookup_create on val w/ FLUX_KVS_RAW");
+    errno = 0;
+    ok (lookup_get_value_iov (lh, &iov, &iovcnt) < 0 && errno == EINVAL,
+        "lookup_get_value_iov fails with EINVAL before lookup");
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED,
+        "lookup val w/ FLUX_KVS_RAW finished");
+    ok (lookup_get_value_iov (lh, &iov, &iovcnt) == 0
+        && iovcnt == 1
+        && iov[0].iov_len == 3
+        && memcmp (iov[0].iov_base, "foo", 3) == 0,
+        "lookup_get_value_iov returns decoded val");
+    lookup_destroy (lh);
+
+    /* raw valref stalls on missing blob, then points at cached blobs */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "valref",
+                             owner_cred,
+                             FLUX_KVS_RAW,
+                             NULL)) != NULL,
+        "lookup_create on valref w/ FLUX_KVS_RAW");
+    check_stall (lh, EAGAIN, 1, valref2_ref, "valref w/ FLUX_KVS_RAW stall");
+
+    (void)cache_insert (cache, create_cache_entry_raw (valref2_ref, "efgh", 4));
+
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED,
+        "lookup valref w/ FLUX_KVS_RAW finished");
+    ok (lookup_get_value_iov (lh, &iov, &iovcnt) == 0
+        && iovcnt == 2
+        && iov[0].iov_len == 4
+        && memcmp (iov[0].iov_base, "abcd", 4) == 0
+        && iov[1].iov_len == 4
+        && memcmp (iov[1].iov_base, "efgh", 4) == 0,
+        "lookup_get_value_iov returns cached blobs");
+    lookup_destroy (lh);
+
+    /* raw dir fails with EISDIR */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "dir",
+                             owner_cred,
+                             FLUX_KVS_RAW,
+                             NULL)) != NULL,
+        "lookup_create on dir w/ FLUX_KVS_RAW");
+    check_error (lh, EISDIR, "lookup dir w/ FLUX_KVS_RAW");
+
+    /* raw lookup of a missing key finishes with no value */
+    ok ((lh = lookup_create (cache,
+                             krm,
+                             KVS_PRIMARY_NAMESPACE,
+                             NULL,
+                             0,
+                             "noexist",
+                             owner_cred,
+                             FLUX_KVS_RAW,
+                             NULL)) != NULL,
+        "lookup_create on noexist w/ FLUX_KVS_RAW");
+    ok (lookup (lh) == LOOKUP_PROCESS_FINISHED,
+        "lookup noexist w/ FLUX_KVS_RAW finished");
+    errno = 0;
+    ok (lookup_get_value_iov (lh, &iov, &iovcnt) < 0 && errno == ENOENT,
+        "lookup_get_value_iov fails with ENOENT");
+    lookup_destroy (lh);
+
+    ltest_finalize (cache, krm);
+    json_decref (valref);
+    json_decref (dir);
+    json_decref (root);
+}
+
 int main (int argc, char *argv[])
 {
     plan (NO_PLAN);
@@ -3351,6 +3718,9 @@ int main (int argc, char *argv[])
     lookup_stall_ref ();
     lookup_stall_namespace_removed ();
     lookup_stall_ref_expire_cache_entries ();
+    lookup_stall_hdir ();
+    lookup_stall_ivalref ();
+    lookup_raw ();
 
     done_testing ();
     return (0);
@@ -387,6 +387,21 @@ int children_sendmsg (struct children *ctx, const flux_msg_t *msg)
     return zmqutil_msg_send_ex (ctx->bind_zsock, msg, true);
 }
 
+int children_sendframes (struct children *ctx,
+                         struct zmqutil_msg_frames *mf,
+                         const char *uuid)
+{
+    if (!ctx) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (!ctx->bind_zsock) {
+        errno = EHOSTUNREACH;
+        return -1;
+    }
+    return zmqutil_msg_frames_send (ctx->bind_zsock, mf, uuid, true);
+}
+
 flux_msg_t *children_recvmsg (struct children *ctx)
 {
     if (!ctx || !ctx->bind_zsock) {
@@ -16,6 +16,7 @@
 #include "src/common/libczmqcontainers/czmq_containers.h"
 #include "src/common/libzmqutil/cert.h"
 #include "src/common/libzmqutil/monitor.h"
+#include "src/common/libzmqutil/msg_zsock.h"
 #include "src/common/libzmqutil/zap.h"
 #include "topology.h"
 #include "ovconf.h"
@@ -146,6 +147,13 @@ int children_watch (struct children *ctx,
  */
 int children_sendmsg (struct children *ctx, const flux_msg_t *msg);
 
+/* Send pre-encoded message frames to the child with 'uuid' via bind socket.
+ * Returns 0 on success, -1 on error.
+ */
+int children_sendframes (struct children *ctx,
+                         struct zmqutil_msg_frames *mf,
+                         const char *uuid);
+
 /* Receive message from children via bind socket.
  * Returns message on success, NULL on error with errno set.
  */
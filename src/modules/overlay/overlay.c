@@ -37,7 +37,6 @@
 #include "src/common/libutil/monotime.h"
 #include "src/common/libutil/errprintf.h"
 #include "src/common/librouter/rpc_track.h"
-#include "src/common/libflux/message_route.h" // for msg_route_sendto()
 #include "ccan/str/str.h"
 #ifndef HAVE_STRLCPY
 #include "src/common/libmissing/strlcpy.h"
@@ -697,29 +696,31 @@ static void log_lost_connection (struct overlay *ov,
               add);
 }
 
+/* Since ROUTER socket has ZMQ_ROUTER_MANDATORY set, EHOSTUNREACH on a
+ * connected peer signifies a disconnect.  See zmq_setsockopt(3).
+ */
+static void overlay_child_unreachable (struct overlay *ov, const char *uuid)
+{
+    int saved_errno = errno;
+    struct child *child;
+
+    if (uuid && (child = children_lookup_online (ov->children, uuid))) {
+        log_lost_connection (ov, child, "failed");
+        overlay_child_status_update (ov,
+                                     child,
+                                     SUBTREE_STATUS_LOST,
+                                     "lost connection");
+    }
+    errno = saved_errno;
+}
+
 static int overlay_sendmsg_child (struct overlay *ov, const flux_msg_t *msg)
 {
     int rc = -1;
 
     rc = children_sendmsg (ov->children, msg);
-    /* Since ROUTER socket has ZMQ_ROUTER_MANDATORY set, EHOSTUNREACH on a
-     * connected peer signifies a disconnect.  See zmq_setsockopt(3).
-     */
-    if (rc < 0 && errno == EHOSTUNREACH) {
-        int saved_errno = errno;
-        const char *uuid;
-        struct child *child;
-
-        if ((uuid = flux_msg_route_last (msg))
-            && (child = children_lookup_online (ov->children, uuid))) {
-            log_lost_connection (ov, child, "failed");
-            overlay_child_status_update (ov,
-                                         child,
-                                         SUBTREE_STATUS_LOST,
-                                         "lost connection");
-        }
-        errno = saved_errno;
-    }
+    if (rc < 0 && errno == EHOSTUNREACH)
+        overlay_child_unreachable (ov, flux_msg_route_last (msg));
     if (rc == 0 && flux_msglist_count (ov->trace_requests) > 0) {
         const char *uuid;
         struct child *child = NULL;
@@ -739,29 +740,27 @@ static int overlay_sendmsg_child (struct overlay *ov, const flux_msg_t *msg)
     return rc;
 }
 
-// callback for msg_route_sendto()
-static int overlay_mcast_send (const flux_msg_t *msg, void *arg)
-{
-    struct overlay *ov = arg;
-    return overlay_sendmsg_child (ov, msg);
-}
-
 /* Forward an event message to downstream peers.
+ * The message is encoded once and the frames are shared by all sends.
  */
 static void overlay_mcast_child (struct overlay *ov, flux_msg_t *msg)
 {
+    struct zmqutil_msg_frames *mf;
     struct child *child;
     int count = 0;
 
     flux_msg_route_enable (msg);
 
+    if (!(mf = zmqutil_msg_frames_create (msg))) {
+        flux_log_error (ov->h, "mcast error encoding event");
+        return;
+    }
     children_foreach (ov->children, child) {
         if (child_is_online (child)) {
-            if (msg_route_sendto (msg,
-                                  child->uuid,
-                                  overlay_mcast_send,
-                                  ov) < 0) {
-                if (errno != EHOSTUNREACH) {
+            if (children_sendframes (ov->children, mf, child->uuid) < 0) {
+                if (errno == EHOSTUNREACH)
+                    overlay_child_unreachable (ov, child->uuid);
+                else {
                     flux_log_error (ov->h,
                                     "mcast error to child rank %lu",
                                     (unsigned long)child->rank);
@@ -771,6 +770,7 @@ static void overlay_mcast_child (struct overlay *ov, flux_msg_t *msg)
                 count++;
         }
     }
+    zmqutil_msg_frames_destroy (mf);
     if (count > 0) {
         trace_overlay_msg (ov->h,
                            "tx",
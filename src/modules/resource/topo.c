@@ -20,6 +20,7 @@
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
+#include <unistd.h>
 #include <jansson.h>
 #include <flux/core.h>
 
@@ -46,6 +47,7 @@ struct topo {
     struct resource_ctx *ctx;
     flux_msg_handler_t **handlers;
     char *xml;
+    char *shmem_path;
     struct rlist *r_local;
 
     struct reduction reduce;
@@ -249,6 +251,10 @@ void topo_destroy (struct topo *topo)
     if (topo) {
         int saved_errno = errno;
         flux_msg_handler_delvec (topo->handlers);
+        if (topo->shmem_path) {
+            (void)unlink (topo->shmem_path);
+            free (topo->shmem_path);
+        }
         free (topo->xml);
         rlist_destroy (topo->reduce.rl);
         rlist_destroy (topo->r_local);
@@ -303,6 +309,47 @@ out:
     return result;
 }
 
+/* Share the topology with job shells on this node in hwloc shared memory
+ * format, so they can attach to it instead of parsing the XML.  Load it
+ * as job shells would: marked as from this system, but not restricted
+ * further.  Failure is not fatal since shells fall back to XML.
+ */
+static void topo_shmem_write (struct topo *topo)
+{
+    flux_t *h = topo->ctx->h;
+    const char *rundir;
+    hwloc_topology_t t;
+
+    if (!(rundir = flux_attr_get (h, "rundir"))
+        || asprintf (&topo->shmem_path,
+                     "%s/%s",
+                     rundir,
+                     RHWLOC_SHMEM_FILE) < 0) {
+        topo->shmem_path = NULL;
+        return;
+    }
+    if (!(t = rhwloc_xml_topology_load (topo->xml,
+                                        RHWLOC_NO_RESTRICT
+                                        | RHWLOC_THISSYSTEM))) {
+        flux_log (h, LOG_DEBUG, "error loading topology for shmem");
+        goto error;
+    }
+    if (rhwloc_topology_shmem_write (t, topo->shmem_path) < 0) {
+        flux_log (h,
+                  LOG_DEBUG,
+                  "error writing %s: %s",
+                  topo->shmem_path,
+                  strerror (errno));
+        hwloc_topology_destroy (t);
+        goto error;
+    }
+    hwloc_topology_destroy (t);
+    return;
+error:
+    free (topo->shmem_path);
+    topo->shmem_path = NULL;
+}
+
 struct topo *topo_create (struct resource_ctx *ctx,
                           struct resource_config *config)
 {
@@ -320,6 +367,7 @@ struct topo *topo_create (struct resource_ctx *ctx,
         flux_log_error (ctx->h, "error creating local resource object");
         goto error;
     }
+    topo_shmem_write (topo);
     /* If global resource object is known now, use it to verify topo.
      */
     if ((R = inventory_get (ctx->inventory))) {
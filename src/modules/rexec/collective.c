@@ -0,0 +1,1138 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* collective.c - start a command on many ranks over the TBON
+ *
+ * <service>.bulk-exec starts the same command on a set of ranks with one
+ * streaming request:
+ *
+ *   {"ranks":s "cmd":o "flags":i "local_flags"?:i}
+ *
+ * Each broker starts the command locally with a <service>.exec request to
+ * itself if its rank is a target, and forwards the request to each child
+ * whose subtree contains targets.  RFC 42 exec responses from the local
+ * subprocess and from the forwarded streams are collected for a short time
+ * and sent upstream together:
+ *
+ *   {"updates":[{"rank":i "response":o} or {"rank":i "errnum":i "errstr"?:s}]}
+ *
+ * An update with "errnum" ends the exec stream for that rank (ENODATA is
+ * normal termination).  The bulk-exec stream ends with ENODATA once all
+ * target ranks have ended.  If a forwarded stream fails, for example with
+ * EHOSTUNREACH because the subtree was lost, the error is reported for each
+ * rank of that subtree that has not ended yet.
+ *
+ * <service>.bulk-kill signals processes started by bulk-exec:
+ *
+ *   {"signum":i "pids":{"rank":pid, ...}}
+ *
+ * It is forwarded down the tree in the same way and responds with the
+ * per-rank kill errors, if any:
+ *
+ *   {"errors":[{"rank":i "errnum":i "errstr"?:s}, ...]}
+ *
+ * Targets outside this broker's subtree are forwarded to rank 0.
+ *
+ * If the client disconnects, its local processes are killed and
+ * <service>.bulk-cancel {"matchtag":i} is sent to the brokers its request
+ * was forwarded to, so they do the same.
+ */
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <signal.h>
+#include <stdlib.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/idset.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+#include "src/common/libsubprocess/client.h"
+#include "src/common/libutil/errno_safe.h"
+#include "ccan/str/str.h"
+
+#include "collective.h"
+
+static const double batch_timeout = 0.01;
+
+struct child {
+    uint32_t rank;
+    struct idset *subtree;
+};
+
+struct collective {
+    flux_t *h;
+    char *service;
+    uint32_t rank;
+    subprocess_server_auth_f auth_cb;
+    void *auth_arg;
+    flux_msg_handler_t **handlers;
+    flux_future_t *f_topo;          // overlay.topology request
+    bool topo_ready;
+    struct idset *subtree;          // ranks in this broker's subtree
+    zlistx_t *children;             // struct child, one per direct child
+    struct flux_msglist *deferred;  // requests received before topology
+    zlistx_t *execs;                // struct exec_op in progress
+    zlistx_t *kills;                // struct kill_op in progress
+};
+
+/* One bulk-exec request.  Each stream is either the local exec request
+ * or a bulk-exec request forwarded to another broker.
+ */
+struct exec_op {
+    struct collective *c;
+    const flux_msg_t *msg;
+    zlistx_t *streams;
+    json_t *updates;                // updates not yet sent upstream
+    flux_watcher_t *timer;
+    pid_t pid;                      // local process, once started
+    bool canceled;
+    void *handle;                   // position in c->execs
+};
+
+struct stream {
+    struct exec_op *op;
+    flux_future_t *f;
+    uint32_t nodeid;
+    struct idset *ranks;            // ranks whose exec has not ended
+    bool local;
+};
+
+/* One bulk-kill request.
+ */
+struct kill_op {
+    struct collective *c;
+    const flux_msg_t *msg;
+    json_t *errors;
+    zlistx_t *futures;
+    void *handle;                   // position in c->kills
+};
+
+static void exec_op_start (struct collective *c, const flux_msg_t *msg);
+static void kill_op_start (struct collective *c, const flux_msg_t *msg);
+static void exec_op_cancel (struct exec_op *op);
+
+static bool is_method (struct collective *c,
+                       const flux_msg_t *msg,
+                       const char *method)
+{
+    const char *topic;
+    size_t len = strlen (c->service);
+
+    return (flux_msg_get_topic (msg, &topic) == 0
+            && strncmp (topic, c->service, len) == 0
+            && topic[len] == '.'
+            && streq (topic + len + 1, method));
+}
+
+static bool is_sender (const flux_msg_t *msg, const char *sender)
+{
+    const char *s = flux_msg_route_first (msg);
+    return s && sender && streq (s, sender);
+}
+
+static flux_future_t *rpc_method (struct collective *c,
+                                  const char *method,
+                                  uint32_t nodeid,
+                                  int flags,
+                                  json_t *payload)
+{
+    char topic[128];
+
+    if (snprintf (topic,
+                  sizeof (topic),
+                  "%s.%s",
+                  c->service,
+                  method) >= sizeof (topic)) {
+        errno = EOVERFLOW;
+        return NULL;
+    }
+    return flux_rpc_pack (c->h, topic, nodeid, flags, "O", payload);
+}
+
+/* Kill the local process of 'op', if it has started.  The request is sent
+ * to this broker's subprocess server, which started it.
+ */
+static void exec_op_kill_local (struct exec_op *op, int signum)
+{
+    flux_future_t *f;
+    json_t *o;
+
+    if (op->pid <= 0)
+        return;
+    if (!(o = json_pack ("{s:i s:i}", "pid", (int)op->pid, "signum", signum))
+        || !(f = rpc_method (op->c,
+                             "kill",
+                             FLUX_NODEID_ANY,
+                             FLUX_RPC_NORESPONSE,
+                             o))) {
+        flux_log_error (op->c->h, "bulk-exec: error killing pid %d",
+                        (int)op->pid);
+        json_decref (o);
+        return;
+    }
+    flux_future_destroy (f);
+    json_decref (o);
+}
+
+static void stream_destroy (void *arg)
+{
+    struct stream *st = arg;
+    if (st) {
+        int saved_errno = errno;
+        flux_future_destroy (st->f);
+        idset_destroy (st->ranks);
+        free (st);
+        errno = saved_errno;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void stream_destructor (void **item)
+{
+    if (item) {
+        stream_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void exec_op_destroy (struct exec_op *op)
+{
+    if (op) {
+        int saved_errno = errno;
+        zlistx_destroy (&op->streams);
+        json_decref (op->updates);
+        flux_watcher_destroy (op->timer);
+        flux_msg_decref (op->msg);
+        free (op);
+        errno = saved_errno;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void exec_op_destructor (void **item)
+{
+    if (item) {
+        exec_op_destroy (*item);
+        *item = NULL;
+    }
+}
+
+/* Send updates collected so far upstream.
+ */
+static void exec_op_flush (struct exec_op *op)
+{
+    flux_watcher_stop (op->timer);
+    if (json_array_size (op->updates) == 0)
+        return;
+    if (flux_respond_pack (op->c->h,
+                           op->msg,
+                           "{s:O}",
+                           "updates", op->updates) < 0)
+        flux_log_error (op->c->h, "error responding to bulk-exec request");
+    json_array_clear (op->updates);
+}
+
+static void timer_cb (flux_reactor_t *r,
+                      flux_watcher_t *w,
+                      int revents,
+                      void *arg)
+{
+    struct exec_op *op = arg;
+    exec_op_flush (op);
+}
+
+static void exec_op_append (struct exec_op *op, json_t *update)
+{
+    if (!update || json_array_append_new (op->updates, update) < 0) {
+        flux_log (op->c->h, LOG_ERR, "bulk-exec: out of memory");
+        return;
+    }
+    if (!flux_watcher_is_active (op->timer)) {
+        flux_timer_watcher_reset (op->timer, batch_timeout, 0.);
+        flux_watcher_start (op->timer);
+    }
+}
+
+/* End the exec stream for 'rank' with an error (ENODATA for success).
+ */
+static void exec_op_end_rank (struct exec_op *op,
+                              uint32_t rank,
+                              int errnum,
+                              const char *errstr)
+{
+    json_t *o;
+
+    if (errstr)
+        o = json_pack ("{s:i s:i s:s}",
+                       "rank", rank,
+                       "errnum", errnum,
+                       "errstr", errstr);
+    else
+        o = json_pack ("{s:i s:i}", "rank", rank, "errnum", errnum);
+    exec_op_append (op, o);
+}
+
+static void exec_op_end_ranks (struct exec_op *op,
+                               const struct idset *ranks,
+                               int errnum,
+                               const char *errstr)
+{
+    unsigned int rank = idset_first (ranks);
+    while (rank != IDSET_INVALID_ID) {
+        exec_op_end_rank (op, rank, errnum, errstr);
+        rank = idset_next (ranks, rank);
+    }
+}
+
+/* Finish the request once all of its streams have ended.
+ */
+static void exec_op_check_done (struct exec_op *op)
+{
+    struct collective *c = op->c;
+
+    if (zlistx_size (op->streams) > 0)
+        return;
+    exec_op_flush (op);
+    if (flux_respond_error (c->h, op->msg, ENODATA, NULL) < 0)
+        flux_log_error (c->h, "error responding to bulk-exec request");
+    zlistx_delete (c->execs, op->handle);
+}
+
+static void stream_end (struct stream *st)
+{
+    struct exec_op *op = st->op;
+    void *handle;
+
+    if ((handle = zlistx_find (op->streams, st)))
+        zlistx_delete (op->streams, handle);
+}
+
+static void local_response (struct stream *st)
+{
+    struct exec_op *op = st->op;
+    struct collective *c = op->c;
+    const char *s;
+    json_t *o;
+    const char *type;
+    int pid;
+
+    if (flux_rpc_get (st->f, &s) < 0) {
+        exec_op_end_rank (op,
+                          c->rank,
+                          errno,
+                          errno == ENODATA ? NULL
+                                           : flux_future_error_string (st->f));
+        stream_end (st);
+        return;
+    }
+    if (!s || !(o = json_loads (s, 0, NULL))) {
+        exec_op_kill_local (op, SIGKILL);
+        exec_op_end_rank (op, c->rank, EPROTO, "malformed exec response");
+        stream_end (st);
+        return;
+    }
+    if (json_unpack (o, "{s:s s?i}", "type", &type, "pid", &pid) == 0
+        && streq (type, "started")) {
+        op->pid = pid;
+        if (op->canceled)
+            exec_op_kill_local (op, SIGKILL);
+    }
+    exec_op_append (op, json_pack ("{s:i s:o}",
+                                   "rank", c->rank,
+                                   "response", o));
+    flux_future_reset (st->f);
+}
+
+static void forward_response (struct stream *st)
+{
+    struct exec_op *op = st->op;
+    json_t *updates;
+    json_t *entry;
+    size_t index;
+
+    if (flux_rpc_get_unpack (st->f, "{s:o}", "updates", &updates) < 0) {
+        if (errno == ENODATA)
+            exec_op_end_ranks (op,
+                               st->ranks,
+                               EPROTO,
+                               "bulk-exec stream ended early");
+        else
+            exec_op_end_ranks (op,
+                               st->ranks,
+                               errno,
+                               flux_future_error_string (st->f));
+        stream_end (st);
+        return;
+    }
+    json_array_foreach (updates, index, entry) {
+        int rank;
+
+        if (json_unpack (entry, "{s:i}", "rank", &rank) < 0
+            || !idset_test (st->ranks, rank)) {
+            flux_log (op->c->h,
+                      LOG_ERR,
+                      "bulk-exec: ignoring bad update from rank %u",
+                      (unsigned int)st->nodeid);
+            continue;
+        }
+        if (json_object_get (entry, "errnum"))
+            (void)idset_clear (st->ranks, rank);
+        exec_op_append (op, json_incref (entry));
+    }
+    flux_future_reset (st->f);
+}
+
+static void stream_continuation (flux_future_t *f, void *arg)
+{
+    struct stream *st = arg;
+    struct exec_op *op = st->op;
+
+    if (st->local)
+        local_response (st);
+    else
+        forward_response (st);
+    exec_op_check_done (op);
+}
+
+static int exec_op_add_stream (struct exec_op *op,
+                               flux_future_t *f,
+                               uint32_t nodeid,
+                               const struct idset *ranks,
+                               bool local)
+{
+    struct stream *st;
+
+    if (!(st = calloc (1, sizeof (*st))))
+        return -1;
+    st->op = op;
+    st->nodeid = nodeid;
+    st->local = local;
+    if (!(st->ranks = idset_copy (ranks))
+        || !zlistx_add_end (op->streams, st)) {
+        stream_destroy (st);
+        errno = ENOMEM;
+        return -1;
+    }
+    st->f = f;
+    if (flux_future_then (f, -1., stream_continuation, st) < 0) {
+        st->f = NULL;
+        stream_end (st);
+        return -1;
+    }
+    return 0;
+}
+
+/* Start the command on this broker.
+ */
+static void exec_op_local (struct exec_op *op,
+                           json_t *payload,
+                           const struct idset *ranks)
+{
+    struct collective *c = op->c;
+    flux_error_t error;
+    flux_future_t *f = NULL;
+    json_t *o;
+
+    if (c->auth_cb && (*c->auth_cb) (op->msg, c->auth_arg, &error) < 0) {
+        exec_op_end_rank (op, c->rank, EPERM, error.text);
+        return;
+    }
+    if (!(o = json_deep_copy (payload))
+        || json_object_del (o, "ranks") < 0
+        || !(f = rpc_method (c,
+                             "exec",
+                             FLUX_NODEID_ANY,
+                             FLUX_RPC_STREAMING,
+                             o))
+        || exec_op_add_stream (op, f, c->rank, ranks, true) < 0) {
+        exec_op_end_rank (op, c->rank, errno ? errno : ENOMEM, NULL);
+        flux_future_destroy (f);
+    }
+    json_decref (o);
+}
+
+/* Forward the request for 'ranks' to broker 'nodeid'.
+ */
+static void exec_op_forward (struct exec_op *op,
+                             json_t *payload,
+                             uint32_t nodeid,
+                             const struct idset *ranks)
+{
+    flux_future_t *f = NULL;
+    char *s = NULL;
+    json_t *o;
+
+    if (!(s = idset_encode (ranks, IDSET_FLAG_RANGE))
+        || !(o = json_copy (payload))
+        || json_object_set_new (o, "ranks", json_string (s)) < 0
+        || json_object_set_new (o, "tree", json_true ()) < 0
+        || !(f = rpc_method (op->c,
+                             "bulk-exec",
+                             nodeid,
+                             FLUX_RPC_STREAMING,
+                             o))
+        || exec_op_add_stream (op, f, nodeid, ranks, false) < 0) {
+        exec_op_end_ranks (op, ranks, errno ? errno : ENOMEM, NULL);
+        flux_future_destroy (f);
+    }
+    json_decref (o);
+    free (s);
+}
+
+static struct exec_op *exec_op_create (struct collective *c,
+                                       const flux_msg_t *msg)
+{
+    struct exec_op *op;
+
+    if (!(op = calloc (1, sizeof (*op))))
+        return NULL;
+    op->c = c;
+    op->msg = flux_msg_incref (msg);
+    if (!(op->streams = zlistx_new ())
+        || !(op->updates = json_array ())
+        || !(op->timer = flux_timer_watcher_create (flux_get_reactor (c->h),
+                                                    batch_timeout,
+                                                    0.,
+                                                    timer_cb,
+                                                    op))
+        || !(op->handle = zlistx_add_end (c->execs, op))) {
+        exec_op_destroy (op);
+        errno = ENOMEM;
+        return NULL;
+    }
+    zlistx_set_destructor (op->streams, stream_destructor);
+    return op;
+}
+
+static void exec_op_start (struct collective *c, const flux_msg_t *msg)
+{
+    const char *errmsg = NULL;
+    json_t *payload;
+    const char *ranks_str;
+    json_t *cmd;
+    int flags;
+    int tree = 0;
+    struct idset *ranks = NULL;
+    struct idset *rest = NULL;
+    struct exec_op *op;
+    struct child *child;
+    int valid_flags = SUBPROCESS_REXEC_STDOUT
+        | SUBPROCESS_REXEC_STDERR
+        | SUBPROCESS_REXEC_CHANNEL;
+
+    if (flux_request_unpack (msg, NULL, "o", &payload) < 0
+        || json_unpack (payload,
+                        "{s:s s:o s:i s?b}",
+                        "ranks", &ranks_str,
+                        "cmd", &cmd,
+                        "flags", &flags,
+                        "tree", &tree) < 0) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (!flux_msg_is_streaming (msg)) {
+        errno = EPROTO;
+        errmsg = "bulk-exec requires a streaming request";
+        goto error;
+    }
+    if ((flags & ~valid_flags)) {
+        errno = EINVAL;
+        errmsg = "bulk-exec does not support the requested flags";
+        goto error;
+    }
+    if (!(ranks = idset_decode (ranks_str)) || idset_empty (ranks)) {
+        errno = EINVAL;
+        errmsg = "invalid ranks";
+        goto error;
+    }
+    if (!(rest = idset_difference (ranks, c->subtree))
+        || !(op = exec_op_create (c, msg)))
+        goto error;
+
+    if (idset_test (ranks, c->rank)) {
+        struct idset *self;
+        if (!(self = idset_create (0, IDSET_FLAG_AUTOGROW))
+            || idset_set (self, c->rank) < 0)
+            exec_op_end_rank (op, c->rank, ENOMEM, NULL);
+        else
+            exec_op_local (op, payload, self);
+        idset_destroy (self);
+    }
+    child = zlistx_first (c->children);
+    while (child) {
+        struct idset *sub;
+        if ((sub = idset_intersect (ranks, child->subtree))
+            && !idset_empty (sub))
+            exec_op_forward (op, payload, child->rank, sub);
+        idset_destroy (sub);
+        child = zlistx_next (c->children);
+    }
+    if (!idset_empty (rest)) {
+        if (tree || c->rank == 0)
+            exec_op_end_ranks (op, rest, EHOSTUNREACH, NULL);
+        else
+            exec_op_forward (op, payload, 0, rest);
+    }
+    idset_destroy (ranks);
+    idset_destroy (rest);
+    exec_op_check_done (op);
+    return;
+error:
+    if (flux_respond_error (c->h, msg, errno, errmsg) < 0)
+        flux_log_error (c->h, "error responding to bulk-exec request");
+    idset_destroy (ranks);
+    idset_destroy (rest);
+}
+
+static void exec_op_cancel (struct exec_op *op)
+{
+    struct stream *st;
+
+    if (op->canceled)
+        return;
+    op->canceled = true;
+    exec_op_kill_local (op, SIGKILL);
+    st = zlistx_first (op->streams);
+    while (st) {
+        if (!st->local) {
+            flux_future_t *f;
+            json_t *o;
+
+            if (!(o = json_pack ("{s:i}",
+                                 "matchtag", flux_rpc_get_matchtag (st->f)))
+                || !(f = rpc_method (op->c,
+                                     "bulk-cancel",
+                                     st->nodeid,
+                                     FLUX_RPC_NORESPONSE,
+                                     o)))
+                flux_log_error (op->c->h,
+                                "bulk-exec: error canceling on rank %u",
+                                (unsigned int)st->nodeid);
+            else
+                flux_future_destroy (f);
+            json_decref (o);
+        }
+        st = zlistx_next (op->streams);
+    }
+}
+
+static void bulk_cancel (struct collective *c, const flux_msg_t *msg)
+{
+    int matchtag;
+    struct exec_op *op;
+
+    if (flux_request_unpack (msg, NULL, "{s:i}", "matchtag", &matchtag) < 0) {
+        flux_log_error (c->h, "error decoding bulk-cancel request");
+        return;
+    }
+    op = zlistx_first (c->execs);
+    while (op) {
+        uint32_t tag;
+        if (flux_msg_get_matchtag (op->msg, &tag) == 0
+            && tag == matchtag
+            && is_sender (op->msg, flux_msg_route_first (msg))) {
+            exec_op_cancel (op);
+            break;
+        }
+        op = zlistx_next (c->execs);
+    }
+}
+
+void collective_disconnect (struct collective *c, const flux_msg_t *msg)
+{
+    const char *sender;
+    struct exec_op *op;
+
+    if (!c || !(sender = flux_msg_route_first (msg)))
+        return;
+    (void)flux_msglist_disconnect (c->deferred, msg);
+    op = zlistx_first (c->execs);
+    while (op) {
+        if (is_sender (op->msg, sender))
+            exec_op_cancel (op);
+        op = zlistx_next (c->execs);
+    }
+}
+
+static void kill_op_destroy (struct kill_op *op)
+{
+    if (op) {
+        int saved_errno = errno;
+        zlistx_destroy (&op->futures);
+        json_decref (op->errors);
+        flux_msg_decref (op->msg);
+        free (op);
+        errno = saved_errno;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void kill_op_destructor (void **item)
+{
+    if (item) {
+        kill_op_destroy (*item);
+        *item = NULL;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void future_destructor (void **item)
+{
+    if (item) {
+        flux_future_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static void kill_op_error (struct kill_op *op,
+                           uint32_t rank,
+                           int errnum,
+                           const char *errstr)
+{
+    json_t *o;
+
+    if (errstr)
+        o = json_pack ("{s:i s:i s:s}",
+                       "rank", rank,
+                       "errnum", errnum,
+                       "errstr", errstr);
+    else
+        o = json_pack ("{s:i s:i}", "rank", rank, "errnum", errnum);
+    if (!o || json_array_append_new (op->errors, o) < 0)
+        flux_log (op->c->h, LOG_ERR, "bulk-kill: out of memory");
+}
+
+static void kill_op_pids_error (struct kill_op *op,
+                                json_t *pids,
+                                int errnum,
+                                const char *errstr)
+{
+    const char *key;
+    json_t *value;
+
+    json_object_foreach (pids, key, value)
+        kill_op_error (op, strtoul (key, NULL, 10), errnum, errstr);
+}
+
+static void kill_op_check_done (struct kill_op *op)
+{
+    struct collective *c = op->c;
+
+    if (zlistx_size (op->futures) > 0)
+        return;
+    if (flux_respond_pack (c->h, op->msg, "{s:O}", "errors", op->errors) < 0)
+        flux_log_error (c->h, "error responding to bulk-kill request");
+    zlistx_delete (c->kills, op->handle);
+}
+
+static void kill_continuation (flux_future_t *f, void *arg)
+{
+    struct kill_op *op = arg;
+    json_t *pids = flux_future_aux_get (f, "rexec::pids");
+    json_t *errors;
+    void *handle;
+
+    if (!pids) {
+        if (flux_rpc_get (f, NULL) < 0)
+            kill_op_error (op,
+                           op->c->rank,
+                           errno,
+                           flux_future_error_string (f));
+    }
+    else if (flux_rpc_get_unpack (f, "{s:o}", "errors", &errors) < 0)
+        kill_op_pids_error (op, pids, errno, flux_future_error_string (f));
+    else if (json_array_extend (op->errors, errors) < 0)
+        flux_log (op->c->h, LOG_ERR, "bulk-kill: out of memory");
+    if ((handle = zlistx_find (op->futures, f)))
+        zlistx_delete (op->futures, handle);
+    kill_op_check_done (op);
+}
+
+static int kill_op_add_future (struct kill_op *op,
+                               flux_future_t *f,
+                               json_t *pids)
+{
+    if ((pids && flux_future_aux_set (f,
+                                      "rexec::pids",
+                                      json_incref (pids),
+                                      (flux_free_f)json_decref) < 0)
+        || flux_future_then (f, -1., kill_continuation, op) < 0)
+        return -1;
+    if (!zlistx_add_end (op->futures, f)) {
+        errno = ENOMEM;
+        return -1;
+    }
+    return 0;
+}
+
+static void kill_op_local (struct kill_op *op, int signum, json_t *pid)
+{
+    struct collective *c = op->c;
+    flux_error_t error;
+    flux_future_t *f = NULL;
+    json_t *o;
+
+    if (c->auth_cb && (*c->auth_cb) (op->msg, c->auth_arg, &error) < 0) {
+        kill_op_error (op, c->rank, EPERM, error.text);
+        return;
+    }
+    if (!(o = json_pack ("{s:O s:i}", "pid", pid, "signum", signum))
+        || !(f = rpc_method (c, "kill", FLUX_NODEID_ANY, 0, o))
+        || kill_op_add_future (op, f, NULL) < 0) {
+        kill_op_error (op, c->rank, errno ? errno : ENOMEM, NULL);
+        flux_future_destroy (f);
+    }
+    json_decref (o);
+}
+
+static void kill_op_forward (struct kill_op *op,
+                             int signum,
+                             uint32_t nodeid,
+                             json_t *pids)
+{
+    flux_future_t *f = NULL;
+    json_t *o;
+
+    if (!(o = json_pack ("{s:i s:O s:b}",
+                         "signum", signum,
+                         "pids", pids,
+                         "tree", 1))
+        || !(f = rpc_method (op->c, "bulk-kill", nodeid, 0, o))
+        || kill_op_add_future (op, f, pids) < 0) {
+        kill_op_pids_error (op, pids, errno ? errno : ENOMEM, NULL);
+        flux_future_destroy (f);
+    }
+    json_decref (o);
+}
+
+static void kill_op_start (struct collective *c, const flux_msg_t *msg)
+{
+    int signum;
+    json_t *pids;
+    int tree = 0;
+    struct kill_op *op = NULL;
+    json_t **fwd = NULL;            // pids per child, then the rest
+    int nchildren = zlistx_size (c->children);
+    json_t *local = NULL;
+    const char *key;
+    json_t *value;
+    struct child *child;
+    int i;
+
+    if (flux_request_unpack (msg,
+                             NULL,
+                             "{s:i s:o s?b}",
+                             "signum", &signum,
+                             "pids", &pids,
+                             "tree", &tree) < 0
+        || !json_is_object (pids)) {
+        errno = EPROTO;
+        goto error;
+    }
+    if (!(op = calloc (1, sizeof (*op)))
+        || !(fwd = calloc (nchildren + 1, sizeof (fwd[0]))))
+        goto error;
+    op->c = c;
+    op->msg = flux_msg_incref (msg);
+    if (!(op->errors = json_array ())
+        || !(op->futures = zlistx_new ()))
+        goto nomem;
+    zlistx_set_destructor (op->futures, future_destructor);
+
+    json_object_foreach (pids, key, value) {
+        char *endptr;
+        unsigned long rank;
+
+        errno = 0;
+        rank = strtoul (key, &endptr, 10);
+        if (errno != 0 || *endptr != '\0' || !json_is_integer (value)) {
+            errno = EPROTO;
+            goto error;
+        }
+        if (rank == c->rank) {
+            local = value;
+            continue;
+        }
+        i = 0;
+        child = zlistx_first (c->children);
+        while (child && !idset_test (child->subtree, rank)) {
+            child = zlistx_next (c->children);
+            i++;
+        }
+        if (!fwd[i] && !(fwd[i] = json_object ()))
+            goto nomem;
+        if (json_object_set (fwd[i], key, value) < 0)
+            goto nomem;
+    }
+    if (!(op->handle = zlistx_add_end (c->kills, op)))
+        goto nomem;
+
+    if (local)
+        kill_op_local (op, signum, local);
+    i = 0;
+    child = zlistx_first (c->children);
+    while (child) {
+        if (fwd[i])
+            kill_op_forward (op, signum, child->rank, fwd[i]);
+        child = zlistx_next (c->children);
+        i++;
+    }
+    if (fwd[nchildren]) {
+        if (tree || c->rank == 0)
+            kill_op_pids_error (op, fwd[nchildren], EHOSTUNREACH, NULL);
+        else
+            kill_op_forward (op, signum, 0, fwd[nchildren]);
+    }
+    for (i = 0; i < nchildren + 1; i++)
+        json_decref (fwd[i]);
+    free (fwd);
+    kill_op_check_done (op);
+    return;
+nomem:
+    errno = ENOMEM;
+error:
+    if (flux_respond_error (c->h, msg, errno, NULL) < 0)
+        flux_log_error (c->h, "error responding to bulk-kill request");
+    if (fwd) {
+        for (i = 0; i < nchildren + 1; i++)
+            json_decref (fwd[i]);
+        free (fwd);
+    }
+    if (op) {
+        if (op->handle)
+            zlistx_delete (c->kills, op->handle);
+        else
+            kill_op_destroy (op);
+    }
+}
+
+static void dispatch_request (struct collective *c, const flux_msg_t *msg)
+{
+    if (is_method (c, msg, "bulk-exec"))
+        exec_op_start (c, msg);
+    else if (is_method (c, msg, "bulk-kill"))
+        kill_op_start (c, msg);
+    else if (is_method (c, msg, "bulk-cancel"))
+        bulk_cancel (c, msg);
+}
+
+/* Recursive function to walk 'topology', adding all subtree ranks to 'ids'.
+ */
+static int add_subtree_ids (struct idset *ids, json_t *topology)
+{
+    int rank;
+    json_t *a;
+    size_t index;
+    json_t *entry;
+
+    if (json_unpack (topology, "{s:i s:o}", "rank", &rank, "children", &a) < 0
+        || idset_set (ids, rank) < 0)
+        return -1;
+    json_array_foreach (a, index, entry) {
+        if (add_subtree_ids (ids, entry) < 0)
+            return -1;
+    }
+    return 0;
+}
+
+static void child_destroy (struct child *child)
+{
+    if (child) {
+        int saved_errno = errno;
+        idset_destroy (child->subtree);
+        free (child);
+        errno = saved_errno;
+    }
+}
+
+// zlistx_destructor_fn footprint
+static void child_destructor (void **item)
+{
+    if (item) {
+        child_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static int add_child (struct collective *c, json_t *topology)
+{
+    struct child *child;
+    int rank;
+
+    if (!(child = calloc (1, sizeof (*child))))
+        return -1;
+    if (json_unpack (topology, "{s:i}", "rank", &rank) < 0
+        || !(child->subtree = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || add_subtree_ids (child->subtree, topology) < 0
+        || idset_add (c->subtree, child->subtree) < 0
+        || !zlistx_add_end (c->children, child)) {
+        child_destroy (child);
+        errno = EPROTO;
+        return -1;
+    }
+    child->rank = rank;
+    return 0;
+}
+
+static void topology_continuation (flux_future_t *f, void *arg)
+{
+    struct collective *c = arg;
+    json_t *children;
+    json_t *entry;
+    size_t index;
+    const flux_msg_t *msg;
+
+    if (flux_rpc_get_unpack (f, "{s:o}", "children", &children) < 0) {
+        flux_log (c->h,
+                  LOG_ERR,
+                  "overlay.topology: %s",
+                  future_strerror (f, errno));
+    }
+    else {
+        json_array_foreach (children, index, entry) {
+            if (add_child (c, entry) < 0) {
+                flux_log_error (c->h, "error parsing overlay.topology");
+                break;
+            }
+        }
+    }
+    c->topo_ready = true;
+    while ((msg = flux_msglist_pop (c->deferred))) {
+        dispatch_request (c, msg);
+        flux_msg_decref (msg);
+    }
+}
+
+/* Requests are deferred until this broker's subtree is known.  The
+ * topology is fetched on first use so that this module does not depend on
+ * the overlay module load order.
+ */
+static void request_cb (flux_t *h,
+                        flux_msg_handler_t *mh,
+                        const flux_msg_t *msg,
+                        void *arg)
+{
+    struct collective *c = arg;
+
+    if (c->topo_ready) {
+        dispatch_request (c, msg);
+        return;
+    }
+    if (flux_msglist_append (c->deferred, msg) < 0)
+        goto error;
+    if (!c->f_topo) {
+        if (!(c->f_topo = flux_rpc_pack (h,
+                                         "overlay.topology",
+                                         FLUX_NODEID_ANY,
+                                         0,
+                                         "{s:i}",
+                                         "rank", c->rank))
+            || flux_future_then (c->f_topo,
+                                 -1.,
+                                 topology_continuation,
+                                 c) < 0) {
+            flux_future_destroy (c->f_topo);
+            c->f_topo = NULL;
+            goto error;
+        }
+    }
+    return;
+error:
+    flux_log_error (h, "error deferring %s request", c->service);
+    if (!is_method (c, msg, "bulk-cancel")
+        && flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to %s request", c->service);
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST, "bulk-exec", request_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "bulk-kill", request_cb, 0 },
+    { FLUX_MSGTYPE_REQUEST, "bulk-cancel", request_cb, 0 },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
+void collective_destroy (struct collective *c)
+{
+    if (c) {
+        int saved_errno = errno;
+        const flux_msg_t *msg;
+        struct exec_op *op;
+
+        flux_msg_handler_delvec (c->handlers);
+        if (c->execs) {
+            op = zlistx_first (c->execs);
+            while (op) {
+                if (flux_respond_error (c->h,
+                                        op->msg,
+                                        ECANCELED,
+                                        "rexec module is unloading") < 0)
+                    flux_log_error (c->h, "error responding to bulk-exec");
+                op = zlistx_next (c->execs);
+            }
+            zlistx_destroy (&c->execs);
+        }
+        zlistx_destroy (&c->kills);
+        if (c->deferred) {
+            while ((msg = flux_msglist_pop (c->deferred))) {
+                if (!is_method (c, msg, "bulk-cancel")
+                    && flux_respond_error (c->h,
+                                           msg,
+                                           ECANCELED,
+                                           "rexec module is unloading") < 0)
+                    flux_log_error (c->h, "error responding to request");
+                flux_msg_decref (msg);
+            }
+            flux_msglist_destroy (c->deferred);
+        }
+        flux_future_destroy (c->f_topo);
+        zlistx_destroy (&c->children);
+        idset_destroy (c->subtree);
+        free (c->service);
+        free (c);
+        errno = saved_errno;
+    }
+}
+
+struct collective *collective_create (flux_t *h,
+                                      const char *service,
+                                      subprocess_server_auth_f auth_cb,
+                                      void *arg)
+{
+    struct collective *c;
+
+    if (!(c = calloc (1, sizeof (*c))))
+        return NULL;
+    c->h = h;
+    c->auth_cb = auth_cb;
+    c->auth_arg = arg;
+    if (flux_get_rank (h, &c->rank) < 0)
+        goto error;
+    if (!(c->service = strdup (service))
+        || !(c->subtree = idset_create (0, IDSET_FLAG_AUTOGROW))
+        || idset_set (c->subtree, c->rank) < 0
+        || !(c->children = zlistx_new ())
+        || !(c->execs = zlistx_new ())
+        || !(c->kills = zlistx_new ())
+        || !(c->deferred = flux_msglist_create ()))
+        goto error;
+    zlistx_set_destructor (c->children, child_destructor);
+    zlistx_set_destructor (c->execs, exec_op_destructor);
+    zlistx_set_destructor (c->kills, kill_op_destructor);
+    if (flux_msg_handler_addvec_ex (h, service, htab, c, &c->handlers) < 0)
+        goto error;
+    return c;
+error:
+    collective_destroy (c);
+    return NULL;
+}
+
+// vi:ts=4 sw=4 expandtab
@@ -0,0 +1,37 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef _REXEC_COLLECTIVE_H
+#define _REXEC_COLLECTIVE_H
+
+#include <flux/core.h>
+
+#include "src/common/libsubprocess/server.h"
+
+struct collective;
+
+/* Register the <service>.bulk-exec, bulk-kill, and bulk-cancel methods.
+ * Processes are started with <service>.exec requests to this broker,
+ * so 'service' must be served by a subprocess server in this module.
+ * If non-NULL, 'auth_cb' is applied to requests that target this rank.
+ */
+struct collective *collective_create (flux_t *h,
+                                      const char *service,
+                                      subprocess_server_auth_f auth_cb,
+                                      void *arg);
+void collective_destroy (struct collective *c);
+
+/* Cancel bulk-exec requests from the client that sent disconnect 'msg'.
+ */
+void collective_disconnect (struct collective *c, const flux_msg_t *msg);
+
+#endif /* !_REXEC_COLLECTIVE_H */
+
+// vi:ts=4 sw=4 expandtab
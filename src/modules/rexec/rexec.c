@@ -27,9 +27,12 @@
 #include "src/common/libsubprocess/server.h"
 #include "src/common/libutil/errprintf.h"
 
+#include "collective.h"
+
 struct rexec_ctx {
     flux_msg_handler_t **handlers;
     subprocess_server_t *ss;
+    struct collective *coll;
     flux_t *h;
     flux_future_t *f_shutdown;
 };
@@ -63,6 +66,12 @@ static int reject_nonlocal (const flux_msg_t *msg,
     return 0;
 }
 
+static void disconnect_cb (const flux_msg_t *msg, void *arg)
+{
+    struct rexec_ctx *ctx = arg;
+    collective_disconnect (ctx->coll, msg);
+}
+
 static void shutdown_continuation (flux_future_t *f, void *arg)
 {
     struct rexec_ctx *ctx = arg;
@@ -134,6 +143,14 @@ static int mod_main (flux_t *h, int argc, char *argv[])
     }
     if (rank == 0)
         subprocess_server_set_auth_cb (ctx.ss, reject_nonlocal, &ctx);
+    if (!(ctx.coll = collective_create (h,
+                                        name,
+                                        rank == 0 ? reject_nonlocal : NULL,
+                                        &ctx))) {
+        flux_log_error (h, "error registering bulk-exec service");
+        goto done;
+    }
+    subprocess_server_set_disconnect_cb (ctx.ss, disconnect_cb, &ctx);
     if (flux_msg_handler_addvec_ex (h, name, htab, &ctx, &ctx.handlers) < 0) {
         flux_log_error (h, "error registering message handlers");
         goto done;
@@ -146,6 +163,7 @@ static int mod_main (flux_t *h, int argc, char *argv[])
 done:
     flux_future_destroy (ctx.f_shutdown);
     flux_msg_handler_delvec (ctx.handlers);
+    collective_destroy (ctx.coll);
     subprocess_server_destroy (ctx.ss);
     return rc;
 }
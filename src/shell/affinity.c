@@ -251,6 +251,37 @@ static void shell_affinity_destroy (void *arg)
     free (sa);
 }
 
+/*  Attach to the topology shared by the local resource module, if
+ *   available, to avoid an XML parse in every job shell.
+ *  The adopted topology is read-only, and distribute_tasks() restricts
+ *   the topology, so return a private duplicate.
+ */
+static hwloc_topology_t topology_adopt (flux_shell_t *shell)
+{
+    flux_t *h = flux_shell_get_flux (shell);
+    const char *rundir;
+    char path[1024];
+    hwloc_topology_t topo;
+    hwloc_topology_t dup;
+
+    if (!(rundir = flux_attr_get (h, "rundir"))
+        || snprintf (path,
+                     sizeof (path),
+                     "%s/%s",
+                     rundir,
+                     RHWLOC_SHMEM_FILE) >= sizeof (path)
+        || !(topo = rhwloc_topology_shmem_adopt (path)))
+        return NULL;
+    if (!hwloc_topology_is_thissystem (topo)
+        || hwloc_topology_dup (&dup, topo) < 0) {
+        hwloc_topology_destroy (topo);
+        return NULL;
+    }
+    hwloc_topology_destroy (topo);
+    shell_debug ("using shared topology from %s", path);
+    return dup;
+}
+
 /*  Initialize topology object for affinity processing.
  */
 static int shell_affinity_topology_init (flux_shell_t *shell,
@@ -259,6 +290,9 @@ static int shell_affinity_topology_init (flux_shell_t *shell,
 {
     const char *xml;
 
+    if (!dry_run && (sa->topo = topology_adopt (shell)))
+        return 0;
+
     /*  Fetch hwloc XML cached in job shell to avoid heavyweight
      *   hwloc topology load (Issue #4365)
      */
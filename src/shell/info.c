@@ -29,11 +29,11 @@
 #include "info.h"
 #include "jobspec.h"
 
-/* Get jobspec from job-info.lookup future and assign.
+/* Get jobspec from the first job-info.launch-watch response and assign.
  * Return 0 on success, -1 on failure (and log error).
- * N.B. assigned values remain valid until future is destroyed.
+ * Caller must free jobspec.
  */
-static int lookup_jobspec_get (flux_future_t *f, char **jobspec)
+static int launch_jobspec_get (flux_future_t *f, char **jobspec)
 {
     flux_error_t error;
     const char *J;
@@ -49,26 +49,7 @@ error:
     return -1;
 }
 
-/* Fetch J from the job-info service.
- * Return future on success or NULL on failure (and log error).
- */
-static flux_future_t *lookup_jobspec (flux_t *h, flux_jobid_t jobid)
-{
-    flux_future_t *f;
-    f = flux_rpc_pack (h,
-                       "job-info.lookup",
-                       FLUX_NODEID_ANY,
-                       0,
-                       "{s:I s:[s] s:i}",
-                       "id", jobid,
-                       "keys", "J",
-                       "flags", 0);
-    if (!f)
-        shell_log_error ("error sending job-info request");
-    return f;
-}
-
-/*  Unpack R from a job-info.update-watch response and update the
+/*  Unpack R from a job-info.launch-watch response and update the
  *  shell's internal info->R and info->rcalc. If a response can't be
  *  unpacked or rcalc_create_json() fails, just ignore this response
  *  and let caller decide if the error is fatal.
@@ -125,7 +106,6 @@ static void R_update_cb (flux_future_t *f, void *arg)
 static int shell_init_jobinfo (flux_shell_t *shell, struct shell_info *info)
 {
     int rc = -1;
-    flux_future_t *f_info = NULL;
     flux_future_t *f_hwloc = NULL;
     const char *xml;
     char *jobspec = NULL;
@@ -142,23 +122,20 @@ static int shell_init_jobinfo (flux_shell_t *shell, struct shell_info *info)
                               0)))
         goto out;
 
-    /*  fetch R from job-info service
+    /*  fetch J and R from job-info service.  The local job-info module
+     *  caches these per job and forwards a single request upstream, so
+     *  shells of large jobs do not each look them up in the KVS.
+     *  The stream continues with R updates.
      */
     if (!(info->R_watch_future = flux_rpc_pack (shell->h,
-                                                "job-info.update-watch",
+                                                "job-info.launch-watch",
                                                 FLUX_NODEID_ANY,
                                                 FLUX_RPC_STREAMING,
-                                                "{s:I s:s s:i}",
+                                                "{s:I s:i}",
                                                 "id", shell->jobid,
-                                                "key", "R",
                                                 "flags", 0)))
         goto out;
 
-    /*  fetch jobspec (via J) for this job
-     */
-    if (!(f_info = lookup_jobspec (shell->h, shell->jobid)))
-        goto out;
-
     if (flux_rpc_get (f_hwloc, &xml) < 0
         || !(info->hwloc_xml = strdup (xml))) {
         shell_log_error ("error fetching local hwloc xml");
@@ -167,13 +144,13 @@ static int shell_init_jobinfo (flux_shell_t *shell, struct shell_info *info)
             goto out;
         }
     }
-    if (lookup_jobspec_get (f_info, &jobspec) < 0) {
+    if (launch_jobspec_get (info->R_watch_future, &jobspec) < 0) {
         shell_log_error ("error fetching jobspec");
         goto out;
     }
 
     /*  Synchronously get initial version of R from first job-info
-     *  watch response:
+     *  watch response (this also resets the future for updates):
      */
     if (resource_watch_update (info) < 0)
         goto out;
@@ -202,7 +179,6 @@ static int shell_init_jobinfo (flux_shell_t *shell, struct shell_info *info)
 out:
     free (jobspec);
     flux_future_destroy (f_hwloc);
-    flux_future_destroy (f_info);
     return rc;
 }
 
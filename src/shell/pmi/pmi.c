@@ -43,6 +43,10 @@
  * shell_pmi_task_ready() logs read errors, EOF, and finalization to stderr
  * in a compatible format.
  *
+ * The PMI KVS is implemented either by an allgather of all keys at each
+ * barrier (pmi-simple.kvs=exchange, the default), or by storing each key on
+ * one owning shell and fetching it on demand (pmi-simple.kvs=sharded).
+ *
  * Caveats:
  * - PMI kvsname parameter is ignored
  * - 64-bit Flux job id's are assigned to integer-typed PMI appnum
@@ -76,6 +80,7 @@
 #include "internal.h"
 #include "task.h"
 #include "pmi_exchange.h"
+#include "pmi_shard.h"
 
 struct shell_pmi {
     flux_shell_t *shell;
@@ -84,6 +89,7 @@ struct shell_pmi {
     json_t *pending;// pending to be exchanged
     json_t *locals;  // never exchanged
     struct pmi_exchange *exchange;
+    struct pmi_shard *shard;
     bool abort;     // an abort exception has been raised
 };
 
@@ -211,6 +217,97 @@ static int exchange_kvs_put (void *arg,
     return put_dict (pmi->pending, key, val);
 }
 
+/**
+ ** ops for sharding the PMI KVS across shells
+ ** This is used if pmi.kvs=sharded option is provided.
+ ** Puts are held locally until the barrier, as with the exchange, but
+ ** then sent to the shell that owns each key.  Gets of keys not held
+ ** locally are fetched from the owner on demand.
+ **/
+
+/* pmi_shard_get_f signature */
+static void shard_get_cb (void *cli, const char *val, void *arg)
+{
+    struct shell_pmi *pmi = arg;
+
+    pmi_simple_server_kvs_get_complete (pmi->server, cli, val);
+}
+
+static void shard_exchange_cb (struct pmi_exchange *pex, void *arg)
+{
+    struct shell_pmi *pmi = arg;
+    int rc = 0;
+
+    if (pmi_exchange_has_error (pex)) {
+        shell_warn ("exchange failed");
+        rc = -1;
+    }
+    pmi_simple_server_barrier_complete (pmi->server, rc);
+}
+
+/* pmi_shard_put_f signature */
+static void shard_put_cb (int rc, void *arg)
+{
+    struct shell_pmi *pmi = arg;
+
+    if (rc < 0) {
+        shell_warn ("failed to store keys on owning shells");
+        goto error;
+    }
+    json_object_clear (pmi->pending);
+    pmi_shard_clear_cache (pmi->shard);
+    if (pmi->shell->info->shell_size == 1) {
+        pmi_simple_server_barrier_complete (pmi->server, 0);
+        return;
+    }
+    /* All keys from this shell are stored.  Exchange an empty dict as
+     * a pure barrier, so that no shell proceeds until all keys are stored.
+     */
+    if (pmi_exchange (pmi->exchange,
+                      pmi->pending,
+                      shard_exchange_cb,
+                      pmi) < 0) {
+        shell_warn ("pmi_exchange %s", flux_strerror (errno));
+        goto error;
+    }
+    return;
+error:
+    pmi_simple_server_barrier_complete (pmi->server, -1);
+}
+
+/* pmi_simple_ops->kvs_get() signature */
+static int shard_kvs_get (void *arg,
+                          void *cli,
+                          const char *kvsname,
+                          const char *key)
+{
+    struct shell_pmi *pmi = arg;
+    json_t *o;
+
+    if ((o = json_object_get (pmi->locals, key))
+        || (o = json_object_get (pmi->pending, key))) {
+        pmi_simple_server_kvs_get_complete (pmi->server,
+                                            cli,
+                                            json_string_value (o));
+        return 0;
+    }
+    if (pmi_shard_get (pmi->shard, key, cli) < 0)
+        return -1; // PMI_ERR_INVALID_KEY
+    return 0;
+}
+
+/* pmi_simple_ops->barrier_enter() signature */
+static int shard_barrier_enter (void *arg)
+{
+    struct shell_pmi *pmi = arg;
+
+    if (pmi_shard_put (pmi->shard, pmi->pending, shard_put_cb, pmi) < 0) {
+        shell_warn ("pmi_shard_put %s", flux_strerror (errno));
+        return -1; // PMI_FAIL
+    }
+    return 0;
+}
+
 /**
  ** end of KVS implementations
  **/
@@ -362,6 +459,7 @@ static void pmi_destroy (struct shell_pmi *pmi)
         int saved_errno = errno;
         pmi_simple_server_destroy (pmi->server);
         pmi_exchange_destroy (pmi->exchange);
+        pmi_shard_destroy (pmi->shard);
         json_decref (pmi->global);
         json_decref (pmi->pending);
         json_decref (pmi->locals);
@@ -423,6 +521,14 @@ static struct shell_pmi *pmi_create (flux_shell_t *shell, json_t *config)
         if (!(pmi->exchange = pmi_exchange_create (shell, exchange_k)))
             goto error;
     }
+    else if (streq (kvs, "sharded")) {
+        shell_pmi_ops.kvs_put = exchange_kvs_put;
+        shell_pmi_ops.kvs_get = shard_kvs_get;
+        shell_pmi_ops.barrier_enter = shard_barrier_enter;
+        if (!(pmi->exchange = pmi_exchange_create (shell, exchange_k))
+            || !(pmi->shard = pmi_shard_create (shell, shard_get_cb, pmi)))
+            goto error;
+    }
     else {
         shell_log_error ("Unknown kvs implementation %s", kvs);
         errno = EINVAL;
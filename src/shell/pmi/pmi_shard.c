@@ -0,0 +1,433 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+/* pmi_shard.c - key-value store sharded across shells
+ *
+ * Each key is owned by one shell rank, selected by a hash of the key.
+ * At a PMI barrier, each shell sends the keys put since the last barrier
+ * to their owners, batched per owner, before entering the barrier.
+ * After the barrier, a get for a key not held locally is fetched from the
+ * owner and cached until the next barrier.
+ *
+ * Compared to the allgather in pmi_exchange.c, each shell stores only
+ * its share of the keys plus those it has read, which suits large jobs
+ * where each process reads a few peers' keys.  Jobs where every process
+ * reads every key are better served by the allgather.
+ */
+#define FLUX_SHELL_PLUGIN_NAME "pmi-simple"
+
+#if HAVE_CONFIG_H
+#include "config.h"
+#endif
+#include <stdlib.h>
+#include <stdint.h>
+#include <jansson.h>
+#include <flux/core.h>
+#include <flux/shell.h>
+
+#include "src/common/libczmqcontainers/czmq_containers.h"
+
+#include "info.h"
+#include "internal.h"
+
+#include "pmi_shard.h"
+
+struct put_request {
+    struct pmi_shard *ps;
+    zlist_t *futures;
+    int pending;
+    int errors;
+    pmi_shard_put_f cb;
+    void *cb_arg;
+};
+
+struct get_request {
+    struct pmi_shard *ps;
+    char *key;
+    zlist_t *clients;
+    flux_future_t *f;
+};
+
+struct pmi_shard {
+    flux_shell_t *shell;
+    int size;
+    int rank;
+    json_t *store;              // keys owned by this shell
+    json_t *cache;              // keys fetched from other shells
+    zhashx_t *gets;             // key => pending get_request
+    struct put_request *put;    // put in progress
+    pmi_shard_get_f get_cb;
+    void *get_arg;
+};
+
+/* 32-bit FNV-1a hash of key, used to select the owning shell rank.
+ */
+static int key_owner (struct pmi_shard *ps, const char *key)
+{
+    uint32_t hash = 2166136261U;
+    const unsigned char *p;
+
+    for (p = (const unsigned char *)key; *p != '\0'; p++) {
+        hash ^= *p;
+        hash *= 16777619U;
+    }
+    return hash % ps->size;
+}
+
+static void put_request_destroy (struct put_request *put)
+{
+    if (put) {
+        int saved_errno = errno;
+        if (put->futures) {
+            flux_future_t *f;
+            while ((f = zlist_pop (put->futures)))
+                flux_future_destroy (f);
+            zlist_destroy (&put->futures);
+        }
+        free (put);
+        errno = saved_errno;
+    }
+}
+
+static struct put_request *put_request_create (struct pmi_shard *ps,
+                                               pmi_shard_put_f cb,
+                                               void *arg)
+{
+    struct put_request *put;
+
+    if (!(put = calloc (1, sizeof (*put))))
+        return NULL;
+    put->ps = ps;
+    put->cb = cb;
+    put->cb_arg = arg;
+    if (!(put->futures = zlist_new ())) {
+        put_request_destroy (put);
+        errno = ENOMEM;
+        return NULL;
+    }
+    return put;
+}
+
+static void put_complete (struct put_request *put)
+{
+    put->ps->put = NULL;
+    put->cb (put->errors > 0 ? -1 : 0, put->cb_arg);
+    put_request_destroy (put);
+}
+
+/* Owner has stored a batch of keys.
+ */
+static void put_continuation (flux_future_t *f, void *arg)
+{
+    struct put_request *put = arg;
+
+    if (flux_future_get (f, NULL) < 0) {
+        shell_warn ("pmi-shard-put request: %s", future_strerror (f, errno));
+        put->errors++;
+    }
+    if (--put->pending == 0)
+        put_complete (put);
+}
+
+static int put_send (struct put_request *put, int owner, json_t *batch)
+{
+    struct pmi_shard *ps = put->ps;
+    flux_future_t *f;
+
+    if (!(f = flux_shell_rpc_pack (ps->shell,
+                                   "pmi-shard-put",
+                                   owner,
+                                   0,
+                                   "O",
+                                   batch))
+        || flux_future_then (f, -1, put_continuation, put) < 0
+        || zlist_append (put->futures, f) < 0) {
+        flux_future_destroy (f);
+        return -1;
+    }
+    put->pending++;
+    return 0;
+}
+
+int pmi_shard_put (struct pmi_shard *ps,
+                   json_t *dict,
+                   pmi_shard_put_f cb,
+                   void *arg)
+{
+    struct put_request *put = NULL;
+    json_t **batch;
+    const char *key;
+    json_t *val;
+    int i;
+    int rc = -1;
+
+    if (ps->put) {
+        errno = EINPROGRESS;
+        return -1;
+    }
+    if (!(batch = calloc (ps->size, sizeof (batch[0]))))
+        return -1;
+    json_object_foreach (dict, key, val) {
+        int owner = key_owner (ps, key);
+
+        if (owner == ps->rank) {
+            if (json_object_set (ps->store, key, val) < 0)
+                goto nomem;
+            continue;
+        }
+        if (!batch[owner] && !(batch[owner] = json_object ()))
+            goto nomem;
+        if (json_object_set (batch[owner], key, val) < 0)
+            goto nomem;
+    }
+    if (!(put = put_request_create (ps, cb, arg)))
+        goto out;
+    for (i = 0; i < ps->size; i++) {
+        if (batch[i] && put_send (put, i, batch[i]) < 0) {
+            shell_warn ("error sending pmi-shard-put request");
+            goto out;
+        }
+    }
+    ps->put = put;
+    if (put->pending == 0)
+        put_complete (put);
+    rc = 0;
+    goto out;
+nomem:
+    errno = ENOMEM;
+out:
+    if (rc < 0)
+        put_request_destroy (put);
+    for (i = 0; i < ps->size; i++)
+        json_decref (batch[i]);
+    free (batch);
+    return rc;
+}
+
+static void get_request_destroy (struct get_request *gr)
+{
+    if (gr) {
+        int saved_errno = errno;
+        flux_future_destroy (gr->f);
+        zlist_destroy (&gr->clients);
+        free (gr->key);
+        free (gr);
+        errno = saved_errno;
+    }
+}
+
+// zhashx_destructor_fn footprint
+static void get_request_destructor (void **item)
+{
+    if (item) {
+        get_request_destroy (*item);
+        *item = NULL;
+    }
+}
+
+static struct get_request *get_request_create (struct pmi_shard *ps,
+                                               const char *key)
+{
+    struct get_request *gr;
+
+    if (!(gr = calloc (1, sizeof (*gr))))
+        return NULL;
+    gr->ps = ps;
+    if (!(gr->key = strdup (key)))
+        goto error;
+    if (!(gr->clients = zlist_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    return gr;
+error:
+    get_request_destroy (gr);
+    return NULL;
+}
+
+/* Owner has responded to a get request.  Cache the value and complete
+ * the get for each waiting client.
+ */
+static void get_continuation (flux_future_t *f, void *arg)
+{
+    struct get_request *gr = arg;
+    struct pmi_shard *ps = gr->ps;
+    const char *val = NULL;
+    void *cli;
+
+    if (flux_rpc_get_unpack (f, "{s:s}", "value", &val) < 0) {
+        if (errno != ENOENT)
+            shell_warn ("pmi-shard-get request: %s",
+                        future_strerror (f, errno));
+        val = NULL;
+    }
+    else if (json_object_set_new (ps->cache, gr->key, json_string (val)) < 0)
+        shell_warn ("pmi-shard-get: failed to cache %s", gr->key);
+    while ((cli = zlist_pop (gr->clients)))
+        ps->get_cb (cli, val, ps->get_arg);
+    zhashx_delete (ps->gets, gr->key);
+}
+
+int pmi_shard_get (struct pmi_shard *ps, const char *key, void *cli)
+{
+    struct get_request *gr;
+    int owner = key_owner (ps, key);
+    json_t *o;
+
+    if (owner == ps->rank) {
+        o = json_object_get (ps->store, key);
+        ps->get_cb (cli, o ? json_string_value (o) : NULL, ps->get_arg);
+        return 0;
+    }
+    if ((o = json_object_get (ps->cache, key))) {
+        ps->get_cb (cli, json_string_value (o), ps->get_arg);
+        return 0;
+    }
+    if ((gr = zhashx_lookup (ps->gets, key))) {
+        if (zlist_append (gr->clients, cli) < 0) {
+            errno = ENOMEM;
+            return -1;
+        }
+        return 0;
+    }
+    if (!(gr = get_request_create (ps, key)))
+        return -1;
+    if (zlist_append (gr->clients, cli) < 0) {
+        errno = ENOMEM;
+        goto error;
+    }
+    if (!(gr->f = flux_shell_rpc_pack (ps->shell,
+                                       "pmi-shard-get",
+                                       owner,
+                                       0,
+                                       "{s:s}",
+                                       "key", key))
+        || flux_future_then (gr->f, -1, get_continuation, gr) < 0) {
+        shell_warn ("error sending pmi-shard-get request");
+        goto error;
+    }
+    if (zhashx_insert (ps->gets, gr->key, gr) < 0) {
+        errno = EEXIST;
+        goto error;
+    }
+    return 0;
+error:
+    get_request_destroy (gr);
+    return -1;
+}
+
+void pmi_shard_clear_cache (struct pmi_shard *ps)
+{
+    json_object_clear (ps->cache);
+}
+
+/* Another shell is storing keys owned by this shell.
+ */
+static void shard_put_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct pmi_shard *ps = arg;
+    json_t *dict;
+    const char *errstr = NULL;
+
+    if (flux_request_unpack (msg, NULL, "o", &dict) < 0)
+        goto error;
+    if (json_object_update (ps->store, dict) < 0) {
+        errstr = "pmi-shard-put request failed to update store";
+        errno = ENOMEM;
+        goto error;
+    }
+    if (flux_respond (h, msg, NULL) < 0)
+        shell_warn ("error responding to pmi-shard-put request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, errstr) < 0)
+        shell_warn ("error responding to pmi-shard-put request: %s",
+                    flux_strerror (errno));
+}
+
+/* Another shell is looking up a key owned by this shell.
+ */
+static void shard_get_cb (flux_t *h,
+                          flux_msg_handler_t *mh,
+                          const flux_msg_t *msg,
+                          void *arg)
+{
+    struct pmi_shard *ps = arg;
+    const char *key;
+    json_t *o;
+
+    if (flux_request_unpack (msg, NULL, "{s:s}", "key", &key) < 0)
+        goto error;
+    if (!(o = json_object_get (ps->store, key))) {
+        errno = ENOENT;
+        goto error;
+    }
+    if (flux_respond_pack (h, msg, "{s:O}", "value", o) < 0)
+        shell_warn ("error responding to pmi-shard-get request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        shell_warn ("error responding to pmi-shard-get request: %s",
+                    flux_strerror (errno));
+}
+
+struct pmi_shard *pmi_shard_create (flux_shell_t *shell,
+                                    pmi_shard_get_f cb,
+                                    void *arg)
+{
+    struct pmi_shard *ps;
+
+    if (!(ps = calloc (1, sizeof (*ps))))
+        return NULL;
+    ps->shell = shell;
+    ps->size = shell->info->shell_size;
+    ps->rank = shell->info->shell_rank;
+    ps->get_cb = cb;
+    ps->get_arg = arg;
+    if (!(ps->store = json_object ())
+        || !(ps->cache = json_object ())
+        || !(ps->gets = zhashx_new ())) {
+        errno = ENOMEM;
+        goto error;
+    }
+    zhashx_set_destructor (ps->gets, get_request_destructor);
+    if (flux_shell_service_register (shell,
+                                     "pmi-shard-put",
+                                     shard_put_cb,
+                                     ps) < 0
+        || flux_shell_service_register (shell,
+                                        "pmi-shard-get",
+                                        shard_get_cb,
+                                        ps) < 0)
+        goto error;
+    return ps;
+error:
+    pmi_shard_destroy (ps);
+    return NULL;
+}
+
+void pmi_shard_destroy (struct pmi_shard *ps)
+{
+    if (ps) {
+        int saved_errno = errno;
+        put_request_destroy (ps->put);
+        zhashx_destroy (&ps->gets);
+        json_decref (ps->store);
+        json_decref (ps->cache);
+        free (ps);
+        errno = saved_errno;
+    }
+}
+
+/* vi: ts=4 sw=4 expandtab
+ */
@@ -0,0 +1,55 @@
+/************************************************************\
+ * Copyright 2026 Lawrence Livermore National Security, LLC
+ * (c.f. AUTHORS, NOTICE.LLNS, COPYING)
+ *
+ * This file is part of the Flux resource manager framework.
+ * For details, see https://github.com/flux-framework.
+ *
+ * SPDX-License-Identifier: LGPL-3.0
+\************************************************************/
+
+#ifndef SHELL_PMI_SHARD_H
+#define SHELL_PMI_SHARD_H
+
+/* Called when a pmi_shard_get() completes.  'val' is NULL if the key
+ * was not found or an error occurred.  'cli' is the value that was passed
+ * to pmi_shard_get().
+ */
+typedef void (*pmi_shard_get_f)(void *cli, const char *val, void *arg);
+
+/* Called when a pmi_shard_put() completes.  'rc' is 0 on success,
+ * or -1 on failure.
+ */
+typedef void (*pmi_shard_put_f)(int rc, void *arg);
+
+/* Create handle for a key-value store sharded across all shell ranks.
+ * 'cb' is invoked when a pmi_shard_get() completes.
+ */
+struct pmi_shard *pmi_shard_create (flux_shell_t *shell,
+                                    pmi_shard_get_f cb,
+                                    void *arg);
+void pmi_shard_destroy (struct pmi_shard *ps);
+
+/* Store each key in 'dict' on the shell rank that owns it.
+ * 'cb' is invoked once all keys are stored.  Only one put may be
+ * in progress at a time.
+ */
+int pmi_shard_put (struct pmi_shard *ps,
+                   json_t *dict,
+                   pmi_shard_put_f cb,
+                   void *arg);
+
+/* Look up 'key', fetching it from the owning shell rank if it is not
+ * cached locally.  Concurrent lookups of the same key share one request.
+ */
+int pmi_shard_get (struct pmi_shard *ps, const char *key, void *cli);
+
+/* Drop cached values, e.g. when a barrier completes and values
+ * may have been updated.
+ */
+void pmi_shard_clear_cache (struct pmi_shard *ps);
+
+#endif /* !SHELL_PMI_SHARD_H */
+
+/* vi: ts=4 sw=4 expandtab
+ */
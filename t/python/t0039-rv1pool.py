@@ -1645,5 +1645,177 @@ class TestSubclassCopy(unittest.TestCase):
         self.assertEqual(subset.tag, "tagged")
 
 
+class TestRv1PoolIndex(unittest.TestCase):
+    """The free-resource index tracks availability and allocation state."""
+
+    def _scan(self, pool, slot_size=1, gpu_per_slot=0):
+        """Brute-force worst-fit candidate ranks, as alloc() once computed them."""
+        candidates = []
+        for rank, info in pool._ranks.items():
+            free_cores = info["cores"] - info["allocated_cores"]
+            free_gpus = info["gpus"] - info["allocated_gpus"]
+            if (
+                info["up"]
+                and len(free_cores) >= slot_size
+                and len(free_gpus) >= gpu_per_slot
+            ):
+                candidates.append((rank, len(free_cores), len(free_gpus)))
+        candidates.sort(key=lambda c: (c[1], c[2]), reverse=True)
+        return [c[0] for c in candidates]
+
+    def _indexed(self, pool, slot_size=1, gpu_per_slot=0):
+        return [
+            c[0]
+            for c in pool._indexed_candidates(slot_size, gpu_per_slot, False, None)
+        ]
+
+    def test_index_follows_alloc_free_up_down(self):
+        pool = Rv1Pool(R_gpu)
+        self.assertEqual(self._indexed(pool), self._scan(pool))
+        pool.alloc(1, rr(0, 3, 1, gpu_per_slot=0))
+        self.assertEqual(self._indexed(pool), self._scan(pool))
+        self.assertEqual(
+            self._indexed(pool, gpu_per_slot=2), self._scan(pool, gpu_per_slot=2)
+        )
+        pool.alloc(2, rr(1, 1, 2, gpu_per_slot=1))
+        self.assertEqual(self._indexed(pool, 2), self._scan(pool, 2))
+        pool.mark_down("0")
+        self.assertEqual(self._indexed(pool), self._scan(pool))
+        pool.free(1, final=True)
+        self.assertEqual(self._indexed(pool), self._scan(pool))
+        pool.mark_up("all")
+        self.assertEqual(self._indexed(pool), self._scan(pool))
+        pool.free(2, final=True)
+        self.assertEqual(self._indexed(pool), [0, 1])
+
+    def test_index_is_updated_incrementally(self):
+        pool = Rv1Pool(R_4x4)
+        list(pool._indexed_candidates(1, 0, False, None))
+        index = pool._free_index
+        pool.alloc(1, rr(1, 2, 1))
+        pool.mark_down("3")
+        pool.free(1, final=True)
+        self.assertIs(pool._free_index, index)
+        self.assertEqual(pool._index_gen, pool.generation)
+        self.assertEqual(self._indexed(pool), [0, 1, 2])
+
+    def test_stale_index_is_rebuilt(self):
+        pool = Rv1Pool(R_4x4)
+        list(pool._indexed_candidates(1, 0, False, None))
+        # Change state behind the index's back, as a subclass might.
+        pool._ranks[0]["allocated_cores"] |= {0, 1, 2}
+        pool._bump()
+        self.assertEqual(self._indexed(pool), [1, 2, 3, 0])
+        self.assertEqual(self._indexed(pool, 2), [1, 2, 3])
+
+    def test_candidates_are_generated_lazily(self):
+        pool = Rv1Pool(R_4x4)
+        candidates = pool._indexed_candidates(1, 0, False, None)
+        rank, info, free_cores, free_gpus = next(candidates)
+        self.assertEqual(rank, 0)
+        self.assertEqual(free_cores, {0, 1, 2, 3})
+        self.assertEqual(free_gpus, frozenset())
+
+    def test_copy_has_independent_index(self):
+        pool = Rv1Pool(R_4x4)
+        pool.alloc(1, rr(1, 4, 1))
+        sim = pool.copy()
+        sim.alloc(2, rr(3, 12, 1))
+        self.assertEqual(self._indexed(pool), [1, 2, 3])
+        self.assertEqual(self._indexed(sim), [])
+
+    def _props_pool(self, nranks=64):
+        """Pool of *nranks* 4-core nodes, "fast" on 0-3, "big" on 2-5."""
+        return Rv1Pool(
+            {
+                "version": 1,
+                "execution": {
+                    "R_lite": [
+                        {"rank": f"0-{nranks - 1}", "children": {"core": "0-3"}}
+                    ],
+                    "starttime": 0,
+                    "expiration": 0,
+                    "nodelist": [f"node[0-{nranks - 1}]"],
+                    "properties": {"fast": "0-3", "big": "2-5"},
+                },
+            }
+        )
+
+    def test_property_constraint_visits_only_matching_ranks(self):
+        class CountingDict(dict):
+            def __getitem__(self, key):
+                self.visited.append(key)
+                return super().__getitem__(key)
+
+        def no_match(*args):
+            raise AssertionError("_matches_constraint called")
+
+        pool = self._props_pool()
+        list(pool._indexed_candidates(1, 0, False, None))
+        pool._ranks = CountingDict(pool._ranks)
+        pool._matches_constraint = no_match
+        for constraint, expected in [
+            ({"properties": ["fast"]}, [0, 1, 2, 3]),
+            ({"properties": ["fast", "^big"]}, [0, 1]),
+            ({"and": [{"properties": ["fast"]}, {"properties": ["big"]}]}, [2, 3]),
+            (
+                {"or": [{"properties": ["fast"]}, {"properties": ["big"]}]},
+                list(range(6)),
+            ),
+            ({"properties": ["nosuchprop"]}, []),
+        ]:
+            pool._ranks.visited = []
+            ranks = [c[0] for c in pool._indexed_candidates(1, 0, False, constraint)]
+            self.assertEqual(ranks, expected)
+            self.assertEqual(sorted(pool._ranks.visited), expected)
+
+    def test_other_constraint_checks_every_rank(self):
+        pool = self._props_pool(8)
+        checked = []
+
+        def matches(rank, info, constraint):
+            checked.append(rank)
+            return rank in (1, 5)
+
+        pool._matches_constraint = matches
+        constraint = {"hostlist": ["node[1,5]"]}
+        ranks = [c[0] for c in pool._indexed_candidates(1, 0, False, constraint)]
+        self.assertEqual(ranks, [1, 5])
+        self.assertEqual(sorted(checked), list(range(8)))
+
+    def _alloc_both_ways(self, request):
+        """Alloc *request* with and without the property set path."""
+        pools = []
+        for use_sets in (True, False):
+            pool = self._props_pool(8)
+            if not use_sets:
+                pool._constraint_ranks = lambda constraint: None
+            # leave ranks 2, 3, 4 with 1, 3, 2 free cores
+            pool.alloc(1, rr(1, 3, 1, constraint={"ranks": "2"}))
+            pool.alloc(2, rr(1, 1, 1, constraint={"ranks": "3"}))
+            pool.alloc(3, rr(1, 2, 1, constraint={"ranks": "4"}))
+            result = pool.alloc(4, request)
+            pools.append(
+                {rank: set(info["cores"]) for rank, info in result._ranks.items()}
+            )
+        self.assertEqual(pools[0], pools[1])
+        return pools[0]
+
+    def test_alloc_worst_fit_unchanged_with_constraint(self):
+        ranks = self._alloc_both_ways(rr(0, 5, 1, constraint={"properties": ["big"]}))
+        self.assertEqual(sorted(ranks), [3, 5])
+        self.assertEqual(len(ranks[5]), 4)
+        self.assertEqual(len(ranks[3]), 1)
+
+    def test_alloc_worst_fit_unchanged_with_nnodes(self):
+        constraint = {"and": [{"properties": ["big"]}, {"properties": ["^fast"]}]}
+        ranks = self._alloc_both_ways(rr(2, 4, 1, constraint=constraint))
+        self.assertEqual(sorted(ranks), [4, 5])
+        ranks = self._alloc_both_ways(
+            rr(2, 2, 1, constraint={"or": [{"properties": ["fast"]}]})
+        )
+        self.assertEqual(sorted(ranks), [0, 1])
+
+
 if __name__ == "__main__":
     unittest.main(testRunner=TAPTestRunner())
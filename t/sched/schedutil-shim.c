@@ -32,12 +32,15 @@
  *
  * The most recently held alloc request message is retained so that a
  * cancel can be answered against it.
+ *
+ * schedutil-shim.stats-get returns libschedutil alloc commit statistics.
  */
 
 #if HAVE_CONFIG_H
 #include "config.h"
 #endif
 #include <flux/core.h>
+#include <jansson.h>
 
 #include "src/common/libschedutil/init.h"
 #include "src/common/libschedutil/hello.h"
@@ -48,6 +51,7 @@
 
 struct shim {
     schedutil_t *util;
+    flux_msg_handler_t **handlers;
     const flux_msg_t *held;     // most recent held alloc request (mode=hold)
 };
 
@@ -190,6 +194,34 @@ static int hello_cb (flux_t *h, const flux_msg_t *msg, const char *R, void *arg)
     return 0;
 }
 
+static void stats_cb (flux_t *h,
+                      flux_msg_handler_t *mh,
+                      const flux_msg_t *msg,
+                      void *arg)
+{
+    struct shim *ctx = arg;
+    struct schedutil_alloc_stats stats;
+
+    if (schedutil_alloc_stats_get (ctx->util, &stats) < 0)
+        goto error;
+    if (flux_respond_pack (h,
+                           msg,
+                           "{s:I s:I s:I}",
+                           "alloc_commits", (json_int_t)stats.commits,
+                           "alloc_committed", (json_int_t)stats.committed,
+                           "alloc_batch_max", (json_int_t)stats.batch_max) < 0)
+        flux_log_error (h, "error responding to stats-get request");
+    return;
+error:
+    if (flux_respond_error (h, msg, errno, NULL) < 0)
+        flux_log_error (h, "error responding to stats-get request");
+}
+
+static const struct flux_msg_handler_spec htab[] = {
+    { FLUX_MSGTYPE_REQUEST, "schedutil-shim.stats-get", stats_cb, 0 },
+    FLUX_MSGHANDLER_TABLE_END,
+};
+
 static struct schedutil_ops ops = {
     .hello = hello_cb,
     .alloc = alloc_cb,
@@ -225,6 +257,10 @@ int mod_main (flux_t *h, int argc, char **argv)
         flux_log_error (h, "schedutil_create");
         goto done;
     }
+    if (flux_msg_handler_addvec (h, htab, &ctx, &ctx.handlers) < 0) {
+        flux_log_error (h, "flux_msg_handler_addvec");
+        goto done;
+    }
     /* Complete the hello/ready handshake before advertising running, so a
      * ready failure (e.g. an invalid mode) is a clean module load failure
      * rather than a runtime crash of an already-running module.
@@ -244,6 +280,7 @@ int mod_main (flux_t *h, int argc, char **argv)
         goto done;
     rc = 0;
 done:
+    flux_msg_handler_delvec (ctx.handlers);
     flux_msg_decref (ctx.held);
     schedutil_destroy (ctx.util);
     return rc;
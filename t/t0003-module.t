@@ -180,6 +180,13 @@ test_expect_success 'flux module stats --clear-all works' '
 	count2=$(flux module stats --parse rx.request $REALMOD_DEFSTATS) &&
 	test $count2 -lt $count
 '
+test_expect_success 'flux module stats reports dispatch histograms' '
+	flux ping --count=1 $REALMOD_DEFSTATS &&
+	flux module stats --parse dispatch $REALMOD_DEFSTATS >dispatch.stats &&
+	jq -e ".\"batch-max\" == 1" <dispatch.stats &&
+	jq -e ".batch.\"1\" > 0" <dispatch.stats &&
+	jq -e ".queue | has(\"256+\")" <dispatch.stats
+'
 test_expect_success 'flux module stats --scale works' '
 	flux module stats --parse tx.request --scale=2 $REALMOD_DEFSTATS
 '
@@ -228,6 +228,24 @@ test_expect_success 'content store --chunksize=-1 fails' '
 test_expect_success 'content load with no blobrefs fails' '
 	test_must_fail flux content load </dev/null
 '
+test_expect_success 'content stats count cache hits and misses' '
+	flux exec -r 1 flux content load $(cat 4k.0.hash) >/dev/null &&
+	flux exec -r 1 flux content load $(cat 4k.0.hash) >/dev/null &&
+	flux exec -r 1 flux module stats content >lrustats.out &&
+	jq -e ".hits > 0 and .misses > 0" <lrustats.out
+'
+test_expect_success 'content module enforces size-limit on load' '
+	flux exec -r 1 flux module reload content size-limit=65536 &&
+	flux exec -r 1 flux content load $(cat 1m.0.hash) >1m.limit &&
+	test_cmp 1m.0.store 1m.limit &&
+	flux exec -r 1 flux module stats content >limitstats.out &&
+	jq -e ".\"size-limit\" == 65536" <limitstats.out &&
+	jq -e ".size <= 65536 and .evictions > 0" <limitstats.out
+'
+test_expect_success 'module fails to load with bad size-limit' '
+	test_must_fail flux exec -r 1 flux module reload content size-limit=x &&
+	flux exec -r 1 flux module load content
+'
 
 test_expect_success 'remove content module' '
 	flux exec flux module remove content
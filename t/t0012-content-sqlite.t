@@ -135,6 +135,11 @@ test_expect_success 'exercise batching of synchronous flush to backing store' '
 	test ${NDIRTY} -eq 0
 '
 
+test_expect_success 'flushed blobs were stored with batch-store' '
+	flux module stats content-sqlite >batchstats.out &&
+	jq -e ".batch_store_time.count > 0" <batchstats.out
+'
+
 test_expect_success 'drop the cache' '
 	flux content dropcache
 '
@@ -222,6 +227,100 @@ test_expect_success 'reload module with journal_mode=WAL synchronous=NORMAL' '
 	flux dmesg >logs &&
 	grep "journal_mode=WAL synchronous=NORMAL" logs
 '
+test_expect_success 'content-sqlite starts reader threads in WAL mode' '
+	flux module stats content-sqlite >walstats.out &&
+	jq -e ".config.readers == 2" <walstats.out
+'
+test_expect_success 'store and load a blob with reader threads' '
+	flux content store --bypass-cache <1m.0.store >1m.wal.hash &&
+	flux content load --bypass-cache $(cat 1m.wal.hash) >1m.wal.load &&
+	test_cmp 1m.0.store 1m.wal.load
+'
+test_expect_success 'reload module with readers=0 and load the blob' '
+	flux module remove -f content-sqlite &&
+	flux module load content-sqlite journal_mode=WAL readers=0 &&
+	flux module stats content-sqlite >walstats2.out &&
+	jq -e ".config.readers == 0" <walstats2.out &&
+	flux content load --bypass-cache $(cat 1m.wal.hash) >1m.wal.load2 &&
+	test_cmp 1m.0.store 1m.wal.load2
+'
+test_expect_success 'module fails to load with invalid readers option' '
+	flux module remove -f content-sqlite &&
+	test_must_fail flux module load content-sqlite readers=-1 &&
+	test_must_fail flux module load content-sqlite readers=foo &&
+	flux module load content-sqlite
+'
+test_expect_success 'content-sqlite reports lz4 codec stats by default' '
+	flux content store --bypass-cache <1m.0.store >/dev/null &&
+	flux module stats content-sqlite >codecstats.out &&
+	jq -e ".config.codec == \"lz4\"" <codecstats.out &&
+	jq -e ".codecs.lz4.count > 0" <codecstats.out &&
+	jq -e ".codecs.zstd.count == 0" <codecstats.out
+'
+test_expect_success 'module fails to load with invalid codec option' '
+	flux module remove -f content-sqlite &&
+	test_must_fail flux module load content-sqlite codec=foo &&
+	flux module load content-sqlite codec=none
+'
+test_expect_success 'blob stored with codec=none can be loaded' '
+	seq 1 10000 >seq.data &&
+	flux content store --bypass-cache <seq.data >seq.hash &&
+	flux content load --bypass-cache $(cat seq.hash) >seq.load &&
+	test_cmp seq.data seq.load
+'
+test_expect_success 'reload module with codec=zstd if supported' '
+	flux module remove -f content-sqlite &&
+	if flux module load content-sqlite codec=zstd; then
+	    test_set_prereq ZSTD
+	else
+	    flux module load content-sqlite
+	fi
+'
+test_expect_success !ZSTD 'dict-train fails with ENOSYS without zstd' '
+	echo "{}" | $RPC content-sqlite.dict-train 38
+'
+test_expect_success ZSTD 'blobs stored with zstd can be loaded' '
+	seq 10000 20000 >seq2.data &&
+	flux content store --bypass-cache <seq2.data >seq2.hash &&
+	flux content load --bypass-cache $(cat seq2.hash) >seq2.load &&
+	test_cmp seq2.data seq2.load &&
+	flux module stats content-sqlite >zstdstats.out &&
+	jq -e ".config.codec == \"zstd\"" <zstdstats.out &&
+	jq -e ".codecs.zstd.count > 0" <zstdstats.out &&
+	jq -e ".codecs.zstd.ratio > 1" <zstdstats.out
+'
+test_expect_success ZSTD 'dict-train trains a dictionary from stored blobs' '
+	for i in $(seq 1 200); do \
+	    echo "{\"name\":\"job$i\",\"state\":\"RUN\",\"ranks\":[$i]}" \
+	        | flux content store --bypass-cache >/dev/null; \
+	done &&
+	echo "{\"dict_size\":1024}" \
+	    | $RPC content-sqlite.dict-train >train.out &&
+	jq -e ".samples > 0" <train.out &&
+	flux module stats content-sqlite >dictstats.out &&
+	jq -e ".dict_id == $(jq .id <train.out)" <dictstats.out
+'
+test_expect_success ZSTD 'small blob is compressed with the dictionary' '
+	echo "{\"name\":\"job999\",\"state\":\"RUN\",\"ranks\":[999]}" \
+	    >small.data &&
+	flux content store --bypass-cache <small.data >small.hash &&
+	flux content load --bypass-cache $(cat small.hash) >small.load &&
+	test_cmp small.data small.load
+'
+test_expect_success ZSTD 'dictionary is reloaded with the module' '
+	flux module reload -f content-sqlite codec=zstd &&
+	flux module stats content-sqlite >dictstats2.out &&
+	jq -e ".dict_id == $(jq .id <train.out)" <dictstats2.out &&
+	flux content load --bypass-cache $(cat small.hash) >small.load2 &&
+	test_cmp small.data small.load2
+'
+test_expect_success ZSTD 'zstd blobs can be loaded after switching to lz4' '
+	flux module reload -f content-sqlite codec=lz4 &&
+	flux content load --bypass-cache $(cat small.hash) >small.load3 &&
+	test_cmp small.data small.load3 &&
+	flux content load --bypass-cache $(cat seq2.hash) >seq2.load2 &&
+	test_cmp seq2.data seq2.load2
+'
 test_expect_success 'reload module with no options and verify modes' '
 	flux module remove -f content-sqlite &&
 	flux dmesg --clear &&
@@ -354,6 +453,28 @@ test_expect_success 'remove content-sqlite module on rank 0' '
 	flux module remove content-sqlite
 '
 
+test_expect_success 'reload content with flush-batch-limit above batch max' '
+	flux exec flux module reload content flush-batch-limit=10000
+'
+test_expect_success 'store 5000 blobs with no backing store' '
+	${SPAMUTIL} 5000 200 >/dev/null &&
+	NDIRTY=`flux module stats --type int --parse dirty content` &&
+	test ${NDIRTY} -ge 5000
+'
+test_expect_success 'load content-sqlite and flush the large batch' '
+	flux module load content-sqlite truncate &&
+	flux content flush &&
+	NDIRTY=`flux module stats --type int --parse dirty content` &&
+	test ${NDIRTY} -eq 0
+'
+test_expect_success 'flush was split into multiple batch-store requests' '
+	flux module stats content-sqlite >bigbatch.out &&
+	jq -e ".batch_store_time.count >= 2" <bigbatch.out
+'
+test_expect_success 'remove content-sqlite module on rank 0' '
+	flux module remove content-sqlite
+'
+
 test_expect_success 'remove content module' '
 	flux exec flux module remove content
 '
@@ -0,0 +1,112 @@
+#!/bin/sh
+
+test_description='Test TBON-collective bulk-exec and bulk-kill'
+
+. $(dirname $0)/sharness.sh
+
+test_under_flux 7 minimal -Stbon.topo=kary:2
+
+bulk_exec="${FLUX_BUILD_DIR}/src/common/libsubprocess/bulk-exec"
+waitfile=${SHARNESS_TEST_SRCDIR}/scripts/waitfile.lua
+
+# Usage: bulk_exec_rpc RANKS ARGS...
+# Send a raw bulk-exec request and print one line per update
+bulk_exec_rpc() {
+	ranks=$1; shift
+	flux python -c '
+import sys, os, errno
+import flux
+h = flux.Flux()
+cmd = {"cmdline": sys.argv[2:], "env": dict(os.environ), "opts": {}, "channels": []}
+payload = {"ranks": sys.argv[1], "cmd": cmd, "flags": 0}
+f = h.rpc("rexec.bulk-exec", payload, flags=flux.constants.FLUX_RPC_STREAMING)
+try:
+    while True:
+        for u in f.get()["updates"]:
+            if "response" in u:
+                print(u["rank"], u["response"]["type"])
+            else:
+                print(u["rank"], "errnum", errno.errorcode[u["errnum"]])
+        f.reset()
+except OSError as exc:
+    if exc.errno != errno.ENODATA:
+        print("error", errno.errorcode[exc.errno])
+' $ranks "$@"
+}
+
+test_expect_success 'bulk-exec runs a command on all ranks' '
+	$bulk_exec --collective echo hello >all.out &&
+	test_debug "cat all.out" &&
+	test $(grep -c ": hello" all.out) -eq 7 &&
+	for rank in $(seq 0 6); do grep "^$rank: hello" all.out; done
+'
+test_expect_success 'bulk-exec runs a command on a subset of ranks' '
+	$bulk_exec --collective -r 1,4-6 echo hello >subset.out &&
+	test_debug "cat subset.out" &&
+	test $(grep -c ": hello" subset.out) -eq 4 &&
+	grep "^4: hello" subset.out &&
+	test_must_fail grep "^0: hello" subset.out
+'
+test_expect_success 'bulk-exec splits ranks across multiple cmds' '
+	$bulk_exec --collective -n 3 echo hello >ncmds.out &&
+	test_debug "cat ncmds.out" &&
+	test $(grep -c ": hello" ncmds.out) -eq 7
+'
+test_expect_success 'bulk-exec reports exit of all ranks' '
+	$bulk_exec --collective true 2>exit.err &&
+	test_debug "cat exit.err" &&
+	grep complete exit.err
+'
+test_expect_success 'bulk-exec stream has started and finished per rank' '
+	bulk_exec_rpc 0-6 true >rpc.out &&
+	test_debug "cat rpc.out" &&
+	test $(grep -c " started" rpc.out) -eq 7 &&
+	test $(grep -c " finished" rpc.out) -eq 7 &&
+	test $(grep -c " errnum ENODATA" rpc.out) -eq 7
+'
+test_expect_success 'bulk-exec reports EHOSTUNREACH for invalid ranks' '
+	bulk_exec_rpc 5-8 true >badrank.out &&
+	test_debug "cat badrank.out" &&
+	grep "^7 errnum EHOSTUNREACH" badrank.out &&
+	grep "^8 errnum EHOSTUNREACH" badrank.out &&
+	grep "^5 finished" badrank.out
+'
+test_expect_success 'bulk-exec reports exec failure per rank' '
+	bulk_exec_rpc 2-3 /nonexistent >enoent.out &&
+	test_debug "cat enoent.out" &&
+	grep "^2 errnum ENOENT" enoent.out &&
+	grep "^3 errnum ENOENT" enoent.out
+'
+test_expect_success 'bulk-exec rejects invalid ranks' '
+	bulk_exec_rpc "foo" true >einval.out &&
+	test_debug "cat einval.out" &&
+	grep "error EINVAL" einval.out
+'
+test_expect_success 'bulk-kill signals processes on all ranks' '
+	$bulk_exec --collective sleep 300 >kill.out 2>kill.err &
+	pid=$! &&
+	$waitfile --count=1 --timeout=30 --pattern=started kill.err &&
+	kill -INT $pid &&
+	wait $pid &&
+	test_debug "cat kill.err" &&
+	grep complete kill.err
+'
+test_expect_success 'processes are cleaned up when bulk-exec client exits' '
+	bulk_exec_rpc 0-6 sleep 300 >/dev/null &
+	pid=$! &&
+	retries=0 &&
+	while test $(flux sproc ps -r 6 -no {state} | grep -c R) -ne 1; do
+		retries=$(($retries+1)) &&
+		test $retries -lt 300 &&
+		sleep 0.1 || return 1
+	done &&
+	kill $pid &&
+	retries=0 &&
+	while test $(flux sproc ps -r 6 -n | wc -l) -ne 0; do
+		retries=$(($retries+1)) &&
+		test $retries -lt 300 &&
+		sleep 0.1 || return 1
+	done
+'
+
+test_done
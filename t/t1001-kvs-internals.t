@@ -45,6 +45,23 @@ test_expect_success 'kvs: kvs get/put large raw values works' '
 	flux kvs get --raw $DIR.data >reread.data &&
 	test_cmp random.data reread.data
 '
+test_expect_success 'kvs: kvs get --raw of multi-blob appended value works' '
+	flux kvs unlink -Rf $DIR &&
+	dd if=/dev/urandom bs=4096 count=3 >random3.data &&
+	split -b 4096 -d random3.data random3.part &&
+	flux kvs put --raw $DIR.data=- <random3.part00 &&
+	flux kvs put --raw --append $DIR.data=- <random3.part01 &&
+	flux kvs put --raw --append $DIR.data=- <random3.part02 &&
+	flux kvs get --raw $DIR.data >reread3.data &&
+	test_cmp random3.data reread3.data &&
+	flux kvs get --raw --at $(flux kvs get --treeobj .) $DIR.data \
+		>reread3at.data &&
+	test_cmp random3.data reread3at.data
+'
+test_expect_success 'kvs: kvs get --raw of a directory fails' '
+	test_must_fail flux kvs get --raw $DIR 2>rawdir.err &&
+	grep "Is a directory" rawdir.err
+'
 
 #
 # key normalization tests
@@ -494,6 +511,12 @@ test_expect_success 'kvs: module stats returns reasonable transaction stats' '
 	echo $commitdata | jq -e ".stddev >= 0.0"
 '
 
+test_expect_success 'kvs: module stats reports dispatch batch histogram' '
+	dispatch=$(flux module stats -p dispatch kvs) &&
+	echo $dispatch | jq -e ".\"batch-max\" == 16" &&
+	echo $dispatch | jq -e "[.batch[]] | add > 0"
+'
+
 #
 # test empty kvs txn works
 #
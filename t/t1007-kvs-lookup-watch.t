@@ -73,6 +73,26 @@ test_expect_success NO_CHAIN_LINT 'flux kvs get --watch returns commit order' '
 	test_monotonicity <seq.out
 '
 
+test_expect_success NO_CHAIN_LINT 'multiple watchers of one key each see every commit' '
+	flux kvs put test.g=1
+	flux kvs get --watch --count=10 test.g >multi1.out &
+	pid1=$! &&
+	flux kvs get --watch --count=10 test.g >multi2.out &
+	pid2=$! &&
+	flux kvs get --watch --count=10 test.g >multi3.out &
+	pid3=$! &&
+	$waitfile --count=1 --timeout=10 --pattern="[0-9]+" multi1.out &&
+	$waitfile --count=1 --timeout=10 --pattern="[0-9]+" multi2.out &&
+	$waitfile --count=1 --timeout=10 --pattern="[0-9]+" multi3.out &&
+	for i in $(seq 2 10); \
+	    do flux kvs put --no-merge test.g=$i test.other=$i; \
+	done &&
+	wait $pid1 && wait $pid2 && wait $pid3 &&
+	test_monotonicity <multi1.out &&
+	test_cmp multi1.out multi2.out &&
+	test_cmp multi1.out multi3.out
+'
+
 test_expect_success 'kvs/commit_order test works (similar to above, with higher concurrency)' '
 	$FLUX_BUILD_DIR/t/kvs/commit_order -f 16 -c 1024 test.d
 '
@@ -0,0 +1,158 @@
+#!/bin/sh
+
+test_description='Test kvs ivalref-chunk option and ranged lookups'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1 kvs
+
+# Look up blobs [first, last] of a key with a ranged kvs.lookup
+cat >lookup_range.py <<-EOF
+import sys
+import base64
+import flux
+
+key, first, last = sys.argv[1], int(sys.argv[2]), int(sys.argv[3])
+payload = {
+    "key": key,
+    "flags": 0,
+    "namespace": "primary",
+    "range": [first, last],
+}
+resp = flux.Flux().rpc("kvs.lookup", payload).get()
+sys.stdout.write(base64.b64decode(resp["val"]["data"]).decode())
+EOF
+
+append_n() {
+	key=$1
+	count=$2
+	for i in $(seq 0 $(($count-1))); do
+		flux kvs put --append $key=$i || return 1
+	done
+}
+
+reload_kvs() {
+	flux module remove kvs-watch &&
+	flux module reload kvs "$@" &&
+	flux module load kvs-watch
+}
+
+test_expect_success 'appends create a valref by default' '
+	append_n test.default 10 &&
+	flux kvs get --treeobj test.default | jq -e ".type == \"valref\""
+'
+test_expect_success 'reload kvs with ivalref-chunk=4' '
+	reload_kvs ivalref-chunk=4
+'
+test_expect_success 'appends past the chunk size create an ivalref' '
+	append_n test.log 10 &&
+	flux kvs get --treeobj test.log >log.treeobj &&
+	jq -e ".type == \"ivalref\"" log.treeobj &&
+	jq -e ".data.count == 10" log.treeobj &&
+	jq -e ".data.chunks | length == 2" log.treeobj &&
+	jq -e ".data.blobrefs | length == 2" log.treeobj
+'
+test_expect_success 'flux kvs get returns the whole ivalref value' '
+	echo 0123456789 >log.exp &&
+	flux kvs get test.log >log.out &&
+	test_cmp log.exp log.out
+'
+test_expect_success 'appending to an existing valref converts it' '
+	flux kvs put --append test.default=x &&
+	flux kvs get --treeobj test.default | jq -e ".type == \"ivalref\""
+'
+test_expect_success 'ranged kvs.lookup within one chunk works' '
+	printf "4567" >range1.exp &&
+	flux python lookup_range.py test.log 4 7 >range1.out &&
+	test_cmp range1.exp range1.out
+'
+test_expect_success 'ranged kvs.lookup spanning chunks works' '
+	printf "2345678" >range2.exp &&
+	flux python lookup_range.py test.log 2 8 >range2.out &&
+	test_cmp range2.exp range2.out
+'
+test_expect_success 'ranged kvs.lookup with negative indices works' '
+	printf "789" >range3.exp &&
+	flux python lookup_range.py test.log -3 -1 >range3.out &&
+	test_cmp range3.exp range3.out
+'
+test_expect_success 'ranged kvs.lookup out of range fails' '
+	test_must_fail flux python lookup_range.py test.log 5 20
+'
+test_expect_success 'ranged kvs.lookup works after reload with cold cache' '
+	reload_kvs ivalref-chunk=4 &&
+	printf "12" >range4.exp &&
+	flux python lookup_range.py test.log 1 2 >range4.out &&
+	test_cmp range4.exp range4.out
+'
+# kvs-watch fetches the blobs behind the inline ones with one ranged
+# kvs.lookup, so the initial response holds blobs 0-7 concatenated.
+test_expect_success 'flux kvs get --watch --append loads older chunks' '
+	cat >watch.exp <<-EOT &&
+	01234567
+	8
+	9
+	EOT
+	run_timeout 10 flux kvs get --watch --append --count=3 \
+		test.log >watch.out &&
+	test_cmp watch.exp watch.out
+'
+test_expect_success NO_CHAIN_LINT 'flux kvs get --watch --append sees new appends' '
+	flux kvs get --watch --append --count=4 test.log >watch2.out &
+	pid=$! &&
+	wait_watcherscount_nonzero primary &&
+	flux kvs put --append test.log=a &&
+	wait $pid &&
+	tail -1 watch2.out >watch2.last &&
+	echo a >watch2.exp &&
+	test_cmp watch2.exp watch2.last
+'
+test_expect_success 'flux kvs eventlog get --watch works on an ivalref' '
+	for i in $(seq 1 10); do \
+		flux kvs eventlog append --timestamp=$i test.ev foo || return 1; \
+	done &&
+	flux kvs get --treeobj test.ev | jq -e ".type == \"ivalref\"" &&
+	flux kvs eventlog get --unformatted test.ev >ev.exp &&
+	run_timeout 10 flux kvs eventlog get --unformatted --watch --count=10 \
+		test.ev >ev.out &&
+	test_cmp ev.exp ev.out
+'
+test_expect_success 'ivalref is still readable after reload with default' '
+	reload_kvs &&
+	echo 0123456789a >log2.exp &&
+	flux kvs get test.log >log2.out &&
+	test_cmp log2.exp log2.out &&
+	printf "56" >range5.exp &&
+	flux python lookup_range.py test.log 5 6 >range5.out &&
+	test_cmp range5.exp range5.out
+'
+test_expect_success 'append to an ivalref works with ivalref-chunk=0' '
+	flux kvs put --append test.log=b &&
+	echo 0123456789ab >log3.exp &&
+	flux kvs get test.log >log3.out &&
+	test_cmp log3.exp log3.out
+'
+test_expect_success 'flux kvs get --watch --append works after reload' '
+	cat >watch3.exp <<-EOT &&
+	01234567
+	8
+	9
+	a
+	b
+	EOT
+	run_timeout 10 flux kvs get --watch --append --count=5 \
+		test.log >watch3.out &&
+	test_cmp watch3.exp watch3.out
+'
+test_expect_success 'invalid ivalref-chunk option fails' '
+	flux module remove kvs-watch &&
+	flux module remove kvs &&
+	test_must_fail flux module load kvs ivalref-chunk=-1 &&
+	test_must_fail flux module load kvs ivalref-chunk=foo &&
+	flux module load kvs &&
+	flux module load kvs-watch
+'
+
+test_done
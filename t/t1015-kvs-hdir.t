@@ -0,0 +1,128 @@
+#!/bin/sh
+
+test_description='Test kvs hdir-threshold option and sharded directories'
+
+. `dirname $0`/kvs/kvs-helper.sh
+
+. `dirname $0`/sharness.sh
+
+test_under_flux 1 kvs
+
+# Print the type of the object that directory $1 is stored as
+stored_type() {
+	ref=$(flux kvs get --treeobj $1 | jq -r ".data[0]") &&
+	flux content load $ref | jq -r .type
+}
+
+# Put keys $1.k1 .. $1.k$2 with values 1 .. $2 in one commit
+put_n() {
+	args="" &&
+	for i in $(seq 1 $2); do args="$args $1.k$i=$i"; done &&
+	flux kvs put $args
+}
+
+# Print "$1.kN = N" lines for N = $2 .. $3, sorted
+dir_exp() {
+	for i in $(seq $2 $3); do echo "$1.k$i = $i"; done | sort
+}
+
+reload_kvs() {
+	flux module remove kvs-watch &&
+	flux module reload kvs "$@" &&
+	flux module load kvs-watch
+}
+
+test_expect_success 'large directory is a plain dir by default' '
+	put_n test.plain 20 &&
+	test "$(stored_type test.plain)" = "dir"
+'
+test_expect_success 'reload kvs with hdir-threshold=8' '
+	reload_kvs hdir-threshold=8
+'
+test_expect_success 'directory at the threshold is a plain dir' '
+	put_n test.small 8 &&
+	test "$(stored_type test.small)" = "dir"
+'
+test_expect_success 'directory over the threshold is stored as an hdir' '
+	put_n test.big 20 &&
+	test "$(stored_type test.big)" = "hdir"
+'
+test_expect_success 'growing a directory past the threshold shards it' '
+	flux kvs put test.small.k9=9 &&
+	test "$(stored_type test.small)" = "hdir" &&
+	dir_exp test.small 1 9 >small.exp &&
+	flux kvs dir test.small | sort >small.out &&
+	test_cmp small.exp small.out
+'
+test_expect_success 'flux kvs get works on keys in an hdir' '
+	for i in $(seq 1 20); do \
+		test "$(flux kvs get test.big.k$i)" = "$i" || return 1; \
+	done
+'
+test_expect_success 'flux kvs ls lists all keys of an hdir' '
+	for i in $(seq 1 20); do echo k$i; done | sort >ls.exp &&
+	flux kvs ls -1 test.big | sort >ls.out &&
+	test_cmp ls.exp ls.out
+'
+test_expect_success 'flux kvs dir lists all keys of an hdir' '
+	dir_exp test.big 1 20 >dir.exp &&
+	flux kvs dir test.big | sort >dir.out &&
+	test_cmp dir.exp dir.out
+'
+test_expect_success 'flux kvs get --treeobj of a key in an hdir works' '
+	flux kvs get --treeobj test.big.k3 | jq -e ".type == \"val\""
+'
+test_expect_success 'updating a key in an hdir works' '
+	flux kvs put test.big.k5=five &&
+	test "$(flux kvs get test.big.k5)" = "five" &&
+	test "$(stored_type test.big)" = "hdir"
+'
+test_expect_success 'subdirectory in an hdir works' '
+	flux kvs put test.big.sub.a=1 test.big.sub.b=2 &&
+	test "$(flux kvs get test.big.sub.b)" = "2" &&
+	flux kvs ls -1F test.big | grep "^sub\.$"
+'
+test_expect_success 'flux kvs unlink works on keys in an hdir' '
+	for i in $(seq 1 15); do \
+		flux kvs unlink test.big.k$i || return 1; \
+	done &&
+	flux kvs unlink -R test.big.sub &&
+	test_must_fail flux kvs get test.big.k1 &&
+	dir_exp test.big 16 20 >unlink.exp &&
+	flux kvs dir test.big | sort >unlink.out &&
+	test_cmp unlink.exp unlink.out
+'
+test_expect_success 'reload kvs with default hdir-threshold' '
+	put_n test.again 20 &&
+	test "$(stored_type test.again)" = "hdir" &&
+	reload_kvs
+'
+test_expect_success 'hdir is still readable after reload' '
+	dir_exp test.again 1 20 >again.exp &&
+	flux kvs dir test.again | sort >again.out &&
+	test_cmp again.exp again.out &&
+	test "$(flux kvs get test.again.k7)" = "7"
+'
+test_expect_success 'hdir can still be updated after reload' '
+	flux kvs put test.again.k21=21 &&
+	flux kvs unlink test.again.k1 &&
+	test "$(flux kvs get test.again.k21)" = "21" &&
+	test_must_fail flux kvs get test.again.k1 &&
+	dir_exp test.again 2 21 >again2.exp &&
+	flux kvs dir test.again | sort >again2.out &&
+	test_cmp again2.exp again2.out
+'
+test_expect_success 'new large directory is a plain dir after reload' '
+	put_n test.plain2 20 &&
+	test "$(stored_type test.plain2)" = "dir"
+'
+test_expect_success 'invalid hdir-threshold option fails' '
+	flux module remove kvs-watch &&
+	flux module remove kvs &&
+	test_must_fail flux module load kvs hdir-threshold=-1 &&
+	test_must_fail flux module load kvs hdir-threshold=foo &&
+	flux module load kvs &&
+	flux module load kvs-watch
+'
+
+test_done
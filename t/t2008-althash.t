@@ -24,6 +24,18 @@ test_expect_success 'Started instance with content.hash=sha256' '
 	test "$OUT" = "sha256"
 '
 
+test_expect_success 'Started instance with content.hash=blake3' '
+	OUT=$(flux start -Scontent.hash=blake3 \
+	    flux getattr content.hash) &&
+	test "$OUT" = "blake3"
+'
+
+test_expect_success 'blake3 instance stores and retrieves KVS data' '
+	OUT=$(flux start -Scontent.hash=blake3 \
+	    "flux kvs put test=hello && flux kvs get test") &&
+	test "$OUT" = "hello"
+'
+
 test_expect_success 'Started instance with content.hash=sha256,content-files' '
 	OUT=$(flux start -Scontent.hash=sha256 \
 	    -Scontent.backing-module=content-files \
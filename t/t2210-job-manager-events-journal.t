@@ -225,6 +225,38 @@ test_expect_success NO_CHAIN_LINT 'job-manager: events-journal contains older jo
 	wait $pid
 '
 
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal after_id skips older jobs' '
+	jq -j -c -n "{full:true, after_id:${jobid2}, allow:{clean:1}}" \
+		| $EVENTS_JOURNAL_STREAM > events8.out &
+	pid=$! &&
+	jobid4=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid4} clean events8.out &&
+	test_must_fail check_event_name ${jobid1} clean events8.out &&
+	test_must_fail check_event_name ${jobid2} clean events8.out &&
+	check_event_name ${jobid3} clean events8.out &&
+	kill -s USR1 $pid &&
+	wait $pid
+'
+
+test_expect_success NO_CHAIN_LINT 'job-manager: events-journal after_time skips older jobs' '
+	t=$(flux job eventlog --format=json ${jobid3} | tail -1 | jq .timestamp) &&
+	jq -j -c -n "{full:true, after_time:${t}, allow:{clean:1}}" \
+		| $EVENTS_JOURNAL_STREAM > events9.out &
+	pid=$! &&
+	jobid5=`flux job submit basic.json | flux job id` &&
+	wait_event_name ${jobid5} clean events9.out &&
+	test_must_fail check_event_name ${jobid3} clean events9.out &&
+	check_event_name ${jobid4} clean events9.out &&
+	kill -s USR1 $pid &&
+	wait $pid
+'
+
+test_expect_success 'job-manager: events-journal request fails if after_id < 0' '
+	jq -j -c -n "{after_id:-2}" > cc4.in &&
+	test_must_fail $EVENTS_JOURNAL_STREAM < cc4.in 2> cc4.err &&
+	grep "after_id must be >= 0" cc4.err
+'
+
 test_expect_success 'job-manager: events-journal request fails with EPROTO on empty payload' '
 	$RPC job-manager.events-journal 71 < /dev/null
 '
@@ -0,0 +1,83 @@
+#!/bin/sh
+
+test_description='Test flux job info service launch-watch'
+
+. $(dirname $0)/sharness.sh
+
+test_under_flux 4 job
+
+RPC=${FLUX_BUILD_DIR}/t/request/rpc
+RPC_STREAM=${FLUX_BUILD_DIR}/t/request/rpc_stream
+
+get_launch_watchers() {
+	flux exec -r $1 flux module stats --parse launch_watchers job-info
+}
+
+wait_launch_watchers() {
+	local rank=$1
+	local count=$2
+	echo "waiting for $count watchers on rank $rank"
+	test_wait_until "[ \$(flux exec -r ${rank} flux module stats \
+		--parse launch_watchers job-info 2> /dev/null) -eq ${count} ]"
+}
+
+test_expect_success 'launch-watch works on rank 0 (job inactive)' '
+	jobid=$(flux submit --wait-event=clean -N4 hostname) &&
+	echo "{\"id\":$(flux job id $jobid), \"flags\":0}" \
+		| ${RPC_STREAM} job-info.launch-watch > launch0.out &&
+	test $(cat launch0.out | wc -l) -eq 1 &&
+	jq -e ".J and .R.execution and .userid == $(id -u)" < launch0.out
+'
+test_expect_success 'launch-watch works on leaf rank (job inactive)' '
+	echo "{\"id\":$(flux job id $jobid), \"flags\":0}" \
+		| flux exec -r 3 ${RPC_STREAM} job-info.launch-watch \
+		> launch3.out &&
+	test $(cat launch3.out | wc -l) -eq 1 &&
+	test_cmp launch0.out launch3.out
+'
+test_expect_success 'launch-watch entries are removed when stream ends' '
+	for rank in 0 1 2 3; do
+		wait_launch_watchers $rank 0 || return 1
+	done
+'
+test_expect_success NO_CHAIN_LINT 'launch-watch streams R updates to leaf rank' '
+	jobid=$(flux submit --wait-event=start sleep inf)
+	id=$(flux job id $jobid)
+	echo "{\"id\":${id}, \"flags\":0}" \
+		| flux exec -r 3 ${RPC_STREAM} job-info.launch-watch \
+		> launch-update.out &
+	pid=$! &&
+	wait_launch_watchers 3 1 &&
+	wait_launch_watchers 0 1 &&
+	flux kvs eventlog append $(flux job id --to=kvs $jobid).eventlog \
+		resource-update "{\"expiration\": 100.0}" &&
+	test_wait_until "test \$(wc -l < launch-update.out) -eq 2" &&
+	flux cancel $jobid &&
+	wait $pid &&
+	head -n1 launch-update.out | jq -e ".J and .R" &&
+	tail -n1 launch-update.out | jq -e ".J == null" &&
+	tail -n1 launch-update.out | jq -e ".R.execution.expiration == 100.0"
+'
+test_expect_success 'launch-watch of unknown job fails with ENOENT' '
+	echo "{\"id\":42, \"flags\":0}" \
+		| flux exec -r 1 ${RPC_STREAM} job-info.launch-watch 2
+'
+test_expect_success 'launch-watch request with empty payload fails with EPROTO(71)' '
+	${RPC} job-info.launch-watch 71 </dev/null
+'
+test_expect_success 'launch-watch request with invalid flags fails with EPROTO(71)' '
+	echo "{\"id\":42, \"flags\":499}" \
+		| ${RPC_STREAM} job-info.launch-watch 71 "invalid flag"
+'
+test_expect_success 'launch-watch request non-streaming fails with EPROTO(71)' '
+	echo "{\"id\":42, \"flags\":0}" \
+		| ${RPC} job-info.launch-watch 71
+'
+test_expect_success 'job shells on all ranks get J and R via launch-watch' '
+	flux run -N4 -n4 hostname &&
+	for rank in 0 1 2 3; do
+		wait_launch_watchers $rank 0 || return 1
+	done
+'
+
+test_done
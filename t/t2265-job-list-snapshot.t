@@ -0,0 +1,114 @@
+#!/bin/sh
+
+test_description='Test job-list inactive job snapshot and restore'
+
+. $(dirname $0)/sharness.sh
+
+test_under_flux 4 job
+
+# Rewrite the epoch in the current job-list snapshot so that the job
+# manager journal cannot resume from it.
+corrupt_snapshot_epoch() {
+	blobref=$(flux kvs get checkpoint.job-list | jq -r .blobref) &&
+	flux content load $blobref | jq -c ".epoch = 1.0" >snapshot.json &&
+	newref=$(flux content store <snapshot.json) &&
+	flux kvs put checkpoint.job-list="{\"version\":1,\"blobref\":\"$newref\"}"
+}
+
+test_expect_success 'run some jobs to completion' '
+	flux submit --cc=1-4 true &&
+	flux submit false &&
+	flux submit -n1 --job-name=named true &&
+	flux queue drain
+'
+test_expect_success 'save flux jobs -a output' '
+	flux jobs -a >jobs.before &&
+	test $(flux jobs -a -n | wc -l) -eq 6
+'
+test_expect_success 'reload job-list' '
+	flux dmesg -C &&
+	flux module reload job-list
+'
+test_expect_success 'job-list saved and restored a snapshot' '
+	flux dmesg -H >reload.log &&
+	grep "saved snapshot of 6 inactive jobs" reload.log &&
+	grep "restored 6 inactive jobs from snapshot" reload.log &&
+	test_must_fail grep "did not resume" reload.log
+'
+test_expect_success 'checkpoint.job-list references the snapshot' '
+	flux kvs get checkpoint.job-list | jq -e ".version == 1" &&
+	blobref=$(flux kvs get checkpoint.job-list | jq -r .blobref) &&
+	flux content load $blobref | jq -e ".count == 6"
+'
+test_expect_success 'flux jobs -a output is unchanged after restore' '
+	flux jobs -a >jobs.after &&
+	test_cmp jobs.before jobs.after
+'
+test_expect_success 'jobs run after restore are listed' '
+	flux submit true &&
+	flux queue drain &&
+	flux jobs -a >jobs.before &&
+	test $(flux jobs -a -n | wc -l) -eq 7
+'
+test_expect_success 'remove job-list and rewrite snapshot epoch' '
+	flux module remove job-list &&
+	corrupt_snapshot_epoch
+'
+test_expect_success 'load job-list' '
+	flux dmesg -C &&
+	flux module load job-list
+'
+test_expect_success 'job-list fell back to a full journal replay' '
+	flux dmesg -H >replay.log &&
+	grep "restored 7 inactive jobs from snapshot" replay.log &&
+	grep "journal did not resume from snapshot, replaying" replay.log
+'
+test_expect_success 'flux jobs -a output is unchanged after replay' '
+	flux jobs -a >jobs.after &&
+	test_cmp jobs.before jobs.after
+'
+test_expect_success 'remove job-list and purge the oldest jobs' '
+	flux jobs -a -no {id.f58} | tail -3 >purged.ids &&
+	flux module remove job-list &&
+	flux job purge --force --num-limit=4
+'
+test_expect_success 'load job-list' '
+	flux dmesg -C &&
+	flux module load job-list
+'
+test_expect_success 'job-list resumed from snapshot' '
+	flux dmesg -H >purge.log &&
+	grep "restored 7 inactive jobs from snapshot" purge.log &&
+	test_must_fail grep "did not resume" purge.log
+'
+test_expect_success 'jobs purged since the snapshot are not listed' '
+	test $(flux jobs -a -n | wc -l) -eq 4 &&
+	flux jobs -a -no {id.f58} >remaining.ids &&
+	for id in $(cat purged.ids); do
+		test_must_fail grep -Fx "$id" remaining.ids || return 1
+	done
+'
+test_expect_success 'remaining jobs match the earlier listing' '
+	grep -vF -f purged.ids jobs.before >jobs.exp &&
+	flux jobs -a >jobs.after &&
+	test_cmp jobs.exp jobs.after
+'
+test_expect_success 'invalid job-list.snapshot-interval is rejected' '
+	cat >bad.toml <<-EOT &&
+	[job-list]
+	snapshot-interval = "foo"
+	EOT
+	test_must_fail flux config load bad.toml
+'
+test_expect_success 'job-list.snapshot-interval = 0 is accepted' '
+	cat >zero.toml <<-EOT &&
+	[job-list]
+	snapshot-interval = "0"
+	EOT
+	flux config load zero.toml &&
+	flux dmesg -C &&
+	flux module reload job-list &&
+	flux dmesg -H | grep "restored 4 inactive jobs from snapshot"
+'
+
+test_done
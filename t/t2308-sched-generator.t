@@ -33,7 +33,10 @@ test_expect_success 'stats-get returns expected fields' '
 	jq -e ".sched_delay >= 0" stats.json &&
 	jq -e ".sched_duration_ewma >= 0" stats.json &&
 	jq -e ".sched_interval_ewma >= 0" stats.json &&
-	jq -e ".pending_jobs >= 0" stats.json
+	jq -e ".pending_jobs >= 0" stats.json &&
+	jq -e ".alloc_commits >= 0" stats.json &&
+	jq -e ".alloc_committed >= 0" stats.json &&
+	jq -e ".alloc_batch_max >= 0" stats.json
 '
 
 # -------------------------------------------------------------------
@@ -51,6 +54,11 @@ test_expect_success 'sched_passes incremented after job ran' '
 	passes_after=$(sched_stat sched_passes) &&
 	test "$passes_after" -gt "$passes_before"
 '
+test_expect_success 'alloc R commits are counted' '
+	test $(sched_stat alloc_commits) -ge 1 &&
+	test $(sched_stat alloc_committed) -ge $(sched_stat alloc_commits) &&
+	test $(sched_stat alloc_batch_max) -ge 1
+'
 
 # -------------------------------------------------------------------
 # stats-get: sched_yields > 0 after a multi-job pass
@@ -73,6 +73,19 @@ test_expect_success "alloc: libschedutil strips '+' properties from job R" '
 test_expect_success 'alloc: restore canned R without properties' '
 	flux kvs put test.schedutil.R="$(cat shim_R.json)"
 '
+test_expect_success 'alloc: burst of allocations is committed in batches' '
+	flux queue stop &&
+	flux submit --cc=1-8 hostname >burst.ids &&
+	flux queue start &&
+	for id in $(cat burst.ids); do
+		flux job wait-event -t 30 $id alloc || return 1
+	done &&
+	flux module stats schedutil-shim >shim_stats.json &&
+	test_debug "jq -S . <shim_stats.json" &&
+	jq -e ".alloc_committed >= 8" <shim_stats.json &&
+	jq -e ".alloc_commits <= .alloc_committed" <shim_stats.json &&
+	jq -e ".alloc_batch_max >= 1" <shim_stats.json
+'
 test_expect_success 'deny: unschedulable jobs receive an exception' '
 	flux kvs put test.schedutil.mode=deny &&
 	jobid=$(flux submit hostname) &&
@@ -353,4 +353,33 @@ test_expect_success 'flux-shell: gpu-affinity uneven distribution node-exclusive
 	sort -k1,1n ${name}.output > ${name}.out &&
 	test_cmp ${name}.expected ${name}.out
 '
+test_expect_success 'resource module shares topology in rundir' '
+	test -f $(flux getattr rundir)/hwloc.shmem
+'
+test_expect_success 'flux-shell: affinity uses shared topology' '
+	flux run -o verbose -n1 -c1 $CPUS_ALLOWED_COUNT \
+		>shmem.out 2>shmem.err &&
+	grep "using shared topology" shmem.err &&
+	test "$(cat shmem.out)" = "1"
+'
+test_expect_success MULTICORE 'flux-shell: per-task affinity uses shared topology' '
+	flux run -o verbose --label-io -ocpu-affinity=per-task -n2 -c1 \
+		hwloc-bind --get >shmem-per-task.out 2>shmem-per-task.err &&
+	grep "using shared topology" shmem-per-task.err &&
+	test_must_fail grep "distribute_tasks failed" shmem-per-task.err &&
+	task0set=$(sed -n "s/^0: //p" shmem-per-task.out) &&
+	task1set=$(sed -n "s/^1: //p" shmem-per-task.out) &&
+	test "$task0set" != "$task1set" &&
+	test $(hwloc-calc --number-of core $task0set) -eq 1 &&
+	test $(hwloc-calc --number-of core $task1set) -eq 1
+'
+test_expect_success 'flux-shell: affinity works without shared topology' '
+	rundir=$(flux getattr rundir) &&
+	mv $rundir/hwloc.shmem $rundir/hwloc.shmem.save &&
+	test_when_finished "mv $rundir/hwloc.shmem.save $rundir/hwloc.shmem" &&
+	flux run -o verbose -n1 -c1 $CPUS_ALLOWED_COUNT \
+		>noshmem.out 2>noshmem.err &&
+	test_must_fail grep "using shared topology" noshmem.err &&
+	test "$(cat noshmem.out)" = "1"
+'
 test_done
@@ -109,6 +109,15 @@ test_expect_success 'kvstest works with -o pmi-simple.exchange.k=SIZE+1' '
 	grep "using k=${SIZE}" kvstest_kp1.err
 '
 
+test_expect_success 'kvstest works with -o pmi-simple.kvs=sharded' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.kvs=sharded ${kvstest}
+'
+test_expect_success 'kvstest -N8 works with -o pmi-simple.kvs=sharded' '
+	flux run -n${SIZE} -N${SIZE} -o pmi-simple.kvs=sharded ${kvstest} -N8
+'
+test_expect_success 'kvstest works with -o pmi-simple.kvs=sharded on one node' '
+	flux run -n2 -N1 -o pmi-simple.kvs=sharded ${kvstest}
+'
 test_expect_success 'kvstest fails with -o pmi-simple.kvs=unknown' '
 	test_must_fail flux run -o pmi-simple.kvs=unknown ${kvstest}
 '